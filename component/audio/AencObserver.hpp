@@ -46,6 +46,10 @@ public:
 
         if (E_OBS_TARGET_TYPE_AIRAW == eTarget) {
             m_nTargetPipeChannel = eTarget << 24 | nGrp << 16 | nChn;
+            if (!m_bProducer) {
+                m_pSink->AddProducer();
+                m_bProducer = AX_TRUE;
+            }
         }
 
         return AX_TRUE;
@@ -53,5 +57,6 @@ public:
 
 private:
     CAudioEncoder* m_pSink{nullptr};
+    AX_BOOL m_bProducer{AX_FALSE};
     AX_U32 m_nTargetPipeChannel{0};
 };
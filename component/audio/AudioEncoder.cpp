@@ -42,6 +42,10 @@ CAudioEncoder::~CAudioEncoder() {
 }
 
 AX_BOOL CAudioEncoder::Init() {
+    if (!CAXStage::Init()) {
+        return AX_FALSE;
+    }
+
     SetCapacity(AX_APP_LOCKQ_CAPACITY);
 
     // parameter check
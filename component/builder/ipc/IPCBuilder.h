@@ -11,6 +11,7 @@
 #pragma once
 
 #include <mutex>
+#include <set>
 #include "Capture.hpp"
 #include "Collector.h"
 #include "Detector.hpp"
@@ -25,6 +26,7 @@
 #include "SensorMgr.h"
 #include "VideoEncoder.h"
 #ifdef MP4ENC_SUPPORT
+#include "EventRecorder.h"
 #include "Mpeg4Encoder.h"
 #endif
 #ifdef VO_SUPPORT
@@ -108,6 +110,9 @@ private:
     AX_BOOL ConstructIves();
     AX_BOOL InitIves();
     AX_BOOL InitDummyEnc(AX_VOID);
+    /* start or stop the modules of one node of CLinkage start/stop order, each node once */
+    AX_BOOL StartModule(const IPC_MOD_INFO_T& tMod, std::set<AX_U64>& setStarted);
+    AX_BOOL StopModule(const IPC_MOD_INFO_T& tMod, std::set<AX_U64>& setStopped);
 
     AX_BOOL UpdateRotation(AX_U8 nSnsID, AX_U8 nRotation);
     AX_VOID SetWebFrameRateOption(const SENSOR_CONFIG_T& tSnsConfig, AX_BOOL bUpdateFrameRate = AX_FALSE);
@@ -128,6 +133,8 @@ public:
 
 #ifdef MP4ENC_SUPPORT
     vector<CMPEG4Encoder*> m_vecMpeg4Instance;
+    vector<CEventRecorder*> m_vecEventRecorder;
+    std::unique_ptr<IFMP4Sink> m_pWebFMP4Sink; /* MSE preview, fed by the first fragmented m_vecMpeg4Instance */
 #endif
     vector<CDummyEncoder*> m_vecDummyEncInstance;
     vector<CJpegEncoder*> m_vecJencInstance;
@@ -141,6 +148,7 @@ public:
     std::vector<std::unique_ptr<IObserver>> m_vecIvesObs;
     std::vector<std::unique_ptr<IObserver>> m_vecIvpsObs;
     std::vector<std::unique_ptr<IObserver>> m_vecMpeg4Obs;
+    std::vector<std::unique_ptr<IObserver>> m_vecEventRecordObs;
     std::vector<std::unique_ptr<IObserver>> m_vecCaptureObs;
     std::vector<std::unique_ptr<IObserver>> m_vecOsdObs;
     std::vector<std::unique_ptr<IObserver>> m_vecDummyEncObs;
@@ -538,6 +538,13 @@ AX_BOOL COPALBuilder::InitDetector() {
         tDetectAttr.strModelPath = ALGO_HVCFP_PARAM(0).strDetectModelsPath;
         tDetectAttr.ePPL = (AX_SKEL_PPL_E)CAlgoOptionHelper::GetInstance()->GetDetectAlgoType(0);
         tDetectAttr.nGrp = tDstMod.nGroup;
+        tDetectAttr.nInflightNum = COptionHelper::GetInstance()->GetDetectInflightNum();
+        tDetectAttr.eSchedMode = (DETECT_SCHED_MODE_E)COptionHelper::GetInstance()->GetDetectSchedMode();
+        tDetectAttr.nBatchBudgetMs = COptionHelper::GetInstance()->GetDetectBatchBudget();
+        tDetectAttr.bAdaptiveSkip = COptionHelper::GetInstance()->IsEnableDetectAdaptiveSkip();
+        for (AX_U32 i = 0; i < AX_APP_ALGO_SNS_MAX; ++i) {
+            tDetectAttr.nSnsWeight[i] = COptionHelper::GetInstance()->GetDetectSnsWeight(i);
+        }
 
         // bind sensor
         m_detector.BindSensorMgr(&m_mgrSensor);
@@ -644,7 +651,7 @@ AX_BOOL COPALBuilder::InitCollector() {
     }
 
     /* Mulit Module to a Collect */
-    for (AX_U8 i = 0; i < MAX_COLLECT_GROUP_NUM; i++) {
+    for (AX_U8 i = 0; i < m_vecCollectorInstance.size(); i++) {
         IPC_MOD_INFO_T tDstMod = {E_PPL_MOD_TYPE_COLLECT, i, 0};
         vector<PPL_MOD_RELATIONSHIP_T> vecRelations;
         if (!GetRelationsByDstMod(tDstMod, vecRelations, AX_TRUE)) {
@@ -680,7 +687,7 @@ AX_BOOL COPALBuilder::InitCollector() {
     }
 
     /* A collect to mulit Module */
-    for (AX_U8 i = 0; i < MAX_COLLECT_GROUP_NUM; i++) {
+    for (AX_U8 i = 0; i < m_vecCollectorInstance.size(); i++) {
         IPC_MOD_INFO_T tSrcMod = {E_PPL_MOD_TYPE_COLLECT, i, 0};
         vector<PPL_MOD_RELATIONSHIP_T> vecRelations;
         if (!GetRelationsBySrcMod(tSrcMod, vecRelations, AX_TRUE)) {
@@ -9,6 +9,7 @@
  **************************************************************************************************/
 
 #include "PanoBuilder.h"
+#include <algorithm>
 
 #include "AXTypeConverter.hpp"
 #include "AlgoOptionHelper.h"
@@ -30,6 +31,7 @@
 #include "IvpsObserver.h"
 #include "IvpsOptionHelper.h"
 #include "JencObserver.h"
+#include "LatencyTracer.hpp"
 #include "OSDHandler.h"
 #include "OSDHelper.h"
 #include "OptionHelper.h"
@@ -46,9 +48,13 @@
 #include "AudioWrapper.hpp"
 #include "WebObserver.h"
 #include "WebServer.h"
+#ifdef MP4ENC_SUPPORT
+#include "WebFMP4Sink.h"
+#endif
 #endif  // SLT
 
 #ifdef MP4ENC_SUPPORT
+#include "EventRecordObserver.h"
 #include "MpegObserver.h"
 #endif
 
@@ -102,6 +108,8 @@ AX_BOOL CPanoBuilder::Construct(AX_VOID) {
         LOG_MM(PPL, "Apply default scenario %d.", m_nScenario);
     }
 
+    CLatencyTracer::GetInstance()->Enable(COptionHelper::GetInstance()->IsEnableLatencyTrace());
+
     /* Step-2: Linkage initialization */
     if (m_linkage.Setup()) {
         LOG_MM_W(PPL, "Linkage setup.");
@@ -301,6 +309,7 @@ AX_BOOL CPanoBuilder::InitIvps() {
         if (!pIvpsInstance->Init()) {
             break;
         }
+        pIvpsInstance->SetQueueType((AX_APP_LOCKQ_TYPE_E)COptionHelper::GetInstance()->GetStageQueueType("Ivps"));
 
         if (COptionHelper::GetInstance()->IsEnableOSD()) {
             IOSDHelper* pHelper = new COSDHelper();
@@ -324,8 +333,10 @@ AX_BOOL CPanoBuilder::InitIvps() {
         m_vecIvpsObs.emplace_back(CObserverMaker::CreateObserver<CIvpsObserver>(pIvpsInstance));
         if (!tRelation.bLink) {
             if (E_PPL_MOD_TYPE_IVPS == tRelation.tSrcModChn.eModType) {
-                m_vecIvpsInstance[tRelation.tSrcModChn.nGroup]->RegObserver(tRelation.tSrcModChn.nChannel,
-                                                                            m_vecIvpsObs[m_vecIvpsObs.size() - 1].get());
+                /* frames of upstream channel come by stage edge, the observer only takes the channel attributes */
+                m_vecIvpsInstance[tRelation.tSrcModChn.nGroup]->BindChnStage(tRelation.tSrcModChn.nChannel, pIvpsInstance,
+                                                                             m_vecIvpsObs[m_vecIvpsObs.size() - 1].get(),
+                                                                             STAGE_DROP_POLICY_NEWEST);
             } else {
                 LOG_MM_W(PPL, "Non-Link mode is not supported");
             }
@@ -496,6 +507,7 @@ AX_BOOL CPanoBuilder::InitVenc() {
                 if (!pVencInstance->Init()) {
                     break;
                 }
+                pVencInstance->SetQueueType((AX_APP_LOCKQ_TYPE_E)COptionHelper::GetInstance()->GetStageQueueType("Venc"));
                 PPL_MOD_INFO_T tDstMod = {E_PPL_MOD_TYPE_VENC, 0, pVencInstance->GetChannel()};
                 vector<PPL_MOD_RELATIONSHIP_T> vecRelations;
                 if (!GetRelationsByDstMod(tDstMod, vecRelations)) {
@@ -582,6 +594,8 @@ AX_BOOL CPanoBuilder::InitVenc() {
                     tMpeg4Info.bLoopSet = COptionHelper::GetInstance()->GetMp4LoopSet();
                     tMpeg4Info.nMaxFileInMBytes = COptionHelper::GetInstance()->GetMp4FileSize();
                     tMpeg4Info.nMaxFileCount = COptionHelper::GetInstance()->GetMp4FileCount();
+                    tMpeg4Info.bFragmented = COptionHelper::GetInstance()->IsMp4Fragmented();
+                    tMpeg4Info.nMaxFragmentInKBytes = COptionHelper::GetInstance()->GetMp4FragmentSize();
 
                     AX_U32 nBuffSize = COptionHelper::GetInstance()->GetWebVencRingBufSize(pConfig->nWidth, pConfig->nHeight);
                     tMpeg4Info.stVideoAttr.bEnable = AX_TRUE;
@@ -617,6 +631,71 @@ AX_BOOL CPanoBuilder::InitVenc() {
                     AX_APP_Audio_RegPacketObserver(nAudioMp4Chn, m_vecMpeg4Obs[m_vecMpeg4Obs.size() - 1].get());
                     pVencInstance->RegObserver(m_vecMpeg4Obs[m_vecMpeg4Obs.size() - 1].get());
                     m_vecMpeg4Instance.emplace_back(pMp4Instance);
+
+                    /* MSE preview serves the same fragments as the recorded files */
+                    if (tMpeg4Info.bFragmented && !m_pWebFMP4Sink) {
+                        CWebFMP4Sink* pWebSink = new CWebFMP4Sink(CWebServer::GetInstance());
+                        m_pWebFMP4Sink.reset(pWebSink);
+                        if (pWebSink->Init(pMp4Instance->GetMaxFragmentSize())) {
+                            pMp4Instance->RegisterFragmentSink(pWebSink);
+                        } else {
+                            LOG_MM_W(PPL, "MSE preview of chn %d is not available", pConfig->nChannel);
+                        }
+                    }
+                }
+
+                /* event record on the first stream of each sensor */
+                AX_U8 nSnsId = pVencInstance->GetSensorSrc();
+                if (COptionHelper::GetInstance()->IsEnableEventRecord() &&
+                    std::none_of(m_vecEventRecorder.begin(), m_vecEventRecorder.end(),
+                                 [nSnsId](CEventRecorder* pRecorder) { return pRecorder->GetSnsId() == nSnsId; })) {
+                    VIDEO_CONFIG_T* pConfig = pVencInstance->GetChnCfg();
+                    EVENT_RECORD_ATTR_T tEventAttr;
+                    tEventAttr.nSnsId = nSnsId;
+                    tEventAttr.nTriggerMask = COptionHelper::GetInstance()->GetEventRecordTrigger();
+                    tEventAttr.nPreRecordSec = COptionHelper::GetInstance()->GetEventPreRecordSec();
+                    tEventAttr.nPostRecordSec = COptionHelper::GetInstance()->GetEventPostRecordSec();
+
+                    MPEG4EC_INFO_T& tClipInfo = tEventAttr.tClipInfo;
+                    tClipInfo.nchn = pConfig->nChannel;
+                    tClipInfo.nMaxFileCount = COptionHelper::GetInstance()->GetEventRecordFileCount();
+                    tClipInfo.nMaxFragmentInKBytes = COptionHelper::GetInstance()->GetMp4FragmentSize();
+                    tClipInfo.strSavePath = COptionHelper::GetInstance()->GetEventRecordSavedPath();
+                    tClipInfo.strFilePrefix = "EVT" + std::to_string(nSnsId) + "_";
+                    tClipInfo.stVideoAttr.bEnable = AX_TRUE;
+                    tClipInfo.stVideoAttr.ePt = pConfig->ePayloadType;
+                    tClipInfo.stVideoAttr.nfrWidth = pConfig->nWidth;
+                    tClipInfo.stVideoAttr.nfrHeight = pConfig->nHeight;
+                    tClipInfo.stVideoAttr.nFrameRate = pConfig->fDstFrameRate;
+                    tClipInfo.stVideoAttr.nBitrate = pConfig->nBitrate;
+
+                    AX_APP_AUDIO_CHAN_E nAudioMp4Chn = APP_AUDIO_MP4_CHANNEL();
+                    AX_APP_AUDIO_ENCODER_ATTR_T stAttr;
+                    if (0 == AX_APP_Audio_GetEncoderAttr(nAudioMp4Chn, &stAttr)) {
+                        tClipInfo.stAudioAttr.bEnable = AX_TRUE;
+                        tClipInfo.stAudioAttr.ePt = (AX_PAYLOAD_TYPE_E)stAttr.eType;
+                        tClipInfo.stAudioAttr.nBitrate = stAttr.nBitRate;
+                        tClipInfo.stAudioAttr.nSampleRate = (AX_U32)stAttr.eSampleRate;
+                        tClipInfo.stAudioAttr.nChnCnt = (AX_APP_AUDIO_SOUND_MODE_MONO == stAttr.eSoundMode) ? 1 : 2;
+                        tClipInfo.stAudioAttr.nAOT = (AX_S32)stAttr.nAOT;
+                    } else {
+                        tClipInfo.stAudioAttr.bEnable = AX_FALSE;
+                    }
+
+                    CEventRecorder* pRecorder = new CEventRecorder();
+                    if (!pRecorder->Init(tEventAttr)) {
+                        LOG_MM_E(PPL, "Init event recorder of sensor %d failed", nSnsId);
+                        delete pRecorder;
+                        return AX_FALSE;
+                    }
+
+                    m_vecEventRecordObs.emplace_back(CObserverMaker::CreateObserver<CEventRecordObserver>(pRecorder));
+                    pVencInstance->RegObserver(m_vecEventRecordObs[m_vecEventRecordObs.size() - 1].get());
+                    if (tClipInfo.stAudioAttr.bEnable) {
+                        AX_APP_Audio_RegPacketObserver(nAudioMp4Chn, m_vecEventRecordObs[m_vecEventRecordObs.size() - 1].get());
+                    }
+                    AX_APP_Audio_RegDetectResultObserver(m_vecEventRecordObs[m_vecEventRecordObs.size() - 1].get());
+                    m_vecEventRecorder.emplace_back(pRecorder);
                 }
 #endif  // MP4ENC_SUPPORT
 #else
@@ -662,6 +741,7 @@ AX_BOOL CPanoBuilder::InitJenc() {
                 if (!pJencInstance->Init()) {
                     break;
                 }
+                pJencInstance->SetQueueType((AX_APP_LOCKQ_TYPE_E)COptionHelper::GetInstance()->GetStageQueueType("Jenc"));
 
                 /* Step-8-2: IVPS register JENC observers and init JENC attributes according to IVPS attributes */
                 IPC_MOD_INFO_T tDstMod = {E_PPL_MOD_TYPE_JENC, 0, pJencInstance->GetChannel()};
@@ -750,6 +830,13 @@ AX_BOOL CPanoBuilder::InitDetector() {
         tDetectAttr.strModelPath = ALGO_HVCFP_PARAM(0).strDetectModelsPath;
         tDetectAttr.ePPL = (AX_SKEL_PPL_E)CAlgoOptionHelper::GetInstance()->GetDetectAlgoType(0);
         tDetectAttr.nGrp = tDstMod.nGroup;
+        tDetectAttr.nInflightNum = COptionHelper::GetInstance()->GetDetectInflightNum();
+        tDetectAttr.eSchedMode = (DETECT_SCHED_MODE_E)COptionHelper::GetInstance()->GetDetectSchedMode();
+        tDetectAttr.nBatchBudgetMs = COptionHelper::GetInstance()->GetDetectBatchBudget();
+        tDetectAttr.bAdaptiveSkip = COptionHelper::GetInstance()->IsEnableDetectAdaptiveSkip();
+        for (AX_U32 i = 0; i < AX_APP_ALGO_SNS_MAX; ++i) {
+            tDetectAttr.nSnsWeight[i] = COptionHelper::GetInstance()->GetDetectSnsWeight(i);
+        }
 
         // bind sensor
         m_detector.BindSensorMgr(&m_mgrSensor);
@@ -777,6 +864,13 @@ AX_BOOL CPanoBuilder::InitDetector() {
             m_vecSvcObs.emplace_back(CObserverMaker::CreateObserver<CSvcObserver>(pInstance));
             m_detector.RegObserver(m_vecSvcObs[m_vecSvcObs.size() - 1].get());
         }
+
+#ifdef MP4ENC_SUPPORT
+        for (auto& pRecorder : m_vecEventRecorder) {
+            m_vecEventRecordObs.emplace_back(CObserverMaker::CreateObserver<CEventRecordObserver>(pRecorder));
+            m_detector.RegObserver(m_vecEventRecordObs[m_vecEventRecordObs.size() - 1].get());
+        }
+#endif
     }
 
     LOG_MM(PPL, "---");
@@ -795,8 +889,10 @@ AX_BOOL CPanoBuilder::ConstructIves() {
                     m_vecIvesInstance.emplace_back(pIves);
 
                     m_vecIvesObs.emplace_back(CObserverMaker::CreateObserver<CIvesObserver>(pIves));
-                    m_vecIvpsInstance[relation.tSrcModChn.nGroup]->RegObserver(relation.tSrcModChn.nChannel,
-                                                                               m_vecIvesObs[m_vecIvesObs.size() - 1].get());
+                    /* analysis wants the latest frame, a slow IVES drops its oldest queued frame instead of stalling the channel */
+                    m_vecIvpsInstance[relation.tSrcModChn.nGroup]->BindChnStage(relation.tSrcModChn.nChannel, pIves,
+                                                                                m_vecIvesObs[m_vecIvesObs.size() - 1].get(),
+                                                                                STAGE_DROP_POLICY_OLDEST);
                     /*fixme: IVES requires a 640*360 resulution ,but INPLACE mode does not support resize */
                     m_vecIvpsInstance[relation.tSrcModChn.nGroup]->SetChnInplace(relation.tSrcModChn.nChannel, AX_FALSE);
                 } else if (E_PPL_MOD_TYPE_COLLECT == relation.tSrcModChn.eModType) {
@@ -825,6 +921,7 @@ AX_BOOL CPanoBuilder::InitIves() {
 
                     CWebOptionHelper::GetInstance()->InitIvesAttr(tDstMod.nGroup, pIves);
                     pIves->Init(tDstMod.nGroup);
+                    pIves->SetQueueType((AX_APP_LOCKQ_TYPE_E)COptionHelper::GetInstance()->GetStageQueueType("Ives"));
 
                     if (m_pTestSuite) {
                         m_pTestSuite->InitIvesAttr(tDstMod.nGroup);
@@ -835,11 +932,18 @@ AX_BOOL CPanoBuilder::InitIves() {
                     m_vecWebObs.emplace_back(CObserverMaker::CreateObserver<CWebObserver>(CWebServer::GetInstance()));
                     pIves->RegObserver(m_vecWebObs[m_vecWebObs.size() - 1].get());
 #endif  // SLT
+#ifdef MP4ENC_SUPPORT
+                    for (auto& pRecorder : m_vecEventRecorder) {
+                        m_vecEventRecordObs.emplace_back(CObserverMaker::CreateObserver<CEventRecordObserver>(pRecorder));
+                        pIves->RegObserver(m_vecEventRecordObs[m_vecEventRecordObs.size() - 1].get());
+                    }
+#endif
                 } else if (E_PPL_MOD_TYPE_COLLECT == relation.tSrcModChn.eModType) {
                     CIVESStage* pIves = m_vecIvesInstance[i];
 
                     CWebOptionHelper::GetInstance()->InitIvesAttr(tDstMod.nGroup, pIves);
                     pIves->Init(tDstMod.nGroup);
+                    pIves->SetQueueType((AX_APP_LOCKQ_TYPE_E)COptionHelper::GetInstance()->GetStageQueueType("Ives"));
                     if (m_pTestSuite) {
                         m_pTestSuite->InitIvesAttr(tDstMod.nGroup);
                     }
@@ -849,6 +953,12 @@ AX_BOOL CPanoBuilder::InitIves() {
                     m_vecWebObs.emplace_back(CObserverMaker::CreateObserver<CWebObserver>(CWebServer::GetInstance()));
                     pIves->RegObserver(m_vecWebObs[m_vecWebObs.size() - 1].get());
 #endif  // SLT
+#ifdef MP4ENC_SUPPORT
+                    for (auto& pRecorder : m_vecEventRecorder) {
+                        m_vecEventRecordObs.emplace_back(CObserverMaker::CreateObserver<CEventRecordObserver>(pRecorder));
+                        pIves->RegObserver(m_vecEventRecordObs[m_vecEventRecordObs.size() - 1].get());
+                    }
+#endif
                 }
             }
         }
@@ -930,7 +1040,7 @@ AX_BOOL CPanoBuilder::InitCollector() {
     }
 
     /* Mulit Module to a Collect */
-    for (AX_U8 i = 0; i < MAX_COLLECT_GROUP_NUM; i++) {
+    for (AX_U8 i = 0; i < m_vecCollectorInstance.size(); i++) {
         IPC_MOD_INFO_T tDstMod = {E_PPL_MOD_TYPE_COLLECT, i, 0};
         vector<PPL_MOD_RELATIONSHIP_T> vecRelations;
         if (!GetRelationsByDstMod(tDstMod, vecRelations, AX_TRUE)) {
@@ -966,7 +1076,7 @@ AX_BOOL CPanoBuilder::InitCollector() {
     }
 
     /* A collect to mulit Module */
-    for (AX_U8 i = 0; i < MAX_COLLECT_GROUP_NUM; i++) {
+    for (AX_U8 i = 0; i < m_vecCollectorInstance.size(); i++) {
         IPC_MOD_INFO_T tSrcMod = {E_PPL_MOD_TYPE_COLLECT, i, 0};
         vector<PPL_MOD_RELATIONSHIP_T> vecRelations;
         if (!GetRelationsBySrcMod(tSrcMod, vecRelations, AX_TRUE)) {
@@ -1064,63 +1174,37 @@ AX_BOOL CPanoBuilder::Start(AX_VOID) {
             return AX_FALSE;
         }
     }
-#endif
 
-    if (!m_detector.Start()) {
-        return AX_FALSE;
+    for (auto& pRecorder : m_vecEventRecorder) {
+        pRecorder->Start();
     }
+#endif
 
-    for (auto& pInstance : m_vecIvesInstance) {
-        if (!pInstance->Start()) {
+    /* modules in relations start downstream first, the others keep their fixed order */
+    std::set<AX_U64> setStarted;
+    for (const auto& tMod : m_linkage.GetStartOrder()) {
+        if (!StartModule(tMod, setStarted)) {
             return AX_FALSE;
         }
     }
 
-    for (auto& pInstance : m_vecDummyEncInstance) {
-        STAGE_START_PARAM_T tStartParam;
-        tStartParam.bStartProcessingThread = AX_TRUE;
-        if (!pInstance->Start(&tStartParam)) {
-            return AX_FALSE;
-        }
+    if (!StartModule({E_PPL_MOD_TYPE_DETECT, 0, 0}, setStarted)) {
+        return AX_FALSE;
     }
-
-    for (auto& pInstance : m_vecVencInstance) {
-        STAGE_START_PARAM_T tStartParam;
-        AX_BOOL bLinkMode = pInstance->GetChnCfg()->bLink;
-        tStartParam.bStartProcessingThread = bLinkMode ? AX_FALSE : AX_TRUE;
-        if (!pInstance->Start(&tStartParam)) {
-            LOG_MM_E(PPL, "Start venc failed.");
+    for (auto& pInstance : m_vecIvesInstance) {
+        if (!StartModule({E_PPL_MOD_TYPE_IVES, (AX_S32)pInstance->GetGrp(), 0}, setStarted)) {
             return AX_FALSE;
         }
     }
-
-    for (auto& pInstance : m_vecJencInstance) {
-        AX_BOOL bLinkMode = pInstance->GetChnCfg()->bLink;
-
-        STAGE_START_PARAM_T tStartParam;
-        tStartParam.bStartProcessingThread = bLinkMode ? AX_FALSE : AX_TRUE;
-        if (!pInstance->Start(&tStartParam)) {
-            LOG_MM_E(PPL, "Start jenc failed.");
-            return AX_FALSE;
-        }
+    if (!StartModule({E_PPL_MOD_TYPE_DUMMYENC, 0, 0}, setStarted) || !StartModule({E_PPL_MOD_TYPE_VENC, 0, 0}, setStarted)) {
+        return AX_FALSE;
     }
-
-    for (auto& pInstance : m_vecIvpsInstance) {
-        AX_BOOL bLinkMode = pInstance->GetGrpCfg()->nGrpLinkFlag == 0 ? AX_FALSE : AX_TRUE;
-
-        STAGE_START_PARAM_T tStartParam;
-        tStartParam.bStartProcessingThread = bLinkMode ? AX_FALSE : AX_TRUE;
-        if (!pInstance->Start(&tStartParam)) {
-            LOG_MM_E(PPL, "Start ivps failed.");
+    for (AX_U32 i = 0; i < m_vecIvpsInstance.size(); ++i) {
+        if (!StartModule({E_PPL_MOD_TYPE_IVPS, (AX_S32)i, 0}, setStarted)) {
             return AX_FALSE;
         }
     }
-
-    m_avs.Start();
-
-    if (AX_FALSE == m_mgrSensor.Start()) {
-        LOG_MM_E(PPL, "Start sensor failed.");
-
+    if (!StartModule({E_PPL_MOD_TYPE_AVS, 0, 0}, setStarted) || !StartModule({E_PPL_MOD_TYPE_VIN, 0, 0}, setStarted)) {
         return AX_FALSE;
     }
 
@@ -1161,50 +1245,39 @@ AX_BOOL CPanoBuilder::Stop(AX_VOID) {
             return AX_FALSE;
         }
     }
+
+    for (auto& pRecorder : m_vecEventRecorder) {
+        pRecorder->Stop();
+    }
 #endif
 
 #ifndef SLT
     AX_APP_Audio_Stop();
 #endif  // SLT
 
-    if (!m_mgrSensor.Stop()) {
-        return AX_FALSE;
-    }
-
-    m_avs.StopAVSCalibrate();
-    m_avs.Stop();
-
-    for (auto& pInstance : m_vecIvpsInstance) {
-        if (!pInstance->Stop()) {
-            return AX_FALSE;
-        }
-    }
-
-    for (auto& pInstance : m_vecIvesInstance) {
-        if (!pInstance->Stop()) {
+    /* modules in relations stop upstream first, the others keep their fixed order */
+    std::set<AX_U64> setStopped;
+    for (const auto& tMod : m_linkage.GetStopOrder()) {
+        if (!StopModule(tMod, setStopped)) {
             return AX_FALSE;
         }
     }
 
-    for (auto& pInstance : m_vecDummyEncInstance) {
-        if (!pInstance->Stop()) {
-            return AX_FALSE;
-        }
+    if (!StopModule({E_PPL_MOD_TYPE_VIN, 0, 0}, setStopped) || !StopModule({E_PPL_MOD_TYPE_AVS, 0, 0}, setStopped)) {
+        return AX_FALSE;
     }
-
-    for (auto& pInstance : m_vecVencInstance) {
-        if (!pInstance->Stop()) {
+    for (AX_U32 i = 0; i < m_vecIvpsInstance.size(); ++i) {
+        if (!StopModule({E_PPL_MOD_TYPE_IVPS, (AX_S32)i, 0}, setStopped)) {
             return AX_FALSE;
         }
     }
-
-    for (auto& pInstance : m_vecJencInstance) {
-        if (!pInstance->Stop()) {
+    for (auto& pInstance : m_vecIvesInstance) {
+        if (!StopModule({E_PPL_MOD_TYPE_IVES, (AX_S32)pInstance->GetGrp(), 0}, setStopped)) {
             return AX_FALSE;
         }
     }
-
-    if (!m_detector.Stop()) {
+    if (!StopModule({E_PPL_MOD_TYPE_DUMMYENC, 0, 0}, setStopped) || !StopModule({E_PPL_MOD_TYPE_VENC, 0, 0}, setStopped) ||
+        !StopModule({E_PPL_MOD_TYPE_DETECT, 0, 0}, setStopped)) {
         return AX_FALSE;
     }
 
@@ -1232,6 +1305,144 @@ AX_BOOL CPanoBuilder::Stop(AX_VOID) {
     return AX_TRUE;
 }
 
+/* key of a start/stop node, IVPS and IVES per group, other modules as a whole */
+static AX_U64 ModuleNodeKey(const IPC_MOD_INFO_T& tMod) {
+    AX_S32 nGroup = (E_PPL_MOD_TYPE_IVPS == tMod.eModType || E_PPL_MOD_TYPE_IVES == tMod.eModType) ? tMod.nGroup : -1;
+    return ((AX_U64)tMod.eModType << 32) | (AX_U32)nGroup;
+}
+
+AX_BOOL CPanoBuilder::StartModule(const IPC_MOD_INFO_T& tMod, std::set<AX_U64>& setStarted) {
+    if (!setStarted.insert(ModuleNodeKey(tMod)).second) {
+        return AX_TRUE;
+    }
+
+    switch (tMod.eModType) {
+        case E_PPL_MOD_TYPE_VIN:
+            if (AX_FALSE == m_mgrSensor.Start()) {
+                LOG_MM_E(PPL, "Start sensor failed.");
+                return AX_FALSE;
+            }
+            break;
+        case E_PPL_MOD_TYPE_AVS:
+            m_avs.Start();
+            break;
+        case E_PPL_MOD_TYPE_IVPS:
+            if (tMod.nGroup >= 0 && tMod.nGroup < (AX_S32)m_vecIvpsInstance.size()) {
+                CIVPSGrpStage* pInstance = m_vecIvpsInstance[tMod.nGroup];
+                STAGE_START_PARAM_T tStartParam;
+                tStartParam.bStartProcessingThread = pInstance->GetGrpCfg()->nGrpLinkFlag == 0 ? AX_TRUE : AX_FALSE;
+                if (!pInstance->Start(&tStartParam)) {
+                    LOG_MM_E(PPL, "Start ivps failed.");
+                    return AX_FALSE;
+                }
+            }
+            break;
+        case E_PPL_MOD_TYPE_VENC:
+            /* JENC and MJENC share the module type of VENC */
+            for (auto& pInstance : m_vecVencInstance) {
+                STAGE_START_PARAM_T tStartParam;
+                tStartParam.bStartProcessingThread = pInstance->GetChnCfg()->bLink ? AX_FALSE : AX_TRUE;
+                if (!pInstance->Start(&tStartParam)) {
+                    LOG_MM_E(PPL, "Start venc failed.");
+                    return AX_FALSE;
+                }
+            }
+            for (auto& pInstance : m_vecJencInstance) {
+                STAGE_START_PARAM_T tStartParam;
+                tStartParam.bStartProcessingThread = pInstance->GetChnCfg()->bLink ? AX_FALSE : AX_TRUE;
+                if (!pInstance->Start(&tStartParam)) {
+                    LOG_MM_E(PPL, "Start jenc failed.");
+                    return AX_FALSE;
+                }
+            }
+            break;
+        case E_PPL_MOD_TYPE_IVES:
+            for (auto& pInstance : m_vecIvesInstance) {
+                if ((AX_S32)pInstance->GetGrp() == tMod.nGroup && !pInstance->Start()) {
+                    return AX_FALSE;
+                }
+            }
+            break;
+        case E_PPL_MOD_TYPE_DETECT:
+            if (!m_detector.Start()) {
+                return AX_FALSE;
+            }
+            break;
+        case E_PPL_MOD_TYPE_DUMMYENC:
+            for (auto& pInstance : m_vecDummyEncInstance) {
+                STAGE_START_PARAM_T tStartParam;
+                tStartParam.bStartProcessingThread = AX_TRUE;
+                if (!pInstance->Start(&tStartParam)) {
+                    return AX_FALSE;
+                }
+            }
+            break;
+        default:
+            /* collector and capture are started out of relations */
+            break;
+    }
+
+    return AX_TRUE;
+}
+
+AX_BOOL CPanoBuilder::StopModule(const IPC_MOD_INFO_T& tMod, std::set<AX_U64>& setStopped) {
+    if (!setStopped.insert(ModuleNodeKey(tMod)).second) {
+        return AX_TRUE;
+    }
+
+    switch (tMod.eModType) {
+        case E_PPL_MOD_TYPE_VIN:
+            if (!m_mgrSensor.Stop()) {
+                return AX_FALSE;
+            }
+            break;
+        case E_PPL_MOD_TYPE_AVS:
+            m_avs.StopAVSCalibrate();
+            m_avs.Stop();
+            break;
+        case E_PPL_MOD_TYPE_IVPS:
+            if (tMod.nGroup >= 0 && tMod.nGroup < (AX_S32)m_vecIvpsInstance.size() && !m_vecIvpsInstance[tMod.nGroup]->Stop()) {
+                return AX_FALSE;
+            }
+            break;
+        case E_PPL_MOD_TYPE_VENC:
+            for (auto& pInstance : m_vecVencInstance) {
+                if (!pInstance->Stop()) {
+                    return AX_FALSE;
+                }
+            }
+            for (auto& pInstance : m_vecJencInstance) {
+                if (!pInstance->Stop()) {
+                    return AX_FALSE;
+                }
+            }
+            break;
+        case E_PPL_MOD_TYPE_IVES:
+            for (auto& pInstance : m_vecIvesInstance) {
+                if ((AX_S32)pInstance->GetGrp() == tMod.nGroup && !pInstance->Stop()) {
+                    return AX_FALSE;
+                }
+            }
+            break;
+        case E_PPL_MOD_TYPE_DETECT:
+            if (!m_detector.Stop()) {
+                return AX_FALSE;
+            }
+            break;
+        case E_PPL_MOD_TYPE_DUMMYENC:
+            for (auto& pInstance : m_vecDummyEncInstance) {
+                if (!pInstance->Stop()) {
+                    return AX_FALSE;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+
+    return AX_TRUE;
+}
+
 AX_BOOL CPanoBuilder::Destroy(AX_VOID) {
     LOG_MM_C(PPL, "+++");
 
@@ -1252,6 +1463,13 @@ AX_BOOL CPanoBuilder::Destroy(AX_VOID) {
         }
         SAFE_DELETE_PTR(pInstance);
     }
+    /* registered to the encoders deleted above */
+    m_pWebFMP4Sink.reset();
+
+    for (auto& pRecorder : m_vecEventRecorder) {
+        pRecorder->DeInit();
+        SAFE_DELETE_PTR(pRecorder);
+    }
 #endif
 
     for (auto& pInstance : m_vecVencInstance) {
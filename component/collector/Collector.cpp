@@ -38,7 +38,6 @@ AX_BOOL CCollector::Stop() {
  * @brief Receive two pipes of VIN yuv frames and dispatch to multiple destinations directly.
  */
 AX_BOOL CCollector::RecvFrame(AX_U8 nSrcGroup, AX_U8 nSrcChannel, CAXFrame* pFrame) {
-    std::unique_lock<std::mutex> lock(m_mtxFrame);
     if (nullptr == pFrame) {
         return AX_FALSE;
     }
@@ -77,11 +76,15 @@ AX_VOID CCollector::RegObserver(IObserver* pObserver) {
         tTransAttr.bEnableFBC = m_stAttr.bEnableFBC;
         tTransAttr.fFramerate = m_stAttr.fFramerate;
         tTransAttr.fSrcFramerate = m_stAttr.fFramerate;
+
+        std::lock_guard<std::mutex> lck(m_mtxObserver);
+        std::shared_ptr<OBSERVER_LIST_T> spObservers = std::make_shared<OBSERVER_LIST_T>(*m_spObservers);
         if (pObserver->OnRegisterObserver(E_OBS_TARGET_TYPE_COLLECT, m_nGroup, 0, &tTransAttr)) {
-            m_vecObserver.emplace_back(pObserver);
+            spObservers->emplace_back(pObserver);
+            std::atomic_store(&m_spObservers, std::shared_ptr<const OBSERVER_LIST_T>(spObservers));
         }
         LOG_MM_I(COLLECT, "m_nGroup:%d, tTransAttr.nWidth:%d, height:%d, frameRate:%lf,vec.size():%d", m_nGroup, tTransAttr.nWidth,
-                 tTransAttr.nHeight, tTransAttr.fFramerate, m_vecObserver.size());
+                 tTransAttr.nHeight, tTransAttr.fFramerate, spObservers->size());
     }
 }
 
@@ -90,9 +93,12 @@ AX_VOID CCollector::UnregObserver(IObserver* pObserver) {
         return;
     }
 
-    for (vector<IObserver*>::iterator it = m_vecObserver.begin(); it != m_vecObserver.end(); it++) {
+    std::lock_guard<std::mutex> lck(m_mtxObserver);
+    std::shared_ptr<OBSERVER_LIST_T> spObservers = std::make_shared<OBSERVER_LIST_T>(*m_spObservers);
+    for (vector<IObserver*>::iterator it = spObservers->begin(); it != spObservers->end(); it++) {
         if (*it == pObserver) {
-            m_vecObserver.erase(it);
+            spObservers->erase(it);
+            std::atomic_store(&m_spObservers, std::shared_ptr<const OBSERVER_LIST_T>(spObservers));
             break;
         }
     }
@@ -103,23 +109,24 @@ AX_VOID CCollector::NotifyAll(AX_VOID* pFrame) {
         return;
     }
 
-    for (vector<IObserver*>::iterator it = m_vecObserver.begin(); it != m_vecObserver.end(); it++) {
+    /* list unregistered during notification stays alive until this snapshot is released */
+    std::shared_ptr<const OBSERVER_LIST_T> spObservers = std::atomic_load(&m_spObservers);
+    for (auto pObserver : *spObservers) {
         ((CAXFrame*)pFrame)->IncFrmRef();
-        (*it)->OnRecvData(E_OBS_TARGET_TYPE_COLLECT, m_nGroup, 0, pFrame);
+        pObserver->OnRecvData(E_OBS_TARGET_TYPE_COLLECT, m_nGroup, 0, pFrame);
     }
 }
 
 AX_VOID CCollector::RegTargetChannel(AX_U8 nGroup, AX_U8 nChannel) {
     LOG_MM_I(COLLECT, "RegTargetChannel nGroup:%d,nChannel:%d", nGroup, nChannel);
-    m_vecTargetChannel.emplace_back(std::make_pair(nGroup, nChannel));
-}
-
-AX_BOOL CCollector::IsTarget(AX_U8 nGroup, AX_U8 nChannel) {
-    for (auto& pair : m_vecTargetChannel) {
-        if (pair.first == nGroup && pair.second == nChannel) {
-            return AX_TRUE;
-        }
+    if (nChannel >= MAX_COLLECT_TARGET_CHN_NUM) {
+        LOG_MM_E(COLLECT, "collector[%d,0] target channel %d exceeds %d", m_nGroup, nChannel, MAX_COLLECT_TARGET_CHN_NUM);
+        return;
     }
 
-    return AX_FALSE;
+    m_vecTargetChannel.emplace_back(std::make_pair(nGroup, nChannel));
+    if (nGroup >= m_vecTargetMask.size()) {
+        m_vecTargetMask.resize(nGroup + 1, 0);
+    }
+    m_vecTargetMask[nGroup] |= ((AX_U64)1 << nChannel);
 }
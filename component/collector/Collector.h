@@ -10,13 +10,18 @@
 
 #pragma once
 
+#include <memory>
 #include <mutex>
+#include <vector>
 #include "AXFrame.hpp"
 #include "IModule.h"
 #include "IObserver.h"
 
-#define MAX_COLLECT_GROUP_NUM (4)
+/* collectors are created by relations in ppl.json with group id from 0, bounded only by AX_U8 group id */
+#define MAX_COLLECT_GROUP_NUM (0xFF)
 #define APP_COLLECT_INVALID (0)
+/* channel of target source is a bit of AX_U64 */
+#define MAX_COLLECT_TARGET_CHN_NUM (64)
 
 typedef struct COLLECTOR_ATTR_S {
     AX_U32 nWidth{APP_COLLECT_INVALID};
@@ -41,6 +46,7 @@ public:
     std::vector<std::pair<AX_U8, AX_U8>>& GetTargetChannels() {
         return m_vecTargetChannel;
     };
+    /* register all target channels before frames arrive, RecvFrame reads target bitmap without lock */
     AX_VOID RegTargetChannel(AX_U8 nGroup, AX_U8 nChannel);
 
     AX_BOOL RecvFrame(AX_U8 nSrcGroup, AX_U8 nSrcChannel, CAXFrame* pFrame);
@@ -53,13 +59,22 @@ public:
     };
 
 private:
-    AX_BOOL IsTarget(AX_U8 nGroup, AX_U8 nChannel);
+    AX_BOOL IsTarget(AX_U8 nGroup, AX_U8 nChannel) const {
+        return (nGroup < m_vecTargetMask.size() && nChannel < MAX_COLLECT_TARGET_CHN_NUM && (m_vecTargetMask[nGroup] >> nChannel) & 1)
+                   ? AX_TRUE
+                   : AX_FALSE;
+    }
     AX_VOID NotifyAll(AX_VOID* pFrame);
 
 private:
+    typedef std::vector<IObserver*> OBSERVER_LIST_T;
+
     AX_U8 m_nGroup;
-    std::vector<IObserver*> m_vecObserver;
+    /* copy on write: RecvFrame of each source takes a snapshot without lock, Reg/UnregObserver swap in a new list */
+    std::shared_ptr<const OBSERVER_LIST_T> m_spObservers{std::make_shared<OBSERVER_LIST_T>()};
+    std::mutex m_mtxObserver;
     std::vector<std::pair<AX_U8, AX_U8>> m_vecTargetChannel;
-    std::mutex m_mtxFrame;
+    /* indexed by source group, bit i for channel i */
+    std::vector<AX_U64> m_vecTargetMask;
     COLLECTOR_ATTR_T m_stAttr;
 };
@@ -19,6 +19,15 @@ AX_BOOL CIniWrapper::Load(const std::string& strIniPath) {
     }
 }
 
+AX_BOOL CIniWrapper::Save(const std::string& strIniPath) {
+    if (0 == m_ini.SaveAs(strIniPath)) {
+        return AX_TRUE;
+    } else {
+        printf("Save %s failed, err msg: %s\n", strIniPath.c_str(), m_ini.GetErrMsg().c_str());
+        return AX_FALSE;
+    }
+}
+
 AX_S32 CIniWrapper::GetIntValue(const std::string& strAppName, const std::string& strKeyName, AX_S32 nDefault) {
     AX_S32 nValue = nDefault;
     m_ini.GetIntValueOrDefault(strAppName, strKeyName, &nValue, nDefault);
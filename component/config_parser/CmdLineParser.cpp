@@ -32,6 +32,7 @@ AX_S32 CCmdLineParser::Parse(int argc, const char* const argv[]) {
     pParser->add(AX_APP_CMD_KEY_STATIC_LIB, 'a', "static lib");
     pParser->add<string>(AX_APP_UT, 'u', "ut case", false, "0");
     pParser->add<string>(AX_APP_CMD_KEY_DELAY_EXIT, 'z', "delay exit", false, "0");
+    pParser->add<string>(AX_APP_CMD_KEY_POOL_STAT, 'k', "pool usage report interval in seconds, 0: disable", false, "0");
 
 #ifdef FRTTESTLP_SUPPORT
     pParser->add<string>(AX_APP_CMD_KEY_VENC_ENABLE, 'v', "venc", false, "1");
@@ -74,6 +75,10 @@ AX_S32 CCmdLineParser::Parse(int argc, const char* const argv[]) {
         m_mapParams.insert(make_pair(AX_APP_CMD_KEY_DELAY_EXIT, pParser->get<string>(AX_APP_CMD_KEY_DELAY_EXIT)));
     }
 
+    if (pParser->exist(AX_APP_CMD_KEY_POOL_STAT)) {
+        m_mapParams.insert(make_pair(AX_APP_CMD_KEY_POOL_STAT, pParser->get<string>(AX_APP_CMD_KEY_POOL_STAT)));
+    }
+
     return 0;
 #else
     return 0;
@@ -203,6 +208,14 @@ AX_BOOL CCmdLineParser::GetDelayExitTime(AX_S32& nDelayExitTime) {
 #endif
 }
 
+AX_BOOL CCmdLineParser::GetPoolStatInterval(AX_S32& nInterval) {
+#ifndef _OPAL_LIB_
+    return GetIntValue(AX_APP_CMD_KEY_POOL_STAT, nInterval);
+#else
+    return AX_FALSE;
+#endif
+}
+
 AX_BOOL CCmdLineParser::isUTEnabled() {
 #ifndef _OPAL_LIB_
     AX_S32 nIndex = 0;
@@ -42,6 +42,7 @@
 
 #endif
 #define AX_APP_CMD_KEY_DELAY_EXIT "delay_exit"
+#define AX_APP_CMD_KEY_POOL_STAT "pool_stat"
 #define AX_APP_SCENARIO_INVALID "scenario_invalid"
 
 typedef enum {
@@ -86,6 +87,7 @@ public:
     AX_BOOL GetLogTarget(AX_S32& nLogTarget);
     AX_BOOL GetConfigPath(std::string& configPath);
     AX_BOOL GetDelayExitTime(AX_S32& nDelayExitTime);
+    AX_BOOL GetPoolStatInterval(AX_S32& nInterval);
 
     static std::string ScenarioEnum2Str(AX_U8 nScenario);
     AX_BOOL isDulSnsMode();
@@ -0,0 +1,170 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "DetectScheduler.hpp"
+#include <string.h>
+
+/* group without frame for 1s does not take share of NPU */
+#define DETECT_SCHED_ACTIVE_WINDOW_US (1000000)
+/* credit kept for burst, in frames */
+#define DETECT_SCHED_MAX_CREDIT (2.0)
+
+AX_BOOL CDetectScheduler::Init(const DETECT_SCHED_ATTR_T& stAttr) {
+    if (0 == stAttr.nGrpCount || stAttr.nGrpCount > DETECT_SCHED_MAX_GROUP_NUM) {
+        return AX_FALSE;
+    }
+
+    m_stAttr = stAttr;
+    for (AX_U32 i = 0; i < m_stAttr.nGrpCount; ++i) {
+        if (0 == m_stAttr.arrWeight[i]) {
+            m_stAttr.arrWeight[i] = 1;
+        }
+
+        m_arrCurWeight[i] = 0;
+        m_arrCredit[i] = DETECT_SCHED_MAX_CREDIT;
+        m_arrLastReadyUs[i] = 0;
+        m_arrStat[i] = DETECT_SCHED_GRP_STAT_T();
+    }
+    m_nLastPlanUs = 0;
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_nServiceUs = 0;
+    m_nLastResultUs = 0;
+    return AX_TRUE;
+}
+
+AX_U32 CDetectScheduler::Schedule(AX_U32 nReadyMask, AX_U32 nInflight, AX_U64 nNowUs, AX_U8 arrOrder[DETECT_SCHED_MAX_GROUP_NUM],
+                                  AX_U32& nSkipMask) {
+    const AX_U32 nGrpCount = m_stAttr.nGrpCount;
+    nSkipMask = 0;
+
+    AX_U64 nElapsedUs = (0 == m_nLastPlanUs || nNowUs < m_nLastPlanUs) ? 0 : nNowUs - m_nLastPlanUs;
+    m_nLastPlanUs = nNowUs;
+
+    for (AX_U32 i = 0; i < nGrpCount; ++i) {
+        if (nReadyMask & (1U << i)) {
+            m_arrLastReadyUs[i] = nNowUs;
+        }
+    }
+
+    const AX_U32 nServiceUs = GetServiceTime();
+    const AX_BOOL bSkip = (m_stAttr.bAdaptiveSkip && nServiceUs > 0) ? AX_TRUE : AX_FALSE;
+    if (bSkip) {
+        /* NPU sends 1 / nServiceUs frames per us, shared by active groups according to weight */
+        AX_F64 fRate = (AX_F64)nElapsedUs / ((AX_F64)GetActiveWeight(nNowUs) * nServiceUs);
+        for (AX_U32 i = 0; i < nGrpCount; ++i) {
+            if (nNowUs - m_arrLastReadyUs[i] <= DETECT_SCHED_ACTIVE_WINDOW_US) {
+                m_arrCredit[i] += fRate * m_stAttr.arrWeight[i];
+                if (m_arrCredit[i] > DETECT_SCHED_MAX_CREDIT) {
+                    m_arrCredit[i] = DETECT_SCHED_MAX_CREDIT;
+                }
+            }
+        }
+    }
+
+    AX_U32 nCandMask = 0;
+    AX_S64 nTotalWeight = 0;
+    for (AX_U32 i = 0; i < nGrpCount; ++i) {
+        if (0 == (nReadyMask & (1U << i))) {
+            continue;
+        }
+
+        if (bSkip && m_arrCredit[i] < 1.0 && nInflight > 1) {
+            nSkipMask |= (1U << i);
+            m_arrStat[i].nSkip++;
+            continue;
+        }
+
+        nCandMask |= (1U << i);
+        nTotalWeight += m_stAttr.arrWeight[i];
+    }
+
+    if (0 == nCandMask) {
+        return 0;
+    }
+
+    /* one step of smooth weighted round robin picks the leader, the others follow by current weight */
+    for (AX_U32 i = 0; i < nGrpCount; ++i) {
+        if (nCandMask & (1U << i)) {
+            m_arrCurWeight[i] += m_stAttr.arrWeight[i];
+        }
+    }
+
+    AX_U32 nCount = 0;
+    while (nCandMask) {
+        AX_S32 nPick = -1;
+        for (AX_U32 i = 0; i < nGrpCount; ++i) {
+            if ((nCandMask & (1U << i)) && (nPick < 0 || m_arrCurWeight[i] > m_arrCurWeight[nPick])) {
+                nPick = (AX_S32)i;
+            }
+        }
+
+        if (0 == nCount) {
+            m_arrCurWeight[nPick] -= nTotalWeight;
+        }
+
+        arrOrder[nCount++] = (AX_U8)nPick;
+        nCandMask &= ~(1U << nPick);
+    }
+
+    return nCount;
+}
+
+AX_VOID CDetectScheduler::OnSubmit(AX_U32 nGrp) {
+    if (nGrp >= m_stAttr.nGrpCount) {
+        return;
+    }
+
+    /* frame sent on idle NPU without credit does not go into debt */
+    m_arrCredit[nGrp] = (m_arrCredit[nGrp] >= 1.0) ? m_arrCredit[nGrp] - 1.0 : 0.0;
+    m_arrStat[nGrp].nSubmit++;
+}
+
+AX_VOID CDetectScheduler::OnResult(AX_U64 nSubmitUs, AX_U64 nNowUs) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+
+    /* NPU starts the frame when it is sent or when previous result is out, whichever is later */
+    AX_U64 nStartUs = (nSubmitUs > m_nLastResultUs) ? nSubmitUs : m_nLastResultUs;
+    if (nNowUs > m_nLastResultUs) {
+        m_nLastResultUs = nNowUs;
+    }
+
+    if (nNowUs <= nStartUs) {
+        return;
+    }
+
+    AX_S64 nSample = (AX_S64)(nNowUs - nStartUs);
+    if (0 == m_nServiceUs) {
+        m_nServiceUs = (AX_U32)nSample;
+    } else {
+        /* EMA with alpha 1/8 */
+        m_nServiceUs = (AX_U32)((AX_S64)m_nServiceUs + (nSample - (AX_S64)m_nServiceUs) / 8);
+    }
+}
+
+AX_U32 CDetectScheduler::GetServiceTime(AX_VOID) const {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    return m_nServiceUs;
+}
+
+DETECT_SCHED_GRP_STAT_T CDetectScheduler::GetGrpStat(AX_U32 nGrp) const {
+    return (nGrp < m_stAttr.nGrpCount) ? m_arrStat[nGrp] : DETECT_SCHED_GRP_STAT_T();
+}
+
+AX_U32 CDetectScheduler::GetActiveWeight(AX_U64 nNowUs) const {
+    AX_U32 nWeight = 0;
+    for (AX_U32 i = 0; i < m_stAttr.nGrpCount; ++i) {
+        if (nNowUs - m_arrLastReadyUs[i] <= DETECT_SCHED_ACTIVE_WINDOW_US) {
+            nWeight += m_stAttr.arrWeight[i];
+        }
+    }
+
+    return (0 == nWeight) ? 1 : nWeight;
+}
@@ -0,0 +1,86 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+#include <mutex>
+#include "ax_base_type.h"
+
+#define DETECT_SCHED_MAX_GROUP_NUM (8)
+
+typedef enum {
+    DETECT_SCHED_MODE_POLL = 0,  /* poll group queues and send one frame per loop */
+    DETECT_SCHED_MODE_BATCH = 1, /* collect ready frames of all groups within budget and send them together */
+    DETECT_SCHED_MODE_BUTT
+} DETECT_SCHED_MODE_E;
+
+typedef struct {
+    AX_U32 nGrpCount{0};
+    AX_U32 arrWeight[DETECT_SCHED_MAX_GROUP_NUM]{1, 1, 1, 1, 1, 1, 1, 1};
+    AX_BOOL bAdaptiveSkip{AX_TRUE};
+} DETECT_SCHED_ATTR_T;
+
+typedef struct {
+    AX_U64 nSubmit{0};
+    AX_U64 nSkip{0};
+} DETECT_SCHED_GRP_STAT_T;
+
+/**
+ * @brief Decide which ready groups a batch sends and in which order.
+ *
+ *  Order: smooth weighted round robin over ready groups, so a group of weight 2 goes first twice as often.
+ *  Skip: each group earns credit at its weighted share of NPU throughput, measured from result callbacks.
+ *        A frame without credit is skipped only while NPU is behind (more than one frame in flight),
+ *        idle capacity is never wasted.
+ *  No SDK dependency, time is passed in by caller, so it can be driven by any backend.
+ */
+class CDetectScheduler final {
+public:
+    CDetectScheduler(AX_VOID) = default;
+    ~CDetectScheduler(AX_VOID) = default;
+
+    AX_BOOL Init(const DETECT_SCHED_ATTR_T& stAttr);
+
+    /**
+     * @brief plan a batch
+     * @param nReadyMask  bit i set if group i has a frame
+     * @param nInflight   frames sent and waiting for result
+     * @param arrOrder    [out] groups to send, in order
+     * @param nSkipMask   [out] ready groups whose frame should be dropped
+     * @return count of arrOrder
+     */
+    AX_U32 Schedule(AX_U32 nReadyMask, AX_U32 nInflight, AX_U64 nNowUs, AX_U8 arrOrder[DETECT_SCHED_MAX_GROUP_NUM], AX_U32& nSkipMask);
+
+    /* frame of group is sent successfully */
+    AX_VOID OnSubmit(AX_U32 nGrp);
+    /* result of frame sent at nSubmitUs arrives */
+    AX_VOID OnResult(AX_U64 nSubmitUs, AX_U64 nNowUs);
+
+    /* smoothed NPU time of one frame, 0 before first result */
+    AX_U32 GetServiceTime(AX_VOID) const;
+    DETECT_SCHED_GRP_STAT_T GetGrpStat(AX_U32 nGrp) const;
+
+private:
+    AX_U32 GetActiveWeight(AX_U64 nNowUs) const;
+
+private:
+    DETECT_SCHED_ATTR_T m_stAttr;
+
+    /* detect thread only */
+    AX_S64 m_arrCurWeight[DETECT_SCHED_MAX_GROUP_NUM]{0};
+    AX_F64 m_arrCredit[DETECT_SCHED_MAX_GROUP_NUM]{0};
+    AX_U64 m_arrLastReadyUs[DETECT_SCHED_MAX_GROUP_NUM]{0};
+    AX_U64 m_nLastPlanUs{0};
+    DETECT_SCHED_GRP_STAT_T m_arrStat[DETECT_SCHED_MAX_GROUP_NUM];
+
+    /* shared with result callback */
+    mutable std::mutex m_mtx;
+    AX_U32 m_nServiceUs{0};
+    AX_U64 m_nLastResultUs{0};
+};
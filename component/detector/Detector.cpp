@@ -17,12 +17,17 @@
 #include "attrParser.hpp"
 #include "AXTypeConverter.hpp"
 #include "SensorOptionHelper.h"
+#include <chrono>
 
 #include "WebServer.h"
 
 #define DETECTOR "DETECTOR"
 
 namespace {
+static AX_U64 GetTickCountUs(AX_VOID) {
+    return (AX_U64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 static AX_VOID SkelResult2DetectResult(DETECT_RESULT_T &hvcfp, const AX_SKEL_RESULT_T *pstResult, CDetector *pThis) {
     hvcfp.nW = pstResult->nOriginalWidth;
     hvcfp.nH = pstResult->nOriginalHeight;
@@ -154,11 +159,17 @@ static AX_VOID SkelResultCallback(AX_SKEL_HANDLE pHandle, AX_SKEL_RESULT_T *pstR
         THROW_AX_EXCEPTION("skel handle %p result callback user data is nil", pHandle);
         return;
     }
-    SKEL_FRAME_PRIVATE_DATA_T *pPrivData = (SKEL_FRAME_PRIVATE_DATA_T *)(pstResult->pUserData);
-    if (!pPrivData) {
+    AX_U32 nHandle = (AX_U32)(uintptr_t)(pstResult->pUserData);
+    if (AX_SLOT_POOL_INVALID_HANDLE == nHandle) {
         THROW_AX_EXCEPTION("skel handle %p frame private data is nil", pHandle);
         return;
     }
+
+    SKEL_FRAME_PRIVATE_DATA_T *pPrivData = pThis->FindSkelPrivateData(nHandle);
+    if (!pPrivData) {
+        LOG_MM_W(DETECTOR, "skel handle %p drop result of stale frame private data 0x%x", pHandle, nHandle);
+        return;
+    }
     DETECT_RESULT_T hvcfp;
     hvcfp.u64Pts = pPrivData->u64Pts;
     hvcfp.nSeqNum = pPrivData->nSeqNum;
@@ -167,12 +178,14 @@ static AX_VOID SkelResultCallback(AX_SKEL_HANDLE pHandle, AX_SKEL_RESULT_T *pstR
 
     SkelResult2DetectResult(hvcfp, pstResult, pThis);
 
+    pThis->OnSkelResult(*pPrivData);
+
     pThis->UpdateAeRoi((AX_U32)hvcfp.nSnsId, hvcfp);
 
     pThis->NotifyAll((AX_U32)hvcfp.nSnsId, 0, &hvcfp);
 
     /* giveback private data */
-    pThis->ReleaseSkelPrivateData(pPrivData);
+    pThis->ReleaseSkelPrivateData(nHandle);
 
     pThis->SetSnsDetectResult(hvcfp);
 
@@ -188,7 +201,6 @@ AX_VOID CDetector::RunDetect(AX_VOID *pArg) {
     AX_U8 nNextIndex = 0;
     const AX_U8 nGrpCount = m_stAttr.nGrpCount;
     CAXFrame *pAxFrame{nullptr};
-    AX_SKEL_FRAME_T skelFrame = {0};
     AX_U64 nStartMs = 0;
     AX_U64 nEndMs = 0;
     AX_U32 nFrameCnt = 0;
@@ -213,60 +225,189 @@ AX_VOID CDetector::RunDetect(AX_VOID *pArg) {
             }
         }
 
-        SKEL_FRAME_PRIVATE_DATA_T *pPrivData = GetSkelPrivateData();
-        if (!pPrivData) {
-            LOG_M_E(DETECTOR, "%s: borrow skel frame private data fail", __func__);
-            pAxFrame->FreeMem();
+        SubmitFrame(nFrameQIndex, pAxFrame, nFrameId);
+
+        pAxFrame->FreeMem();
+        nFrameCnt++;
+        nEndMs = CElapsedTimer::GetInstance()->GetTickCount();
+        if ((nEndMs - nStartMs) >= 20 * 1000) {
+            fFps = (1000 / ((AX_F64)(nEndMs - nStartMs) / nFrameCnt));
+            LOG_M_I(DETECTOR, "fps %.2lf, private data in flight %d/%d peak %d, exhausted %lld, stale %lld", fFps,
+                    m_poolSkelData.GetUsedCount(), m_poolSkelData.GetCapacity(), m_poolSkelData.GetPeakCount(),
+                    m_poolSkelData.GetExhaustedCount(), m_poolSkelData.GetStaleCount());
+            nStartMs = CElapsedTimer::GetInstance()->GetTickCount();
+            nFrameCnt = 0;
+        }
+    }
+    LOG_MM_I(DETECTOR, "---");
+}
+
+AX_VOID CDetector::RunBatchDetect(AX_VOID *pArg) {
+    LOG_MM_I(DETECTOR, "+++");
+
+    AX_U64 nFrameId = 0;
+    const AX_U8 nGrpCount = m_stAttr.nGrpCount;
+    CAXFrame *arrFrame[MAX_DETECTOR_GROUP_NUM]{nullptr};
+    AX_U8 arrOrder[DETECT_SCHED_MAX_GROUP_NUM];
+    AX_U32 nActiveMask = 0;
+    AX_U64 nStartMs = CElapsedTimer::GetInstance()->GetTickCount();
+    AX_U64 nEndMs = 0;
+    AX_U32 nFrameCnt = 0;
+    AX_U32 nBatchCnt = 0;
+    while (m_DetectThread.IsRunning()) {
+        /* reset before checking queues, so frame pushed after the check wakes up the wait */
+        m_evtFrameReady.ResetEvent();
+
+        AX_U32 nReadyMask = 0;
+        for (AX_U8 i = 0; i < nGrpCount; ++i) {
+            if (m_arrFrameQ[i].GetCount() > 0) {
+                nReadyMask |= (1U << i);
+            }
+        }
+
+        if (0 == nReadyMask) {
+            m_evtFrameReady.WaitEvent(100);
             continue;
-        } else {
-            pPrivData->u64Pts = pAxFrame->stFrame.stVFrame.stVFrame.u64PTS;
-            pPrivData->nSeqNum = pAxFrame->stFrame.stVFrame.stVFrame.u64SeqNum;
-            pPrivData->nGrpId = m_stAttr.nGrp;
-            pPrivData->nSnsId = m_stAttr.nSnsId[nFrameQIndex];
         }
-        skelFrame.nFrameId = ++nFrameId;
-        skelFrame.nStreamId = m_stAttr.nSnsId[nFrameQIndex];
-        skelFrame.stFrame = pAxFrame->stFrame.stVFrame.stVFrame;
-        skelFrame.pUserData = (void *)pPrivData;
 
-        AX_S32 nTimeOut = -1;
+        /* wait within budget for groups which sent frames recently */
+        AX_U64 nFirstMs = CElapsedTimer::GetInstance()->GetTickCount();
+        nActiveMask |= nReadyMask;
+        while ((nReadyMask & nActiveMask) != nActiveMask && m_DetectThread.IsRunning()) {
+            AX_U64 nWaitMs = CElapsedTimer::GetInstance()->GetTickCount() - nFirstMs;
+            if (nWaitMs >= m_stAttr.nBatchBudgetMs) {
+                /* missing groups fall out of batch until they send again */
+                nActiveMask = nReadyMask;
+                break;
+            }
+
+            m_evtFrameReady.ResetEvent();
+            for (AX_U8 i = 0; i < nGrpCount; ++i) {
+                if (m_arrFrameQ[i].GetCount() > 0) {
+                    nReadyMask |= (1U << i);
+                }
+            }
 
-        if (m_stAttr.fFramerate != 0) {
-            nTimeOut = (AX_S32)(1000. / m_stAttr.fFramerate);
+            if ((nReadyMask & nActiveMask) != nActiveMask) {
+                m_evtFrameReady.WaitEvent((AX_S32)(m_stAttr.nBatchBudgetMs - nWaitMs));
+            }
         }
 
-        AX_S32 ret = AX_SKEL_SendFrame(m_Skel, &skelFrame, nTimeOut);
+        /* take the latest frame of each group, older ones are outdated */
+        nReadyMask = 0;
+        for (AX_U8 i = 0; i < nGrpCount; ++i) {
+            CAXFrame *pAxFrame{nullptr};
+            while (m_arrFrameQ[i].Pop(pAxFrame, 0)) {
+                if (arrFrame[i]) {
+                    arrFrame[i]->FreeMem();
+                }
+                arrFrame[i] = pAxFrame;
+                nReadyMask |= (1U << i);
+            }
+        }
 
-        if (AX_SKEL_SUCC != ret) {
-            ReleaseSkelPrivateData(pPrivData);
-
-            if (AX_ERR_SKEL_QUEUE_FULL != ret
-                && AX_ERR_SKEL_TIMEOUT != ret) {
-                LOG_MM_E(DETECTOR,
-                         "AX_SKEL_SendFrame fail,ret =0x%x, nSnsId:%d vdGrp %d vdChn %d frame %lld pts %lld phy 0x%llx VirAddr:0x%llx %dx%d "
-                         "stride %d blkId "
-                         "0x%x, size:%u",
-                         ret, m_stAttr.nSnsId[nFrameQIndex], pAxFrame->nGrp, pAxFrame->nChn, pAxFrame->stFrame.stVFrame.stVFrame.u64SeqNum,
-                         pAxFrame->stFrame.stVFrame.stVFrame.u64PTS, pAxFrame->stFrame.stVFrame.stVFrame.u64PhyAddr[0],
-                         pAxFrame->stFrame.stVFrame.stVFrame.u64VirAddr[0], pAxFrame->stFrame.stVFrame.stVFrame.u32Width,
-                         pAxFrame->stFrame.stVFrame.stVFrame.u32Height, pAxFrame->stFrame.stVFrame.stVFrame.u32PicStride[0],
-                         pAxFrame->stFrame.stVFrame.stVFrame.u32BlkId[0], pAxFrame->stFrame.stVFrame.stVFrame.u32FrameSize);
+        AX_U32 nSkipMask = 0;
+        AX_U32 nCount = m_scheduler.Schedule(nReadyMask, m_poolSkelData.GetUsedCount(), GetTickCountUs(), arrOrder, nSkipMask);
+        for (AX_U32 i = 0; i < nCount; ++i) {
+            AX_U8 nIndex = arrOrder[i];
+            if (arrFrame[nIndex]) {
+                if (SubmitFrame(nIndex, arrFrame[nIndex], nFrameId)) {
+                    m_scheduler.OnSubmit(nIndex);
+                }
+
+                arrFrame[nIndex]->FreeMem();
+                arrFrame[nIndex] = nullptr;
+                nFrameCnt++;
             }
         }
 
-        pAxFrame->FreeMem();
-        nFrameCnt++;
+        /* skipped by scheduler */
+        for (AX_U8 i = 0; i < nGrpCount; ++i) {
+            if (arrFrame[i]) {
+                arrFrame[i]->FreeMem();
+                arrFrame[i] = nullptr;
+            }
+        }
+
+        nBatchCnt++;
         nEndMs = CElapsedTimer::GetInstance()->GetTickCount();
         if ((nEndMs - nStartMs) >= 20 * 1000) {
-            fFps = (1000 / ((AX_F64)(nEndMs - nStartMs) / nFrameCnt));
-            LOG_M_I(DETECTOR, "fps %.2lf", fFps);
-            nStartMs = CElapsedTimer::GetInstance()->GetTickCount();
+            LOG_M_I(DETECTOR, "fps %.2lf, %d batches of avg %.2lf frames, npu %d us/frame", (1000 / ((AX_F64)(nEndMs - nStartMs) / nFrameCnt)),
+                    nBatchCnt, (AX_F64)nFrameCnt / nBatchCnt, m_scheduler.GetServiceTime());
+            LOG_M_I(DETECTOR, "private data in flight %d/%d peak %d, exhausted %lld, stale %lld", m_poolSkelData.GetUsedCount(),
+                    m_poolSkelData.GetCapacity(), m_poolSkelData.GetPeakCount(), m_poolSkelData.GetExhaustedCount(),
+                    m_poolSkelData.GetStaleCount());
+            for (AX_U8 i = 0; i < nGrpCount; ++i) {
+                DETECT_SCHED_GRP_STAT_T tStat = m_scheduler.GetGrpStat(i);
+                LOG_M_I(DETECTOR, "sns %d: submit %lld, skip %lld", m_stAttr.nSnsId[i], tStat.nSubmit, tStat.nSkip);
+            }
+            nStartMs = nEndMs;
             nFrameCnt = 0;
+            nBatchCnt = 0;
         }
     }
     LOG_MM_I(DETECTOR, "---");
 }
 
+AX_BOOL CDetector::SubmitFrame(AX_U8 nFrameQIndex, CAXFrame *pAxFrame, AX_U64 &nFrameId) {
+    AX_U32 nPrivHandle = AX_SLOT_POOL_INVALID_HANDLE;
+    SKEL_FRAME_PRIVATE_DATA_T *pPrivData = GetSkelPrivateData(nPrivHandle);
+    if (!pPrivData) {
+        /* all slots wait for results, NPU is behind */
+        LOG_M_W(DETECTOR, "%s: borrow skel frame private data fail, %d in flight, exhausted %lld times", __func__,
+                m_poolSkelData.GetUsedCount(), m_poolSkelData.GetExhaustedCount());
+        return AX_FALSE;
+    } else {
+        pPrivData->u64Pts = pAxFrame->stFrame.stVFrame.stVFrame.u64PTS;
+        pPrivData->nSeqNum = pAxFrame->stFrame.stVFrame.stVFrame.u64SeqNum;
+        pPrivData->nGrpId = m_stAttr.nGrp;
+        pPrivData->nSnsId = m_stAttr.nSnsId[nFrameQIndex];
+        pPrivData->nQIndex = nFrameQIndex;
+        pPrivData->u64SubmitUs = GetTickCountUs();
+    }
+
+    AX_SKEL_FRAME_T skelFrame = {0};
+    skelFrame.nFrameId = ++nFrameId;
+    skelFrame.nStreamId = m_stAttr.nSnsId[nFrameQIndex];
+    skelFrame.stFrame = pAxFrame->stFrame.stVFrame.stVFrame;
+    skelFrame.pUserData = (void *)(uintptr_t)nPrivHandle;
+
+    AX_S32 nTimeOut = -1;
+
+    if (m_stAttr.fFramerate != 0) {
+        nTimeOut = (AX_S32)(1000. / m_stAttr.fFramerate);
+    }
+
+    AX_S32 ret = AX_SKEL_SendFrame(m_Skel, &skelFrame, nTimeOut);
+
+    if (AX_SKEL_SUCC != ret) {
+        ReleaseSkelPrivateData(nPrivHandle);
+
+        if (AX_ERR_SKEL_QUEUE_FULL != ret
+            && AX_ERR_SKEL_TIMEOUT != ret) {
+            LOG_MM_E(DETECTOR,
+                     "AX_SKEL_SendFrame fail,ret =0x%x, nSnsId:%d vdGrp %d vdChn %d frame %lld pts %lld phy 0x%llx VirAddr:0x%llx %dx%d "
+                     "stride %d blkId "
+                     "0x%x, size:%u",
+                     ret, m_stAttr.nSnsId[nFrameQIndex], pAxFrame->nGrp, pAxFrame->nChn, pAxFrame->stFrame.stVFrame.stVFrame.u64SeqNum,
+                     pAxFrame->stFrame.stVFrame.stVFrame.u64PTS, pAxFrame->stFrame.stVFrame.stVFrame.u64PhyAddr[0],
+                     pAxFrame->stFrame.stVFrame.stVFrame.u64VirAddr[0], pAxFrame->stFrame.stVFrame.stVFrame.u32Width,
+                     pAxFrame->stFrame.stVFrame.stVFrame.u32Height, pAxFrame->stFrame.stVFrame.stVFrame.u32PicStride[0],
+                     pAxFrame->stFrame.stVFrame.stVFrame.u32BlkId[0], pAxFrame->stFrame.stVFrame.stVFrame.u32FrameSize);
+        }
+
+        return AX_FALSE;
+    }
+
+    return AX_TRUE;
+}
+
+AX_VOID CDetector::OnSkelResult(const SKEL_FRAME_PRIVATE_DATA_T &tPrivData) {
+    if (DETECT_SCHED_MODE_BATCH == m_stAttr.eSchedMode) {
+        m_scheduler.OnResult(tPrivData.u64SubmitUs, GetTickCountUs());
+    }
+}
+
 AX_BOOL CDetector::Init(const DETECTOR_ATTR_T &stAttr) {
     LOG_MM_I(DETECTOR, "+++");
 
@@ -285,9 +426,39 @@ AX_BOOL CDetector::Init(const DETECTOR_ATTR_T &stAttr) {
     m_stAttr.nFrameDepth = stAttr.nFrameDepth;
     m_stAttr.strModelPath = stAttr.strModelPath;
     m_stAttr.nGrp = stAttr.nGrp;
+    m_stAttr.nInflightNum = (0 == stAttr.nInflightNum) ? MAX_DETECTOR_PRIVATE_DATA_NUM : stAttr.nInflightNum;
+    if (m_stAttr.nInflightNum > MAX_DETECTOR_INFLIGHT_NUM) {
+        m_stAttr.nInflightNum = MAX_DETECTOR_INFLIGHT_NUM;
+    }
 
-    LOG_MM_I(DETECTOR, "m_stAttr.width:%d, height:%d, nGrpCount: %d, modelPath:%s",
-                        m_stAttr.nWidth, m_stAttr.nHeight, m_stAttr.nGrpCount, m_stAttr.strModelPath.c_str());
+    if (!m_poolSkelData.Init(m_stAttr.nInflightNum)) {
+        LOG_MM_E(DETECTOR, "alloc %d frame private data fail", m_stAttr.nInflightNum);
+        delete[] m_arrFrameQ;
+        m_arrFrameQ = nullptr;
+        return AX_FALSE;
+    }
+
+    m_stAttr.eSchedMode = stAttr.eSchedMode;
+    m_stAttr.nBatchBudgetMs = stAttr.nBatchBudgetMs;
+    m_stAttr.bAdaptiveSkip = stAttr.bAdaptiveSkip;
+    memcpy(m_stAttr.nSnsWeight, stAttr.nSnsWeight, sizeof(m_stAttr.nSnsWeight));
+    if (DETECT_SCHED_MODE_BATCH == m_stAttr.eSchedMode) {
+        DETECT_SCHED_ATTR_T tSchedAttr;
+        tSchedAttr.nGrpCount = m_stAttr.nGrpCount;
+        tSchedAttr.bAdaptiveSkip = m_stAttr.bAdaptiveSkip;
+        for (AX_U32 i = 0; i < m_stAttr.nGrpCount; ++i) {
+            AX_S8 nSnsId = m_stAttr.nSnsId[i];
+            tSchedAttr.arrWeight[i] = (nSnsId >= 0 && nSnsId < AX_APP_ALGO_SNS_MAX) ? m_stAttr.nSnsWeight[nSnsId] : 1;
+        }
+
+        if (!m_scheduler.Init(tSchedAttr)) {
+            LOG_MM_W(DETECTOR, "init batch scheduler of %d groups fail, fall back to poll mode", m_stAttr.nGrpCount);
+            m_stAttr.eSchedMode = DETECT_SCHED_MODE_POLL;
+        }
+    }
+
+    LOG_MM_I(DETECTOR, "m_stAttr.width:%d, height:%d, nGrpCount: %d, inflight: %d, sched mode: %d, modelPath:%s", m_stAttr.nWidth,
+             m_stAttr.nHeight, m_stAttr.nGrpCount, m_stAttr.nInflightNum, m_stAttr.eSchedMode, m_stAttr.strModelPath.c_str());
     /* [1]: SKEL init */
     AX_SKEL_INIT_PARAM_T stInit;
     AX_S32 ret = 0;
@@ -523,7 +694,8 @@ AX_BOOL CDetector::Start(AX_VOID) {
     if (m_initState) {
         LOG_MM_I(DETECTOR, "+++");
 
-        if (!m_DetectThread.Start(std::bind(&CDetector::RunDetect, this, std::placeholders::_1), nullptr, "APP_DETECT")) {
+        auto fnRun = (DETECT_SCHED_MODE_BATCH == m_stAttr.eSchedMode) ? &CDetector::RunBatchDetect : &CDetector::RunDetect;
+        if (!m_DetectThread.Start(std::bind(fnRun, this, std::placeholders::_1), nullptr, "APP_DETECT")) {
             LOG_MM_E(DETECTOR, "create detect thread fail");
             return AX_FALSE;
         }
@@ -543,6 +715,7 @@ AX_BOOL CDetector::Stop(AX_VOID) {
                 m_arrFrameQ[i].Wakeup();
             }
         }
+        m_evtFrameReady.SetEvent();
 
         m_DetectThread.Join();
 
@@ -579,7 +752,16 @@ AX_BOOL CDetector::SendFrame(AX_U8 nSnsId, CAXFrame *paxFrame) {
         }
 
         if (i < m_stAttr.nGrpCount) {
-            if (!m_arrFrameQ[i].Push(paxFrame)) {
+            if (DETECT_SCHED_MODE_BATCH == m_stAttr.eSchedMode) {
+                /* batch thread only sends the latest frame, drop the oldest instead of stalling the sender */
+                CAXFrame *pOldest{nullptr};
+                while (!m_arrFrameQ[i].Push(paxFrame)) {
+                    if (m_arrFrameQ[i].Pop(pOldest, 0)) {
+                        pOldest->FreeMem();
+                    }
+                }
+                m_evtFrameReady.SetEvent();
+            } else if (!m_arrFrameQ[i].Push(paxFrame)) {
                 paxFrame->FreeMem();
                 CElapsedTimer::GetInstance()->mSleep(1);
             }
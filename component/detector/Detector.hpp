@@ -12,18 +12,23 @@
 #include <vector>
 #include <mutex>
 #include "AXAlgo.hpp"
+#include "AXEvent.hpp"
 #include "AXFrame.hpp"
 #include "AXLockQ.hpp"
 #include "AXResource.hpp"
+#include "AXSlotPool.hpp"
 #include "AXThread.hpp"
 #include "IObserver.h"
 #include "WebServer.h"
 #include "ax_skel_api.h"
 #include "DetectResult.hpp"
+#include "DetectScheduler.hpp"
 #include "SensorMgr.h"
 
 #define MAX_DETECTOR_GROUP_NUM (3)
+/* default frames in flight between AX_SKEL_SendFrame and result callback */
 #define MAX_DETECTOR_PRIVATE_DATA_NUM (8)
+#define MAX_DETECTOR_INFLIGHT_NUM (1024)
 
 typedef struct _DETECTOR_ATTR_T {
     AX_U8 nGrpCount{0};
@@ -35,6 +40,11 @@ typedef struct _DETECTOR_ATTR_T {
     AX_U32 nHeight{0};
     AX_F32 fFramerate{0};
     AX_S8 nSnsId[MAX_DETECTOR_GROUP_NUM]{-1, -1, -1};
+    AX_U32 nInflightNum{MAX_DETECTOR_PRIVATE_DATA_NUM}; /* private data slots */
+    DETECT_SCHED_MODE_E eSchedMode{DETECT_SCHED_MODE_POLL};
+    AX_U32 nBatchBudgetMs{5};                        /* batch mode: wait for other groups after first frame is ready */
+    AX_U32 nSnsWeight[AX_APP_ALGO_SNS_MAX]{1, 1, 1}; /* batch mode: NPU share of each sensor */
+    AX_BOOL bAdaptiveSkip{AX_TRUE};                  /* batch mode: skip frames by measured inference time */
 } DETECTOR_ATTR_T;
 
 typedef struct {
@@ -43,7 +53,8 @@ typedef struct {
     AX_S32 nGrpId{0};
     AX_S32 nChnId{0};
     AX_S8 nSnsId{0};
-    AX_S8 nRefCnt{0};
+    AX_U8 nQIndex{0};
+    AX_U64 u64SubmitUs{0};
 } SKEL_FRAME_PRIVATE_DATA_T;
 
 /**
@@ -76,25 +87,23 @@ public:
 
     AX_VOID Enable(AX_U8 nSnsId, AX_BOOL bEnable = AX_TRUE);
 
-    SKEL_FRAME_PRIVATE_DATA_T* GetSkelPrivateData(AX_VOID) {
-        std::lock_guard<std::mutex> lck(m_mtxSkelData);
-        for (AX_U32 i = 0; i < MAX_DETECTOR_PRIVATE_DATA_NUM; i++) {
-            if (m_skelData[i].nRefCnt == 0) {
-                m_skelData[i].nRefCnt = 1;
-                return &m_skelData[i];
-            }
-        }
+    /* nHandle is passed to SKEL as frame user data */
+    SKEL_FRAME_PRIVATE_DATA_T* GetSkelPrivateData(AX_U32& nHandle) {
+        return m_poolSkelData.Acquire(nHandle);
+    }
 
-        return nullptr;
+    /* nullptr if nHandle is already released, e.g. result of a frame sent before restart */
+    SKEL_FRAME_PRIVATE_DATA_T* FindSkelPrivateData(AX_U32 nHandle) {
+        return m_poolSkelData.Get(nHandle);
     }
 
-    AX_VOID ReleaseSkelPrivateData(SKEL_FRAME_PRIVATE_DATA_T* pData) {
-        if (pData) {
-            std::lock_guard<std::mutex> lck(m_mtxSkelData);
-            pData->nRefCnt = 0;
-        }
+    AX_VOID ReleaseSkelPrivateData(AX_U32 nHandle) {
+        m_poolSkelData.Release(nHandle);
     }
 
+    /* result of frame is out, feed inference time to scheduler */
+    AX_VOID OnSkelResult(const SKEL_FRAME_PRIVATE_DATA_T& tPrivData);
+
     AX_VOID NotifyAll(AX_U32 nSnsId, AX_U32 nChn, AX_VOID* pStream);
 
     AX_S32 SetSkelPushMode(AX_U32 nSnsId, AI_PUSH_STATEGY_T& stStrategy);
@@ -120,6 +129,8 @@ public:
 
 protected:
     AX_VOID RunDetect(AX_VOID* pArg);
+    AX_VOID RunBatchDetect(AX_VOID* pArg);
+    AX_BOOL SubmitFrame(AX_U8 nFrameQIndex, CAXFrame* pAxFrame, AX_U64& nFrameId);
     AX_VOID ClearQueue(AX_S32 nIndex);
 
 private:
@@ -140,8 +151,9 @@ private:
     std::vector<IObserver*> m_vecObserver;
     AX_BOOL m_initState{AX_FALSE};
     AX_BOOL m_arrSnsAiEnable[AX_APP_ALGO_SNS_MAX]{AX_TRUE, AX_TRUE,  AX_TRUE};
-    SKEL_FRAME_PRIVATE_DATA_T m_skelData[MAX_DETECTOR_PRIVATE_DATA_NUM];
-    std::mutex  m_mtxSkelData;
+    CAXSlotPool<SKEL_FRAME_PRIVATE_DATA_T> m_poolSkelData;
+    CDetectScheduler m_scheduler;
+    CAXEvent m_evtFrameReady;
     CSensorMgr* m_pSensorMgr{nullptr};
     std::map<AX_U8, AX_BOOL> m_mapSnsAiEnable;
 };
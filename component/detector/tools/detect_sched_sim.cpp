@@ -0,0 +1,299 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+/*
+    Discrete-event simulation of CDetector batch mode on a mock NPU, drives the real CDetectScheduler.
+
+    mock NPU:  serial server, one frame takes nServiceUs (+/- jitter), at most SIM_MAX_INFLIGHT frames sent and not answered,
+               same as the private data pool of CDetector. Results come back in send order.
+    sensors:   each group delivers a frame every period, the group queue keeps the latest frame only.
+    detector:  same loop as CDetector::DetectThreadFunc in batch mode, plans when every active group is ready
+               or SIM_BATCH_BUDGET_US after the first frame.
+
+    Every scenario checks its expectation and the program exits non-zero if one fails.
+
+    usage: detect_sched_sim [seconds]
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <deque>
+#include "DetectScheduler.hpp"
+
+#define SIM_MAX_INFLIGHT (8) /* MAX_DETECTOR_PRIVATE_DATA_NUM */
+#define SIM_BATCH_BUDGET_US (5000)
+#define SIM_NEVER (~0ULL)
+
+typedef struct {
+    AX_U64 nSubmitUs;
+    AX_U64 nCaptureUs;
+    AX_U32 nGrp;
+} NPU_JOB_T;
+
+/* serial NPU with bounded in-flight frames */
+class CMockNpu {
+public:
+    CMockNpu(AX_U32 nServiceUs, AX_U32 nJitterUs) : m_nServiceUs(nServiceUs), m_nJitterUs(nJitterUs) {
+    }
+
+    AX_BOOL Submit(AX_U32 nGrp, AX_U64 nCaptureUs, AX_U64 nNowUs) {
+        if (m_dqJobs.size() >= SIM_MAX_INFLIGHT) {
+            return AX_FALSE;
+        }
+
+        AX_U64 nStartUs = (nNowUs > m_nBusyUntilUs) ? nNowUs : m_nBusyUntilUs;
+        AX_U32 nCost = m_nServiceUs;
+        if (m_nJitterUs > 0) {
+            nCost += rand() % (2 * m_nJitterUs + 1);
+            nCost -= m_nJitterUs;
+        }
+
+        m_nBusyUs += nCost;
+        m_nBusyUntilUs = nStartUs + nCost;
+        m_dqJobs.push_back({nNowUs, nCaptureUs, nGrp});
+        m_dqDoneUs.push_back(m_nBusyUntilUs);
+        return AX_TRUE;
+    }
+
+    AX_U64 NextResultUs(AX_VOID) const {
+        return m_dqDoneUs.empty() ? SIM_NEVER : m_dqDoneUs.front();
+    }
+
+    /* pop one result due at or before nNowUs */
+    AX_BOOL PopResult(AX_U64 nNowUs, NPU_JOB_T& tJob, AX_U64& nDoneUs) {
+        if (m_dqDoneUs.empty() || m_dqDoneUs.front() > nNowUs) {
+            return AX_FALSE;
+        }
+
+        tJob = m_dqJobs.front();
+        nDoneUs = m_dqDoneUs.front();
+        m_dqJobs.pop_front();
+        m_dqDoneUs.pop_front();
+        return AX_TRUE;
+    }
+
+    AX_U32 GetInflight(AX_VOID) const {
+        return (AX_U32)m_dqJobs.size();
+    }
+
+    AX_U64 GetBusyUs(AX_VOID) const {
+        return m_nBusyUs;
+    }
+
+private:
+    AX_U32 m_nServiceUs;
+    AX_U32 m_nJitterUs;
+    AX_U64 m_nBusyUntilUs{0};
+    AX_U64 m_nBusyUs{0};
+    std::deque<NPU_JOB_T> m_dqJobs;
+    std::deque<AX_U64> m_dqDoneUs;
+};
+
+typedef struct {
+    const AX_CHAR* pszName;
+    AX_U32 nGrpCount;
+    AX_U32 arrWeight[DETECT_SCHED_MAX_GROUP_NUM];
+    AX_U32 arrPeriodUs[DETECT_SCHED_MAX_GROUP_NUM];
+    AX_U32 nServiceUs;
+    AX_U32 nJitterUs;
+    /* expectation */
+    AX_BOOL bExpectNoSkip;                             /* NPU has capacity for every frame */
+    AX_F64 arrExpectShare[DETECT_SCHED_MAX_GROUP_NUM]; /* share of results per group, 0: not checked */
+    AX_F64 fShareTolerance;
+} SIM_SCENARIO_T;
+
+typedef struct {
+    AX_U64 nFrames{0};   /* delivered by sensor */
+    AX_U64 nReplaced{0}; /* overwritten in group queue before planned */
+    AX_U64 nResults{0};
+    AX_U64 nLatencySumUs{0}; /* capture to result */
+    AX_U64 nLatencyMaxUs{0};
+} SIM_GRP_STAT_T;
+
+static AX_BOOL RunScenario(const SIM_SCENARIO_T& tScen, AX_U64 nDurationUs) {
+    const AX_U32 nGrpCount = tScen.nGrpCount;
+    DETECT_SCHED_ATTR_T tAttr;
+    tAttr.nGrpCount = nGrpCount;
+    for (AX_U32 i = 0; i < nGrpCount; ++i) {
+        tAttr.arrWeight[i] = tScen.arrWeight[i];
+    }
+
+    CDetectScheduler scheduler;
+    if (!scheduler.Init(tAttr)) {
+        printf("[%s] Init failed\n", tScen.pszName);
+        return AX_FALSE;
+    }
+
+    CMockNpu npu(tScen.nServiceUs, tScen.nJitterUs);
+    SIM_GRP_STAT_T arrStat[DETECT_SCHED_MAX_GROUP_NUM];
+    AX_U64 arrNextFrameUs[DETECT_SCHED_MAX_GROUP_NUM];
+    AX_U64 arrQueuedUs[DETECT_SCHED_MAX_GROUP_NUM]; /* capture time of latest frame in group queue, SIM_NEVER: empty */
+    for (AX_U32 i = 0; i < nGrpCount; ++i) {
+        arrNextFrameUs[i] = 1000 * i; /* sensors are not in phase */
+        arrQueuedUs[i] = SIM_NEVER;
+    }
+
+    AX_U32 nActiveMask = 0;
+    AX_U64 nBatchDeadlineUs = SIM_NEVER;
+    AX_U64 nBatches = 0;
+    AX_U64 nNowUs = 0;
+    while (nNowUs < nDurationUs) {
+        /* next event: frame, result or end of batch budget */
+        AX_U64 nNextUs = npu.NextResultUs();
+        for (AX_U32 i = 0; i < nGrpCount; ++i) {
+            if (arrNextFrameUs[i] < nNextUs) {
+                nNextUs = arrNextFrameUs[i];
+            }
+        }
+        if (nBatchDeadlineUs < nNextUs) {
+            nNextUs = nBatchDeadlineUs;
+        }
+        nNowUs = nNextUs;
+
+        NPU_JOB_T tJob;
+        AX_U64 nDoneUs = 0;
+        while (npu.PopResult(nNowUs, tJob, nDoneUs)) {
+            scheduler.OnResult(tJob.nSubmitUs, nDoneUs);
+            SIM_GRP_STAT_T& tStat = arrStat[tJob.nGrp];
+            AX_U64 nLatency = nDoneUs - tJob.nCaptureUs;
+            tStat.nResults++;
+            tStat.nLatencySumUs += nLatency;
+            if (nLatency > tStat.nLatencyMaxUs) {
+                tStat.nLatencyMaxUs = nLatency;
+            }
+        }
+
+        AX_U32 nReadyMask = 0;
+        for (AX_U32 i = 0; i < nGrpCount; ++i) {
+            if (arrNextFrameUs[i] <= nNowUs) {
+                if (arrQueuedUs[i] != SIM_NEVER) {
+                    arrStat[i].nReplaced++;
+                }
+                arrQueuedUs[i] = arrNextFrameUs[i];
+                arrNextFrameUs[i] += tScen.arrPeriodUs[i];
+                arrStat[i].nFrames++;
+            }
+
+            if (arrQueuedUs[i] != SIM_NEVER) {
+                nReadyMask |= (1U << i);
+            }
+        }
+
+        if (0 == nReadyMask) {
+            continue;
+        }
+
+        /* batch window: wait for groups which sent recently, within budget */
+        if (SIM_NEVER == nBatchDeadlineUs) {
+            nBatchDeadlineUs = nNowUs + SIM_BATCH_BUDGET_US;
+            nActiveMask |= nReadyMask;
+        }
+
+        if ((nReadyMask & nActiveMask) != nActiveMask) {
+            if (nNowUs < nBatchDeadlineUs) {
+                continue;
+            }
+
+            /* missing groups fall out of batch until they send again */
+            nActiveMask = nReadyMask;
+        }
+        nBatchDeadlineUs = SIM_NEVER;
+
+        AX_U8 arrOrder[DETECT_SCHED_MAX_GROUP_NUM];
+        AX_U32 nSkipMask = 0;
+        AX_U32 nCount = scheduler.Schedule(nReadyMask, npu.GetInflight(), nNowUs, arrOrder, nSkipMask);
+        for (AX_U32 i = 0; i < nCount; ++i) {
+            AX_U32 nGrp = arrOrder[i];
+            if (npu.Submit(nGrp, arrQueuedUs[nGrp], nNowUs)) {
+                scheduler.OnSubmit(nGrp);
+            }
+        }
+
+        /* sent, skipped, or dropped on exhausted pool */
+        for (AX_U32 i = 0; i < nGrpCount; ++i) {
+            arrQueuedUs[i] = SIM_NEVER;
+        }
+        nBatches++;
+    }
+
+    AX_F64 fSeconds = nDurationUs / 1e6;
+    AX_U64 nTotalResults = 0;
+    AX_U64 nTotalSkip = 0;
+    for (AX_U32 i = 0; i < nGrpCount; ++i) {
+        nTotalResults += arrStat[i].nResults;
+        nTotalSkip += scheduler.GetGrpStat(i).nSkip;
+    }
+
+    printf("[%s] npu %.1f fps (%u us), busy %.1f%%, %llu batches, measured service %u us\n", tScen.pszName, 1e6 / tScen.nServiceUs,
+           tScen.nServiceUs, 100.0 * npu.GetBusyUs() / nDurationUs, nBatches, scheduler.GetServiceTime());
+
+    AX_BOOL bOk = AX_TRUE;
+    for (AX_U32 i = 0; i < nGrpCount; ++i) {
+        const SIM_GRP_STAT_T& tStat = arrStat[i];
+        DETECT_SCHED_GRP_STAT_T tSched = scheduler.GetGrpStat(i);
+        AX_F64 fShare = nTotalResults ? (AX_F64)tStat.nResults / nTotalResults : 0;
+        printf("    grp %u weight %u: in %.1f fps, detected %.1f fps (share %.3f), skip %llu, replaced %llu, latency avg %.1f ms max %.1f ms\n",
+               i, tScen.arrWeight[i], tStat.nFrames / fSeconds, tStat.nResults / fSeconds, fShare, tSched.nSkip, tStat.nReplaced,
+               tStat.nResults ? tStat.nLatencySumUs / 1000.0 / tStat.nResults : 0, tStat.nLatencyMaxUs / 1000.0);
+
+        if (tScen.arrExpectShare[i] > 0 && fabs(fShare - tScen.arrExpectShare[i]) > tScen.fShareTolerance) {
+            printf("    FAIL: grp %u share %.3f, expected %.3f +/- %.3f\n", i, fShare, tScen.arrExpectShare[i], tScen.fShareTolerance);
+            bOk = AX_FALSE;
+        }
+    }
+
+    if (tScen.bExpectNoSkip && nTotalSkip > 0) {
+        printf("    FAIL: %llu frames skipped although NPU has capacity\n", nTotalSkip);
+        bOk = AX_FALSE;
+    }
+
+    if (tScen.bExpectNoSkip) {
+        for (AX_U32 i = 0; i < nGrpCount; ++i) {
+            /* every delivered frame but the last few in flight gets a result */
+            if (arrStat[i].nResults + SIM_MAX_INFLIGHT < arrStat[i].nFrames) {
+                printf("    FAIL: grp %u detected %llu of %llu frames\n", i, arrStat[i].nResults, arrStat[i].nFrames);
+                bOk = AX_FALSE;
+            }
+        }
+    }
+
+    return bOk;
+}
+
+int main(int argc, char* argv[]) {
+    AX_U64 nDurationUs = ((argc > 1) ? (AX_U64)atoi(argv[1]) : 20) * 1000000ULL;
+    srand(1);
+
+    const SIM_SCENARIO_T arrScenarios[] = {
+        /* 2 x 30 fps on 40 fps NPU: equal share */
+        {"overload 1:1", 2, {1, 1}, {33333, 33333}, 25000, 0, AX_FALSE, {0.5, 0.5}, 0.02},
+        /* same load, weights 3:1 */
+        {"overload 3:1", 2, {3, 1}, {33333, 33333}, 25000, 0, AX_FALSE, {0.75, 0.25}, 0.03},
+        /* 3:1 with NPU time jitter of +/- 20% */
+        {"overload 3:1 jitter", 2, {3, 1}, {33333, 33333}, 25000, 5000, AX_FALSE, {0.75, 0.25}, 0.04},
+        /* 30 + 5 fps on 40 fps NPU: nothing may be skipped */
+        {"underload 30+5", 2, {1, 1}, {33333, 200000}, 25000, 0, AX_TRUE, {0, 0}, 0},
+        /* heavy weight group asks less than its share: the rest goes to the other group */
+        {"work conserving 3:1", 2, {3, 1}, {100000, 33333}, 33333, 0, AX_FALSE, {0.333, 0.667}, 0.03},
+        /* 4 x 25 fps on 60 fps NPU */
+        {"overload 4 groups", 4, {1, 1, 1, 1}, {40000, 40000, 40000, 40000}, 16667, 2000, AX_FALSE, {0.25, 0.25, 0.25, 0.25}, 0.02},
+    };
+
+    AX_BOOL bOk = AX_TRUE;
+    for (const auto& tScen : arrScenarios) {
+        if (!RunScenario(tScen, nDurationUs)) {
+            bOk = AX_FALSE;
+        }
+    }
+
+    printf("%s\n", bOk ? "all scenarios passed" : "FAILED");
+    return bOk ? 0 : 1;
+}
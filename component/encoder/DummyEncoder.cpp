@@ -39,6 +39,10 @@ AX_BOOL CDummyEncoder::Stop(AX_VOID) {
 }
 
 AX_BOOL CDummyEncoder::Init() {
+    if (!CAXStage::Init()) {
+        return AX_FALSE;
+    }
+
     SetCapacity(AX_APP_LOCKQ_CAPACITY);
     return AX_TRUE;
 }
@@ -37,10 +37,15 @@ public:
 
     AX_BOOL OnRegisterObserver(OBS_TARGET_TYPE_E eTarget, AX_U32 nGrp, AX_U32 nChn, OBS_TRANS_ATTR_PTR pParams) override {
         m_nTargetPipeChannel = eTarget << 24 | nGrp << 16 | nChn;
+        if (!m_bProducer) {
+            m_pSink->AddProducer();
+            m_bProducer = AX_TRUE;
+        }
         return AX_TRUE;
     }
 
 private:
     CDummyEncoder* m_pSink{nullptr};
+    AX_BOOL m_bProducer{AX_FALSE};
     AX_U32 m_nTargetPipeChannel{0};
 };
\ No newline at end of file
@@ -46,11 +46,16 @@ public:
         tJencConfig->nHeight = pParams->nHeight;
         tJencConfig->bLink = AX_FALSE;
         m_nTargetPipeChannel = eTarget << 24 | nGrp << 16 | nChn;
+        if (!m_bProducer) {
+            m_pSink->AddProducer();
+            m_bProducer = AX_TRUE;
+        }
 
         return AX_TRUE;
     }
 
 private:
     CJpegEncoder* m_pSink{nullptr};
+    AX_BOOL m_bProducer{AX_FALSE};
     AX_U32 m_nTargetPipeChannel{0};
 };
\ No newline at end of file
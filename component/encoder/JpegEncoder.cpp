@@ -12,6 +12,7 @@
 #include "AppLogApi.h"
 #include "ElapsedTimer.hpp"
 #include "GlobalDef.h"
+#include "OptionHelper.h"
 #include "PrintHelper.h"
 #include "ax_buffer_tool.h"
 #include "ax_vdec_api.h"
@@ -123,6 +124,11 @@ AX_BOOL CJpegEncoder::Stop() {
 
     StopRecv();
 
+    if (m_bStreamReactor) {
+        /* leave select group before channel is destroyed */
+        StopWorkThread();
+    }
+
     LOG_MM_I(JENC, "[%d] AX_VENC_DestroyChn ...", GetChannel());
     do {
         nRet = AX_VENC_DestroyChn(GetChannel());
@@ -177,6 +183,20 @@ AX_VOID CJpegEncoder::ResetChn() {
 
 AX_VOID CJpegEncoder::StartWorkThread() {
     m_bGetThreadRunning = AX_TRUE;
+
+    if (COptionHelper::GetInstance()->IsEnableVencStreamReactor()) {
+        m_bStreamReactor = CVencStreamReactor::GetInstance()->Register(m_tJpegConfig.nChannel, this);
+        if (m_bStreamReactor) {
+            std::lock_guard<std::mutex> lck(m_mtx);
+            if (m_bPauseGet) {
+                CVencStreamReactor::GetInstance()->Suspend(m_tJpegConfig.nChannel, AX_TRUE);
+            }
+            return;
+        }
+
+        LOG_MM_W(JENC, "[%d] register to stream reactor failed, fall back to get thread", m_tJpegConfig.nChannel);
+    }
+
     m_hGetThread = new std::thread(&CJpegEncoder::FrameGetThreadFunc, this, this);
 }
 
@@ -184,6 +204,11 @@ AX_VOID CJpegEncoder::StopWorkThread() {
     LOG_MM_I(JENC, "[%d] +++", m_tJpegConfig.nChannel);
 
     m_bGetThreadRunning = AX_FALSE;
+
+    if (m_bStreamReactor) {
+        CVencStreamReactor::GetInstance()->Unregister(m_tJpegConfig.nChannel);
+        m_bStreamReactor = AX_FALSE;
+    }
     if (m_hGetThread && m_hGetThread->joinable()) {
         m_hGetThread->join();
         delete m_hGetThread;
@@ -194,6 +219,10 @@ AX_VOID CJpegEncoder::StopWorkThread() {
 }
 
 AX_BOOL CJpegEncoder::Init() {
+    if (!CAXStage::Init()) {
+        return AX_FALSE;
+    }
+
     SetCapacity(AX_APP_LOCKQ_CAPACITY);
     return AX_TRUE;
 }
@@ -362,8 +391,7 @@ AX_VOID CJpegEncoder::FrameGetThreadFunc(AX_VOID* pCaller) {
         }
 
         if (stStream.stPack.pu8Addr && stStream.stPack.u32Len > 0) {
-            LOG_MM_D(JENC, "[%d] Get jenc out stream, size=%d.", nChannel, stStream.stPack.u32Len);
-            NotifyAll(nChannel, &stStream);
+            OnStreamArrived(nChannel, &stStream);
         }
 
         nRet = AX_VENC_ReleaseStream(nChannel, &stStream);
@@ -430,7 +458,16 @@ AX_BOOL CJpegEncoder::UpdateChnResolution(const JPEG_CONFIG_T& tNewConfig) {
     return AX_TRUE;
 }
 
+AX_VOID CJpegEncoder::OnStreamArrived(AX_S32 nChannel, AX_VENC_STREAM_T* pStream) {
+    LOG_MM_D(JENC, "[%d] Get jenc out stream, size=%d.", nChannel, pStream->stPack.u32Len);
+    NotifyAll(nChannel, pStream);
+}
+
 AX_VOID CJpegEncoder::SetPauseFlag(AX_BOOL bPause) {
     std::lock_guard<std::mutex> lck(m_mtx);
     m_bPauseGet = bPause;
+
+    if (m_bStreamReactor) {
+        CVencStreamReactor::GetInstance()->Suspend(m_tJpegConfig.nChannel, bPause);
+    }
 }
\ No newline at end of file
@@ -13,6 +13,7 @@
 #include "AXStage.hpp"
 #include "FramerateCtrlHelper.h"
 #include "IObserver.h"
+#include "VencStreamReactor.h"
 #include "ax_venc_comm.h"
 
 #define MAX_JENC_CHANNEL_NUM (16)
@@ -43,7 +44,7 @@ typedef struct stJpegConfig {
 
 } JPEG_CONFIG_T, *JPEG_CONFIG_PTR;
 
-class CJpegEncoder : public CAXStage {
+class CJpegEncoder : public CAXStage, public IVencStreamHandler {
 public:
     CJpegEncoder(JPEG_CONFIG_T& tConfig);
     ~CJpegEncoder();
@@ -92,6 +93,7 @@ protected:
     AX_VOID NotifyAll(AX_U32 nChannel, AX_VOID* pStream);
 
     AX_VOID FrameGetThreadFunc(AX_VOID* pCaller);
+    AX_VOID OnStreamArrived(AX_S32 nChannel, AX_VENC_STREAM_T* pStream) override;
     AX_VOID StartWorkThread();
     AX_VOID StopWorkThread();
 
@@ -104,6 +106,7 @@ private:
 
     std::thread* m_hGetThread{nullptr};
     AX_BOOL m_bGetThreadRunning;
+    AX_BOOL m_bStreamReactor{AX_FALSE};
 
     std::vector<IObserver*> m_vecObserver;
     CFramerateCtrlHelper* m_pFramectrl{nullptr};
@@ -54,6 +54,10 @@ public:
             tVideoConfig->bLink = AX_FALSE;
 
             m_nTargetPipeChannel = eTarget << 24 | nGrp << 16 | nChn;
+            if (!m_bProducer) {
+                m_pSink->AddProducer();
+                m_bProducer = AX_TRUE;
+            }
         }
 
         return AX_TRUE;
@@ -61,5 +65,6 @@ public:
 
 private:
     CVideoEncoder* m_pSink{nullptr};
+    AX_BOOL m_bProducer{AX_FALSE};
     AX_U32 m_nTargetPipeChannel{0};
 };
\ No newline at end of file
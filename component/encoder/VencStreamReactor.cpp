@@ -0,0 +1,241 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "VencStreamReactor.h"
+#include <string.h>
+#include <sys/prctl.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "AppLogApi.h"
+
+#define REACTOR "VENC_REACTOR"
+
+CVencStreamReactor::~CVencStreamReactor(AX_VOID) {
+    StopThread();
+}
+
+AX_BOOL CVencStreamReactor::Register(AX_S32 nChannel, IVencStreamHandler* pHandler) {
+    if (nullptr == pHandler) {
+        return AX_FALSE;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtxHandlers);
+    if (m_mapHandlers.find(nChannel) != m_mapHandlers.end()) {
+        LOG_MM_E(REACTOR, "[%d] already registered", nChannel);
+        return AX_FALSE;
+    }
+
+    AX_S32 nRet = AX_VENC_SelectGrpAddChn(AX_VENC_REACTOR_SELECT_GRP, nChannel);
+    if (AX_SUCCESS != nRet) {
+        LOG_MM_E(REACTOR, "[%d] AX_VENC_SelectGrpAddChn failed, ret=0x%x", nChannel, nRet);
+        return AX_FALSE;
+    }
+
+    m_mapHandlers[nChannel] = {pHandler, AX_FALSE, AX_FALSE};
+
+    if (!m_bRunning) {
+        m_bRunning = AX_TRUE;
+        m_hThread = std::thread(&CVencStreamReactor::ReactorThreadFunc, this);
+    }
+
+    m_cvHandlers.notify_one();
+
+    LOG_MM_I(REACTOR, "[%d] registered, total %d", nChannel, (AX_S32)m_mapHandlers.size());
+    return AX_TRUE;
+}
+
+AX_VOID CVencStreamReactor::Unregister(AX_S32 nChannel) {
+    std::unique_lock<std::mutex> lck(m_mtxHandlers);
+    auto it = m_mapHandlers.find(nChannel);
+    if (it == m_mapHandlers.end()) {
+        return;
+    }
+
+    /* handler may unregister itself from OnStreamArrived, never wait for the reactor thread on itself */
+    if (std::this_thread::get_id() != m_hThread.get_id()) {
+        m_cvIdle.wait(lck, [this, nChannel]() -> bool {
+            auto itWait = m_mapHandlers.find(nChannel);
+            return itWait == m_mapHandlers.end() || !itWait->second.bBusy;
+        });
+
+        it = m_mapHandlers.find(nChannel);
+        if (it == m_mapHandlers.end()) {
+            return;
+        }
+    }
+
+    if (!it->second.bSuspend) {
+        AX_S32 nRet = AX_VENC_SelectGrpDeleteChn(AX_VENC_REACTOR_SELECT_GRP, nChannel);
+        if (AX_SUCCESS != nRet) {
+            LOG_MM_W(REACTOR, "[%d] AX_VENC_SelectGrpDeleteChn failed, ret=0x%x", nChannel, nRet);
+        }
+    }
+
+    m_mapHandlers.erase(it);
+
+    LOG_MM_I(REACTOR, "[%d] unregistered, total %d", nChannel, (AX_S32)m_mapHandlers.size());
+}
+
+AX_BOOL CVencStreamReactor::Suspend(AX_S32 nChannel, AX_BOOL bSuspend) {
+    std::lock_guard<std::mutex> lck(m_mtxHandlers);
+    auto it = m_mapHandlers.find(nChannel);
+    if (it == m_mapHandlers.end()) {
+        return AX_FALSE;
+    }
+
+    if (it->second.bSuspend == bSuspend) {
+        return AX_TRUE;
+    }
+
+    AX_S32 nRet = bSuspend ? AX_VENC_SelectGrpDeleteChn(AX_VENC_REACTOR_SELECT_GRP, nChannel)
+                           : AX_VENC_SelectGrpAddChn(AX_VENC_REACTOR_SELECT_GRP, nChannel);
+    if (AX_SUCCESS != nRet) {
+        LOG_MM_E(REACTOR, "[%d] %s select group failed, ret=0x%x", nChannel, bSuspend ? "leave" : "join", nRet);
+        return AX_FALSE;
+    }
+
+    it->second.bSuspend = bSuspend;
+    m_cvHandlers.notify_one();
+
+    return AX_TRUE;
+}
+
+AX_VOID CVencStreamReactor::StopThread(AX_VOID) {
+    {
+        std::lock_guard<std::mutex> lck(m_mtxHandlers);
+        m_bRunning = AX_FALSE;
+        m_cvHandlers.notify_one();
+    }
+
+    if (m_hThread.joinable()) {
+        m_hThread.join();
+    }
+}
+
+AX_VOID CVencStreamReactor::ReactorThreadFunc(AX_VOID) {
+    prctl(PR_SET_NAME, "APP_VENC_Reactor");
+
+    LOG_MM_I(REACTOR, "+++");
+
+    AX_CHN_STREAM_STATUS_T tStatus;
+    std::vector<std::pair<AX_S32, IVencStreamHandler*>> vecReady;
+    AX_U32 nBackoff = 0;
+    while (1) {
+        {
+            /* sleep while no channel is selectable */
+            std::unique_lock<std::mutex> lck(m_mtxHandlers);
+            m_cvHandlers.wait(lck, [this]() -> bool {
+                if (!m_bRunning) {
+                    return true;
+                }
+
+                for (auto& kv : m_mapHandlers) {
+                    if (!kv.second.bSuspend) {
+                        return true;
+                    }
+                }
+
+                return false;
+            });
+
+            if (!m_bRunning) {
+                break;
+            }
+        }
+
+        memset(&tStatus, 0, sizeof(tStatus));
+        auto tBegin = std::chrono::steady_clock::now();
+        AX_S32 nRet = AX_VENC_SelectGrp(AX_VENC_REACTOR_SELECT_GRP, &tStatus, AX_VENC_REACTOR_SELECT_TIMEOUT);
+        if (AX_SUCCESS != nRet) {
+            /* timeout, recheck registration and running state */
+            auto nElapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tBegin).count();
+            if (nElapsed >= AX_VENC_REACTOR_SELECT_TIMEOUT) {
+                nBackoff = 0;
+                continue;
+            }
+
+            /* failed without waiting, back off instead of spinning */
+            if (0 == nBackoff) {
+                LOG_MM_E(REACTOR, "AX_VENC_SelectGrp failed, ret=0x%x", nRet);
+            }
+            nBackoff = (0 == nBackoff) ? 1 : std::min<AX_U32>(nBackoff * 2, AX_VENC_REACTOR_MAX_BACKOFF);
+
+            std::unique_lock<std::mutex> lck(m_mtxHandlers);
+            m_cvHandlers.wait_for(lck, std::chrono::milliseconds(nBackoff), [this]() -> bool { return !m_bRunning; });
+            continue;
+        }
+        nBackoff = 0;
+
+        /* mark handlers busy under lock, call them without it */
+        vecReady.clear();
+        {
+            std::lock_guard<std::mutex> lck(m_mtxHandlers);
+            AX_U32 nCount = sizeof(tStatus.au32ChnIndex) / sizeof(tStatus.au32ChnIndex[0]);
+            for (AX_U32 i = 0; i < tStatus.u32TotalChnNum && i < nCount; ++i) {
+                AX_S32 nChannel = (AX_S32)tStatus.au32ChnIndex[i];
+                auto it = m_mapHandlers.find(nChannel);
+                if (it == m_mapHandlers.end() || it->second.bSuspend || it->second.bBusy) {
+                    continue;
+                }
+
+                it->second.bBusy = AX_TRUE;
+                vecReady.emplace_back(nChannel, it->second.pHandler);
+            }
+        }
+
+        for (auto& tReady : vecReady) {
+            DrainChannel(tReady.first, tReady.second);
+
+            std::lock_guard<std::mutex> lck(m_mtxHandlers);
+            auto it = m_mapHandlers.find(tReady.first);
+            if (it != m_mapHandlers.end()) {
+                it->second.bBusy = AX_FALSE;
+            }
+            m_cvIdle.notify_all();
+        }
+    }
+
+    LOG_MM_I(REACTOR, "---");
+}
+
+AX_VOID CVencStreamReactor::DrainChannel(AX_S32 nChannel, IVencStreamHandler* pHandler) {
+    AX_VENC_STREAM_T stStream;
+    while (1) {
+        memset(&stStream, 0, sizeof(AX_VENC_STREAM_T));
+        AX_S32 nRet = AX_VENC_GetStream(nChannel, &stStream, 0);
+        if (AX_SUCCESS != nRet) {
+            if (AX_ERR_VENC_QUEUE_EMPTY != nRet && AX_ERR_VENC_NOT_PERMIT != nRet) {
+                LOG_MM_W(REACTOR, "[%d] AX_VENC_GetStream failed, ret=0x%x", nChannel, nRet);
+            }
+            break;
+        }
+
+        if (stStream.stPack.pu8Addr && stStream.stPack.u32Len > 0) {
+            pHandler->OnStreamArrived(nChannel, &stStream);
+        } else {
+            LOG_MM_W(REACTOR, "[%d] AX_VENC_GetStream output data error, addr=%p, size=%d", nChannel, stStream.stPack.pu8Addr,
+                     stStream.stPack.u32Len);
+        }
+
+        nRet = AX_VENC_ReleaseStream(nChannel, &stStream);
+        if (AX_SUCCESS != nRet) {
+            LOG_MM_E(REACTOR, "[%d] AX_VENC_ReleaseStream failed, ret=0x%x", nChannel, nRet);
+            break;
+        }
+
+        /* handler may unregister or suspend the channel meanwhile, remaining packets are not delivered */
+        std::lock_guard<std::mutex> lck(m_mtxHandlers);
+        auto it = m_mapHandlers.find(nChannel);
+        if (it == m_mapHandlers.end() || it->second.bSuspend) {
+            break;
+        }
+    }
+}
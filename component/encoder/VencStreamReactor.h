@@ -0,0 +1,73 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include "AXSingleton.h"
+#include "ax_venc_api.h"
+
+/* VENC select group owned by the reactor */
+#define AX_VENC_REACTOR_SELECT_GRP (0)
+/* select timeout, also the latency of channel registration changes */
+#define AX_VENC_REACTOR_SELECT_TIMEOUT (100)
+/* max backoff in ms while AX_VENC_SelectGrp keeps failing without waiting */
+#define AX_VENC_REACTOR_MAX_BACKOFF (AX_VENC_REACTOR_SELECT_TIMEOUT)
+
+class IVencStreamHandler {
+public:
+    virtual ~IVencStreamHandler(AX_VOID) = default;
+
+    /* called on reactor thread without reactor lock held, stream is released after return */
+    virtual AX_VOID OnStreamArrived(AX_S32 nChannel, AX_VENC_STREAM_T* pStream) = 0;
+};
+
+/**
+ * @brief Serve VENC/JENC channels from one thread.
+ *
+ * Channels are added to a VENC select group, the thread waits in AX_VENC_SelectGrp and
+ * drains every ready packet of each ready channel before waiting again.
+ * AENC has no select group, CAudioEncoder and opal elevenc keep one thread blocked in GetStream(-1) per channel.
+ */
+class CVencStreamReactor final : public CAXSingleton<CVencStreamReactor> {
+    friend class CAXSingleton<CVencStreamReactor>;
+
+public:
+    AX_BOOL Register(AX_S32 nChannel, IVencStreamHandler* pHandler);
+    AX_VOID Unregister(AX_S32 nChannel);
+
+    /* suspended channel is removed from select group and its packets stay in VENC */
+    AX_BOOL Suspend(AX_S32 nChannel, AX_BOOL bSuspend);
+
+private:
+    CVencStreamReactor(AX_VOID) noexcept = default;
+    virtual ~CVencStreamReactor(AX_VOID);
+
+    AX_VOID ReactorThreadFunc(AX_VOID);
+    AX_VOID DrainChannel(AX_S32 nChannel, IVencStreamHandler* pHandler);
+    AX_VOID StopThread(AX_VOID);
+
+private:
+    typedef struct {
+        IVencStreamHandler* pHandler;
+        AX_BOOL bSuspend;
+        AX_BOOL bBusy; /* handler is being called, Unregister waits until it returns */
+    } HANDLER_ITEM_T;
+
+    std::map<AX_S32, HANDLER_ITEM_T> m_mapHandlers;
+    std::mutex m_mtxHandlers;
+    std::condition_variable m_cvHandlers;
+    std::condition_variable m_cvIdle;
+    std::thread m_hThread;
+    AX_BOOL m_bRunning{AX_FALSE};
+};
@@ -17,6 +17,7 @@
 #include "AXVideo.hpp"
 #include "PrintHelper.h"
 #include "AlgoOptionHelper.h"
+#include "OptionHelper.h"
 
 #define VENC "VENC"
 
@@ -25,13 +26,27 @@ using namespace std;
 CVideoEncoder::CVideoEncoder(VIDEO_CONFIG_T& tConfig) : CAXStage((string)VENC + (char)('0' + tConfig.nChannel)), m_tVideoConfig(tConfig) {
     m_tCfgFrameRate.fSrcFrameRate = tConfig.fSrcFrameRate;
     m_tCfgFrameRate.fDstFrameRate = tConfig.fDstFrameRate;
+    m_nStreamTracePoint = CLatencyTracer::GetInstance()->RegisterPoint(GetStageName() + "_STREAM");
 }
 
 CVideoEncoder::~CVideoEncoder() {
 }
 
 AX_BOOL CVideoEncoder::Init() {
+    if (!CAXStage::Init()) {
+        return AX_FALSE;
+    }
+
     SetCapacity(AX_APP_LOCKQ_CAPACITY);
+
+    if (COptionHelper::GetInstance()->IsEnableSharedStreamBuf()) {
+        AX_U32 nWidth = m_tVideoConfig.nWidth;
+        AX_U32 nHeight = m_tVideoConfig.nHeight;
+        AX_U32 nCount = COptionHelper::GetInstance()->GetWebVencRingBufCount(nWidth, nHeight);
+        AX_U32 nSize = COptionHelper::GetInstance()->GetWebVencRingBufSize(nWidth, nHeight) * nCount;
+        m_spStreamBuf = CAXStreamBufferMgr::GetInstance()->Create(GetChannel(), nSize, nCount * 2);
+    }
+
     return AX_TRUE;
 }
 
@@ -41,6 +56,11 @@ AX_BOOL CVideoEncoder::DeInit() {
         Stop();
     }
 
+    if (m_spStreamBuf) {
+        CAXStreamBufferMgr::GetInstance()->Destroy(GetChannel());
+        m_spStreamBuf = nullptr;
+    }
+
     CAXStage::DeInit();
     LOG_MM_C(VENC, "[%d] ---", GetChannel());
 
@@ -79,6 +99,11 @@ AX_BOOL CVideoEncoder::Stop() {
 
     StopRecv();
 
+    if (m_bStreamReactor) {
+        /* leave select group before channel is destroyed */
+        StopWorkThread();
+    }
+
     LOG_MM_I(VENC, "[%d] AX_VENC_DestroyChn ...", GetChannel());
     do {
         nRet = AX_VENC_DestroyChn(GetChannel());
@@ -140,6 +165,16 @@ AX_BOOL CVideoEncoder::ResetChn() {
 
 AX_VOID CVideoEncoder::StartWorkThread() {
     m_bGetThreadRunning = AX_TRUE;
+
+    if (COptionHelper::GetInstance()->IsEnableVencStreamReactor()) {
+        m_bStreamReactor = CVencStreamReactor::GetInstance()->Register(GetChannel(), this);
+        if (m_bStreamReactor) {
+            return;
+        }
+
+        LOG_MM_W(VENC, "[%d] register to stream reactor failed, fall back to get thread", GetChannel());
+    }
+
     m_hGetThread = std::thread(&CVideoEncoder::FrameGetThreadFunc, this, this);
 }
 
@@ -148,6 +183,11 @@ AX_VOID CVideoEncoder::StopWorkThread() {
 
     m_bGetThreadRunning = AX_FALSE;
 
+    if (m_bStreamReactor) {
+        CVencStreamReactor::GetInstance()->Unregister(GetChannel());
+        m_bStreamReactor = AX_FALSE;
+    }
+
     if (m_hGetThread.joinable()) {
         m_hGetThread.join();
     }
@@ -187,8 +227,66 @@ AX_VOID CVideoEncoder::NotifyAll(AX_U32 nChannel, AX_VOID* pStream) {
         return;
     }
 
+    CLatencyHistogram* pNotify = CLatencyTracer::GetInstance()->IsEnabled()
+                                     ? CLatencyTracer::GetInstance()->GetHistogram(m_nStreamTracePoint, LATENCY_HIST_NOTIFY)
+                                     : nullptr;
     for (vector<IObserver*>::iterator it = m_vecObserver.begin(); it != m_vecObserver.end(); it++) {
+        AX_U64 nStart = pNotify ? CLatencyTracer::NowUs() : 0;
         (*it)->OnRecvData(E_OBS_TARGET_TYPE_VENC, m_tVideoConfig.nPipeSrc, nChannel, pStream);
+        if (pNotify) {
+            pNotify->Record(CLatencyTracer::NowUs() - nStart);
+        }
+    }
+}
+
+AX_VOID CVideoEncoder::TraceFrameSent(const CAXFrame* pFrame) {
+    if (!CLatencyTracer::GetInstance()->IsEnabled() || !pFrame->tTrail.IsStarted()) {
+        return;
+    }
+
+    AX_U64 nDequeue = pFrame->tTrail.Find(m_nTracePoint, LATENCY_STAMP_DEQUEUE);
+
+    std::lock_guard<std::mutex> lck(m_mtxTrace);
+    /* oldest one is overwritten if its stream never comes */
+    VENC_LATENCY_TRACE_T& tTrace = m_arrTrace[m_nTraceIndex];
+    tTrace.nPts = pFrame->stFrame.stVFrame.stVFrame.u64PTS;
+    tTrace.nOrigin = pFrame->tTrail.GetOrigin();
+    tTrace.nDequeue = nDequeue ? nDequeue : CLatencyTracer::NowUs();
+    m_nTraceIndex = (m_nTraceIndex + 1) % VENC_LATENCY_TRACE_NUM;
+}
+
+AX_VOID CVideoEncoder::TraceStreamArrived(AX_U64 nPts) {
+    CLatencyTracer* pTracer = CLatencyTracer::GetInstance();
+    if (!pTracer->IsEnabled()) {
+        return;
+    }
+
+    VENC_LATENCY_TRACE_T tTrace{0, 0, 0};
+    {
+        std::lock_guard<std::mutex> lck(m_mtxTrace);
+        for (auto& m : m_arrTrace) {
+            if (0 != m.nOrigin && m.nPts == nPts) {
+                tTrace = m;
+                m.nOrigin = 0;
+                break;
+            }
+        }
+    }
+
+    /* frame came by link or was sent before tracing is enabled */
+    if (0 == tTrace.nOrigin) {
+        return;
+    }
+
+    AX_U64 nNow = CLatencyTracer::NowUs();
+    CLatencyHistogram* pEdge = pTracer->GetEdge(m_nTracePoint, m_nStreamTracePoint);
+    if (pEdge && nNow >= tTrace.nDequeue) {
+        pEdge->Record(nNow - tTrace.nDequeue);
+    }
+
+    CLatencyHistogram* pAge = pTracer->GetHistogram(m_nStreamTracePoint, LATENCY_HIST_AGE);
+    if (pAge && nNow >= tTrace.nOrigin) {
+        pAge->Record(nNow - tTrace.nOrigin);
     }
 }
 
@@ -642,6 +740,7 @@ AX_BOOL CVideoEncoder::ProcessFrame(CAXFrame* pFrame) {
         return AX_FALSE;
     } else {
         LOG_M_D(VENC, "[%d] AX_VENC_SendFrame, seq=%lld", GetChannel(), pFrame->stFrame.stVFrame.stVFrame.u64SeqNum);
+        TraceFrameSent(pFrame);
     }
 
     return AX_TRUE;
@@ -678,16 +777,7 @@ AX_VOID CVideoEncoder::FrameGetThreadFunc(CVideoEncoder* pCaller) {
         }
 
         if (pThis->m_bGetThreadRunning && stStream.stPack.pu8Addr && stStream.stPack.u32Len > 0) {
-#ifdef SLT
-            if (0 == nChannel) {
-                CPrintHelper::GetInstance()->Add(E_PH_MOD_VENC, 0);
-            }
-#else
-            NotifyAll(nChannel, &stStream);
-
-            CPrintHelper::GetInstance()->Add(E_PH_MOD_VENC, nChannel);
-#endif
-
+            OnStreamArrived(nChannel, &stStream);
         } else {
             LOG_MM_W(VENC, "[%d] AX_VENC_GetStream output data error, addr=%p, size=%d", nChannel, stStream.stPack.pu8Addr,
                      stStream.stPack.u32Len);
@@ -701,6 +791,24 @@ AX_VOID CVideoEncoder::FrameGetThreadFunc(CVideoEncoder* pCaller) {
     }
 }
 
+AX_VOID CVideoEncoder::OnStreamArrived(AX_S32 nChannel, AX_VENC_STREAM_T* pStream) {
+#ifdef SLT
+    if (0 == nChannel) {
+        CPrintHelper::GetInstance()->Add(E_PH_MOD_VENC, 0);
+    }
+#else
+    if (m_spStreamBuf) {
+        AX_BOOL bIFrame = (AX_VENC_INTRA_FRAME == pStream->stPack.enCodingType || PT_MJPEG == pStream->stPack.enType) ? AX_TRUE : AX_FALSE;
+        m_spStreamBuf->Put(pStream->stPack.pu8Addr, pStream->stPack.u32Len, pStream->stPack.u64PTS, bIFrame);
+    }
+
+    TraceStreamArrived(pStream->stPack.u64PTS);
+    NotifyAll(nChannel, pStream);
+
+    CPrintHelper::GetInstance()->Add(E_PH_MOD_VENC, nChannel);
+#endif
+}
+
 AX_BOOL CVideoEncoder::UpdateChnResolution(const VIDEO_CONFIG_T& tNewConfig) {
     std::lock_guard<std::mutex> lck(m_mtx);
     AX_BOOL ret = AX_TRUE;
@@ -10,9 +10,13 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <vector>
 #include "AXStage.hpp"
+#include "AXStreamBuffer.h"
 #include "IObserver.h"
+#include "VencStreamReactor.h"
 #include "ax_venc_comm.h"
 #include "ax_venc_rc.h"
 #include "AXAlgo.hpp"
@@ -21,6 +25,8 @@
 #define APP_ENCODER_TYPE_MAX 4
 #define APP_RC_TYPE_MAX 5
 #define APP_ENCODE_PARSE_INVALID (0)
+/* frames sent to VENC which wait for their stream, to trace latency of encoded stream */
+#define VENC_LATENCY_TRACE_NUM (8)
 
 typedef struct _stAppVencRcParams {
     AX_VENC_H264_CBR_T tH264Cbr{0};
@@ -131,7 +137,7 @@ typedef struct _APP_VIDEO_RESOLUTION_T {
     AX_U32 nHeight;
 } APP_VIDEO_RESOLUTION_T;
 
-class CVideoEncoder : public CAXStage {
+class CVideoEncoder : public CAXStage, public IVencStreamHandler {
 public:
     CVideoEncoder(VIDEO_CONFIG_T& tConfig);
     virtual ~CVideoEncoder();
@@ -197,10 +203,13 @@ protected:
     AX_VOID NotifyAll(AX_U32 nChannel, AX_VOID* pStream);
 
     AX_VOID FrameGetThreadFunc(CVideoEncoder* pCaller);
+    AX_VOID OnStreamArrived(AX_S32 nChannel, AX_VENC_STREAM_T* pStream) override;
     AX_VOID StartWorkThread();
     AX_VOID StopWorkThread();
     AX_BOOL InitRcParams(VIDEO_CONFIG_T& tConfig);
     AX_BOOL UpdateSvcParamInternal(const AX_APP_ALGO_SVC_PARAM_T& tParam);
+    AX_VOID TraceFrameSent(const CAXFrame* pFrame);
+    AX_VOID TraceStreamArrived(AX_U64 nPts);
 
 private:
     AX_BOOL GetResolutionByRotate(AX_U8 nRotation, AX_U32& nWidth, AX_U32& nHeight);
@@ -217,9 +226,24 @@ private:
 
     std::thread m_hGetThread;
     AX_BOOL m_bGetThreadRunning;
+    /* streams are retrieved by CVencStreamReactor instead of m_hGetThread */
+    AX_BOOL m_bStreamReactor{AX_FALSE};
     AX_BOOL m_bSend{AX_FALSE};
 
     std::vector<IObserver*> m_vecObserver;
+    /* encoded packets are copied once here and read by rtsp/web sinks, nullptr if not enabled */
+    std::shared_ptr<CAXStreamBuffer> m_spStreamBuf;
+
+    /* stream is matched to the frame sent by pts */
+    typedef struct {
+        AX_U64 nPts;
+        AX_U64 nOrigin; /* 0: free */
+        AX_U64 nDequeue;
+    } VENC_LATENCY_TRACE_T;
+    AX_U16 m_nStreamTracePoint{LATENCY_POINT_INVALID};
+    VENC_LATENCY_TRACE_T m_arrTrace[VENC_LATENCY_TRACE_NUM]{};
+    AX_U32 m_nTraceIndex{0};
+    std::mutex m_mtxTrace;
 
     /* Update resolution should be small than creation resolution ,so <m_tCurResolution> recorde the current resolution without rotation*/
     APP_VIDEO_RESOLUTION_T m_tCurResolution{0, 0};
@@ -0,0 +1,391 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+/*
+    Check of CVencStreamReactor on a mocked VENC HAL.
+    Encoded packets are queued per channel and an eventfd is signaled, AX_VENC_SelectGrp waits on the eventfd and
+    reports the channels of the select group having packets, as the SDK select group does.
+
+    drain:    channels encoding with bursts get every packet in order on one thread, several packets per wakeup.
+    suspend:  packets of a suspended channel stay in VENC and arrive after resume.
+    busy:     a slow handler blocks neither suspend of other channels nor delivery to them,
+              Unregister waits for the running handler and no packet arrives after it returns.
+    self:     handler unregistering itself from OnStreamArrived does not deadlock.
+    errors:   AX_VENC_SelectGrp failing without waiting is backed off, packets arrive once it recovers.
+
+    usage: venc_reactor_check
+*/
+
+#include <poll.h>
+#include <stdio.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+#include "AppLogApi.h"
+#include "VencStreamReactor.h"
+#include "host_tool.h"
+
+#define CHECK_CHN_NUM (4)
+#define CHECK_FRAME_NUM (300)
+#define CHECK_FRAME_INTERVAL_US (2000)
+#define CHECK_BURST_PERIOD (10) /* every 10th frame comes with 2 more packets, e.g. SPS/PPS/SEI */
+#define CHECK_WAIT_MS (2000)
+#define MOCK_ERR_TIMEOUT ((AX_S32)0x80060027)
+#define MOCK_ERR_SELECT ((AX_S32)0x80060028)
+
+/* reactor logs through app log, not shown here */
+AX_VOID AX_APP_LogFmtStr(AX_S32 nLv, const AX_CHAR *pFmt, ...) {
+}
+
+typedef struct {
+    AX_U64 nSeq;
+    AX_U64 nEncodeNs;
+} MOCK_PACKET_T;
+
+typedef struct {
+    std::mutex mtx;
+    std::set<AX_S32> setSelect;
+    std::deque<MOCK_PACKET_T> arrQueue[CHECK_CHN_NUM];
+    MOCK_PACKET_T arrHeld[CHECK_CHN_NUM]; /* between GetStream and ReleaseStream */
+    AX_BOOL arrIsHeld[CHECK_CHN_NUM];
+    AX_U64 arrSeq[CHECK_CHN_NUM];
+    AX_U32 nBadCall{0}; /* get while holding, release without get, unknown channel */
+    AX_U32 nReady{0};   /* AX_VENC_SelectGrp returned ready channels */
+    std::atomic<AX_U32> nSelect{0};
+    std::atomic<AX_BOOL> bFail{AX_FALSE};
+    AX_S32 nEventFd{-1};
+} MOCK_VENC_T;
+
+static MOCK_VENC_T g_tVenc;
+
+static AX_BOOL MockChnValid(AX_S32 nChn) {
+    return (nChn >= 0 && nChn < CHECK_CHN_NUM) ? AX_TRUE : AX_FALSE;
+}
+
+/* the encoder output nCount packets */
+static AX_VOID MockEncode(AX_S32 nChn, AX_U32 nCount) {
+    {
+        std::lock_guard<std::mutex> lck(g_tVenc.mtx);
+        for (AX_U32 i = 0; i < nCount; ++i) {
+            g_tVenc.arrQueue[nChn].push_back({g_tVenc.arrSeq[nChn]++, HostToolNowNs()});
+        }
+    }
+
+    AX_U64 nOne = 1;
+    if (write(g_tVenc.nEventFd, &nOne, sizeof(nOne)) != sizeof(nOne)) {
+        printf("eventfd write failed\n");
+    }
+}
+
+static AX_U32 MockQueued(AX_S32 nChn) {
+    std::lock_guard<std::mutex> lck(g_tVenc.mtx);
+    return (AX_U32)g_tVenc.arrQueue[nChn].size();
+}
+
+AX_S32 AX_VENC_SelectGrpAddChn(AX_S32 nGrp, AX_S32 nChn) {
+    std::lock_guard<std::mutex> lck(g_tVenc.mtx);
+    g_tVenc.setSelect.insert(nChn);
+    return AX_SUCCESS;
+}
+
+AX_S32 AX_VENC_SelectGrpDeleteChn(AX_S32 nGrp, AX_S32 nChn) {
+    std::lock_guard<std::mutex> lck(g_tVenc.mtx);
+    g_tVenc.setSelect.erase(nChn);
+    return AX_SUCCESS;
+}
+
+AX_S32 AX_VENC_SelectGrp(AX_S32 nGrp, AX_CHN_STREAM_STATUS_T *pStatus, AX_S32 nTimeOut) {
+    ++g_tVenc.nSelect;
+    if (g_tVenc.bFail) {
+        return MOCK_ERR_SELECT;
+    }
+
+    AX_U64 nDeadline = HostToolNowNs() + (AX_U64)nTimeOut * 1000000;
+    while (1) {
+        {
+            std::lock_guard<std::mutex> lck(g_tVenc.mtx);
+            pStatus->u32TotalChnNum = 0;
+            for (AX_S32 nChn : g_tVenc.setSelect) {
+                if (MockChnValid(nChn) && !g_tVenc.arrQueue[nChn].empty()) {
+                    pStatus->au32ChnIndex[pStatus->u32TotalChnNum++] = (AX_U32)nChn;
+                }
+            }
+
+            if (pStatus->u32TotalChnNum > 0) {
+                g_tVenc.nReady++;
+                return AX_SUCCESS;
+            }
+        }
+
+        AX_U64 nNow = HostToolNowNs();
+        if (nNow >= nDeadline) {
+            return MOCK_ERR_TIMEOUT;
+        }
+
+        struct pollfd tFd = {g_tVenc.nEventFd, POLLIN, 0};
+        if (poll(&tFd, 1, (AX_S32)((nDeadline - nNow + 999999) / 1000000)) > 0) {
+            AX_U64 nValue = 0;
+            if (read(g_tVenc.nEventFd, &nValue, sizeof(nValue)) != sizeof(nValue)) {
+                continue;
+            }
+        }
+    }
+}
+
+AX_S32 AX_VENC_GetStream(AX_S32 nChn, AX_VENC_STREAM_T *pStream, AX_S32 nTimeOut) {
+    std::lock_guard<std::mutex> lck(g_tVenc.mtx);
+    if (!MockChnValid(nChn) || g_tVenc.arrIsHeld[nChn]) {
+        g_tVenc.nBadCall++;
+        return AX_ERR_VENC_NOT_PERMIT;
+    }
+
+    if (g_tVenc.arrQueue[nChn].empty()) {
+        return AX_ERR_VENC_QUEUE_EMPTY;
+    }
+
+    g_tVenc.arrHeld[nChn] = g_tVenc.arrQueue[nChn].front();
+    g_tVenc.arrQueue[nChn].pop_front();
+    g_tVenc.arrIsHeld[nChn] = AX_TRUE;
+    pStream->stPack.pu8Addr = (AX_U8 *)&g_tVenc.arrHeld[nChn];
+    pStream->stPack.u32Len = sizeof(MOCK_PACKET_T);
+    pStream->stPack.u64PTS = g_tVenc.arrHeld[nChn].nSeq;
+    return AX_SUCCESS;
+}
+
+AX_S32 AX_VENC_ReleaseStream(AX_S32 nChn, AX_VENC_STREAM_T *pStream) {
+    std::lock_guard<std::mutex> lck(g_tVenc.mtx);
+    if (!MockChnValid(nChn) || !g_tVenc.arrIsHeld[nChn] || pStream->stPack.pu8Addr != (AX_U8 *)&g_tVenc.arrHeld[nChn]) {
+        g_tVenc.nBadCall++;
+        return AX_ERR_VENC_NOT_PERMIT;
+    }
+
+    g_tVenc.arrIsHeld[nChn] = AX_FALSE;
+    return AX_SUCCESS;
+}
+
+static std::mutex g_mtxThreads;
+static std::set<std::thread::id> g_setThreads; /* threads calling OnStreamArrived */
+
+class CCheckHandler : public IVencStreamHandler {
+public:
+    AX_VOID OnStreamArrived(AX_S32 nChannel, AX_VENC_STREAM_T *pStream) override {
+        m_bInCall = AX_TRUE;
+        if (m_bGone) {
+            m_nAfterGone++;
+        }
+
+        {
+            std::lock_guard<std::mutex> lck(g_mtxThreads);
+            g_setThreads.insert(std::this_thread::get_id());
+        }
+
+        const MOCK_PACKET_T *pPacket = (const MOCK_PACKET_T *)pStream->stPack.pu8Addr;
+        if (pPacket->nSeq != m_nNextSeq) {
+            m_nOutOfOrder++;
+        }
+        m_nNextSeq = pPacket->nSeq + 1;
+
+        AX_U64 nLatency = HostToolNowNs() - pPacket->nEncodeNs;
+        m_nLatencyNs += nLatency;
+        if (nLatency > m_nLatencyMaxNs) {
+            m_nLatencyMaxNs = nLatency;
+        }
+
+        if (m_nSlowMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_nSlowMs));
+        }
+
+        if (m_bUnregisterSelf) {
+            CVencStreamReactor::GetInstance()->Unregister(nChannel);
+        }
+
+        m_nCount++;
+        m_bInCall = AX_FALSE;
+    }
+
+    AX_BOOL WaitCount(AX_U32 nCount) const {
+        AX_U64 nDeadline = HostToolNowNs() + (AX_U64)CHECK_WAIT_MS * 1000000;
+        while (m_nCount < nCount && HostToolNowNs() < nDeadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return (m_nCount >= nCount) ? AX_TRUE : AX_FALSE;
+    }
+
+    std::atomic<AX_U32> m_nCount{0};
+    std::atomic<AX_BOOL> m_bInCall{AX_FALSE};
+    std::atomic<AX_BOOL> m_bGone{AX_FALSE}; /* set after Unregister returned */
+    std::atomic<AX_U32> m_nAfterGone{0};
+    AX_U32 m_nSlowMs{0};
+    AX_BOOL m_bUnregisterSelf{AX_FALSE};
+    AX_U64 m_nNextSeq{0};
+    AX_U32 m_nOutOfOrder{0};
+    AX_U64 m_nLatencyNs{0};
+    AX_U64 m_nLatencyMaxNs{0};
+};
+
+static AX_VOID CheckResult(const AX_CHAR *pszCase, AX_BOOL bPass, AX_BOOL &bOk) {
+    printf("%-8s %s\n", pszCase, bPass ? "ok" : "FAILED");
+    if (!bPass) {
+        bOk = AX_FALSE;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    g_tVenc.nEventFd = eventfd(0, EFD_CLOEXEC);
+    if (g_tVenc.nEventFd < 0) {
+        printf("eventfd failed\n");
+        return 1;
+    }
+
+    CVencStreamReactor *pReactor = CVencStreamReactor::GetInstance();
+    CCheckHandler arrHandler[CHECK_CHN_NUM];
+    AX_BOOL bOk = AX_TRUE;
+
+    /* drain */
+    AX_BOOL bPass = AX_TRUE;
+    for (AX_S32 i = 0; i < CHECK_CHN_NUM; ++i) {
+        bPass = (pReactor->Register(i, &arrHandler[i]) && bPass) ? AX_TRUE : AX_FALSE;
+    }
+    bPass = (!pReactor->Register(0, &arrHandler[0]) && bPass) ? AX_TRUE : AX_FALSE;
+
+    AX_U32 nPackets = 0;
+    for (AX_U32 i = 0; i < CHECK_FRAME_NUM; ++i) {
+        AX_U32 nCount = (0 == i % CHECK_BURST_PERIOD) ? 3 : 1;
+        for (AX_S32 j = 0; j < CHECK_CHN_NUM; ++j) {
+            MockEncode(j, nCount);
+        }
+        nPackets += nCount;
+        std::this_thread::sleep_for(std::chrono::microseconds(CHECK_FRAME_INTERVAL_US));
+    }
+
+    AX_U64 nLatencyNs = 0;
+    AX_U64 nLatencyMaxNs = 0;
+    for (AX_S32 i = 0; i < CHECK_CHN_NUM; ++i) {
+        CCheckHandler &tHandler = arrHandler[i];
+        if (!tHandler.WaitCount(nPackets) || tHandler.m_nCount != nPackets || tHandler.m_nOutOfOrder > 0) {
+            printf("  chn %d got %u of %u packets, %u out of order\n", i, tHandler.m_nCount.load(), nPackets, tHandler.m_nOutOfOrder);
+            bPass = AX_FALSE;
+        }
+        nLatencyNs += tHandler.m_nLatencyNs;
+        nLatencyMaxNs = std::max(nLatencyMaxNs, tHandler.m_nLatencyMaxNs);
+    }
+
+    AX_U32 nReady = 0;
+    {
+        std::lock_guard<std::mutex> lck(g_tVenc.mtx);
+        nReady = g_tVenc.nReady;
+    }
+    {
+        std::lock_guard<std::mutex> lck(g_mtxThreads);
+        if (g_setThreads.size() != 1) {
+            printf("  packets arrived on %u threads\n", (AX_U32)g_setThreads.size());
+            bPass = AX_FALSE;
+        }
+    }
+    printf("  %u channels x %u packets, %.2f packets per wakeup, latency avg %.1f us max %.1f us\n", CHECK_CHN_NUM, nPackets,
+           (AX_F64)nPackets * CHECK_CHN_NUM / (nReady ? nReady : 1), nLatencyNs / 1000.0 / (nPackets * CHECK_CHN_NUM),
+           nLatencyMaxNs / 1000.0);
+    CheckResult("drain", bPass, bOk);
+
+    /* suspend */
+    CCheckHandler &tSuspend = arrHandler[1];
+    AX_U32 nBase = tSuspend.m_nCount;
+    bPass = pReactor->Suspend(1, AX_TRUE);
+    MockEncode(1, 5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    if (tSuspend.m_nCount != nBase || MockQueued(1) != 5) {
+        printf("  suspended channel got %u packets, %u left in VENC\n", tSuspend.m_nCount - nBase, MockQueued(1));
+        bPass = AX_FALSE;
+    }
+    bPass = (pReactor->Suspend(1, AX_FALSE) && tSuspend.WaitCount(nBase + 5) && bPass) ? AX_TRUE : AX_FALSE;
+    CheckResult("suspend", bPass, bOk);
+
+    /* busy */
+    CCheckHandler &tSlow = arrHandler[2];
+    tSlow.m_nSlowMs = 100;
+    nBase = tSlow.m_nCount;
+    MockEncode(2, 1);
+    while (!tSlow.m_bInCall) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    AX_U64 nStart = HostToolNowNs();
+    bPass = (pReactor->Suspend(0, AX_TRUE) && pReactor->Suspend(0, AX_FALSE)) ? AX_TRUE : AX_FALSE;
+    AX_U64 nSuspendUs = (HostToolNowNs() - nStart) / 1000;
+
+    pReactor->Unregister(2);
+    tSlow.m_bGone = AX_TRUE;
+    AX_U64 nUnregisterUs = (HostToolNowNs() - nStart) / 1000;
+    if (tSlow.m_bInCall || tSlow.m_nCount != nBase + 1) {
+        printf("  Unregister returned while handler is running\n");
+        bPass = AX_FALSE;
+    }
+
+    MockEncode(2, 3);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    if (tSlow.m_nAfterGone > 0 || nSuspendUs > 20000) {
+        printf("  %u packets after Unregister, suspend took %llu us\n", tSlow.m_nAfterGone.load(), (unsigned long long)nSuspendUs);
+        bPass = AX_FALSE;
+    }
+    printf("  suspend of other channel %llu us, Unregister waited %llu us for a 100 ms handler\n", (unsigned long long)nSuspendUs,
+           (unsigned long long)nUnregisterUs);
+    CheckResult("busy", bPass, bOk);
+
+    /* self */
+    CCheckHandler &tSelf = arrHandler[3];
+    tSelf.m_bUnregisterSelf = AX_TRUE;
+    nBase = tSelf.m_nCount;
+    AX_U32 nOther = arrHandler[0].m_nCount;
+    MockEncode(3, 3);
+    MockEncode(0, 1);
+    bPass = (tSelf.WaitCount(nBase + 1) && arrHandler[0].WaitCount(nOther + 1)) ? AX_TRUE : AX_FALSE;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    if (tSelf.m_nCount != nBase + 1) {
+        printf("  self unregistered handler got %u packets\n", tSelf.m_nCount - nBase);
+        bPass = AX_FALSE;
+    }
+    CheckResult("self", bPass, bOk);
+
+    /* errors */
+    g_tVenc.bFail = AX_TRUE;
+    std::this_thread::sleep_for(std::chrono::milliseconds(CHECK_WAIT_MS / 4));
+    AX_U32 nSelectBase = g_tVenc.nSelect;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    AX_U32 nSelect = g_tVenc.nSelect - nSelectBase;
+    g_tVenc.bFail = AX_FALSE;
+    nBase = arrHandler[0].m_nCount;
+    MockEncode(0, 2);
+    bPass = (arrHandler[0].WaitCount(nBase + 2) && nSelect <= 2 * 1000 / AX_VENC_REACTOR_MAX_BACKOFF) ? AX_TRUE : AX_FALSE;
+    printf("  %u select calls in 1 s of errors\n", nSelect);
+    CheckResult("errors", bPass, bOk);
+
+    pReactor->Unregister(0);
+    pReactor->Unregister(1);
+    {
+        std::lock_guard<std::mutex> lck(g_tVenc.mtx);
+        for (AX_S32 i = 0; i < CHECK_CHN_NUM; ++i) {
+            if (g_tVenc.arrIsHeld[i]) {
+                printf("chn %d stream not released\n", i);
+                bOk = AX_FALSE;
+            }
+        }
+        if (g_tVenc.nBadCall > 0 || !g_tVenc.setSelect.empty()) {
+            printf("%u bad HAL calls, %u channels left in select group\n", g_tVenc.nBadCall, (AX_U32)g_tVenc.setSelect.size());
+            bOk = AX_FALSE;
+        }
+    }
+
+    printf("%s\n", bOk ? "PASS" : "FAIL");
+    return bOk ? 0 : 1;
+}
@@ -18,6 +18,7 @@
 #include <mutex>
 #include <string>
 #include "AppLogApi.h"
+#include "LatencyTracer.hpp"
 #if defined(__RECORD_VB_TIMESTAMP__)
 #include "TimestampHelper.hpp"
 #endif
@@ -47,6 +48,10 @@ public:
     AX_BOOL bMultiplex{AX_FALSE};
     AX_U32 nFrmRefCnt{0};
     std::mutex mtxFrmRefCnt;
+    /* stamped by source and stages when latency trace is enabled */
+    CLatencyTrail tTrail;
+    /* handle of CAXFramePool slot owning this frame, 0 if frame is allocated from heap */
+    AX_U32 nPoolHandle{0};
 
     CAXFrame(AX_VOID) {
         memset(&stFrame, 0, sizeof(stFrame));
@@ -62,6 +67,8 @@ private:
         pUserDefine = rhs.pUserDefine;
         bMultiplex = rhs.bMultiplex;
         nFrmRefCnt = rhs.nFrmRefCnt;
+        tTrail = rhs.tTrail;
+        nPoolHandle = rhs.nPoolHandle;
     }
 
 public:
@@ -81,6 +88,23 @@ public:
     CAXFrame(CAXFrame &&rhs) = default;
     CAXFrame &operator=(CAXFrame &&rhs) = default;
 
+    /* back to default state before a pooled frame is reused */
+    AX_VOID Reset(AX_VOID) {
+        nGrp = -1;
+        nChn = -1;
+        eFrameType = AX_APP_FRAME_TYPE_VIDEO;
+        memset(&stFrame, 0, sizeof(stFrame));
+        pFrameRelease = nullptr;
+        pUserDefine = nullptr;
+        bMultiplex = AX_FALSE;
+        {
+            std::lock_guard<std::mutex> lck(mtxFrmRefCnt);
+            nFrmRefCnt = 0;
+        }
+        tTrail.Clear();
+        nPoolHandle = 0;
+    }
+
     AX_VOID FreeMem(AX_VOID) {
         if (pFrameRelease) {
             if (AX_APP_FRAME_TYPE_AUDIO == eFrameType) {
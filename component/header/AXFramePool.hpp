@@ -0,0 +1,132 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include "AXFrame.hpp"
+#include "AXSlotPool.hpp"
+
+/**
+ * @brief fixed capacity pool of CAXFrame for a frame getter (VIN or IVPS chn), each frame with an extra T (e.g. AX_IMG_INFO_T).
+ *
+ *  Acquire resets the frame and stamps slot handle into CAXFrame::nPoolHandle, so the release callback finds the slot
+ *  in O(1) instead of searching an in-flight list. Acquire and Release are lock free (CAXSlotPool), Release only takes
+ *  a lock to wake a getter waiting in Acquire with timeout.
+ *  Init is called once by the getter thread before first Acquire; the pool lives as long as its owner, as frames may
+ *  still be held by consumers after the getter thread exits.
+ */
+template <typename T = AX_U8>
+class CAXFramePool final {
+public:
+    CAXFramePool(AX_VOID) = default;
+    ~CAXFramePool(AX_VOID) = default;
+
+    CAXFramePool(const CAXFramePool&) = delete;
+    CAXFramePool& operator=(const CAXFramePool&) = delete;
+
+    AX_BOOL Init(AX_U32 nCapacity) {
+        return m_pool.Init(nCapacity);
+    }
+
+    AX_BOOL IsInited(AX_VOID) const {
+        return (m_pool.GetCapacity() > 0) ? AX_TRUE : AX_FALSE;
+    }
+
+    /* return reset frame and its zeroed extra, nullptr if all frames are in flight */
+    CAXFrame* Acquire(T** ppExtra = nullptr) {
+        AX_U32 nHandle = AX_SLOT_POOL_INVALID_HANDLE;
+        SLOT_T* pSlot = m_pool.Acquire(nHandle);
+        if (!pSlot) {
+            return nullptr;
+        }
+
+        pSlot->tFrame.Reset();
+        pSlot->tFrame.nPoolHandle = nHandle;
+        memset(&pSlot->tExtra, 0, sizeof(T));
+        if (ppExtra) {
+            *ppExtra = &pSlot->tExtra;
+        }
+
+        return &pSlot->tFrame;
+    }
+
+    /* wait up to nTimeOutMs for a frame released by consumers, nullptr on timeout */
+    CAXFrame* Acquire(T** ppExtra, AX_U32 nTimeOutMs) {
+        CAXFrame* pFrame = Acquire(ppExtra);
+        if (pFrame || 0 == nTimeOutMs) {
+            return pFrame;
+        }
+
+        auto tDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(nTimeOutMs);
+        std::unique_lock<std::mutex> lck(m_mtxWait);
+        m_nWaiters.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        /* a slot released before the waiter is seen by Release is found by this Acquire */
+        while (!(pFrame = Acquire(ppExtra))) {
+            if (std::cv_status::timeout == m_cvWait.wait_until(lck, tDeadline)) {
+                pFrame = Acquire(ppExtra);
+                break;
+            }
+        }
+        m_nWaiters.fetch_sub(1);
+
+        return pFrame;
+    }
+
+    /* frame in flight of handle, nullptr if handle is stale */
+    CAXFrame* Get(AX_U32 nHandle) {
+        SLOT_T* pSlot = m_pool.Get(nHandle);
+        return pSlot ? &pSlot->tFrame : nullptr;
+    }
+
+    AX_BOOL Release(CAXFrame* pFrame) {
+        if (!pFrame || !m_pool.Release(pFrame->nPoolHandle)) {
+            return AX_FALSE;
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_nWaiters.load() > 0) {
+            std::lock_guard<std::mutex> lck(m_mtxWait);
+            m_cvWait.notify_one();
+        }
+
+        return AX_TRUE;
+    }
+
+    AX_U32 GetCapacity(AX_VOID) const {
+        return m_pool.GetCapacity();
+    }
+
+    AX_U32 GetUsedCount(AX_VOID) const {
+        return m_pool.GetUsedCount();
+    }
+
+    AX_U32 GetPeakCount(AX_VOID) const {
+        return m_pool.GetPeakCount();
+    }
+
+    AX_U64 GetExhaustedCount(AX_VOID) const {
+        return m_pool.GetExhaustedCount();
+    }
+
+private:
+    typedef struct {
+        CAXFrame tFrame;
+        T tExtra;
+    } SLOT_T;
+
+    CAXSlotPool<SLOT_T> m_pool;
+    std::mutex m_mtxWait;
+    std::condition_variable m_cvWait;
+    std::atomic<AX_U32> m_nWaiters{0};
+};
@@ -0,0 +1,258 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include "AXLockQ.hpp"
+
+/* ring slots used when capacity is not limited (SetCapacity(-1)) */
+#define AX_LOCKFREE_Q_DEFAULT_CAPACITY (64)
+
+/**
+ * @brief bounded lock-free ring queue, drop-in replacement of CAXLockQ.
+ *
+ *  - SPSC: one producer thread and one consumer thread, plain head/tail indexes.
+ *  - MPSC: any number of producer threads, per-slot sequence numbers (D. Vyukov bounded queue).
+ *
+ *  Push never blocks and takes no lock. Pop sleeps on a futex only when the ring is empty,
+ *  and producers issue FUTEX_WAKE only when a consumer is actually waiting.
+ *  SetCapacity reallocates the ring, so it must be called before the queue is shared between threads.
+ */
+template <typename T>
+class CAXLockFreeQ final : public IAXLockQ<T> {
+public:
+    CAXLockFreeQ(AX_BOOL bMultiProducer = AX_TRUE) : m_bMultiProducer(bMultiProducer) {
+        SetCapacity(-1);
+    }
+
+    ~CAXLockFreeQ(AX_VOID) = default;
+
+    AX_VOID SetCapacity(AX_S32 nCapacity) override {
+        m_nCapacity = (nCapacity < 0) ? (AX_U32)-1 : nCapacity;
+        m_nLimit = (nCapacity < 0) ? AX_LOCKFREE_Q_DEFAULT_CAPACITY : nCapacity;
+
+        size_t nSize = 1;
+        while (nSize < m_nLimit) {
+            nSize <<= 1;
+        }
+
+        m_arrSlots.reset(new SLOT_T[nSize]);
+        for (size_t i = 0; i < nSize; ++i) {
+            m_arrSlots[i].nSeq.store(i, std::memory_order_relaxed);
+        }
+
+        m_nMask = nSize - 1;
+        m_nHead.store(0, std::memory_order_relaxed);
+        m_nTail.store(0, std::memory_order_release);
+    }
+
+    AX_S32 GetCapacity(AX_VOID) const override {
+        return (m_nCapacity == ((AX_U32)-1)) ? -1 : m_nCapacity;
+    }
+
+    AX_S32 GetCount(AX_VOID) const override {
+        intptr_t nCount = (intptr_t)(m_nTail.load(std::memory_order_acquire) - m_nHead.load(std::memory_order_acquire));
+        return (nCount < 0) ? 0 : (AX_S32)nCount;
+    }
+
+    AX_BOOL IsFull(AX_VOID) const override {
+        return ((AX_U32)GetCount() >= m_nLimit) ? AX_TRUE : AX_FALSE;
+    }
+
+    AX_VOID Wakeup(AX_VOID) override {
+        m_bWakeup.store(true, std::memory_order_release);
+        Notify();
+    }
+
+    AX_BOOL Push(const T& m) override {
+        if (!(m_bMultiProducer ? PushMulti(m) : PushSingle(m))) {
+            return AX_FALSE;
+        }
+
+        /* pairs with the fence in Pop: either consumer sees the new item or we see the waiter */
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_nWaiters.load(std::memory_order_relaxed) > 0) {
+            Notify();
+        }
+
+        return AX_TRUE;
+    }
+
+    AX_BOOL Pop(T& m, AX_S32 nTimeOut = -1) override {
+        if (TryPop(m)) {
+            return AX_TRUE;
+        }
+
+        if (0 == nTimeOut) {
+            return AX_FALSE;
+        }
+
+        std::chrono::steady_clock::time_point tpDeadline;
+        if (nTimeOut > 0) {
+            tpDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(nTimeOut);
+        }
+
+        AX_BOOL bAvail{AX_FALSE};
+        m_nWaiters.fetch_add(1, std::memory_order_relaxed);
+        while (1) {
+            AX_S32 nSeq = m_nFutex.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (TryPop(m)) {
+                bAvail = AX_TRUE;
+                break;
+            }
+
+            if (m_bWakeup.load(std::memory_order_acquire)) {
+                break;
+            }
+
+            struct timespec ts;
+            struct timespec* pTimeout{nullptr};
+            if (nTimeOut > 0) {
+                auto remain = std::chrono::duration_cast<std::chrono::nanoseconds>(tpDeadline - std::chrono::steady_clock::now()).count();
+                if (remain <= 0) {
+                    break;
+                }
+
+                ts.tv_sec = remain / 1000000000;
+                ts.tv_nsec = remain % 1000000000;
+                pTimeout = &ts;
+            }
+
+            (AX_VOID) syscall(SYS_futex, reinterpret_cast<AX_S32*>(&m_nFutex), FUTEX_WAIT_PRIVATE, nSeq, pTimeout, nullptr, 0);
+        }
+        m_nWaiters.fetch_sub(1, std::memory_order_relaxed);
+        m_bWakeup.store(false, std::memory_order_release);
+
+        return bAvail;
+    }
+
+private:
+    AX_BOOL PushSingle(const T& m) {
+        size_t nTail = m_nTail.load(std::memory_order_relaxed);
+        if (nTail - m_nHead.load(std::memory_order_acquire) >= m_nLimit) {
+            return AX_FALSE;
+        }
+
+        m_arrSlots[nTail & m_nMask].data = m;
+        m_nTail.store(nTail + 1, std::memory_order_release);
+        return AX_TRUE;
+    }
+
+    AX_BOOL PushMulti(const T& m) {
+        size_t nPos = m_nTail.load(std::memory_order_relaxed);
+        SLOT_T* pSlot{nullptr};
+        while (1) {
+            if ((intptr_t)(nPos - m_nHead.load(std::memory_order_acquire)) >= (intptr_t)m_nLimit) {
+                return AX_FALSE;
+            }
+
+            pSlot = &m_arrSlots[nPos & m_nMask];
+            intptr_t nDiff = (intptr_t)pSlot->nSeq.load(std::memory_order_acquire) - (intptr_t)nPos;
+            if (0 == nDiff) {
+                if (m_nTail.compare_exchange_weak(nPos, nPos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (nDiff < 0) {
+                return AX_FALSE;
+            } else {
+                nPos = m_nTail.load(std::memory_order_relaxed);
+            }
+        }
+
+        pSlot->data = m;
+        pSlot->nSeq.store(nPos + 1, std::memory_order_release);
+        return AX_TRUE;
+    }
+
+    AX_BOOL TryPop(T& m) {
+        size_t nHead = m_nHead.load(std::memory_order_relaxed);
+        if (!m_bMultiProducer) {
+            if (nHead == m_nTail.load(std::memory_order_acquire)) {
+                return AX_FALSE;
+            }
+
+            m = m_arrSlots[nHead & m_nMask].data;
+            m_nHead.store(nHead + 1, std::memory_order_release);
+            return AX_TRUE;
+        }
+
+        SLOT_T& slot = m_arrSlots[nHead & m_nMask];
+        if (slot.nSeq.load(std::memory_order_acquire) != nHead + 1) {
+            /* empty, or the producer owning this slot has not published yet */
+            return AX_FALSE;
+        }
+
+        m = slot.data;
+        slot.nSeq.store(nHead + m_nMask + 1, std::memory_order_release);
+        m_nHead.store(nHead + 1, std::memory_order_release);
+        return AX_TRUE;
+    }
+
+    AX_VOID Notify(AX_VOID) {
+        m_nFutex.fetch_add(1, std::memory_order_release);
+        (AX_VOID) syscall(SYS_futex, reinterpret_cast<AX_S32*>(&m_nFutex), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    /* delete copy and assignment ctor */
+    CAXLockFreeQ(const CAXLockFreeQ&) = delete;
+    CAXLockFreeQ(CAXLockFreeQ&&) = delete;
+    CAXLockFreeQ& operator=(const CAXLockFreeQ&) = delete;
+    CAXLockFreeQ& operator=(CAXLockFreeQ&&) = delete;
+
+private:
+    typedef struct {
+        std::atomic<size_t> nSeq;
+        T data;
+    } SLOT_T;
+
+    static_assert(sizeof(std::atomic<AX_S32>) == sizeof(AX_S32), "futex word must be a plain 32 bits integer");
+
+    AX_BOOL m_bMultiProducer{AX_TRUE};
+    AX_U32 m_nCapacity{(AX_U32)-1};
+    size_t m_nLimit{AX_LOCKFREE_Q_DEFAULT_CAPACITY};
+    size_t m_nMask{0};
+    std::unique_ptr<SLOT_T[]> m_arrSlots;
+
+    /* keep producer and consumer indexes on separate cache lines */
+    AX_U8 m_arrPad0[64];
+    std::atomic<size_t> m_nTail{0};
+    AX_U8 m_arrPad1[64];
+    std::atomic<size_t> m_nHead{0};
+    AX_U8 m_arrPad2[64];
+    std::atomic<AX_S32> m_nFutex{0};
+    std::atomic<AX_S32> m_nWaiters{0};
+    std::atomic<bool> m_bWakeup{false};
+};
+
+/**
+ * @brief create frame queue by type, used by CAXStage to select queue backend per stage
+ *
+ */
+template <typename T>
+inline std::unique_ptr<IAXLockQ<T>> CreateAXLockQ(AX_APP_LOCKQ_TYPE_E eType) {
+    switch (eType) {
+        case AX_APP_LOCKQ_TYPE_SPSC:
+            return std::unique_ptr<IAXLockQ<T>>(new (std::nothrow) CAXLockFreeQ<T>(AX_FALSE));
+        case AX_APP_LOCKQ_TYPE_MPSC:
+            return std::unique_ptr<IAXLockQ<T>>(new (std::nothrow) CAXLockFreeQ<T>(AX_TRUE));
+        default:
+            return std::unique_ptr<IAXLockQ<T>>(new (std::nothrow) CAXLockQ<T>());
+    }
+}
@@ -15,39 +15,64 @@
 #include "ax_base_type.h"
 #include "condition_variable.hpp"
 
+typedef enum axAPP_LOCKQ_TYPE {
+    AX_APP_LOCKQ_TYPE_MUTEX = 0, /* std::queue guarded by mutex and condition_variable */
+    AX_APP_LOCKQ_TYPE_SPSC = 1,  /* lock-free ring, single producer and single consumer */
+    AX_APP_LOCKQ_TYPE_MPSC = 2,  /* lock-free ring, multiple producers and single consumer */
+    AX_APP_LOCKQ_TYPE_BUTT
+} AX_APP_LOCKQ_TYPE_E;
+
+/**
+ * @brief common interface of frame queues, see CAXLockQ and CAXLockFreeQ
+ *
+ */
+template <typename T>
+class IAXLockQ {
+public:
+    virtual ~IAXLockQ(AX_VOID) = default;
+
+    virtual AX_VOID SetCapacity(AX_S32 nCapacity) = 0;
+    virtual AX_S32 GetCapacity(AX_VOID) const = 0;
+    virtual AX_S32 GetCount(AX_VOID) const = 0;
+    virtual AX_BOOL IsFull(AX_VOID) const = 0;
+    virtual AX_VOID Wakeup(AX_VOID) = 0;
+    virtual AX_BOOL Push(const T& m) = 0;
+    virtual AX_BOOL Pop(T& m, AX_S32 nTimeOut = -1) = 0;
+};
+
 template <typename T>
-class CAXLockQ {
+class CAXLockQ : public IAXLockQ<T> {
 public:
     CAXLockQ(AX_VOID) = default;
     virtual ~CAXLockQ(AX_VOID) = default;
 
-    AX_VOID SetCapacity(AX_S32 nCapacity) {
+    AX_VOID SetCapacity(AX_S32 nCapacity) override {
         std::lock_guard<std::mutex> lck(m_mtx);
         m_nCapacity = (nCapacity < 0) ? (AX_U32)-1 : nCapacity;
     }
 
-    AX_S32 GetCapacity(AX_VOID) const {
+    AX_S32 GetCapacity(AX_VOID) const override {
         std::lock_guard<std::mutex> lck(m_mtx);
         return (m_nCapacity == ((AX_U32)-1)) ? -1 : m_nCapacity;
     }
 
-    AX_S32 GetCount(AX_VOID) const {
+    AX_S32 GetCount(AX_VOID) const override {
         std::lock_guard<std::mutex> lck(m_mtx);
         return m_q.size();
     }
 
-    AX_BOOL IsFull(AX_VOID) const {
+    AX_BOOL IsFull(AX_VOID) const override {
         std::lock_guard<std::mutex> lck(m_mtx);
         return (m_q.size() >= m_nCapacity) ? AX_TRUE : AX_FALSE;
     }
 
-    AX_VOID Wakeup(AX_VOID) {
+    AX_VOID Wakeup(AX_VOID) override {
         std::lock_guard<std::mutex> lck(m_mtx);
         m_bWakeup = true;
         m_cv.notify_one();
     }
 
-    AX_BOOL Push(const T& m) {
+    AX_BOOL Push(const T& m) override {
         std::lock_guard<std::mutex> lck(m_mtx);
         if (m_q.size() >= m_nCapacity) {
             return AX_FALSE;
@@ -57,7 +82,7 @@ public:
         return AX_TRUE;
     }
 
-    AX_BOOL Pop(T& m, AX_S32 nTimeOut = -1) {
+    AX_BOOL Pop(T& m, AX_S32 nTimeOut = -1) override {
         std::unique_lock<std::mutex> lck(m_mtx);
         AX_BOOL bAvail{AX_TRUE};
         if (0 == m_q.size()) {
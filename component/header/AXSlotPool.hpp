@@ -0,0 +1,195 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <new>
+#include "ax_base_type.h"
+
+/* index takes the low 16 bits of a handle, generation the high 16 bits */
+#define AX_SLOT_POOL_MAX_CAPACITY (0xFFFF)
+#define AX_SLOT_POOL_INVALID_HANDLE (0)
+
+/**
+ * @brief fixed capacity pool of T slots with a lock-free free list.
+ *
+ *  Acquire and Release only CAS the free list head (Treiber stack with an ABA tag), so they can be called from
+ *  any thread without a lock.
+ *  Each acquire bumps the generation of the slot and returns a handle of (generation, index). Get and Release check
+ *  the generation, so a handle from an earlier use of the slot (e.g. late callback after Stop) is refused and counted
+ *  instead of touching the new owner's data.
+ *  Init and DeInit reallocate the slots and must not run concurrently with other calls.
+ */
+template <typename T>
+class CAXSlotPool final {
+public:
+    CAXSlotPool(AX_VOID) = default;
+    ~CAXSlotPool(AX_VOID) = default;
+
+    CAXSlotPool(const CAXSlotPool&) = delete;
+    CAXSlotPool& operator=(const CAXSlotPool&) = delete;
+
+    AX_BOOL Init(AX_U32 nCapacity) {
+        if (0 == nCapacity || nCapacity > AX_SLOT_POOL_MAX_CAPACITY) {
+            return AX_FALSE;
+        }
+
+        m_arrSlots.reset(new (std::nothrow) SLOT_T[nCapacity]);
+        if (!m_arrSlots) {
+            m_nCapacity = 0;
+            return AX_FALSE;
+        }
+
+        /* chain all slots, index 0 on top */
+        for (AX_U32 i = 0; i < nCapacity; ++i) {
+            m_arrSlots[i].nNext.store((i + 1 < nCapacity) ? i + 1 : INVALID_INDEX, std::memory_order_relaxed);
+            m_arrSlots[i].nTag.store(0, std::memory_order_relaxed);
+        }
+
+        m_nCapacity = nCapacity;
+        m_nUsed.store(0, std::memory_order_relaxed);
+        m_nPeak.store(0, std::memory_order_relaxed);
+        m_nExhausted.store(0, std::memory_order_relaxed);
+        m_nStale.store(0, std::memory_order_relaxed);
+        m_nHead.store(0, std::memory_order_release);
+        return AX_TRUE;
+    }
+
+    AX_VOID DeInit(AX_VOID) {
+        m_nHead.store(INVALID_INDEX, std::memory_order_relaxed);
+        m_arrSlots.reset();
+        m_nCapacity = 0;
+    }
+
+    /* return free slot and its handle, nullptr if all slots are in use */
+    T* Acquire(AX_U32& nHandle) {
+        nHandle = AX_SLOT_POOL_INVALID_HANDLE;
+
+        AX_U64 nHead = m_nHead.load(std::memory_order_acquire);
+        AX_U32 nIndex = INVALID_INDEX;
+        while (1) {
+            nIndex = (AX_U32)nHead;
+            if (INVALID_INDEX == nIndex || !m_arrSlots) {
+                m_nExhausted.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            AX_U64 nNew = (((nHead >> 32) + 1) << 32) | m_arrSlots[nIndex].nNext.load(std::memory_order_relaxed);
+            if (m_nHead.compare_exchange_weak(nHead, nNew, std::memory_order_acquire, std::memory_order_acquire)) {
+                break;
+            }
+        }
+
+        SLOT_T& tSlot = m_arrSlots[nIndex];
+        AX_U32 nGen = ((tSlot.nTag.load(std::memory_order_relaxed) >> 1) + 1) & 0xFFFF;
+        if (0 == nGen) {
+            /* handle 0 is invalid */
+            nGen = 1;
+        }
+        tSlot.nTag.store((nGen << 1) | 1, std::memory_order_release);
+
+        AX_U32 nUsed = m_nUsed.fetch_add(1, std::memory_order_relaxed) + 1;
+        AX_U32 nPeak = m_nPeak.load(std::memory_order_relaxed);
+        while (nUsed > nPeak && !m_nPeak.compare_exchange_weak(nPeak, nUsed, std::memory_order_relaxed)) {
+        }
+
+        nHandle = (nGen << 16) | nIndex;
+        return &tSlot.tData;
+    }
+
+    /* return slot of handle, nullptr if handle is invalid or stale */
+    T* Get(AX_U32 nHandle) {
+        SLOT_T* pSlot = Find(nHandle);
+        if (!pSlot || pSlot->nTag.load(std::memory_order_acquire) != HandleTag(nHandle)) {
+            m_nStale.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        return &pSlot->tData;
+    }
+
+    /* give back slot, AX_FALSE if handle is invalid, stale or already released */
+    AX_BOOL Release(AX_U32 nHandle) {
+        SLOT_T* pSlot = Find(nHandle);
+        AX_U32 nTag = HandleTag(nHandle);
+        if (!pSlot || !pSlot->nTag.compare_exchange_strong(nTag, nTag & ~1U, std::memory_order_acq_rel)) {
+            m_nStale.fetch_add(1, std::memory_order_relaxed);
+            return AX_FALSE;
+        }
+
+        AX_U32 nIndex = nHandle & 0xFFFF;
+        AX_U64 nHead = m_nHead.load(std::memory_order_relaxed);
+        AX_U64 nNew = 0;
+        do {
+            pSlot->nNext.store((AX_U32)nHead, std::memory_order_relaxed);
+            nNew = (((nHead >> 32) + 1) << 32) | nIndex;
+        } while (!m_nHead.compare_exchange_weak(nHead, nNew, std::memory_order_release, std::memory_order_relaxed));
+
+        m_nUsed.fetch_sub(1, std::memory_order_relaxed);
+        return AX_TRUE;
+    }
+
+    AX_U32 GetCapacity(AX_VOID) const {
+        return m_nCapacity;
+    }
+
+    AX_U32 GetUsedCount(AX_VOID) const {
+        return m_nUsed.load(std::memory_order_relaxed);
+    }
+
+    /* most slots in use at the same time since Init */
+    AX_U32 GetPeakCount(AX_VOID) const {
+        return m_nPeak.load(std::memory_order_relaxed);
+    }
+
+    /* Acquire calls failed for no free slot */
+    AX_U64 GetExhaustedCount(AX_VOID) const {
+        return m_nExhausted.load(std::memory_order_relaxed);
+    }
+
+    /* Get or Release calls refused for stale handle */
+    AX_U64 GetStaleCount(AX_VOID) const {
+        return m_nStale.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr AX_U32 INVALID_INDEX = 0xFFFFFFFF;
+
+    typedef struct {
+        T tData;
+        std::atomic<AX_U32> nNext;
+        std::atomic<AX_U32> nTag; /* generation << 1 | in use */
+    } SLOT_T;
+
+    static AX_U32 HandleTag(AX_U32 nHandle) {
+        return ((nHandle >> 16) << 1) | 1;
+    }
+
+    SLOT_T* Find(AX_U32 nHandle) {
+        AX_U32 nIndex = nHandle & 0xFFFF;
+        if (AX_SLOT_POOL_INVALID_HANDLE == nHandle || !m_arrSlots || nIndex >= m_nCapacity) {
+            return nullptr;
+        }
+
+        return &m_arrSlots[nIndex];
+    }
+
+private:
+    std::unique_ptr<SLOT_T[]> m_arrSlots;
+    AX_U32 m_nCapacity{0};
+    /* ABA tag << 32 | index of first free slot */
+    std::atomic<AX_U64> m_nHead{INVALID_INDEX};
+    std::atomic<AX_U32> m_nUsed{0};
+    std::atomic<AX_U32> m_nPeak{0};
+    std::atomic<AX_U64> m_nExhausted{0};
+    std::atomic<AX_U64> m_nStale{0};
+};
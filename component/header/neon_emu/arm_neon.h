@@ -0,0 +1,153 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+/*
+    Host only: scalar model of the NEON intrinsics used by the app, so that __ARM_NEON paths are compiled and
+    checked on a PC by the tools under component/<module>/tools (build with -U__SSE2__ -D__ARM_NEON -I<this dir>).
+    Each vector is a distinct struct, mixing lane types without vreinterpret fails to compile as on aarch64.
+    Never put this directory on the include path of a target build.
+*/
+
+#if defined(__aarch64__) || defined(__arm__)
+#error "neon_emu is for host build only, use the toolchain arm_neon.h"
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+    uint8_t val[8];
+} uint8x8_t;
+
+typedef struct {
+    int8_t val[8];
+} int8x8_t;
+
+typedef struct {
+    uint8_t val[16];
+} uint8x16_t;
+
+typedef struct {
+    uint16_t val[8];
+} uint16x8_t;
+
+typedef struct {
+    int16_t val[8];
+} int16x8_t;
+
+/* load, store and duplicate */
+static inline uint8x8_t vld1_u8(const uint8_t *p) {
+    uint8x8_t r;
+    memcpy(r.val, p, sizeof(r.val));
+    return r;
+}
+
+static inline uint16x8_t vld1q_u16(const uint16_t *p) {
+    uint16x8_t r;
+    memcpy(r.val, p, sizeof(r.val));
+    return r;
+}
+
+static inline void vst1q_u8(uint8_t *p, uint8x16_t v) {
+    memcpy(p, v.val, sizeof(v.val));
+}
+
+static inline void vst1q_u16(uint16_t *p, uint16x8_t v) {
+    memcpy(p, v.val, sizeof(v.val));
+}
+
+static inline uint8x8_t vdup_n_u8(uint8_t n) {
+    uint8x8_t r;
+    for (int i = 0; i < 8; ++i) {
+        r.val[i] = n;
+    }
+    return r;
+}
+
+static inline uint16x8_t vdupq_n_u16(uint16_t n) {
+    uint16x8_t r;
+    for (int i = 0; i < 8; ++i) {
+        r.val[i] = n;
+    }
+    return r;
+}
+
+/* reinterpret, lanes are little endian as on AX SoCs */
+static inline int8x8_t vreinterpret_s8_u8(uint8x8_t v) {
+    int8x8_t r;
+    memcpy(r.val, v.val, sizeof(r.val));
+    return r;
+}
+
+static inline uint8x16_t vreinterpretq_u8_u16(uint16x8_t v) {
+    uint8x16_t r;
+    memcpy(r.val, v.val, sizeof(r.val));
+    return r;
+}
+
+static inline uint16x8_t vreinterpretq_u16_s16(int16x8_t v) {
+    uint16x8_t r;
+    memcpy(r.val, v.val, sizeof(r.val));
+    return r;
+}
+
+/* widen with sign extension */
+static inline int16x8_t vmovl_s8(int8x8_t v) {
+    int16x8_t r;
+    for (int i = 0; i < 8; ++i) {
+        r.val[i] = v.val[i];
+    }
+    return r;
+}
+
+/* compare, lane is all ones if equal */
+static inline uint8x8_t vceq_u8(uint8x8_t a, uint8x8_t b) {
+    uint8x8_t r;
+    for (int i = 0; i < 8; ++i) {
+        r.val[i] = (a.val[i] == b.val[i]) ? 0xFF : 0;
+    }
+    return r;
+}
+
+static inline uint16x8_t vceqq_u16(uint16x8_t a, uint16x8_t b) {
+    uint16x8_t r;
+    for (int i = 0; i < 8; ++i) {
+        r.val[i] = (a.val[i] == b.val[i]) ? 0xFFFF : 0;
+    }
+    return r;
+}
+
+/* bitwise */
+static inline uint16x8_t vandq_u16(uint16x8_t a, uint16x8_t b) {
+    uint16x8_t r;
+    for (int i = 0; i < 8; ++i) {
+        r.val[i] = a.val[i] & b.val[i];
+    }
+    return r;
+}
+
+static inline uint16x8_t vorrq_u16(uint16x8_t a, uint16x8_t b) {
+    uint16x8_t r;
+    for (int i = 0; i < 8; ++i) {
+        r.val[i] = a.val[i] | b.val[i];
+    }
+    return r;
+}
+
+/* bit select: bits of a where mask is set, else bits of b */
+static inline uint16x8_t vbslq_u16(uint16x8_t mask, uint16x8_t a, uint16x8_t b) {
+    uint16x8_t r;
+    for (int i = 0; i < 8; ++i) {
+        r.val[i] = (uint16_t)((mask.val[i] & a.val[i]) | (~mask.val[i] & b.val[i]));
+    }
+    return r;
+}
@@ -0,0 +1,192 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+/*
+    Micro benchmark of CAXLockFreeQ against CAXLockQ, both behind IAXLockQ as used by the pipeline stages.
+
+    burst:  producers push as fast as the ring accepts (retry on full), one consumer pops with infinite timeout.
+            reports throughput and push-to-pop latency.
+    paced:  producers push one item every nPeriodUs, so consumer sleeps between items (cv or futex wake up).
+            reports wake up latency, the path taken by frames at 30 fps.
+
+    Every item is checked: per producer sequence must arrive in order and none lost.
+
+    usage: lockq_bench [items per producer]
+*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/prctl.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "AXLockFreeQ.hpp"
+#include "AXLockQ.hpp"
+#include "host_tool.h"
+
+#define LOCKQ_BENCH_CAPACITY (16) /* typical stage queue depth */
+#define LOCKQ_BENCH_MAX_PRODUCERS (8)
+
+typedef struct {
+    AX_U32 nProducer;
+    AX_U32 nSeq;
+    AX_U64 nPushNs; /* steady clock */
+    AX_U64 nPayload[2];
+} BENCH_ITEM_T;
+
+typedef enum { QUEUE_LOCK = 0, QUEUE_LOCKFREE_SPSC, QUEUE_LOCKFREE_MPSC } QUEUE_TYPE_E;
+
+typedef struct {
+    const AX_CHAR* pszName;
+    AX_U32 nProducers;
+    AX_U32 nItems;     /* per producer */
+    AX_U32 nPeriodUs;  /* 0: burst */
+} BENCH_CASE_T;
+
+typedef struct {
+    AX_F64 fItemsPerSec;
+    AX_U64 nP50Ns;
+    AX_U64 nP99Ns;
+    AX_U64 nMaxNs;
+    AX_U64 nFullRetries;
+    AX_BOOL bOk;
+} BENCH_RESULT_T;
+
+static std::unique_ptr<IAXLockQ<BENCH_ITEM_T>> CreateQueue(QUEUE_TYPE_E eType) {
+    std::unique_ptr<IAXLockQ<BENCH_ITEM_T>> pQ;
+    switch (eType) {
+        case QUEUE_LOCK:
+            pQ.reset(new CAXLockQ<BENCH_ITEM_T>());
+            break;
+        case QUEUE_LOCKFREE_SPSC:
+            pQ.reset(new CAXLockFreeQ<BENCH_ITEM_T>(AX_FALSE));
+            break;
+        default:
+            pQ.reset(new CAXLockFreeQ<BENCH_ITEM_T>(AX_TRUE));
+            break;
+    }
+
+    pQ->SetCapacity(LOCKQ_BENCH_CAPACITY);
+    return pQ;
+}
+
+static BENCH_RESULT_T RunCase(QUEUE_TYPE_E eType, const BENCH_CASE_T& tCase) {
+    BENCH_RESULT_T tResult = {0, 0, 0, 0, 0, AX_TRUE};
+    std::unique_ptr<IAXLockQ<BENCH_ITEM_T>> pQ = CreateQueue(eType);
+    const AX_U64 nTotal = (AX_U64)tCase.nProducers * tCase.nItems;
+
+    std::vector<AX_U64> vecLatency;
+    vecLatency.reserve(nTotal);
+    std::vector<AX_U64> vecRetries(tCase.nProducers, 0);
+
+    std::thread hConsumer([&]() {
+        prctl(PR_SET_NAME, "BenchPop");
+        std::vector<AX_U32> vecNextSeq(tCase.nProducers, 0);
+        BENCH_ITEM_T tItem;
+        for (AX_U64 i = 0; i < nTotal; ++i) {
+            if (!pQ->Pop(tItem, -1)) {
+                tResult.bOk = AX_FALSE;
+                break;
+            }
+
+            vecLatency.push_back(HostToolNowNs() - tItem.nPushNs);
+            if (tItem.nProducer >= tCase.nProducers || tItem.nSeq != vecNextSeq[tItem.nProducer]++) {
+                tResult.bOk = AX_FALSE;
+            }
+        }
+    });
+
+    AX_U64 nStart = HostToolNowNs();
+    std::vector<std::thread> vecProducers;
+    for (AX_U32 p = 0; p < tCase.nProducers; ++p) {
+        vecProducers.emplace_back([&, p]() {
+            prctl(PR_SET_NAME, "BenchPush");
+            AX_U64 nNext = HostToolNowNs();
+            for (AX_U32 i = 0; i < tCase.nItems; ++i) {
+                if (tCase.nPeriodUs > 0) {
+                    nNext += tCase.nPeriodUs * 1000ULL;
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(nNext - std::min(nNext, HostToolNowNs())));
+                }
+
+                BENCH_ITEM_T tItem = {p, i, HostToolNowNs(), {i, p}};
+                while (!pQ->Push(tItem)) {
+                    ++vecRetries[p];
+                    std::this_thread::yield();
+                    tItem.nPushNs = HostToolNowNs();
+                }
+            }
+        });
+    }
+
+    for (auto& t : vecProducers) {
+        t.join();
+    }
+    hConsumer.join();
+    AX_U64 nElapsed = HostToolNowNs() - nStart;
+
+    if (vecLatency.size() != nTotal) {
+        tResult.bOk = AX_FALSE;
+        return tResult;
+    }
+
+    std::sort(vecLatency.begin(), vecLatency.end());
+    tResult.fItemsPerSec = nTotal * 1e9 / (nElapsed ? nElapsed : 1);
+    tResult.nP50Ns = vecLatency[nTotal / 2];
+    tResult.nP99Ns = vecLatency[nTotal * 99 / 100];
+    tResult.nMaxNs = vecLatency.back();
+    for (auto n : vecRetries) {
+        tResult.nFullRetries += n;
+    }
+
+    return tResult;
+}
+
+int main(int argc, char* argv[]) {
+    AX_U32 nItems = (argc > 1) ? (AX_U32)atoi(argv[1]) : 200000;
+    AX_U32 nPaced = std::max(nItems / 200, (AX_U32)100);
+
+    const BENCH_CASE_T arrCases[] = {
+        {"burst 1P1C", 1, nItems, 0},
+        {"burst 4P1C", 4, nItems / 4, 0},
+        {"paced 1P1C 100us", 1, nPaced, 100},
+        {"paced 4P1C 400us", 4, nPaced / 4, 400},
+    };
+
+    const struct {
+        QUEUE_TYPE_E eType;
+        const AX_CHAR* pszName;
+    } arrQueues[] = {{QUEUE_LOCK, "CAXLockQ"}, {QUEUE_LOCKFREE_SPSC, "CAXLockFreeQ SPSC"}, {QUEUE_LOCKFREE_MPSC, "CAXLockFreeQ MPSC"}};
+
+    printf("capacity %d, %u hw threads\n", LOCKQ_BENCH_CAPACITY, std::thread::hardware_concurrency());
+    printf("%-18s %-18s %12s %10s %10s %10s %10s\n", "case", "queue", "items/s", "p50 us", "p99 us", "max us", "full");
+
+    AX_BOOL bOk = AX_TRUE;
+    for (const auto& tCase : arrCases) {
+        for (const auto& tQueue : arrQueues) {
+            /* single producer ring is only valid with one producer */
+            if (QUEUE_LOCKFREE_SPSC == tQueue.eType && tCase.nProducers > 1) {
+                continue;
+            }
+
+            BENCH_RESULT_T tResult = RunCase(tQueue.eType, tCase);
+            printf("%-18s %-18s %12.0f %10.2f %10.2f %10.2f %10llu%s\n", tCase.pszName, tQueue.pszName, tResult.fItemsPerSec,
+                   tResult.nP50Ns / 1000.0, tResult.nP99Ns / 1000.0, tResult.nMaxNs / 1000.0, tResult.nFullRetries,
+                   tResult.bOk ? "" : "  LOST OR REORDERED");
+            if (!tResult.bOk) {
+                bOk = AX_FALSE;
+            }
+        }
+    }
+
+    return bOk ? 0 : 1;
+}
@@ -20,6 +20,10 @@ CIVESStage::CIVESStage(AX_VOID) : CAXStage(IVES) {
 }
 
 AX_BOOL CIVESStage::Init(AX_U32 nGrp) {
+    if (!CAXStage::Init()) {
+        return AX_FALSE;
+    }
+
     SetCapacity(AX_APP_LOCKQ_CAPACITY);
 
     if (0 == m_stAttr.nGrpCount) {
@@ -179,10 +183,18 @@ AX_BOOL CIVESStage::Start(AX_VOID) {
     return CAXStage::Start(&tStartParams);
 }
 
-AX_BOOL CIVESStage::SendFrame(AX_U32 nSnsID, CAXFrame *pAxFrame) {
+AX_BOOL CIVESStage::AcceptFrame(CAXFrame *pAxFrame) {
     AX_BOOL bEnable = (m_bMDEnable || m_bODEnable || m_bSCDEnable) ? AX_TRUE : AX_FALSE;
     if (!bEnable ||
        (m_spFramectrl && m_spFramectrl->FramerateCtrl())) {
+        return AX_FALSE;
+    }
+
+    return AX_TRUE;
+}
+
+AX_BOOL CIVESStage::SendFrame(AX_U32 nSnsID, CAXFrame *pAxFrame) {
+    if (!AcceptFrame(pAxFrame)) {
         pAxFrame->FreeMem();
         return AX_TRUE;
     }
@@ -101,6 +101,9 @@ public:
     static AX_BOOL InitModule();
     static AX_BOOL DeinitModule();
 
+protected:
+    AX_BOOL AcceptFrame(CAXFrame* pFrame) override;
+
 private:
     AX_VOID NotifyAll(AX_U32 nGrp, AX_U32 nChn, AX_VOID* pStream);
     AX_BOOL GetResolutionByRotate(AX_U8 nRotation, AX_U32& nWidth, AX_U32& nHeight);
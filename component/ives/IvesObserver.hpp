@@ -60,11 +60,16 @@ public:
         m_ChnAttr.nGrp = nGrp;
         m_ChnAttr.nChn = nChn;
         m_ChnAttr.nSnsSrc = pParams->nSnsSrc;
+        if (!m_bProducer) {
+            m_pSink->AddProducer();
+            m_bProducer = AX_TRUE;
+        }
 
         return AX_TRUE;
     }
 
 private:
     CIVESStage* m_pSink{nullptr};
+    AX_BOOL m_bProducer{AX_FALSE};
     IVES_GRP_CHN_ATTR_T m_ChnAttr;
 };
@@ -13,6 +13,8 @@
 #include <chrono>
 #include <map>
 #include "AXFrame.hpp"
+#include "AXFramePool.hpp"
+#include "AXPoolManager.hpp"
 #include "AXThread.hpp"
 #include "AppLogApi.h"
 #include "CmdLineParser.h"
@@ -25,6 +27,7 @@
 #define IVPS "IVPS"
 
 #define MAX_IPC_IVPS_FRAME_TIMEOUT (1000)
+#define IVPS_GET_FRAME_TIMEOUT (95) /* ms, AX_IVPS_GetChnFrame and wait for a pooled frame */
 #define MAX_REGION_GROUP (3)
 #define TDP_CROP_RESIZE_APPLY_GRP (3)
 #define TDP_CROP_RESIZE_APPLY_CHN (0)
@@ -36,9 +39,15 @@ static constexpr AX_S32 g_ivps_nMinFBCWidthFor4K = 720;
 
 CIVPSGrpStage::CIVPSGrpStage(IVPS_GROUP_CFG_T& tGrpConfig) : CAXStage(IVPS), m_tIvpsGrpCfg(tGrpConfig), m_nIvpsGrp(tGrpConfig.nGrp) {
     memcpy(m_arrCfgChnFramerate, m_tIvpsGrpCfg.arrChnFramerate, sizeof(m_tIvpsGrpCfg.arrChnFramerate));
+    /* all groups share stage name, trace each group separately */
+    m_nTracePoint = CLatencyTracer::GetInstance()->RegisterPoint((std::string)IVPS + "_" + std::to_string(m_nIvpsGrp));
 }
 
 AX_BOOL CIVPSGrpStage::Init() {
+    if (!CAXStage::Init()) {
+        return AX_FALSE;
+    }
+
     SetCapacity(AX_APP_LOCKQ_CAPACITY);
 
     return AX_TRUE;
@@ -78,6 +87,8 @@ AX_BOOL CIVPSGrpStage::Start(STAGE_START_PARAM_PTR pStartParams) {
         return AX_FALSE;
     }
 
+    AddUntrackedPoolUsers(tGrp.tPipelineAttr);
+
     for (AX_U8 nChn = 0; nChn < tGrp.tPipelineAttr.nOutChnNum; ++nChn) {
         ret = AX_IVPS_EnableChn(nIvpsGrp, nChn);
         if (AX_SUCCESS != ret) {
@@ -157,6 +168,15 @@ AX_VOID CIVPSGrpStage::FrameGetThreadFunc(IVPS_GET_THREAD_PARAM_PTR pThreadParam
     prctl(PR_SET_NAME, szName);
 
     AX_BOOL bLink = m_tIvpsGrpCfg.arrChnLinkFlag[nIvpsChn] == 0 ? AX_FALSE : AX_TRUE;
+    AX_U16 nTracePoint =
+        CLatencyTracer::GetInstance()->RegisterPoint((std::string)IVPS + "_" + std::to_string(nIvpsGrp) + "_" + std::to_string(nIvpsChn));
+
+    /* pool is kept after thread exits, frames may still be held by observers */
+    CAXFramePool<>& tFramePool = m_arrFramePool[nIvpsChn];
+    if (!tFramePool.IsInited() && !tFramePool.Init(IVPS_INFLIGHT_FRAME_NUM)) {
+        LOG_MM_E(IVPS, "[%d][%d] init frame pool failed", nIvpsGrp, nIvpsChn);
+        return;
+    }
 
     LOG_MM_I(IVPS, "[%d][%d] +++ bLink:%d ", nIvpsGrp, nIvpsChn, bLink);
 
@@ -183,6 +203,12 @@ AX_VOID CIVPSGrpStage::FrameGetThreadFunc(IVPS_GET_THREAD_PARAM_PTR pThreadParam
             }
         }
 
+        /* all frames are held by observers: wait for one released, output is left in ivps fifo meanwhile */
+        CAXFrame* pFrame = tFramePool.Acquire(nullptr, IVPS_GET_FRAME_TIMEOUT);
+        if (!pFrame) {
+            continue;
+        }
+
         if (bNeedDispatchFrame) {
             AX_IVPS_PIPELINE_ATTR_T tPipelineAttr = {0};
             AX_S32 nRet = AX_IVPS_GetPipelineAttr(m_tIvpsGrpCfg.nGrp, &tPipelineAttr);
@@ -192,18 +218,12 @@ AX_VOID CIVPSGrpStage::FrameGetThreadFunc(IVPS_GET_THREAD_PARAM_PTR pThreadParam
             }
         }
 
-        auto spFrame = std::make_unique<CAXFrame>();
-        if (!spFrame) {
-            LOG_M_E(IVPS, "alloc MediaFrame instance fail");
-            continue;
-        }
-
-        nRet = AX_IVPS_GetChnFrame(nIvpsGrp, nIvpsChn, &spFrame->stFrame.stVFrame.stVFrame, 95);
+        nRet = AX_IVPS_GetChnFrame(nIvpsGrp, nIvpsChn, &pFrame->stFrame.stVFrame.stVFrame, IVPS_GET_FRAME_TIMEOUT);
         constexpr AX_S32 nMaxRetrytimes = 10;
         if (bNeedDispatchFrame) {
             AX_S32 nGetTimes = 0;
             while (AX_SUCCESS != nRet && nGetTimes++ < nMaxRetrytimes) {
-                nRet = AX_IVPS_GetChnFrame(nIvpsGrp, nIvpsChn, &spFrame->stFrame.stVFrame.stVFrame, 95);
+                nRet = AX_IVPS_GetChnFrame(nIvpsGrp, nIvpsChn, &pFrame->stFrame.stVFrame.stVFrame, IVPS_GET_FRAME_TIMEOUT);
                 CElapsedTimer::GetInstance()->mSleep(100);
             }
             AX_IVPS_PIPELINE_ATTR_T tPipelineAttr = {0};
@@ -214,6 +234,7 @@ AX_VOID CIVPSGrpStage::FrameGetThreadFunc(IVPS_GET_THREAD_PARAM_PTR pThreadParam
             }
         }
         if (AX_SUCCESS != nRet) {
+            tFramePool.Release(pFrame);
             if (AX_ERR_IVPS_BUF_EMPTY == nRet) {
                 CElapsedTimer::GetInstance()->mSleep(1);
                 continue;
@@ -224,21 +245,32 @@ AX_VOID CIVPSGrpStage::FrameGetThreadFunc(IVPS_GET_THREAD_PARAM_PTR pThreadParam
             continue;
         }
         LOG_MM_D(IVPS, "[%d][%d] Seq: %lld, w:%d, h:%d, size:%u, release:%p,PhyAddr:%lld", nIvpsGrp, nIvpsChn,
-                 spFrame->stFrame.stVFrame.stVFrame.u64SeqNum, spFrame->stFrame.stVFrame.stVFrame.u32Width,
-                 spFrame->stFrame.stVFrame.stVFrame.u32Height, spFrame->stFrame.stVFrame.stVFrame.u32FrameSize, pThreadParam->pReleaseStage,
-                 spFrame->stFrame.stVFrame.stVFrame.u64PhyAddr[0]);
+                 pFrame->stFrame.stVFrame.stVFrame.u64SeqNum, pFrame->stFrame.stVFrame.stVFrame.u32Width,
+                 pFrame->stFrame.stVFrame.stVFrame.u32Height, pFrame->stFrame.stVFrame.stVFrame.u32FrameSize, pThreadParam->pReleaseStage,
+                 pFrame->stFrame.stVFrame.stVFrame.u64PhyAddr[0]);
 
         if (pThreadParam->nChnEnable) {
-            spFrame->nGrp = nIvpsGrp;
-            spFrame->nChn = nIvpsChn;
-            spFrame->pFrameRelease = pThreadParam->pReleaseStage;
-            NotifyAll(nIvpsGrp, nIvpsChn, spFrame.release());
+            pFrame->nGrp = nIvpsGrp;
+            pFrame->nChn = nIvpsChn;
+            pFrame->pFrameRelease = pThreadParam->pReleaseStage;
+            if (CAXPoolManager::GetInstance()->IsTracking()) {
+                CAXPoolManager::GetInstance()->TrackAcquire(POOL_OWNER_ID(POOL_OWNER_MOD_IVPS, nIvpsGrp, nIvpsChn),
+                                                            pFrame->stFrame.stVFrame.stVFrame.u32BlkId[0],
+                                                            pFrame->stFrame.stVFrame.stVFrame.u32FrameSize,
+                                                            m_tIvpsGrpCfg.arrChnOutFifoDepth[nIvpsChn]);
+            }
+            if (CLatencyTracer::GetInstance()->IsEnabled()) {
+                pFrame->tTrail.Start(nTracePoint, pFrame->stFrame.stVFrame.stVFrame.u64SeqNum, CLatencyTracer::NowUs());
+            }
+            NotifyAll(nIvpsGrp, nIvpsChn, pFrame);
         } else {
-            AX_IVPS_ReleaseChnFrame(nIvpsGrp, nIvpsChn, &spFrame->stFrame.stVFrame.stVFrame);
+            AX_IVPS_ReleaseChnFrame(nIvpsGrp, nIvpsChn, &pFrame->stFrame.stVFrame.stVFrame);
+            tFramePool.Release(pFrame);
         }
     }
 
-    LOG_MM(IVPS, "[%d][%d] ---", nIvpsGrp, nIvpsChn);
+    LOG_MM(IVPS, "[%d][%d] --- frame pool peak %d/%d, exhausted %lld", nIvpsGrp, nIvpsChn, tFramePool.GetPeakCount(),
+           tFramePool.GetCapacity(), tFramePool.GetExhaustedCount());
 }
 
 AX_VOID CIVPSGrpStage::VideoFrameRelease(CAXFrame* pFrame) {
@@ -246,8 +278,13 @@ AX_VOID CIVPSGrpStage::VideoFrameRelease(CAXFrame* pFrame) {
         if (!pFrame->bMultiplex || pFrame->DecFrmRef() == 0) {
             LOG_M_D(IVPS, "[%d][%d] AX_IVPS_ReleaseChnFrame, seq=%lld, pFrqame:%p", pFrame->nGrp, pFrame->nChn,
                     pFrame->stFrame.stVFrame.stVFrame.u64SeqNum, pFrame);
+            if (CAXPoolManager::GetInstance()->IsTracking()) {
+                CAXPoolManager::GetInstance()->TrackRelease(POOL_OWNER_ID(POOL_OWNER_MOD_IVPS, pFrame->nGrp, pFrame->nChn),
+                                                            pFrame->stFrame.stVFrame.stVFrame.u32BlkId[0]);
+            }
+            CLatencyTracer::GetInstance()->Collect(pFrame->tTrail);
             AX_IVPS_ReleaseChnFrame(pFrame->nGrp, pFrame->nChn, &pFrame->stFrame.stVFrame.stVFrame);
-            delete pFrame;
+            m_arrFramePool[pFrame->nChn].Release(pFrame);
         }
     }
 }
@@ -290,7 +327,7 @@ AX_VOID CIVPSGrpStage::StartWorkThread() {
     /* Start frame get thread */
     for (AX_U8 nChn = 0; nChn < m_tIvpsGrp.tPipelineAttr.nOutChnNum; ++nChn) {
         const auto& vecObserver = m_mapChnObserver[nChn];
-        if (vecObserver.empty()) {
+        if (vecObserver.empty() && !HasNextStage(IVPS_CHN_PORT(nChn))) {
             continue;
         }
 
@@ -478,21 +515,51 @@ AX_BOOL CIVPSGrpStage::InitParams() {
     return AX_TRUE;
 }
 
+AX_VOID CIVPSGrpStage::AddUntrackedPoolUsers(const AX_IVPS_PIPELINE_ATTR_T& tPipelineAttr) {
+    /* frames of these filters stay inside IVPS or go to next module by link, app never gets their blocks */
+    CAXPoolManager* pPoolMgr = CAXPoolManager::GetInstance();
+    for (AX_U8 i = 0; i < 2; i++) {
+        const auto& tFilter = tPipelineAttr.tFilter[0][i];
+        if (tFilter.bEngage && !tFilter.bInplace) {
+            pPoolMgr->AddUntrackedUser(POOL_OWNER_ID(POOL_OWNER_MOD_IVPS, m_nIvpsGrp, POOL_OWNER_CHN_INTERNAL), tFilter.nDstPicStride,
+                                       tFilter.nDstPicHeight, tFilter.tCompressInfo);
+        }
+    }
+
+    for (AX_U8 nChn = 0; nChn < tPipelineAttr.nOutChnNum; nChn++) {
+        const auto& tFilter0 = tPipelineAttr.tFilter[nChn + 1][0];
+        const auto& tFilter1 = tPipelineAttr.tFilter[nChn + 1][1];
+        AX_U32 nOwner = POOL_OWNER_ID(POOL_OWNER_MOD_IVPS, m_nIvpsGrp, nChn);
+        AX_BOOL bFilter1Out = (tFilter1.bEngage && !tFilter1.bInplace) ? AX_TRUE : AX_FALSE;
+        if (tFilter0.bEngage && !tFilter0.bInplace && (bFilter1Out || m_tIvpsGrpCfg.arrChnLinkFlag[nChn])) {
+            pPoolMgr->AddUntrackedUser(nOwner, tFilter0.nDstPicStride, tFilter0.nDstPicHeight, tFilter0.tCompressInfo);
+        }
+
+        if (bFilter1Out && m_tIvpsGrpCfg.arrChnLinkFlag[nChn]) {
+            pPoolMgr->AddUntrackedUser(nOwner, tFilter1.nDstPicStride, tFilter1.nDstPicHeight, tFilter1.tCompressInfo);
+        }
+    }
+}
+
 AX_VOID CIVPSGrpStage::SetChnInplace(AX_S32 nChannel, AX_BOOL bEnable) {
     AX_S32 nChnFilter = nChannel + 1;
     m_tIvpsGrp.tPipelineAttr.tFilter[nChnFilter][1].bInplace = bEnable;
 }
 
+AX_VOID CIVPSGrpStage::GetChnTransAttr(AX_S32 nChannel, OBS_TRANS_ATTR_T& tTransAttr) {
+    tTransAttr.fSrcFramerate = m_tIvpsGrpCfg.arrChnFramerate[nChannel][0]; /*0: src framerate*/
+    tTransAttr.fFramerate = m_tIvpsGrpCfg.arrChnFramerate[nChannel][1];    /* 1: Out framerate */
+    tTransAttr.nWidth = m_tIvpsGrpCfg.arrChnResolution[nChannel][0];
+    tTransAttr.nHeight = m_tIvpsGrpCfg.arrChnResolution[nChannel][1];
+    tTransAttr.bEnableFBC = m_tIvpsGrpCfg.arrChnFBC[nChannel][0] == 0 ? AX_FALSE : AX_TRUE;
+    tTransAttr.bLink = m_tIvpsGrpCfg.arrChnLinkFlag[nChannel] == 0 ? AX_FALSE : AX_TRUE;
+    tTransAttr.nSnsSrc = m_tIvpsGrpCfg.nSnsSrc;
+}
+
 AX_VOID CIVPSGrpStage::RegObserver(AX_S32 nChannel, IObserver* pObserver) {
     if (nullptr != pObserver) {
         OBS_TRANS_ATTR_T tTransAttr;
-        tTransAttr.fSrcFramerate = m_tIvpsGrpCfg.arrChnFramerate[nChannel][0]; /*0: src framerate*/
-        tTransAttr.fFramerate = m_tIvpsGrpCfg.arrChnFramerate[nChannel][1];    /* 1: Out framerate */
-        tTransAttr.nWidth = m_tIvpsGrpCfg.arrChnResolution[nChannel][0];
-        tTransAttr.nHeight = m_tIvpsGrpCfg.arrChnResolution[nChannel][1];
-        tTransAttr.bEnableFBC = m_tIvpsGrpCfg.arrChnFBC[nChannel][0] == 0 ? AX_FALSE : AX_TRUE;
-        tTransAttr.bLink = m_tIvpsGrpCfg.arrChnLinkFlag[nChannel] == 0 ? AX_FALSE : AX_TRUE;
-        tTransAttr.nSnsSrc = m_tIvpsGrpCfg.nSnsSrc;
+        GetChnTransAttr(nChannel, tTransAttr);
         if (pObserver->OnRegisterObserver(E_OBS_TARGET_TYPE_IVPS, m_nIvpsGrp, nChannel, &tTransAttr)) {
             std::lock_guard<std::mutex> lock(m_mtxObserver);
             auto& vecObserver = m_mapChnObserver[nChannel];
@@ -501,6 +568,27 @@ AX_VOID CIVPSGrpStage::RegObserver(AX_S32 nChannel, IObserver* pObserver) {
     }
 }
 
+AX_BOOL CIVPSGrpStage::BindChnStage(AX_S32 nChannel, CAXStage* pNext, IObserver* pAttrObserver, STAGE_DROP_POLICY_E ePolicy) {
+    if (nullptr == pNext) {
+        return AX_FALSE;
+    }
+
+    if (nullptr != pAttrObserver) {
+        OBS_TRANS_ATTR_T tTransAttr;
+        GetChnTransAttr(nChannel, tTransAttr);
+        if (!pAttrObserver->OnRegisterObserver(E_OBS_TARGET_TYPE_IVPS, m_nIvpsGrp, nChannel, &tTransAttr)) {
+            return AX_FALSE;
+        }
+    }
+
+    if (!BindNextStage(pNext, IVPS_CHN_PORT(nChannel), ePolicy)) {
+        LOG_MM_E(IVPS, "[%d][%d] bind stage %s failed", m_nIvpsGrp, nChannel, pNext->GetStageName().c_str());
+        return AX_FALSE;
+    }
+
+    return AX_TRUE;
+}
+
 AX_VOID CIVPSGrpStage::UnregObserver(AX_S32 nChannel, IObserver* pObserver) {
     if (nullptr == pObserver) {
         return;
@@ -517,10 +605,11 @@ AX_VOID CIVPSGrpStage::UnregObserver(AX_S32 nChannel, IObserver* pObserver) {
 }
 
 AX_VOID CIVPSGrpStage::NotifyAll(AX_U32 nGrp, AX_U32 nChn, CAXFrame* pFrame) {
-    std::lock_guard<std::mutex> lock(m_mtxObserver);
+    std::unique_lock<std::mutex> lock(m_mtxObserver);
     auto& vecObserver = m_mapChnObserver[nChn];
     if (vecObserver.empty()) {
-        pFrame->FreeMem();
+        lock.unlock();
+        DispatchFrame(IVPS_CHN_PORT(nChn), pFrame);
         return;
     }
 
@@ -528,9 +617,25 @@ AX_VOID CIVPSGrpStage::NotifyAll(AX_U32 nGrp, AX_U32 nChn, CAXFrame* pFrame) {
         pFrame->IncFrmRef();
     }
     pFrame->bMultiplex = AX_TRUE;
+
+    /* frame is held by the reference above until FreeMem, safe to stamp after callbacks */
+    CLatencyTracer* pTracer = CLatencyTracer::GetInstance();
+    AX_U16 nSource = pFrame->tTrail.GetSource();
+    CLatencyHistogram* pNotify = pTracer->GetHistogram(nSource, LATENCY_HIST_NOTIFY);
     for (auto it : vecObserver) {
         pFrame->IncFrmRef();
+        AX_U64 nStart = pNotify ? CLatencyTracer::NowUs() : 0;
         it->OnRecvData(E_OBS_TARGET_TYPE_IVPS, m_nIvpsGrp, nChn, pFrame);
+        if (pNotify) {
+            pNotify->Record(CLatencyTracer::NowUs() - nStart);
+        }
+    }
+    lock.unlock();
+
+    /* edges with blocking policy may wait, never under observer lock */
+    DeliverToEdges(IVPS_CHN_PORT(nChn), pFrame);
+    if (pNotify) {
+        pFrame->tTrail.Stamp(nSource, LATENCY_STAMP_NOTIFY, CLatencyTracer::NowUs());
     }
     pFrame->FreeMem();
 }
@@ -641,6 +746,7 @@ AX_BOOL CIVPSGrpStage::UpdateRotationResolution(AX_IVPS_ROTATION_E eRotation, AX
         LOG_M_E(IVPS, "AX_IVPS_SetPipelineAttr(Grp %d) failed, ret=0x%x", m_tIvpsGrpCfg.nGrp, nRet);
         return AX_FALSE;
     }
+    AddUntrackedPoolUsers(tPipelineAttr);
 
     return AX_TRUE;
 }
@@ -726,6 +832,7 @@ AX_BOOL CIVPSGrpStage::UpdateChnResolution(AX_U8 nChn, AX_S32 nWidth, AX_S32 nHe
         LOG_M_E(IVPS, "AX_IVPS_SetPipelineAttr(Grp %d) failed, ret=0x%x", m_tIvpsGrpCfg.nGrp, nRet);
         return AX_FALSE;
     }
+    AddUntrackedPoolUsers(tPipelineAttr);
     m_tIvpsGrpCfg.arrChnResolution[nChn][0] = tPipelineAttr.tFilter[nChn + 1][1].nDstPicWidth;
     m_tIvpsGrpCfg.arrChnResolution[nChn][1] = tPipelineAttr.tFilter[nChn + 1][1].nDstPicHeight;
 
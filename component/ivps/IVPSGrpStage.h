@@ -11,6 +11,7 @@
 #pragma once
 
 #include <map>
+#include "AXFramePool.hpp"
 #include "AXStage.hpp"
 // #include "BmpOSD.hpp"
 #include "GlobalDef.h"
@@ -25,8 +26,12 @@ class CIVPSGrpStage;
 // AX620E TODO: 16->10?
 #define MAX_IVPS_GROUP_NUM (10)
 #define IVPS_MAX_CHANNEL_PER_GROUP (5)
+/* output frames of one chn held by observers, bounded by blocks of its pool in practice */
+#define IVPS_INFLIGHT_FRAME_NUM (32)
 #define IVPS_IN_FIFO_DEPTH (2)
 #define IVPS_OUT_FIFO_DEPTH (2)
+/* stage edge port of a channel output, port 0 is output of stage thread (frames sent to ivps) */
+#define IVPS_CHN_PORT(nChn) ((AX_U32)(nChn) + 1)
 
 typedef AX_S32 AX_IVPS_FILTER;
 typedef struct _IVPS_GROUP_CFG_T {
@@ -119,6 +124,8 @@ public:
 
     AX_VOID RegObserver(AX_S32 nChannel, IObserver* pObserver);
     AX_VOID UnregObserver(AX_S32 nChannel, IObserver* pObserver);
+    /* deliver channel output to pNext by a stage edge, pAttrObserver only receives channel attributes */
+    AX_BOOL BindChnStage(AX_S32 nChannel, CAXStage* pNext, IObserver* pAttrObserver, STAGE_DROP_POLICY_E ePolicy);
 
     virtual AX_BOOL ProcessFrame(CAXFrame* pFrame) override;
     virtual AX_VOID VideoFrameRelease(CAXFrame* pFrame) override;
@@ -183,6 +190,7 @@ public:
 
 private:
     AX_VOID NotifyAll(AX_U32 nGrp, AX_U32 nChn, CAXFrame* pFrame);
+    AX_VOID GetChnTransAttr(AX_S32 nChannel, OBS_TRANS_ATTR_T& tTransAttr);
     AX_VOID StartWorkThread();
     AX_VOID StopWorkThread();
     AX_VOID FrameGetThreadFunc(IVPS_GET_THREAD_PARAM_PTR pThreadParam);
@@ -191,6 +199,7 @@ private:
     AX_BOOL UpdateRotationResolution(AX_IVPS_ROTATION_E eRotation, AX_U8 nChn, AX_U32 nWidth, AX_U32 nHeight);
 
     AX_VOID UpdateCompressInfo(AX_FRAME_COMPRESS_INFO_T& tCompressInfo, AX_U16 nChnWidth);
+    AX_VOID AddUntrackedPoolUsers(const AX_IVPS_PIPELINE_ATTR_T& tPipelineAttr);
 
 private:
     AX_BOOL m_bStarted{AX_FALSE};
@@ -200,6 +209,7 @@ private:
     IVPS_GRP_T m_tIvpsGrp;
     IVPS_GET_THREAD_PARAM_T m_tGetThreadParam[IVPS_MAX_CHANNEL_PER_GROUP];
     std::thread m_hGetThread[IVPS_MAX_CHANNEL_PER_GROUP];
+    CAXFramePool<> m_arrFramePool[IVPS_MAX_CHANNEL_PER_GROUP];
     std::map<AX_U32, AX_BOOL> m_mapChnState;
     std::map<AX_U32, std::vector<IObserver*>> m_mapChnObserver;
     std::mutex m_mtxObserver;
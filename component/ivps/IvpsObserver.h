@@ -75,11 +75,16 @@ public:
         }
 
         m_nTargetPipeChannel = eTarget << 24 | nGrp << 16 | nChn;
+        if (!m_bProducer) {
+            m_pSink->AddProducer();
+            m_bProducer = AX_TRUE;
+        }
 
         return AX_TRUE;
     }
 
 private:
     CIVPSGrpStage* m_pSink{nullptr};
+    AX_BOOL m_bProducer{AX_FALSE};
     AX_U32 m_nTargetPipeChannel{0};
 };
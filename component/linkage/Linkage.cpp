@@ -9,6 +9,7 @@
  **************************************************************************************************/
 
 #include "Linkage.h"
+#include <algorithm>
 #include "CommonUtils.hpp"
 #include "PPLOptionHelper.h"
 #include "SensorOptionHelper.h"
@@ -17,6 +18,29 @@ using namespace std;
 
 #define LINKAGE "LINKAGE"
 
+namespace {
+typedef enum {
+    LINK_KEY_SRC_CHN = 0,
+    LINK_KEY_SRC_GRP = 1,     /* channel ignored */
+    LINK_KEY_DST_CHN = 2,
+    LINK_KEY_DST_GRP = 3,     /* channel ignored */
+    LINK_KEY_DST_TYPE_CHN = 4 /* group ignored, for SetLinkMode and UpdateRelation */
+} LINK_KEY_TYPE_E;
+
+inline AX_U64 LinkKey(LINK_KEY_TYPE_E eType, PPL_MODULE_TYPE_E eModType, AX_S32 nGroup, AX_S32 nChannel) {
+    return ((AX_U64)eType << 56) | ((AX_U64)(eModType & 0xFF) << 48) | ((AX_U64)(AX_U16)nGroup << 32) | (AX_U32)nChannel;
+}
+
+inline AX_U64 LinkKey(LINK_KEY_TYPE_E eType, const IPC_MOD_INFO_T& tMod) {
+    return LinkKey(eType, tMod.eModType, tMod.nGroup, tMod.nChannel);
+}
+
+/* module node of start/stop order */
+inline AX_U64 ModKey(const IPC_MOD_INFO_T& tMod) {
+    return LinkKey(LINK_KEY_SRC_GRP, tMod.eModType, tMod.nGroup, 0);
+}
+}  // namespace
+
 AX_BOOL CLinkage::Setup() {
     vector<IPC_MOD_RELATIONSHIP_T> vecRelations;
     if (!GetCurrRelations(vecRelations)) {
@@ -37,6 +61,8 @@ AX_BOOL CLinkage::Setup() {
         }
     }
     m_vecRelations.swap(vecRelations);
+    BuildIndex();
+    BuildOrder();
     return AX_TRUE;
 }
 
@@ -61,33 +87,37 @@ AX_BOOL CLinkage::Release() {
 }
 
 AX_BOOL CLinkage::SetLinkMode(PPL_MODULE_TYPE_E eModule, AX_S32 nChn, AX_BOOL bLink) {
-    for (auto& relation : m_vecRelations) {
-        if (eModule == relation.tDstModChn.eModType && relation.tDstModChn.nChannel == nChn) {
-            LINK_MOD_INFO_T tLinkInfo;
-            tLinkInfo.tSrcModChn.eModType = relation.tSrcModChn.eModType;
-            tLinkInfo.tSrcModChn.nGroup = relation.tSrcModChn.nGroup;
-            tLinkInfo.tSrcModChn.nChannel = relation.tSrcModChn.nChannel;
-            tLinkInfo.tDstModChn.eModType = relation.tDstModChn.eModType;
-            tLinkInfo.tDstModChn.nGroup = relation.tDstModChn.nGroup;
-            tLinkInfo.tDstModChn.nChannel = relation.tDstModChn.nChannel;
-            LOG_MM_D(LINKAGE, "bLink:%d Src[module:%d %d,%d], Dst[module:%d %d,%d]", bLink, relation.tSrcModChn.eModType,
-                     relation.tSrcModChn.nGroup, relation.tSrcModChn.nChannel, relation.tDstModChn.eModType, relation.tDstModChn.nGroup,
-                     relation.tDstModChn.nChannel);
-            if (AX_FALSE == bLink) {
-                if (AX_SUCCESS != Unlink(tLinkInfo)) {
-                    LOG_MM_E(LINKAGE, "Unlink(Src[module:%d %d,%d], Dst[module:%d %d,%d]) Failed.", relation.tSrcModChn.eModType,
-                             relation.tSrcModChn.nGroup, relation.tSrcModChn.nChannel, relation.tDstModChn.eModType,
-                             relation.tDstModChn.nGroup, relation.tDstModChn.nChannel);
-                } else {
-                    relation.bLink = AX_FALSE;
-                }
+    const std::vector<AX_U32>* pIndexes = FindRelations(LinkKey(LINK_KEY_DST_TYPE_CHN, eModule, 0, nChn));
+    if (!pIndexes) {
+        return AX_TRUE;
+    }
+
+    for (const auto nIndex : *pIndexes) {
+        auto& relation = m_vecRelations[nIndex];
+        LINK_MOD_INFO_T tLinkInfo;
+        tLinkInfo.tSrcModChn.eModType = relation.tSrcModChn.eModType;
+        tLinkInfo.tSrcModChn.nGroup = relation.tSrcModChn.nGroup;
+        tLinkInfo.tSrcModChn.nChannel = relation.tSrcModChn.nChannel;
+        tLinkInfo.tDstModChn.eModType = relation.tDstModChn.eModType;
+        tLinkInfo.tDstModChn.nGroup = relation.tDstModChn.nGroup;
+        tLinkInfo.tDstModChn.nChannel = relation.tDstModChn.nChannel;
+        LOG_MM_D(LINKAGE, "bLink:%d Src[module:%d %d,%d], Dst[module:%d %d,%d]", bLink, relation.tSrcModChn.eModType,
+                 relation.tSrcModChn.nGroup, relation.tSrcModChn.nChannel, relation.tDstModChn.eModType, relation.tDstModChn.nGroup,
+                 relation.tDstModChn.nChannel);
+        if (AX_FALSE == bLink) {
+            if (AX_SUCCESS != Unlink(tLinkInfo)) {
+                LOG_MM_E(LINKAGE, "Unlink(Src[module:%d %d,%d], Dst[module:%d %d,%d]) Failed.", relation.tSrcModChn.eModType,
+                         relation.tSrcModChn.nGroup, relation.tSrcModChn.nChannel, relation.tDstModChn.eModType,
+                         relation.tDstModChn.nGroup, relation.tDstModChn.nChannel);
             } else {
-                if (AX_SUCCESS != Link(tLinkInfo)) {
-                    LOG_MM_E(LINKAGE, "link(Src[%d,%d], Dst[%d,%d]) Failed.", relation.tSrcModChn.nGroup, relation.tSrcModChn.nChannel,
-                             relation.tDstModChn.nGroup, relation.tDstModChn.nChannel);
-                } else {
-                    relation.bLink = AX_TRUE;
-                }
+                relation.bLink = AX_FALSE;
+            }
+        } else {
+            if (AX_SUCCESS != Link(tLinkInfo)) {
+                LOG_MM_E(LINKAGE, "link(Src[%d,%d], Dst[%d,%d]) Failed.", relation.tSrcModChn.nGroup, relation.tSrcModChn.nChannel,
+                         relation.tDstModChn.nGroup, relation.tDstModChn.nChannel);
+            } else {
+                relation.bLink = AX_TRUE;
             }
         }
     }
@@ -96,36 +126,39 @@ AX_BOOL CLinkage::SetLinkMode(PPL_MODULE_TYPE_E eModule, AX_S32 nChn, AX_BOOL bL
 
 AX_BOOL CLinkage::UpdateRelation(PPL_MODULE_TYPE_E eOldModule, AX_S32 nOldChn, PPL_MODULE_TYPE_E eDstModule, AX_S32 nDstGrp, AX_S32 nDstChn,
                                  AX_BOOL bLink) {
-    for (auto& relation : m_vecRelations) {
-        if (eOldModule == relation.tDstModChn.eModType && relation.tDstModChn.nChannel == nOldChn) {
-            if (bLink) {
-                LINK_MOD_INFO_T tLinkInfo;
-                tLinkInfo.tSrcModChn = relation.tSrcModChn;
-                tLinkInfo.tDstModChn = relation.tDstModChn;
-                if (AX_SUCCESS != Unlink(tLinkInfo)) {
-                    return AX_FALSE;
-                }
-                relation.bLink = AX_FALSE;
-                sleep(1);
-            }
+    const std::vector<AX_U32>* pIndexes = FindRelations(LinkKey(LINK_KEY_DST_TYPE_CHN, eOldModule, 0, nOldChn));
+    if (!pIndexes) {
+        return AX_TRUE;
+    }
 
-            {
-                LINK_MOD_INFO_T tLinkInfo;
-                tLinkInfo.tSrcModChn = relation.tSrcModChn;
-                tLinkInfo.tDstModChn.eModType = eDstModule;
-                tLinkInfo.tDstModChn.nGroup = nDstGrp;
-                tLinkInfo.tDstModChn.nChannel = nDstChn;
-                if (bLink && (AX_SUCCESS != Link(tLinkInfo))) {
-                    return AX_FALSE;
-                }
-
-                relation.tDstModChn.eModType = tLinkInfo.tDstModChn.eModType;
-                relation.tDstModChn.nGroup = tLinkInfo.tDstModChn.nGroup;
-                relation.tDstModChn.nChannel = tLinkInfo.tDstModChn.nChannel;
-            }
-            break;
+    auto& relation = m_vecRelations[pIndexes->front()];
+    if (bLink) {
+        LINK_MOD_INFO_T tLinkInfo;
+        tLinkInfo.tSrcModChn = relation.tSrcModChn;
+        tLinkInfo.tDstModChn = relation.tDstModChn;
+        if (AX_SUCCESS != Unlink(tLinkInfo)) {
+            return AX_FALSE;
         }
+        relation.bLink = AX_FALSE;
+        sleep(1);
+    }
+
+    LINK_MOD_INFO_T tLinkInfo;
+    tLinkInfo.tSrcModChn = relation.tSrcModChn;
+    tLinkInfo.tDstModChn.eModType = eDstModule;
+    tLinkInfo.tDstModChn.nGroup = nDstGrp;
+    tLinkInfo.tDstModChn.nChannel = nDstChn;
+    if (bLink && (AX_SUCCESS != Link(tLinkInfo))) {
+        return AX_FALSE;
     }
+
+    relation.tDstModChn.eModType = tLinkInfo.tDstModChn.eModType;
+    relation.tDstModChn.nGroup = tLinkInfo.tDstModChn.nGroup;
+    relation.tDstModChn.nChannel = tLinkInfo.tDstModChn.nChannel;
+
+    /* destination changed, pIndexes is invalid after this */
+    BuildIndex();
+    BuildOrder();
     return AX_TRUE;
 }
 
@@ -136,11 +169,11 @@ const AX_BOOL CLinkage::GetCurrRelations(vector<IPC_MOD_RELATIONSHIP_T>& vecRela
 }
 
 IPC_MOD_RELATIONSHIP_T CLinkage::GetRelation(const LINK_MOD_INFO_T& tModLink) const {
-    for (const auto relation : m_vecRelations) {
-        if (relation.Valid()) {
-            if (CCommonUtils::ModuleEqual(relation.tSrcModChn, tModLink.tSrcModChn) &&
-                CCommonUtils::ModuleEqual(relation.tDstModChn, tModLink.tDstModChn)) {
-                return relation;
+    const std::vector<AX_U32>* pIndexes = FindRelations(LinkKey(LINK_KEY_SRC_CHN, tModLink.tSrcModChn));
+    if (pIndexes) {
+        for (const auto nIndex : *pIndexes) {
+            if (CCommonUtils::ModuleEqual(m_vecRelations[nIndex].tDstModChn, tModLink.tDstModChn)) {
+                return m_vecRelations[nIndex];
             }
         }
     }
@@ -150,11 +183,11 @@ IPC_MOD_RELATIONSHIP_T CLinkage::GetRelation(const LINK_MOD_INFO_T& tModLink) co
 
 AX_BOOL CLinkage::GetRelationsBySrcMod(const IPC_MOD_INFO_T& tSrcMod, vector<IPC_MOD_RELATIONSHIP_T>& vecOutRelations,
                                        AX_BOOL bIgnoreChn /*= AX_FALSE*/) const {
-    for (const auto& relation : m_vecRelations) {
-        if (relation.Valid()) {
-            if (CCommonUtils::ModuleEqual(relation.tSrcModChn, tSrcMod, bIgnoreChn)) {
-                vecOutRelations.emplace_back(relation);
-            }
+    const std::vector<AX_U32>* pIndexes = FindRelations(LinkKey(bIgnoreChn ? LINK_KEY_SRC_GRP : LINK_KEY_SRC_CHN, tSrcMod.eModType,
+                                                                tSrcMod.nGroup, bIgnoreChn ? 0 : tSrcMod.nChannel));
+    if (pIndexes) {
+        for (const auto nIndex : *pIndexes) {
+            vecOutRelations.emplace_back(m_vecRelations[nIndex]);
         }
     }
 
@@ -163,11 +196,11 @@ AX_BOOL CLinkage::GetRelationsBySrcMod(const IPC_MOD_INFO_T& tSrcMod, vector<IPC
 
 AX_BOOL CLinkage::GetRelationsByDstMod(const IPC_MOD_INFO_T& tDstMod, vector<IPC_MOD_RELATIONSHIP_T>& vecOutRelations,
                                        AX_BOOL bIgnoreChn /*= AX_FALSE*/) const {
-    for (const auto& relation : m_vecRelations) {
-        if (relation.Valid()) {
-            if (CCommonUtils::ModuleEqual(relation.tDstModChn, tDstMod, bIgnoreChn)) {
-                vecOutRelations.emplace_back(relation);
-            }
+    const std::vector<AX_U32>* pIndexes = FindRelations(LinkKey(bIgnoreChn ? LINK_KEY_DST_GRP : LINK_KEY_DST_CHN, tDstMod.eModType,
+                                                                tDstMod.nGroup, bIgnoreChn ? 0 : tDstMod.nChannel));
+    if (pIndexes) {
+        for (const auto nIndex : *pIndexes) {
+            vecOutRelations.emplace_back(m_vecRelations[nIndex]);
         }
     }
 
@@ -175,18 +208,106 @@ AX_BOOL CLinkage::GetRelationsByDstMod(const IPC_MOD_INFO_T& tDstMod, vector<IPC
 }
 
 AX_BOOL CLinkage::GetPrecedingMod(const IPC_MOD_INFO_T& tDstMod, IPC_MOD_INFO_T& tPrecedingMod) const {
+    const std::vector<AX_U32>* pIndexes = FindRelations(LinkKey(LINK_KEY_DST_CHN, tDstMod));
+    if (pIndexes) {
+        const auto& relation = m_vecRelations[pIndexes->front()];
+        if (relation.tSrcModChn.eModType == tPrecedingMod.eModType) {
+            tPrecedingMod = relation.tSrcModChn;
+            return AX_TRUE;
+        } else {
+            return GetPrecedingMod(relation.tSrcModChn, tPrecedingMod);
+        }
+    }
+
+    return AX_FALSE;
+}
+
+const std::vector<AX_U32>* CLinkage::FindRelations(AX_U64 nKey) const {
+    auto it = m_mapRelations.find(nKey);
+    return (it != m_mapRelations.end()) ? &it->second : nullptr;
+}
+
+AX_VOID CLinkage::BuildIndex(AX_VOID) {
+    m_mapRelations.clear();
+    m_mapRelations.reserve(m_vecRelations.size() * 5);
+
+    for (AX_U32 i = 0; i < m_vecRelations.size(); ++i) {
+        const auto& relation = m_vecRelations[i];
+        if (!relation.Valid()) {
+            continue;
+        }
+
+        const IPC_MOD_INFO_T& tSrc = relation.tSrcModChn;
+        const IPC_MOD_INFO_T& tDst = relation.tDstModChn;
+        m_mapRelations[LinkKey(LINK_KEY_SRC_CHN, tSrc)].push_back(i);
+        m_mapRelations[LinkKey(LINK_KEY_SRC_GRP, tSrc.eModType, tSrc.nGroup, 0)].push_back(i);
+        m_mapRelations[LinkKey(LINK_KEY_DST_CHN, tDst)].push_back(i);
+        m_mapRelations[LinkKey(LINK_KEY_DST_GRP, tDst.eModType, tDst.nGroup, 0)].push_back(i);
+        m_mapRelations[LinkKey(LINK_KEY_DST_TYPE_CHN, tDst.eModType, 0, tDst.nChannel)].push_back(i);
+    }
+}
+
+AX_VOID CLinkage::BuildOrder(AX_VOID) {
+    /* Kahn's algorithm on module groups, ties keep the order of first appearance in ppl.json */
+    std::vector<IPC_MOD_INFO_T> vecMods;
+    std::unordered_map<AX_U64, AX_U32> mapMod2Node;
+    std::vector<std::vector<AX_U32>> vecSuccessors;
+    std::vector<AX_U32> vecInDegree;
+    auto fnNode = [&](const IPC_MOD_INFO_T& tMod) -> AX_U32 {
+        auto it = mapMod2Node.find(ModKey(tMod));
+        if (it != mapMod2Node.end()) {
+            return it->second;
+        }
+
+        AX_U32 nNode = (AX_U32)vecMods.size();
+        mapMod2Node[ModKey(tMod)] = nNode;
+        vecMods.push_back({tMod.eModType, tMod.nGroup, 0});
+        vecSuccessors.emplace_back();
+        vecInDegree.push_back(0);
+        return nNode;
+    };
+
     for (const auto& relation : m_vecRelations) {
         if (relation.Valid()) {
-            if (CCommonUtils::ModuleEqual(relation.tDstModChn, tDstMod, AX_FALSE)) {
-                if (relation.tSrcModChn.eModType == tPrecedingMod.eModType) {
-                    tPrecedingMod = relation.tSrcModChn;
-                    return AX_TRUE;
-                } else {
-                    return GetPrecedingMod(relation.tSrcModChn, tPrecedingMod);
-                }
+            AX_U32 nSrc = fnNode(relation.tSrcModChn);
+            AX_U32 nDst = fnNode(relation.tDstModChn);
+            if (nSrc != nDst && std::find(vecSuccessors[nSrc].begin(), vecSuccessors[nSrc].end(), nDst) == vecSuccessors[nSrc].end()) {
+                vecSuccessors[nSrc].push_back(nDst);
+                vecInDegree[nDst]++;
             }
         }
     }
 
-    return AX_FALSE;
+    const AX_U32 nNodeCount = (AX_U32)vecMods.size();
+    std::vector<AX_U32> vecTopo;
+    vecTopo.reserve(nNodeCount);
+    for (AX_U32 i = 0; i < nNodeCount; ++i) {
+        if (0 == vecInDegree[i]) {
+            vecTopo.push_back(i);
+        }
+    }
+
+    for (AX_U32 nHead = 0; nHead < vecTopo.size(); ++nHead) {
+        AX_U32 nNode = vecTopo[nHead];
+        for (const auto nNext : vecSuccessors[nNode]) {
+            if (0 == --vecInDegree[nNext]) {
+                vecTopo.push_back(nNext);
+            }
+        }
+    }
+
+    if (vecTopo.size() < nNodeCount) {
+        LOG_M_W(LINKAGE, "Relations in ppl.json have cycle, %d modules keep configured order.", nNodeCount - (AX_U32)vecTopo.size());
+        for (AX_U32 i = 0; i < nNodeCount; ++i) {
+            if (vecInDegree[i] > 0) {
+                vecTopo.push_back(i);
+            }
+        }
+    }
+
+    m_vecStopOrder.clear();
+    for (const auto nNode : vecTopo) {
+        m_vecStopOrder.push_back(vecMods[nNode]);
+    }
+    m_vecStartOrder.assign(m_vecStopOrder.rbegin(), m_vecStopOrder.rend());
 }
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <unordered_map>
 #include <vector>
 #include "BaseLinkage.h"
 #include "IPPLBuilder.h"
@@ -34,9 +35,25 @@ public:
     AX_BOOL UpdateRelation(PPL_MODULE_TYPE_E eOldModule, AX_S32 nOldChn, PPL_MODULE_TYPE_E eDstModule, AX_S32 nDstGrp, AX_S32 nDstChn,
                            AX_BOOL bLink);
 
+    /* modules (group level, nChannel is 0) sorted by relations: start downstream first, stop upstream first */
+    const std::vector<IPC_MOD_INFO_T>& GetStartOrder(AX_VOID) const {
+        return m_vecStartOrder;
+    }
+    const std::vector<IPC_MOD_INFO_T>& GetStopOrder(AX_VOID) const {
+        return m_vecStopOrder;
+    }
+
 private:
     const AX_BOOL GetCurrRelations(std::vector<IPC_MOD_RELATIONSHIP_T>& vecRelations) const;
+    /* rebuild hash index and start/stop order after m_vecRelations changes */
+    AX_VOID BuildIndex(AX_VOID);
+    AX_VOID BuildOrder(AX_VOID);
+    const std::vector<AX_U32>* FindRelations(AX_U64 nKey) const;
 
 private:
     std::vector<IPC_MOD_RELATIONSHIP_T> m_vecRelations;
+    /* key of (src or dst, module, group, channel) to indexes of valid m_vecRelations, in vector order */
+    std::unordered_map<AX_U64, std::vector<AX_U32>> m_mapRelations;
+    std::vector<IPC_MOD_INFO_T> m_vecStartOrder;
+    std::vector<IPC_MOD_INFO_T> m_vecStopOrder;
 };
\ No newline at end of file
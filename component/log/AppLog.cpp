@@ -63,6 +63,43 @@ AX_VOID CAppLog::Log(AX_S32 nLv, const AX_CHAR *pStr) {
     fwrite(pStr, 1, nLen, m_fp);
 }
 
+AX_VOID CAppLog::LogBatch(const AX_CHAR *pBuf, AX_U32 nLen) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+
+    while (m_fp && nLen > 0) {
+        long nFileLen = ftell(m_fp);
+        if (-1 == nFileLen) {
+            return;
+        }
+
+        if (nFileLen + nLen <= MAX_LOG_FILE_SIZE) {
+            fwrite(pBuf, 1, nLen, m_fp);
+            return;
+        }
+
+        /* fill current file up to the last complete line, the rest goes to next file */
+        AX_U32 nChunk = (nFileLen < (long)MAX_LOG_FILE_SIZE) ? (MAX_LOG_FILE_SIZE - nFileLen) : 0;
+        while (nChunk > 0 && '\n' != pBuf[nChunk - 1]) {
+            --nChunk;
+        }
+
+        if (0 == nChunk && 0 == nFileLen) {
+            /* no line end within a whole file */
+            nChunk = MAX_LOG_FILE_SIZE;
+        }
+
+        if (nChunk > 0) {
+            fwrite(pBuf, 1, nChunk, m_fp);
+            pBuf += nChunk;
+            nLen -= nChunk;
+        }
+
+        if (!SwitchFile()) {
+            return;
+        }
+    }
+}
+
 AX_BOOL CAppLog::SwitchFile(AX_VOID) {
     Close();
 
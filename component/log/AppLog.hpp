@@ -23,6 +23,7 @@ public:
 
     AX_BOOL Open(const APP_LOG_ATTR_T &stAttr) override;
     AX_VOID Log(AX_S32 nLv, const AX_CHAR *pStr) override;
+    AX_VOID LogBatch(const AX_CHAR *pBuf, AX_U32 nLen) override;
     AX_VOID Close(AX_VOID) override;
 
 protected:
@@ -51,6 +51,7 @@ typedef enum {
     APP_LOG_TARGET_SYSLOG = 1,
     APP_LOG_TARGET_APPLOG = 2,
     APP_LOG_TARGET_STDOUT = 4,
+    APP_LOG_TARGET_ASYNC = 8, /* not a target: format and write by background thread for all targets */
     APP_LOG_TARGET_BUTT
 } APP_LOG_TARGET_E;
 
@@ -0,0 +1,809 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "AppLogAsync.hpp"
+#include <ctype.h>
+#include <chrono>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <time.h>
+#include <unistd.h>
+#if __GLIBC__ == 2 && __GLIBC_MINOR__ < 30
+#include <sys/syscall.h>
+#define gettid() syscall(SYS_gettid)
+#endif
+
+/* same as AppLogWrapper.cpp */
+#define MAX_PREFIX 48
+#define MAX_LOG_STR 1024
+
+/* bytes of one record: header, arguments and copied strings */
+#define MAX_RECORD_SIZE (MAX_LOG_STR + 1024)
+/* stdout and log file are written once per batch */
+#define MAX_BATCH_SIZE (32 * 1024)
+/* max length of one conversion spec, such as %-#08.*llx */
+#define MAX_SPEC_LEN (32)
+
+#define LOG_RECORD_PAD (0x1)
+#define LOG_RECORD_RAW (0x2)
+
+static_assert(0 == (APP_LOG_ASYNC_RING_SIZE & (APP_LOG_ASYNC_RING_SIZE - 1)), "ring size should be power of 2");
+static_assert(MAX_RECORD_SIZE * 4 <= APP_LOG_ASYNC_RING_SIZE, "ring should hold several records");
+
+typedef struct {
+    AX_U32 nSize; /* whole record aligned to 8, pad record only has nSize and nFlag */
+    AX_U16 nFlag;
+    AX_S16 nLv;
+    AX_U32 nTid;
+    AX_U32 nReserved;
+    const AX_CHAR *pFmt;
+    AX_U64 nRealTimeUs;
+    AX_U64 nTickUs;
+} LOG_RECORD_HEAD_T;
+
+struct CAppLogAsync::LOG_RING_T {
+    AX_U8 arrData[APP_LOG_ASYNC_RING_SIZE];
+    /* head is written by producer, tail by consumer, keep them on different cache lines */
+    std::atomic<AX_U64> nHead{0};
+    AX_U8 arrPad0[64];
+    std::atomic<AX_U64> nTail{0};
+    AX_U8 arrPad1[64];
+    std::atomic<AX_U32> nDropped{0};
+    /* owner thread exited, consumer frees ring after draining */
+    std::atomic<AX_BOOL> bOrphan{AX_FALSE};
+    AX_U32 nTid{0};
+    /* consumer only, head snapshot of current drain pass */
+    AX_U64 nDrainHead{0};
+};
+
+typedef struct LOG_RING_HOLDER_S {
+    std::shared_ptr<CAppLogAsync::LOG_RING_T> pRing;
+    AX_U64 nInstanceID{0};
+
+    ~LOG_RING_HOLDER_S(AX_VOID) {
+        if (pRing) {
+            pRing->bOrphan.store(AX_TRUE, std::memory_order_release);
+        }
+    }
+} LOG_RING_HOLDER_T;
+
+static thread_local LOG_RING_HOLDER_T t_tRingHolder;
+static std::atomic<AX_U64> s_nInstanceSeq{0};
+
+typedef enum {
+    LOG_ARG_NONE, /* %% */
+    LOG_ARG_INT,
+    LOG_ARG_LONG,
+    LOG_ARG_LLONG,
+    LOG_ARG_INTMAX,
+    LOG_ARG_SIZE,
+    LOG_ARG_PTRDIFF,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_LDOUBLE,
+    LOG_ARG_PTR,
+    LOG_ARG_STR,
+    LOG_ARG_INVALID
+} LOG_ARG_TYPE_E;
+
+typedef struct {
+    LOG_ARG_TYPE_E eType;
+    AX_U32 nLen;       /* from % to conversion char */
+    AX_U32 nStars;     /* '*' width or precision arguments before the value */
+    AX_BOOL bPrecStar; /* precision is the last '*' argument */
+    AX_S32 nPrecision; /* -1: none */
+} LOG_SPEC_T;
+
+/**
+ * @brief parse one conversion spec at '%', return the char after it.
+ * Producer and consumer walk the same format with this function, so argument layout never needs type tags.
+ */
+static const AX_CHAR *ParseSpec(const AX_CHAR *pFmt, LOG_SPEC_T &tSpec) {
+    enum { LEN_NONE, LEN_HH, LEN_H, LEN_L, LEN_LL, LEN_J, LEN_Z, LEN_T, LEN_BIGL } eLen = LEN_NONE;
+
+    tSpec.eType = LOG_ARG_INVALID;
+    tSpec.nStars = 0;
+    tSpec.bPrecStar = AX_FALSE;
+    tSpec.nPrecision = -1;
+
+    const AX_CHAR *p = pFmt + 1;
+    if ('%' == *p) {
+        tSpec.eType = LOG_ARG_NONE;
+        tSpec.nLen = 2;
+        return p + 1;
+    }
+
+    while ('-' == *p || '+' == *p || ' ' == *p || '#' == *p || '0' == *p || '\'' == *p) {
+        ++p;
+    }
+
+    if ('*' == *p) {
+        ++tSpec.nStars;
+        ++p;
+    } else {
+        while (isdigit((AX_U8)*p)) {
+            ++p;
+        }
+    }
+
+    if ('.' == *p) {
+        ++p;
+        if ('*' == *p) {
+            ++tSpec.nStars;
+            tSpec.bPrecStar = AX_TRUE;
+            ++p;
+        } else {
+            tSpec.nPrecision = 0;
+            while (isdigit((AX_U8)*p)) {
+                tSpec.nPrecision = tSpec.nPrecision * 10 + (*p - '0');
+                ++p;
+            }
+        }
+    }
+
+    switch (*p) {
+        case 'h':
+            ++p;
+            eLen = ('h' == *p) ? (++p, LEN_HH) : LEN_H;
+            break;
+        case 'l':
+            ++p;
+            eLen = ('l' == *p) ? (++p, LEN_LL) : LEN_L;
+            break;
+        case 'q':
+            ++p;
+            eLen = LEN_LL;
+            break;
+        case 'j':
+            ++p;
+            eLen = LEN_J;
+            break;
+        case 'z':
+            ++p;
+            eLen = LEN_Z;
+            break;
+        case 't':
+            ++p;
+            eLen = LEN_T;
+            break;
+        case 'L':
+            ++p;
+            eLen = LEN_BIGL;
+            break;
+        default:
+            break;
+    }
+
+    switch (*p) {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            if (LEN_NONE == eLen || LEN_HH == eLen || LEN_H == eLen) {
+                tSpec.eType = LOG_ARG_INT;
+            } else if (LEN_L == eLen) {
+                tSpec.eType = LOG_ARG_LONG;
+            } else if (LEN_LL == eLen) {
+                tSpec.eType = LOG_ARG_LLONG;
+            } else if (LEN_J == eLen) {
+                tSpec.eType = LOG_ARG_INTMAX;
+            } else if (LEN_Z == eLen) {
+                tSpec.eType = LOG_ARG_SIZE;
+            } else if (LEN_T == eLen) {
+                tSpec.eType = LOG_ARG_PTRDIFF;
+            }
+            break;
+        case 'c':
+            /* wint_t is not supported */
+            if (LEN_NONE == eLen) {
+                tSpec.eType = LOG_ARG_INT;
+            }
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            tSpec.eType = (LEN_BIGL == eLen) ? LOG_ARG_LDOUBLE : LOG_ARG_DOUBLE;
+            break;
+        case 's':
+            /* wide string is not supported */
+            if (LEN_NONE == eLen) {
+                tSpec.eType = LOG_ARG_STR;
+            }
+            break;
+        case 'p':
+            tSpec.eType = LOG_ARG_PTR;
+            break;
+        default:
+            /* %n, %m (errno of consumer thread is meaningless) and unknown conversions */
+            return p;
+    }
+
+    ++p;
+    tSpec.nLen = (AX_U32)(p - pFmt);
+    if (tSpec.nLen >= MAX_SPEC_LEN) {
+        tSpec.eType = LOG_ARG_INVALID;
+    }
+
+    return p;
+}
+
+/* arguments are stored in 8 bytes slots, strings are length prefixed and null terminated */
+class CLogArgWriter {
+public:
+    CLogArgWriter(AX_U8 *pBuf, AX_U32 nSize, AX_U32 nPos) : m_pBuf(pBuf), m_nSize(nSize), m_nPos(nPos) {
+    }
+
+    template <typename T>
+    AX_VOID Put(T v) {
+        PutBytes(&v, sizeof(T));
+    }
+
+    AX_VOID PutStr(const AX_CHAR *pStr, AX_U32 nLen) {
+        Put((AX_U64)nLen);
+        if (!m_bOverflow && m_nPos + nLen + 1 <= m_nSize) {
+            memcpy(m_pBuf + m_nPos, pStr, nLen);
+            m_pBuf[m_nPos + nLen] = '\0';
+        }
+        Advance(nLen + 1);
+    }
+
+    AX_BOOL IsOverflow(AX_VOID) const {
+        return m_bOverflow;
+    }
+
+    AX_U32 GetSize(AX_VOID) const {
+        return m_nPos;
+    }
+
+private:
+    AX_VOID PutBytes(const AX_VOID *pData, AX_U32 nLen) {
+        if (!m_bOverflow && m_nPos + nLen <= m_nSize) {
+            memcpy(m_pBuf + m_nPos, pData, nLen);
+        }
+        Advance(nLen);
+    }
+
+    AX_VOID Advance(AX_U32 nLen) {
+        m_nPos += (nLen + 7) & ~7U;
+        if (m_nPos > m_nSize) {
+            m_bOverflow = AX_TRUE;
+        }
+    }
+
+private:
+    AX_U8 *m_pBuf;
+    AX_U32 m_nSize;
+    AX_U32 m_nPos;
+    AX_BOOL m_bOverflow{AX_FALSE};
+};
+
+class CLogArgReader {
+public:
+    CLogArgReader(const AX_U8 *pBuf) : m_pBuf(pBuf) {
+    }
+
+    template <typename T>
+    T Get(AX_VOID) {
+        T v;
+        memcpy(&v, m_pBuf, sizeof(T));
+        m_pBuf += (sizeof(T) + 7) & ~7U;
+        return v;
+    }
+
+    const AX_CHAR *GetStr(AX_VOID) {
+        AX_U32 nLen = (AX_U32)Get<AX_U64>();
+        const AX_CHAR *pStr = (const AX_CHAR *)m_pBuf;
+        m_pBuf += (nLen + 1 + 7) & ~7U;
+        return pStr;
+    }
+
+private:
+    const AX_U8 *m_pBuf;
+};
+
+template <typename T>
+static AX_S32 FormatArg(AX_CHAR *pBuf, AX_U32 nSize, const AX_CHAR *pSpec, const AX_S32 *pStars, AX_U32 nStars, T v) {
+    switch (nStars) {
+        case 0:
+            return snprintf(pBuf, nSize, pSpec, v);
+        case 1:
+            return snprintf(pBuf, nSize, pSpec, pStars[0], v);
+        default:
+            return snprintf(pBuf, nSize, pSpec, pStars[0], pStars[1], v);
+    }
+}
+
+static AX_U64 GetClockUs(clockid_t nClock) {
+    struct timespec ts;
+    clock_gettime(nClock, &ts);
+    return (AX_U64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+CAppLogAsync::~CAppLogAsync(AX_VOID) {
+    Stop();
+}
+
+AX_BOOL CAppLogAsync::Start(CSysLog *pSysLog, CStdLog *pStdLog, CAppLog *pAppLog) {
+    if (m_bRunning) {
+        return AX_TRUE;
+    }
+
+    m_pBatch = new (std::nothrow) AX_CHAR[MAX_BATCH_SIZE];
+    if (!m_pBatch) {
+        return AX_FALSE;
+    }
+
+    m_pSysLog = pSysLog;
+    m_pStdLog = pStdLog;
+    m_pAppLog = pAppLog;
+    m_nBatchLen = 0;
+    m_nInstanceID = ++s_nInstanceSeq;
+
+    m_bRunning = AX_TRUE;
+    m_hThread = std::thread(&CAppLogAsync::WorkThread, this);
+
+    return AX_TRUE;
+}
+
+AX_VOID CAppLogAsync::Stop(AX_VOID) {
+    m_bRunning = AX_FALSE;
+    if (m_hThread.joinable()) {
+        m_hThread.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lck(m_mtxRings);
+        m_vecRings.clear();
+    }
+
+    if (m_pBatch) {
+        delete[] m_pBatch;
+        m_pBatch = nullptr;
+    }
+}
+
+AX_BOOL CAppLogAsync::LogArgStr(AX_S32 nLv, const AX_CHAR *pFmt, va_list vlist) {
+    return Push(nLv, AX_FALSE, pFmt, vlist);
+}
+
+AX_BOOL CAppLogAsync::LogRawStr(AX_S32 nLv, const AX_CHAR *pStr) {
+    return PushFmt(nLv, AX_TRUE, "%s", pStr);
+}
+
+AX_BOOL CAppLogAsync::PushFmt(AX_S32 nLv, AX_BOOL bRaw, const AX_CHAR *pFmt, ...) {
+    va_list args;
+    va_start(args, pFmt);
+    AX_BOOL bRet = Push(nLv, bRaw, pFmt, args);
+    va_end(args);
+    return bRet;
+}
+
+CAppLogAsync::LOG_RING_T *CAppLogAsync::GetThreadRing(AX_VOID) {
+    LOG_RING_HOLDER_T &tHolder = t_tRingHolder;
+    if (tHolder.pRing && tHolder.nInstanceID == m_nInstanceID) {
+        return tHolder.pRing.get();
+    }
+
+    if (tHolder.pRing) {
+        /* ring of previous logger instance */
+        tHolder.pRing->bOrphan.store(AX_TRUE, std::memory_order_release);
+        tHolder.pRing.reset();
+    }
+
+    LOG_RING_T *pRing = new (std::nothrow) LOG_RING_T;
+    if (!pRing) {
+        return nullptr;
+    }
+
+    pRing->nTid = (AX_U32)gettid();
+    tHolder.pRing.reset(pRing);
+    tHolder.nInstanceID = m_nInstanceID;
+
+    std::lock_guard<std::mutex> lck(m_mtxRings);
+    m_vecRings.push_back(tHolder.pRing);
+
+    return pRing;
+}
+
+AX_BOOL CAppLogAsync::Push(AX_S32 nLv, AX_BOOL bRaw, const AX_CHAR *pFmt, va_list vlist) {
+    if (!m_bRunning || !pFmt) {
+        return AX_FALSE;
+    }
+
+    /* encode on stack first, record size is known only after strings are measured */
+    AX_U64 arrRecord[MAX_RECORD_SIZE / sizeof(AX_U64)];
+    CLogArgWriter tWriter((AX_U8 *)arrRecord, sizeof(arrRecord), sizeof(LOG_RECORD_HEAD_T));
+
+    LOG_SPEC_T tSpec;
+    const AX_CHAR *p = pFmt;
+    while (nullptr != (p = strchr(p, '%'))) {
+        p = ParseSpec(p, tSpec);
+        if (LOG_ARG_INVALID == tSpec.eType) {
+            return AX_FALSE;
+        }
+
+        AX_S32 nPrecision = tSpec.nPrecision;
+        for (AX_U32 i = 0; i < tSpec.nStars; ++i) {
+            AX_S32 nStar = va_arg(vlist, int);
+            if (tSpec.bPrecStar && i + 1 == tSpec.nStars) {
+                nPrecision = nStar;
+            }
+            tWriter.Put((AX_S64)nStar);
+        }
+
+        switch (tSpec.eType) {
+            case LOG_ARG_INT:
+                tWriter.Put((AX_S64)va_arg(vlist, int));
+                break;
+            case LOG_ARG_LONG:
+                tWriter.Put((AX_S64)va_arg(vlist, long));
+                break;
+            case LOG_ARG_LLONG:
+                tWriter.Put((AX_S64)va_arg(vlist, long long));
+                break;
+            case LOG_ARG_INTMAX:
+                tWriter.Put((AX_S64)va_arg(vlist, intmax_t));
+                break;
+            case LOG_ARG_SIZE:
+                tWriter.Put((AX_U64)va_arg(vlist, size_t));
+                break;
+            case LOG_ARG_PTRDIFF:
+                tWriter.Put((AX_S64)va_arg(vlist, ptrdiff_t));
+                break;
+            case LOG_ARG_DOUBLE:
+                tWriter.Put(va_arg(vlist, double));
+                break;
+            case LOG_ARG_LDOUBLE:
+                tWriter.Put(va_arg(vlist, long double));
+                break;
+            case LOG_ARG_PTR:
+                tWriter.Put((AX_U64)(uintptr_t)va_arg(vlist, void *));
+                break;
+            case LOG_ARG_STR: {
+                const AX_CHAR *pStr = va_arg(vlist, const char *);
+                if (!pStr) {
+                    pStr = "(null)";
+                }
+
+                /* precision bounds the read, string may not be null terminated */
+                AX_U32 nMax = MAX_LOG_STR - 1;
+                if (nPrecision >= 0 && (AX_U32)nPrecision < nMax) {
+                    nMax = (AX_U32)nPrecision;
+                }
+                tWriter.PutStr(pStr, (AX_U32)strnlen(pStr, nMax));
+                break;
+            }
+            default:
+                break;
+        }
+
+        if (tWriter.IsOverflow()) {
+            return AX_FALSE;
+        }
+    }
+
+    LOG_RING_T *pRing = GetThreadRing();
+    if (!pRing) {
+        return AX_FALSE;
+    }
+
+    LOG_RECORD_HEAD_T tHead;
+    tHead.nSize = tWriter.GetSize();
+    tHead.nFlag = bRaw ? LOG_RECORD_RAW : 0;
+    tHead.nLv = (AX_S16)nLv;
+    tHead.nTid = pRing->nTid;
+    tHead.nReserved = 0;
+    tHead.pFmt = pFmt;
+    tHead.nRealTimeUs = GetClockUs(CLOCK_REALTIME);
+    tHead.nTickUs = GetClockUs(CLOCK_MONOTONIC);
+    memcpy(arrRecord, &tHead, sizeof(tHead));
+
+    AX_U64 nHead = pRing->nHead.load(std::memory_order_relaxed);
+    AX_U64 nFree = APP_LOG_ASYNC_RING_SIZE - (nHead - pRing->nTail.load(std::memory_order_acquire));
+    AX_U32 nOffset = (AX_U32)(nHead & (APP_LOG_ASYNC_RING_SIZE - 1));
+    AX_U32 nToEnd = APP_LOG_ASYNC_RING_SIZE - nOffset;
+
+    /* records never wrap, skip tail of ring with a pad record */
+    AX_U32 nNeed = (nToEnd < tHead.nSize) ? nToEnd + tHead.nSize : tHead.nSize;
+    if (nNeed > nFree) {
+        pRing->nDropped.fetch_add(1, std::memory_order_relaxed);
+        return AX_TRUE;
+    }
+
+    if (nToEnd < tHead.nSize) {
+        LOG_RECORD_HEAD_T tPad;
+        tPad.nSize = nToEnd;
+        tPad.nFlag = LOG_RECORD_PAD;
+        memcpy(&pRing->arrData[nOffset], &tPad, offsetof(LOG_RECORD_HEAD_T, nTid));
+        nOffset = 0;
+    }
+
+    memcpy(&pRing->arrData[nOffset], arrRecord, tHead.nSize);
+    pRing->nHead.store(nHead + nNeed, std::memory_order_release);
+
+    /* wake consumer once when ring crosses half full, otherwise it polls */
+    AX_U64 nUsed = APP_LOG_ASYNC_RING_SIZE - nFree + nNeed;
+    if (nUsed >= APP_LOG_ASYNC_RING_SIZE / 2 && nUsed - nNeed < APP_LOG_ASYNC_RING_SIZE / 2) {
+        m_cvWake.notify_one();
+    }
+
+    return AX_TRUE;
+}
+
+AX_VOID CAppLogAsync::WorkThread(AX_VOID) {
+    prctl(PR_SET_NAME, "APP_LOG_Async");
+
+    while (m_bRunning) {
+        if (0 == Drain()) {
+            std::unique_lock<std::mutex> lck(m_mtxWake);
+            m_cvWake.wait_for(lck, std::chrono::milliseconds(APP_LOG_ASYNC_IDLE_MS));
+        }
+    }
+
+    /* records pushed before stop */
+    while (Drain() > 0) {
+    }
+}
+
+AX_U32 CAppLogAsync::Drain(AX_VOID) {
+    {
+        /* drain without lock, new threads only take it once to register */
+        std::lock_guard<std::mutex> lck(m_mtxRings);
+        m_vecDrain.assign(m_vecRings.begin(), m_vecRings.end());
+    }
+
+    AX_BOOL bHasOrphan = AX_FALSE;
+    for (auto &pRing : m_vecDrain) {
+        /* check orphan before taking head, so no record pushed before thread exit is lost */
+        if (pRing->bOrphan.load(std::memory_order_acquire)) {
+            bHasOrphan = AX_TRUE;
+        }
+
+        pRing->nDrainHead = pRing->nHead.load(std::memory_order_acquire);
+        OutputDropped(pRing.get());
+    }
+
+    /* merge rings by tick, records pushed after snapshot wait for next pass */
+    AX_U32 nCount = 0;
+    while (1) {
+        LOG_RING_T *pNext = nullptr;
+        const AX_U8 *pNextRecord = nullptr;
+        AX_U64 nMinTick = 0;
+        for (auto &pRing : m_vecDrain) {
+            const AX_U8 *pRecord = PeekRecord(pRing.get());
+            if (!pRecord) {
+                continue;
+            }
+
+            AX_U64 nTick;
+            memcpy(&nTick, pRecord + offsetof(LOG_RECORD_HEAD_T, nTickUs), sizeof(nTick));
+            if (!pNext || nTick < nMinTick) {
+                pNext = pRing.get();
+                pNextRecord = pRecord;
+                nMinTick = nTick;
+            }
+        }
+
+        if (!pNext) {
+            break;
+        }
+
+        AX_U32 nSize = OutputRecord(pNextRecord);
+
+        /* release space as soon as possible */
+        pNext->nTail.store(pNext->nTail.load(std::memory_order_relaxed) + nSize, std::memory_order_release);
+        ++nCount;
+    }
+
+    m_vecDrain.clear();
+    Flush();
+
+    if (bHasOrphan) {
+        std::lock_guard<std::mutex> lck(m_mtxRings);
+        for (auto it = m_vecRings.begin(); it != m_vecRings.end();) {
+            LOG_RING_T *pRing = it->get();
+            if (pRing->bOrphan.load(std::memory_order_acquire) &&
+                pRing->nHead.load(std::memory_order_acquire) == pRing->nTail.load(std::memory_order_relaxed)) {
+                it = m_vecRings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    return nCount;
+}
+
+const AX_U8 *CAppLogAsync::PeekRecord(LOG_RING_T *pRing) {
+    AX_U64 nTail = pRing->nTail.load(std::memory_order_relaxed);
+    while (nTail != pRing->nDrainHead) {
+        const AX_U8 *pRecord = &pRing->arrData[nTail & (APP_LOG_ASYNC_RING_SIZE - 1)];
+        LOG_RECORD_HEAD_T tHead;
+        memcpy(&tHead, pRecord, offsetof(LOG_RECORD_HEAD_T, nTid));
+        if (0 == (tHead.nFlag & LOG_RECORD_PAD)) {
+            return pRecord;
+        }
+
+        nTail += tHead.nSize;
+        pRing->nTail.store(nTail, std::memory_order_release);
+    }
+
+    return nullptr;
+}
+
+AX_VOID CAppLogAsync::OutputDropped(LOG_RING_T *pRing) {
+    AX_U32 nDropped = pRing->nDropped.exchange(0, std::memory_order_relaxed);
+    if (0 == nDropped) {
+        return;
+    }
+
+    LOG_RECORD_HEAD_T tHead;
+    memset(&tHead, 0, sizeof(tHead));
+    tHead.nTid = pRing->nTid;
+    tHead.nRealTimeUs = GetClockUs(CLOCK_REALTIME);
+    tHead.nTickUs = GetClockUs(CLOCK_MONOTONIC);
+
+    AX_CHAR szLog[MAX_PREFIX + MAX_LOG_STR];
+    AX_U32 nLen = FormatPrefix(&tHead, szLog, sizeof(szLog));
+    nLen += snprintf(szLog + nLen, sizeof(szLog) - nLen, MACRO_LOG_YELLOW "W: %u logs dropped, log ring is full" MACRO_LOG_END, nDropped);
+    Output(APP_LOG_WARN, szLog, nLen);
+}
+
+AX_U32 CAppLogAsync::OutputRecord(const AX_U8 *pRecord) {
+    AX_CHAR szLog[MAX_PREFIX + MAX_LOG_STR];
+    LOG_RECORD_HEAD_T tHead;
+    memcpy(&tHead, pRecord, sizeof(tHead));
+
+    AX_U32 nLen = (tHead.nFlag & LOG_RECORD_RAW) ? 0 : FormatPrefix(&tHead, szLog, sizeof(szLog));
+    AX_U32 nEnd = (nLen + MAX_LOG_STR < sizeof(szLog)) ? nLen + MAX_LOG_STR : sizeof(szLog);
+
+    CLogArgReader tReader(pRecord + sizeof(LOG_RECORD_HEAD_T));
+    LOG_SPEC_T tSpec;
+    const AX_CHAR *p = tHead.pFmt;
+    while (*p && nLen + 1 < nEnd) {
+        if ('%' != *p) {
+            const AX_CHAR *pNext = strchr(p, '%');
+            AX_U32 nText = pNext ? (AX_U32)(pNext - p) : (AX_U32)strlen(p);
+            if (nText > nEnd - 1 - nLen) {
+                nText = nEnd - 1 - nLen;
+            }
+            memcpy(szLog + nLen, p, nText);
+            nLen += nText;
+            p += nText;
+            continue;
+        }
+
+        const AX_CHAR *pSpec = p;
+        p = ParseSpec(p, tSpec);
+        if (LOG_ARG_NONE == tSpec.eType) {
+            szLog[nLen++] = '%';
+            continue;
+        }
+
+        AX_CHAR szSpec[MAX_SPEC_LEN];
+        memcpy(szSpec, pSpec, tSpec.nLen);
+        szSpec[tSpec.nLen] = '\0';
+
+        AX_S32 arrStars[2] = {0, 0};
+        for (AX_U32 i = 0; i < tSpec.nStars; ++i) {
+            arrStars[i] = (AX_S32)tReader.Get<AX_S64>();
+        }
+
+        AX_CHAR *pOut = szLog + nLen;
+        AX_U32 nRoom = nEnd - nLen;
+        AX_S32 nRet = 0;
+        switch (tSpec.eType) {
+            case LOG_ARG_INT:
+                nRet = FormatArg(pOut, nRoom, szSpec, arrStars, tSpec.nStars, (int)tReader.Get<AX_S64>());
+                break;
+            case LOG_ARG_LONG:
+                nRet = FormatArg(pOut, nRoom, szSpec, arrStars, tSpec.nStars, (long)tReader.Get<AX_S64>());
+                break;
+            case LOG_ARG_LLONG:
+                nRet = FormatArg(pOut, nRoom, szSpec, arrStars, tSpec.nStars, (long long)tReader.Get<AX_S64>());
+                break;
+            case LOG_ARG_INTMAX:
+                nRet = FormatArg(pOut, nRoom, szSpec, arrStars, tSpec.nStars, (intmax_t)tReader.Get<AX_S64>());
+                break;
+            case LOG_ARG_SIZE:
+                nRet = FormatArg(pOut, nRoom, szSpec, arrStars, tSpec.nStars, (size_t)tReader.Get<AX_U64>());
+                break;
+            case LOG_ARG_PTRDIFF:
+                nRet = FormatArg(pOut, nRoom, szSpec, arrStars, tSpec.nStars, (ptrdiff_t)tReader.Get<AX_S64>());
+                break;
+            case LOG_ARG_DOUBLE:
+                nRet = FormatArg(pOut, nRoom, szSpec, arrStars, tSpec.nStars, tReader.Get<double>());
+                break;
+            case LOG_ARG_LDOUBLE:
+                nRet = FormatArg(pOut, nRoom, szSpec, arrStars, tSpec.nStars, tReader.Get<long double>());
+                break;
+            case LOG_ARG_PTR:
+                nRet = FormatArg(pOut, nRoom, szSpec, arrStars, tSpec.nStars, (void *)(uintptr_t)tReader.Get<AX_U64>());
+                break;
+            case LOG_ARG_STR:
+                nRet = FormatArg(pOut, nRoom, szSpec, arrStars, tSpec.nStars, tReader.GetStr());
+                break;
+            default:
+                break;
+        }
+
+        if (nRet > 0) {
+            nLen += ((AX_U32)nRet < nRoom) ? (AX_U32)nRet : nRoom - 1;
+        }
+    }
+
+    szLog[nLen] = '\0';
+    Output(tHead.nLv, szLog, nLen);
+
+    return tHead.nSize;
+}
+
+AX_U32 CAppLogAsync::FormatPrefix(const AX_VOID *pHead, AX_CHAR *pBuf, AX_U32 nSize) {
+    const LOG_RECORD_HEAD_T *pRecord = (const LOG_RECORD_HEAD_T *)pHead;
+
+    /* calendar conversion is done once per second */
+    time_t nSec = (time_t)(pRecord->nRealTimeUs / 1000000);
+    if (nSec != m_nCachedSec) {
+        struct tm t;
+        localtime_r(&nSec, &t);
+        snprintf(m_szCachedDate, sizeof(m_szCachedDate), "%02u-%02u %02u:%02u:%02u", t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min,
+                 t.tm_sec);
+        m_nCachedSec = nSec;
+    }
+
+    /* same layout as CAppLogWrapper::LogArgStr */
+    AX_S32 nLen = snprintf(pBuf, nSize, "%s:%03u %llu %6lu ", m_szCachedDate, (AX_U32)(pRecord->nRealTimeUs / 1000 % 1000),
+                           (unsigned long long)pRecord->nTickUs, (long unsigned int)pRecord->nTid);
+    return (nLen > 0 && (AX_U32)nLen < nSize) ? (AX_U32)nLen : 0;
+}
+
+AX_VOID CAppLogAsync::Output(AX_S32 nLv, const AX_CHAR *pStr, AX_U32 nLen) {
+    /* syslog keeps level per record */
+    if (m_pSysLog) {
+        m_pSysLog->Log(nLv, pStr);
+    }
+
+    if (!m_pStdLog && !m_pAppLog) {
+        return;
+    }
+
+    if (m_nBatchLen + nLen + 1 > MAX_BATCH_SIZE) {
+        Flush();
+    }
+
+    memcpy(m_pBatch + m_nBatchLen, pStr, nLen);
+    m_nBatchLen += nLen;
+    m_pBatch[m_nBatchLen] = '\0';
+}
+
+AX_VOID CAppLogAsync::Flush(AX_VOID) {
+    if (0 == m_nBatchLen) {
+        return;
+    }
+
+    if (m_pStdLog) {
+        m_pStdLog->LogBatch(m_pBatch, m_nBatchLen);
+    }
+
+    if (m_pAppLog) {
+        m_pAppLog->LogBatch(m_pBatch, m_nBatchLen);
+    }
+
+    m_nBatchLen = 0;
+}
@@ -0,0 +1,88 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+#include <stdarg.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "AppLog.hpp"
+#include "SysLog.hpp"
+
+/* per-thread ring size, power of 2 */
+#define APP_LOG_ASYNC_RING_SIZE (32 * 1024)
+/* consumer sleep when all rings are empty, a ring crossing half full wakes it earlier */
+#define APP_LOG_ASYNC_IDLE_MS (5)
+
+/**
+ * @brief Asynchronous log backend.
+ *
+ * Producers never format: each thread owns a lock-free SPSC byte ring, a record holds format pointer,
+ * timestamps, thread id and raw arguments (strings are copied). Format strings must be literals or
+ * outlive the logger, which holds for all LOG_X macros.
+ * One background thread drains all rings, formats records with a per-second cached date and writes
+ * them to syslog record by record, to stdout and log files in batches.
+ * Full ring drops the record and never blocks the producer; drops are reported by the consumer.
+ */
+class CAppLogAsync {
+public:
+    CAppLogAsync(AX_VOID) = default;
+    ~CAppLogAsync(AX_VOID);
+
+    AX_BOOL Start(CSysLog *pSysLog, CStdLog *pStdLog, CAppLog *pAppLog);
+    /* drain all pending records then stop */
+    AX_VOID Stop(AX_VOID);
+
+    /* return AX_FALSE if format is not supported (%n, %ls ...) or record is too big, caller logs synchronously */
+    AX_BOOL LogArgStr(AX_S32 nLv, const AX_CHAR *pFmt, va_list vlist);
+    /* preformatted string without time prefix, such as hex dump lines */
+    AX_BOOL LogRawStr(AX_S32 nLv, const AX_CHAR *pStr);
+
+    struct LOG_RING_T;
+
+private:
+    AX_BOOL Push(AX_S32 nLv, AX_BOOL bRaw, const AX_CHAR *pFmt, va_list vlist);
+    AX_BOOL PushFmt(AX_S32 nLv, AX_BOOL bRaw, const AX_CHAR *pFmt, ...);
+    LOG_RING_T *GetThreadRing(AX_VOID);
+
+    AX_VOID WorkThread(AX_VOID);
+    AX_U32 Drain(AX_VOID);
+    const AX_U8 *PeekRecord(LOG_RING_T *pRing);
+    AX_VOID OutputDropped(LOG_RING_T *pRing);
+    AX_U32 OutputRecord(const AX_U8 *pRecord);
+    AX_VOID Output(AX_S32 nLv, const AX_CHAR *pStr, AX_U32 nLen);
+    AX_VOID Flush(AX_VOID);
+    AX_U32 FormatPrefix(const AX_VOID *pHead, AX_CHAR *pBuf, AX_U32 nSize);
+
+private:
+    CSysLog *m_pSysLog{nullptr};
+    CStdLog *m_pStdLog{nullptr};
+    CAppLog *m_pAppLog{nullptr};
+
+    /* rings are shared with thread local holders, so either side may go first */
+    std::vector<std::shared_ptr<LOG_RING_T>> m_vecRings;
+    std::mutex m_mtxRings;
+
+    std::thread m_hThread;
+    std::atomic<AX_BOOL> m_bRunning{AX_FALSE};
+    AX_U64 m_nInstanceID{0};
+    std::mutex m_mtxWake;
+    std::condition_variable m_cvWake;
+
+    /* consumer only */
+    std::vector<std::shared_ptr<LOG_RING_T>> m_vecDrain;
+    AX_CHAR *m_pBatch{nullptr};
+    AX_U32 m_nBatchLen{0};
+    time_t m_nCachedSec{-1};
+    AX_CHAR m_szCachedDate[16]{0};
+};
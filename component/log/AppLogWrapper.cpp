@@ -62,6 +62,15 @@ static const AX_CHAR* HEX_TABLE[256] = {
         }                      \
     } while (0)
 
+#define SAFE_RELEASE_ASYNC_LOGGER(p) \
+    do {                             \
+        if (p) {                     \
+            p->Stop();               \
+            delete p;                \
+            p = nullptr;             \
+        }                            \
+    } while (0)
+
 AX_S32 CAppLogWrapper::Init(const APP_LOG_ATTR_T* pstAttr) {
     if (!pstAttr) {
         return -1;
@@ -101,11 +110,23 @@ AX_S32 CAppLogWrapper::Init(const APP_LOG_ATTR_T* pstAttr) {
             }
         }
 
+        if (pstAttr->nTarget & APP_LOG_TARGET_ASYNC) {
+            m_pAsyncLog = new (std::nothrow) CAppLogAsync();
+            if (!m_pAsyncLog) {
+                break;
+            }
+
+            if (!m_pAsyncLog->Start(m_pSysLog, m_pStdLog, m_pAppLog)) {
+                break;
+            }
+        }
+
         m_stAttr = *pstAttr;
         return 0;
 
     } while (0);
 
+    SAFE_RELEASE_ASYNC_LOGGER(m_pAsyncLog);
     SAFE_RELEASE_LOGGER(m_pAppLog);
     SAFE_RELEASE_LOGGER(m_pStdLog);
     SAFE_RELEASE_LOGGER(m_pSysLog);
@@ -114,6 +135,8 @@ AX_S32 CAppLogWrapper::Init(const APP_LOG_ATTR_T* pstAttr) {
 }
 
 AX_VOID CAppLogWrapper::DeInit(AX_VOID) {
+    /* drain pending records before sinks are closed */
+    SAFE_RELEASE_ASYNC_LOGGER(m_pAsyncLog);
     SAFE_RELEASE_LOGGER(m_pAppLog);
     SAFE_RELEASE_LOGGER(m_pStdLog);
     SAFE_RELEASE_LOGGER(m_pSysLog);
@@ -134,6 +157,16 @@ AX_VOID CAppLogWrapper::LogArgStr(AX_S32 nLv, const AX_CHAR* pFmt, va_list vlist
         return;
     }
 
+    if (m_pAsyncLog) {
+        va_list vcopy;
+        va_copy(vcopy, vlist);
+        AX_BOOL bQueued = m_pAsyncLog->LogArgStr(nLv, pFmt, vcopy);
+        va_end(vcopy);
+        if (bQueued) {
+            return;
+        }
+    }
+
     AX_CHAR szBuf[MAX_LOG_STR] = {0};
     AX_S32 nLen = vsnprintf(szBuf, sizeof(szBuf), pFmt, vlist);
     if (nLen > 0) {
@@ -10,6 +10,7 @@
 
 #pragma once
 #include "AppLog.hpp"
+#include "AppLogAsync.hpp"
 #include "SysLog.hpp"
 
 class CAppLogWrapper {
@@ -42,6 +43,10 @@ public:
 
 protected:
     AX_VOID Logging(AX_S32 nLv, const AX_CHAR *pStr) {
+        if (m_pAsyncLog && m_pAsyncLog->LogRawStr(nLv, pStr)) {
+            return;
+        }
+
         if (m_pSysLog) {
             m_pSysLog->Log(nLv, pStr);
         }
@@ -62,4 +67,5 @@ protected:
     CSysLog *m_pSysLog{nullptr};
     CStdLog *m_pStdLog{nullptr};
     CAppLog *m_pAppLog{nullptr};
+    CAppLogAsync *m_pAsyncLog{nullptr};
 };
\ No newline at end of file
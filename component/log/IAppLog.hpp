@@ -18,4 +18,9 @@ public:
     virtual AX_BOOL Open(const APP_LOG_ATTR_T &stAttr) = 0;
     virtual AX_VOID Log(AX_S32 nLv, const AX_CHAR *pStr) = 0;
     virtual AX_VOID Close(AX_VOID) = 0;
+
+    /* complete lines, null terminated, level is unknown; called by asynchronous backend */
+    virtual AX_VOID LogBatch(const AX_CHAR *pBuf, AX_U32 nLen) {
+        Log(APP_LOG_INFO, pBuf);
+    }
 };
\ No newline at end of file
@@ -29,6 +29,11 @@ public:
         fprintf(stdout, "%s", pStr);
     };
 
+    AX_VOID LogBatch(const AX_CHAR *pBuf, AX_U32 nLen) override {
+        fwrite(pBuf, 1, nLen, stdout);
+        fflush(stdout);
+    };
+
     AX_VOID Close(AX_VOID) override{};
 };
 
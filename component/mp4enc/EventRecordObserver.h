@@ -0,0 +1,91 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+#include "AudioAedAlgo.hpp"
+#include "AudioEncoder.hpp"
+#include "DetectResult.hpp"
+#include "EventRecorder.h"
+#include "IObserver.h"
+#include "IvesResult.hpp"
+
+#define EVENT_REC_OBS "EVENT_REC_OBS"
+
+/* feeds encoded stream of one sensor into CEventRecorder and triggers it by IVES, detect and AED results */
+class CEventRecordObserver : public IObserver {
+public:
+    CEventRecordObserver(CEventRecorder* pSink) : m_pSink(pSink){};
+    virtual ~CEventRecordObserver(AX_VOID) = default;
+
+public:
+    AX_BOOL IsSame(AX_U32 nGrp, AX_U32 nChn) const {
+        return (m_nGroup == nGrp && m_nChannel == nChn) ? AX_TRUE : AX_FALSE;
+    }
+
+public:
+    AX_BOOL OnRecvData(OBS_TARGET_TYPE_E eTarget, AX_U32 nGrp, AX_U32 nChannel, AX_VOID* pData) override {
+        if (!m_pSink || nullptr == pData) {
+            return AX_TRUE;
+        }
+
+        if (E_OBS_TARGET_TYPE_VENC == eTarget) {
+            AX_VENC_PACK_T* pVencPack = &((AX_VENC_STREAM_T*)pData)->stPack;
+            if (PT_H264 == pVencPack->enType || PT_H265 == pVencPack->enType) {
+                if (nullptr == pVencPack->pu8Addr || 0 == pVencPack->u32Len) {
+                    LOG_M_E(EVENT_REC_OBS, "Invalid NALU data(chn=%d, buff=0x%08X, len=%d).", nChannel, pVencPack->pu8Addr,
+                            pVencPack->u32Len);
+                    return AX_FALSE;
+                }
+
+                AX_BOOL bIFrame = (AX_VENC_INTRA_FRAME == pVencPack->enCodingType) ? AX_TRUE : AX_FALSE;
+                m_pSink->SendVideo(pVencPack->pu8Addr, pVencPack->u32Len, pVencPack->u64PTS, bIFrame);
+            }
+        } else if (E_OBS_TARGET_TYPE_AENC == eTarget) {
+            AX_AUDIO_STREAM_T* pAencPack = &((AENC_STREAM_T*)pData)->stPack;
+            if (nullptr == pAencPack->pStream || 0 == pAencPack->u32Len) {
+                return AX_FALSE;
+            }
+
+            m_pSink->SendAudio(pAencPack->pStream, pAencPack->u32Len, pAencPack->u64TimeStamp);
+        } else if (E_OBS_TARGET_TYPE_EVENT == eTarget) {
+            /* nGrp is sensor id */
+            IVES_RESULT_T* rlt = (IVES_RESULT_T*)pData;
+            if (nGrp == m_pSink->GetSnsId() && (rlt->nMdCount > 0 || rlt->nOdCount > 0 || rlt->nScdCount > 0)) {
+                m_pSink->Trigger(E_EVENT_RECORD_TRIGGER_IVES);
+            }
+        } else if (E_OBS_TARGET_TYPE_DETECT == eTarget) {
+            /* nGrp is sensor id */
+            DETECT_RESULT_T* rlt = (DETECT_RESULT_T*)pData;
+            if (nGrp == m_pSink->GetSnsId() &&
+                (rlt->nBodyCount > 0 || rlt->nVehicleCount > 0 || rlt->nCycleCount > 0 || rlt->nFaceCount > 0 || rlt->nPlateCount > 0)) {
+                m_pSink->Trigger(E_EVENT_RECORD_TRIGGER_DETECT);
+            }
+        } else if (E_OBS_TARGET_TYPE_AED == eTarget) {
+            /* audio is shared by all sensors, AED is only notified above threshold */
+            m_pSink->Trigger(E_EVENT_RECORD_TRIGGER_AED);
+        }
+
+        return AX_TRUE;
+    }
+
+    AX_BOOL OnRegisterObserver(OBS_TARGET_TYPE_E eTarget, AX_U32 nGrp, AX_U32 nChannel, OBS_TRANS_ATTR_PTR pParams) override {
+        if (E_OBS_TARGET_TYPE_VENC == eTarget) {
+            m_nGroup = nGrp;
+            m_nChannel = nChannel;
+        }
+
+        return AX_TRUE;
+    }
+
+private:
+    CEventRecorder* m_pSink{nullptr};
+    AX_U32 m_nGroup{0};
+    AX_U32 m_nChannel{0};
+};
@@ -0,0 +1,403 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "EventRecorder.h"
+#include <sys/prctl.h>
+#include <algorithm>
+#include "AppLogApi.h"
+
+#define EVENT_REC "EVENT_REC"
+
+#define EVENT_REC_MIN_BUF_SIZE (1 * 1024 * 1024)
+/* ring holds pre-record plus the GOP it starts in, leave room for a few more seconds of peak bitrate */
+#define EVENT_REC_BUF_EXTRA_SEC (4)
+
+CEventRecorder::~CEventRecorder() {
+    /* clip thread must not outlive the recorder */
+    Stop();
+}
+
+AX_BOOL CEventRecorder::Init(const EVENT_RECORD_ATTR_T& tAttr) {
+    m_tAttr = tAttr;
+    m_tAttr.tClipInfo.bFragmented = AX_TRUE;
+    m_tAttr.tClipInfo.bLoopSet = AX_TRUE;
+
+    if (0 == m_tAttr.nBufSize) {
+        /* bitrate in kbps, doubled for I frames above average */
+        AX_U64 nBytesPerSec = (AX_U64)m_tAttr.tClipInfo.stVideoAttr.nBitrate * 1000 / 8 + m_tAttr.tClipInfo.stAudioAttr.nBitrate / 8;
+        AX_U64 nSize = nBytesPerSec * (m_tAttr.nPreRecordSec + EVENT_REC_BUF_EXTRA_SEC) * 2;
+        m_tAttr.nBufSize = (AX_U32)std::max<AX_U64>(nSize, EVENT_REC_MIN_BUF_SIZE);
+    }
+
+    if (!m_clipWriter.InitParam(m_tAttr.tClipInfo)) {
+        LOG_MM_E(EVENT_REC, "sns %d init clip writer failed", m_tAttr.nSnsId);
+        return AX_FALSE;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_vecBuf.resize(m_tAttr.nBufSize);
+    m_dqPackets.clear();
+    m_nWritePos = 0;
+
+    LOG_MM_I(EVENT_REC, "sns %d pre-record %ds post-record %ds, ring %d KB, triggers 0x%x, clips saved to %s", m_tAttr.nSnsId,
+             m_tAttr.nPreRecordSec, m_tAttr.nPostRecordSec, m_tAttr.nBufSize / 1024, m_tAttr.nTriggerMask,
+             m_tAttr.tClipInfo.strSavePath.c_str());
+
+    return AX_TRUE;
+}
+
+AX_BOOL CEventRecorder::DeInit(AX_VOID) {
+    Stop();
+    m_clipWriter.DeInit();
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    std::vector<AX_U8>().swap(m_vecBuf);
+    m_dqPackets.clear();
+
+    return AX_TRUE;
+}
+
+AX_BOOL CEventRecorder::Start(AX_VOID) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (m_bStarted) {
+        return AX_TRUE;
+    }
+
+    m_bClipRunning = AX_TRUE;
+    m_hClipThread = std::thread(&CEventRecorder::ClipThreadFunc, this);
+    m_bStarted = AX_TRUE;
+
+    return AX_TRUE;
+}
+
+AX_BOOL CEventRecorder::Stop(AX_VOID) {
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        if (!m_bStarted) {
+            return AX_TRUE;
+        }
+
+        m_bStarted = AX_FALSE;
+        m_bTriggered = AX_FALSE;
+        if (m_bRecording) {
+            StopClip();
+        }
+    }
+
+    /* queued packets are written before clip thread exits */
+    {
+        std::lock_guard<std::mutex> lck(m_mtxClip);
+        m_bClipRunning = AX_FALSE;
+        m_cvClip.notify_one();
+    }
+    if (m_hClipThread.joinable()) {
+        m_hClipThread.join();
+    }
+
+    LOG_MM_I(EVENT_REC, "sns %d stopped, %d events recorded in %d clips, %d packets dropped", m_tAttr.nSnsId, m_nEventCount,
+             m_nClipCount, m_nClipDropCount);
+
+    return AX_TRUE;
+}
+
+AX_VOID CEventRecorder::Trigger(EVENT_RECORD_TRIGGER_E eSource) {
+    if (0 == (m_tAttr.nTriggerMask & eSource)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (!m_bStarted) {
+        return;
+    }
+
+    ++m_nEventCount;
+
+    if (m_bRecording) {
+        /* overlapping event, extend current clip */
+        m_nEventEndPts = m_nLastVideoPts + (AX_U64)m_tAttr.nPostRecordSec * 1000000;
+    } else {
+        m_bTriggered = AX_TRUE;
+    }
+}
+
+AX_VOID CEventRecorder::SendVideo(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts, AX_BOOL bIFrame) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (!m_bStarted) {
+        return;
+    }
+
+    m_nLastVideoPts = nPts;
+
+    if (bIFrame) {
+        TrimPreRecord(nPts);
+    }
+
+    if (m_bRecording && nPts > m_nEventEndPts) {
+        StopClip();
+    }
+
+    if (!m_bRecording && m_bTriggered) {
+        StartClip(nPts);
+    }
+
+    /* ring only serves pre-record of next clip, a packet it can not hold is still recorded */
+    PushPacket(pData, nSize, nPts, AX_TRUE, bIFrame);
+
+    if (m_bRecording) {
+        QueueClipPacket(pData, nSize, nPts, AX_TRUE, bIFrame);
+    }
+}
+
+AX_VOID CEventRecorder::SendAudio(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (!m_bStarted) {
+        return;
+    }
+
+    /* ring always starts with an I frame */
+    if (!m_dqPackets.empty()) {
+        PushPacket(pData, nSize, nPts, AX_FALSE, AX_FALSE);
+    }
+
+    if (m_bRecording) {
+        QueueClipPacket(pData, nSize, nPts, AX_FALSE, AX_FALSE);
+    }
+}
+
+AX_BOOL CEventRecorder::PushPacket(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts, AX_BOOL bVideo, AX_BOOL bIFrame) {
+    AX_U32 nCapacity = (AX_U32)m_vecBuf.size();
+    if (0 == nSize || nSize > nCapacity) {
+        LOG_MM_W(EVENT_REC, "sns %d packet of %d bytes does not fit ring of %d bytes", m_tAttr.nSnsId, nSize, nCapacity);
+        m_dqPackets.clear();
+        m_nWritePos = 0;
+        return AX_FALSE;
+    }
+
+    if (m_dqPackets.empty()) {
+        if (!bIFrame) {
+            return AX_FALSE;
+        }
+        m_nWritePos = 0;
+    }
+
+    AX_U32 nPos = m_nWritePos;
+    AX_BOOL bDropped = AX_FALSE;
+    if (nPos + nSize > nCapacity) {
+        /* tail behind write position holds the oldest packets, it is skipped on wrap */
+        while (!m_dqPackets.empty() && m_dqPackets.front().nOffset >= m_nWritePos) {
+            m_dqPackets.pop_front();
+            bDropped = AX_TRUE;
+        }
+        nPos = 0;
+    }
+
+    /* overwrite oldest packets, then drop up to next I frame so that ring still starts with one */
+    while (!m_dqPackets.empty()) {
+        const PACKET_T& tFront = m_dqPackets.front();
+        if (tFront.nOffset + tFront.nSize <= nPos || tFront.nOffset >= nPos + nSize) {
+            break;
+        }
+        m_dqPackets.pop_front();
+        bDropped = AX_TRUE;
+    }
+    if (bDropped) {
+        while (!m_dqPackets.empty() && !(m_dqPackets.front().bVideo && m_dqPackets.front().bIFrame)) {
+            m_dqPackets.pop_front();
+        }
+        if (m_dqPackets.empty() && !bIFrame) {
+            m_nWritePos = 0;
+            return AX_FALSE;
+        }
+    }
+
+    memcpy(m_vecBuf.data() + nPos, pData, nSize);
+    m_dqPackets.push_back({nPos, nSize, nPts, bVideo, bIFrame, m_nNextSeq++});
+    m_nWritePos = nPos + nSize;
+
+    return AX_TRUE;
+}
+
+AX_VOID CEventRecorder::TrimPreRecord(AX_U64 nPts) {
+    AX_U64 nPreRecord = (AX_U64)m_tAttr.nPreRecordSec * 1000000;
+    if (nPts < nPreRecord) {
+        return;
+    }
+
+    /* keep from the last I frame at or before (nPts - pre-record) */
+    AX_U64 nFrom = nPts - nPreRecord;
+    size_t nKeep = 0;
+    for (size_t i = 1; i < m_dqPackets.size(); ++i) {
+        const PACKET_T& tPacket = m_dqPackets[i];
+        if (tPacket.bVideo && tPacket.bIFrame) {
+            if (tPacket.nPts > nFrom) {
+                break;
+            }
+            nKeep = i;
+        }
+    }
+
+    m_dqPackets.erase(m_dqPackets.begin(), m_dqPackets.begin() + nKeep);
+}
+
+AX_VOID CEventRecorder::StartClip(AX_U64 nPts) {
+    m_bTriggered = AX_FALSE;
+    m_bRecording = AX_TRUE;
+    m_nEventEndPts = nPts + (AX_U64)m_tAttr.nPostRecordSec * 1000000;
+    ++m_nClipCount;
+
+    /* packets already written by last clip are skipped, clip starts at the first I frame after them */
+    CLIP_ITEM_T tItem;
+    tItem.eCmd = E_CLIP_START;
+    tItem.nFromSeq = m_nNextSeq;
+    tItem.nToSeq = m_nNextSeq;
+    AX_U64 nPreRecordPts = nPts;
+    for (auto& tPacket : m_dqPackets) {
+        if (tPacket.bVideo && tPacket.bIFrame && (0 == m_nLastWrittenPts || tPacket.nPts > m_nLastWrittenPts)) {
+            tItem.nFromSeq = tPacket.nSeq;
+            nPreRecordPts = tPacket.nPts;
+            break;
+        }
+    }
+    QueueClipItem(tItem);
+
+    LOG_MM_I(EVENT_REC, "sns %d event clip %d starts, pre-record %lld ms", m_tAttr.nSnsId, m_nClipCount,
+             (nPts - nPreRecordPts) / 1000);
+}
+
+AX_VOID CEventRecorder::StopClip(AX_VOID) {
+    m_bRecording = AX_FALSE;
+
+    CLIP_ITEM_T tItem;
+    tItem.eCmd = E_CLIP_STOP;
+    QueueClipItem(tItem);
+
+    LOG_MM_I(EVENT_REC, "sns %d event clip %d ends", m_tAttr.nSnsId, m_nClipCount);
+}
+
+AX_VOID CEventRecorder::QueueClipPacket(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts, AX_BOOL bVideo, AX_BOOL bIFrame) {
+    if (bVideo) {
+        m_nLastWrittenPts = nPts;
+    }
+
+    {
+        std::lock_guard<std::mutex> lck(m_mtxClip);
+        if (m_bClipDropping && !(bVideo && bIFrame)) {
+            ++m_nClipDropCount;
+            return;
+        }
+
+        if (m_nClipQueued + nSize > m_tAttr.nBufSize) {
+            if (!m_bClipDropping) {
+                LOG_MM_W(EVENT_REC, "sns %d clip writer is %lld KB behind, drop packets until next I frame", m_tAttr.nSnsId,
+                         m_nClipQueued / 1024);
+                m_bClipDropping = AX_TRUE;
+            }
+            ++m_nClipDropCount;
+            return;
+        }
+
+        m_bClipDropping = AX_FALSE;
+    }
+
+    CLIP_ITEM_T tItem;
+    tItem.vecData.assign(pData, pData + nSize);
+    tItem.nPts = nPts;
+    tItem.bVideo = bVideo;
+    tItem.bIFrame = bIFrame;
+    QueueClipItem(tItem);
+}
+
+AX_VOID CEventRecorder::QueueClipItem(CLIP_ITEM_T& tItem) {
+    std::lock_guard<std::mutex> lck(m_mtxClip);
+    m_nClipQueued += tItem.vecData.size();
+    m_dqClip.push_back(std::move(tItem));
+    m_cvClip.notify_one();
+}
+
+AX_VOID CEventRecorder::ClipThreadFunc(AX_VOID) {
+    AX_CHAR szName[16] = {0};
+    snprintf(szName, sizeof(szName), "APP_EVT_REC%d", m_tAttr.nSnsId);
+    prctl(PR_SET_NAME, szName);
+
+    while (AX_TRUE) {
+        CLIP_ITEM_T tItem;
+        {
+            std::unique_lock<std::mutex> lck(m_mtxClip);
+            m_cvClip.wait(lck, [this]() -> bool { return !m_dqClip.empty() || !m_bClipRunning; });
+            if (m_dqClip.empty()) {
+                break;
+            }
+
+            tItem = std::move(m_dqClip.front());
+            m_dqClip.pop_front();
+        }
+
+        switch (tItem.eCmd) {
+            case E_CLIP_START:
+                WritePreRecord(tItem.nFromSeq, tItem.nToSeq);
+                break;
+            case E_CLIP_PACKET:
+                WriteClipPacket(tItem.vecData.data(), tItem.vecData.size(), tItem.nPts, tItem.bVideo, tItem.bIFrame);
+                break;
+            case E_CLIP_STOP:
+                m_clipWriter.CloseFile();
+                break;
+        }
+
+        std::lock_guard<std::mutex> lck(m_mtxClip);
+        m_nClipQueued -= tItem.vecData.size();
+    }
+}
+
+AX_VOID CEventRecorder::WritePreRecord(AX_U64 nFromSeq, AX_U64 nToSeq) {
+    /* copied one packet at a time, the caller of SendVideo only waits for a single memcpy */
+    std::vector<AX_U8> vecData;
+    AX_U64 nSeq = nFromSeq;
+    while (nSeq < nToSeq) {
+        PACKET_T tPacket;
+        {
+            std::lock_guard<std::mutex> lck(m_mtx);
+            if (m_dqPackets.empty() || m_dqPackets.back().nSeq < nSeq) {
+                break;
+            }
+
+            size_t nIndex = (nSeq > m_dqPackets.front().nSeq) ? (size_t)(nSeq - m_dqPackets.front().nSeq) : 0;
+            if (m_dqPackets[nIndex].nSeq != nSeq) {
+                /* overwritten by new packets, go on from the next I frame still in ring */
+                while (nIndex < m_dqPackets.size() && !(m_dqPackets[nIndex].bVideo && m_dqPackets[nIndex].bIFrame)) {
+                    ++nIndex;
+                }
+                if (nIndex == m_dqPackets.size() || m_dqPackets[nIndex].nSeq >= nToSeq) {
+                    break;
+                }
+                LOG_MM_W(EVENT_REC, "sns %d pre-record packets %lld - %lld are overwritten", m_tAttr.nSnsId, nSeq,
+                         m_dqPackets[nIndex].nSeq - 1);
+            }
+
+            tPacket = m_dqPackets[nIndex];
+            vecData.assign(m_vecBuf.data() + tPacket.nOffset, m_vecBuf.data() + tPacket.nOffset + tPacket.nSize);
+        }
+
+        WriteClipPacket(vecData.data(), tPacket.nSize, tPacket.nPts, tPacket.bVideo, tPacket.bIFrame);
+        nSeq = tPacket.nSeq + 1;
+    }
+
+    if (nSeq < nToSeq) {
+        LOG_MM_W(EVENT_REC, "sns %d pre-record packets %lld - %lld are lost", m_tAttr.nSnsId, nSeq, nToSeq - 1);
+    }
+}
+
+AX_VOID CEventRecorder::WriteClipPacket(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts, AX_BOOL bVideo, AX_BOOL bIFrame) {
+    if (bVideo) {
+        m_clipWriter.SendRawFrame(m_tAttr.tClipInfo.nchn, (AX_VOID*)pData, nSize, nPts, bIFrame);
+    } else {
+        m_clipWriter.SendAudioFrame(m_tAttr.tClipInfo.nchn, (AX_VOID*)pData, nSize, nPts);
+    }
+}
@@ -0,0 +1,129 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Mpeg4Encoder.h"
+#include "ax_global_type.h"
+
+/* event sources, used as bit mask of EventRecordTrigger option */
+typedef enum {
+    E_EVENT_RECORD_TRIGGER_IVES = 1 << 0, /* MD/OD/SCD */
+    E_EVENT_RECORD_TRIGGER_DETECT = 1 << 1,
+    E_EVENT_RECORD_TRIGGER_AED = 1 << 2,
+} EVENT_RECORD_TRIGGER_E;
+
+typedef struct EVENT_RECORD_ATTR_S {
+    AX_U8 nSnsId;
+    AX_U32 nTriggerMask;     /* EVENT_RECORD_TRIGGER_E bits */
+    AX_U32 nPreRecordSec;    /* encoded packets kept in memory before a trigger */
+    AX_U32 nPostRecordSec;   /* clip goes on after the last trigger */
+    AX_U32 nBufSize;         /* bytes of pre-record ring, 0: derived from video bitrate */
+    MPEG4EC_INFO_T tClipInfo; /* clips are written by CMPEG4Encoder in fragmented mode */
+
+    EVENT_RECORD_ATTR_S() {
+        nSnsId = 0;
+        nTriggerMask = E_EVENT_RECORD_TRIGGER_IVES | E_EVENT_RECORD_TRIGGER_DETECT | E_EVENT_RECORD_TRIGGER_AED;
+        nPreRecordSec = 5;
+        nPostRecordSec = 10;
+        nBufSize = 0;
+    }
+} EVENT_RECORD_ATTR_T;
+
+/*
+    Keeps the last nPreRecordSec seconds of encoded video and audio in a GOP aligned ring, which always
+    starts with an I frame. A trigger writes the ring out as head of a new clip and records on until
+    nPostRecordSec after the last trigger, so overlapping events are merged into one clip.
+    Clips are muxed by a clip thread, the caller of SendVideo/SendAudio only copies packets.
+*/
+class CEventRecorder {
+public:
+    CEventRecorder() = default;
+    ~CEventRecorder();
+
+    AX_BOOL Init(const EVENT_RECORD_ATTR_T& tAttr);
+    AX_BOOL DeInit(AX_VOID);
+    AX_BOOL Start(AX_VOID);
+    AX_BOOL Stop(AX_VOID);
+
+    AX_VOID SendVideo(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts, AX_BOOL bIFrame);
+    AX_VOID SendAudio(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts);
+    AX_VOID Trigger(EVENT_RECORD_TRIGGER_E eSource);
+
+    AX_U8 GetSnsId(AX_VOID) const {
+        return m_tAttr.nSnsId;
+    }
+
+private:
+    typedef struct {
+        AX_U32 nOffset;
+        AX_U32 nSize;
+        AX_U64 nPts;
+        AX_BOOL bVideo;
+        AX_BOOL bIFrame;
+        AX_U64 nSeq; /* consecutive in m_dqPackets */
+    } PACKET_T;
+
+    typedef enum { E_CLIP_START, E_CLIP_PACKET, E_CLIP_STOP } CLIP_CMD_E;
+
+    typedef struct {
+        CLIP_CMD_E eCmd{E_CLIP_PACKET};
+        std::vector<AX_U8> vecData;
+        AX_U64 nPts{0};
+        AX_BOOL bVideo{AX_FALSE};
+        AX_BOOL bIFrame{AX_FALSE};
+        AX_U64 nFromSeq{0}; /* start: pre-record packets [nFromSeq, nToSeq) are copied from ring by clip thread */
+        AX_U64 nToSeq{0};
+    } CLIP_ITEM_T;
+
+    AX_BOOL PushPacket(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts, AX_BOOL bVideo, AX_BOOL bIFrame);
+    AX_VOID TrimPreRecord(AX_U64 nPts);
+    AX_VOID StartClip(AX_U64 nPts);
+    AX_VOID StopClip(AX_VOID);
+    AX_VOID QueueClipPacket(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts, AX_BOOL bVideo, AX_BOOL bIFrame);
+    AX_VOID QueueClipItem(CLIP_ITEM_T& tItem);
+
+    AX_VOID ClipThreadFunc(AX_VOID);
+    AX_VOID WritePreRecord(AX_U64 nFromSeq, AX_U64 nToSeq);
+    AX_VOID WriteClipPacket(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts, AX_BOOL bVideo, AX_BOOL bIFrame);
+
+private:
+    EVENT_RECORD_ATTR_T m_tAttr;
+    CMPEG4Encoder m_clipWriter;
+    std::mutex m_mtx;
+
+    std::vector<AX_U8> m_vecBuf;
+    std::deque<PACKET_T> m_dqPackets; /* oldest first */
+    AX_U32 m_nWritePos{0};
+    AX_U64 m_nNextSeq{0};
+
+    /* packets to clip thread, bounded by ring size in bytes */
+    std::thread m_hClipThread;
+    std::mutex m_mtxClip;
+    std::condition_variable m_cvClip;
+    std::deque<CLIP_ITEM_T> m_dqClip;
+    AX_U64 m_nClipQueued{0};
+    AX_BOOL m_bClipRunning{AX_FALSE};
+    AX_BOOL m_bClipDropping{AX_FALSE}; /* clip thread fell behind, drop until next I frame */
+    AX_U32 m_nClipDropCount{0};
+
+    AX_BOOL m_bStarted{AX_FALSE};
+    AX_BOOL m_bTriggered{AX_FALSE}; /* trigger arrived while idle, clip starts at next video packet */
+    AX_BOOL m_bRecording{AX_FALSE};
+    AX_U64 m_nLastVideoPts{0};
+    AX_U64 m_nEventEndPts{0};
+    AX_U64 m_nLastWrittenPts{0}; /* pre-record of next clip does not repeat packets of last clip */
+    AX_U32 m_nEventCount{0};
+    AX_U32 m_nClipCount{0};
+};
@@ -0,0 +1,692 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "Fmp4Muxer.h"
+#include <string.h>
+#include "AppLogApi.h"
+
+#define FMP4 "FMP4"
+
+#define FMP4_VIDEO_TRACK_ID (1)
+#define FMP4_AUDIO_TRACK_ID (2)
+#define FMP4_VIDEO_TIMESCALE (90000)
+#define FMP4_AAC_FRAME_SAMPLES (1024)
+
+/* sample_depends_on = 2 */
+#define FMP4_SAMPLE_FLAGS_SYNC (0x02000000)
+/* sample_depends_on = 1, sample_is_non_sync_sample = 1 */
+#define FMP4_SAMPLE_FLAGS_NON_SYNC (0x01010000)
+
+namespace {
+
+class CBoxWriter {
+public:
+    explicit CBoxWriter(std::vector<AX_U8>& vecBuf) : m_vecBuf(vecBuf) {
+    }
+
+    AX_VOID U8(AX_U32 nVal) {
+        m_vecBuf.push_back((AX_U8)nVal);
+    }
+    AX_VOID U16(AX_U32 nVal) {
+        U8(nVal >> 8);
+        U8(nVal);
+    }
+    AX_VOID U24(AX_U32 nVal) {
+        U8(nVal >> 16);
+        U16(nVal);
+    }
+    AX_VOID U32(AX_U32 nVal) {
+        U16(nVal >> 16);
+        U16(nVal);
+    }
+    AX_VOID U64(AX_U64 nVal) {
+        U32((AX_U32)(nVal >> 32));
+        U32((AX_U32)nVal);
+    }
+    AX_VOID Bytes(const AX_U8* pData, AX_U32 nSize) {
+        m_vecBuf.insert(m_vecBuf.end(), pData, pData + nSize);
+    }
+    AX_VOID Zero(AX_U32 nSize) {
+        m_vecBuf.insert(m_vecBuf.end(), nSize, 0);
+    }
+    AX_VOID FourCC(const AX_CHAR* szType) {
+        Bytes((const AX_U8*)szType, 4);
+    }
+
+    /* returns position of box, pass it to End() once the box content is written */
+    AX_U32 Begin(const AX_CHAR* szType) {
+        AX_U32 nPos = Pos();
+        U32(0);
+        FourCC(szType);
+        return nPos;
+    }
+    AX_U32 BeginFull(const AX_CHAR* szType, AX_U8 nVersion, AX_U32 nFlags) {
+        AX_U32 nPos = Begin(szType);
+        U8(nVersion);
+        U24(nFlags);
+        return nPos;
+    }
+    AX_VOID End(AX_U32 nPos) {
+        Patch32(nPos, Pos() - nPos);
+    }
+
+    AX_U32 Pos() const {
+        return (AX_U32)m_vecBuf.size();
+    }
+    AX_VOID Patch32(AX_U32 nPos, AX_U32 nVal) {
+        m_vecBuf[nPos] = (AX_U8)(nVal >> 24);
+        m_vecBuf[nPos + 1] = (AX_U8)(nVal >> 16);
+        m_vecBuf[nPos + 2] = (AX_U8)(nVal >> 8);
+        m_vecBuf[nPos + 3] = (AX_U8)nVal;
+    }
+
+private:
+    std::vector<AX_U8>& m_vecBuf;
+};
+
+AX_VOID WriteMatrix(CBoxWriter& w) {
+    const AX_U32 arrMatrix[9] = {0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000};
+    for (AX_U32 i = 0; i < 9; ++i) {
+        w.U32(arrMatrix[i]);
+    }
+}
+
+/* split Annex-B stream into nal units without start code */
+AX_VOID SplitNalus(const AX_U8* pData, AX_U32 nSize, std::vector<std::pair<const AX_U8*, AX_U32>>& vecNalus) {
+    vecNalus.clear();
+
+    AX_U32 nStart = 0;
+    AX_BOOL bFound = AX_FALSE;
+    AX_U32 i = 0;
+    while (i + 3 <= nSize) {
+        if (pData[i] == 0 && pData[i + 1] == 0 && pData[i + 2] == 1) {
+            if (bFound) {
+                AX_U32 nEnd = i;
+                while (nEnd > nStart && pData[nEnd - 1] == 0) {
+                    --nEnd;
+                }
+                vecNalus.emplace_back(pData + nStart, nEnd - nStart);
+            }
+            i += 3;
+            nStart = i;
+            bFound = AX_TRUE;
+        } else {
+            ++i;
+        }
+    }
+
+    if (bFound && nSize > nStart) {
+        vecNalus.emplace_back(pData + nStart, nSize - nStart);
+    } else if (!bFound && nSize > 0) {
+        /* no start code, treat as one nal unit */
+        vecNalus.emplace_back(pData, nSize);
+    }
+}
+
+/* drop emulation prevention bytes of first nMax bytes */
+std::vector<AX_U8> UnescapeRbsp(const AX_U8* pData, AX_U32 nSize, AX_U32 nMax) {
+    std::vector<AX_U8> vecRbsp;
+    for (AX_U32 i = 0; i < nSize && vecRbsp.size() < nMax; ++i) {
+        if (i >= 2 && pData[i] == 3 && pData[i - 1] == 0 && pData[i - 2] == 0) {
+            continue;
+        }
+        vecRbsp.push_back(pData[i]);
+    }
+    return vecRbsp;
+}
+
+AX_U32 GetAacSampleRateIndex(AX_U32 nSampleRate) {
+    const AX_U32 arrRates[] = {96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000, 7350};
+    for (AX_U32 i = 0; i < sizeof(arrRates) / sizeof(arrRates[0]); ++i) {
+        if (arrRates[i] == nSampleRate) {
+            return i;
+        }
+    }
+    return 8;
+}
+
+}  // namespace
+
+AX_BOOL CFMP4Muxer::Init(const FMP4_MUXER_ATTR_T& tAttr, IFMP4Sink* pSink) {
+    if (PT_H264 != tAttr.eVideoPt && PT_H265 != tAttr.eVideoPt) {
+        LOG_MM_E(FMP4, "unsupported video payload type %d", tAttr.eVideoPt);
+        return AX_FALSE;
+    }
+
+    m_tAttr = tAttr;
+    if (m_tAttr.bAudio && PT_AAC != m_tAttr.eAudioPt && PT_G711A != m_tAttr.eAudioPt && PT_G711U != m_tAttr.eAudioPt) {
+        LOG_MM_W(FMP4, "audio payload type %d is not supported, record video only", m_tAttr.eAudioPt);
+        m_tAttr.bAudio = AX_FALSE;
+    }
+    if (0 == m_tAttr.nFrameRate) {
+        m_tAttr.nFrameRate = 30;
+    }
+    if (0 == m_tAttr.nChnCnt) {
+        m_tAttr.nChnCnt = 1;
+    }
+
+    m_pSink = pSink;
+    m_bHevc = (PT_H265 == m_tAttr.eVideoPt) ? AX_TRUE : AX_FALSE;
+    m_bStarted = AX_FALSE;
+    m_bAudioTimeSet = AX_FALSE;
+    m_nSeqNum = 0;
+    m_nVideoDecodeTime = 0;
+    m_nAudioDecodeTime = 0;
+
+    m_vecVideoSamples.clear();
+    m_vecAudioSamples.clear();
+    m_vecVideoData.clear();
+    m_vecAudioData.clear();
+    m_vecVideoSamples.reserve(m_tAttr.nFrameRate * 4);
+    m_vecVideoData.reserve(m_tAttr.nMaxFragmentSize);
+
+    return AX_TRUE;
+}
+
+AX_BOOL CFMP4Muxer::UpdateParamSets(const std::vector<std::pair<const AX_U8*, AX_U32>>& vecNalus) {
+    std::vector<AX_U8> vecVps;
+    std::vector<AX_U8> vecSps;
+    std::vector<AX_U8> vecPps;
+
+    for (auto& nalu : vecNalus) {
+        if (0 == nalu.second) {
+            continue;
+        }
+
+        std::vector<AX_U8>* pParam = nullptr;
+        if (m_bHevc) {
+            AX_U8 nType = (nalu.first[0] >> 1) & 0x3F;
+            pParam = (32 == nType) ? &vecVps : ((33 == nType) ? &vecSps : ((34 == nType) ? &vecPps : nullptr));
+        } else {
+            AX_U8 nType = nalu.first[0] & 0x1F;
+            pParam = (7 == nType) ? &vecSps : ((8 == nType) ? &vecPps : nullptr);
+        }
+
+        if (pParam && pParam->empty()) {
+            pParam->assign(nalu.first, nalu.first + nalu.second);
+        }
+    }
+
+    if (vecSps.empty() || vecPps.empty() || (m_bHevc && vecVps.empty())) {
+        return AX_FALSE;
+    }
+
+    if (vecVps != m_vecVps || vecSps != m_vecSps || vecPps != m_vecPps) {
+        m_vecVps.swap(vecVps);
+        m_vecSps.swap(vecSps);
+        m_vecPps.swap(vecPps);
+        BuildInitSegment();
+        return AX_TRUE;
+    }
+
+    return AX_FALSE;
+}
+
+AX_VOID CFMP4Muxer::BuildInitSegment(AX_VOID) {
+    m_vecInit.clear();
+    CBoxWriter w(m_vecInit);
+
+    AX_U32 nFtyp = w.Begin("ftyp");
+    w.FourCC("iso6");
+    w.U32(0);
+    w.FourCC("iso6");
+    w.FourCC("cmfc");
+    w.FourCC("mp41");
+    w.FourCC(m_bHevc ? "hvc1" : "avc1");
+    w.End(nFtyp);
+
+    AX_U32 nMoov = w.Begin("moov");
+    {
+        AX_U32 nMvhd = w.BeginFull("mvhd", 0, 0);
+        w.U32(0);    /* creation time */
+        w.U32(0);    /* modification time */
+        w.U32(1000); /* timescale */
+        w.U32(0);    /* duration, unknown for fragmented file */
+        w.U32(0x00010000);
+        w.U16(0x0100);
+        w.Zero(10);
+        WriteMatrix(w);
+        w.Zero(24);
+        w.U32(m_tAttr.bAudio ? FMP4_AUDIO_TRACK_ID + 1 : FMP4_VIDEO_TRACK_ID + 1);
+        w.End(nMvhd);
+    }
+
+    for (AX_U32 nTrack = FMP4_VIDEO_TRACK_ID; nTrack <= (m_tAttr.bAudio ? FMP4_AUDIO_TRACK_ID : FMP4_VIDEO_TRACK_ID); ++nTrack) {
+        AX_BOOL bVideo = (FMP4_VIDEO_TRACK_ID == nTrack) ? AX_TRUE : AX_FALSE;
+
+        AX_U32 nTrak = w.Begin("trak");
+
+        AX_U32 nTkhd = w.BeginFull("tkhd", 0, 0x3); /* enabled | in movie */
+        w.U32(0);
+        w.U32(0);
+        w.U32(nTrack);
+        w.U32(0);
+        w.U32(0); /* duration */
+        w.Zero(8);
+        w.U16(0); /* layer */
+        w.U16(bVideo ? 0 : 1);
+        w.U16(bVideo ? 0 : 0x0100);
+        w.U16(0);
+        WriteMatrix(w);
+        w.U32(bVideo ? m_tAttr.nWidth << 16 : 0);
+        w.U32(bVideo ? m_tAttr.nHeight << 16 : 0);
+        w.End(nTkhd);
+
+        AX_U32 nMdia = w.Begin("mdia");
+
+        AX_U32 nMdhd = w.BeginFull("mdhd", 0, 0);
+        w.U32(0);
+        w.U32(0);
+        w.U32(bVideo ? FMP4_VIDEO_TIMESCALE : m_tAttr.nSampleRate);
+        w.U32(0);
+        w.U16(0x55C4); /* und */
+        w.U16(0);
+        w.End(nMdhd);
+
+        AX_U32 nHdlr = w.BeginFull("hdlr", 0, 0);
+        w.U32(0);
+        w.FourCC(bVideo ? "vide" : "soun");
+        w.Zero(12);
+        const AX_CHAR* szName = bVideo ? "VideoHandler" : "SoundHandler";
+        w.Bytes((const AX_U8*)szName, strlen(szName) + 1);
+        w.End(nHdlr);
+
+        AX_U32 nMinf = w.Begin("minf");
+        if (bVideo) {
+            AX_U32 nVmhd = w.BeginFull("vmhd", 0, 1);
+            w.Zero(8);
+            w.End(nVmhd);
+        } else {
+            AX_U32 nSmhd = w.BeginFull("smhd", 0, 0);
+            w.Zero(4);
+            w.End(nSmhd);
+        }
+
+        AX_U32 nDinf = w.Begin("dinf");
+        AX_U32 nDref = w.BeginFull("dref", 0, 0);
+        w.U32(1);
+        AX_U32 nUrl = w.BeginFull("url ", 0, 1); /* media data in same file */
+        w.End(nUrl);
+        w.End(nDref);
+        w.End(nDinf);
+
+        AX_U32 nStbl = w.Begin("stbl");
+        AX_U32 nStsd = w.BeginFull("stsd", 0, 0);
+        w.U32(1);
+        if (bVideo) {
+            AX_U32 nEntry = w.Begin(m_bHevc ? "hvc1" : "avc1");
+            w.Zero(6);
+            w.U16(1); /* data reference index */
+            w.Zero(16);
+            w.U16(m_tAttr.nWidth);
+            w.U16(m_tAttr.nHeight);
+            w.U32(0x00480000);
+            w.U32(0x00480000);
+            w.U32(0);
+            w.U16(1); /* frame count */
+            w.Zero(32);
+            w.U16(0x0018);
+            w.U16(0xFFFF);
+
+            if (m_bHevc) {
+                /* profile_tier_level follows 2 bytes nal header and 1 byte of vps id / sub layers */
+                std::vector<AX_U8> vecSps = UnescapeRbsp(m_vecSps.data(), m_vecSps.size(), 15);
+                vecSps.resize(15, 0);
+                AX_U8 nSubLayers = ((vecSps[2] >> 1) & 0x7) + 1;
+
+                AX_U32 nHvcc = w.Begin("hvcC");
+                w.U8(1);
+                w.Bytes(&vecSps[3], 12); /* profile, compatibility, constraint and level */
+                w.U16(0xF000);
+                w.U8(0xFC);
+                w.U8(0xFD); /* chroma format 4:2:0 */
+                w.U8(0xF8);
+                w.U8(0xF8);
+                w.U16(0);
+                w.U8((nSubLayers << 3) | ((vecSps[2] & 0x1) << 2) | 0x3);
+                w.U8(3);
+                const std::vector<AX_U8>* arrParams[3] = {&m_vecVps, &m_vecSps, &m_vecPps};
+                const AX_U8 arrTypes[3] = {32, 33, 34};
+                for (AX_U32 i = 0; i < 3; ++i) {
+                    w.U8(0x80 | arrTypes[i]);
+                    w.U16(1);
+                    w.U16(arrParams[i]->size());
+                    w.Bytes(arrParams[i]->data(), arrParams[i]->size());
+                }
+                w.End(nHvcc);
+            } else {
+                std::vector<AX_U8> vecSps = UnescapeRbsp(m_vecSps.data(), m_vecSps.size(), 4);
+                vecSps.resize(4, 0);
+
+                AX_U32 nAvcc = w.Begin("avcC");
+                w.U8(1);
+                w.U8(vecSps[1]); /* profile */
+                w.U8(vecSps[2]); /* compatibility */
+                w.U8(vecSps[3]); /* level */
+                w.U8(0xFF);      /* 4 bytes nal length */
+                w.U8(0xE1);
+                w.U16(m_vecSps.size());
+                w.Bytes(m_vecSps.data(), m_vecSps.size());
+                w.U8(1);
+                w.U16(m_vecPps.size());
+                w.Bytes(m_vecPps.data(), m_vecPps.size());
+                w.End(nAvcc);
+            }
+            w.End(nEntry);
+        } else {
+            const AX_CHAR* szEntry = (PT_AAC == m_tAttr.eAudioPt) ? "mp4a" : ((PT_G711A == m_tAttr.eAudioPt) ? "alaw" : "ulaw");
+            AX_U32 nEntry = w.Begin(szEntry);
+            w.Zero(6);
+            w.U16(1);
+            w.Zero(8);
+            w.U16(m_tAttr.nChnCnt);
+            w.U16(16);
+            w.U32(0);
+            w.U32(m_tAttr.nSampleRate << 16);
+
+            if (PT_AAC == m_tAttr.eAudioPt) {
+                AX_U32 nSrIdx = GetAacSampleRateIndex(m_tAttr.nSampleRate);
+                AX_U8 arrAsc[2] = {(AX_U8)((m_tAttr.nAOT << 3) | (nSrIdx >> 1)), (AX_U8)(((nSrIdx & 0x1) << 7) | (m_tAttr.nChnCnt << 3))};
+
+                AX_U32 nEsds = w.BeginFull("esds", 0, 0);
+                w.U8(0x03); /* ES_Descriptor */
+                w.U8(3 + 2 + 13 + 2 + sizeof(arrAsc) + 3);
+                w.U16(FMP4_AUDIO_TRACK_ID);
+                w.U8(0);
+                w.U8(0x04); /* DecoderConfigDescriptor */
+                w.U8(13 + 2 + sizeof(arrAsc));
+                w.U8(0x40); /* MPEG-4 audio */
+                w.U8(0x15); /* audio stream */
+                w.U24(0);
+                w.U32(0);
+                w.U32(0);
+                w.U8(0x05); /* DecoderSpecificInfo */
+                w.U8(sizeof(arrAsc));
+                w.Bytes(arrAsc, sizeof(arrAsc));
+                w.U8(0x06); /* SLConfigDescriptor */
+                w.U8(1);
+                w.U8(0x02);
+                w.End(nEsds);
+            }
+            w.End(nEntry);
+        }
+        w.End(nStsd);
+
+        /* sample tables are empty, samples are described by fragments */
+        const AX_CHAR* arrEmpty[3] = {"stts", "stsc", "stco"};
+        for (AX_U32 i = 0; i < 3; ++i) {
+            AX_U32 nBox = w.BeginFull(arrEmpty[i], 0, 0);
+            w.U32(0);
+            w.End(nBox);
+        }
+        AX_U32 nStsz = w.BeginFull("stsz", 0, 0);
+        w.U32(0);
+        w.U32(0);
+        w.End(nStsz);
+        w.End(nStbl);
+
+        w.End(nMinf);
+        w.End(nMdia);
+        w.End(nTrak);
+    }
+
+    AX_U32 nMvex = w.Begin("mvex");
+    for (AX_U32 nTrack = FMP4_VIDEO_TRACK_ID; nTrack <= (m_tAttr.bAudio ? FMP4_AUDIO_TRACK_ID : FMP4_VIDEO_TRACK_ID); ++nTrack) {
+        AX_U32 nTrex = w.BeginFull("trex", 0, 0);
+        w.U32(nTrack);
+        w.U32(1);
+        w.U32(0);
+        w.U32(0);
+        w.U32(0);
+        w.End(nTrex);
+    }
+    w.End(nMvex);
+
+    w.End(nMoov);
+}
+
+AX_BOOL CFMP4Muxer::SendVideo(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts, AX_BOOL bIFrame) {
+    if (!pData || 0 == nSize) {
+        return AX_FALSE;
+    }
+
+    std::vector<std::pair<const AX_U8*, AX_U32>> vecNalus;
+    SplitNalus(pData, nSize, vecNalus);
+
+    AX_U64 nTicks = 0;
+    if (m_bStarted) {
+        nTicks = (nPts > m_nBasePts) ? (nPts - m_nBasePts) * FMP4_VIDEO_TIMESCALE / 1000000 : 0;
+    }
+
+    if (bIFrame) {
+        AX_BOOL bChanged = UpdateParamSets(vecNalus);
+        if (m_vecInit.empty()) {
+            /* no parameter sets in this I frame */
+            return AX_FALSE;
+        }
+
+        if (!m_bStarted) {
+            m_bStarted = AX_TRUE;
+            m_nBasePts = nPts;
+            nTicks = 0;
+        }
+
+        EmitFragment(nTicks);
+
+        if (bChanged && m_pSink) {
+            m_pSink->OnInitSegment(m_vecInit.data(), m_vecInit.size());
+        }
+    } else if (!m_bStarted) {
+        return AX_FALSE;
+    }
+
+    /* parameter sets and access unit delimiters are carried by sample entry, others are length prefixed */
+    AX_U32 nSampleSize = 0;
+    for (auto& nalu : vecNalus) {
+        if (0 == nalu.second) {
+            continue;
+        }
+        AX_U8 nType = m_bHevc ? ((nalu.first[0] >> 1) & 0x3F) : (nalu.first[0] & 0x1F);
+        if ((m_bHevc && nType >= 32 && nType <= 35) || (!m_bHevc && (nType == 7 || nType == 8 || nType == 9))) {
+            continue;
+        }
+        nSampleSize += 4 + nalu.second;
+    }
+
+    if (0 == nSampleSize) {
+        return AX_FALSE;
+    }
+
+    if (!m_vecVideoSamples.empty() && m_vecVideoData.size() + m_vecAudioData.size() + nSampleSize > m_tAttr.nMaxFragmentSize) {
+        EmitFragment(nTicks);
+    }
+
+    if (m_vecVideoSamples.empty()) {
+        m_nFragmentPts = nPts;
+    }
+
+    for (auto& nalu : vecNalus) {
+        if (0 == nalu.second) {
+            continue;
+        }
+        AX_U8 nType = m_bHevc ? ((nalu.first[0] >> 1) & 0x3F) : (nalu.first[0] & 0x1F);
+        if ((m_bHevc && nType >= 32 && nType <= 35) || (!m_bHevc && (nType == 7 || nType == 8 || nType == 9))) {
+            continue;
+        }
+        AX_U8 arrLen[4] = {(AX_U8)(nalu.second >> 24), (AX_U8)(nalu.second >> 16), (AX_U8)(nalu.second >> 8), (AX_U8)nalu.second};
+        m_vecVideoData.insert(m_vecVideoData.end(), arrLen, arrLen + 4);
+        m_vecVideoData.insert(m_vecVideoData.end(), nalu.first, nalu.first + nalu.second);
+    }
+
+    SAMPLE_T tSample;
+    tSample.nSize = nSampleSize;
+    tSample.nDuration = 0;
+    tSample.nTicks = nTicks;
+    tSample.bKey = bIFrame;
+    m_vecVideoSamples.push_back(tSample);
+
+    return AX_TRUE;
+}
+
+AX_BOOL CFMP4Muxer::SendAudio(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts) {
+    if (!m_tAttr.bAudio || !m_bStarted || !pData || 0 == nSize || nPts < m_nBasePts) {
+        return AX_FALSE;
+    }
+
+    AX_U32 nDuration = 0;
+    if (PT_AAC == m_tAttr.eAudioPt) {
+        /* strip ADTS header */
+        if (nSize > 7 && pData[0] == 0xFF && (pData[1] & 0xF6) == 0xF0) {
+            AX_U32 nHeadSize = (pData[1] & 0x1) ? 7 : 9;
+            if (nSize <= nHeadSize) {
+                return AX_FALSE;
+            }
+            pData += nHeadSize;
+            nSize -= nHeadSize;
+        }
+        nDuration = FMP4_AAC_FRAME_SAMPLES;
+    } else {
+        nDuration = nSize / m_tAttr.nChnCnt;
+    }
+
+    if (!m_bAudioTimeSet) {
+        m_nAudioDecodeTime = (nPts - m_nBasePts) * m_tAttr.nSampleRate / 1000000;
+        m_bAudioTimeSet = AX_TRUE;
+    }
+
+    m_vecAudioData.insert(m_vecAudioData.end(), pData, pData + nSize);
+
+    SAMPLE_T tSample;
+    tSample.nSize = nSize;
+    tSample.nDuration = nDuration;
+    tSample.nTicks = 0;
+    tSample.bKey = AX_TRUE;
+    m_vecAudioSamples.push_back(tSample);
+
+    return AX_TRUE;
+}
+
+AX_VOID CFMP4Muxer::Flush(AX_VOID) {
+    if (m_vecVideoSamples.empty()) {
+        return;
+    }
+
+    EmitFragment(m_vecVideoSamples.back().nTicks + FMP4_VIDEO_TIMESCALE / m_tAttr.nFrameRate);
+}
+
+AX_VOID CFMP4Muxer::Reset(AX_VOID) {
+    m_bStarted = AX_FALSE;
+    m_bAudioTimeSet = AX_FALSE;
+    m_nVideoDecodeTime = 0;
+    m_nAudioDecodeTime = 0;
+
+    m_vecVideoSamples.clear();
+    m_vecAudioSamples.clear();
+    m_vecVideoData.clear();
+    m_vecAudioData.clear();
+}
+
+AX_VOID CFMP4Muxer::EmitFragment(AX_U64 nNextVideoTicks) {
+    if (m_vecVideoSamples.empty()) {
+        return;
+    }
+
+    /* video durations come from pts of next sample, the last one from the sample which starts next fragment */
+    AX_U32 nDefaultDuration = FMP4_VIDEO_TIMESCALE / m_tAttr.nFrameRate;
+    for (size_t i = 0; i < m_vecVideoSamples.size(); ++i) {
+        AX_U64 nNext = (i + 1 < m_vecVideoSamples.size()) ? m_vecVideoSamples[i + 1].nTicks : nNextVideoTicks;
+        m_vecVideoSamples[i].nDuration = (nNext > m_vecVideoSamples[i].nTicks) ? (AX_U32)(nNext - m_vecVideoSamples[i].nTicks)
+                                                                                : nDefaultDuration;
+    }
+
+    AX_BOOL bAudio = m_vecAudioSamples.empty() ? AX_FALSE : AX_TRUE;
+
+    m_vecHead.clear();
+    CBoxWriter w(m_vecHead);
+
+    AX_U32 nMoof = w.Begin("moof");
+    AX_U32 nMfhd = w.BeginFull("mfhd", 0, 0);
+    w.U32(++m_nSeqNum);
+    w.End(nMfhd);
+
+    /* trun data offsets are patched once moof size is known */
+    AX_U32 arrOffsetPos[2] = {0, 0};
+
+    AX_U32 nVideoTraf = w.Begin("traf");
+    AX_U32 nVideoTfhd = w.BeginFull("tfhd", 0, 0x020000); /* default base is moof */
+    w.U32(FMP4_VIDEO_TRACK_ID);
+    w.End(nVideoTfhd);
+    AX_U32 nVideoTfdt = w.BeginFull("tfdt", 1, 0);
+    w.U64(m_nVideoDecodeTime);
+    w.End(nVideoTfdt);
+    AX_U32 nVideoTrun = w.BeginFull("trun", 0, 0x000701); /* data offset, duration, size, flags */
+    w.U32(m_vecVideoSamples.size());
+    arrOffsetPos[0] = w.Pos();
+    w.U32(0);
+    for (auto& tSample : m_vecVideoSamples) {
+        w.U32(tSample.nDuration);
+        w.U32(tSample.nSize);
+        w.U32(tSample.bKey ? FMP4_SAMPLE_FLAGS_SYNC : FMP4_SAMPLE_FLAGS_NON_SYNC);
+        m_nVideoDecodeTime += tSample.nDuration;
+    }
+    w.End(nVideoTrun);
+    w.End(nVideoTraf);
+
+    if (bAudio) {
+        AX_U32 nAudioTraf = w.Begin("traf");
+        AX_U32 nAudioTfhd = w.BeginFull("tfhd", 0, 0x020000);
+        w.U32(FMP4_AUDIO_TRACK_ID);
+        w.End(nAudioTfhd);
+        AX_U32 nAudioTfdt = w.BeginFull("tfdt", 1, 0);
+        w.U64(m_nAudioDecodeTime);
+        w.End(nAudioTfdt);
+        AX_U32 nAudioTrun = w.BeginFull("trun", 0, 0x000701);
+        w.U32(m_vecAudioSamples.size());
+        arrOffsetPos[1] = w.Pos();
+        w.U32(0);
+        for (auto& tSample : m_vecAudioSamples) {
+            w.U32(tSample.nDuration);
+            w.U32(tSample.nSize);
+            w.U32(FMP4_SAMPLE_FLAGS_SYNC);
+            m_nAudioDecodeTime += tSample.nDuration;
+        }
+        w.End(nAudioTrun);
+        w.End(nAudioTraf);
+    }
+    w.End(nMoof);
+
+    AX_U32 nMoofSize = w.Pos();
+    w.Patch32(arrOffsetPos[0], nMoofSize + 8);
+    if (bAudio) {
+        w.Patch32(arrOffsetPos[1], nMoofSize + 8 + m_vecVideoData.size());
+    }
+
+    /* audio is appended behind video so that mdat payload is one buffer */
+    m_vecVideoData.insert(m_vecVideoData.end(), m_vecAudioData.begin(), m_vecAudioData.end());
+    w.U32(8 + m_vecVideoData.size());
+    w.FourCC("mdat");
+
+    if (m_pSink) {
+        FMP4_FRAGMENT_T tFragment;
+        tFragment.pHead = m_vecHead.data();
+        tFragment.nHeadSize = m_vecHead.size();
+        tFragment.pData = m_vecVideoData.data();
+        tFragment.nDataSize = m_vecVideoData.size();
+        tFragment.nPts = m_nFragmentPts;
+        tFragment.nEndPts = m_nBasePts + nNextVideoTicks * 1000000 / FMP4_VIDEO_TIMESCALE;
+        tFragment.bKeyFrame = m_vecVideoSamples[0].bKey;
+        m_pSink->OnFragment(tFragment);
+    }
+
+    m_vecVideoSamples.clear();
+    m_vecAudioSamples.clear();
+    m_vecVideoData.clear();
+    m_vecAudioData.clear();
+}
@@ -0,0 +1,123 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+#include <vector>
+#include "ax_global_type.h"
+
+/*
+    Fragmented MP4 (ISO BMFF, CMAF compatible) muxer.
+    Output is one init segment (ftyp + moov) and a moof + mdat fragment per GOP. A GOP with more than
+    nMaxFragmentSize bytes of media data is split into several fragments, so memory does not grow with
+    the length of recording and every fragment written out is complete on its own.
+    Video input is Annex-B H.264/H.265 access units, pts in microseconds.
+    Audio input is AAC (raw or ADTS) or G.711 frames, pts in microseconds.
+*/
+typedef struct FMP4_MUXER_ATTR_S {
+    AX_PAYLOAD_TYPE_E eVideoPt;
+    AX_U32 nWidth;
+    AX_U32 nHeight;
+    AX_U32 nFrameRate;
+    AX_BOOL bAudio;
+    AX_PAYLOAD_TYPE_E eAudioPt;
+    AX_U32 nSampleRate;
+    AX_U8 nChnCnt;
+    AX_S32 nAOT;
+    AX_U32 nMaxFragmentSize;
+
+    FMP4_MUXER_ATTR_S() {
+        eVideoPt = PT_H264;
+        nWidth = 0;
+        nHeight = 0;
+        nFrameRate = 30;
+        bAudio = AX_FALSE;
+        eAudioPt = PT_AAC;
+        nSampleRate = 16000;
+        nChnCnt = 1;
+        nAOT = 2;
+        nMaxFragmentSize = 4 * 1024 * 1024;
+    }
+} FMP4_MUXER_ATTR_T;
+
+typedef struct FMP4_FRAGMENT_S {
+    const AX_U8* pHead; /* moof + mdat header */
+    AX_U32 nHeadSize;
+    const AX_U8* pData; /* mdat payload */
+    AX_U32 nDataSize;
+    AX_U64 nPts;        /* pts of first video sample */
+    AX_U64 nEndPts;     /* pts after last video sample */
+    AX_BOOL bKeyFrame;  /* starts with an I frame */
+} FMP4_FRAGMENT_T;
+
+class IFMP4Sink {
+public:
+    virtual ~IFMP4Sink() = default;
+
+    /* ftyp + moov, delivered before the first fragment and again if stream parameters change */
+    virtual AX_VOID OnInitSegment(const AX_U8* pData, AX_U32 nSize) = 0;
+    virtual AX_VOID OnFragment(const FMP4_FRAGMENT_T& tFragment) = 0;
+};
+
+class CFMP4Muxer {
+public:
+    CFMP4Muxer() = default;
+    ~CFMP4Muxer() = default;
+
+    AX_BOOL Init(const FMP4_MUXER_ATTR_T& tAttr, IFMP4Sink* pSink);
+
+    /* samples before the first I frame are dropped */
+    AX_BOOL SendVideo(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts, AX_BOOL bIFrame);
+    AX_BOOL SendAudio(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts);
+
+    /* emit buffered samples as a fragment */
+    AX_VOID Flush(AX_VOID);
+    /* drop buffered samples and restart timeline from next I frame, init segment is kept */
+    AX_VOID Reset(AX_VOID);
+
+    const std::vector<AX_U8>& GetInitSegment(AX_VOID) const {
+        return m_vecInit;
+    }
+
+private:
+    typedef struct {
+        AX_U32 nSize;
+        AX_U32 nDuration;
+        AX_U64 nTicks; /* video: pts in track timescale */
+        AX_BOOL bKey;
+    } SAMPLE_T;
+
+    AX_BOOL UpdateParamSets(const std::vector<std::pair<const AX_U8*, AX_U32>>& vecNalus);
+    AX_VOID BuildInitSegment(AX_VOID);
+    AX_VOID EmitFragment(AX_U64 nNextVideoTicks);
+
+private:
+    FMP4_MUXER_ATTR_T m_tAttr;
+    IFMP4Sink* m_pSink{nullptr};
+    AX_BOOL m_bHevc{AX_FALSE};
+    AX_BOOL m_bStarted{AX_FALSE};
+
+    std::vector<AX_U8> m_vecVps;
+    std::vector<AX_U8> m_vecSps;
+    std::vector<AX_U8> m_vecPps;
+    std::vector<AX_U8> m_vecInit;
+
+    AX_U32 m_nSeqNum{0};
+    AX_U64 m_nBasePts{0};
+    AX_U64 m_nVideoDecodeTime{0};
+    AX_U64 m_nAudioDecodeTime{0};
+    AX_BOOL m_bAudioTimeSet{AX_FALSE};
+    AX_U64 m_nFragmentPts{0};
+
+    std::vector<SAMPLE_T> m_vecVideoSamples;
+    std::vector<SAMPLE_T> m_vecAudioSamples;
+    std::vector<AX_U8> m_vecVideoData;
+    std::vector<AX_U8> m_vecAudioData;
+    std::vector<AX_U8> m_vecHead;
+};
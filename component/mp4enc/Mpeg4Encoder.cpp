@@ -9,6 +9,12 @@
  **************************************************************************************************/
 
 #include "Mpeg4Encoder.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <algorithm>
 #include "AppLogApi.h"
 
 #define MPEG4 "MPEG4"
@@ -21,6 +27,14 @@
 #define MP4_DEFAULT_LOOP_SET AX_TRUE
 
 #define MP4_FORMAT_NAME "mp4"
+#define MP4_DEFAULT_FRAGMENT_SIZE (4 * 1024)  // KiB
+/* fragments waiting for the writer thread, in max fragment size, data beyond is dropped until next I frame */
+#define MP4_WRITE_QUEUE_FRAGMENTS (2)
+/* recycled fragment buffers kept by writer thread */
+#define MP4_WRITE_FREE_BUFFERS (2)
+/* header of the free box covering the unused tail of a reused file */
+#define MP4_FREE_BOX_SIZE (8)
+#define MP4_FREE_LARGE_BOX_SIZE (16)
 
 namespace {
 
@@ -32,12 +46,30 @@ AX_VOID mpeg4_status_report_callback(MP4_HANDLE handle, const char *file_name, m
         inst->StatusReport(file_name, status);
     }
 }
+
+AX_S32 WriteFull(AX_S32 nFd, const AX_U8 *pData, AX_U32 nSize) {
+    while (nSize > 0) {
+        ssize_t nRet = write(nFd, pData, nSize);
+        if (nRet < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return -1;
+        }
+        pData += nRet;
+        nSize -= (AX_U32)nRet;
+    }
+    return 0;
+}
 }  // namespace
 
 CMPEG4Encoder::CMPEG4Encoder() {
 }
 
 CMPEG4Encoder::~CMPEG4Encoder() {
+    if (m_hWriteThread.joinable()) {
+        StopWriteThread();
+    }
 }
 
 AX_BOOL CMPEG4Encoder::Init() {
@@ -55,6 +87,24 @@ AX_BOOL CMPEG4Encoder::Stop() {
         m_Mp4Handle = nullptr;
     }
 
+    if (m_pFMP4Muxer) {
+        {
+            std::lock_guard<std::mutex> lck(m_mtxFMP4);
+            m_pFMP4Muxer->Flush();
+            WRITE_ITEM_T tItem;
+            tItem.eType = E_WRITE_CLOSE;
+            QueueWrite(tItem);
+        }
+
+        /* queued fragments are written before writer thread exits */
+        StopWriteThread();
+
+        std::lock_guard<std::mutex> lck(m_mtxFMP4);
+        m_pFMP4Muxer.reset();
+        std::lock_guard<std::mutex> lckIndex(m_mtxIndex);
+        m_recIndex.Close();
+    }
+
     LOG_MM_C(MPEG4, "---");
     return AX_TRUE;
 }
@@ -81,11 +131,58 @@ AX_BOOL CMPEG4Encoder::InitParam(const MPEG4EC_INFO_T &stMpeg4Info) {
     mp4_info.dest_path = (char *)stMpeg4Info.strSavePath.c_str();
     mp4_info.user_data = this;
 
-    std::string strNamePrefix = "CH" + std::to_string(m_Chn) + "_";
+    std::string strNamePrefix = stMpeg4Info.strFilePrefix.empty() ? "CH" + std::to_string(m_Chn) + "_" : stMpeg4Info.strFilePrefix;
     mp4_info.file_name_prefix = (char *)strNamePrefix.c_str();
 
     mp4_info.sr_callback = mpeg4_status_report_callback;
 
+    if (stMpeg4Info.bFragmented) {
+        FMP4_MUXER_ATTR_T tAttr;
+        tAttr.eVideoPt = stMpeg4Info.stVideoAttr.ePt;
+        tAttr.nWidth = (AX_U32)stMpeg4Info.stVideoAttr.nfrWidth;
+        tAttr.nHeight = (AX_U32)stMpeg4Info.stVideoAttr.nfrHeight;
+        tAttr.nFrameRate = stMpeg4Info.stVideoAttr.nFrameRate;
+        tAttr.bAudio = stMpeg4Info.stAudioAttr.bEnable;
+        tAttr.eAudioPt = stMpeg4Info.stAudioAttr.ePt;
+        tAttr.nSampleRate = stMpeg4Info.stAudioAttr.nSampleRate;
+        tAttr.nChnCnt = stMpeg4Info.stAudioAttr.nChnCnt;
+        tAttr.nAOT = stMpeg4Info.stAudioAttr.nAOT;
+        tAttr.nMaxFragmentSize =
+            ((stMpeg4Info.nMaxFragmentInKBytes > 0) ? stMpeg4Info.nMaxFragmentInKBytes : MP4_DEFAULT_FRAGMENT_SIZE) * 1024;
+
+        m_bLoop = stMpeg4Info.bLoopSet;
+        m_nMaxFileSize = (AX_U64)mp4_info.max_file_size * 1024 * 1024;
+        m_nMaxFileCount = mp4_info.max_file_num;
+        m_strSavePath = stMpeg4Info.strSavePath;
+        m_strNamePrefix = strNamePrefix;
+        m_bFileFull = AX_FALSE;
+
+        m_nMaxFragmentSize = tAttr.nMaxFragmentSize;
+
+        std::lock_guard<std::mutex> lck(m_mtxFMP4);
+        m_pFMP4Muxer.reset(new CFMP4Muxer());
+        if (!m_pFMP4Muxer->Init(tAttr, this)) {
+            m_pFMP4Muxer.reset();
+            return AX_FALSE;
+        }
+
+        {
+            std::lock_guard<std::mutex> lckIndex(m_mtxIndex);
+            m_recIndex.Open(m_strSavePath, m_strNamePrefix, ".mp4");
+        }
+
+        /* file io never runs on the encoder callback thread, an SD card stall only fills the write queue */
+        m_nMaxQueueSize = (AX_U64)tAttr.nMaxFragmentSize * MP4_WRITE_QUEUE_FRAGMENTS;
+        if (!m_hWriteThread.joinable()) {
+            m_bWriteRunning = AX_TRUE;
+            m_hWriteThread = std::thread(&CMPEG4Encoder::WriteThreadFunc, this);
+        }
+
+        LOG_MM_I(MPEG4, "chn %d record fragmented mp4 to %s, fragment %d KB, %d files, write queue %lld KB", m_Chn,
+                 m_strSavePath.c_str(), tAttr.nMaxFragmentSize / 1024, m_nMaxFileCount, m_nMaxQueueSize / 1024);
+        return AX_TRUE;
+    }
+
     if (stMpeg4Info.stVideoAttr.bEnable) {
         mp4_info.video.enable = true;
         mp4_info.video.object = (stMpeg4Info.stVideoAttr.ePt) == PT_H264 ? MP4_OBJECT_AVC : MP4_OBJECT_HEVC;
@@ -127,6 +224,11 @@ AX_BOOL CMPEG4Encoder::InitParam(const MPEG4EC_INFO_T &stMpeg4Info) {
 }
 
 AX_BOOL CMPEG4Encoder::SendRawFrame(AX_U8 nChn, AX_VOID *data, AX_U32 size, AX_U64 nPts /*=0*/, AX_BOOL bIFrame /*=AX_FALSE*/) {
+    if (m_pFMP4Muxer) {
+        std::lock_guard<std::mutex> lck(m_mtxFMP4);
+        return m_pFMP4Muxer->SendVideo((const AX_U8 *)data, size, nPts, bIFrame);
+    }
+
     if (0 == mp4_send(m_Mp4Handle, MP4_DATA_VIDEO, data, size, nPts, (bool)bIFrame)) {
         return AX_TRUE;
     }
@@ -134,7 +236,52 @@ AX_BOOL CMPEG4Encoder::SendRawFrame(AX_U8 nChn, AX_VOID *data, AX_U32 size, AX_U
     return AX_FALSE;
 }
 
+AX_BOOL CMPEG4Encoder::AttachStreamBuffer(std::shared_ptr<CAXStreamBuffer> spStreamBuf) {
+    if (!spStreamBuf) {
+        return AX_FALSE;
+    }
+
+    m_pStreamReader.reset(new CAXStreamReader(spStreamBuf));
+    m_nStreamSkipped = 0;
+
+    LOG_MM_I(MPEG4, "chn %d attach to shared stream buffer %s", m_Chn, spStreamBuf->GetName());
+    return AX_TRUE;
+}
+
+AX_VOID CMPEG4Encoder::DrainStream(AX_VOID) {
+    if (!m_pStreamReader) {
+        return;
+    }
+
+    AX_STREAM_PACKET_T tPkt;
+    while (m_pStreamReader->Get(tPkt)) {
+        AX_U8 *pData = tPkt.pBuf;
+        AX_U32 nSize = tPkt.nSize + tPkt.nSize2;
+        if (tPkt.nSize2 > 0) {
+            /* muxers take contiguous access units */
+            m_vecLinear.resize(nSize);
+            memcpy(m_vecLinear.data(), tPkt.pBuf, tPkt.nSize);
+            memcpy(m_vecLinear.data() + tPkt.nSize, tPkt.pBuf2, tPkt.nSize2);
+            pData = m_vecLinear.data();
+        }
+
+        SendRawFrame(m_Chn, pData, nSize, tPkt.nPts, tPkt.bIFrame);
+        m_pStreamReader->Free(tPkt);
+    }
+
+    if (m_pStreamReader->GetSkipCount() != m_nStreamSkipped) {
+        LOG_MM_W(MPEG4, "chn %d lagged behind shared stream buffer, %lld packets skipped to next IDR", m_Chn,
+                 m_pStreamReader->GetSkipCount() - m_nStreamSkipped);
+        m_nStreamSkipped = m_pStreamReader->GetSkipCount();
+    }
+}
+
 AX_BOOL CMPEG4Encoder::SendAudioFrame(AX_U8 nChn, AX_VOID *data, AX_U32 size, AX_U64 nPts /*=0*/) {
+    if (m_pFMP4Muxer) {
+        std::lock_guard<std::mutex> lck(m_mtxFMP4);
+        return m_pFMP4Muxer->SendAudio((const AX_U8 *)data, size, nPts);
+    }
+
     if (0 == mp4_send(m_Mp4Handle, MP4_DATA_AUDIO, data, size, nPts, true)) {
         return AX_TRUE;
     }
@@ -151,3 +298,405 @@ AX_VOID CMPEG4Encoder::StatusReport(const AX_CHAR *szFileName, mp4_status_e eSta
         LOG_MM_N(MPEG4, "%s status: %s", szFileName ? szFileName : "", status_str[eStatus]);
     }
 }
+
+AX_VOID CMPEG4Encoder::CloseFile(AX_VOID) {
+    std::lock_guard<std::mutex> lck(m_mtxFMP4);
+    if (!m_pFMP4Muxer) {
+        return;
+    }
+
+    m_pFMP4Muxer->Flush();
+    m_pFMP4Muxer->Reset();
+
+    WRITE_ITEM_T tItem;
+    tItem.eType = E_WRITE_CLOSE;
+    QueueWrite(tItem);
+}
+
+AX_VOID CMPEG4Encoder::RegisterFragmentSink(IFMP4Sink *pSink) {
+    std::lock_guard<std::mutex> lck(m_mtxFMP4);
+    if (std::find(m_vecFragmentSinks.begin(), m_vecFragmentSinks.end(), pSink) != m_vecFragmentSinks.end()) {
+        return;
+    }
+
+    m_vecFragmentSinks.push_back(pSink);
+
+    /* late sink gets current init segment, it should start from a fragment with bKeyFrame set */
+    if (m_pFMP4Muxer && !m_pFMP4Muxer->GetInitSegment().empty()) {
+        const std::vector<AX_U8> &vecInit = m_pFMP4Muxer->GetInitSegment();
+        pSink->OnInitSegment(vecInit.data(), vecInit.size());
+    }
+}
+
+AX_VOID CMPEG4Encoder::UnregisterFragmentSink(IFMP4Sink *pSink) {
+    std::lock_guard<std::mutex> lck(m_mtxFMP4);
+    m_vecFragmentSinks.erase(std::remove(m_vecFragmentSinks.begin(), m_vecFragmentSinks.end(), pSink), m_vecFragmentSinks.end());
+}
+
+AX_VOID CMPEG4Encoder::OnInitSegment(const AX_U8 *pData, AX_U32 nSize) {
+    /* sinks are fed on the muxer thread, independent of file writing */
+    for (auto pSink : m_vecFragmentSinks) {
+        pSink->OnInitSegment(pData, nSize);
+    }
+
+    /* moov can not change within a file, the next fragment starts a new one */
+    WRITE_ITEM_T tItem;
+    tItem.eType = E_WRITE_INIT;
+    tItem.vecData.assign(pData, pData + nSize);
+    QueueWrite(tItem);
+}
+
+AX_VOID CMPEG4Encoder::OnFragment(const FMP4_FRAGMENT_T &tFragment) {
+    AX_U64 nSize = tFragment.nHeadSize + tFragment.nDataSize;
+    for (auto pSink : m_vecFragmentSinks) {
+        pSink->OnFragment(tFragment);
+    }
+
+    WRITE_ITEM_T tItem;
+    tItem.eType = E_WRITE_FRAGMENT;
+    tItem.nPts = tFragment.nPts;
+    tItem.nEndPts = tFragment.nEndPts;
+    tItem.bKeyFrame = tFragment.bKeyFrame;
+
+    {
+        std::lock_guard<std::mutex> lck(m_mtxWrite);
+        if (m_bWriteDropping && !tFragment.bKeyFrame) {
+            ++m_nWriteDropCount;
+            return;
+        }
+
+        if (m_nQueuedSize + nSize > m_nMaxQueueSize) {
+            if (!m_bWriteDropping) {
+                LOG_MM_W(MPEG4, "chn %d writer is %lld KB behind, drop fragments until next I frame", m_Chn, m_nQueuedSize / 1024);
+            }
+            m_bWriteDropping = AX_TRUE;
+            ++m_nWriteDropCount;
+            return;
+        }
+
+        if (m_bWriteDropping) {
+            LOG_MM_W(MPEG4, "chn %d writer caught up, %lld fragments dropped", m_Chn, m_nWriteDropCount);
+            m_bWriteDropping = AX_FALSE;
+        }
+
+        if (!m_vecFreeBufs.empty()) {
+            tItem.vecData.swap(m_vecFreeBufs.back());
+            m_vecFreeBufs.pop_back();
+        }
+    }
+
+    tItem.vecData.resize(nSize);
+    memcpy(tItem.vecData.data(), tFragment.pHead, tFragment.nHeadSize);
+    memcpy(tItem.vecData.data() + tFragment.nHeadSize, tFragment.pData, tFragment.nDataSize);
+    QueueWrite(tItem);
+}
+
+AX_VOID CMPEG4Encoder::QueueWrite(WRITE_ITEM_T &tItem) {
+    std::lock_guard<std::mutex> lck(m_mtxWrite);
+    if (E_WRITE_FRAGMENT == tItem.eType) {
+        m_nQueuedSize += tItem.vecData.size();
+    }
+
+    m_dqWrite.push_back(std::move(tItem));
+    m_cvWrite.notify_one();
+}
+
+AX_VOID CMPEG4Encoder::StopWriteThread(AX_VOID) {
+    {
+        std::lock_guard<std::mutex> lck(m_mtxWrite);
+        m_bWriteRunning = AX_FALSE;
+        m_cvWrite.notify_one();
+    }
+
+    if (m_hWriteThread.joinable()) {
+        m_hWriteThread.join();
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtxWrite);
+    m_dqWrite.clear();
+    m_vecFreeBufs.clear();
+    m_nQueuedSize = 0;
+    m_bWriteDropping = AX_FALSE;
+}
+
+AX_VOID CMPEG4Encoder::WriteThreadFunc(AX_VOID) {
+    AX_CHAR szName[16] = {0};
+    snprintf(szName, sizeof(szName), "APP_MP4_W%d", m_Chn);
+    prctl(PR_SET_NAME, szName);
+
+    while (AX_TRUE) {
+        WRITE_ITEM_T tItem;
+        {
+            std::unique_lock<std::mutex> lck(m_mtxWrite);
+            m_cvWrite.wait(lck, [this]() -> bool { return !m_dqWrite.empty() || !m_bWriteRunning; });
+            if (m_dqWrite.empty()) {
+                break;
+            }
+
+            tItem = std::move(m_dqWrite.front());
+            m_dqWrite.pop_front();
+        }
+
+        switch (tItem.eType) {
+            case E_WRITE_INIT:
+                CloseFragmentFile();
+                m_vecInitSeg.swap(tItem.vecData);
+                break;
+            case E_WRITE_CLOSE:
+                CloseFragmentFile();
+                break;
+            case E_WRITE_FRAGMENT:
+                WriteFragment(tItem);
+                break;
+        }
+
+        if (E_WRITE_FRAGMENT == tItem.eType) {
+            /* queued size covers the fragment being written, so that a stall is seen by producer */
+            std::lock_guard<std::mutex> lck(m_mtxWrite);
+            m_nQueuedSize -= tItem.vecData.size();
+            if (m_vecFreeBufs.size() < MP4_WRITE_FREE_BUFFERS) {
+                m_vecFreeBufs.push_back(std::move(tItem.vecData));
+            }
+        }
+    }
+
+    CloseFragmentFile();
+}
+
+AX_VOID CMPEG4Encoder::WriteFragment(const WRITE_ITEM_T &tItem) {
+    AX_U64 nSize = tItem.vecData.size();
+
+    if (tItem.bKeyFrame && m_nFd >= 0 && m_nFileSize + nSize > m_nMaxFileSize) {
+        CloseFragmentFile();
+    }
+
+    if (m_nFd < 0 && tItem.bKeyFrame) {
+        OpenFragmentFile();
+    }
+
+    if (m_nFd < 0) {
+        return;
+    }
+
+    /* fragments are appended as a whole, a power loss only loses the one being written */
+    for (AX_U32 nRetry = 0; nRetry < 2; ++nRetry) {
+        off_t nOffset = (off_t)m_nFileSize;
+        if (0 == WriteFull(m_nFd, tItem.vecData.data(), nSize)) {
+            m_nFileSize += nSize;
+            m_nFileAlloc = std::max(m_nFileAlloc, m_nFileSize);
+            MarkFragmentTail();
+            std::lock_guard<std::mutex> lck(m_mtxIndex);
+            /* each fragment starting with an I frame is a seek point */
+            if (tItem.bKeyFrame) {
+                m_recIndex.AddKeyFrame((AX_U64)nOffset, tItem.nPts);
+            }
+            m_recIndex.Update(m_nFileSize, tItem.nEndPts);
+            break;
+        }
+
+        AX_S32 nErr = errno;
+        if (ftruncate(m_nFd, nOffset) != 0 || lseek(m_nFd, nOffset, SEEK_SET) < 0) {
+            nErr = errno;
+        }
+        m_nFileAlloc = (AX_U64)nOffset;
+
+        if (0 == nRetry && ENOSPC == nErr && m_bLoop && RemoveOldestFragmentFile()) {
+            continue;
+        }
+
+        LOG_MM_E(MPEG4, "write %s failed, %s", m_strCurFile.c_str(), strerror(nErr));
+        CloseFragmentFile();
+        break;
+    }
+}
+
+AX_BOOL CMPEG4Encoder::OpenFragmentFile(AX_VOID) {
+    /* loop mode is a ring of m_nMaxFileCount files: the oldest one is renamed and overwritten instead of unlinked */
+    AX_BOOL bReuse = AX_FALSE;
+    if (m_bLoop) {
+        /* file count may be lowered since last run */
+        while (GetRecordCount() > m_nMaxFileCount && RemoveOldestFragmentFile()) {
+        }
+        bReuse = (GetRecordCount() >= m_nMaxFileCount) ? AX_TRUE : AX_FALSE;
+    } else if (GetRecordCount() >= m_nMaxFileCount) {
+        if (!m_bFileFull) {
+            LOG_MM_W(MPEG4, "chn %d has recorded %d files, stop recording", m_Chn, m_nMaxFileCount);
+            m_bFileFull = AX_TRUE;
+        }
+        return AX_FALSE;
+    }
+
+    const std::vector<AX_U8> &vecInit = m_vecInitSeg;
+    if (vecInit.empty()) {
+        return AX_FALSE;
+    }
+
+    time_t tNow = time(nullptr);
+    struct tm tmNow;
+    localtime_r(&tNow, &tmNow);
+    AX_CHAR szTime[32] = {0};
+    strftime(szTime, sizeof(szTime), "%Y%m%d_%H%M%S", &tmNow);
+
+    /* an indexed file is never overwritten, e.g. restarted within the same second */
+    AX_CHAR szName[RECORD_INDEX_NAME_LEN] = {0};
+    AX_CHAR szPath[512] = {0};
+    for (AX_U32 nTry = 0; nTry < 10; ++nTry) {
+        snprintf(szName, sizeof(szName), "%s%s_%04d.mp4", m_strNamePrefix.c_str(), szTime, m_nFileSeq++ % 10000);
+        snprintf(szPath, sizeof(szPath), "%s/%s", m_strSavePath.c_str(), szName);
+        if (access(szPath, F_OK) != 0) {
+            break;
+        }
+    }
+
+    std::string strOldest;
+    if (bReuse && PopOldestFragmentFile(strOldest)) {
+        if (0 == rename(strOldest.c_str(), szPath)) {
+            m_nFd = open(szPath, O_WRONLY | O_CLOEXEC);
+        } else {
+            LOG_MM_W(MPEG4, "reuse %s failed, %s", strOldest.c_str(), strerror(errno));
+            unlink(strOldest.c_str());
+        }
+    }
+
+    if (m_nFd < 0) {
+        m_nFd = open(szPath, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        /* extents are reserved beyond eof without zero filling, later rounds of the ring write into them again */
+        if (m_nFd >= 0 && m_bLoop && fallocate(m_nFd, FALLOC_FL_KEEP_SIZE, 0, (off_t)m_nMaxFileSize) != 0) {
+            LOG_MM_D(MPEG4, "preallocate %s failed, %s", szPath, strerror(errno));
+        }
+    }
+
+    if (m_nFd < 0) {
+        LOG_MM_E(MPEG4, "open %s failed, %s", szPath, strerror(errno));
+        return AX_FALSE;
+    }
+
+    struct stat stFile;
+    m_nFileAlloc = (0 == fstat(m_nFd, &stFile)) ? (AX_U64)stFile.st_size : 0;
+
+    if (WriteFull(m_nFd, vecInit.data(), vecInit.size()) != 0) {
+        LOG_MM_E(MPEG4, "write %s failed, %s", szPath, strerror(errno));
+        close(m_nFd);
+        m_nFd = -1;
+        unlink(szPath);
+        return AX_FALSE;
+    }
+
+    m_nFileSize = vecInit.size();
+    m_nFileAlloc = std::max(m_nFileAlloc, m_nFileSize);
+    MarkFragmentTail();
+    m_strCurFile = szPath;
+    {
+        std::lock_guard<std::mutex> lck(m_mtxIndex);
+        if (!m_recIndex.Append(szName, tNow) || !m_recIndex.Update(m_nFileSize, 0)) {
+            LOG_MM_W(MPEG4, "%s is not indexed", szPath);
+        }
+    }
+    LOG_MM_N(MPEG4, "%s status: %s", szPath, (strOldest.empty() ? "start" : "start, reused"));
+
+    return AX_TRUE;
+}
+
+AX_VOID CMPEG4Encoder::CloseFragmentFile(AX_VOID) {
+    if (m_nFd < 0) {
+        return;
+    }
+
+    fdatasync(m_nFd);
+    close(m_nFd);
+    m_nFd = -1;
+    m_nFileSize = 0;
+    m_nFileAlloc = 0;
+    {
+        std::lock_guard<std::mutex> lck(m_mtxIndex);
+        m_recIndex.Sync();
+    }
+
+    LOG_MM_N(MPEG4, "%s status: complete", m_strCurFile.c_str());
+}
+
+/* bytes of a reused file after the last fragment become one free box, players skip it */
+AX_VOID CMPEG4Encoder::MarkFragmentTail(AX_VOID) {
+    AX_U64 nTail = m_nFileAlloc - m_nFileSize;
+    if (0 == nTail) {
+        return;
+    }
+
+    AX_U8 arrBox[MP4_FREE_LARGE_BOX_SIZE] = {0, 0, 0, 0, 'f', 'r', 'e', 'e'};
+    AX_U32 nBoxSize = MP4_FREE_BOX_SIZE;
+    if (nTail > 0xFFFFFFFF) {
+        /* size 1: 64-bit largesize follows the type */
+        arrBox[3] = 1;
+        for (AX_U32 i = 0; i < 8; ++i) {
+            arrBox[8 + i] = (AX_U8)(nTail >> (56 - 8 * i));
+        }
+        nBoxSize = MP4_FREE_LARGE_BOX_SIZE;
+    } else if (nTail >= MP4_FREE_BOX_SIZE) {
+        for (AX_U32 i = 0; i < 4; ++i) {
+            arrBox[i] = (AX_U8)(nTail >> (24 - 8 * i));
+        }
+    } else {
+        nBoxSize = 0;
+    }
+
+    if (0 == nBoxSize || pwrite(m_nFd, arrBox, nBoxSize, (off_t)m_nFileSize) != (ssize_t)nBoxSize) {
+        /* no room for a box header or it is not written, cut the tail */
+        if (0 == ftruncate(m_nFd, (off_t)m_nFileSize)) {
+            m_nFileAlloc = m_nFileSize;
+        }
+    }
+}
+
+/* never pops the file being written */
+AX_BOOL CMPEG4Encoder::PopOldestFragmentFile(std::string &strFile) {
+    std::lock_guard<std::mutex> lck(m_mtxIndex);
+    if (m_recIndex.GetCount() <= ((m_nFd >= 0) ? 1u : 0u)) {
+        return AX_FALSE;
+    }
+
+    strFile = m_recIndex.GetPath(0);
+    m_recIndex.PopFront();
+    return AX_TRUE;
+}
+
+AX_BOOL CMPEG4Encoder::RemoveOldestFragmentFile(AX_VOID) {
+    std::string strFile;
+    if (!PopOldestFragmentFile(strFile)) {
+        return AX_FALSE;
+    }
+
+    if (unlink(strFile.c_str()) != 0 && ENOENT != errno) {
+        LOG_MM_E(MPEG4, "remove %s failed, %s", strFile.c_str(), strerror(errno));
+    } else {
+        LOG_MM_N(MPEG4, "%s status: deleted", strFile.c_str());
+    }
+
+    return AX_TRUE;
+}
+
+AX_U32 CMPEG4Encoder::GetRecordCount(AX_VOID) {
+    std::lock_guard<std::mutex> lck(m_mtxIndex);
+    return m_recIndex.GetCount();
+}
+
+AX_BOOL CMPEG4Encoder::FindRecordFiles(time_t tStart, time_t tEnd, std::vector<std::string> &vecFiles) {
+    std::lock_guard<std::mutex> lck(m_mtxIndex);
+    vecFiles.clear();
+
+    AX_U32 nFirst = 0;
+    AX_U32 nLast = 0;
+    if (!m_recIndex.FindByTime(tStart, tEnd, nFirst, nLast)) {
+        return AX_FALSE;
+    }
+
+    for (AX_U32 i = nFirst; i <= nLast; ++i) {
+        vecFiles.push_back(m_recIndex.GetPath(i));
+    }
+
+    return AX_TRUE;
+}
+
+AX_U64 CMPEG4Encoder::GetRecordSize(AX_VOID) {
+    std::lock_guard<std::mutex> lck(m_mtxIndex);
+    return m_recIndex.GetTotalSize();
+}
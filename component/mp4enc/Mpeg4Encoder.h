@@ -11,8 +11,18 @@
 #pragma once
 #include <stdlib.h>
 #include <unistd.h>
+#include <time.h>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+#include "AXStreamBuffer.h"
+#include "Fmp4Muxer.h"
+#include "RecordIndex.hpp"
 #include "ax_global_type.h"
 #include "mp4_api.h"
 
@@ -23,7 +33,10 @@ typedef struct MPEG4EC_INFO_S {
     AX_U32 nchn;
     AX_U32 nMaxFileInMBytes;
     AX_U32 nMaxFileCount;
+    AX_BOOL bFragmented;        /* write fragmented mp4 by CFMP4Muxer instead of mp4_api */
+    AX_U32 nMaxFragmentInKBytes;
     std::string strSavePath;
+    std::string strFilePrefix;  /* CH<nchn>_ if empty */
 
     struct mpeg4_video_sess_attr {
         AX_BOOL bEnable;
@@ -49,12 +62,14 @@ typedef struct MPEG4EC_INFO_S {
         nMaxFileInMBytes = 0;
         nMaxFileCount = 0;
         bLoopSet = AX_TRUE;
+        bFragmented = AX_FALSE;
+        nMaxFragmentInKBytes = 0;
         memset(&stVideoAttr, 0x00, sizeof(stVideoAttr));
         memset(&stAudioAttr, 0x00, sizeof(stAudioAttr));
     }
 } MPEG4EC_INFO_T;
 
-class CMPEG4Encoder {
+class CMPEG4Encoder : public IFMP4Sink {
 public:
     CMPEG4Encoder();
     virtual ~CMPEG4Encoder();
@@ -70,7 +85,94 @@ public:
 
     AX_VOID StatusReport(const AX_CHAR* szFileName, mp4_status_e eStatus);
 
+    /* read video from the shared stream buffer of VENC channel instead of SendRawFrame, DrainStream on each notification */
+    AX_BOOL AttachStreamBuffer(std::shared_ptr<CAXStreamBuffer> spStreamBuf);
+    AX_BOOL IsStreamAttached(AX_VOID) const {
+        return m_pStreamReader ? AX_TRUE : AX_FALSE;
+    }
+    AX_VOID DrainStream(AX_VOID);
+
+    /* fragmented mode only: finish current file, next I frame starts a new file with its own timeline */
+    AX_VOID CloseFile(AX_VOID);
+
+    /* fragmented mode only: pSink also receives init segment and fragments on the muxer thread, e.g. for MSE preview */
+    AX_VOID RegisterFragmentSink(IFMP4Sink* pSink);
+    AX_VOID UnregisterFragmentSink(IFMP4Sink* pSink);
+    /* fragmented mode only: upper bound of one fragment (moof + mdat) in bytes, 0 if not fragmented */
+    AX_U32 GetMaxFragmentSize(AX_VOID) const {
+        return m_nMaxFragmentSize;
+    }
+
+    /* fragmented mode only: files recorded within utc seconds [tStart, tEnd], oldest first */
+    AX_BOOL FindRecordFiles(time_t tStart, time_t tEnd, std::vector<std::string>& vecFiles);
+    /* fragmented mode only: bytes of all recorded files, taken from index instead of walking the directory */
+    AX_U64 GetRecordSize(AX_VOID);
+
+protected:
+    AX_VOID OnInitSegment(const AX_U8* pData, AX_U32 nSize) override;
+    AX_VOID OnFragment(const FMP4_FRAGMENT_T& tFragment) override;
+
+private:
+    typedef enum { E_WRITE_INIT, E_WRITE_FRAGMENT, E_WRITE_CLOSE } WRITE_TYPE_E;
+
+    /* finished by muxer on the caller thread, written by the writer thread */
+    typedef struct {
+        WRITE_TYPE_E eType{E_WRITE_CLOSE};
+        std::vector<AX_U8> vecData; /* init: ftyp + moov, fragment: moof + mdat */
+        AX_U64 nPts{0};
+        AX_U64 nEndPts{0};
+        AX_BOOL bKeyFrame{AX_FALSE};
+    } WRITE_ITEM_T;
+
+    AX_VOID QueueWrite(WRITE_ITEM_T& tItem);
+    AX_VOID StopWriteThread(AX_VOID);
+    AX_VOID WriteThreadFunc(AX_VOID);
+    AX_VOID WriteFragment(const WRITE_ITEM_T& tItem);
+    AX_BOOL OpenFragmentFile(AX_VOID);
+    AX_VOID CloseFragmentFile(AX_VOID);
+    AX_VOID MarkFragmentTail(AX_VOID);
+    AX_BOOL RemoveOldestFragmentFile(AX_VOID);
+    AX_BOOL PopOldestFragmentFile(std::string& strFile);
+    AX_U32 GetRecordCount(AX_VOID);
+
 public:
     AX_U8 m_Chn;
     MP4_HANDLE m_Mp4Handle{nullptr};
+
+private:
+    std::unique_ptr<CAXStreamReader> m_pStreamReader;
+    std::vector<AX_U8> m_vecLinear; /* packet wrapped around the end of shared buffer */
+    AX_U64 m_nStreamSkipped{0};
+    std::unique_ptr<CFMP4Muxer> m_pFMP4Muxer;
+    std::mutex m_mtxFMP4;
+    std::vector<IFMP4Sink*> m_vecFragmentSinks; /* guarded by m_mtxFMP4 */
+    AX_U32 m_nMaxFragmentSize{0};
+
+    /* fragments queued to writer thread, bounded by m_nMaxQueueSize bytes */
+    std::thread m_hWriteThread;
+    std::mutex m_mtxWrite;
+    std::condition_variable m_cvWrite;
+    std::deque<WRITE_ITEM_T> m_dqWrite;
+    std::vector<std::vector<AX_U8>> m_vecFreeBufs;
+    AX_U64 m_nQueuedSize{0};
+    AX_U64 m_nMaxQueueSize{0};
+    AX_BOOL m_bWriteRunning{AX_FALSE};
+    AX_BOOL m_bWriteDropping{AX_FALSE}; /* queue was full, drop until next fragment with I frame */
+    AX_U64 m_nWriteDropCount{0};
+
+    /* below are used by writer thread only, except m_recIndex guarded by m_mtxIndex */
+    std::vector<AX_U8> m_vecInitSeg;
+    std::mutex m_mtxIndex;
+    AX_BOOL m_bLoop{AX_TRUE};
+    AX_U64 m_nMaxFileSize{0};
+    AX_U32 m_nMaxFileCount{0};
+    std::string m_strSavePath;
+    std::string m_strNamePrefix;
+    CRecordIndex m_recIndex; /* oldest first, the last one is being written while m_nFd is open */
+    std::string m_strCurFile;
+    AX_S32 m_nFd{-1};
+    AX_U64 m_nFileSize{0};
+    AX_U64 m_nFileAlloc{0}; /* length of file, bytes after m_nFileSize are one free box */
+    AX_U32 m_nFileSeq{0};
+    AX_BOOL m_bFileFull{AX_FALSE}; /* file count reached without loop */
 };
@@ -47,6 +47,12 @@ public:
                     return AX_FALSE;
                 }
 
+                if (m_pSink->IsStreamAttached()) {
+                    /* packet is already in shared stream buffer */
+                    m_pSink->DrainStream();
+                    return AX_TRUE;
+                }
+
                 AX_BOOL bIFrame = (AX_VENC_INTRA_FRAME == pVencPack->enCodingType) ? AX_TRUE : AX_FALSE;
                 m_pSink->SendRawFrame(nChannel, pVencPack->pu8Addr, pVencPack->u32Len, pVencPack->u64PTS, bIFrame);
             }
@@ -70,6 +76,11 @@ public:
         } else if (E_OBS_TARGET_TYPE_VENC == eTarget) {
             m_nGroup = nGrp;
             m_nChannel = nChannel;
+
+            std::shared_ptr<CAXStreamBuffer> spStreamBuf = CAXStreamBufferMgr::GetInstance()->Get(nChannel);
+            if (spStreamBuf) {
+                return m_pSink->AttachStreamBuffer(spStreamBuf);
+            }
         }
         return AX_TRUE;
     }
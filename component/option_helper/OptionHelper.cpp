@@ -178,6 +178,78 @@ AX_BOOL COptionHelper::GetMp4LoopSet() {
 #endif
 }
 
+AX_BOOL COptionHelper::IsMp4Fragmented() {
+#ifndef _OPAL_LIB_
+    AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("mp4", "MP4RecordFragmented", 0);
+    return value ? AX_TRUE : AX_FALSE;
+#else
+    return AX_FALSE;
+#endif
+}
+
+AX_U32 COptionHelper::GetMp4FragmentSize() {
+#ifndef _OPAL_LIB_
+    AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("mp4", "MP4RecordFragmentSize", 4096);
+    return value;
+#else
+    return 4096;
+#endif
+}
+
+AX_BOOL COptionHelper::IsEnableEventRecord() {
+#ifndef _OPAL_LIB_
+    AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("mp4", "EnableEventRecord", 0);
+    return value ? AX_TRUE : AX_FALSE;
+#else
+    return AX_FALSE;
+#endif
+}
+
+string COptionHelper::GetEventRecordSavedPath() {
+#ifndef _OPAL_LIB_
+    string strVal = m_iniWrapper.GetStringValue("mp4", "EventRecordSavedPath", "./");
+    return strVal;
+#else
+    return "./";
+#endif
+}
+
+AX_U32 COptionHelper::GetEventPreRecordSec() {
+#ifndef _OPAL_LIB_
+    AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("mp4", "EventPreRecordSec", 5);
+    return value;
+#else
+    return 5;
+#endif
+}
+
+AX_U32 COptionHelper::GetEventPostRecordSec() {
+#ifndef _OPAL_LIB_
+    AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("mp4", "EventPostRecordSec", 10);
+    return value;
+#else
+    return 10;
+#endif
+}
+
+AX_U32 COptionHelper::GetEventRecordFileCount() {
+#ifndef _OPAL_LIB_
+    AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("mp4", "EventRecordFileCount", 50);
+    return value;
+#else
+    return 50;
+#endif
+}
+
+AX_U32 COptionHelper::GetEventRecordTrigger() {
+#ifndef _OPAL_LIB_
+    AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("mp4", "EventRecordTrigger", 7);
+    return value;
+#else
+    return 7;
+#endif
+}
+
 AX_U32 COptionHelper::GetVencThreadNum() {
 #ifndef _OPAL_LIB_
     AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("venc", "VencThreadNum", AX_VENC_THREAD_NUM);
@@ -205,6 +277,24 @@ AX_BOOL COptionHelper::IsEnableVencRefRingbuf() {
 #endif
 }
 
+AX_BOOL COptionHelper::IsEnableSharedStreamBuf() {
+#ifndef _OPAL_LIB_
+    AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("venc", "EnableSharedStreamBuf", 0);
+    return value ? AX_TRUE : AX_FALSE;
+#else
+    return AX_FALSE;
+#endif
+}
+
+AX_BOOL COptionHelper::IsEnableVencStreamReactor() {
+#ifndef _OPAL_LIB_
+    AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("venc", "EnableStreamReactor", 0);
+    return value ? AX_TRUE : AX_FALSE;
+#else
+    return AX_FALSE;
+#endif
+}
+
 AX_U32 COptionHelper::GetSLTRunTime() {
 #ifndef _OPAL_LIB_
     AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("slt", "RunTime", 0);
@@ -424,4 +514,93 @@ AX_U32 COptionHelper::GetDiscardYuvFrmNum() {
 #else
     return 0;
 #endif
-}
\ No newline at end of file
+}
+
+AX_U32 COptionHelper::GetStageQueueType(const std::string &strStage) {
+#ifndef _OPAL_LIB_
+    AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("stage", strStage + "QueueType", 0);
+    return value;
+#else
+    return 0;
+#endif
+}
+
+AX_BOOL COptionHelper::IsEnableLatencyTrace() {
+#ifndef _OPAL_LIB_
+    AX_S32 value = m_iniWrapper.GetIntValue("stage", "LatencyTrace", 0);
+    return (value != 0) ? AX_TRUE : AX_FALSE;
+#else
+    return AX_FALSE;
+#endif
+}
+
+AX_U32 COptionHelper::GetDetectInflightNum() {
+#ifndef _OPAL_LIB_
+    AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("detect", "InflightFrameNum", 0);
+    return value;
+#else
+    return 0;
+#endif
+}
+
+AX_U32 COptionHelper::GetDetectSchedMode() {
+#ifndef _OPAL_LIB_
+    AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("detect", "SchedMode", 0);
+    return value;
+#else
+    return 0;
+#endif
+}
+
+AX_U32 COptionHelper::GetDetectBatchBudget() {
+#ifndef _OPAL_LIB_
+    AX_U32 value = (AX_U32)m_iniWrapper.GetIntValue("detect", "BatchBudgetMs", 5);
+    return value;
+#else
+    return 5;
+#endif
+}
+
+AX_U32 COptionHelper::GetDetectSnsWeight(AX_U32 nSnsId) {
+#ifndef _OPAL_LIB_
+    std::vector<AX_S32> vecWeight;
+    m_iniWrapper.GetIntValue("detect", "SnsWeight", vecWeight);
+    return (nSnsId < vecWeight.size() && vecWeight[nSnsId] > 0) ? (AX_U32)vecWeight[nSnsId] : 1;
+#else
+    return 1;
+#endif
+}
+
+AX_BOOL COptionHelper::IsEnableDetectAdaptiveSkip() {
+#ifndef _OPAL_LIB_
+    AX_S32 value = m_iniWrapper.GetIntValue("detect", "AdaptiveSkip", 1);
+    return (value != 0) ? AX_TRUE : AX_FALSE;
+#else
+    return AX_TRUE;
+#endif
+}
+
+AX_U32 COptionHelper::GetPoolAutoSizeMode() {
+#ifndef _OPAL_LIB_
+    AX_S32 value = m_iniWrapper.GetIntValue("pool", "AutoSizeMode", 0);
+    return (value > 0) ? (AX_U32)value : 0;
+#else
+    return 0;
+#endif
+}
+
+std::string COptionHelper::GetPoolProfile() {
+#ifndef _OPAL_LIB_
+    return m_iniWrapper.GetStringValue("pool", "Profile", "pool_profile.ini");
+#else
+    return "";
+#endif
+}
+
+AX_F64 COptionHelper::GetPoolTargetDropRate() {
+#ifndef _OPAL_LIB_
+    return m_iniWrapper.GetDoubleValue("pool", "TargetDropRate", 0.001);
+#else
+    return 0.001;
+#endif
+}
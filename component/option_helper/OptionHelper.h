@@ -50,6 +50,14 @@ public:
     AX_U32 GetMp4FileSize();
     AX_U32 GetMp4FileCount();
     AX_BOOL GetMp4LoopSet();
+    AX_BOOL IsMp4Fragmented();
+    AX_U32 GetMp4FragmentSize();
+    AX_BOOL IsEnableEventRecord();
+    std::string GetEventRecordSavedPath();
+    AX_U32 GetEventPreRecordSec();
+    AX_U32 GetEventPostRecordSec();
+    AX_U32 GetEventRecordFileCount();
+    AX_U32 GetEventRecordTrigger();
     /* SLT functions */
     AX_U32 GetSLTRunTime();
     AX_U32 GetSLTFpsCheckFreq();
@@ -58,6 +66,8 @@ public:
     AX_U32 GetVencThreadNum();
     AX_BOOL IsEnableVencDebreath();
     AX_BOOL IsEnableVencRefRingbuf();
+    AX_BOOL IsEnableSharedStreamBuf();
+    AX_BOOL IsEnableVencStreamReactor();
 
     AX_BOOL GetInterpolationResolution(AX_U32 &nWidth, AX_U32 &nHeight);
     AX_BOOL SetInterpolationResolution(const AX_U32 &nWidth, const AX_U32 &nHeight);
@@ -76,6 +86,26 @@ public:
 
     AX_U32 GetDiscardYuvFrmNum();
 
+    /* frame queue backend of stage, see AX_APP_LOCKQ_TYPE_E */
+    AX_U32 GetStageQueueType(const std::string &strStage);
+    /* latency histograms and frame trace of stages */
+    AX_BOOL IsEnableLatencyTrace();
+
+    /* frames in flight of detector, 0 means default */
+    AX_U32 GetDetectInflightNum();
+    /* detector scheduler, see DETECT_SCHED_MODE_E */
+    AX_U32 GetDetectSchedMode();
+    AX_U32 GetDetectBatchBudget();
+    /* NPU share of sensor in batch mode, default 1 */
+    AX_U32 GetDetectSnsWeight(AX_U32 nSnsId);
+    AX_BOOL IsEnableDetectAdaptiveSkip();
+
+    /* pool floor plan auto sizing, see POOL_AUTO_SIZE_MODE_E */
+    AX_U32 GetPoolAutoSizeMode();
+    std::string GetPoolProfile();
+    /* frames dropped by app / frames got, above which a pool is not shrunk */
+    AX_F64 GetPoolTargetDropRate();
+
 private:
     COptionHelper(AX_VOID) = default;
     ~COptionHelper(AX_VOID) = default;
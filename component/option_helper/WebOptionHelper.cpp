@@ -11,6 +11,7 @@
 #include "WebOptionHelper.h"
 #include "AlgoOptionHelper.h"
 #include "CmdLineParser.h"
+#include "AXJsonWriter.hpp"
 #include "ElapsedTimer.hpp"
 #include "GlobalDef.h"
 #include "ISensor.hpp"
@@ -254,16 +255,21 @@ AX_BOOL CWebOptionHelper::GetCapSettingStr(AX_CHAR* pOutBuf, AX_U32 nSize) {
     }
 
     AX_BOOL bDualSnsMode = (APP_SENSOR_COUNT() == 1 || CCommonUtils::GetPPLSpecification() == "PANO") ? AX_FALSE : AX_TRUE;
-    AX_S32 nCount = snprintf(pOutBuf, nSize,
-                             "{support_dual_sns: %d, support_page_sys: %d, support_page_cam: %d, support_page_img: %d, support_page_ai: "
-                             "%d, support_page_audio: %d, "
-                             "support_page_video: %d, "
-                             "support_page_overlay: %d, support_page_storage: %d, support_page_playback: %d}",
-                             bDualSnsMode, m_mapCapabilities["sys"], m_mapCapabilities["cam"], m_mapCapabilities["img"],
-                             m_mapCapabilities["ai"], m_mapCapabilities["audio"], m_mapCapabilities["video"], m_mapCapabilities["overlay"],
-                             m_mapCapabilities["storage"], m_mapCapabilities["playback"]);
-
-    return nCount > 0 ? AX_TRUE : AX_FALSE;
+    CAXJsonWriter tJson(pOutBuf, nSize);
+    tJson.BeginObject();
+    tJson.Int("support_dual_sns", bDualSnsMode);
+    tJson.Int("support_page_sys", m_mapCapabilities["sys"]);
+    tJson.Int("support_page_cam", m_mapCapabilities["cam"]);
+    tJson.Int("support_page_img", m_mapCapabilities["img"]);
+    tJson.Int("support_page_ai", m_mapCapabilities["ai"]);
+    tJson.Int("support_page_audio", m_mapCapabilities["audio"]);
+    tJson.Int("support_page_video", m_mapCapabilities["video"]);
+    tJson.Int("support_page_overlay", m_mapCapabilities["overlay"]);
+    tJson.Int("support_page_storage", m_mapCapabilities["storage"]);
+    tJson.Int("support_page_playback", m_mapCapabilities["playback"]);
+    tJson.EndObject();
+
+    return tJson.IsValid();
 }
 
 WEB_CAMERA_ATTR_T& CWebOptionHelper::GetCamera(AX_U8 nSnsID) {
@@ -308,20 +314,17 @@ AX_BOOL CWebOptionHelper::GetImageStr(AX_U8 nSnsID, AX_CHAR* pOutBuf, AX_U32 nSi
         return AX_FALSE;
     }
     std::lock_guard<std::mutex> lck(m_mapSns2MtxOption[nSnsID]);
-    WEB_CAMERA_ATTR_T attr = m_mapSns2CameraSetting[nSnsID];
-    picojson::object json;
-    json["isp_auto_mode"] = JSON2INT(attr.tImageAttr.nAutoMode);
-    json["sharpness"] = JSON2INT(attr.tImageAttr.nSharpness);
-    json["brightness"] = JSON2INT(attr.tImageAttr.nBrightness);
-    json["contrast"] = JSON2INT(attr.tImageAttr.nContrast);
-    json["saturation"] = JSON2INT(attr.tImageAttr.nSaturation);
-    std::string strJson = picojson::value(json).serialize().data();
-    if (strJson.size() > (nSize - 1)) {
-        return AX_FALSE;
-    }
-    memcpy(pOutBuf, strJson.data(), strJson.size());
-    pOutBuf[strJson.size()] = 0;
-    return AX_TRUE;
+    const WEB_CAMERA_ATTR_T& attr = m_mapSns2CameraSetting[nSnsID];
+    CAXJsonWriter tJson(pOutBuf, nSize);
+    tJson.BeginObject();
+    tJson.Int("isp_auto_mode", attr.tImageAttr.nAutoMode);
+    tJson.Int("sharpness", attr.tImageAttr.nSharpness);
+    tJson.Int("brightness", attr.tImageAttr.nBrightness);
+    tJson.Int("contrast", attr.tImageAttr.nContrast);
+    tJson.Int("saturation", attr.tImageAttr.nSaturation);
+    tJson.EndObject();
+
+    return tJson.IsValid();
 }
 
 AX_BOOL CWebOptionHelper::GetLdcStr(AX_U8 nSnsID, AX_CHAR* pOutBuf, AX_U32 nSize) {
@@ -329,41 +332,34 @@ AX_BOOL CWebOptionHelper::GetLdcStr(AX_U8 nSnsID, AX_CHAR* pOutBuf, AX_U32 nSize
         return AX_FALSE;
     }
     std::lock_guard<std::mutex> lck(m_mapSns2MtxOption[nSnsID]);
-    WEB_CAMERA_ATTR_T attr = m_mapSns2CameraSetting[nSnsID];
-    picojson::object json;
-    json["ldc_support"] = JSON2BOOL(attr.bLdcEnable);
-    json["ldc_enable"] = JSON2BOOL(attr.tLdcAttr.bLdcEnable);
-    json["aspect"] = JSON2BOOL(attr.tLdcAttr.bLdcAspect);
-    json["x_ratio"] = JSON2INT(attr.tLdcAttr.nXRatio);
-    json["y_ratio"] = JSON2INT(attr.tLdcAttr.nYRatio);
-    json["xy_ratio"] = JSON2INT(attr.tLdcAttr.nXYRatio);
-    json["distor_ratio"] = JSON2INT(attr.tLdcAttr.nDistorRatio);
-    std::string strJson = picojson::value(json).serialize().data();
-    if (strJson.size() > (nSize - 1)) {
-        return AX_FALSE;
-    }
-    memcpy(pOutBuf, strJson.data(), strJson.size());
-    pOutBuf[strJson.size()] = 0;
-    return AX_TRUE;
+    const WEB_CAMERA_ATTR_T& attr = m_mapSns2CameraSetting[nSnsID];
+    CAXJsonWriter tJson(pOutBuf, nSize);
+    tJson.BeginObject();
+    tJson.Bool("ldc_support", attr.bLdcEnable);
+    tJson.Bool("ldc_enable", attr.tLdcAttr.bLdcEnable);
+    tJson.Bool("aspect", attr.tLdcAttr.bLdcAspect);
+    tJson.Int("x_ratio", attr.tLdcAttr.nXRatio);
+    tJson.Int("y_ratio", attr.tLdcAttr.nYRatio);
+    tJson.Int("xy_ratio", attr.tLdcAttr.nXYRatio);
+    tJson.Int("distor_ratio", attr.tLdcAttr.nDistorRatio);
+    tJson.EndObject();
+
+    return tJson.IsValid();
 }
 
 AX_BOOL CWebOptionHelper::GetDisStr(AX_U8 nSnsID, AX_CHAR* pOutBuf, AX_U32 nSize) {
-    WEB_CAMERA_ATTR_T attr;
-    {
-        std::lock_guard<std::mutex> lck(m_mapSns2MtxOption[nSnsID]);
-        attr = m_mapSns2CameraSetting[nSnsID];
-    }
-
-    picojson::object json;
-    json["dis_support"] = JSON2BOOL(attr.bDisSupport);
-    json["dis_enable"] = JSON2BOOL(attr.tDisAttr.bDisEnable);
-    std::string strJson = picojson::value(json).serialize().data();
-    if (strJson.size() > (nSize - 1)) {
+    if (nullptr == pOutBuf || 0 == nSize) {
         return AX_FALSE;
     }
-    memcpy(pOutBuf, strJson.data(), strJson.size());
-    pOutBuf[strJson.size()] = 0;
-    return AX_TRUE;
+    std::lock_guard<std::mutex> lck(m_mapSns2MtxOption[nSnsID]);
+    const WEB_CAMERA_ATTR_T& attr = m_mapSns2CameraSetting[nSnsID];
+    CAXJsonWriter tJson(pOutBuf, nSize);
+    tJson.BeginObject();
+    tJson.Bool("dis_support", attr.bDisSupport);
+    tJson.Bool("dis_enable", attr.tDisAttr.bDisEnable);
+    tJson.EndObject();
+
+    return tJson.IsValid();
 }
 
 AX_U8 CWebOptionHelper::GetVideoCount(AX_U8 nSnsID) {
@@ -671,8 +667,10 @@ AX_BOOL CWebOptionHelper::GetAssistBitrateStr(AX_U8 nSnsID, AX_U32 nUniChn, AX_C
 
     AX_F64 fBitrate = m_mapSns2ChnStatInfo[nSnsID][nUniChn].nVencOutBytes / (AX_F64)nGap * 8;
 
-    AX_S32 nCount = snprintf(pOutBuf, nSize, "%.2fkbps", fBitrate);
-    if (nCount <= 0) {
+    /* string value, e.g. "1024.00kbps" */
+    CAXJsonWriter tJson(pOutBuf, nSize);
+    tJson.Raw("\"", 1).Float(fBitrate, 2).Raw("kbps\"", 5);
+    if (!tJson.IsValid()) {
         return AX_FALSE;
     }
 
@@ -723,124 +721,81 @@ AX_BOOL CWebOptionHelper::GetAiInfoStr(AX_U8 nSnsID, AX_CHAR* pOutBuf, AX_U32 nS
 
     std::lock_guard<std::mutex> lck(m_mapSns2MtxAi[nSnsID]);
 
-    AX_CHAR szPushStrgy[128] = {0};
-    AX_CHAR szDetModelAttr[512] = {0};
-    AX_CHAR szEvent[256] = {0};
-    AX_CHAR szSvc[512] = {0};
+    const AI_ATTR_T& tAiAttr = m_mapSns2AiAttr[nSnsID];
+    std::string strDetectModel = GetDetectModelStr(nSnsID);
+
+    CAXJsonWriter tJson(pOutBuf, nSize);
+    tJson.BeginObject();
+    tJson.Bool("ai_enable", tAiAttr.bEnable);
+    tJson.String("detect_model", strDetectModel.c_str());
+    tJson.Int("detect_fps", 10);
+    tJson.Key("push_strategy").BeginObject();
+    GetPushStrgyStr(nSnsID, tJson);
+    tJson.EndObject();
+    tJson.Bool("detect_only", AX_TRUE);
+    tJson.Key(strDetectModel.c_str()).BeginObject();
+    GetDetectModelAttrStr(tJson);
+    tJson.EndObject();
+    tJson.Key("body_roi").BeginObject();
+    tJson.Bool("enable", tAiAttr.tAeRoiBody.bEnable).Int("min_width", tAiAttr.tAeRoiBody.nWidth);
+    tJson.Int("min_height", tAiAttr.tAeRoiBody.nHeight).Int("mode", tAiAttr.tAeRoiBody.eMode);
+    tJson.EndObject();
+    tJson.Key("vehicle_roi").BeginObject();
+    tJson.Bool("enable", tAiAttr.tAeRoiVehicle.bEnable).Int("min_width", tAiAttr.tAeRoiVehicle.nWidth);
+    tJson.Int("min_height", tAiAttr.tAeRoiVehicle.nHeight).Int("mode", tAiAttr.tAeRoiVehicle.eMode);
+    tJson.EndObject();
+    tJson.Key("events").BeginObject();
+    GetEventsStr(nSnsID, tJson);
+    tJson.EndObject();
+    tJson.Key("svc").BeginObject();
+    GetAlgoSvcStr(nSnsID, tJson);
+    tJson.EndObject();
+    tJson.EndObject();
+
+    return tJson.IsValid();
+}
 
-    if (!GetPushStrgyStr(nSnsID, szPushStrgy, 128)
-        || !GetDetectModelAttrStr(szDetModelAttr, 512)
-        || !GetEventsStr(nSnsID, szEvent, 256)
-        || !GetAlgoSvcStr(nSnsID, szSvc, 512)) {
-        return AX_FALSE;
-    }
+AX_BOOL CWebOptionHelper::GetPushStrgyStr(AX_U8 nSnsID, CAXJsonWriter& tJson) {
+    const AI_PUSH_STATEGY_T& tPushStategy = m_mapSns2AiAttr[nSnsID].tPushStategy;
+    tJson.String("push_mode", GetPushModeStr(tPushStategy.ePushMode).c_str());
+    tJson.Int("push_interval", tPushStategy.nPushIntervalMs);
+    tJson.Int("push_count", tPushStategy.nPushCounts);
+    tJson.Bool("push_same_frame", AX_TRUE);
 
-    AX_S32 nCount = snprintf(pOutBuf, nSize,
-        "{ai_enable: %s, \
-        detect_model: %s, \
-        detect_fps: %d, \
-        push_strategy: {%s}, \
-        detect_only: %s, \
-        %s: {%s}, \
-        body_roi: {enable:%s, min_width:%d, min_height:%d, mode:%d}, \
-        vehicle_roi: {enable:%s, min_width:%d, min_height:%d, mode:%d}, \
-        events: {%s}, \
-        svc: {%s}}",
-        ADAPTER_INT2BOOLSTR(m_mapSns2AiAttr[nSnsID].bEnable),
-        GetDetectModelStr(nSnsID).c_str(),
-        10,
-        szPushStrgy,
-        ADAPTER_INT2BOOLSTR(1),
-        GetDetectModelStr(nSnsID).c_str(), szDetModelAttr,
-        ADAPTER_INT2BOOLSTR(m_mapSns2AiAttr[nSnsID].tAeRoiBody.bEnable),m_mapSns2AiAttr[nSnsID].tAeRoiBody.nWidth, m_mapSns2AiAttr[nSnsID].tAeRoiBody.nHeight,m_mapSns2AiAttr[nSnsID].tAeRoiBody.eMode,
-        ADAPTER_INT2BOOLSTR(m_mapSns2AiAttr[nSnsID].tAeRoiVehicle.bEnable),m_mapSns2AiAttr[nSnsID].tAeRoiVehicle.nWidth, m_mapSns2AiAttr[nSnsID].tAeRoiVehicle.nHeight,m_mapSns2AiAttr[nSnsID].tAeRoiVehicle.eMode,
-        szEvent,
-        szSvc);
-
-    return nCount > 0 ? AX_TRUE : AX_FALSE;
+    return tJson.IsOverflow() ? AX_FALSE : AX_TRUE;
 }
-AX_BOOL CWebOptionHelper::GetPushStrgyStr(AX_U8 nSnsID, AX_CHAR* pOutBuf, AX_U32 nSize) {
-    if (nullptr == pOutBuf || 0 == nSize) {
-        return AX_FALSE;
+
+AX_BOOL CWebOptionHelper::GetDetectModelAttrStr(CAXJsonWriter& tJson) {
+    /* detect/draw switches are not configurable yet, always reported as disabled */
+    static const struct {
+        const AX_CHAR* pszName;
+        AX_BOOL bDrawRect;
+    } arrAttrs[] = {{"face_detect", AX_TRUE},  {"face_identify", AX_FALSE}, {"body_detect", AX_TRUE},    {"vechicle_detect", AX_TRUE},
+                    {"cycle_detect", AX_TRUE}, {"plate_detect", AX_TRUE},   {"plate_identify", AX_FALSE}};
+    for (auto& tAttr : arrAttrs) {
+        tJson.Key(tAttr.pszName).BeginObject().Bool("enable", AX_FALSE);
+        if (tAttr.bDrawRect) {
+            tJson.Bool("draw_rect", AX_FALSE);
+        }
+        tJson.EndObject();
     }
-    std::string strPushMode = GetPushModeStr(m_mapSns2AiAttr[nSnsID].tPushStategy.ePushMode);
-    AX_U32 nPushCounts = m_mapSns2AiAttr[nSnsID].tPushStategy.nPushCounts;
-    AX_U32 nPushIntervalMs = m_mapSns2AiAttr[nSnsID].tPushStategy.nPushIntervalMs;
-    AX_S32 nCount = snprintf(pOutBuf, nSize, "push_mode: %s, push_interval:%d, push_count: %d, push_same_frame: %s", strPushMode.c_str(),
-                             nPushIntervalMs, nPushCounts, ADAPTER_INT2BOOLSTR(1));
 
-    return nCount > 0 ? AX_TRUE : AX_FALSE;
+    return tJson.IsOverflow() ? AX_FALSE : AX_TRUE;
 }
 
-AX_BOOL CWebOptionHelper::GetDetectModelAttrStr(AX_CHAR* pOutBuf, AX_U32 nSize) {
-    if (nullptr == pOutBuf || 0 == nSize) {
-        return AX_FALSE;
-    }
-
-    AX_S32 nCount = 0;
-    nCount = snprintf(pOutBuf, nSize,
-                      "face_detect: {enable: %s, draw_rect: %s}, \
-                        face_identify: {enable: %s}, \
-                        body_detect: {enable: %s, draw_rect: %s}, \
-                        vechicle_detect: {enable: %s, draw_rect: %s}, \
-                        cycle_detect: {enable: %s, draw_rect: %s}, \
-                        plate_detect: {enable: %s, draw_rect: %s}, \
-                        plate_identify: {enable: %s}",
-                      ADAPTER_INT2BOOLSTR(0), ADAPTER_INT2BOOLSTR(0), ADAPTER_INT2BOOLSTR(0), ADAPTER_INT2BOOLSTR(0),
-                      ADAPTER_INT2BOOLSTR(0), ADAPTER_INT2BOOLSTR(0), ADAPTER_INT2BOOLSTR(0), ADAPTER_INT2BOOLSTR(0),
-                      ADAPTER_INT2BOOLSTR(0), ADAPTER_INT2BOOLSTR(0), ADAPTER_INT2BOOLSTR(0), ADAPTER_INT2BOOLSTR(0));
-
-    /*
-        AX_S32 nCount = 0;
-        if (E_AI_DETECT_MODEL_TYPE_FACEHUMAN == m_tAiAttr.eDetectModel) {
-            nCount = snprintf(pOutBuf, nSize, "face_detect: {enable: %s, draw_rect: %s}, \
-                body_detect: {enable: %s, draw_rect: %s}, \
-                face_identify: {enable: %s}",
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHumanFaceSetting.tFace.nEnable),
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHumanFaceSetting.tFace.nDrawRect),
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHumanFaceSetting.tBody.nEnable),
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHumanFaceSetting.tBody.nDrawRect),
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHumanFaceSetting.nEnableFI));
-        } else if (E_AI_DETECT_MODEL_TYPE_HVCFP == m_tAiAttr.eDetectModel) {
-            nCount = snprintf(pOutBuf, nSize, "face_detect: {enable: %s, draw_rect: %s}, \
-                body_detect: {enable: %s, draw_rect: %s}, \
-                vechicle_detect: {enable: %s, draw_rect: %s}, \
-                cycle_detect: {enable: %s, draw_rect: %s}, \
-                plate_detect: {enable: %s, draw_rect: %s}, \
-                plate_identify: {enable: %s}",
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHvcfpSetting.tFace.nEnable),
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHvcfpSetting.tFace.nDrawRect),
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHvcfpSetting.tBody.nEnable),
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHvcfpSetting.tBody.nDrawRect),
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHvcfpSetting.tVechicle.nEnable),
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHvcfpSetting.tVechicle.nDrawRect),
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHvcfpSetting.tCycle.nEnable),
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHvcfpSetting.tCycle.nDrawRect),
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHvcfpSetting.tPlate.nEnable),
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHvcfpSetting.tPlate.nDrawRect),
-                ADAPTER_INT2BOOLSTR(m_tAiAttr.tHvcfpSetting.nEnablePI));
-        }
-    */
-    return nCount > 0 ? AX_TRUE : AX_FALSE;
+static AX_VOID WriteEventsDetectAttr(CAXJsonWriter& tJson, const AX_CHAR* pszName, const WEB_OPR_EVENTS_DETECT_ATTR_T& tAttr) {
+    tJson.Key(pszName).BeginObject();
+    tJson.Bool("enable", tAttr.bEnable).Int("threshold_y", tAttr.nThrsHoldY).Int("confidence", tAttr.nConfidence);
+    tJson.EndObject();
 }
 
-AX_BOOL CWebOptionHelper::GetEventsStr(AX_U8 nSnsID, AX_CHAR* pOutBuf, AX_U32 nSize) {
-    if (nullptr == pOutBuf || 0 == nSize) {
-        return AX_FALSE;
-    }
+AX_BOOL CWebOptionHelper::GetEventsStr(AX_U8 nSnsID, CAXJsonWriter& tJson) {
+    const AI_EVENTS_OPTION_T& tEvents = m_mapSns2AiAttr[nSnsID].tEvents;
+    WriteEventsDetectAttr(tJson, "motion_detect", tEvents.tMD);
+    WriteEventsDetectAttr(tJson, "occlusion_detect", tEvents.tOD);
+    WriteEventsDetectAttr(tJson, "scene_change_detect", tEvents.tSCD);
 
-    AX_S32 nCount =
-        snprintf(pOutBuf, nSize,
-                 "motion_detect: {enable: %s, threshold_y: %d, confidence: %d}, \
-                  occlusion_detect: {enable: %s, threshold_y: %d, confidence: %d}, \
-                  scene_change_detect: {enable: %s, threshold_y: %d, confidence: %d}",
-                  ADAPTER_BOOL2BOOLSTR(m_mapSns2AiAttr[nSnsID].tEvents.tMD.bEnable), m_mapSns2AiAttr[nSnsID].tEvents.tMD.nThrsHoldY,
-                  m_mapSns2AiAttr[nSnsID].tEvents.tMD.nConfidence, ADAPTER_BOOL2BOOLSTR(m_mapSns2AiAttr[nSnsID].tEvents.tOD.bEnable),
-                  m_mapSns2AiAttr[nSnsID].tEvents.tOD.nThrsHoldY, m_mapSns2AiAttr[nSnsID].tEvents.tOD.nConfidence,
-                  ADAPTER_BOOL2BOOLSTR(m_mapSns2AiAttr[nSnsID].tEvents.tSCD.bEnable), m_mapSns2AiAttr[nSnsID].tEvents.tSCD.nThrsHoldY,
-                  m_mapSns2AiAttr[nSnsID].tEvents.tSCD.nConfidence);
-
-    return nCount > 0 ? AX_TRUE : AX_FALSE;
+    return tJson.IsOverflow() ? AX_FALSE : AX_TRUE;
 }
 
 std::string CWebOptionHelper::GetDetectModelStr(AX_U8 nSnsID) {
@@ -853,35 +808,32 @@ std::string CWebOptionHelper::GetDetectModelStr(AX_U8 nSnsID) {
     }
 }
 
-AX_BOOL CWebOptionHelper::GetAlgoSvcStr(AX_U8 nSnsID, AX_CHAR* pOutBuf, AX_U32 nSize) {
-    if (nullptr == pOutBuf || 0 == nSize) {
-        return AX_FALSE;
-    }
+static AX_VOID WriteSvcQpMap(CAXJsonWriter& tJson, const AX_CHAR* pszName, const AI_SVC_MAP_PARAM_T& tQpMap) {
+    tJson.Key(pszName).BeginObject().Int("iQp", tQpMap.iQp).Int("pQp", tQpMap.pQp).EndObject();
+}
 
-    const AI_SVC_OPTION_T &tSvcParam = m_mapSns2AiAttr[nSnsID].tSvcParam;
-
-    AX_S32 nCount =
-        snprintf(pOutBuf, nSize,
-                 "valid: %s, \
-                  sync_valid: %s, \
-                  enable: %s, \
-                  sync_mode: %s, \
-                  bg_qp: {iQp: %d, pQp: %d}, \
-                  body: {enable: %s, qp: {iQp: %d, pQp: %d}}, \
-                  vehicle: {enable: %s, qp: {iQp: %d, pQp: %d}}, \
-                  cycle: {enable: %s, qp: {iQp: %d, pQp: %d}}, \
-                  face: {enable: %s, qp: {iQp: %d, pQp: %d}}, \
-                  plate: {enable: %s, qp: {iQp: %d, pQp: %d}}",
-                  ADAPTER_BOOL2BOOLSTR(tSvcParam.bValid), ADAPTER_BOOL2BOOLSTR(tSvcParam.bSyncValid),
-                  ADAPTER_BOOL2BOOLSTR(tSvcParam.bEnable), ADAPTER_BOOL2BOOLSTR(tSvcParam.bSync),
-                  tSvcParam.tBgQpCfg.iQp, tSvcParam.tBgQpCfg.pQp,
-                  ADAPTER_BOOL2BOOLSTR(tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_BODY].bEnable), tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_BODY].tQpMap.iQp, tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_BODY].tQpMap.pQp,
-                  ADAPTER_BOOL2BOOLSTR(tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_VEHICLE].bEnable), tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_VEHICLE].tQpMap.iQp, tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_VEHICLE].tQpMap.pQp,
-                  ADAPTER_BOOL2BOOLSTR(tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_CYCLE].bEnable), tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_CYCLE].tQpMap.iQp, tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_CYCLE].tQpMap.pQp,
-                  ADAPTER_BOOL2BOOLSTR(tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_FACE].bEnable), tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_FACE].tQpMap.iQp, tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_FACE].tQpMap.pQp,
-                  ADAPTER_BOOL2BOOLSTR(tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_PLATE].bEnable), tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_PLATE].tQpMap.iQp, tSvcParam.tQpCfg[AX_APP_ALGO_HVCFP_PLATE].tQpMap.pQp);
-
-    return nCount > 0 ? AX_TRUE : AX_FALSE;
+AX_BOOL CWebOptionHelper::GetAlgoSvcStr(AX_U8 nSnsID, CAXJsonWriter& tJson) {
+    static const struct {
+        const AX_CHAR* pszName;
+        AX_APP_ALGO_HVCFP_TYPE_E eType;
+    } arrTargets[] = {{"body", AX_APP_ALGO_HVCFP_BODY},
+                      {"vehicle", AX_APP_ALGO_HVCFP_VEHICLE},
+                      {"cycle", AX_APP_ALGO_HVCFP_CYCLE},
+                      {"face", AX_APP_ALGO_HVCFP_FACE},
+                      {"plate", AX_APP_ALGO_HVCFP_PLATE}};
+
+    const AI_SVC_OPTION_T& tSvcParam = m_mapSns2AiAttr[nSnsID].tSvcParam;
+    tJson.Bool("valid", tSvcParam.bValid).Bool("sync_valid", tSvcParam.bSyncValid);
+    tJson.Bool("enable", tSvcParam.bEnable).Bool("sync_mode", tSvcParam.bSync);
+    WriteSvcQpMap(tJson, "bg_qp", tSvcParam.tBgQpCfg);
+    for (auto& tTarget : arrTargets) {
+        tJson.Key(tTarget.pszName).BeginObject();
+        tJson.Bool("enable", tSvcParam.tQpCfg[tTarget.eType].bEnable);
+        WriteSvcQpMap(tJson, "qp", tSvcParam.tQpCfg[tTarget.eType].tQpMap);
+        tJson.EndObject();
+    }
+
+    return tJson.IsOverflow() ? AX_FALSE : AX_TRUE;
 }
 
 AX_BOOL CWebOptionHelper::ParseWebRequest(WEB_REQUEST_TYPE_E eReqType, const AX_VOID* pJsonReq, vector<WEB_REQ_OPERATION_T>& vecWebOpr) {
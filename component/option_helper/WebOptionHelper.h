@@ -14,6 +14,7 @@
 #include <map>
 #include <mutex>
 #include <vector>
+#include "AXJsonWriter.hpp"
 #include "AXSingleton.h"
 #include "AXTypeConverter.hpp"
 #include "OSDHandler.h"
@@ -25,8 +26,11 @@
 
 #define MAX_VIDEO_ATTR_NUM 4
 #define MAX_REGION_NUM (32)
+/* quoted bitrate with unit and terminator, e.g. "1024.00kbps" */
+#define WEB_ASSIST_BITRATE_STR_LEN (AX_JSON_MAX_FLOAT_LEN + 7)
 
 struct MprJson;
+class CAXJsonWriter;
 
 typedef struct _WEB_CAMERA_ATTR_T {
     AX_U8 nSnsMode;
@@ -231,11 +235,12 @@ public:
     /* AI functions */
     AX_BOOL GetAiInfoStr(AX_U8 nSnsID, AX_CHAR* pOutBuf, AX_U32 nSize);
     std::string GetDetectModelStr(AX_U8 nSnsID);
-    AX_BOOL GetPushStrgyStr(AX_U8 nSnsID, AX_CHAR* pOutBuf, AX_U32 nSize);
+    /* write members into current json object of GetAiInfoStr */
+    AX_BOOL GetPushStrgyStr(AX_U8 nSnsID, CAXJsonWriter& tJson);
     std::string GetPushModeStr(AX_S32 mode);
-    AX_BOOL GetDetectModelAttrStr(AX_CHAR* pOutBuf, AX_U32 nSize);
-    AX_BOOL GetEventsStr(AX_U8 nSnsID, AX_CHAR* pOutBuf, AX_U32 nSize);
-    AX_BOOL GetAlgoSvcStr(AX_U8 nSnsID, AX_CHAR* pOutBuf, AX_U32 nSize);
+    AX_BOOL GetDetectModelAttrStr(CAXJsonWriter& tJson);
+    AX_BOOL GetEventsStr(AX_U8 nSnsID, CAXJsonWriter& tJson);
+    AX_BOOL GetAlgoSvcStr(AX_U8 nSnsID, CAXJsonWriter& tJson);
     E_AI_DETECT_PUSH_MODE_TYPE ParseResAiStr(std::string& strAiPushMode);
 
     AX_BOOL StatVencOutBytes(AX_U8 nSnsID, AX_U32 nUniChn, AX_U32 nBytes);
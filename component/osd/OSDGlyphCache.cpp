@@ -0,0 +1,274 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "OSDGlyphCache.h"
+#include <string.h>
+#include <algorithm>
+#include "FontIndex.h"
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static inline AX_U32 GetGlyphBytes(const OSD_GLYPH_T &tGlyph) {
+    return (AX_U32)(tGlyph.vecArgb.size() * sizeof(AX_U16) + tGlyph.vecType.size() + tGlyph.vecFontMask.size() * sizeof(AX_U64) +
+                    sizeof(OSD_GLYPH_T));
+}
+
+/* set bits [nStart, nEnd) of a packed mask row */
+static inline AX_VOID SetMaskRange(AX_U64 *pWords, AX_U32 nStart, AX_U32 nEnd) {
+    while (nStart < nEnd) {
+        AX_U32 nBit = nStart % 64;
+        AX_U32 nLen = std::min(64 - nBit, nEnd - nStart);
+        pWords[nStart / 64] |= (64 == nLen) ? ~0ULL : (((1ULL << nLen) - 1) << nBit);
+        nStart += nLen;
+    }
+}
+
+/* call fn(nStart, nEnd) for each run of set bits of a packed mask row, runs are split at word boundaries */
+template <typename FN>
+static inline AX_VOID ForEachMaskRun(const AX_U64 *pWords, AX_U32 nWords, FN fn) {
+    for (AX_U32 w = 0; w < nWords; ++w) {
+        AX_U64 nBits = pWords[w];
+        while (nBits) {
+            AX_U32 nStart = __builtin_ctzll(nBits);
+            AX_U64 nZeros = ~(nBits >> nStart);
+            AX_U32 nEnd = nStart + (nZeros ? __builtin_ctzll(nZeros) : 64);
+            fn(w * 64 + nStart, w * 64 + nEnd);
+            nBits = (nEnd >= 64) ? 0 : (nBits & (~0ULL << nEnd));
+        }
+    }
+}
+
+/* set bits [nStart, nEnd) of 1bpp bitmap, bit order of COSDHandler::GenBitmap */
+static inline AX_VOID SetBitmapRange(AX_U8 *pBitmap, AX_U32 nStart, AX_U32 nEnd) {
+    for (; nStart < nEnd && (nStart % 8); ++nStart) {
+        pBitmap[nStart / 8] |= (1 << (nStart % 8));
+    }
+
+    if (nStart + 8 <= nEnd) {
+        AX_U32 nBytes = (nEnd - nStart) / 8;
+        memset(pBitmap + nStart / 8, 0xFF, nBytes);
+        nStart += nBytes * 8;
+    }
+
+    for (; nStart < nEnd; ++nStart) {
+        pBitmap[nStart / 8] |= (1 << (nStart % 8));
+    }
+}
+
+std::shared_ptr<const OSD_GLYPH_T> COSDGlyphCache::Get(AX_U16 nUnicode, AX_U16 nScale, AX_BOOL bBrushSide, AX_U16 nFontColor,
+                                                       AX_U16 nSideColor) {
+    if (0 == nScale || nScale > 0xFF) {
+        return nullptr;
+    }
+
+    if (!bBrushSide) {
+        nSideColor = 0;
+    }
+
+    AX_U64 nKey = ((AX_U64)nUnicode << 48) | ((AX_U64)nScale << 40) | ((AX_U64)(bBrushSide ? 1 : 0) << 32) | ((AX_U64)nFontColor << 16) |
+                  (AX_U64)nSideColor;
+
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        auto it = m_mapItems.find(nKey);
+        if (it != m_mapItems.end()) {
+            m_lstItems.splice(m_lstItems.begin(), m_lstItems, it->second);
+            return it->second->pGlyph;
+        }
+    }
+
+    /* rasterise without lock, a concurrent miss of the same key only wastes one rasterisation */
+    std::shared_ptr<const OSD_GLYPH_T> pGlyph = Rasterize(nUnicode, nScale, bBrushSide, nFontColor, nSideColor);
+    if (!pGlyph) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    auto it = m_mapItems.find(nKey);
+    if (it != m_mapItems.end()) {
+        m_lstItems.splice(m_lstItems.begin(), m_lstItems, it->second);
+        return it->second->pGlyph;
+    }
+
+    m_lstItems.push_front({nKey, pGlyph});
+    m_mapItems[nKey] = m_lstItems.begin();
+    m_nBytes += GetGlyphBytes(*pGlyph);
+
+    /* keep at least the new one */
+    while (m_nBytes > OSD_GLYPH_CACHE_SIZE && m_lstItems.size() > 1) {
+        CACHE_ITEM_T &tLast = m_lstItems.back();
+        m_nBytes -= GetGlyphBytes(*tLast.pGlyph);
+        m_mapItems.erase(tLast.nKey);
+        m_lstItems.pop_back();
+    }
+
+    return pGlyph;
+}
+
+std::shared_ptr<OSD_GLYPH_T> COSDGlyphCache::Rasterize(AX_U16 nUnicode, AX_U16 nScale, AX_BOOL bBrushSide, AX_U16 nFontColor,
+                                                       AX_U16 nSideColor) {
+    FONT_BITMAP_T tBitmap;
+    if (0 != GetFontBitmap(nUnicode, tBitmap) || !tBitmap.pBuffer) {
+        return nullptr;
+    }
+
+    std::shared_ptr<OSD_GLYPH_T> pGlyph = std::make_shared<OSD_GLYPH_T>();
+    OSD_GLYPH_T &tGlyph = *pGlyph;
+    tGlyph.nWidth = tBitmap.nWidth * nScale;
+    tGlyph.nHeight = tBitmap.nHeight * nScale;
+    tGlyph.nMargin = bBrushSide ? 1 : 0;
+    tGlyph.nStride = tGlyph.nWidth + 2 * tGlyph.nMargin;
+    tGlyph.nMaskWords = (tGlyph.nStride + 63) / 64;
+
+    AX_U32 nRows = tGlyph.nHeight + 2 * tGlyph.nMargin;
+    AX_U32 nWords = tGlyph.nMaskWords;
+    tGlyph.vecArgb.assign(tGlyph.nStride * nRows, 0);
+    tGlyph.vecType.assign(tGlyph.nStride * nRows, OSD_GLYPH_PIXEL_NONE);
+    tGlyph.vecFontMask.assign(nWords * nRows, 0);
+
+    /* runs of font bits are scaled into mask ranges, then the row is repeated nScale times */
+    AX_U16 nWByte = tBitmap.nWidth / 8;
+    for (AX_U16 j = 0; j < tBitmap.nHeight; j++) {
+        AX_U64 *pMask = &tGlyph.vecFontMask[(tGlyph.nMargin + j * nScale) * nWords];
+        const AX_U8 *pSrc = tBitmap.pBuffer + j * nWByte;
+        for (AX_U16 i = 0; i < tBitmap.nWidth;) {
+            if (0 == (pSrc[i / 8] & (0x80 >> (i % 8)))) {
+                i = (0 == i % 8 && 0 == pSrc[i / 8]) ? i + 8 : i + 1;
+                continue;
+            }
+
+            AX_U16 nEnd = i + 1;
+            while (nEnd < tBitmap.nWidth && (pSrc[nEnd / 8] & (0x80 >> (nEnd % 8)))) {
+                nEnd++;
+            }
+
+            SetMaskRange(pMask, tGlyph.nMargin + i * nScale, tGlyph.nMargin + nEnd * nScale);
+            i = nEnd;
+        }
+
+        for (AX_U16 hScale = 1; hScale < nScale; hScale++) {
+            memcpy(pMask + hScale * nWords, pMask, nWords * sizeof(AX_U64));
+        }
+    }
+
+    for (AX_U32 y = 0; y < nRows; y++) {
+        AX_U16 *pArgb = &tGlyph.vecArgb[y * tGlyph.nStride];
+        AX_U8 *pType = &tGlyph.vecType[y * tGlyph.nStride];
+        ForEachMaskRun(&tGlyph.vecFontMask[y * nWords], nWords, [&](AX_U32 nStart, AX_U32 nEnd) {
+            std::fill(pArgb + nStart, pArgb + nEnd, nFontColor);
+            memset(pType + nStart, OSD_GLYPH_PIXEL_FONT, nEnd - nStart);
+        });
+    }
+
+    if (bBrushSide) {
+        /* 8-neighbours of font pixels: OR of rows above and below, then shifted left and right by one pixel, font pixels win */
+        std::vector<AX_U64> vecRows(nWords);
+        std::vector<AX_U64> vecSide(nWords);
+        for (AX_U32 y = 0; y < nRows; y++) {
+            const AX_U64 *pFont = &tGlyph.vecFontMask[y * nWords];
+            const AX_U64 *pAbove = (y > 0) ? pFont - nWords : pFont;
+            const AX_U64 *pBelow = (y + 1 < nRows) ? pFont + nWords : pFont;
+            for (AX_U32 w = 0; w < nWords; w++) {
+                vecRows[w] = pAbove[w] | pFont[w] | pBelow[w];
+            }
+
+            for (AX_U32 w = 0; w < nWords; w++) {
+                AX_U64 nLeft = (vecRows[w] << 1) | ((w > 0) ? (vecRows[w - 1] >> 63) : 0);
+                AX_U64 nRight = (vecRows[w] >> 1) | ((w + 1 < nWords) ? (vecRows[w + 1] << 63) : 0);
+                vecSide[w] = (vecRows[w] | nLeft | nRight) & ~pFont[w];
+            }
+
+            AX_U16 *pArgb = &tGlyph.vecArgb[y * tGlyph.nStride];
+            AX_U8 *pType = &tGlyph.vecType[y * tGlyph.nStride];
+            ForEachMaskRun(vecSide.data(), nWords, [&](AX_U32 nStart, AX_U32 nEnd) {
+                std::fill(pArgb + nStart, pArgb + nEnd, nSideColor);
+                memset(pType + nStart, OSD_GLYPH_PIXEL_SIDE, nEnd - nStart);
+            });
+        }
+    }
+
+    return pGlyph;
+}
+
+AX_VOID COSDGlyphCache::Blit(const OSD_GLYPH_T &tGlyph, AX_U16 *pArgbBuffer, AX_U32 nWidth, AX_U32 nHeight, AX_S32 x, AX_S32 y,
+                             AX_U16 nBgColor) {
+    AX_S32 nLeft = x - tGlyph.nMargin;
+    AX_S32 nTop = y - tGlyph.nMargin;
+    AX_S32 nRows = tGlyph.nHeight + 2 * tGlyph.nMargin;
+
+    AX_S32 nX0 = (nLeft < 0) ? -nLeft : 0;
+    AX_S32 nY0 = (nTop < 0) ? -nTop : 0;
+    AX_S32 nX1 = ((AX_S32)nWidth - nLeft < (AX_S32)tGlyph.nStride) ? (AX_S32)nWidth - nLeft : (AX_S32)tGlyph.nStride;
+    AX_S32 nY1 = ((AX_S32)nHeight - nTop < nRows) ? (AX_S32)nHeight - nTop : nRows;
+
+    for (AX_S32 j = nY0; j < nY1; j++) {
+        const AX_U16 *pSrc = &tGlyph.vecArgb[j * tGlyph.nStride];
+        const AX_U8 *pType = &tGlyph.vecType[j * tGlyph.nStride];
+        AX_U16 *pDst = pArgbBuffer + (nTop + j) * nWidth + nLeft;
+        AX_S32 i = nX0;
+
+        /* 8 pixels a time: select glyph where font, or side on background */
+#if defined(__ARM_NEON)
+        uint16x8_t vBg = vdupq_n_u16(nBgColor);
+        for (; i + 8 <= nX1; i += 8) {
+            uint8x8_t vType = vld1_u8(pType + i);
+            uint16x8_t vFont = vreinterpretq_u16_s16(vmovl_s8(vreinterpret_s8_u8(vceq_u8(vType, vdup_n_u8(OSD_GLYPH_PIXEL_FONT)))));
+            uint16x8_t vSide = vreinterpretq_u16_s16(vmovl_s8(vreinterpret_s8_u8(vceq_u8(vType, vdup_n_u8(OSD_GLYPH_PIXEL_SIDE)))));
+            uint16x8_t vDst = vld1q_u16(pDst + i);
+            uint16x8_t vSel = vorrq_u16(vFont, vandq_u16(vSide, vceqq_u16(vDst, vBg)));
+            vst1q_u16(pDst + i, vbslq_u16(vSel, vld1q_u16(pSrc + i), vDst));
+        }
+#elif defined(__SSE2__)
+        __m128i vBg = _mm_set1_epi16((short)nBgColor);
+        for (; i + 8 <= nX1; i += 8) {
+            __m128i vType = _mm_loadl_epi64((const __m128i *)(pType + i));
+            __m128i vFont = _mm_cmpeq_epi8(vType, _mm_set1_epi8(OSD_GLYPH_PIXEL_FONT));
+            __m128i vSide = _mm_cmpeq_epi8(vType, _mm_set1_epi8(OSD_GLYPH_PIXEL_SIDE));
+            __m128i vDst = _mm_loadu_si128((const __m128i *)(pDst + i));
+            __m128i vSel = _mm_or_si128(_mm_unpacklo_epi8(vFont, vFont),
+                                        _mm_and_si128(_mm_unpacklo_epi8(vSide, vSide), _mm_cmpeq_epi16(vDst, vBg)));
+            __m128i vSrc = _mm_loadu_si128((const __m128i *)(pSrc + i));
+            _mm_storeu_si128((__m128i *)(pDst + i), _mm_or_si128(_mm_and_si128(vSel, vSrc), _mm_andnot_si128(vSel, vDst)));
+        }
+#endif
+        for (; i < nX1; i++) {
+            if (OSD_GLYPH_PIXEL_FONT == pType[i] || (OSD_GLYPH_PIXEL_SIDE == pType[i] && nBgColor == pDst[i])) {
+                pDst[i] = pSrc[i];
+            }
+        }
+    }
+}
+
+AX_VOID COSDGlyphCache::BlitBitmap(const OSD_GLYPH_T &tGlyph, AX_U8 *pBitmapBuffer, AX_U32 nWidth, AX_U32 nHeight, AX_S32 x, AX_S32 y) {
+    AX_S32 nX0 = (x < 0) ? -x : 0;
+    AX_S32 nY0 = (y < 0) ? -y : 0;
+    AX_S32 nX1 = ((AX_S32)nWidth - x < (AX_S32)tGlyph.nWidth) ? (AX_S32)nWidth - x : (AX_S32)tGlyph.nWidth;
+    AX_S32 nY1 = ((AX_S32)nHeight - y < (AX_S32)tGlyph.nHeight) ? (AX_S32)nHeight - y : (AX_S32)tGlyph.nHeight;
+    if (nX0 >= nX1) {
+        return;
+    }
+
+    /* runs of the font mask are set as bit ranges, whole bytes at once */
+    AX_S32 nMargin = tGlyph.nMargin;
+    for (AX_S32 j = nY0; j < nY1; j++) {
+        const AX_U64 *pMask = &tGlyph.vecFontMask[(j + nMargin) * tGlyph.nMaskWords];
+        AX_U32 nPos = (y + j) * nWidth + x;
+        ForEachMaskRun(pMask, tGlyph.nMaskWords, [&](AX_U32 nStart, AX_U32 nEnd) {
+            AX_S32 nRunStart = std::max((AX_S32)nStart - nMargin, nX0);
+            AX_S32 nRunEnd = std::min((AX_S32)nEnd - nMargin, nX1);
+            if (nRunStart < nRunEnd) {
+                SetBitmapRange(pBitmapBuffer, nPos + nRunStart, nPos + nRunEnd);
+            }
+        });
+    }
+}
@@ -0,0 +1,78 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "AXSingleton.h"
+#include "ax_base_type.h"
+
+/* total bytes of cached glyphs, 16x16 glyph at scale 4 with side costs about 13KB */
+#define OSD_GLYPH_CACHE_SIZE (2 * 1024 * 1024)
+
+typedef enum {
+    OSD_GLYPH_PIXEL_NONE = 0,
+    OSD_GLYPH_PIXEL_SIDE = 1, /* drawn only on background, same as COSDHandler::BrushSide */
+    OSD_GLYPH_PIXEL_FONT = 2,
+} OSD_GLYPH_PIXEL_E;
+
+/* scaled ARGB1555 glyph, side pixels take a margin of 1 pixel around the font cell */
+typedef struct {
+    AX_U16 nWidth;   /* advance without side margin */
+    AX_U16 nHeight;  /* without side margin */
+    AX_U16 nMargin;  /* 1 with side, else 0 */
+    AX_U16 nStride;  /* nWidth + 2 * nMargin */
+    std::vector<AX_U16> vecArgb;
+    std::vector<AX_U8> vecType; /* OSD_GLYPH_PIXEL_E */
+    AX_U16 nMaskWords;               /* 64-bit words of one mask row, covering nStride */
+    std::vector<AX_U64> vecFontMask; /* font pixels packed by row, bit i of word w is pixel w * 64 + i */
+} OSD_GLYPH_T;
+
+/**
+ * @brief LRU cache of rasterised glyphs keyed by (unicode, scale, side, font color, side color).
+ *
+ * Shared by all COSDHandler instances, so channel name and custom text of every stream rasterise each glyph once.
+ * Returned glyphs stay valid while referenced even if evicted.
+ */
+class COSDGlyphCache final : public CAXSingleton<COSDGlyphCache> {
+    friend class CAXSingleton<COSDGlyphCache>;
+
+public:
+    std::shared_ptr<const OSD_GLYPH_T> Get(AX_U16 nUnicode, AX_U16 nScale, AX_BOOL bBrushSide, AX_U16 nFontColor, AX_U16 nSideColor);
+
+    /* draw glyph at (x, y) of font cell, pixels out of buffer are clipped */
+    static AX_VOID Blit(const OSD_GLYPH_T &tGlyph, AX_U16 *pArgbBuffer, AX_U32 nWidth, AX_U32 nHeight, AX_S32 x, AX_S32 y,
+                        AX_U16 nBgColor);
+    /* set bits of font pixels in 1bpp bitmap with COSDHandler::GenBitmap bit order, side pixels are ignored */
+    static AX_VOID BlitBitmap(const OSD_GLYPH_T &tGlyph, AX_U8 *pBitmapBuffer, AX_U32 nWidth, AX_U32 nHeight, AX_S32 x, AX_S32 y);
+
+private:
+    COSDGlyphCache(AX_VOID) noexcept = default;
+    virtual ~COSDGlyphCache(AX_VOID) = default;
+
+    static std::shared_ptr<OSD_GLYPH_T> Rasterize(AX_U16 nUnicode, AX_U16 nScale, AX_BOOL bBrushSide, AX_U16 nFontColor,
+                                                  AX_U16 nSideColor);
+
+private:
+    typedef struct {
+        AX_U64 nKey;
+        std::shared_ptr<const OSD_GLYPH_T> pGlyph;
+    } CACHE_ITEM_T;
+
+    /* front is the most recently used */
+    std::list<CACHE_ITEM_T> m_lstItems;
+    std::unordered_map<AX_U64, std::list<CACHE_ITEM_T>::iterator> m_mapItems;
+    AX_U32 m_nBytes{0};
+    std::mutex m_mtx;
+};
@@ -9,6 +9,9 @@
  **************************************************************************************************/
 
 #include "OSDHandler.h"
+#ifndef FONT_USE_FREETYPE
+#include "OSDGlyphCache.h"
+#endif
 
 COSDHandler::COSDHandler() {
 }
@@ -28,7 +31,6 @@ AX_VOID *COSDHandler::GenARGB(wchar_t *pStr, AX_U16 *pArgbBuffer, AX_U32 u32OSDW
     AX_U16 u16SideColor = 0x0;
     AX_U8 uColor_H = 0x0;
     AX_U8 uColor_L = 0x0;
-    AX_U8 dot8 = 0x0;
 
     AX_U16 uLen = 0;
 
@@ -80,6 +82,7 @@ AX_VOID *COSDHandler::GenARGB(wchar_t *pStr, AX_U16 *pArgbBuffer, AX_U32 u32OSDW
     }
 
 #ifdef FONT_USE_FREETYPE
+    AX_U8 dot8 = 0x0;
     AX_S32 s32Error = FT_Set_Pixel_Sizes(m_fontFace, uFontSize, uFontSize);
     if (0 != s32Error) {
         printf("FT Set Size error!\r\n");
@@ -174,48 +177,27 @@ AX_VOID *COSDHandler::GenARGB(wchar_t *pStr, AX_U16 *pArgbBuffer, AX_U32 u32OSDW
     }
 
 #else
-    FONT_BITMAP_T bitmap;
-
     AX_U16 nScale = (uFontSize + 15) / 16;
 
+    /* BrushSide never matched a background with alpha bit set, keep that */
+    AX_BOOL bSide = (bIsBrushSide && !(u16BgColor & 0x8000)) ? AX_TRUE : AX_FALSE;
+    COSDGlyphCache *pCache = COSDGlyphCache::GetInstance();
+
     switch (enAlign) {
         case OSD_ALIGN_TYPE_LEFT_TOP:
         case OSD_ALIGN_TYPE_LEFT_BOTTOM: {
             int x0 = x;
-            int y0 = y;
-            AX_BOOL bExit = AX_FALSE;
             for (AX_U16 i = 0; i < uLen; i++) {
-                if (bExit) {
-                    break;
+                std::shared_ptr<const OSD_GLYPH_T> pGlyph = pCache->Get((AX_U16)(pTextStr[i]), nScale, bSide, u16FontColor, u16SideColor);
+                if (!pGlyph) {
+                    continue;
                 }
-                GetFontBitmap((AX_U16)(pTextStr[i]), bitmap);
-                AX_U16 nWByte = bitmap.nWidth / 8;
-                for (AX_U16 j = 0; j < bitmap.nHeight; j++) {
-                    for (AX_U16 k = 0; k < nWByte; k++) {
-                        dot8 = bitmap.pBuffer[k + j * nWByte];
-                        for (AX_U16 dot = 0; dot < 8; dot++) {
-                            if ((dot8 & 0x80) == 0x80) {
-                                for (AX_U16 hScale = 0; hScale < nScale; hScale++) {
-                                    for (AX_U16 wScale = 0; wScale < nScale; wScale++) {
-                                        if (bIsBrushSide) {
-                                            BrushSide(pArgbBuffer, x0 + (k * 8 + dot) * nScale + wScale, y0 + j * nScale + hScale,
-                                                      u16SideColor, u16BgColor, u32OSDWidth, u32OSDHeight);
-                                        }
-                                        if (OE_WIDTH_BACKWARD_RANGE == DrawPoint(pArgbBuffer, x0 + (k * 8 + dot) * nScale + wScale,
-                                                                                 y0 + j * nScale + hScale, u16FontColor, u32OSDWidth,
-                                                                                 u32OSDHeight)) {
-                                            if (!bExit) {
-                                                bExit = AX_TRUE;
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                            dot8 = dot8 << 1;
-                        }
-                    }
+
+                COSDGlyphCache::Blit(*pGlyph, pArgbBuffer, u32OSDWidth, u32OSDHeight, x0, y, u16BgColor);
+                x0 += pGlyph->nWidth;
+                if (x0 >= (int)u32OSDWidth) {
+                    break;
                 }
-                x0 += bitmap.nWidth * nScale;
             }
             break;
         }
@@ -225,39 +207,16 @@ AX_VOID *COSDHandler::GenARGB(wchar_t *pStr, AX_U16 *pArgbBuffer, AX_U32 u32OSDW
             if (x0 < 0) {
                 return nullptr;
             }
-            int y0 = y;
-            AX_BOOL bExit = AX_FALSE;
             for (AX_S16 i = uLen - 1; i >= 0; i--) {
-                if (bExit) {
-                    break;
+                std::shared_ptr<const OSD_GLYPH_T> pGlyph = pCache->Get((AX_U16)(pTextStr[i]), nScale, bSide, u16FontColor, u16SideColor);
+                if (!pGlyph) {
+                    continue;
                 }
-                GetFontBitmap((AX_U16)(pTextStr[i]), bitmap);
-                AX_U16 nWByte = bitmap.nWidth / 8;
-                x0 -= bitmap.nWidth * nScale;
-                for (AX_U16 j = 0; j < bitmap.nHeight; j++) {
-                    for (AX_S16 k = 0; k < nWByte; k++) {
-                        dot8 = bitmap.pBuffer[k + j * nWByte];
-                        for (AX_U16 dot = 0; dot < 8; dot++) {
-                            if ((dot8 & 0x80) == 0x80) {
-                                for (AX_U16 hScale = 0; hScale < nScale; hScale++) {
-                                    for (AX_U16 wScale = 0; wScale < nScale; wScale++) {
-                                        if (bIsBrushSide) {
-                                            BrushSide(pArgbBuffer, x0 + (k * 8 + dot) * nScale + wScale, y0 + j * nScale + hScale,
-                                                      u16SideColor, u16BgColor, u32OSDWidth, u32OSDHeight);
-                                        }
-                                        if (OE_WIDTH_BACKWARD_RANGE == DrawPoint(pArgbBuffer, x0 + (k * 8 + dot) * nScale + wScale,
-                                                                                 y0 + j * nScale + hScale, u16FontColor, u32OSDWidth,
-                                                                                 u32OSDHeight)) {
-                                            if (!bExit) {
-                                                bExit = AX_TRUE;
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                            dot8 = dot8 << 1;
-                        }
-                    }
+
+                x0 -= pGlyph->nWidth;
+                COSDGlyphCache::Blit(*pGlyph, pArgbBuffer, u32OSDWidth, u32OSDHeight, x0, y, u16BgColor);
+                if (x0 < 0) {
+                    break;
                 }
             }
             break;
@@ -91,6 +91,8 @@ public:
 
     AX_S32 CalcStrSize(wchar_t *pTextStr, AX_U16 uFontSize, AX_U32 &u32OSDWidth, AX_U32 &u32OSDHeight);
 
+    static AX_U16 ConvertColor2Argb1555(AX_U32 &uColor);
+
 private:
     AX_BOOL DeinitOSDHandler(AX_VOID);
 
@@ -99,8 +101,6 @@ private:
     OSD_ERROR BrushSide(AX_U16 *pDataBuffer, AX_S16 x, AX_S16 y, AX_U16 uSideColor, AX_S16 uBgColor, AX_U32 u32OSDWidth,
                         AX_U32 u32OSDHeight);
 
-    AX_U16 ConvertColor2Argb1555(AX_U32 &uColor);
-
 #ifdef FONT_USE_FREETYPE
     FT_Bitmap *FTGetGlpyhBitMap(AX_U16 u16CharCode);
 
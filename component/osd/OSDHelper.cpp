@@ -10,6 +10,7 @@
 
 #include "OSDHelper.h"
 #include <sys/prctl.h>
+#include <sys/time.h>
 #include <chrono>
 #include <map>
 #include "AXFrame.hpp"
@@ -20,6 +21,7 @@
 #include "ElapsedTimer.hpp"
 #include "GlobalDef.h"
 #include "IvpsOptionHelper.h"
+#include "OSDScheduler.h"
 #include "OptionHelper.h"
 #include "OsdOptionHelper.h"
 #include "SensorOptionHelper.h"
@@ -39,6 +41,11 @@ AX_BOOL COSDHelper::StartOSD(CIVPSGrpStage* pIvpsInstance) {
     AX_U8 nRgnIndex = 0;
     IVPS_GRP_T* pGrpAttr = m_pIvpsGrpInstance->GetGrpPPLAttr();
 
+    if (!COSDScheduler::GetInstance()->Start()) {
+        LOG_MM_E(OSD, "Start OSD scheduler failed.");
+        return AX_FALSE;
+    }
+
     for (AX_U32 nChn = 0; nChn < pGrpConfig->nGrpChnNum; nChn++) {
         AX_U8 nChnFilter = nChn + 1;
         if (AX_TRUE != pGrpAttr->tPipelineAttr.tFilter[nChnFilter][APP_OSD_CHANNEL_FILTER_1].bEngage) {
@@ -85,9 +92,14 @@ AX_BOOL COSDHelper::StartOSD(CIVPSGrpStage* pIvpsInstance) {
     }
     m_nRgnCount = nRgnIndex;
 
-    AX_CHAR threadName[32];
-    sprintf(threadName, "APP_RGN_UPDATE%d_%d", pGrpConfig->nSnsSrc, pGrpConfig->nGrp);
-    m_updateThread.Start(std::bind(&COSDHelper::PerformUpdateOSD, this), nullptr, threadName);
+    AX_CHAR taskName[32];
+    sprintf(taskName, "APP_RGN_UPDATE%d_%d", pGrpConfig->nSnsSrc, pGrpConfig->nGrp);
+    m_nUpdateTaskID = COSDScheduler::GetInstance()->AddTask(
+        taskName, 0, [this]() -> AX_U32 {
+            PerformUpdateOSD();
+            return OSD_SCHED_STOP;
+        },
+        AX_FALSE);
 
     return AX_TRUE;
 }
@@ -96,15 +108,34 @@ AX_BOOL COSDHelper::UpdateOSD(OSD_REGION_PARAM_T* pThreadParam) {
     if (nullptr == pThreadParam) {
         return AX_FALSE;
     }
-    AX_CHAR threadName[32];
+    AX_CHAR taskName[32];
     switch (pThreadParam->tOsdCfg.eType) {
         case OSD_TYPE_TIME: {
-            sprintf(threadName, "APP_RGN_TIME%d_%d", pThreadParam->nGroup, pThreadParam->nChn);
-            if (!pThreadParam->m_EventThread.Start(std::bind(&COSDHelper::TimeThreadFunc, this, pThreadParam), nullptr, threadName)) {
-                LOG_MM_E(OSD, "start RgnThreadFunc  failed!");
-                AX_IVPS_RGN_Destroy(pThreadParam->hRgn);
+            if (-1 != pThreadParam->nTaskID) {
+                COSDScheduler::GetInstance()->Trigger(pThreadParam->nTaskID);
+                break;
+            }
+
+            pThreadParam->pTimeHandler = m_osdWrapper.NewInstance();
+            if (nullptr == pThreadParam->pTimeHandler) {
+                LOG_MM_E(OSD, "Get osd handle failed.");
+                break;
+            }
+
+            static AX_CHAR strTtfFile[128] = {0};
+            sprintf(strTtfFile, "%s/GB2312.ttf", GetResPath().c_str());
+            if (AX_FALSE == m_osdWrapper.InitHandler(pThreadParam->pTimeHandler, strTtfFile)) {
+                LOG_MM_E(OSD, "AX_OSDInitHandler failed, ttf: %s.", strTtfFile);
+                m_osdWrapper.ReleaseInstance(&pThreadParam->pTimeHandler);
                 break;
             }
+
+            /* time task decides its next run by wall clock */
+            pThreadParam->tTimeRender.Reset();
+            pThreadParam->bLastDisp = AX_FALSE;
+            sprintf(taskName, "APP_RGN_TIME%d_%d", pThreadParam->nGroup, pThreadParam->nChn);
+            pThreadParam->nTaskID =
+                COSDScheduler::GetInstance()->AddTask(taskName, 0, std::bind(&COSDHelper::TimeTask, this, pThreadParam));
             break;
         };
         case OSD_TYPE_PICTURE: {
@@ -121,12 +152,14 @@ AX_BOOL COSDHelper::UpdateOSD(OSD_REGION_PARAM_T* pThreadParam) {
             break;
         };
         case OSD_TYPE_RECT: {
-            sprintf(threadName, "APP_RGN_RECT%d_%d", pThreadParam->nGroup, pThreadParam->nChn);
-            if (!pThreadParam->m_EventThread.Start(std::bind(&COSDHelper::RectThreadFunc, this, pThreadParam), nullptr, threadName)) {
-                LOG_MM_E(OSD, "start RgnThreadFunc  failed!");
-                AX_IVPS_RGN_Destroy(pThreadParam->hRgn);
+            if (-1 != pThreadParam->nTaskID) {
                 break;
             }
+
+            pThreadParam->nLastRectNum = (AX_U32)-1;
+            sprintf(taskName, "APP_RGN_RECT%d_%d", pThreadParam->nGroup, pThreadParam->nChn);
+            pThreadParam->nTaskID = COSDScheduler::GetInstance()->AddTask(taskName, APP_OSD_RECT_INTERVAL,
+                                                                          std::bind(&COSDHelper::RectTask, this, pThreadParam));
             break;
         }
         default: {
@@ -138,245 +171,205 @@ AX_BOOL COSDHelper::UpdateOSD(OSD_REGION_PARAM_T* pThreadParam) {
     return AX_TRUE;
 }
 
-AX_VOID COSDHelper::TimeThreadFunc(OSD_REGION_PARAM_T* pThreadParam) {
+AX_U32 COSDHelper::TimeTask(OSD_REGION_PARAM_T* pThreadParam) {
     AX_U32 nIvpsChn = pThreadParam->nChn;
-    while (!pThreadParam->bExit) {
-        if (!m_pIvpsGrpInstance->GetChannelState(pThreadParam->nChn)) {
-            for (int i = 0; i < 25 && !pThreadParam->bExit; i++) {
-                CElapsedTimer::mSleep(20);
-            }
-            continue;
-        }
-
-        AX_IVPS_RGN_DISP_GROUP_T tDisp;
-        AX_U16* pArgbData = nullptr;
-
-        memset(&tDisp, 0, sizeof(AX_IVPS_RGN_DISP_GROUP_T));
-        AX_U32 nRGB = pThreadParam->tOsdCfg.tTimeAttr.nColor;
+    if (!m_pIvpsGrpInstance->GetChannelState(pThreadParam->nChn)) {
+        /* region may be reset while channel is off, update it again once channel is on */
+        pThreadParam->tTimeRender.Reset();
+        pThreadParam->bLastDisp = AX_FALSE;
+        return APP_OSD_CHN_OFF_INTERVAL;
+    }
 
-        tDisp.nNum = 1;
-        tDisp.tChnAttr.nAlpha = 255;
-        tDisp.tChnAttr.nZindex = pThreadParam->tOsdCfg.nZIndex;
-        tDisp.tChnAttr.bSingleCanvas = AX_FALSE;
+    AX_IVPS_RGN_DISP_GROUP_T tDisp;
 
-        COSDHandler* pOsdHandle = m_osdWrapper.NewInstance();
-        if (nullptr == pOsdHandle) {
-            LOG_MM_E(OSD, "Get osd handle failed.");
-            break;
-        }
+    memset(&tDisp, 0, sizeof(AX_IVPS_RGN_DISP_GROUP_T));
+    AX_U32 nRGB = pThreadParam->tOsdCfg.tTimeAttr.nColor;
 
-        static AX_CHAR strTtfFile[128] = {0};
-        sprintf(strTtfFile, "%s/GB2312.ttf", GetResPath().c_str());
+    tDisp.nNum = 1;
+    tDisp.tChnAttr.nAlpha = 255;
+    tDisp.tChnAttr.nZindex = pThreadParam->tOsdCfg.nZIndex;
+    tDisp.tChnAttr.bSingleCanvas = AX_FALSE;
 
-        if (AX_FALSE == m_osdWrapper.InitHandler(pOsdHandle, strTtfFile)) {
-            LOG_MM_E(OSD, "AX_OSDInitHandler failed, ttf: %s.", strTtfFile);
-            m_osdWrapper.ReleaseInstance(&pOsdHandle);
-            break;
-        }
-        wchar_t wszOsdDate[MAX_OSD_TIME_CHAR_LEN] = {0};
+    wchar_t wszOsdDate[MAX_OSD_TIME_CHAR_LEN] = {0};
 
-        memset(&wszOsdDate[0], 0, sizeof(wchar_t) * MAX_OSD_TIME_CHAR_LEN);
+    memset(&wszOsdDate[0], 0, sizeof(wchar_t) * MAX_OSD_TIME_CHAR_LEN);
 
-        AX_S32 nCharLen = 0;
-        if (nullptr == CElapsedTimer::GetCurrDateStr(&wszOsdDate[0], pThreadParam->tOsdCfg.tTimeAttr.eFormat, nCharLen)) {
-            LOG_MM_E(OSD, "Failed to get current date string.");
-            m_osdWrapper.ReleaseInstance(&pOsdHandle);
-            break;
-        }
+    AX_S32 nCharLen = 0;
+    if (nullptr == CElapsedTimer::GetCurrDateStr(&wszOsdDate[0], pThreadParam->tOsdCfg.tTimeAttr.eFormat, nCharLen)) {
+        LOG_MM_E(OSD, "Failed to get current date string.");
+        return OSD_SCHED_STOP;
+    }
 
-        AX_U8 nIvpsGrp = m_pIvpsGrpInstance->GetGrpCfg()->nGrp;
+    AX_U8 nIvpsGrp = m_pIvpsGrpInstance->GetGrpCfg()->nGrp;
 
 #ifdef SWITCH_SENSOR_SUPPORT
-        AX_S32 nScenario = 0;
-        if (!CCmdLineParser::GetInstance()->GetScenario(nScenario)) {
-            LOG_M_W(OSD, "Load default scenario %d", nScenario);
-        }
-        if (nScenario == E_APP_SCENARIO_TRIPLE_SENSOR_SWITCH_SINGLE_PIPE) {
-            AX_U8 nSnsId = nIvpsGrp;
-            WEB_CAMERA_ATTR_T tCamera = CWebOptionHelper::GetInstance()->GetCamera(nSnsId);
-            nCharLen += swprintf(&wszOsdDate[nCharLen], (MAX_OSD_TIME_CHAR_LEN - nCharLen)*2, L" %.1fX", tCamera.tEZoomAttr.fEZoomRatio);
-        }
+    AX_S32 nScenario = 0;
+    if (!CCmdLineParser::GetInstance()->GetScenario(nScenario)) {
+        LOG_M_W(OSD, "Load default scenario %d", nScenario);
+    }
+    if (nScenario == E_APP_SCENARIO_TRIPLE_SENSOR_SWITCH_SINGLE_PIPE) {
+        AX_U8 nSnsId = nIvpsGrp;
+        WEB_CAMERA_ATTR_T tCamera = CWebOptionHelper::GetInstance()->GetCamera(nSnsId);
+        nCharLen += swprintf(&wszOsdDate[nCharLen], (MAX_OSD_TIME_CHAR_LEN - nCharLen)*2, L" %.1fX", tCamera.tEZoomAttr.fEZoomRatio);
+    }
 #endif
 
-        AX_U32 nSrcWidth = m_pIvpsGrpInstance->GetGrpPPLAttr()->tPipelineAttr.tFilter[nIvpsChn + 1][APP_OSD_CHANNEL_FILTER_1].nDstPicWidth;
-        AX_U32 nSrcHeight =
-            m_pIvpsGrpInstance->GetGrpPPLAttr()->tPipelineAttr.tFilter[nIvpsChn + 1][APP_OSD_CHANNEL_FILTER_1].nDstPicHeight;
-        AX_U32 nSrcOffset = 0;
-        AX_U8 nRotation = AX_IVPS_ROTATION_0;
-        AX_U8 nMirror = 0;
-        if (AX_IVPS_ROTATION_90 == nRotation || AX_IVPS_ROTATION_270 == nRotation) {
-            ::std::swap(nSrcWidth, nSrcHeight);
-        }
-
-        if (nMirror || AX_IVPS_ROTATION_180 == nRotation) {
-            nSrcOffset = ALIGN_UP(nSrcWidth, ROTATION_WIDTH_ALIGEMENT) - nSrcHeight;
-        }
-
-        AX_U32 nFontSize = COSDStyle::GetInstance()->GetTimeFontSize(nSrcWidth, nSrcHeight);
-        nFontSize = ALIGN_UP(nFontSize, BASE_FONT_SIZE);
-
-        AX_U32 nMarginX = pThreadParam->tOsdCfg.nBoundaryX;
-        AX_U32 nMarginY = pThreadParam->tOsdCfg.nBoundaryY;
+    AX_U32 nSrcWidth = m_pIvpsGrpInstance->GetGrpPPLAttr()->tPipelineAttr.tFilter[nIvpsChn + 1][APP_OSD_CHANNEL_FILTER_1].nDstPicWidth;
+    AX_U32 nSrcHeight =
+        m_pIvpsGrpInstance->GetGrpPPLAttr()->tPipelineAttr.tFilter[nIvpsChn + 1][APP_OSD_CHANNEL_FILTER_1].nDstPicHeight;
+    AX_U32 nSrcOffset = 0;
+    AX_U8 nRotation = AX_IVPS_ROTATION_0;
+    AX_U8 nMirror = 0;
+    if (AX_IVPS_ROTATION_90 == nRotation || AX_IVPS_ROTATION_270 == nRotation) {
+        ::std::swap(nSrcWidth, nSrcHeight);
+    }
 
-        OSD_ALIGN_TYPE_E eAlign = pThreadParam->tOsdCfg.eAlign;
-        AX_U32 nPicOffset = nMarginX % OSD_ALIGN_WIDTH;
-        AX_U32 nPicOffsetBlock = nMarginX / OSD_ALIGN_WIDTH;
+    if (nMirror || AX_IVPS_ROTATION_180 == nRotation) {
+        nSrcOffset = ALIGN_UP(nSrcWidth, ROTATION_WIDTH_ALIGEMENT) - nSrcHeight;
+    }
 
-        AX_U32 nPixWidth = ALIGN_UP(nFontSize / 2 * nCharLen, BASE_FONT_SIZE);
-        AX_U32 nPixHeight = ALIGN_UP(nFontSize, OSD_ALIGN_HEIGHT);
-        m_osdWrapper.CalcStrSize(pOsdHandle, wszOsdDate, nFontSize, nPixWidth, nPixHeight);
+    AX_U32 nFontSize = COSDStyle::GetInstance()->GetTimeFontSize(nSrcWidth, nSrcHeight);
+    nFontSize = ALIGN_UP(nFontSize, BASE_FONT_SIZE);
 
-        nPixWidth = ALIGN_UP(nPixWidth + nPicOffset, 8);
-        AX_U32 nPicSize = nPixWidth * nPixHeight * 2;
-        AX_U32 nFontColor = nRGB;
-        nFontColor |= (1 << 24);
-        AX_U32 nOffsetX = nSrcOffset + CCommonUtils::OverlayOffsetX(
-                                           nSrcWidth, nPixWidth, (nPicOffset > 0 ? nPicOffsetBlock * OSD_ALIGN_WIDTH : nMarginX), eAlign);
-        AX_U32 nOffsetY = CCommonUtils::OverlayOffsetY(nSrcHeight, nPixHeight, nMarginY, eAlign);
-        LOG_MM_D(OSD, "PixWidth:%d, nPixHeight:%d, nOffsetX:%d, nOffsetY:%d, nCharLen:%d", nPixWidth, nPixHeight, nOffsetX, nOffsetY,
-                 nCharLen);
+    AX_U32 nMarginX = pThreadParam->tOsdCfg.nBoundaryX;
+    AX_U32 nMarginY = pThreadParam->tOsdCfg.nBoundaryY;
 
-        tDisp.arrDisp[0].eType = AX_IVPS_RGN_TYPE_OSD;
-        tDisp.arrDisp[0].bShow = pThreadParam->tOsdCfg.bEnable;
-        tDisp.arrDisp[0].uDisp.tOSD.u16Alpha = (AX_F32)(nRGB >> 24) / 0xFF * 1024;
-        tDisp.arrDisp[0].uDisp.tOSD.u32BmpHeight = nPixHeight;
-        tDisp.arrDisp[0].uDisp.tOSD.u32BmpWidth = nPixWidth;
+    OSD_ALIGN_TYPE_E eAlign = pThreadParam->tOsdCfg.eAlign;
+    AX_U32 nPicOffset = nMarginX % OSD_ALIGN_WIDTH;
+    AX_U32 nPicOffsetBlock = nMarginX / OSD_ALIGN_WIDTH;
 
-        tDisp.arrDisp[0].uDisp.tOSD.u64PhyAddr = 0;
-        if (pThreadParam->tOsdCfg.tTimeAttr.bInvEnable) {
-            /* Bitmap */
-            nPicSize /= 8;
-            pArgbData = (AX_U16*)AX_MALLOC(nPicSize);
-            memset(pArgbData, 0x0, nPicSize);
+    AX_U32 nPixWidth = ALIGN_UP(nFontSize / 2 * nCharLen, BASE_FONT_SIZE);
+    AX_U32 nPixHeight = ALIGN_UP(nFontSize, OSD_ALIGN_HEIGHT);
+    m_osdWrapper.CalcStrSize(pThreadParam->pTimeHandler, wszOsdDate, nFontSize, nPixWidth, nPixHeight);
 
-            if (nullptr == m_osdWrapper.GenBitmap(pOsdHandle, (wchar_t*)&wszOsdDate[0], (AX_U8*)pArgbData, nPixWidth, nPixHeight,
-                                                  nPicOffset, 0, nFontSize, eAlign)) {
-                LOG_MM_E(OSD, "Failed to generate bitmap for date string.");
-                m_osdWrapper.ReleaseInstance(&pOsdHandle);
-                if (pArgbData) {
-                    AX_FREE(pArgbData);
-                    pArgbData = nullptr;
-                }
-                break;
-            }
-            tDisp.tChnAttr.eFormat = AX_FORMAT_BITMAP;
-            tDisp.arrDisp[0].uDisp.tOSD.enRgbFormat = AX_FORMAT_BITMAP;
-            tDisp.tChnAttr.nBitColor.nColor = nRGB;
-            tDisp.tChnAttr.nBitColor.bColorInv = AX_TRUE;
-            tDisp.tChnAttr.nBitColor.nColorInv = pThreadParam->tOsdCfg.tTimeAttr.nColorInv;
-            tDisp.tChnAttr.nBitColor.nColorInvThr = 0x808080;
-            tDisp.arrDisp[0].uDisp.tOSD.u32DstXoffset = ALIGN_UP(nOffsetX, OSD_BMP_ALIGN_X_OFFSET);
-            tDisp.arrDisp[0].uDisp.tOSD.u32DstYoffset = ALIGN_UP(nOffsetY, OSD_BMP_ALIGN_Y_OFFSET);
-        } else {
-            /* ARGB1555 */
-            pArgbData = (AX_U16*)AX_MALLOC(nPicSize);
-            memset(pArgbData, 0x0, nPicSize);
+    nPixWidth = ALIGN_UP(nPixWidth + nPicOffset, 8);
+    AX_U32 nFontColor = nRGB;
+    nFontColor |= (1 << 24);
+    AX_U32 nOffsetX = nSrcOffset + CCommonUtils::OverlayOffsetX(
+                                       nSrcWidth, nPixWidth, (nPicOffset > 0 ? nPicOffsetBlock * OSD_ALIGN_WIDTH : nMarginX), eAlign);
+    AX_U32 nOffsetY = CCommonUtils::OverlayOffsetY(nSrcHeight, nPixHeight, nMarginY, eAlign);
+    LOG_MM_D(OSD, "PixWidth:%d, nPixHeight:%d, nOffsetX:%d, nOffsetY:%d, nCharLen:%d", nPixWidth, nPixHeight, nOffsetX, nOffsetY,
+             nCharLen);
 
-            if (nullptr == m_osdWrapper.GenARGB(pOsdHandle, (wchar_t*)&wszOsdDate[0], pArgbData, nPixWidth, nPixHeight, nPicOffset, 0,
-                                                nFontSize, AX_TRUE, nFontColor, 0xFFFFFF, 0xFF000000, eAlign)) {
-                LOG_MM_E(OSD, "Failed to generate bitmap for date string.");
-                m_osdWrapper.ReleaseInstance(&pOsdHandle);
-                if (pArgbData) {
-                    AX_FREE(pArgbData);
-                    pArgbData = nullptr;
-                }
-                break;
-            }
+    tDisp.arrDisp[0].eType = AX_IVPS_RGN_TYPE_OSD;
+    tDisp.arrDisp[0].bShow = pThreadParam->tOsdCfg.bEnable;
+    tDisp.arrDisp[0].uDisp.tOSD.u16Alpha = (AX_F32)(nRGB >> 24) / 0xFF * 1024;
+    tDisp.arrDisp[0].uDisp.tOSD.u32BmpHeight = nPixHeight;
+    tDisp.arrDisp[0].uDisp.tOSD.u32BmpWidth = nPixWidth;
+
+    tDisp.arrDisp[0].uDisp.tOSD.u64PhyAddr = 0;
+
+    OSD_TIME_LAYOUT_T tLayout;
+    tLayout.nWidth = nPixWidth;
+    tLayout.nHeight = nPixHeight;
+    tLayout.sX = nPicOffset;
+    tLayout.sY = 0;
+    tLayout.nFontSize = nFontSize;
+    tLayout.eAlign = eAlign;
+    if (pThreadParam->tOsdCfg.tTimeAttr.bInvEnable) {
+        /* Bitmap */
+        tLayout.bBitmap = AX_TRUE;
+        tDisp.tChnAttr.eFormat = AX_FORMAT_BITMAP;
+        tDisp.arrDisp[0].uDisp.tOSD.enRgbFormat = AX_FORMAT_BITMAP;
+        tDisp.tChnAttr.nBitColor.nColor = nRGB;
+        tDisp.tChnAttr.nBitColor.bColorInv = AX_TRUE;
+        tDisp.tChnAttr.nBitColor.nColorInv = pThreadParam->tOsdCfg.tTimeAttr.nColorInv;
+        tDisp.tChnAttr.nBitColor.nColorInvThr = 0x808080;
+        tDisp.arrDisp[0].uDisp.tOSD.u32DstXoffset = ALIGN_UP(nOffsetX, OSD_BMP_ALIGN_X_OFFSET);
+        tDisp.arrDisp[0].uDisp.tOSD.u32DstYoffset = ALIGN_UP(nOffsetY, OSD_BMP_ALIGN_Y_OFFSET);
+    } else {
+        /* ARGB1555 */
+        tLayout.bBitmap = AX_FALSE;
+        tLayout.bBrushSide = AX_TRUE;
+        tLayout.nFontColor = nFontColor;
+        tLayout.nBgColor = 0xFFFFFF;
+        tLayout.nSideColor = 0xFF000000;
+        tDisp.tChnAttr.eFormat = AX_FORMAT_ARGB1555;
+        tDisp.arrDisp[0].uDisp.tOSD.enRgbFormat = AX_FORMAT_ARGB1555;
+        tDisp.arrDisp[0].uDisp.tOSD.u32DstXoffset = ALIGN_UP(nOffsetX, OSD_ALIGN_X_OFFSET);
+        tDisp.arrDisp[0].uDisp.tOSD.u32DstYoffset = ALIGN_UP(nOffsetY, OSD_ALIGN_Y_OFFSET);
+    }
 
-            tDisp.tChnAttr.eFormat = AX_FORMAT_ARGB1555;
-            tDisp.arrDisp[0].uDisp.tOSD.enRgbFormat = AX_FORMAT_ARGB1555;
-            tDisp.arrDisp[0].uDisp.tOSD.u32DstXoffset = ALIGN_UP(nOffsetX, OSD_ALIGN_X_OFFSET);
-            tDisp.arrDisp[0].uDisp.tOSD.u32DstYoffset = ALIGN_UP(nOffsetY, OSD_ALIGN_Y_OFFSET);
-        }
+    AX_BOOL bChanged = AX_FALSE;
+    if (!pThreadParam->tTimeRender.Render(pThreadParam->pTimeHandler, &wszOsdDate[0], tLayout, bChanged)) {
+        LOG_MM_E(OSD, "Failed to generate bitmap for date string.");
+        return OSD_SCHED_STOP;
+    }
 
-        tDisp.arrDisp[0].uDisp.tOSD.pBitmap = (AX_U8*)pArgbData;
+    tDisp.arrDisp[0].uDisp.tOSD.pBitmap = (AX_U8*)pThreadParam->tTimeRender.GetBuffer();
+    if (bChanged || !pThreadParam->bLastDisp || 0 != memcmp(&tDisp, &pThreadParam->tLastDisp, sizeof(AX_IVPS_RGN_DISP_GROUP_T))) {
         AX_S32 ret = AX_IVPS_RGN_Update(pThreadParam->hRgn, &tDisp);
         if (AX_SUCCESS != ret) {
             LOG_MM_E(OSD, "AX_IVPS_RGN_Update fail, ret=0x%x, hRgn=%d", ret, pThreadParam->hRgn);
+            pThreadParam->bLastDisp = AX_FALSE;
+        } else {
+            pThreadParam->tLastDisp = tDisp;
+            pThreadParam->bLastDisp = AX_TRUE;
         }
         LOG_MM_D(OSD,
-                 "[%d][%d] OSD (TIME):hRgn:%d bEnable:%d,  nSrcWidth:%d, nSrcHeight:%d, u32BmpWidth: %d, u32BmpHeight: %d, xOffset: %d, "
-                 "yOffset: "
-                 "%d, alpha: %d, eFormat:%d, bInvEnable:%d",
+                 "[%d][%d] OSD (TIME):hRgn:%d bEnable:%d,  nSrcWidth:%d, nSrcHeight:%d, u32BmpWidth: %d, u32BmpHeight: %d, "
+                 "xOffset: %d, yOffset: %d, alpha: %d, eFormat:%d, bInvEnable:%d",
                  nIvpsGrp, nIvpsChn, pThreadParam->hRgn, tDisp.arrDisp[0].bShow, nSrcWidth, nSrcHeight,
                  tDisp.arrDisp[0].uDisp.tOSD.u32BmpWidth, tDisp.arrDisp[0].uDisp.tOSD.u32BmpHeight,
-                 tDisp.arrDisp[0].uDisp.tOSD.u32DstXoffset, tDisp.arrDisp[0].uDisp.tOSD.u32DstYoffset, tDisp.arrDisp[0].uDisp.tOSD.u16Alpha,
-                 tDisp.tChnAttr.eFormat, pThreadParam->tOsdCfg.tTimeAttr.bInvEnable);
-        m_osdWrapper.ReleaseInstance(&pOsdHandle);
+                 tDisp.arrDisp[0].uDisp.tOSD.u32DstXoffset, tDisp.arrDisp[0].uDisp.tOSD.u32DstYoffset,
+                 tDisp.arrDisp[0].uDisp.tOSD.u16Alpha, tDisp.tChnAttr.eFormat, pThreadParam->tOsdCfg.tTimeAttr.bInvEnable);
+    }
 
-        if (pArgbData) {
-            AX_FREE(pArgbData);
-            pArgbData = nullptr;
-        }
+    /* text changes only when second changes, run right after next second of wall clock */
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return 1000 - tv.tv_usec / 1000 + APP_OSD_TIME_LAG;
+}
 
-        for (int i = 0; i < 25 && !pThreadParam->bExit; i++) {
-            CElapsedTimer::mSleep(10);
-        }
-        // {
-        //     std::unique_lock<std::mutex> lck(m_mtxTime);
-        //     m_cvTime.wait_for(lck, std::chrono::milliseconds(500), [pThreadParam]() -> bool { return pThreadParam->bExit; });
-        // }
+AX_U32 COSDHelper::RectTask(OSD_REGION_PARAM_T* pThreadParam) {
+    if (!m_pIvpsGrpInstance->GetChannelState(pThreadParam->nChn)) {
+        return APP_OSD_CHN_OFF_INTERVAL;
     }
-}
 
-AX_VOID COSDHelper::RectThreadFunc(OSD_REGION_PARAM_T* pThreadParam) {
     AX_IVPS_RGN_DISP_GROUP_T tDisp;
     memset(&tDisp, 0, sizeof(AX_IVPS_RGN_DISP_GROUP_T));
 
-    AX_U32 nLastNum = (AX_U32)-1;
+    tDisp.nNum = 1;
+    tDisp.tChnAttr.nAlpha = 255;
+    tDisp.tChnAttr.eFormat = AX_FORMAT_ARGB1555;
+    tDisp.tChnAttr.nZindex = pThreadParam->tOsdCfg.nZIndex;
+    tDisp.tChnAttr.bSingleCanvas = AX_TRUE;
+    tDisp.tChnAttr.bVoRect = pThreadParam->bVoRect;
 
-    while (!pThreadParam->bExit) {
-        if (!m_pIvpsGrpInstance->GetChannelState(pThreadParam->nChn)) {
-            for (int i = 0; i < 25 && !pThreadParam->bExit; i++) {
-                CElapsedTimer::mSleep(20);
-            }
-            continue;
+    std::vector<AX_IVPS_RGN_POLYGON_T> stRgn;
+    AX_U32 index = 0;
+    if (APP_OSD_RECT(pThreadParam->hRgn, stRgn)) {
+        for (AX_U32 i = 0; i < stRgn.size() && index < AX_IVPS_REGION_MAX_DISP_NUM; ++i) {
+            tDisp.arrDisp[index].eType = AX_IVPS_RGN_TYPE_RECT;
+            tDisp.arrDisp[index].bShow = pThreadParam->tOsdCfg.bEnable;
+            tDisp.arrDisp[index].uDisp.tPolygon = stRgn[i];
+            index++;
         }
+    }
 
-        tDisp.nNum = 1;
-        tDisp.tChnAttr.nAlpha = 255;
-        tDisp.tChnAttr.eFormat = AX_FORMAT_ARGB1555;
-        tDisp.tChnAttr.nZindex = pThreadParam->tOsdCfg.nZIndex;
-        tDisp.tChnAttr.bSingleCanvas = AX_TRUE;
-        tDisp.tChnAttr.bVoRect = pThreadParam->bVoRect;
-
-        std::vector<AX_IVPS_RGN_POLYGON_T> stRgn;
-        AX_U32 index = 0;
-        if (APP_OSD_RECT(pThreadParam->hRgn, stRgn)) {
-            for (AX_U32 i = 0; i < stRgn.size() && index < AX_IVPS_REGION_MAX_DISP_NUM; ++i) {
-                tDisp.arrDisp[index].eType = AX_IVPS_RGN_TYPE_RECT;
-                tDisp.arrDisp[index].bShow = pThreadParam->tOsdCfg.bEnable;
-                tDisp.arrDisp[index].uDisp.tPolygon = stRgn[i];
-                index++;
-            }
+    stRgn.clear();
+    if (APP_OSD_POLYGON(pThreadParam->hRgn, stRgn)) {
+        tDisp.nNum += stRgn.size();
+        for (AX_U32 i = 0; i < stRgn.size() && index < AX_IVPS_REGION_MAX_DISP_NUM; ++i) {
+            tDisp.arrDisp[index].eType = AX_IVPS_RGN_TYPE_POLYGON;
+            tDisp.arrDisp[index].bShow = pThreadParam->tOsdCfg.bEnable;
+            tDisp.arrDisp[index].uDisp.tPolygon = stRgn[i];
+            index++;
         }
+    }
+    tDisp.nNum = index;
 
-        stRgn.clear();
-        if (APP_OSD_POLYGON(pThreadParam->hRgn, stRgn)) {
-            tDisp.nNum += stRgn.size();
-            for (AX_U32 i = 0; i < stRgn.size() && index < AX_IVPS_REGION_MAX_DISP_NUM; ++i) {
-                tDisp.arrDisp[index].eType = AX_IVPS_RGN_TYPE_POLYGON;
-                tDisp.arrDisp[index].bShow = pThreadParam->tOsdCfg.bEnable;
-                tDisp.arrDisp[index].uDisp.tPolygon = stRgn[i];
-                index++;
-            }
-        }
-        tDisp.nNum = index;
-
-        if (!(nLastNum == tDisp.nNum && nLastNum == 0)) {
-            AX_S32 ret = AX_IVPS_RGN_Update(pThreadParam->hRgn, &tDisp);
-            if (AX_SUCCESS != ret) {
-                LOG_MM_E(OSD, "AX_IVPS_RGN_Update fail, ret=0x%x, hRgn=%d", ret, pThreadParam->hRgn);
-                for (int i = 0; i < 50 && !pThreadParam->bExit; i++) {
-                    CElapsedTimer::mSleep(20);
-                }
-            }
+    AX_U32 nLastNum = pThreadParam->nLastRectNum;
+    pThreadParam->nLastRectNum = tDisp.nNum;
+    if (!(nLastNum == tDisp.nNum && nLastNum == 0)) {
+        AX_S32 ret = AX_IVPS_RGN_Update(pThreadParam->hRgn, &tDisp);
+        if (AX_SUCCESS != ret) {
+            LOG_MM_E(OSD, "AX_IVPS_RGN_Update fail, ret=0x%x, hRgn=%d", ret, pThreadParam->hRgn);
+            return APP_OSD_RECT_RETRY_INTERVAL;
         }
-
-        nLastNum = tDisp.nNum;
-
-        CElapsedTimer::mSleep(33);
     }
+
+    return OSD_SCHED_KEEP_PERIOD;
 }
 
 AX_VOID COSDHelper::UpdateOSDPic(OSD_REGION_PARAM_T* pThreadParam) {
@@ -740,18 +733,22 @@ AX_BOOL COSDHelper::StopOSD() {
 
     AX_S32 nRet = AX_SUCCESS;
 
-    m_bExited = AX_TRUE;
-    m_cv.notify_one();
-    m_updateThread.Join();
+    /* no task touches regions after removed */
+    COSDScheduler::GetInstance()->RemoveTask(m_nUpdateTaskID);
+    m_nUpdateTaskID = -1;
+    for (AX_U32 i = 0; i < m_nRgnCount; i++) {
+        if (-1 != m_arrRgnThreadParam[i].nTaskID) {
+            COSDScheduler::GetInstance()->RemoveTask(m_arrRgnThreadParam[i].nTaskID);
+            m_arrRgnThreadParam[i].nTaskID = -1;
+        }
+        if (m_arrRgnThreadParam[i].pTimeHandler) {
+            m_osdWrapper.ReleaseInstance(&m_arrRgnThreadParam[i].pTimeHandler);
+        }
+    }
+    COSDScheduler::GetInstance()->Stop();
 
     for (AX_U32 i = 0; i < m_nRgnCount; i++) {
         if (AX_IVPS_INVALID_REGION_HANDLE != m_arrRgnThreadParam[i].hRgn) {
-            if (OSD_TYPE_TIME == m_arrRgnThreadParam[i].tOsdCfg.eType || OSD_TYPE_RECT == m_arrRgnThreadParam[i].tOsdCfg.eType) {
-                {
-                    m_arrRgnThreadParam[i].bExit = AX_TRUE;
-                }
-                m_arrRgnThreadParam[i].m_EventThread.Join();
-            }
             nRet = AX_IVPS_RGN_DetachFromFilter(m_arrRgnThreadParam[i].hRgn, m_arrRgnThreadParam[i].nGroup, m_arrRgnThreadParam[i].nFilter);
             if (AX_SUCCESS != nRet) {
                 LOG_MM_E(OSD, "AX_IVPS_RGN_DetachFromFilter(Grp: %d, Filter: %x, Handle: %d) failed, ret=0x%x",
@@ -777,44 +774,32 @@ AX_BOOL COSDHelper::StopOSD() {
 }
 
 AX_BOOL COSDHelper::Refresh() {
-    std::unique_lock<std::mutex> lck(m_mtx);
-    ++m_nUpdateOSDTasks;
-    m_cv.notify_one();
+    /* refreshes requested during an update are merged into one more update */
+    COSDScheduler::GetInstance()->Trigger(m_nUpdateTaskID);
     return AX_TRUE;
 }
 
 AX_VOID COSDHelper::PerformUpdateOSD(AX_VOID) {
-    LOG_MM_C(OSD, "+++");
+    LOG_MM_I(OSD, "+++");
     if (!m_pIvpsGrpInstance) {
         return;
     }
     IVPS_GROUP_CFG_T* pGrpConfig = m_pIvpsGrpInstance->GetGrpCfg();
-    while (!m_bExited) {
-        std::unique_lock<std::mutex> lck(m_mtx);
-        m_cv.wait(lck, [this] { return ((m_nUpdateOSDTasks > 0) || m_bExited); });
-        if (m_bExited) {
-            break;
-        }
-
-        --m_nUpdateOSDTasks;
-
-        for (AX_U8 nChn = 0; nChn < pGrpConfig->nGrpChnNum; nChn++) {
-            std::vector<OSD_CFG_T> vecOsdCfg;
-            CWebOptionHelper::GetInstance()->GetOsdConfig(pGrpConfig->nSnsSrc, pGrpConfig->nGrp, nChn, vecOsdCfg);
-            for (AX_U32 i = 0; i < vecOsdCfg.size(); i++) {
-                OSD_TYPE_E eType = vecOsdCfg[i].eType;
-                for (AX_U32 j = 0; j < m_nRgnCount; j++) {
-                    if (nChn == m_arrRgnThreadParam[j].nChn && m_arrRgnThreadParam[j].tOsdCfg.eType == eType && OSD_TYPE_RECT != eType) {
-                        m_arrRgnThreadParam[j].tOsdCfg = vecOsdCfg[i];
-                        if (OSD_TYPE_TIME != eType) {
-                            UpdateOSD(&m_arrRgnThreadParam[j]);
-                        }
-                    }
+    for (AX_U8 nChn = 0; nChn < pGrpConfig->nGrpChnNum; nChn++) {
+        std::vector<OSD_CFG_T> vecOsdCfg;
+        CWebOptionHelper::GetInstance()->GetOsdConfig(pGrpConfig->nSnsSrc, pGrpConfig->nGrp, nChn, vecOsdCfg);
+        for (AX_U32 i = 0; i < vecOsdCfg.size(); i++) {
+            OSD_TYPE_E eType = vecOsdCfg[i].eType;
+            for (AX_U32 j = 0; j < m_nRgnCount; j++) {
+                if (nChn == m_arrRgnThreadParam[j].nChn && m_arrRgnThreadParam[j].tOsdCfg.eType == eType && OSD_TYPE_RECT != eType) {
+                    m_arrRgnThreadParam[j].tOsdCfg = vecOsdCfg[i];
+                    /* time region is redrawn by its task at once */
+                    UpdateOSD(&m_arrRgnThreadParam[j]);
                 }
             }
         }
     }
-    LOG_MM_C(OSD, "---");
+    LOG_MM_I(OSD, "---");
 }
 
 AX_BOOL COSDHelper::EnableAiRegion(AX_BOOL bEnable) {
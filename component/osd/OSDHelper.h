@@ -14,9 +14,9 @@
 #include <condition_variable.hpp>
 #include <map>
 #include <vector>
-#include "AXThread.hpp"
 #include "IOSDHelper.h"
 #include "OSDHandlerWrapper.h"
+#include "OSDTimeRender.h"
 #include "OsdConfig.h"
 #include "ax_base_type.h"
 #include "ax_ivps_api.h"
@@ -28,6 +28,12 @@
 #define APP_OSD_CHANNEL_FILTER_1 (1)
 #define APP_OSD_GROUP_FILTER_0 (0)
 #define APP_OSD_GROUP_FILTER_1 (1)
+/* intervals in ms of COSDScheduler tasks */
+#define APP_OSD_RECT_INTERVAL (33)
+#define APP_OSD_RECT_RETRY_INTERVAL (1000)
+#define APP_OSD_CHN_OFF_INTERVAL (500)
+/* time region runs this long after each second of wall clock */
+#define APP_OSD_TIME_LAG (5)
 
 class CIVPSGrpStage;
 
@@ -38,8 +44,16 @@ typedef struct _OSD_REGION_PARAM {
     AX_IVPS_FILTER nFilter{0};
     OSD_CFG_T tOsdCfg;
     AX_BOOL bVoRect{AX_FALSE};
-    AX_BOOL bExit{AX_FALSE};
-    CAXThread m_EventThread;
+    AX_S32 nTaskID{-1}; /* COSDScheduler task of time and rect region */
+
+    /* time region states kept between runs */
+    COSDHandler* pTimeHandler{nullptr};
+    COSDTimeRender tTimeRender;
+    AX_IVPS_RGN_DISP_GROUP_T tLastDisp;
+    AX_BOOL bLastDisp{AX_FALSE};
+
+    /* rect region states kept between runs */
+    AX_U32 nLastRectNum{(AX_U32)-1};
 } OSD_REGION_PARAM_T;
 
 class COSDHelper : public IOSDHelper {
@@ -58,8 +72,9 @@ public:
 
 private:
     AX_BOOL UpdateOSD(OSD_REGION_PARAM_T* pOsd);
-    AX_VOID TimeThreadFunc(OSD_REGION_PARAM_T* pThreadParam);
-    AX_VOID RectThreadFunc(OSD_REGION_PARAM_T* pThreadParam);
+    /* COSDScheduler tasks, return delay of next run */
+    AX_U32 TimeTask(OSD_REGION_PARAM_T* pThreadParam);
+    AX_U32 RectTask(OSD_REGION_PARAM_T* pThreadParam);
     AX_VOID UpdateOSDPic(OSD_REGION_PARAM_T* pThreadParam);
     AX_VOID UpdateOSDStr(OSD_REGION_PARAM_T* pThreadParam);
     AX_VOID UpdateOSDPri(OSD_REGION_PARAM_T* pThreadParam);
@@ -72,9 +87,6 @@ private:
     COSDHandlerWrapper m_osdWrapper;
     AX_U32 m_nRgnCount{0};
 
-    AX_BOOL m_bExited{AX_FALSE};
-    AX_S32 m_nUpdateOSDTasks{0};
-    CAXThread m_updateThread;
-    std::mutex m_mtx;
-    std::condition_variable m_cv;
+    /* COSDScheduler task triggered by Refresh */
+    AX_S32 m_nUpdateTaskID{-1};
 };
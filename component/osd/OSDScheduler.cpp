@@ -0,0 +1,258 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "OSDScheduler.h"
+#include <stdio.h>
+#include "AppLogApi.h"
+
+#define TAG "OSD_SCHED"
+
+AX_BOOL COSDScheduler::Start(AX_VOID) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (m_nRef++ > 0) {
+        return AX_TRUE;
+    }
+
+    m_bRunning = AX_TRUE;
+    if (!m_timerThread.Start(std::bind(&COSDScheduler::TimerThread, this), nullptr, "APP_OSD_TIMER")) {
+        LOG_MM_E(TAG, "start timer thread failed");
+        m_bRunning = AX_FALSE;
+        --m_nRef;
+        return AX_FALSE;
+    }
+
+    for (AX_U32 i = 0; i < OSD_SCHED_WORKER_NUM; ++i) {
+        AX_CHAR szName[16];
+        snprintf(szName, sizeof(szName), "APP_OSD_WORK%d", i);
+        if (!m_arrWorkerThread[i].Start(std::bind(&COSDScheduler::WorkerThread, this), nullptr, szName)) {
+            LOG_MM_E(TAG, "start worker thread %d failed", i);
+        }
+    }
+
+    LOG_MM_I(TAG, "started, tick %d ms, %d workers", OSD_SCHED_TICK_MS, OSD_SCHED_WORKER_NUM);
+    return AX_TRUE;
+}
+
+AX_VOID COSDScheduler::Stop(AX_VOID) {
+    AX_U32 nTasks = 0;
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        if (0 == m_nRef || --m_nRef > 0) {
+            return;
+        }
+
+        nTasks = m_mapTasks.size();
+
+        m_bRunning = AX_FALSE;
+        m_cvTimer.notify_all();
+        m_cvWork.notify_all();
+    }
+
+    m_timerThread.Join();
+    for (AX_U32 i = 0; i < OSD_SCHED_WORKER_NUM; ++i) {
+        m_arrWorkerThread[i].Join();
+    }
+
+    LOG_MM_I(TAG, "stopped, %d tasks left", nTasks);
+}
+
+AX_S32 COSDScheduler::AddTask(const AX_CHAR* pName, AX_U32 nPeriodMs, OSDTaskFunc fn, AX_BOOL bRunNow /* = AX_TRUE */) {
+    if (!fn) {
+        return -1;
+    }
+
+    TaskPtr pTask = std::make_shared<OSD_TASK_T>();
+    pTask->strName = pName ? pName : "";
+    pTask->nPeriodMs = nPeriodMs;
+    pTask->fn = fn;
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    pTask->nID = ++m_nNextID;
+    m_mapTasks[pTask->nID] = pTask;
+
+    if (bRunNow) {
+        MakeReady(pTask);
+    } else if (nPeriodMs > 0) {
+        AX_U64 nNow = NowMs();
+        Schedule(pTask, (nNow / nPeriodMs + 1) * nPeriodMs);
+    }
+
+    LOG_MM_I(TAG, "task %d (%s) added, period %d ms", pTask->nID, pTask->strName.c_str(), nPeriodMs);
+    return pTask->nID;
+}
+
+AX_VOID COSDScheduler::RemoveTask(AX_S32 nTaskID) {
+    std::unique_lock<std::mutex> lck(m_mtx);
+    auto it = m_mapTasks.find(nTaskID);
+    if (it == m_mapTasks.end()) {
+        return;
+    }
+
+    TaskPtr pTask = it->second;
+    m_mapTasks.erase(it);
+    pTask->bRemoved = AX_TRUE;
+    Unschedule(pTask);
+
+    /* a task removing itself must not wait for its own return */
+    if (OSD_TASK_RUNNING == pTask->eState && std::this_thread::get_id() != pTask->tRunner) {
+        m_cvDone.wait(lck, [&pTask]() -> bool { return OSD_TASK_RUNNING != pTask->eState; });
+    }
+
+    LOG_MM_I(TAG, "task %d (%s) removed", pTask->nID, pTask->strName.c_str());
+}
+
+AX_VOID COSDScheduler::Trigger(AX_S32 nTaskID) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    auto it = m_mapTasks.find(nTaskID);
+    if (it == m_mapTasks.end()) {
+        return;
+    }
+
+    TaskPtr& pTask = it->second;
+    switch (pTask->eState) {
+        case OSD_TASK_IDLE:
+        case OSD_TASK_WAIT:
+            Unschedule(pTask);
+            MakeReady(pTask);
+            break;
+        case OSD_TASK_RUNNING:
+            pTask->bTriggered = AX_TRUE;
+            break;
+        default:
+            break;
+    }
+}
+
+AX_U64 COSDScheduler::NowMs(AX_VOID) const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_tEpoch).count();
+}
+
+AX_VOID COSDScheduler::Schedule(const TaskPtr& pTask, AX_U64 nDeadlineMs) {
+    pTask->nDeadlineMs = nDeadlineMs;
+    pTask->nDeadlineTick = (nDeadlineMs + OSD_SCHED_TICK_MS - 1) / OSD_SCHED_TICK_MS;
+    if (pTask->nDeadlineTick < m_nCurTick) {
+        MakeReady(pTask);
+        return;
+    }
+
+    std::list<TaskPtr>& lstSlot = m_arrWheel[pTask->nDeadlineTick % OSD_SCHED_WHEEL_SLOTS];
+    pTask->itSlot = lstSlot.insert(lstSlot.end(), pTask);
+    pTask->eState = OSD_TASK_WAIT;
+    m_cvTimer.notify_one();
+}
+
+AX_VOID COSDScheduler::MakeReady(const TaskPtr& pTask) {
+    pTask->eState = OSD_TASK_READY;
+    m_qReady.push_back(pTask);
+    m_cvWork.notify_one();
+}
+
+AX_VOID COSDScheduler::Unschedule(const TaskPtr& pTask) {
+    if (OSD_TASK_WAIT == pTask->eState) {
+        m_arrWheel[pTask->nDeadlineTick % OSD_SCHED_WHEEL_SLOTS].erase(pTask->itSlot);
+        pTask->eState = OSD_TASK_IDLE;
+    }
+}
+
+AX_VOID COSDScheduler::ExpireSlot(AX_U32 nSlot, AX_U64 nTick) {
+    std::list<TaskPtr>& lstSlot = m_arrWheel[nSlot];
+    for (auto it = lstSlot.begin(); it != lstSlot.end();) {
+        if ((*it)->nDeadlineTick <= nTick) {
+            TaskPtr pTask = *it;
+            it = lstSlot.erase(it);
+            pTask->eState = OSD_TASK_READY;
+            m_qReady.push_back(pTask);
+        } else {
+            ++it;
+        }
+    }
+}
+
+AX_VOID COSDScheduler::TimerThread(AX_VOID) {
+    std::unique_lock<std::mutex> lck(m_mtx);
+    while (m_bRunning) {
+        AX_U64 nNowTick = NowMs() / OSD_SCHED_TICK_MS;
+        std::size_t nReady = m_qReady.size();
+        if (nNowTick >= m_nCurTick + OSD_SCHED_WHEEL_SLOTS) {
+            /* slept over a whole round, every slot is visited once */
+            for (AX_U32 i = 0; i < OSD_SCHED_WHEEL_SLOTS; ++i) {
+                ExpireSlot(i, nNowTick);
+            }
+            m_nCurTick = nNowTick + 1;
+        } else {
+            for (; m_nCurTick <= nNowTick; ++m_nCurTick) {
+                ExpireSlot(m_nCurTick % OSD_SCHED_WHEEL_SLOTS, m_nCurTick);
+            }
+        }
+
+        /* tasks expired in the same tick are handed to workers at once */
+        if (m_qReady.size() > nReady) {
+            m_cvWork.notify_all();
+        }
+
+        /* sleep to the next occupied slot instead of ticking through empty ones */
+        AX_U64 nWakeTick = m_nCurTick + OSD_SCHED_WHEEL_SLOTS;
+        for (AX_U32 i = 0; i < OSD_SCHED_WHEEL_SLOTS; ++i) {
+            if (!m_arrWheel[(m_nCurTick + i) % OSD_SCHED_WHEEL_SLOTS].empty()) {
+                nWakeTick = m_nCurTick + i;
+                break;
+            }
+        }
+
+        m_cvTimer.wait_until(lck, m_tEpoch + std::chrono::milliseconds(nWakeTick * OSD_SCHED_TICK_MS));
+    }
+}
+
+AX_VOID COSDScheduler::WorkerThread(AX_VOID) {
+    std::unique_lock<std::mutex> lck(m_mtx);
+    while (m_bRunning) {
+        m_cvWork.wait(lck, [this]() -> bool { return !m_qReady.empty() || !m_bRunning; });
+        if (!m_bRunning) {
+            break;
+        }
+
+        TaskPtr pTask = m_qReady.front();
+        m_qReady.pop_front();
+        if (pTask->bRemoved) {
+            continue;
+        }
+
+        pTask->eState = OSD_TASK_RUNNING;
+        pTask->tRunner = std::this_thread::get_id();
+        lck.unlock();
+
+        AX_U32 nDelayMs = pTask->fn();
+
+        lck.lock();
+        pTask->eState = OSD_TASK_IDLE;
+        pTask->tRunner = std::thread::id();
+        if (pTask->bRemoved) {
+            m_cvDone.notify_all();
+            continue;
+        }
+
+        AX_U64 nNow = NowMs();
+        if (pTask->bTriggered) {
+            pTask->bTriggered = AX_FALSE;
+            MakeReady(pTask);
+        } else if (OSD_SCHED_STOP == nDelayMs || (OSD_SCHED_KEEP_PERIOD == nDelayMs && 0 == pTask->nPeriodMs)) {
+            /* wait for Trigger */
+        } else if (OSD_SCHED_KEEP_PERIOD != nDelayMs) {
+            Schedule(pTask, nNow + nDelayMs);
+        } else {
+            AX_U64 nPeriod = pTask->nPeriodMs;
+            AX_U64 nNext = (pTask->nDeadlineMs / nPeriod + 1) * nPeriod;
+            if (nNext <= nNow) {
+                nNext = (nNow / nPeriod + 1) * nPeriod;
+            }
+            Schedule(pTask, nNext);
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "AXSingleton.h"
+#include "AXThread.hpp"
+#include "ax_base_type.h"
+#include "condition_variable.hpp"
+
+/* wheel resolution, deadlines in the same tick are dispatched together */
+#define OSD_SCHED_TICK_MS (5)
+/* 2.56s per round, longer delays stay in slot for more rounds */
+#define OSD_SCHED_WHEEL_SLOTS (512)
+#define OSD_SCHED_WORKER_NUM (2)
+
+/* task returns: next run on its period grid */
+#define OSD_SCHED_KEEP_PERIOD (0)
+/* task returns: no more run until COSDScheduler::Trigger */
+#define OSD_SCHED_STOP ((AX_U32)-1)
+
+/* returns delay in ms of next run, or OSD_SCHED_KEEP_PERIOD, OSD_SCHED_STOP */
+using OSDTaskFunc = std::function<AX_U32(AX_VOID)>;
+
+/**
+ * @brief Shared scheduler of all OSD regions.
+ *
+ * One timer thread keeps tasks in a hashed timer wheel and a small fixed worker pool runs them, instead of one
+ * sleeping thread per region.
+ * Periodic runs are placed on a grid of the period counted from scheduler epoch, so regions of the same period expire
+ * in the same tick and wake the workers once. A task never runs concurrently with itself; a run that overruns its
+ * period skips the missed grid points.
+ */
+class COSDScheduler final : public CAXSingleton<COSDScheduler> {
+    friend class CAXSingleton<COSDScheduler>;
+
+public:
+    /* reference counted, threads run between the first Start and the last Stop */
+    AX_BOOL Start(AX_VOID);
+    AX_VOID Stop(AX_VOID);
+
+    /* nPeriodMs 0 means run on Trigger only, return task id */
+    AX_S32 AddTask(const AX_CHAR *pName, AX_U32 nPeriodMs, OSDTaskFunc fn, AX_BOOL bRunNow = AX_TRUE);
+    /* wait until a running callback returns */
+    AX_VOID RemoveTask(AX_S32 nTaskID);
+    /* run as soon as possible, a running task runs once more after current run */
+    AX_VOID Trigger(AX_S32 nTaskID);
+
+private:
+    COSDScheduler(AX_VOID) noexcept = default;
+    virtual ~COSDScheduler(AX_VOID) = default;
+
+    typedef enum { OSD_TASK_IDLE, OSD_TASK_WAIT, OSD_TASK_READY, OSD_TASK_RUNNING } OSD_TASK_STATE_E;
+
+    struct OSD_TASK_T;
+    using TaskPtr = std::shared_ptr<OSD_TASK_T>;
+
+    struct OSD_TASK_T {
+        AX_S32 nID{-1};
+        std::string strName;
+        AX_U32 nPeriodMs{0};
+        OSDTaskFunc fn;
+        OSD_TASK_STATE_E eState{OSD_TASK_IDLE};
+        AX_U64 nDeadlineMs{0};
+        AX_U64 nDeadlineTick{0};
+        std::list<TaskPtr>::iterator itSlot; /* valid in OSD_TASK_WAIT */
+        std::thread::id tRunner;
+        AX_BOOL bTriggered{AX_FALSE};
+        AX_BOOL bRemoved{AX_FALSE};
+    };
+
+    AX_U64 NowMs(AX_VOID) const;
+    /* following require m_mtx */
+    AX_VOID Schedule(const TaskPtr &pTask, AX_U64 nDeadlineMs);
+    AX_VOID MakeReady(const TaskPtr &pTask);
+    AX_VOID Unschedule(const TaskPtr &pTask);
+    AX_VOID ExpireSlot(AX_U32 nSlot, AX_U64 nTick);
+
+    AX_VOID TimerThread(AX_VOID);
+    AX_VOID WorkerThread(AX_VOID);
+
+private:
+    std::chrono::steady_clock::time_point m_tEpoch{std::chrono::steady_clock::now()};
+    std::map<AX_S32, TaskPtr> m_mapTasks;
+    std::list<TaskPtr> m_arrWheel[OSD_SCHED_WHEEL_SLOTS];
+    AX_U64 m_nCurTick{0}; /* next tick to expire */
+    std::deque<TaskPtr> m_qReady;
+    AX_S32 m_nNextID{0};
+
+    std::mutex m_mtx;
+    std::condition_variable m_cvTimer;
+    std::condition_variable m_cvWork;
+    std::condition_variable m_cvDone;
+
+    AX_S32 m_nRef{0};
+    AX_BOOL m_bRunning{AX_FALSE};
+    CAXThread m_timerThread;
+    CAXThread m_arrWorkerThread[OSD_SCHED_WORKER_NUM];
+};
@@ -0,0 +1,279 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "OSDTimeRender.h"
+#include <string.h>
+#include <algorithm>
+
+AX_BOOL COSDTimeRender::Render(COSDHandler *pHandler, const wchar_t *pText, const OSD_TIME_LAYOUT_T &tLayout, AX_BOOL &bChanged) {
+    bChanged = AX_FALSE;
+    if (!pText || 0 == tLayout.nWidth || 0 == tLayout.nHeight) {
+        return AX_FALSE;
+    }
+
+    std::wstring strText(pText);
+    if (m_bValid && IsSameLayout(m_tLayout, tLayout)) {
+        if (strText == m_strText) {
+            return AX_TRUE;
+        }
+
+#ifndef FONT_USE_FREETYPE
+        if (RenderDirty(strText)) {
+            m_strText = strText;
+            bChanged = AX_TRUE;
+            return AX_TRUE;
+        }
+#endif
+    } else {
+        m_tLayout = tLayout;
+        m_bValid = AX_FALSE;
+
+        AX_U32 nSize = tLayout.bBitmap ? (tLayout.nWidth * tLayout.nHeight + 7) / 8 : tLayout.nWidth * tLayout.nHeight * 2;
+        m_vecBuffer.resize(nSize);
+#ifndef FONT_USE_FREETYPE
+        PrepareStyle();
+#endif
+    }
+
+    if (!RenderAll(pHandler, strText)) {
+        m_bValid = AX_FALSE;
+        return AX_FALSE;
+    }
+
+    m_strText = strText;
+    m_bValid = AX_TRUE;
+    bChanged = AX_TRUE;
+    return AX_TRUE;
+}
+
+AX_VOID COSDTimeRender::Reset(AX_VOID) {
+    m_bValid = AX_FALSE;
+}
+
+AX_BOOL COSDTimeRender::IsSameLayout(const OSD_TIME_LAYOUT_T &tLeft, const OSD_TIME_LAYOUT_T &tRight) {
+    return (tLeft.nWidth == tRight.nWidth && tLeft.nHeight == tRight.nHeight && tLeft.sX == tRight.sX && tLeft.sY == tRight.sY &&
+            tLeft.nFontSize == tRight.nFontSize && tLeft.bBitmap == tRight.bBitmap && tLeft.bBrushSide == tRight.bBrushSide &&
+            tLeft.nFontColor == tRight.nFontColor && tLeft.nBgColor == tRight.nBgColor && tLeft.nSideColor == tRight.nSideColor &&
+            tLeft.eAlign == tRight.eAlign)
+               ? AX_TRUE
+               : AX_FALSE;
+}
+
+#ifdef FONT_USE_FREETYPE
+AX_BOOL COSDTimeRender::RenderAll(COSDHandler *pHandler, const std::wstring &strText) {
+    if (!pHandler) {
+        return AX_FALSE;
+    }
+
+    memset(m_vecBuffer.data(), 0, m_vecBuffer.size());
+
+    /* freetype glyphs have variable advance, always draw the whole text */
+    wchar_t *pText = const_cast<wchar_t *>(strText.c_str());
+    const OSD_TIME_LAYOUT_T &t = m_tLayout;
+    if (t.bBitmap) {
+        return pHandler->GenBitmap(pText, m_vecBuffer.data(), t.nWidth, t.nHeight, t.sX, t.sY, t.nFontSize, t.eAlign) ? AX_TRUE : AX_FALSE;
+    }
+
+    return pHandler->GenARGB(pText, (AX_U16 *)m_vecBuffer.data(), t.nWidth, t.nHeight, t.sX, t.sY, t.nFontSize, t.bBrushSide,
+                             t.nFontColor, t.nBgColor, t.nSideColor, t.eAlign)
+               ? AX_TRUE
+               : AX_FALSE;
+}
+#else
+AX_BOOL COSDTimeRender::RenderAll(COSDHandler * /* pHandler */, const std::wstring &strText) {
+    if (!LayoutCells(strText, m_vecCells)) {
+        return AX_FALSE;
+    }
+
+    if (m_tLayout.bBitmap) {
+        memset(m_vecBuffer.data(), 0, m_vecBuffer.size());
+    } else {
+        AX_U16 *pArgb = (AX_U16 *)m_vecBuffer.data();
+        std::fill(pArgb, pArgb + m_tLayout.nWidth * m_tLayout.nHeight, m_u16BgColor);
+    }
+
+    for (auto &tCell : m_vecCells) {
+        DrawCell(tCell);
+    }
+
+    return AX_TRUE;
+}
+
+AX_VOID COSDTimeRender::PrepareStyle(AX_VOID) {
+    AX_U32 nFontColor = m_tLayout.nFontColor;
+    AX_U32 nBgColor = m_tLayout.nBgColor;
+    AX_U32 nSideColor = m_tLayout.nSideColor;
+
+    m_nScale = (m_tLayout.nFontSize + 15) / 16;
+    m_u16FontColor = COSDHandler::ConvertColor2Argb1555(nFontColor);
+    m_u16BgColor = COSDHandler::ConvertColor2Argb1555(nBgColor);
+    m_u16SideColor = COSDHandler::ConvertColor2Argb1555(nSideColor);
+    /* same as COSDHandler::GenARGB */
+    m_bSide = (m_tLayout.bBrushSide && !(m_u16BgColor & 0x8000)) ? AX_TRUE : AX_FALSE;
+
+    for (const wchar_t *p = OSD_TIME_ATLAS_CHARS; *p; ++p) {
+        GetGlyph(*p);
+    }
+}
+
+std::shared_ptr<const OSD_GLYPH_T> COSDTimeRender::GetGlyph(wchar_t wch) {
+    if (m_tLayout.bBitmap) {
+        /* color is meaningless for 1bpp, share one entry for all bitmap regions */
+        return COSDGlyphCache::GetInstance()->Get((AX_U16)wch, m_nScale, AX_FALSE, 0xFFFF, 0);
+    }
+
+    return COSDGlyphCache::GetInstance()->Get((AX_U16)wch, m_nScale, m_bSide, m_u16FontColor, m_u16SideColor);
+}
+
+AX_BOOL COSDTimeRender::LayoutCells(const std::wstring &strText, std::vector<TIME_CELL_T> &vecCells) {
+    /* same positions and clipping as COSDHandler::GenARGB */
+    AX_S32 nWidth = (AX_S32)m_tLayout.nWidth;
+    AX_S32 x = (m_tLayout.sX < 0) ? 0 : m_tLayout.sX;
+    AX_S32 nLen = (AX_S32)strText.size();
+
+    vecCells.assign(nLen, TIME_CELL_T{0, nullptr});
+
+    switch (m_tLayout.eAlign) {
+        case OSD_ALIGN_TYPE_LEFT_TOP:
+        case OSD_ALIGN_TYPE_LEFT_BOTTOM: {
+            AX_S32 x0 = x;
+            for (AX_S32 i = 0; i < nLen; i++) {
+                std::shared_ptr<const OSD_GLYPH_T> pGlyph = GetGlyph(strText[i]);
+                if (!pGlyph) {
+                    continue;
+                }
+
+                vecCells[i].nX = x0;
+                vecCells[i].pGlyph = pGlyph;
+                x0 += pGlyph->nWidth;
+                if (x0 >= nWidth) {
+                    break;
+                }
+            }
+            break;
+        }
+        case OSD_ALIGN_TYPE_RIGHT_TOP:
+        case OSD_ALIGN_TYPE_RIGHT_BOTTOM: {
+            AX_S32 x0 = nWidth - x;
+            if (x0 < 0) {
+                return AX_FALSE;
+            }
+
+            for (AX_S32 i = nLen - 1; i >= 0; i--) {
+                std::shared_ptr<const OSD_GLYPH_T> pGlyph = GetGlyph(strText[i]);
+                if (!pGlyph) {
+                    continue;
+                }
+
+                x0 -= pGlyph->nWidth;
+                vecCells[i].nX = x0;
+                vecCells[i].pGlyph = pGlyph;
+                if (x0 < 0) {
+                    break;
+                }
+            }
+            break;
+        }
+        default:
+            return AX_FALSE;
+    }
+
+    return AX_TRUE;
+}
+
+AX_VOID COSDTimeRender::DrawCell(const TIME_CELL_T &tCell) {
+    if (!tCell.pGlyph) {
+        return;
+    }
+
+    AX_S32 y = (m_tLayout.sY < 0) ? 0 : m_tLayout.sY;
+    if (m_tLayout.bBitmap) {
+        COSDGlyphCache::BlitBitmap(*tCell.pGlyph, m_vecBuffer.data(), m_tLayout.nWidth, m_tLayout.nHeight, tCell.nX, y);
+    } else {
+        COSDGlyphCache::Blit(*tCell.pGlyph, (AX_U16 *)m_vecBuffer.data(), m_tLayout.nWidth, m_tLayout.nHeight, tCell.nX, y,
+                             m_u16BgColor);
+    }
+}
+
+AX_VOID COSDTimeRender::ClearCell(const TIME_CELL_T &tCell) {
+    if (!tCell.pGlyph) {
+        return;
+    }
+
+    /* cell with side margin, clipped to region */
+    AX_S32 nMargin = tCell.pGlyph->nMargin;
+    AX_S32 y = (m_tLayout.sY < 0) ? 0 : m_tLayout.sY;
+    AX_S32 nX0 = std::max(tCell.nX - nMargin, 0);
+    AX_S32 nY0 = std::max(y - nMargin, 0);
+    AX_S32 nX1 = std::min(tCell.nX + tCell.pGlyph->nWidth + nMargin, (AX_S32)m_tLayout.nWidth);
+    AX_S32 nY1 = std::min(y + tCell.pGlyph->nHeight + nMargin, (AX_S32)m_tLayout.nHeight);
+
+    for (AX_S32 j = nY0; j < nY1; j++) {
+        if (m_tLayout.bBitmap) {
+            AX_U8 *pBitmap = m_vecBuffer.data();
+            for (AX_S32 i = nX0; i < nX1; i++) {
+                AX_U32 nPos = j * m_tLayout.nWidth + i;
+                pBitmap[nPos / 8] &= ~(1 << (nPos % 8));
+            }
+        } else if (nX0 < nX1) {
+            AX_U16 *pArgb = (AX_U16 *)m_vecBuffer.data() + j * m_tLayout.nWidth;
+            std::fill(pArgb + nX0, pArgb + nX1, m_u16BgColor);
+        }
+    }
+}
+
+AX_BOOL COSDTimeRender::RenderDirty(const std::wstring &strText) {
+    if (strText.size() != m_strText.size()) {
+        return AX_FALSE;
+    }
+
+    std::vector<TIME_CELL_T> vecCells;
+    if (!LayoutCells(strText, vecCells)) {
+        return AX_FALSE;
+    }
+
+    /* any glyph moves, such as a wider char, falls back to full render */
+    AX_S32 nLen = (AX_S32)strText.size();
+    for (AX_S32 i = 0; i < nLen; i++) {
+        if (vecCells[i].nX != m_vecCells[i].nX || !vecCells[i].pGlyph != !m_vecCells[i].pGlyph ||
+            (vecCells[i].pGlyph && vecCells[i].pGlyph->nWidth != m_vecCells[i].pGlyph->nWidth)) {
+            return AX_FALSE;
+        }
+    }
+
+    /* side pixels reach 1 pixel into neighbour cells, so neighbours of a cleared cell are redrawn too */
+    std::vector<AX_BOOL> vecRedraw(nLen, AX_FALSE);
+    for (AX_S32 i = 0; i < nLen; i++) {
+        if (strText[i] == m_strText[i] || !m_vecCells[i].pGlyph) {
+            continue;
+        }
+
+        ClearCell(m_vecCells[i]);
+        vecRedraw[i] = AX_TRUE;
+        if (m_vecCells[i].pGlyph->nMargin > 0) {
+            if (i > 0) {
+                vecRedraw[i - 1] = AX_TRUE;
+            }
+            if (i + 1 < nLen) {
+                vecRedraw[i + 1] = AX_TRUE;
+            }
+        }
+    }
+
+    m_vecCells.swap(vecCells);
+    for (AX_S32 i = 0; i < nLen; i++) {
+        if (vecRedraw[i]) {
+            DrawCell(m_vecCells[i]);
+        }
+    }
+
+    return AX_TRUE;
+}
+#endif
@@ -0,0 +1,94 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "OSDHandler.h"
+#include "ax_base_type.h"
+#ifndef FONT_USE_FREETYPE
+#include "OSDGlyphCache.h"
+#endif
+
+/* digits and separators of all time formats, rasterised once per font size and color */
+#define OSD_TIME_ATLAS_CHARS L"0123456789-/: "
+
+/* render parameters of time region, any change redraws the whole region */
+typedef struct _OSD_TIME_LAYOUT {
+    AX_U32 nWidth{0};
+    AX_U32 nHeight{0};
+    AX_S16 sX{0};
+    AX_S16 sY{0};
+    AX_U16 nFontSize{0};
+    AX_BOOL bBitmap{AX_FALSE}; /* 1bpp for color inversion, else ARGB1555 */
+    AX_BOOL bBrushSide{AX_FALSE};
+    AX_U32 nFontColor{0};
+    AX_U32 nBgColor{0};
+    AX_U32 nSideColor{0};
+    OSD_ALIGN_TYPE_E eAlign{OSD_ALIGN_TYPE_LEFT_TOP};
+} OSD_TIME_LAYOUT_T;
+
+/**
+ * @brief Incremental renderer of the time OSD.
+ *
+ * Keeps the region buffer and text of last render. Unchanged text and layout are reported as not changed, so caller can skip
+ * AX_IVPS_RGN_Update. If only some characters change and glyph widths stay the same (seconds, minutes ...), only cells of those
+ * characters are cleared and redrawn from COSDGlyphCache, otherwise the whole region is drawn.
+ * With FONT_USE_FREETYPE, any text change redraws the whole region by COSDHandler.
+ */
+class COSDTimeRender {
+public:
+    COSDTimeRender(AX_VOID) = default;
+    ~COSDTimeRender(AX_VOID) = default;
+
+    /* bChanged returns AX_FALSE if buffer is same as last render */
+    AX_BOOL Render(COSDHandler *pHandler, const wchar_t *pText, const OSD_TIME_LAYOUT_T &tLayout, AX_BOOL &bChanged);
+    /* force next Render to draw the whole region */
+    AX_VOID Reset(AX_VOID);
+
+    AX_VOID *GetBuffer(AX_VOID) {
+        return m_vecBuffer.data();
+    }
+
+private:
+    static AX_BOOL IsSameLayout(const OSD_TIME_LAYOUT_T &tLeft, const OSD_TIME_LAYOUT_T &tRight);
+    AX_BOOL RenderAll(COSDHandler *pHandler, const std::wstring &strText);
+
+#ifndef FONT_USE_FREETYPE
+    typedef struct {
+        AX_S32 nX;
+        std::shared_ptr<const OSD_GLYPH_T> pGlyph; /* nullptr if not drawn */
+    } TIME_CELL_T;
+
+    AX_VOID PrepareStyle(AX_VOID);
+    std::shared_ptr<const OSD_GLYPH_T> GetGlyph(wchar_t wch);
+    AX_BOOL LayoutCells(const std::wstring &strText, std::vector<TIME_CELL_T> &vecCells);
+    AX_VOID DrawCell(const TIME_CELL_T &tCell);
+    AX_VOID ClearCell(const TIME_CELL_T &tCell);
+    AX_BOOL RenderDirty(const std::wstring &strText);
+#endif
+
+private:
+    std::vector<AX_U8> m_vecBuffer;
+    std::wstring m_strText;
+    OSD_TIME_LAYOUT_T m_tLayout;
+    AX_BOOL m_bValid{AX_FALSE};
+
+#ifndef FONT_USE_FREETYPE
+    std::vector<TIME_CELL_T> m_vecCells;
+    AX_U16 m_nScale{1};
+    AX_BOOL m_bSide{AX_FALSE};
+    AX_U16 m_u16FontColor{0};
+    AX_U16 m_u16BgColor{0};
+    AX_U16 m_u16SideColor{0};
+#endif
+};
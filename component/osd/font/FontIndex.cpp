@@ -9,8 +9,9 @@
  **************************************************************************************************/
 
 #ifndef FONT_USE_FREETYPE
-#include "FontEn16.h"
-#include "FontZh16.h"
+#include "glyph/FontEn16.h"
+#include "glyph/FontLookup.h"
+#include "glyph/FontZh16.h"
 #endif
 
 #include "FontIndex.h"
@@ -18,39 +19,16 @@
 #include <wchar.h>
 
 #ifndef FONT_USE_FREETYPE
-AX_U16 GetZhGlyphIndex(AX_U16 nUnicode) {
-    AX_U32 nCount = sizeof(g_fontZh16Index) / sizeof(g_fontZh16Index[0]);
-    for (AX_U32 i = 0; i < nCount; i++) {
-        if (g_fontZh16Index[i].nUnicode == nUnicode) {
-            return g_fontZh16Index[i].nIndex;
-        }
-    }
-    return 0;
-}
-
-AX_U16 GetEnGlyphIndex(AX_U16 nUnicode) {
-    AX_U32 nCount = sizeof(g_fontEn16Index) / sizeof(g_fontEn16Index[0]);
-    for (AX_U32 i = 0; i < nCount; i++) {
-        if (g_fontEn16Index[i].nUnicode == nUnicode) {
-            return g_fontEn16Index[i].nIndex;
-        } else if (g_fontEn16Index[i].nUnicode > nUnicode) {
-            break;
-        }
-    }
-
-    return 0;
-}
-
 AX_S32 GetFontBitmap(AX_U16 nUnicode, FONT_BITMAP_T &bmp) {
     if (nUnicode <= 0x7F) {
-        AX_U16 nInd = GetEnGlyphIndex(nUnicode);
-        bmp.nWidth = 8;
-        bmp.nHeight = 16;
+        AX_U32 nInd = FontLookupGlyph(g_fontEn16Codes, FONT_EN16_COUNT, nUnicode, FONT_EN16_DEFAULT_GLYPH);
+        bmp.nWidth = FONT_EN16_WIDTH;
+        bmp.nHeight = FONT_EN16_HEIGHT;
         bmp.pBuffer = (AX_U8 *)(g_fontEn16Glyphs + (bmp.nWidth / 8 * bmp.nHeight) * nInd);
     } else {
-        AX_U16 nInd = GetZhGlyphIndex(nUnicode);
-        bmp.nWidth = 16;
-        bmp.nHeight = 16;
+        AX_U32 nInd = FontLookupGlyph(g_fontZh16Codes, FONT_ZH16_COUNT, nUnicode, FONT_ZH16_DEFAULT_GLYPH);
+        bmp.nWidth = FONT_ZH16_WIDTH;
+        bmp.nHeight = FONT_ZH16_HEIGHT;
         bmp.pBuffer = (AX_U8 *)(g_fontZh16Glyphs + (bmp.nWidth / 8 * bmp.nHeight) * nInd);
     }
 
@@ -82,40 +60,3 @@ AX_S32 OsdCalcStrSize(wchar_t *pStr, AX_U32 nFontSize, AX_U32 &nWidth, AX_U32 &n
     nHeight = 16 * nScale;
     return nWidth*nHeight;
 }
-
-/*
-#define FONT_IS_GB2312(a, b)        ((a) >= 0xA1 && (a) <= 0xF7 && (b) >= 0xA1 && (b) <= 0xFE)
-#define HZ16_INDEX(C1, C2)         ((((C1)&0xFF)-0xA1)*94 + (((C2)&0xFF)-0xA1))
-
-AX_S32 GenGB2312UnicodeGlyfIndex() {
-
-    AX_S32 nCount = sizeof(g_fontZh16Index) / sizeof(g_fontZh16Index[0]);
-    AX_S32 nGBCount = 0;
-    UICODE_INDEX_T * gbGlyph = new UICODE_INDEX_T[nCount];
-    for (int i = 0; i < nCount; i++) {
-        AX_U16 nGB = g_fontZh16Index[i].nIndex;
-        AX_U8* szGB = (AX_U8 *)&nGB;
-        if ( FONT_IS_GB2312(szGB[1], szGB[0]) ) {
-            AX_U16 nIndex = HZ16_INDEX(szGB[1], szGB[0]);
-            gbGlyph[nGBCount].nUnicode = g_fontZh16Index[i].nUnicode;
-            gbGlyph[nGBCount].nIndex = nIndex;
-            nGBCount ++;
-        }
-    }
-
-    printf("total gb glyph = %d\n",nGBCount);
-
-    for (int i = 0; i < nGBCount/8; i++) {
-        for (int j = 0; j < 8; j++) {
-            printf("{0x%04x,0x%04x},",gbGlyph[i*8+j].nUnicode, gbGlyph[i*8+j].nIndex);
-        }
-        printf("\n");
-    }
-
-    for (int j = 0; j < nGBCount%8; j++) {
-        printf("{0x%04x,0x%04x},",gbGlyph[(nGBCount%8)*8 + j].nUnicode, gbGlyph[(nGBCount%8)*8 + j].nIndex);
-    }
-    printf("\n");
-    return 0;
-}
-*/
\ No newline at end of file
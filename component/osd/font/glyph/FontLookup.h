@@ -0,0 +1,32 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef __FONTLOOKUP_H__
+#define __FONTLOOKUP_H__
+
+#include "ax_base_type.h"
+
+/* binary search in generated g_fontXXCodes[], return nDefault if not found */
+static inline AX_U32 FontLookupGlyph(const AX_U16 *pCodes, AX_U32 nCount, AX_U16 nUnicode, AX_U32 nDefault) {
+    AX_U32 nLow = 0;
+    AX_U32 nHigh = nCount;
+    while (nLow < nHigh) {
+        AX_U32 nMid = (nLow + nHigh) / 2;
+        if (pCodes[nMid] < nUnicode) {
+            nLow = nMid + 1;
+        } else {
+            nHigh = nMid;
+        }
+    }
+
+    return (nLow < nCount && pCodes[nLow] == nUnicode) ? nLow : nDefault;
+}
+
+#endif  // __FONTLOOKUP_H__
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+# **************************************************************************************************
+#
+# Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+#
+# This source file is the property of Axera Semiconductor Co., Ltd. and
+# may not be copied or distributed in any isomorphic form without the prior
+# written consent of Axera Semiconductor Co., Ltd.
+#
+# **************************************************************************************************
+
+"""
+Generate the shared OSD font table header used by component, opal and QSDemo.
+
+Output contains glyphs sorted by unicode so runtime looks them up by binary search:
+    FONT_<NAME>_WIDTH / FONT_<NAME>_HEIGHT / FONT_<NAME>_COUNT
+    FONT_<NAME>_DEFAULT_GLYPH    glyph drawn for codes not in font
+    g_font<Name>Codes[]          sorted unicode of each glyph
+    g_font<Name>Glyphs[]         1bpp bitmaps, MSB first, in the same order as codes
+
+Supported inputs:
+    legacy C header: glyph array plus UICODE_INDEX_T {unicode, glyph id} array, unreferenced glyphs are dropped
+    generated header: output of this script, to rebuild after editing
+    BDF font: ENCODING is unicode, bitmaps are placed at top-left of WxH cell
+
+e.g. python3 font_table_gen.py --name Zh16 --width 16 --height 16 --default 0x3000 -i FontZh16_legacy.h -o ../glyph/FontZh16.h
+"""
+
+import argparse
+import re
+import sys
+
+HEADER = """/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+/* generated by component/osd/font/tools/font_table_gen.py, do not edit */
+"""
+
+
+def parse_c_array(text, pattern):
+    m = re.search(pattern + r"[^=]*=\s*\{", text)
+    if not m:
+        return None
+    end = text.index("};", m.end())
+    return text[m.end():end]
+
+
+def load_header(path, name, glyph_size):
+    text = open(path, encoding="utf-8").read()
+    glyphs = parse_c_array(text, r"g_font%sGlyphs" % name)
+    if glyphs is None:
+        sys.exit("%s: g_font%sGlyphs not found" % (path, name))
+    data = [int(v, 16) for v in re.findall(r"0x([0-9a-fA-F]{1,2})\b", glyphs)]
+
+    codes = parse_c_array(text, r"g_font%sCodes" % name)
+    if codes is not None:
+        # generated format, glyph i belongs to code i
+        codes = [int(v, 16) for v in re.findall(r"0x([0-9a-fA-F]+)", codes)]
+        return {c: data[i * glyph_size:(i + 1) * glyph_size] for i, c in enumerate(codes)}
+
+    index = parse_c_array(text, r"g_font%sIndex" % name)
+    if index is None:
+        sys.exit("%s: neither g_font%sCodes nor g_font%sIndex found" % (path, name, name))
+
+    table = {}
+    for code, glyph in re.findall(r"\{\s*0x([0-9a-fA-F]+)\s*,\s*0x([0-9a-fA-F]+)\s*\}", index):
+        code, glyph = int(code, 16), int(glyph, 16)
+        # legacy lookup is linear, first entry wins
+        if code not in table:
+            table[code] = data[glyph * glyph_size:(glyph + 1) * glyph_size]
+    return table
+
+
+def load_bdf(path, width, height):
+    row_bytes = (width + 7) // 8
+    table = {}
+    code, rows, in_bitmap = None, [], False
+    for line in open(path, encoding="latin-1"):
+        words = line.split()
+        if not words:
+            continue
+        if words[0] == "ENCODING":
+            code = int(words[1])
+        elif words[0] == "BITMAP":
+            rows, in_bitmap = [], True
+        elif words[0] == "ENDCHAR":
+            in_bitmap = False
+            if code is None or code < 0 or code > 0xFFFF:
+                continue
+            glyph = []
+            for r in range(height):
+                value = int(rows[r], 16) if r < len(rows) else 0
+                bits = len(rows[r]) * 4 if r < len(rows) else 8
+                for b in range(row_bytes):
+                    shift = bits - 8 * (b + 1)
+                    glyph.append((value >> shift) & 0xFF if shift >= 0 else (value << -shift) & 0xFF)
+            table[code] = glyph
+            code = None
+        elif in_bitmap:
+            rows.append(words[0])
+    return table
+
+
+def write_header(path, name, width, height, default, table):
+    glyph_size = (width + 7) // 8 * height
+    codes = sorted(table)
+    if default not in table:
+        sys.exit("default code 0x%04x not in font" % default)
+
+    upper = name.upper()
+    guard = "__FONT%s_H__" % upper
+    out = [HEADER]
+    out.append("#ifndef %s\n#define %s\n\n#include \"ax_base_type.h\"\n\n" % (guard, guard))
+    out.append("#define FONT_%s_WIDTH (%d)\n" % (upper, width))
+    out.append("#define FONT_%s_HEIGHT (%d)\n" % (upper, height))
+    out.append("#define FONT_%s_COUNT (%d)\n" % (upper, len(codes)))
+    out.append("#define FONT_%s_DEFAULT_GLYPH (%d) /* U+%04X */\n\n" % (upper, codes.index(default), default))
+
+    out.append("// Unicode of each glyph, ascending\n")
+    out.append("const static AX_U16 g_font%sCodes[FONT_%s_COUNT] = {\n" % (name, upper))
+    for i in range(0, len(codes), 16):
+        out.append(",".join("0x%04x" % c for c in codes[i:i + 16]) + ",\n")
+    out.append("};\n\n")
+
+    out.append("// Glyphs: WxH = %dx%d, 1bpp, MSB is the left pixel\n" % (width, height))
+    out.append("const static AX_U8 g_font%sGlyphs[FONT_%s_COUNT * %d] = {\n" % (name, upper, glyph_size))
+    for c in codes:
+        glyph = table[c]
+        for i in range(0, glyph_size, 16):
+            out.append(",".join("0x%02x" % v for v in glyph[i:i + 16]) + ",\n")
+    out.append("};\n\n#endif  // %s\n" % guard)
+
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("".join(out))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="generate sorted OSD font table")
+    parser.add_argument("--name", required=True, help="table name, such as Zh16 or En16")
+    parser.add_argument("--width", type=int, required=True)
+    parser.add_argument("--height", type=int, required=True)
+    parser.add_argument("--default", type=lambda v: int(v, 0), default=0, help="code drawn for missing glyphs")
+    parser.add_argument("-i", "--input", required=True, help="C header or .bdf")
+    parser.add_argument("-o", "--output", required=True)
+    args = parser.parse_args()
+
+    glyph_size = (args.width + 7) // 8 * args.height
+    if args.input.endswith(".bdf"):
+        table = load_bdf(args.input, args.width, args.height)
+    else:
+        table = load_header(args.input, args.name, glyph_size)
+
+    for code, glyph in table.items():
+        if len(glyph) != glyph_size:
+            sys.exit("U+%04X: glyph has %d bytes, %d expected" % (code, len(glyph), glyph_size))
+
+    write_header(args.output, args.name, args.width, args.height, args.default, table)
+    print("%s: %d glyphs" % (args.output, len(table)))
+
+
+if __name__ == "__main__":
+    main()
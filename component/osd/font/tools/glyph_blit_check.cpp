@@ -0,0 +1,123 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+/*
+    Golden check and benchmark of COSDGlyphCache::Blit.
+    Random glyphs are blitted at random positions around random ARGB1555 buffers by every build of OSDGlyphCache.cpp,
+    the scalar build is the golden and the SIMD builds must produce identical pixels.
+
+    usage: glyph_blit_check [iterations]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "glyph_blit_check.h"
+#include "host_tool.h"
+
+#define GLYPH_BENCH_TEXT_LEN (32)
+#define GLYPH_BENCH_LOOP (2000)
+
+static const HOST_TOOL_VARIANT_T<GLYPH_BLIT_FUNC> s_arrVariants[] = {
+    {"scalar", GlyphBlitScalar},
+    {"simd", GlyphBlitSimd},
+#if defined(HOST_TOOL_NEON_EMU)
+    {"neon_emu", GlyphBlitNeonEmu},
+#endif
+};
+
+/* ascii, digits of time OSD, CJK, and codes out of font */
+static const AX_U16 s_arrUnicodes[] = {'0', '9', ':', '-', 'A', 'g', 'W', ' ', 0x4E2D, 0x6587, 0x661F, 0x671F, 0x901A, 0x9053, 0xFFFF, 0x0001};
+
+static const AX_U16 s_arrColors[] = {0xFFFF, 0x8000, 0x0000, 0x7C00, 0x83E0, 0x801F};
+
+static AX_BOOL Check(AX_U32 nIterations) {
+    const AX_U32 nVariants = HOST_TOOL_ARRAY_SIZE(s_arrVariants);
+    const AX_U32 nColors = HOST_TOOL_ARRAY_SIZE(s_arrColors);
+    AX_U32 nMismatch = 0;
+    for (AX_U32 it = 0; it < nIterations; ++it) {
+        AX_U16 nUnicode = s_arrUnicodes[rand() % HOST_TOOL_ARRAY_SIZE(s_arrUnicodes)];
+        AX_U16 nScale = 1 + rand() % 4;
+        AX_BOOL bSide = (AX_BOOL)(rand() % 2);
+        AX_U16 nFontColor = s_arrColors[rand() % nColors];
+        AX_U16 nSideColor = s_arrColors[rand() % nColors];
+        AX_U16 nBgColor = s_arrColors[rand() % nColors];
+        auto pGlyph = GlyphGetScalar(nUnicode, nScale, bSide, nFontColor, nSideColor);
+        if (!pGlyph) {
+            continue;
+        }
+
+        AX_U32 nWidth = 1 + rand() % 160;
+        AX_U32 nHeight = 1 + rand() % 80;
+        AX_S32 x = rand() % (nWidth + 2 * pGlyph->nStride) - pGlyph->nStride;
+        AX_S32 y = rand() % (nHeight + 2 * pGlyph->nStride) - pGlyph->nStride;
+
+        /* mostly background, so that side pixels are drawn and skipped */
+        std::vector<AX_U16> vecInit(nWidth * nHeight);
+        for (auto &c : vecInit) {
+            c = (rand() % 4) ? nBgColor : (AX_U16)rand();
+        }
+
+        std::vector<AX_U16> vecGolden = vecInit;
+        s_arrVariants[0].pFunc(*pGlyph, vecGolden.data(), nWidth, nHeight, x, y, nBgColor);
+        for (AX_U32 v = 1; v < nVariants; ++v) {
+            std::vector<AX_U16> vecBuf = vecInit;
+            s_arrVariants[v].pFunc(*pGlyph, vecBuf.data(), nWidth, nHeight, x, y, nBgColor);
+            if (vecBuf != vecGolden) {
+                if (++nMismatch <= 5) {
+                    printf("[%s] differs from scalar: iteration %u, unicode 0x%04X scale %u side %d at (%d, %d) of %ux%u\n",
+                           s_arrVariants[v].pszName, it, nUnicode, nScale, bSide, x, y, nWidth, nHeight);
+                }
+            }
+        }
+    }
+
+    printf("check: %u iterations, %u variants, %u mismatches\n", nIterations, nVariants, nMismatch);
+    return (0 == nMismatch) ? AX_TRUE : AX_FALSE;
+}
+
+static AX_VOID Bench(AX_VOID) {
+    /* one line of channel name OSD, scale 2 with side */
+    const AX_U16 nScale = 2;
+    std::vector<std::shared_ptr<const OSD_GLYPH_T>> vecGlyphs;
+    AX_U32 nWidth = 0;
+    AX_U32 nHeight = 0;
+    for (AX_U32 i = 0; i < GLYPH_BENCH_TEXT_LEN; ++i) {
+        auto pGlyph = GlyphGetScalar(s_arrUnicodes[i % 14], nScale, AX_TRUE, 0xFFFF, 0x8000);
+        nWidth += pGlyph->nWidth;
+        nHeight = pGlyph->nHeight;
+        vecGlyphs.push_back(pGlyph);
+    }
+
+    std::vector<AX_U16> vecBuf(nWidth * nHeight, 0);
+    for (const auto &tVariant : s_arrVariants) {
+        AX_F64 fUs = HostToolBenchUs(GLYPH_BENCH_LOOP, [&]() {
+            AX_S32 x = 0;
+            for (const auto &pGlyph : vecGlyphs) {
+                tVariant.pFunc(*pGlyph, vecBuf.data(), nWidth, nHeight, x, 0, 0);
+                x += pGlyph->nWidth;
+            }
+        });
+        printf("bench [%-8s] %u glyphs, scale %u with side, %ux%u: %.2f us/line\n", tVariant.pszName, GLYPH_BENCH_TEXT_LEN, nScale, nWidth,
+               nHeight, fUs);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    AX_U32 nIterations = (argc > 1) ? (AX_U32)atoi(argv[1]) : 20000;
+    srand(1);
+
+    if (!Check(nIterations)) {
+        return 1;
+    }
+
+    Bench();
+    return 0;
+}
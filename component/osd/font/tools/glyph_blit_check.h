@@ -0,0 +1,30 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+#include <memory>
+#include "OSDGlyphCache.h"
+
+typedef AX_VOID (*GLYPH_BLIT_FUNC)(const OSD_GLYPH_T &tGlyph, AX_U16 *pArgbBuffer, AX_U32 nWidth, AX_U32 nHeight, AX_S32 x, AX_S32 y,
+                                   AX_U16 nBgColor);
+
+/* one entry per build of OSDGlyphCache.cpp, see glyph_blit_variant.cpp */
+AX_VOID GlyphBlitScalar(const OSD_GLYPH_T &tGlyph, AX_U16 *pArgbBuffer, AX_U32 nWidth, AX_U32 nHeight, AX_S32 x, AX_S32 y,
+                        AX_U16 nBgColor);
+AX_VOID GlyphBlitSimd(const OSD_GLYPH_T &tGlyph, AX_U16 *pArgbBuffer, AX_U32 nWidth, AX_U32 nHeight, AX_S32 x, AX_S32 y,
+                      AX_U16 nBgColor);
+#if defined(HOST_TOOL_NEON_EMU)
+AX_VOID GlyphBlitNeonEmu(const OSD_GLYPH_T &tGlyph, AX_U16 *pArgbBuffer, AX_U32 nWidth, AX_U32 nHeight, AX_S32 x, AX_S32 y,
+                         AX_U16 nBgColor);
+#endif
+
+/* glyphs are rasterised by the scalar build, rasterising has no SIMD path */
+std::shared_ptr<const OSD_GLYPH_T> GlyphGetScalar(AX_U16 nUnicode, AX_U16 nScale, AX_BOOL bBrushSide, AX_U16 nFontColor,
+                                                  AX_U16 nSideColor);
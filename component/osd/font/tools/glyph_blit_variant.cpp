@@ -0,0 +1,28 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+/*
+    Built once per SIMD variant by Makefile, with COSDGlyphCache renamed and GLYPH_BLIT_ENTRY set to the entry of
+    glyph_blit_check.h, so that the scalar, SSE2/NEON and emulated NEON paths of OSDGlyphCache.cpp link into one program.
+*/
+#include "../../OSDGlyphCache.cpp"
+#include "glyph_blit_check.h"
+
+AX_VOID GLYPH_BLIT_ENTRY(const OSD_GLYPH_T &tGlyph, AX_U16 *pArgbBuffer, AX_U32 nWidth, AX_U32 nHeight, AX_S32 x, AX_S32 y,
+                         AX_U16 nBgColor) {
+    COSDGlyphCache::Blit(tGlyph, pArgbBuffer, nWidth, nHeight, x, y, nBgColor);
+}
+
+#if defined(GLYPH_GET_ENTRY)
+std::shared_ptr<const OSD_GLYPH_T> GLYPH_GET_ENTRY(AX_U16 nUnicode, AX_U16 nScale, AX_BOOL bBrushSide, AX_U16 nFontColor,
+                                                   AX_U16 nSideColor) {
+    return COSDGlyphCache::GetInstance()->Get(nUnicode, nScale, bBrushSide, nFontColor, nSideColor);
+}
+#endif
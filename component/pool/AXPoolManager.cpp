@@ -10,8 +10,10 @@
 
 #include "AXPoolManager.hpp"
 #include <algorithm>
+#include "AXJsonWriter.hpp"
 #include "AppLog.hpp"
 #include "ax_sys_api.h"
+#include "ax_vin_api.h"
 using namespace std;
 
 AX_BOOL CAXPoolManager::AddBlockToFloorPlan(AX_U32 nBlkSize, AX_U32 nBlkCount) {
@@ -96,6 +98,7 @@ AX_POOL CAXPoolManager::CreatePool(const AX_POOL_CONFIG_T &stPoolCfg) {
 
     lock_guard<std::mutex> lck(m_mtx);
     m_arrPools.push_back(pool);
+    m_mapPrivPool[pool] = stPoolCfg;
     return pool;
 }
 
@@ -116,6 +119,7 @@ AX_BOOL CAXPoolManager::DestoryPool(AX_POOL &pool) {
         *it = AX_INVALID_POOLID;
     }
 
+    m_mapPrivPool.erase(pool);
     pool = AX_INVALID_POOLID;
     return AX_TRUE;
 }
@@ -144,6 +148,7 @@ AX_BOOL CAXPoolManager::DestoryAllPools(AX_VOID) {
     }
 
     m_arrPools.clear();
+    m_mapPrivPool.clear();
 
     ret = AX_POOL_Exit();
     if (0 != ret) {
@@ -152,4 +157,307 @@ AX_BOOL CAXPoolManager::DestoryAllPools(AX_VOID) {
     }
 
     return AX_TRUE;
-}
\ No newline at end of file
+}
+
+static const AX_CHAR *PoolOwnerModName(AX_U32 nOwner) {
+    switch (POOL_OWNER_MOD(nOwner)) {
+        case POOL_OWNER_MOD_VIN:
+            return "VIN";
+        case POOL_OWNER_MOD_IVPS:
+            return "IVPS";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+AX_VOID CAXPoolManager::EnableTracking(AX_BOOL bEnable) {
+    lock_guard<std::mutex> lck(m_mtxUsage);
+    if (bEnable && !m_bTracking) {
+        m_mapUsage.clear();
+    }
+
+    m_bTracking = bEnable;
+}
+
+POOL_USAGE_T *CAXPoolManager::FindUsage(AX_POOL nPoolId, AX_U64 nFrameSize) {
+    auto it = m_mapUsage.find(nPoolId);
+    if (it != m_mapUsage.end()) {
+        return &it->second;
+    }
+
+    POOL_USAGE_T tUsage;
+    tUsage.nPoolId = nPoolId;
+
+    {
+        lock_guard<std::mutex> lck(m_mtx);
+        auto itPriv = m_mapPrivPool.find(nPoolId);
+        if (itPriv != m_mapPrivPool.end()) {
+            tUsage.nBlkSize = itPriv->second.BlkSize;
+            tUsage.nBlkCnt = itPriv->second.BlkCnt;
+            tUsage.bPrivate = AX_TRUE;
+        } else {
+            /* floor plan is sorted by block size, SDK takes the smallest common pool which fits */
+            auto itComm = m_mapFloorPool.lower_bound((AX_U32)nFrameSize);
+            if (itComm != m_mapFloorPool.end()) {
+                tUsage.nBlkSize = itComm->second.BlkSize;
+                tUsage.nBlkCnt = itComm->second.BlkCnt;
+            }
+        }
+    }
+
+    return &(m_mapUsage[nPoolId] = tUsage);
+}
+
+AX_VOID CAXPoolManager::TrackAcquire(AX_U32 nOwner, AX_BLK nBlkId, AX_U64 nFrameSize, AX_U32 nFifoDepth) {
+    if (!IsTracking() || AX_INVALID_BLOCKID == nBlkId) {
+        return;
+    }
+
+    AX_POOL nPoolId = AX_POOL_Handle2PoolId(nBlkId);
+    if (AX_INVALID_POOLID == nPoolId) {
+        return;
+    }
+
+    lock_guard<std::mutex> lck(m_mtxUsage);
+    POOL_USAGE_T *pUsage = FindUsage(nPoolId, nFrameSize);
+    if (++pUsage->nInUse > pUsage->nPeak) {
+        pUsage->nPeak = pUsage->nInUse;
+    }
+
+    POOL_OWNER_USAGE_T &tOwner = pUsage->mapOwner[nOwner];
+    tOwner.nFifoDepth = nFifoDepth;
+    tOwner.nAcquire++;
+    if (++tOwner.nInUse > tOwner.nPeak) {
+        tOwner.nPeak = tOwner.nInUse;
+    }
+}
+
+AX_VOID CAXPoolManager::TrackRelease(AX_U32 nOwner, AX_BLK nBlkId) {
+    if (!IsTracking() || AX_INVALID_BLOCKID == nBlkId) {
+        return;
+    }
+
+    AX_POOL nPoolId = AX_POOL_Handle2PoolId(nBlkId);
+    if (AX_INVALID_POOLID == nPoolId) {
+        return;
+    }
+
+    lock_guard<std::mutex> lck(m_mtxUsage);
+    auto it = m_mapUsage.find(nPoolId);
+    if (it == m_mapUsage.end()) {
+        return;
+    }
+
+    /* block acquired before tracking is enabled is not counted */
+    auto itOwner = it->second.mapOwner.find(nOwner);
+    if (itOwner == it->second.mapOwner.end() || 0 == itOwner->second.nInUse) {
+        return;
+    }
+
+    itOwner->second.nInUse--;
+    itOwner->second.nRelease++;
+    it->second.nInUse--;
+}
+
+AX_VOID CAXPoolManager::TrackDrop(AX_U32 nOwner, AX_BLK nBlkId, AX_U64 nFrameSize) {
+    if (!IsTracking() || AX_INVALID_BLOCKID == nBlkId) {
+        return;
+    }
+
+    AX_POOL nPoolId = AX_POOL_Handle2PoolId(nBlkId);
+    if (AX_INVALID_POOLID == nPoolId) {
+        return;
+    }
+
+    lock_guard<std::mutex> lck(m_mtxUsage);
+    FindUsage(nPoolId, nFrameSize)->mapOwner[nOwner].nDrop++;
+}
+
+AX_VOID CAXPoolManager::AddUntrackedUser(AX_U32 nOwner, AX_U64 nFrameSize) {
+    if (0 == nFrameSize) {
+        return;
+    }
+
+    lock_guard<std::mutex> lck(m_mtxUsage);
+    if (m_setUntracked.insert(make_pair(nOwner, nFrameSize)).second) {
+        LOG_I("%s: %s[%d][%d] frame size %llu", __func__, PoolOwnerModName(nOwner), POOL_OWNER_GRP(nOwner), POOL_OWNER_CHN(nOwner),
+              nFrameSize);
+    }
+}
+
+AX_VOID CAXPoolManager::AddUntrackedUser(AX_U32 nOwner, AX_U32 nWidthStride, AX_U32 nHeight,
+                                         const AX_FRAME_COMPRESS_INFO_T &tCompressInfo) {
+    /* same size as common pool of PoolConfig */
+    AX_FRAME_COMPRESS_INFO_T tInfo = tCompressInfo;
+    AddUntrackedUser(nOwner, AX_VIN_GetImgBufferSize(nHeight, nWidthStride, AX_FORMAT_YUV420_SEMIPLANAR, &tInfo, 2));
+}
+
+AX_VOID CAXPoolManager::GetUsage(std::vector<POOL_USAGE_T> &vecUsage) {
+    vecUsage.clear();
+
+    std::set<std::pair<AX_U32, AX_U64>> setUntracked;
+    {
+        lock_guard<std::mutex> lck(m_mtxUsage);
+        for (const auto &kv : m_mapUsage) {
+            vecUsage.push_back(kv.second);
+        }
+
+        setUntracked = m_setUntracked;
+    }
+
+    /* pools of floor plan which are never seen */
+    lock_guard<std::mutex> lck(m_mtx);
+    for (const auto &kv : m_mapFloorPool) {
+        auto it = find_if(vecUsage.begin(), vecUsage.end(),
+                          [&kv](const POOL_USAGE_T &m) { return !m.bPrivate && m.nBlkSize == kv.second.BlkSize; });
+        if (it == vecUsage.end()) {
+            POOL_USAGE_T tUsage;
+            tUsage.nBlkSize = kv.second.BlkSize;
+            tUsage.nBlkCnt = kv.second.BlkCnt;
+            vecUsage.push_back(tUsage);
+        }
+    }
+
+    /* blocks of untracked users come from the smallest fitting common pool, but how many is unknown */
+    for (const auto &m : setUntracked) {
+        auto itComm = m_mapFloorPool.lower_bound((AX_U32)m.second);
+        if (itComm == m_mapFloorPool.end()) {
+            continue;
+        }
+
+        for (auto &tUsage : vecUsage) {
+            if (!tUsage.bPrivate && tUsage.nBlkSize == itComm->second.BlkSize &&
+                find(tUsage.vecUntracked.begin(), tUsage.vecUntracked.end(), m.first) == tUsage.vecUntracked.end()) {
+                tUsage.vecUntracked.push_back(m.first);
+            }
+        }
+    }
+
+    sort(vecUsage.begin(), vecUsage.end(), [](const POOL_USAGE_T &a, const POOL_USAGE_T &b) {
+        return (a.bPrivate != b.bPrivate) ? !a.bPrivate : a.nBlkSize < b.nBlkSize;
+    });
+}
+
+AX_U32 CAXPoolManager::RecommendBlkCnt(const POOL_USAGE_T &tUsage) {
+    if (0 == tUsage.mapOwner.size()) {
+        return tUsage.nBlkCnt;
+    }
+
+    /* blocks of untracked users are never seen, each one gets a fixed allowance */
+    AX_U32 nCnt = tUsage.nPeak + POOL_TRACK_MARGIN_BLK_NUM + (AX_U32)tUsage.vecUntracked.size() * POOL_UNTRACKED_BLK_NUM;
+    for (const auto &kv : tUsage.mapOwner) {
+        nCnt += kv.second.nFifoDepth;
+    }
+
+    return (0 == tUsage.nBlkCnt || nCnt < tUsage.nBlkCnt) ? nCnt : tUsage.nBlkCnt;
+}
+
+AX_U32 CAXPoolManager::DeriveBlkCnt(const POOL_USAGE_T &tUsage, AX_F64 fTargetDropRate) {
+    AX_U64 nFrames = 0;
+    for (const auto &kv : tUsage.mapOwner) {
+        AX_U64 nTotal = kv.second.nAcquire + kv.second.nDrop;
+        if (nTotal > 0 && (AX_F64)kv.second.nDrop / nTotal > fTargetDropRate) {
+            /* stage already stalls with configured count */
+            return tUsage.nBlkCnt;
+        }
+
+        nFrames += kv.second.nAcquire;
+    }
+
+    if (nFrames < POOL_CALIBRATE_MIN_FRAME_NUM) {
+        return tUsage.nBlkCnt;
+    }
+
+    return RecommendBlkCnt(tUsage);
+}
+
+AX_VOID CAXPoolManager::DeriveFloorPlan(AX_F64 fTargetDropRate, std::map<AX_U32, AX_U32> &mapPlan) {
+    std::vector<POOL_USAGE_T> vecUsage;
+    GetUsage(vecUsage);
+
+    mapPlan.clear();
+    for (const auto &m : vecUsage) {
+        if (m.bPrivate || 0 == m.nBlkSize) {
+            continue;
+        }
+
+        AX_U32 nBlkCnt = DeriveBlkCnt(m, fTargetDropRate);
+        auto it = mapPlan.find((AX_U32)m.nBlkSize);
+        if (it == mapPlan.end() || it->second < nBlkCnt) {
+            mapPlan[(AX_U32)m.nBlkSize] = nBlkCnt;
+        }
+    }
+}
+
+AX_U32 CAXPoolManager::DumpUsage(AX_CHAR *pBuf, AX_U32 nSize) {
+    std::vector<POOL_USAGE_T> vecUsage;
+    GetUsage(vecUsage);
+
+    AX_U64 nCfgBytes = 0;
+    AX_U64 nRecBytes = 0;
+
+    CAXJsonWriter w(pBuf, nSize);
+    w.BeginObject().Bool("tracking", IsTracking()).Key("pools").BeginArray();
+    for (const auto &m : vecUsage) {
+        AX_U32 nRecCnt = RecommendBlkCnt(m);
+        nCfgBytes += m.nBlkSize * m.nBlkCnt;
+        nRecBytes += m.nBlkSize * nRecCnt;
+
+        w.BeginObject();
+        w.Int("pool", (AX_INVALID_POOLID == m.nPoolId) ? -1 : (AX_S64)m.nPoolId);
+        w.Bool("private", m.bPrivate).UInt("blk_size", m.nBlkSize).UInt("blk_cnt", m.nBlkCnt);
+        w.UInt("in_use", m.nInUse).UInt("peak", m.nPeak).UInt("recommend_cnt", nRecCnt);
+        w.Key("owners").BeginArray();
+        for (const auto &kv : m.mapOwner) {
+            w.BeginObject();
+            w.String("mod", PoolOwnerModName(kv.first)).UInt("grp", POOL_OWNER_GRP(kv.first)).UInt("chn", POOL_OWNER_CHN(kv.first));
+            w.UInt("in_use", kv.second.nInUse).UInt("peak", kv.second.nPeak).UInt("fifo_depth", kv.second.nFifoDepth);
+            w.UInt("acquire", kv.second.nAcquire).UInt("release", kv.second.nRelease).UInt("drop", kv.second.nDrop);
+            w.EndObject();
+        }
+        w.EndArray();
+        w.Key("untracked").BeginArray();
+        for (auto nOwner : m.vecUntracked) {
+            w.BeginObject();
+            w.String("mod", PoolOwnerModName(nOwner)).UInt("grp", POOL_OWNER_GRP(nOwner)).UInt("chn", POOL_OWNER_CHN(nOwner));
+            w.UInt("allowance", POOL_UNTRACKED_BLK_NUM);
+            w.EndObject();
+        }
+        w.EndArray().EndObject();
+    }
+    w.EndArray();
+    w.UInt("config_bytes", nCfgBytes).UInt("recommend_bytes", nRecBytes);
+    w.EndObject();
+
+    return w.IsValid() ? w.GetLength() : 0;
+}
+
+AX_VOID CAXPoolManager::PrintUsage(AX_VOID) {
+    std::vector<POOL_USAGE_T> vecUsage;
+    GetUsage(vecUsage);
+
+    AX_U64 nCfgBytes = 0;
+    AX_U64 nRecBytes = 0;
+
+    LOG_C("---------------------------------- POOL USAGE (tracking: %d) ----------------------------------", IsTracking());
+    for (const auto &m : vecUsage) {
+        AX_U32 nRecCnt = RecommendBlkCnt(m);
+        nCfgBytes += m.nBlkSize * m.nBlkCnt;
+        nRecBytes += m.nBlkSize * nRecCnt;
+
+        LOG_C("%s pool %2d: blkSize %10llu, blkCnt %3d, inUse %3d, peak %3d, recommend %3d%s", m.bPrivate ? "priv" : "comm",
+              (AX_S32)m.nPoolId, m.nBlkSize, m.nBlkCnt, m.nInUse, m.nPeak, nRecCnt,
+              m.mapOwner.size() ? "" : " (untracked)");
+        for (const auto &kv : m.mapOwner) {
+            LOG_C("    %-4s[%d][%d]: inUse %3d, peak %3d, fifo %2d, acquire %llu, release %llu, drop %llu", PoolOwnerModName(kv.first),
+                  POOL_OWNER_GRP(kv.first), POOL_OWNER_CHN(kv.first), kv.second.nInUse, kv.second.nPeak, kv.second.nFifoDepth,
+                  kv.second.nAcquire, kv.second.nRelease, kv.second.nDrop);
+        }
+        for (auto nOwner : m.vecUntracked) {
+            LOG_C("    %-4s[%d][%d]: untracked, blocks held inside SDK, allow %d", PoolOwnerModName(nOwner), POOL_OWNER_GRP(nOwner),
+                  POOL_OWNER_CHN(nOwner), POOL_UNTRACKED_BLK_NUM);
+        }
+    }
+
+    LOG_C("config %llu KB, recommend %llu KB", nCfgBytes >> 10, nRecBytes >> 10);
+}
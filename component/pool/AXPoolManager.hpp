@@ -10,15 +10,66 @@
 
 #pragma once
 #include <string.h>
+#include <atomic>
 #include <map>
 #include <mutex>
+#include <set>
 #include <vector>
 #include "AXSingleton.h"
 #include "GlobalDef.h"
+#include "ax_global_type.h"
 #include "ax_pool_type.h"
 
 #define DEFAULT_META_SIZE (4096)
 
+/* blocks kept on top of observed peak when recommending floor plan */
+#define POOL_TRACK_MARGIN_BLK_NUM (1)
+/* blocks allowed per untracked user: one written by hardware, one read by next module, one queued */
+#define POOL_UNTRACKED_BLK_NUM (3)
+/* pool with fewer frames than this during calibration is not shrunk */
+#define POOL_CALIBRATE_MIN_FRAME_NUM (300)
+
+typedef enum {
+    POOL_AUTO_SIZE_OFF = 0,       /* floor plan from pool.ini */
+    POOL_AUTO_SIZE_CALIBRATE = 1, /* floor plan from pool.ini, track usage and save profile on stop */
+    POOL_AUTO_SIZE_PROFILE = 2,   /* block counts from saved profile */
+    POOL_AUTO_SIZE_BUTT
+} POOL_AUTO_SIZE_MODE_E;
+
+typedef enum {
+    POOL_OWNER_MOD_VIN = 0,
+    POOL_OWNER_MOD_IVPS = 1,
+    POOL_OWNER_MOD_BUTT
+} POOL_OWNER_MOD_E;
+
+/* stage which holds blocks: module, group (pipe) and channel */
+#define POOL_OWNER_ID(mod, grp, chn) ((((AX_U32)(mod)&0xFF) << 16) | (((AX_U32)(grp)&0xFF) << 8) | ((AX_U32)(chn)&0xFF))
+#define POOL_OWNER_MOD(id) (((id) >> 16) & 0xFF)
+#define POOL_OWNER_GRP(id) (((id) >> 8) & 0xFF)
+#define POOL_OWNER_CHN(id) ((id)&0xFF)
+/* channel of an owner which is internal to the group, e.g. output of IVPS group filter */
+#define POOL_OWNER_CHN_INTERNAL (0xFF)
+
+typedef struct {
+    AX_U32 nInUse{0};
+    AX_U32 nPeak{0};
+    AX_U32 nFifoDepth{0}; /* blocks queued inside SDK for this stage, not visible to app */
+    AX_U64 nAcquire{0};
+    AX_U64 nRelease{0};
+    AX_U64 nDrop{0}; /* frames got and dropped by app because downstream is stalled */
+} POOL_OWNER_USAGE_T;
+
+typedef struct {
+    AX_POOL nPoolId{AX_INVALID_POOLID};
+    AX_U64 nBlkSize{0};
+    AX_U32 nBlkCnt{0};
+    AX_BOOL bPrivate{AX_FALSE};
+    AX_U32 nInUse{0};
+    AX_U32 nPeak{0};
+    std::map<AX_U32 /* POOL_OWNER_ID */, POOL_OWNER_USAGE_T> mapOwner;
+    std::vector<AX_U32 /* POOL_OWNER_ID */> vecUntracked; /* users whose blocks never leave SDK */
+} POOL_USAGE_T;
+
 class CAXPoolManager : public CAXSingleton<CAXPoolManager> {
     friend class CAXSingleton<CAXPoolManager>;
 
@@ -45,12 +96,59 @@ public:
      */
     AX_BOOL DestoryAllPools(AX_VOID);
 
+    /**
+     * @brief Accounting of blocks held by app stages (frames got from VIN / IVPS and not released yet)
+     * @note
+     *   1. Blocks queued inside SDK for a tracked owner are estimated by fifo depth that owner reports on acquire.
+     *   2. Blocks of users which never hand frames to app (VIN channels, IVPS group filters, link mode outputs ...)
+     *      can not be counted, these users are registered by AddUntrackedUser.
+     *   3. Common pool of a block is matched by frame size to the smallest fitting pool of floor plan,
+     *      the same way SDK picks a common pool.
+     *   4. Recommended count = peak of app held + fifo depth of owners + POOL_TRACK_MARGIN_BLK_NUM
+     *      + POOL_UNTRACKED_BLK_NUM per untracked user, never above configured count.
+     *      Pools without any tracked owner have nothing observed and keep configured count.
+     */
+    AX_VOID EnableTracking(AX_BOOL bEnable);
+    AX_BOOL IsTracking(AX_VOID) const {
+        return m_bTracking.load(std::memory_order_relaxed) ? AX_TRUE : AX_FALSE;
+    }
+
+    AX_VOID TrackAcquire(AX_U32 nOwner, AX_BLK nBlkId, AX_U64 nFrameSize, AX_U32 nFifoDepth);
+    AX_VOID TrackRelease(AX_U32 nOwner, AX_BLK nBlkId);
+    AX_VOID TrackDrop(AX_U32 nOwner, AX_BLK nBlkId, AX_U64 nFrameSize);
+
+    /* registration is kept across EnableTracking, a user whose resolution changes adds each frame size */
+    AX_VOID AddUntrackedUser(AX_U32 nOwner, AX_U64 nFrameSize);
+    AX_VOID AddUntrackedUser(AX_U32 nOwner, AX_U32 nWidthStride, AX_U32 nHeight, const AX_FRAME_COMPRESS_INFO_T& tCompressInfo);
+
+    AX_VOID GetUsage(std::vector<POOL_USAGE_T>& vecUsage);
+    /* JSON report with recommended floor plan, return length or 0 if buffer is too small */
+    AX_U32 DumpUsage(AX_CHAR* pBuf, AX_U32 nSize);
+    AX_VOID PrintUsage(AX_VOID);
+
+    /**
+     * @brief Derive block count of each common pool from tracked usage
+     * @param fTargetDropRate  pool used by an owner dropping more frames than this rate keeps configured count
+     * @note pure function of usage, so profiles can be checked off target with recorded or mocked usage
+     */
+    static AX_U32 DeriveBlkCnt(const POOL_USAGE_T& tUsage, AX_F64 fTargetDropRate);
+    AX_VOID DeriveFloorPlan(AX_F64 fTargetDropRate, std::map<AX_U32 /* blkSize */, AX_U32 /* blkCnt */>& mapPlan);
+
 private:
     CAXPoolManager(AX_VOID) noexcept = default;
     virtual ~CAXPoolManager(AX_VOID) = default;
 
+    POOL_USAGE_T* FindUsage(AX_POOL nPoolId, AX_U64 nFrameSize);
+    static AX_U32 RecommendBlkCnt(const POOL_USAGE_T& tUsage);
+
 private:
     std::map<AX_U32 /* blkSize */, AX_POOL_CONFIG_T> m_mapFloorPool;
     std::vector<AX_POOL> m_arrPools;
+    std::map<AX_POOL, AX_POOL_CONFIG_T> m_mapPrivPool;
     std::mutex m_mtx;
+
+    std::atomic<AX_BOOL> m_bTracking{AX_FALSE};
+    std::map<AX_POOL, POOL_USAGE_T> m_mapUsage;
+    std::set<std::pair<AX_U32 /* POOL_OWNER_ID */, AX_U64 /* frameSize */>> m_setUntracked;
+    std::mutex m_mtxUsage;
 };
\ No newline at end of file
@@ -9,10 +9,13 @@
  **************************************************************************************************/
 
 #include "PoolConfig.h"
+#include "AXPoolManager.hpp"
 #include "AXStringHelper.hpp"
 #include "AppLogApi.h"
+#include "CmdLineParser.h"
 #include "CommonUtils.hpp"
 #include "GlobalDef.h"
+#include "IniWrapper.hpp"
 #include "OptionHelper.h"
 #include "PoolOptionHelper.h"
 #include "SensorOptionHelper.h"
@@ -426,6 +429,11 @@ AX_BOOL CPoolConfig::Start() {
         return AX_FALSE;
     }
 
+    m_nAutoSizeMode = COptionHelper::GetInstance()->GetPoolAutoSizeMode();
+    if (POOL_AUTO_SIZE_PROFILE == m_nAutoSizeMode) {
+        ApplyProfile();
+    }
+
     nRet = AX_POOL_SetConfig(&m_tCommPoolFloorPlan);
 
     for (AX_U32 k = 0; k < m_nPoolCount; k++) {
@@ -440,6 +448,13 @@ AX_BOOL CPoolConfig::Start() {
         LOG_M_D(POOL, "AX_POOL_SetConfig success!");
     }
 
+    /* keep floor plan for usage accounting */
+    CAXPoolManager::GetInstance()->ClearFloorPlan();
+    for (AX_U32 k = 0; k < m_nPoolCount; k++) {
+        CAXPoolManager::GetInstance()->AddBlockToFloorPlan(m_tCommPoolFloorPlan.CommPool[k].BlkSize,
+                                                           m_tCommPoolFloorPlan.CommPool[k].BlkCnt);
+    }
+
     nRet = AX_POOL_Init();
     if (nRet) {
         LOG_M_E(POOL, "AX_POOL_Init fail!!Error Code:0x%X", nRet);
@@ -447,12 +462,22 @@ AX_BOOL CPoolConfig::Start() {
         LOG_M_I(POOL, "AX_POOL_Init success!");
     }
 
+    if (POOL_AUTO_SIZE_CALIBRATE == m_nAutoSizeMode) {
+        LOG_M_C(POOL, "Pool calibration: tracking block usage, profile is saved on stop");
+        CAXPoolManager::GetInstance()->EnableTracking(AX_TRUE);
+    }
+
     /*initialize private pool*/
     nRet = InitPrivatePool();
     return (nRet == 0) ? AX_TRUE : AX_FALSE;
 }
 
 AX_BOOL CPoolConfig::Stop() {
+    if (POOL_AUTO_SIZE_CALIBRATE == m_nAutoSizeMode) {
+        CAXPoolManager::GetInstance()->PrintUsage();
+        SaveProfile();
+    }
+
     // can not invoke AX_POOL_Exit, this will destroy pool early.
 
     // AX_S32 nRet = AX_POOL_Exit();
@@ -470,3 +495,91 @@ AX_BOOL CPoolConfig::Stop() {
 const AX_POOL_FLOORPLAN_T& CPoolConfig::GetPrivPoolFloorPlan() {
     return m_tPrivPoolFloorPlan;
 }
+
+std::string CPoolConfig::GetProfilePath(AX_VOID) {
+    std::string strProfile = COptionHelper::GetInstance()->GetPoolProfile();
+    if (strProfile.empty() || '/' == strProfile[0]) {
+        return strProfile;
+    }
+
+    return CCommonUtils::GetPPLConfigDir() + "/" + strProfile;
+}
+
+std::string CPoolConfig::GetProfileSection(AX_VOID) {
+    AX_S32 nLoadType = E_LOAD_TYPE_MAX;
+    AX_S32 nScenario = 0;
+    CCmdLineParser::GetInstance()->GetLoadType(nLoadType);
+    CCmdLineParser::GetInstance()->GetScenario(nScenario);
+
+    AX_CHAR szSection[32] = {0};
+    snprintf(szSection, sizeof(szSection), "S%dN%d", nLoadType, nScenario);
+    return szSection;
+}
+
+AX_BOOL CPoolConfig::ApplyProfile(AX_VOID) {
+    std::string strPath = GetProfilePath();
+    std::string strSection = GetProfileSection();
+
+    CIniWrapper tProfile;
+    if (strPath.empty() || !tProfile.Load(strPath)) {
+        LOG_M_W(POOL, "Pool profile %s not found, use pool.ini", strPath.c_str());
+        return AX_FALSE;
+    }
+
+    /* profile is applied only if it covers every pool, otherwise floor plan has changed since calibration */
+    AX_U32 arrBlkCnt[AX_MAX_COMM_POOLS] = {0};
+    for (AX_U32 k = 0; k < m_nPoolCount; k++) {
+        AX_CHAR szKey[32] = {0};
+        snprintf(szKey, sizeof(szKey), "BLK_%u", (AX_U32)m_tCommPoolFloorPlan.CommPool[k].BlkSize);
+        AX_S32 nBlkCnt = tProfile.GetIntValue(strSection, szKey, 0);
+        if (nBlkCnt <= 0) {
+            LOG_M_W(POOL, "Pool profile [%s] has no %s, use pool.ini", strSection.c_str(), szKey);
+            return AX_FALSE;
+        }
+
+        arrBlkCnt[k] = (AX_U32)nBlkCnt;
+    }
+
+    for (AX_U32 k = 0; k < m_nPoolCount; k++) {
+        LOG_M_C(POOL, "Pool profile [%s] BlkSize:%llu, BlkCnt: %d -> %d", strSection.c_str(),
+                (AX_U64)m_tCommPoolFloorPlan.CommPool[k].BlkSize, m_tCommPoolFloorPlan.CommPool[k].BlkCnt, arrBlkCnt[k]);
+        m_tCommPoolFloorPlan.CommPool[k].BlkCnt = arrBlkCnt[k];
+    }
+
+    return AX_TRUE;
+}
+
+AX_BOOL CPoolConfig::SaveProfile(AX_VOID) {
+    std::map<AX_U32, AX_U32> mapPlan;
+    CAXPoolManager::GetInstance()->DeriveFloorPlan(COptionHelper::GetInstance()->GetPoolTargetDropRate(), mapPlan);
+
+    std::string strPath = GetProfilePath();
+    std::string strSection = GetProfileSection();
+    if (strPath.empty()) {
+        return AX_FALSE;
+    }
+
+    /* keep sections of other load types and scenarios */
+    CIniWrapper tProfile;
+    tProfile.Load(strPath);
+
+    for (AX_U32 k = 0; k < m_nPoolCount; k++) {
+        AX_U32 nBlkSize = (AX_U32)m_tCommPoolFloorPlan.CommPool[k].BlkSize;
+        auto it = mapPlan.find(nBlkSize);
+        AX_U32 nBlkCnt = (it != mapPlan.end()) ? it->second : m_tCommPoolFloorPlan.CommPool[k].BlkCnt;
+
+        AX_CHAR szKey[32] = {0};
+        snprintf(szKey, sizeof(szKey), "BLK_%u", nBlkSize);
+        tProfile.SetIntValue(strSection, szKey, (AX_S32)nBlkCnt);
+        LOG_M_C(POOL, "Pool profile [%s] BlkSize:%u, BlkCnt: %d -> %d", strSection.c_str(), nBlkSize,
+                m_tCommPoolFloorPlan.CommPool[k].BlkCnt, nBlkCnt);
+    }
+
+    if (!tProfile.Save(strPath)) {
+        LOG_M_E(POOL, "Save pool profile %s fail", strPath.c_str());
+        return AX_FALSE;
+    }
+
+    LOG_M_C(POOL, "Pool profile saved to %s [%s]", strPath.c_str(), strSection.c_str());
+    return AX_TRUE;
+}
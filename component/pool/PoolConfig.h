@@ -42,10 +42,17 @@ private:
     AX_S32 InitPrivatePool();
     AX_VOID MergePrivBlocks();
 
+    /* auto sizing: profile is an ini with section per load type and scenario, BLK_<blkSize> = blkCnt */
+    std::string GetProfilePath(AX_VOID);
+    std::string GetProfileSection(AX_VOID);
+    AX_BOOL ApplyProfile(AX_VOID);
+    AX_BOOL SaveProfile(AX_VOID);
+
 private:
     std::map<AX_U8, POOL_ATTR_T> m_tAttr;
     AX_POOL_FLOORPLAN_T m_tCommPoolFloorPlan;
     AX_POOL_FLOORPLAN_T m_tPrivPoolFloorPlan;
     AX_U32 m_nPoolCount{0};
     AX_U32 m_nPrivPoolCount{0};
+    AX_U32 m_nAutoSizeMode{0};
 };  // namespace class CPoolConfig
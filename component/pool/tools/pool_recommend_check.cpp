@@ -0,0 +1,158 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+/*
+    Check of floor plan recommended by CAXPoolManager, AX_POOL is mocked: a block id carries its pool id in the upper 16 bits.
+
+    stock:      users of the stock ivps.json, VIN channel and IVPS group filter are untracked and share the common pool of
+                a tracked IVPS channel. The pool must shrink to peak + fifo + margin + allowance of each untracked user.
+    untracked:  pool used by untracked users only keeps configured count.
+    cap:        recommendation never exceeds configured count.
+    calibrate:  too few frames or a stage dropping above target rate keeps configured count.
+
+    usage: pool_recommend_check
+*/
+
+#include <stdio.h>
+#include <map>
+#include "AXPoolManager.hpp"
+#include "AppLogApi.h"
+#include "host_tool.h"
+#include "ax_sys_api.h"
+#include "ax_vin_api.h"
+
+#define CHECK_FRAME_NUM (POOL_CALIBRATE_MIN_FRAME_NUM)
+#define CHECK_DROP_RATE (0.01)
+#define CHECK_BLK_ID(pool, n) ((AX_BLK)(((pool) << 16) | ((n)&0xFFFF)))
+
+/* pool manager logs through app log, not shown here */
+AX_VOID AX_APP_LogFmtStr(AX_S32 nLv, const AX_CHAR *pFmt, ...) {
+}
+
+AX_S32 AX_POOL_SetConfig(const AX_POOL_FLOORPLAN_T *pPoolFloorPlan) {
+    return 0;
+}
+
+AX_S32 AX_POOL_Init(AX_VOID) {
+    return 0;
+}
+
+AX_S32 AX_POOL_Exit(AX_VOID) {
+    return 0;
+}
+
+AX_POOL AX_POOL_CreatePool(AX_POOL_CONFIG_T *pPoolConfig) {
+    return AX_INVALID_POOLID;
+}
+
+AX_S32 AX_POOL_DestroyPool(AX_POOL PoolId) {
+    return 0;
+}
+
+AX_POOL AX_POOL_Handle2PoolId(AX_BLK BlockId) {
+    return (AX_POOL)(BlockId >> 16);
+}
+
+AX_U32 AX_VIN_GetImgBufferSize(AX_U32 nHeight, AX_U32 nWidthStride, AX_IMG_FORMAT_E eImgType, AX_FRAME_COMPRESS_INFO_T *ptCompressInfo,
+                               AX_U32 nAlignSize) {
+    return nWidthStride * nHeight * 3 / 2;
+}
+
+typedef struct {
+    AX_U32 nBlkSize;
+    AX_U32 nBlkCnt;
+    AX_POOL nPoolId; /* id returned by mocked AX_POOL_Handle2PoolId */
+} CHECK_POOL_T;
+
+static const CHECK_POOL_T g_arrPools[] = {
+    {1920 * 1088 * 3 / 2, 10, 1},
+    {3840 * 2160 * 3 / 2, 20, 2},
+    {7680 * 2160 * 3 / 2, 6, 3},
+};
+
+/* owner keeps nPeak frames in hand and reports nFifoDepth queued inside SDK */
+static AX_VOID CheckFeed(AX_U32 nOwner, const CHECK_POOL_T &tPool, AX_U32 nPeak, AX_U32 nFifoDepth, AX_U32 nFrames) {
+    CAXPoolManager *pMgr = CAXPoolManager::GetInstance();
+    for (AX_U32 i = 0; i < nFrames; ++i) {
+        pMgr->TrackAcquire(nOwner, CHECK_BLK_ID(tPool.nPoolId, i), tPool.nBlkSize, nFifoDepth);
+        if (i + 1 >= nPeak) {
+            pMgr->TrackRelease(nOwner, CHECK_BLK_ID(tPool.nPoolId, i + 1 - nPeak));
+        }
+    }
+}
+
+static AX_VOID CheckCount(const AX_CHAR *pszCase, AX_U32 nGot, AX_U32 nExpect, AX_BOOL &bOk) {
+    printf("%-10s recommend %3u, expect %3u%s\n", pszCase, nGot, nExpect, (nGot == nExpect) ? "" : "  FAILED");
+    if (nGot != nExpect) {
+        bOk = AX_FALSE;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    CAXPoolManager *pMgr = CAXPoolManager::GetInstance();
+    AX_BOOL bOk = AX_TRUE;
+
+    for (AX_U32 i = 0; i < HOST_TOOL_ARRAY_SIZE(g_arrPools); ++i) {
+        pMgr->AddBlockToFloorPlan(g_arrPools[i].nBlkSize, g_arrPools[i].nBlkCnt);
+    }
+
+    const CHECK_POOL_T &t1080 = g_arrPools[0];
+    const CHECK_POOL_T &t4K = g_arrPools[1];
+    const CHECK_POOL_T &t8K = g_arrPools[2];
+
+    /* registered at pipeline setup as BaseSensor and IVPSGrpStage do */
+    AX_FRAME_COMPRESS_INFO_T tCompress = {AX_COMPRESS_MODE_NONE, 0};
+    pMgr->AddUntrackedUser(POOL_OWNER_ID(POOL_OWNER_MOD_VIN, 0, 0), 3840, 2160, tCompress);
+    pMgr->AddUntrackedUser(POOL_OWNER_ID(POOL_OWNER_MOD_IVPS, 0, POOL_OWNER_CHN_INTERNAL), 3840, 2160, tCompress);
+    pMgr->AddUntrackedUser(POOL_OWNER_ID(POOL_OWNER_MOD_IVPS, 0, 2), 1920, 1088, tCompress);
+    pMgr->AddUntrackedUser(POOL_OWNER_ID(POOL_OWNER_MOD_VIN, 1, 0), 7680, 2160, tCompress);
+
+    pMgr->EnableTracking(AX_TRUE);
+    CheckFeed(POOL_OWNER_ID(POOL_OWNER_MOD_IVPS, 0, 0), t4K, 2, 2, CHECK_FRAME_NUM);
+    CheckFeed(POOL_OWNER_ID(POOL_OWNER_MOD_IVPS, 0, 1), t1080, 1, 1, CHECK_FRAME_NUM);
+
+    std::map<AX_U32, AX_U32> mapPlan;
+    pMgr->DeriveFloorPlan(CHECK_DROP_RATE, mapPlan);
+
+    /* 4K: peak 2 + fifo 2 + margin 1 + VIN and IVPS filter untracked */
+    CheckCount("stock 4K", mapPlan[t4K.nBlkSize], 2 + 2 + POOL_TRACK_MARGIN_BLK_NUM + 2 * POOL_UNTRACKED_BLK_NUM, bOk);
+    /* 1080p: peak 1 + fifo 1 + margin 1 + one link mode channel untracked */
+    CheckCount("stock 1080", mapPlan[t1080.nBlkSize], 1 + 1 + POOL_TRACK_MARGIN_BLK_NUM + POOL_UNTRACKED_BLK_NUM, bOk);
+    CheckCount("untracked", mapPlan[t8K.nBlkSize], t8K.nBlkCnt, bOk);
+
+    POOL_USAGE_T tUsage;
+    tUsage.nBlkSize = t1080.nBlkSize;
+    tUsage.nBlkCnt = t1080.nBlkCnt;
+    POOL_OWNER_USAGE_T &tOwner = tUsage.mapOwner[POOL_OWNER_ID(POOL_OWNER_MOD_IVPS, 1, 0)];
+    tUsage.nPeak = 5;
+    tOwner.nPeak = 5;
+    tOwner.nFifoDepth = 2;
+    tOwner.nAcquire = CHECK_FRAME_NUM;
+    tUsage.vecUntracked.push_back(POOL_OWNER_ID(POOL_OWNER_MOD_VIN, 1, 0));
+    tUsage.vecUntracked.push_back(POOL_OWNER_ID(POOL_OWNER_MOD_IVPS, 1, POOL_OWNER_CHN_INTERNAL));
+    CheckCount("cap", CAXPoolManager::DeriveBlkCnt(tUsage, CHECK_DROP_RATE), tUsage.nBlkCnt, bOk);
+
+    tUsage.nPeak = 1;
+    tOwner.nPeak = 1;
+    tOwner.nFifoDepth = 0;
+    tUsage.vecUntracked.pop_back();
+    CheckCount("calibrated", CAXPoolManager::DeriveBlkCnt(tUsage, CHECK_DROP_RATE), 1 + POOL_TRACK_MARGIN_BLK_NUM + POOL_UNTRACKED_BLK_NUM,
+               bOk);
+
+    tOwner.nAcquire = CHECK_FRAME_NUM - 1;
+    CheckCount("few frames", CAXPoolManager::DeriveBlkCnt(tUsage, CHECK_DROP_RATE), tUsage.nBlkCnt, bOk);
+
+    tOwner.nAcquire = CHECK_FRAME_NUM;
+    tOwner.nDrop = CHECK_FRAME_NUM / 10;
+    CheckCount("dropping", CAXPoolManager::DeriveBlkCnt(tUsage, CHECK_DROP_RATE), tUsage.nBlkCnt, bOk);
+
+    printf("%s\n", bOk ? "PASS" : "FAIL");
+    return bOk ? 0 : 1;
+}
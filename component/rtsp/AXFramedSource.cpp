@@ -19,11 +19,16 @@ AXFramedSource* AXFramedSource::createNew(UsageEnvironment& env, AX_U32 nMaxFrmS
     return new AXFramedSource(env, nMaxFrmSize);
 }
 
+AXFramedSource* AXFramedSource::createNew(UsageEnvironment& env, AX_U32 nMaxFrmSize, std::shared_ptr<CAXStreamBuffer> spStreamBuf) {
+    return new AXFramedSource(env, nMaxFrmSize, spStreamBuf);
+}
+
 EventTriggerId AXFramedSource::eventTriggerId = 0;
 
 unsigned AXFramedSource::referenceCount = 0;
 
-AXFramedSource::AXFramedSource(UsageEnvironment& env, AX_U32 nMaxFrmSize) : FramedSource(env) {
+AXFramedSource::AXFramedSource(UsageEnvironment& env, AX_U32 nMaxFrmSize, std::shared_ptr<CAXStreamBuffer> spStreamBuf /*= nullptr*/)
+    : FramedSource(env) {
     if (referenceCount == 0) {
         // Any global initialization of the device would be done here:
         //%%% TO BE WRITTEN %%%
@@ -31,7 +36,12 @@ AXFramedSource::AXFramedSource(UsageEnvironment& env, AX_U32 nMaxFrmSize) : Fram
     ++referenceCount;
 
     m_nTriggerID = envir().taskScheduler().createEventTrigger(deliverFrame);
-    m_pRingBuf = new CAXRingBufferEx(nMaxFrmSize, COptionHelper::GetInstance()->GetRTSPRingBufCount(), "RTSP");
+    if (spStreamBuf) {
+        /* new client starts from the latest IDR kept in shared buffer */
+        m_pStreamReader = new CAXStreamReader(spStreamBuf);
+    } else {
+        m_pRingBuf = new CAXRingBufferEx(nMaxFrmSize, COptionHelper::GetInstance()->GetRTSPRingBufCount(), "RTSP");
+    }
     m_nMaxFrmSize = nMaxFrmSize;
     // m_pFile = fopen("/opt/data/frm_src_recv_venc_out.h264", "wb");
 }
@@ -41,8 +51,15 @@ AXFramedSource::~AXFramedSource() {
 
     envir().taskScheduler().deleteEventTrigger(m_nTriggerID);
     eventTriggerId = 0;
-    delete (m_pRingBuf);
-    m_pRingBuf = nullptr;
+    if (m_pRingBuf) {
+        delete (m_pRingBuf);
+        m_pRingBuf = nullptr;
+    }
+
+    if (m_pStreamReader) {
+        delete (m_pStreamReader);
+        m_pStreamReader = nullptr;
+    }
 
     // fflush(m_pFile);
     // fclose(m_pFile);
@@ -55,6 +72,10 @@ void AXFramedSource::AddFrameBuff(AX_U8 nChn, const AX_U8* pBuf, AX_U32 nLen, AX
     envir().taskScheduler().triggerEvent(m_nTriggerID, this);
 }
 
+void AXFramedSource::NotifyFrameArrived(void) {
+    envir().taskScheduler().triggerEvent(m_nTriggerID, this);
+}
+
 void AXFramedSource::doGetNextFrame() {
     _deliverFrame();
 }
@@ -68,6 +89,11 @@ void AXFramedSource::_deliverFrame() {
         return;  // we're not ready for the data yet
     }
 
+    if (m_pStreamReader) {
+        _deliverSharedFrame();
+        return;
+    }
+
     CAXRingElementEx* element = m_pRingBuf->Get();
     if (!element) {
         return;
@@ -115,6 +141,38 @@ void AXFramedSource::_deliverFrame() {
     FramedSource::afterGetting(this);
 }
 
+void AXFramedSource::_deliverSharedFrame() {
+    AX_STREAM_PACKET_T tPkt;
+    if (!m_pStreamReader->Get(tPkt)) {
+        return;
+    }
+
+    AX_U32 nNewFrameSize = tPkt.nSize + tPkt.nSize2;
+    if (nNewFrameSize > fMaxSize) {
+        LOG_MM_W(LIVE, "Exceeding max frame size: newFrameSize:%u > fMaxSize:%u", nNewFrameSize, fMaxSize);
+        fFrameSize = fMaxSize;
+        fNumTruncatedBytes = nNewFrameSize - fMaxSize;
+    } else {
+        fFrameSize = nNewFrameSize;
+    }
+    fPresentationTimeSpecified.tv_sec = tPkt.nPts / 1000000;
+    fPresentationTimeSpecified.tv_usec = tPkt.nPts % 1000000;
+
+    /* the only copy on rtsp path: shared buffer -> live555 output buffer */
+    if (fFrameSize <= tPkt.nSize) {
+        memcpy(fTo, tPkt.pBuf, fFrameSize);
+    } else {
+        memcpy(fTo, tPkt.pBuf, tPkt.nSize);
+        memcpy(fTo + tPkt.nSize, tPkt.pBuf2, fFrameSize - tPkt.nSize);
+    }
+
+    m_pStreamReader->Free(tPkt);
+
+    LOG_M_D(LIVE, "Send data to rtsp client, size=%d.", fFrameSize);
+
+    FramedSource::afterGetting(this);
+}
+
 unsigned AXFramedSource::maxFrameSize() const {
     // By default, this source has no maximum frame size.
     return m_nMaxFrmSize;
@@ -11,12 +11,16 @@
 #ifndef __AXFRAMEDSOURCE_H__
 #define __AXFRAMEDSOURCE_H__
 
+#include <memory>
 #include "AXRingBufferEx.h"
+#include "AXStreamBuffer.h"
 #include "FramedSource.hh"
 
 class AXFramedSource : public FramedSource {
 public:
     static AXFramedSource* createNew(UsageEnvironment& env, AX_U32 nMaxFrmSize);
+    /* read frames from shared stream buffer of encoder instead of private ring */
+    static AXFramedSource* createNew(UsageEnvironment& env, AX_U32 nMaxFrmSize, std::shared_ptr<CAXStreamBuffer> spStreamBuf);
 
 public:
     static EventTriggerId eventTriggerId;
@@ -24,10 +28,14 @@ public:
     // encapsulate a *single* device - not a set of devices.
     // You can, however, redefine this to be a non-static member variable.
     void AddFrameBuff(AX_U8 nChn, const AX_U8* pBuf, AX_U32 nLen, AX_U64 nPts = 0, AX_BOOL bIFrame = AX_FALSE);
+    void NotifyFrameArrived(void);
+    AX_BOOL IsStreamShared(void) const {
+        return m_pStreamReader ? AX_TRUE : AX_FALSE;
+    }
     virtual unsigned maxFrameSize() const;
 
 protected:
-    AXFramedSource(UsageEnvironment& env, AX_U32 nMaxFrmSize);
+    AXFramedSource(UsageEnvironment& env, AX_U32 nMaxFrmSize, std::shared_ptr<CAXStreamBuffer> spStreamBuf = nullptr);
     // called only by createNew(), or by subclass constructors
     virtual ~AXFramedSource();
 
@@ -39,10 +47,12 @@ private:
 private:
     static void deliverFrame(void* clientData);
     void _deliverFrame();
+    void _deliverSharedFrame();
 
 private:
     static unsigned referenceCount;  // used to count how many instances of this class currently exist
-    CAXRingBufferEx* m_pRingBuf;
+    CAXRingBufferEx* m_pRingBuf{nullptr};
+    CAXStreamReader* m_pStreamReader{nullptr};
     AX_U32 m_nMaxFrmSize;
 
     u_int32_t m_nTriggerID;
@@ -12,8 +12,8 @@
 #include <GroupsockHelper.hh>
 
 AXLiveServerMediaSession* AXLiveServerMediaSession::createNewVideo(UsageEnvironment& env, bool reuseFirstSource, AX_PAYLOAD_TYPE_E ePt,
-                                                                   AX_U32 nMaxFrmSize, AX_U32 nBitRate) {
-    return new AXLiveServerMediaSession(env, reuseFirstSource, ePt, nMaxFrmSize, nBitRate, 0, 0, 0);
+                                                                   AX_U32 nMaxFrmSize, AX_U32 nBitRate, AX_S32 nStreamChn) {
+    return new AXLiveServerMediaSession(env, reuseFirstSource, ePt, nMaxFrmSize, nBitRate, 0, 0, 0, nStreamChn);
 }
 
 AXLiveServerMediaSession* AXLiveServerMediaSession::createNewAudio(UsageEnvironment& env, bool reuseFirstSource, AX_PAYLOAD_TYPE_E ePt,
@@ -22,7 +22,7 @@ AXLiveServerMediaSession* AXLiveServerMediaSession::createNewAudio(UsageEnvironm
     return new AXLiveServerMediaSession(env, reuseFirstSource, ePt, nMaxFrmSize, nBitRate, nSampleRate, nChnCnt, nAOT);
 }
 AXLiveServerMediaSession::AXLiveServerMediaSession(UsageEnvironment& env, bool reuseFirstSource, AX_PAYLOAD_TYPE_E ePt, AX_U32 nMaxFrmSize,
-                                                   AX_U32 nBitRate, AX_U32 nSampleRate, AX_U8 nChnCnt, AX_S32 nAOT)
+                                                   AX_U32 nBitRate, AX_U32 nSampleRate, AX_U8 nChnCnt, AX_S32 nAOT, AX_S32 nStreamChn)
     : OnDemandServerMediaSubsession(env, reuseFirstSource),
       m_ePt(ePt),
       m_nMaxFrmBuffSize(nMaxFrmSize),
@@ -37,7 +37,8 @@ AXLiveServerMediaSession::AXLiveServerMediaSession(UsageEnvironment& env, bool r
       m_pIFrameBuf(NULL),
       m_nIFrameChn(0),
       m_nIFrameSize(0),
-      m_nIFramePts(0){
+      m_nIFramePts(0),
+      m_nStreamChn(nStreamChn) {
     pthread_spin_init(&m_tLock, 0);
     m_pIFrameBuf = new AX_U8[nMaxFrmSize];
 
@@ -109,10 +110,12 @@ FramedSource* AXLiveServerMediaSession::createNewStreamSource(unsigned clientSes
     // Based on encoder configuration i kept it 90000
     estBitRate = m_nBitRate;
 
-    AXFramedSource* source = AXFramedSource::createNew(envir(), m_nMaxFrmBuffSize);
+    std::shared_ptr<CAXStreamBuffer> spStreamBuf = GetSharedStream();
+    AXFramedSource* source = spStreamBuf ? AXFramedSource::createNew(envir(), m_nMaxFrmBuffSize, spStreamBuf)
+                                         : AXFramedSource::createNew(envir(), m_nMaxFrmBuffSize);
     pthread_spin_lock(&m_tLock);
     m_pSource = source;
-    if (m_pIFrameBuf && m_nIFrameSize > 0) {
+    if (!spStreamBuf && m_pIFrameBuf && m_nIFrameSize > 0) {
         m_pSource->AddFrameBuff(m_nIFrameChn, m_pIFrameBuf, m_nIFrameSize, m_nIFramePts, AX_TRUE);
     }
     pthread_spin_unlock(&m_tLock);
@@ -168,9 +171,26 @@ RTPSink* AXLiveServerMediaSession::createNewRTPSink(Groupsock* rtpGroupsock, uns
     return nullptr;
 }
 
+std::shared_ptr<CAXStreamBuffer> AXLiveServerMediaSession::GetSharedStream(AX_VOID) {
+    if (m_nStreamChn < 0) {
+        return nullptr;
+    }
+
+    return CAXStreamBufferMgr::GetInstance()->Get(m_nStreamChn);
+}
+
 void AXLiveServerMediaSession::SendNalu(AX_U8 nChn, const AX_U8* pBuf, AX_U32 nLen, AX_U64 nPts /*=0*/, AX_BOOL bIFrame /*=AX_FALSE*/) {
+    /* latest IDR is kept by shared stream buffer, no private copy needed */
+    AX_BOOL bKeepIFrame = (bIFrame && !GetSharedStream()) ? AX_TRUE : AX_FALSE;
+
     pthread_spin_lock(&m_tLock);
-    if (bIFrame && nLen < m_nMaxFrmBuffSize && nLen > 0) {
+    if (m_pSource && m_pSource->IsStreamShared()) {
+        m_pSource->NotifyFrameArrived();
+        pthread_spin_unlock(&m_tLock);
+        return;
+    }
+
+    if (bKeepIFrame && nLen < m_nMaxFrmBuffSize && nLen > 0) {
         memcpy(m_pIFrameBuf, pBuf, nLen);
         m_nIFrameSize = nLen;
         m_nIFramePts = nPts;
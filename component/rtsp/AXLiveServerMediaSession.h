@@ -21,7 +21,7 @@
 class AXLiveServerMediaSession : public OnDemandServerMediaSubsession {
 public:
     static AXLiveServerMediaSession* createNewVideo(UsageEnvironment& env, bool reuseFirstSource, AX_PAYLOAD_TYPE_E ePt = PT_H264,
-                                                    AX_U32 nMaxFrmSize = 700000, AX_U32 nBitRate = 48000);
+                                                    AX_U32 nMaxFrmSize = 700000, AX_U32 nBitRate = 48000, AX_S32 nStreamChn = -1);
     static AXLiveServerMediaSession* createNewAudio(UsageEnvironment& env, bool reuseFirstSource, AX_PAYLOAD_TYPE_E ePt = PT_AAC,
                                                     AX_U32 nMaxFrmSize = 8192, AX_U32 nBitRate = 48000, AX_U32 nSampleRate = 16000,
                                                     AX_U8 nChnCnt = 1, AX_S32 nAOT = 1);
@@ -31,7 +31,7 @@ public:
 
 protected:
     AXLiveServerMediaSession(UsageEnvironment& env, bool reuseFirstSource, AX_PAYLOAD_TYPE_E ePt, AX_U32 nMaxFrmSize, AX_U32 nBitRate,
-                             AX_U32 nSampleRate, AX_U8 nChnCnt, AX_S32 nAOT);
+                             AX_U32 nSampleRate, AX_U8 nChnCnt, AX_S32 nAOT, AX_S32 nStreamChn = -1);
     virtual ~AXLiveServerMediaSession(void);
     void setDoneFlag() {
         fDoneFlag = ~0;
@@ -44,6 +44,9 @@ protected:
     virtual void closeStreamSource(FramedSource* inputSource);
     virtual char const* sdpLines();
 
+private:
+    std::shared_ptr<CAXStreamBuffer> GetSharedStream(AX_VOID);
+
 private:
     AX_PAYLOAD_TYPE_E m_ePt{PT_H264};
     AX_U32 m_nMaxFrmBuffSize;
@@ -60,6 +63,8 @@ private:
     AX_U8  m_nIFrameChn;
     AX_U32  m_nIFrameSize;
     AX_U64  m_nIFramePts;
+    /* venc channel of shared stream buffer, -1: not shared */
+    AX_S32  m_nStreamChn;
 };
 
 #endif /*__AXLIVESEVERMEDIASESSION_H__*/
@@ -129,7 +129,7 @@ AX_VOID CAXRtspServer::RtspServerThreadFunc() {
             nMaxFrmSize = m_vecMediaSessionAttr[i].stVideoAttr.nMaxFrmSize;
             nBitRate = m_vecMediaSessionAttr[i].stVideoAttr.nBitRate;
             m_pMediaSession[nChannel][RTSP_SESS_MEDIA_VIDEO] =
-                AXLiveServerMediaSession::createNewVideo(*m_pUEnv, true, ePt, nMaxFrmSize, nBitRate);
+                AXLiveServerMediaSession::createNewVideo(*m_pUEnv, true, ePt, nMaxFrmSize, nBitRate, nChannel);
             sms->addSubsession(m_pMediaSession[nChannel][RTSP_SESS_MEDIA_VIDEO]);
         }
         if (m_vecMediaSessionAttr[i].stAudioAttr.bEnable) {
@@ -226,7 +226,7 @@ AX_VOID CAXRtspServer::DoRestartSessions(AX_VOID) {
             AX_U32 nMaxFrmSize = m_vecMediaSessionAttr[i].stVideoAttr.nMaxFrmSize;
             AX_U32 nBitRate = m_vecMediaSessionAttr[i].stVideoAttr.nBitRate;
             m_pMediaSession[nChannel][RTSP_SESS_MEDIA_VIDEO] =
-                AXLiveServerMediaSession::createNewVideo(*m_pUEnv, true, ePt, nMaxFrmSize, nBitRate);
+                AXLiveServerMediaSession::createNewVideo(*m_pUEnv, true, ePt, nMaxFrmSize, nBitRate, nChannel);
             sms->addSubsession(m_pMediaSession[nChannel][RTSP_SESS_MEDIA_VIDEO]);
         }
 
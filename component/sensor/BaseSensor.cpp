@@ -15,6 +15,7 @@
 #include "AppLogApi.h"
 #include "CommonUtils.hpp"
 #include "ElapsedTimer.hpp"
+#include "AXPoolManager.hpp"
 #include "AXTypeConverter.hpp"
 #include "SensorOptionHelper.h"
 #include "SoftPhotoSensitivity.h"
@@ -589,6 +590,10 @@ AX_BOOL CBaseSensor::OpenAll() {
                         } else {
                             LOG_M_C(SENSOR, "Pipe[%d] AX_VIN_EnableChn[%d]", nPipeID, j);
                         }
+
+                        /* ISP output and link buffers are held inside VIN, only frames got by app are tracked */
+                        CAXPoolManager::GetInstance()->AddUntrackedUser(POOL_OWNER_ID(POOL_OWNER_MOD_VIN, nPipeID, j),
+                                                                        tChnAttr.nWidthStride, tChnAttr.nHeight, tChnAttr.tCompressInfo);
                     }
                 }
             }
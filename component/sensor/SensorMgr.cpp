@@ -12,6 +12,8 @@
 #include <math.h>
 #include <dlfcn.h>
 #include <sys/prctl.h>
+#include "AXFramePool.hpp"
+#include "AXPoolManager.hpp"
 #include "AppLogApi.h"
 #include "ElapsedTimer.hpp"
 #include "FramerateCtrlHelper.h"
@@ -448,8 +450,14 @@ AX_VOID CSensorMgr::NotifyAll(AX_S32 nPipe, AX_U32 nChannel, AX_VOID* pFrame) {
         return;
     }
 
+    /* frame may be released by last observer, do not touch it after callbacks */
+    CLatencyHistogram* pNotify = CLatencyTracer::GetInstance()->GetHistogram(((CAXFrame*)pFrame)->tTrail.GetSource(), LATENCY_HIST_NOTIFY);
     for (vector<IObserver*>::iterator it = m_mapObservers[nPipe][nChannel].begin(); it != m_mapObservers[nPipe][nChannel].end(); it++) {
+        AX_U64 nStart = pNotify ? CLatencyTracer::NowUs() : 0;
         (*it)->OnRecvData(E_OBS_TARGET_TYPE_VIN, nPipe, nChannel, pFrame);
+        if (pNotify) {
+            pNotify->Record(CLatencyTracer::NowUs() - nStart);
+        }
     }
 }
 
@@ -458,27 +466,26 @@ AX_VOID CSensorMgr::VideoFrameRelease(CAXFrame* pAXFrame) {
         AX_U32 nPipe = pAXFrame->nGrp;
         AX_U32 nChn = pAXFrame->nChn;
 
-        m_mtxFrame[nPipe][nChn].lock();
-        for (list<CAXFrame*>::iterator it = m_qFrame[nPipe][nChn].begin(); it != m_qFrame[nPipe][nChn].end(); it++) {
-            if ((*it)->nGrp == pAXFrame->nGrp && (*it)->nChn == pAXFrame->nChn &&
-                (*it)->stFrame.stVFrame.stVFrame.u64SeqNum == pAXFrame->stFrame.stVFrame.stVFrame.u64SeqNum) {
-                if (!pAXFrame->bMultiplex || (*it)->DecFrmRef() == 0) {
-                    AX_VIN_ReleaseYuvFrame(nPipe, (AX_VIN_CHN_ID_E)nChn, (AX_IMG_INFO_T*)(*it)->pUserDefine);
-                    LOG_MM_D(SNS_MGR, "[%d][%d] AX_VIN_ReleaseYuvFrame, seq:%lld, addr:%p", nPipe, nChn,
-                             pAXFrame->stFrame.stVFrame.stVFrame.u64SeqNum, pAXFrame->pUserDefine);
-
-                    AX_IMG_INFO_T* pIspImg = (AX_IMG_INFO_T*)(*it)->pUserDefine;
-
-                    SAFE_DELETE_PTR(pIspImg);
-                    SAFE_DELETE_PTR((*it));
-
-                    m_qFrame[nPipe][nChn].erase(it);
-                }
+        /* frame of handle is the one got by YuvGetThreadFunc, O(1) instead of searching frames in flight */
+        CAXFramePool<AX_IMG_INFO_T>& tFramePool = m_arrFramePool[nPipe][nChn];
+        CAXFrame* pOrigin = tFramePool.Get(pAXFrame->nPoolHandle);
+        if (!pOrigin) {
+            LOG_MM_W(SNS_MGR, "[%d][%d] release stale frame, seq:%lld", nPipe, nChn, pAXFrame->stFrame.stVFrame.stVFrame.u64SeqNum);
+            return;
+        }
 
-                break;
+        if (!pOrigin->bMultiplex || pOrigin->DecFrmRef() == 0) {
+            if (CAXPoolManager::GetInstance()->IsTracking()) {
+                CAXPoolManager::GetInstance()->TrackRelease(POOL_OWNER_ID(POOL_OWNER_MOD_VIN, nPipe, nChn),
+                                                            pOrigin->stFrame.stVFrame.stVFrame.u32BlkId[0]);
             }
+            CLatencyTracer::GetInstance()->Collect(pOrigin->tTrail);
+            AX_VIN_ReleaseYuvFrame(nPipe, (AX_VIN_CHN_ID_E)nChn, (AX_IMG_INFO_T*)pOrigin->pUserDefine);
+            LOG_MM_D(SNS_MGR, "[%d][%d] AX_VIN_ReleaseYuvFrame, seq:%lld, addr:%p", nPipe, nChn,
+                     pOrigin->stFrame.stVFrame.stVFrame.u64SeqNum, pOrigin->pUserDefine);
+
+            tFramePool.Release(pOrigin);
         }
-        m_mtxFrame[nPipe][nChn].unlock();
     }
 }
 
@@ -494,6 +501,19 @@ AX_VOID CSensorMgr::RawDispatchThreadFunc(RAW_DISPATCH_THREAD_PARAM_T* pThreadPa
     sprintf(szName, "APP_RAW_DISP_%d", nPipeID);
     prctl(PR_SET_NAME, szName);
 
+    /* frames queued inside VIN chn, for pool accounting */
+    AX_U32 nYuvDepth = 0;
+    CBaseSensor* pSensor = GetSnsInstance(nSnsID);
+    if (pSensor) {
+        const SENSOR_CONFIG_T& tSnsCfg = pSensor->GetSnsConfig();
+        for (AX_U32 i = 0; i < tSnsCfg.nPipeCount && i < MAX_PIPE_PER_DEVICE; ++i) {
+            if (tSnsCfg.arrPipeAttr[i].nPipeID == nPipe) {
+                nYuvDepth = tSnsCfg.arrPipeAttr[i].arrChannelAttr[nChn].nYuvDepth;
+                break;
+            }
+        }
+    }
+
     AX_S32 nRet = 0;
     m_bGetFrameFlag[nSnsID] = AX_TRUE;
     pThreadParam->bThreadRunning = AX_TRUE;
@@ -569,6 +589,28 @@ AX_VOID CSensorMgr::YuvGetThreadFunc(YUV_THREAD_PARAM_T* pThreadParam) {
     sprintf(szName, "APP_YUV_Get_%d_%d", nPipe, nChn);
     prctl(PR_SET_NAME, szName);
 
+    AX_U16 nTracePoint = CLatencyTracer::GetInstance()->RegisterPoint("VIN_" + std::to_string(nPipe) + "_" + std::to_string(nChn));
+
+    /* frames queued inside VIN chn, for pool accounting */
+    AX_U32 nYuvDepth = 0;
+    CBaseSensor* pSensor = GetSnsInstance(nSnsID);
+    if (pSensor) {
+        const SENSOR_CONFIG_T& tSnsCfg = pSensor->GetSnsConfig();
+        for (AX_U32 i = 0; i < tSnsCfg.nPipeCount && i < MAX_PIPE_PER_DEVICE; ++i) {
+            if (tSnsCfg.arrPipeAttr[i].nPipeID == nPipe) {
+                nYuvDepth = tSnsCfg.arrPipeAttr[i].arrChannelAttr[nChn].nYuvDepth;
+                break;
+            }
+        }
+    }
+
+    /* pool is kept after thread exits, frames may still be held by observers */
+    CAXFramePool<AX_IMG_INFO_T>& tFramePool = m_arrFramePool[nPipe][nChn];
+    if (!tFramePool.IsInited() && !tFramePool.Init(SNS_YUV_INFLIGHT_FRAME_NUM)) {
+        LOG_MM_E(SNS_MGR, "[%d][%d] init frame pool failed", nPipe, nChn);
+        return;
+    }
+
     AX_S32 nRet = 0;
     m_bGetFrameFlag[nSnsID] = AX_TRUE;
     pThreadParam->bThreadRunning = AX_TRUE;
@@ -577,20 +619,21 @@ AX_VOID CSensorMgr::YuvGetThreadFunc(YUV_THREAD_PARAM_T* pThreadParam) {
             CElapsedTimer::GetInstance()->mSleep(10);
             continue;
         }
-        AX_IMG_INFO_T* pVinImg = new (std::nothrow) AX_IMG_INFO_T();
-        if (nullptr == pVinImg) {
-            LOG_M_E(SNS_MGR, "Allocate buffer for YuvGetThread failed.");
-            CElapsedTimer::GetInstance()->mSleep(10);
-            continue;
+        /* all frames are in flight: still get the frame to keep VIN fifo fresh, then drop it */
+        AX_IMG_INFO_T tDropImg;
+        AX_IMG_INFO_T* pVinImg = nullptr;
+        CAXFrame* pAXFrame = tFramePool.Acquire(&pVinImg);
+        if (!pAXFrame) {
+            pVinImg = &tDropImg;
         }
 
         nRet = AX_VIN_GetYuvFrame(nPipe, (AX_VIN_CHN_ID_E)nChn, pVinImg, 1000);
         if (AX_SUCCESS != nRet) {
             if (pThreadParam->bThreadRunning) {
                 LOG_M_E(SNS_MGR, "[%d][%d] AX_VIN_GetYuvFrame failed, ret=0x%x, unreleased buffer=%d", nPipe, nChn, nRet,
-                        m_qFrame[nPipe][nChn].size());
+                        tFramePool.GetUsedCount());
             }
-            SAFE_DELETE_PTR(pVinImg);
+            tFramePool.Release(pAXFrame);
             continue;
         }
 
@@ -601,11 +644,21 @@ AX_VOID CSensorMgr::YuvGetThreadFunc(YUV_THREAD_PARAM_T* pThreadParam) {
 
         ///////////////////////////// DEBUG DATA //////////////////////////////////
         // AX_VIN_ReleaseYuvFrame(nPipe, (AX_VIN_CHN_ID_E)nChn, pVinImg);
-        // SAFE_DELETE_PTR(pVinImg);
+        // tFramePool.Release(pAXFrame);
         // continue;
         ///////////////////////////////////////////////////////////////
 
-        CAXFrame* pAXFrame = new (std::nothrow) CAXFrame();
+        if (!pAXFrame) {
+            LOG_MM_W(SNS_MGR, "[%d][%d] %d frames in flight, drop this frame", nPipe, nChn, tFramePool.GetUsedCount());
+            if (CAXPoolManager::GetInstance()->IsTracking()) {
+                CAXPoolManager::GetInstance()->TrackDrop(POOL_OWNER_ID(POOL_OWNER_MOD_VIN, nPipe, nChn),
+                                                         pVinImg->tFrameInfo.stVFrame.u32BlkId[0],
+                                                         pVinImg->tFrameInfo.stVFrame.u32FrameSize);
+            }
+            AX_VIN_ReleaseYuvFrame(nPipe, (AX_VIN_CHN_ID_E)nChn, pVinImg);
+            continue;
+        }
+
         pAXFrame->nGrp = nPipe;
         pAXFrame->nChn = nChn;
         pAXFrame->stFrame.stVFrame = pVinImg->tFrameInfo;
@@ -614,25 +667,21 @@ AX_VOID CSensorMgr::YuvGetThreadFunc(YUV_THREAD_PARAM_T* pThreadParam) {
         /* Here, we can not determine bMultiplex flag according to number of observers, because each observer must filter frames by target
          * pipe & channel */
         pAXFrame->bMultiplex = pThreadParam->bMultiplex;
-
-        m_mtxFrame[nPipe][nChn].lock();
-        if (m_qFrame[nPipe][nChn].size() >= 5) {
-            LOG_MM_W(SNS_MGR, "[%d][%d] queue size is %d, drop this frame", nPipe, nChn, m_qFrame[nPipe][nChn].size());
-            AX_VIN_ReleaseYuvFrame(nPipe, (AX_VIN_CHN_ID_E)nChn, pVinImg);
-            SAFE_DELETE_PTR(pVinImg);
-            SAFE_DELETE_PTR(pAXFrame);
-
-            m_mtxFrame[nPipe][nChn].unlock();
-            continue;
+        if (CLatencyTracer::GetInstance()->IsEnabled()) {
+            pAXFrame->tTrail.Start(nTracePoint, pVinImg->tFrameInfo.stVFrame.u64SeqNum, CLatencyTracer::NowUs());
         }
 
-        m_qFrame[nPipe][nChn].push_back(pAXFrame);
-        m_mtxFrame[nPipe][nChn].unlock();
+        if (CAXPoolManager::GetInstance()->IsTracking()) {
+            CAXPoolManager::GetInstance()->TrackAcquire(POOL_OWNER_ID(POOL_OWNER_MOD_VIN, nPipe, nChn),
+                                                        pVinImg->tFrameInfo.stVFrame.u32BlkId[0],
+                                                        pVinImg->tFrameInfo.stVFrame.u32FrameSize, nYuvDepth);
+        }
 
         NotifyAll(nPipe, nChn, pAXFrame);
     }
 
-    LOG_MM(SNS_MGR, "[%d][%d] ---", nPipe, nChn);
+    LOG_MM(SNS_MGR, "[%d][%d] --- frame pool peak %d/%d, exhausted %lld", nPipe, nChn, tFramePool.GetPeakCount(), tFramePool.GetCapacity(),
+           tFramePool.GetExhaustedCount());
 }
 
 CBaseSensor* CSensorMgr::GetSnsInstance(AX_U32 nIndex) {
@@ -17,6 +17,7 @@
 #include "condition_variable.hpp"
 #include "GlobalDef.h"
 #include "AXFrame.hpp"
+#include "AXFramePool.hpp"
 #include "BaseLinkage.h"
 #include "BaseSensor.h"
 #include "IModule.h"
@@ -24,6 +25,8 @@
 
 #define MAX_SENSOR_COUNT (3)
 #define MAX_PIPE_PER_DEV (3)
+/* yuv frames of one pipe chn held by observers, more frames got from VIN are dropped */
+#define SNS_YUV_INFLIGHT_FRAME_NUM (5)
 
 typedef struct _RAW_DISPATCH_THREAD_PARAM {
     AX_U8 nSnsID;
@@ -183,8 +186,8 @@ private:
     std::map<AX_U32, std::map<AX_U32, YUV_THREAD_PARAM_T>> m_mapYuvThreadParams;
     std::map<AX_U32, std::map<AX_U32, AX_BOOL>> m_mapChnLinkable;
 
-    list<CAXFrame*> m_qFrame[MAX_SENSOR_COUNT * MAX_PIPE_PER_DEVICE][AX_VIN_CHN_ID_MAX];
-    mutex m_mtxFrame[MAX_SENSOR_COUNT * MAX_PIPE_PER_DEVICE][AX_VIN_CHN_ID_MAX];
+    /* yuv frames in flight of each pipe chn, handle of frame indexes its slot */
+    CAXFramePool<AX_IMG_INFO_T> m_arrFramePool[MAX_SENSOR_COUNT * MAX_PIPE_PER_DEVICE][AX_VIN_CHN_ID_MAX];
     AX_BOOL m_bGetFrameFlag[MAX_SENSOR_COUNT]{AX_FALSE};
 
     AX_VOID* m_pNtCrtlLib{nullptr};
@@ -9,26 +9,30 @@
  **************************************************************************************************/
 
 #include "AXStage.hpp"
+#include "AppLogApi.h"
 using namespace std;
 
+#define STAGE "STAGE"
+
+/* upper bound of one wait of STAGE_DROP_POLICY_BLOCK, the stage thread normally wakes producers earlier */
+#define STAGE_BLOCK_WAIT_MS (20)
+
 AX_VOID CAXStage::StageThreadFunc(AX_VOID* pArg) {
     while (m_StageThread.IsRunning()) {
         CAXFrame* pFrame{nullptr};
-        if (!m_qFrame.Pop(pFrame, -1)) {
+        if (!m_qFrame->Pop(pFrame, -1)) {
             continue;
         }
 
+        NotifySpace(AX_FALSE);
         if (!pFrame) {
             continue;
         }
 
+        CLatencyTracer::GetInstance()->OnDequeue(pFrame->tTrail, m_nTracePoint);
         if (ProcessFrame(pFrame)) {
-            CAXStage* pNextStage = GetNextStage();
-            if (pNextStage) {
-                if (pNextStage->EnqueueFrame(pFrame)) {
-                    continue;
-                }
-            }
+            DispatchFrame(0, pFrame);
+            continue;
         }
 
         pFrame->FreeMem();
@@ -36,6 +40,12 @@ AX_VOID CAXStage::StageThreadFunc(AX_VOID* pArg) {
 }
 
 CAXStage::CAXStage(const string& strName) : m_strStageName(strName) {
+    m_spEdges = std::make_shared<const vector<STAGE_EDGE_T>>();
+    m_qFrame = CreateAXLockQ<CAXFrame*>(m_eQueueType);
+    if (!m_qFrame) {
+        LOG_M_E(STAGE, "%s: create frame queue fail", strName.c_str());
+    }
+    m_nTracePoint = CLatencyTracer::GetInstance()->RegisterPoint(strName);
 }
 
 CAXStage::~CAXStage() {
@@ -43,13 +53,18 @@ CAXStage::~CAXStage() {
 }
 
 AX_BOOL CAXStage::Init(AX_VOID) {
-    return AX_TRUE;
+    /* queue is created by ctor, which can not fail */
+    return m_qFrame ? AX_TRUE : AX_FALSE;
 }
 
 AX_BOOL CAXStage::DeInit(AX_VOID) {
+    if (!m_qFrame) {
+        return AX_TRUE;
+    }
+
     do {
         CAXFrame* pFrame{nullptr};
-        if (!m_qFrame.Pop(pFrame, 0)) {
+        if (!m_qFrame->Pop(pFrame, 0)) {
             break;
         }
         if (pFrame) {
@@ -69,11 +84,16 @@ AX_BOOL CAXStage::Start(AX_VOID) {
 }
 
 AX_BOOL CAXStage::Start(STAGE_START_PARAM_PTR pStartParams) {
-    if (m_StageThread.IsRunning()) {
+    if (m_StageThread.IsRunning() || !m_qFrame) {
         return AX_FALSE;
     }
 
     if (pStartParams && pStartParams->bStartProcessingThread) {
+        /* producers may be added after queue type is selected, e.g. observers registered by builder */
+        if (!SetQueueType(m_eQueueType)) {
+            return AX_FALSE;
+        }
+
         if (!m_StageThread.Start([this](AX_VOID* pArg) -> AX_VOID { StageThreadFunc(pArg); }, nullptr, m_strStageName.c_str())) {
             return AX_FALSE;
         }
@@ -84,17 +104,126 @@ AX_BOOL CAXStage::Start(STAGE_START_PARAM_PTR pStartParams) {
 
 AX_BOOL CAXStage::Stop(AX_VOID) {
     m_StageThread.Stop();
-    m_qFrame.Wakeup();
+    if (m_qFrame) {
+        m_qFrame->Wakeup();
+    }
+    NotifySpace(AX_TRUE);
     m_StageThread.Join();
 
     return AX_TRUE;
 }
 
 AX_BOOL CAXStage::EnqueueFrame(CAXFrame* pFrame) {
-    if (!m_StageThread.IsRunning() || !m_qFrame.Push(pFrame)) {
+    return EnqueueFrame(pFrame, STAGE_DROP_POLICY_NEWEST);
+}
+
+AX_BOOL CAXStage::EnqueueFrame(CAXFrame* pFrame, STAGE_DROP_POLICY_E ePolicy) {
+    CLatencyTracer::GetInstance()->OnEnqueue(pFrame->tTrail, m_nTracePoint);
+    if (!m_StageThread.IsRunning()) {
+        pFrame->FreeMem();
+        return AX_FALSE;
+    }
+
+    if (m_qFrame->Push(pFrame)) {
+        return AX_TRUE;
+    }
+
+    /* lock-free queues allow only one consumer, the stage thread, so oldest frame can not be popped here */
+    if (STAGE_DROP_POLICY_OLDEST == ePolicy && AX_APP_LOCKQ_TYPE_MUTEX == m_eQueueType) {
+        CAXFrame* pOldest{nullptr};
+        if (m_qFrame->Pop(pOldest, 0) && pOldest) {
+            pOldest->FreeMem();
+            m_nDropCount++;
+        }
+        if (m_qFrame->Push(pFrame)) {
+            return AX_TRUE;
+        }
+    } else if (STAGE_DROP_POLICY_BLOCK == ePolicy) {
+        std::unique_lock<std::mutex> lck(m_mtxSpace);
+        m_nBlockedProducers++;
+        while (m_StageThread.IsRunning()) {
+            if (m_qFrame->Push(pFrame)) {
+                m_nBlockedProducers--;
+                return AX_TRUE;
+            }
+            m_cvSpace.wait_for(lck, std::chrono::milliseconds(STAGE_BLOCK_WAIT_MS));
+        }
+        m_nBlockedProducers--;
+    }
+
+    m_nDropCount++;
+    pFrame->FreeMem();
+    return AX_FALSE;
+}
+
+AX_BOOL CAXStage::AcceptFrame(CAXFrame* pFrame) {
+    return AX_TRUE;
+}
+
+AX_VOID CAXStage::NotifySpace(AX_BOOL bForce) {
+    if (bForce || m_nBlockedProducers.load() > 0) {
+        std::lock_guard<std::mutex> lck(m_mtxSpace);
+        m_cvSpace.notify_all();
+    }
+}
+
+std::shared_ptr<const vector<STAGE_EDGE_T>> CAXStage::GetEdges(AX_VOID) {
+    std::lock_guard<std::mutex> lck(m_mtxEdges);
+    return m_spEdges;
+}
+
+AX_VOID CAXStage::DeliverEdge(const STAGE_EDGE_T& tEdge, CAXFrame* pFrame) {
+    if (!tEdge.pNext->AcceptFrame(pFrame)) {
+        pFrame->FreeMem();
+        return;
+    }
+
+    tEdge.pNext->EnqueueFrame(pFrame, tEdge.ePolicy);
+}
+
+AX_BOOL CAXStage::HasNextStage(AX_U32 nPort) {
+    return GetNextStageCount(nPort) > 0 ? AX_TRUE : AX_FALSE;
+}
+
+AX_VOID CAXStage::DeliverToEdges(AX_U32 nPort, CAXFrame* pFrame) {
+    std::shared_ptr<const vector<STAGE_EDGE_T>> spEdges = GetEdges();
+    for (auto& tEdge : *spEdges) {
+        if (tEdge.nPort == nPort) {
+            pFrame->IncFrmRef();
+            DeliverEdge(tEdge, pFrame);
+        }
+    }
+}
+
+AX_BOOL CAXStage::DispatchFrame(AX_U32 nPort, CAXFrame* pFrame) {
+    std::shared_ptr<const vector<STAGE_EDGE_T>> spEdges = GetEdges();
+    const STAGE_EDGE_T* pOnly{nullptr};
+    AX_U32 nCount = 0;
+    for (auto& tEdge : *spEdges) {
+        if (tEdge.nPort == nPort) {
+            pOnly = &tEdge;
+            nCount++;
+        }
+    }
+
+    if (0 == nCount) {
         pFrame->FreeMem();
         return AX_FALSE;
     }
+
+    if (1 == nCount) {
+        DeliverEdge(*pOnly, pFrame);
+        return AX_TRUE;
+    }
+
+    /* one shared reference per edge, same scheme as observer notification, no copy of frame */
+    if (!pFrame->bMultiplex) {
+        pFrame->IncFrmRef();
+    }
+    pFrame->bMultiplex = AX_TRUE;
+    DeliverToEdges(nPort, pFrame);
+    pFrame->FreeMem();
+
     return AX_TRUE;
 }
 
@@ -102,17 +231,92 @@ AX_BOOL CAXStage::ProcessFrame(CAXFrame* pFrame) {
     return AX_TRUE;
 }
 
-CAXStage* CAXStage::BindNextStage(CAXStage* pNext) {
-    if (!pNext) {
+CAXStage* CAXStage::BindNextStage(CAXStage* pNext, AX_U32 nPort /* = 0 */, STAGE_DROP_POLICY_E ePolicy /* = STAGE_DROP_POLICY_NEWEST */) {
+    if (!pNext || pNext == this || ePolicy >= STAGE_DROP_POLICY_BUTT) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtxEdges);
+    for (auto& tEdge : *m_spEdges) {
+        if (tEdge.nPort == nPort && tEdge.pNext == pNext) {
+            return nullptr;
+        }
+    }
+
+    /* queue of a running stage can not be switched, a second producer would break its SPSC queue */
+    if (AX_APP_LOCKQ_TYPE_SPSC == pNext->GetQueueType() && pNext->m_StageThread.IsRunning() && pNext->GetProducerCount() > 0) {
+        LOG_M_E(STAGE, "%s: can not bind to running %s, its SPSC queue allows one producer only", m_strStageName.c_str(),
+                pNext->GetStageName().c_str());
         return nullptr;
     }
 
-    m_pNextStage = pNext;
+    STAGE_EDGE_T tEdge;
+    tEdge.nPort = nPort;
+    tEdge.pNext = pNext;
+    tEdge.ePolicy = ePolicy;
+
+    std::shared_ptr<vector<STAGE_EDGE_T>> spEdges = std::make_shared<vector<STAGE_EDGE_T>>(*m_spEdges);
+    spEdges->emplace_back(tEdge);
+    m_spEdges = spEdges;
+    pNext->AddProducer();
+
     return pNext;
 }
 
+AX_BOOL CAXStage::UnbindNextStage(CAXStage* pNext, AX_U32 nPort /* = 0 */) {
+    std::lock_guard<std::mutex> lck(m_mtxEdges);
+    std::shared_ptr<vector<STAGE_EDGE_T>> spEdges = std::make_shared<vector<STAGE_EDGE_T>>(*m_spEdges);
+    for (auto it = spEdges->begin(); it != spEdges->end(); ++it) {
+        if (it->nPort == nPort && it->pNext == pNext) {
+            spEdges->erase(it);
+            m_spEdges = spEdges;
+            pNext->RemoveProducer();
+            return AX_TRUE;
+        }
+    }
+
+    return AX_FALSE;
+}
+
 CAXStage* CAXStage::GetNextStage(AX_VOID) {
-    return m_pNextStage;
+    std::shared_ptr<const vector<STAGE_EDGE_T>> spEdges = GetEdges();
+    for (auto& tEdge : *spEdges) {
+        if (0 == tEdge.nPort) {
+            return tEdge.pNext;
+        }
+    }
+
+    return nullptr;
+}
+
+AX_U32 CAXStage::GetNextStageCount(AX_U32 nPort /* = 0 */) {
+    std::shared_ptr<const vector<STAGE_EDGE_T>> spEdges = GetEdges();
+    AX_U32 nCount = 0;
+    for (auto& tEdge : *spEdges) {
+        if (tEdge.nPort == nPort) {
+            nCount++;
+        }
+    }
+
+    return nCount;
+}
+
+AX_U64 CAXStage::GetDropCount(AX_VOID) const {
+    return m_nDropCount.load();
+}
+
+AX_VOID CAXStage::AddProducer(AX_VOID) {
+    m_nProducers++;
+}
+
+AX_VOID CAXStage::RemoveProducer(AX_VOID) {
+    AX_U32 nProducers = m_nProducers.load();
+    while (nProducers > 0 && !m_nProducers.compare_exchange_weak(nProducers, nProducers - 1)) {
+    }
+}
+
+AX_U32 CAXStage::GetProducerCount(AX_VOID) const {
+    return m_nProducers.load();
 }
 
 const string& CAXStage::GetStageName(AX_VOID) const {
@@ -120,15 +324,58 @@ const string& CAXStage::GetStageName(AX_VOID) const {
 }
 
 AX_VOID CAXStage::SetCapacity(AX_S32 nCapacity) {
-    m_qFrame.SetCapacity(nCapacity);
+    if (m_qFrame) {
+        m_qFrame->SetCapacity(nCapacity);
+    }
+}
+
+AX_APP_LOCKQ_TYPE_E CAXStage::FitQueueType(AX_APP_LOCKQ_TYPE_E eType) {
+    AX_U32 nProducers = GetProducerCount();
+    if (AX_APP_LOCKQ_TYPE_SPSC == eType && nProducers > 1) {
+        LOG_M_W(STAGE, "%s: %d producers, SPSC queue falls back to MPSC", m_strStageName.c_str(), nProducers);
+        return AX_APP_LOCKQ_TYPE_MPSC;
+    }
+
+    return eType;
+}
+
+AX_BOOL CAXStage::SetQueueType(AX_APP_LOCKQ_TYPE_E eType) {
+    if (eType >= AX_APP_LOCKQ_TYPE_BUTT || m_StageThread.IsRunning() || !m_qFrame) {
+        return AX_FALSE;
+    }
+
+    eType = FitQueueType(eType);
+    if (eType == m_eQueueType) {
+        return AX_TRUE;
+    }
+
+    std::unique_ptr<IAXLockQ<CAXFrame*>> qFrame = CreateAXLockQ<CAXFrame*>(eType);
+    if (!qFrame) {
+        return AX_FALSE;
+    }
+
+    ClearQueue();
+    qFrame->SetCapacity(m_qFrame->GetCapacity());
+    m_qFrame = std::move(qFrame);
+    m_eQueueType = eType;
+
+    return AX_TRUE;
+}
+
+AX_APP_LOCKQ_TYPE_E CAXStage::GetQueueType(AX_VOID) const {
+    return m_eQueueType;
 }
 
 AX_BOOL CAXStage::ClearQueue(AX_VOID) {
+    if (!m_qFrame) {
+        return AX_TRUE;
+    }
+
     AX_BOOL ret = AX_TRUE;
     do {
         CAXFrame* pFrame{nullptr};
-        if (!m_qFrame.Pop(pFrame, 0)) {
-            if (m_qFrame.GetCount()) {
+        if (!m_qFrame->Pop(pFrame, 0)) {
+            if (m_qFrame->GetCount()) {
                 ret = AX_FALSE;
             }
             break;
@@ -137,5 +384,7 @@ AX_BOOL CAXStage::ClearQueue(AX_VOID) {
             pFrame->FreeMem();
         }
     } while (1);
+
+    NotifySpace(AX_TRUE);
     return ret;
 }
@@ -9,17 +9,38 @@
  **************************************************************************************************/
 
 #pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 #include "AXFrame.hpp"
-#include "AXLockQ.hpp"
+#include "AXLockFreeQ.hpp"
 #include "AXThread.hpp"
 #include "IModule.h"
+#include "LatencyTracer.hpp"
 
 typedef struct _STAGE_START_PARAMS {
     /* Indicates whether Stage would start frame processing thread, usually enabled on non-link channels */
     AX_BOOL bStartProcessingThread;
 } STAGE_START_PARAM_T, *STAGE_START_PARAM_PTR;
 
+/* what an edge does when the queue of its successor is full */
+typedef enum {
+    STAGE_DROP_POLICY_NEWEST = 0, /* drop the frame being delivered */
+    STAGE_DROP_POLICY_OLDEST,     /* drop the oldest queued frame, needs mutex queue, else falls back to NEWEST */
+    STAGE_DROP_POLICY_BLOCK,      /* wait until the successor pops a frame or stops */
+    STAGE_DROP_POLICY_BUTT
+} STAGE_DROP_POLICY_E;
+
+class CAXStage;
+typedef struct _STAGE_EDGE_T {
+    AX_U32 nPort{0};
+    CAXStage* pNext{nullptr};
+    STAGE_DROP_POLICY_E ePolicy{STAGE_DROP_POLICY_NEWEST};
+} STAGE_EDGE_T;
+
 /**
  * @brief
  *
@@ -31,9 +52,22 @@ public:
 
     const std::string& GetStageName(AX_VOID) const;
     AX_VOID SetCapacity(AX_S32 nCapacity);
+    /* switch frame queue backend, only allowed before stage thread started, SPSC falls back to MPSC with more than one producer */
+    AX_BOOL SetQueueType(AX_APP_LOCKQ_TYPE_E eType);
+    AX_APP_LOCKQ_TYPE_E GetQueueType(AX_VOID) const;
 
-    CAXStage* BindNextStage(CAXStage* pNext);
+    /* append an edge from output port nPort to pNext, frames of one port are shared by all its successors */
+    CAXStage* BindNextStage(CAXStage* pNext, AX_U32 nPort = 0, STAGE_DROP_POLICY_E ePolicy = STAGE_DROP_POLICY_NEWEST);
+    AX_BOOL UnbindNextStage(CAXStage* pNext, AX_U32 nPort = 0);
+    /* first successor of port 0 */
     CAXStage* GetNextStage(AX_VOID);
+    AX_U32 GetNextStageCount(AX_U32 nPort = 0);
+    /* frames dropped by the drop policy of edges into this stage */
+    AX_U64 GetDropCount(AX_VOID) const;
+    /* threads which enqueue frames: one per edge into this stage, counted by bind, and one per observer feeding it */
+    AX_VOID AddProducer(AX_VOID);
+    AX_VOID RemoveProducer(AX_VOID);
+    AX_U32 GetProducerCount(AX_VOID) const;
 
     virtual AX_BOOL Init(AX_VOID) override;
     virtual AX_BOOL DeInit(AX_VOID) override;
@@ -43,15 +77,40 @@ public:
     virtual AX_BOOL Start(STAGE_START_PARAM_PTR pStartParams);
 
     virtual AX_BOOL EnqueueFrame(CAXFrame* pFrame);
+    AX_BOOL EnqueueFrame(CAXFrame* pFrame, STAGE_DROP_POLICY_E ePolicy);
     virtual AX_BOOL ClearQueue(AX_VOID);
 
 protected:
     virtual AX_BOOL ProcessFrame(CAXFrame* pFrame);
     virtual AX_VOID StageThreadFunc(AX_VOID* pArg);
+    /* filter of frames arriving through an edge, rejected frames are released by the edge */
+    virtual AX_BOOL AcceptFrame(CAXFrame* pFrame);
+
+    /* hand pFrame to every successor of nPort, frame is always consumed; returns AX_FALSE if port has no successor */
+    AX_BOOL DispatchFrame(AX_U32 nPort, CAXFrame* pFrame);
+    AX_BOOL HasNextStage(AX_U32 nPort);
+    /* caller holds one reference of a multiplexed frame, each successor gets its own */
+    AX_VOID DeliverToEdges(AX_U32 nPort, CAXFrame* pFrame);
+
+private:
+    std::shared_ptr<const std::vector<STAGE_EDGE_T>> GetEdges(AX_VOID);
+    AX_VOID DeliverEdge(const STAGE_EDGE_T& tEdge, CAXFrame* pFrame);
+    AX_VOID NotifySpace(AX_BOOL bForce);
+    AX_APP_LOCKQ_TYPE_E FitQueueType(AX_APP_LOCKQ_TYPE_E eType);
 
 protected:
-    CAXLockQ<CAXFrame*> m_qFrame;
+    std::unique_ptr<IAXLockQ<CAXFrame*>> m_qFrame;
+    AX_APP_LOCKQ_TYPE_E m_eQueueType{AX_APP_LOCKQ_TYPE_MUTEX};
     std::string m_strStageName;
-    CAXStage* m_pNextStage{nullptr};
+    /* copied on bind/unbind, dispatch walks a snapshot without holding m_mtxEdges */
+    std::shared_ptr<const std::vector<STAGE_EDGE_T>> m_spEdges;
+    std::mutex m_mtxEdges;
+    std::atomic<AX_U64> m_nDropCount{0};
+    std::atomic<AX_U32> m_nProducers{0};
+    /* producers waiting on a full queue for STAGE_DROP_POLICY_BLOCK */
+    std::atomic<AX_U32> m_nBlockedProducers{0};
+    std::mutex m_mtxSpace;
+    std::condition_variable m_cvSpace;
     CAXThread m_StageThread;
+    AX_U16 m_nTracePoint{LATENCY_POINT_INVALID};
 };
\ No newline at end of file
@@ -0,0 +1,311 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+/*
+    Check of CAXStage edges.
+    Frames are released by a counter honoring bMultiplex like CIVPSGrpStage::VideoFrameRelease, every frame must be
+    released exactly once after all successors are done with it.
+
+    fanout:  one source stage feeds a fast stage, a slow stage dropping newest and a slow stage dropping oldest.
+             Fast stage must see every frame, slow ones must not hold back the source, drop-oldest keeps the last frame.
+    block:   successor with blocking edge and queue of one frame receives every frame; Stop releases a blocked producer.
+    unbind:  frames after UnbindNextStage go to the remaining successor only.
+    spsc:    SPSC queue of a stage fed by two stages falls back to MPSC on start and gets every frame,
+             binding a second producer to a running SPSC stage is refused.
+
+    usage: stage_edge_check
+*/
+
+#include <stdio.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "AXStage.hpp"
+#include "host_tool.h"
+
+#define CHECK_FRAME_NUM (300)
+#define CHECK_SLOW_US (2000)
+
+/* stage logs through app log, not shown here */
+AX_VOID AX_APP_LogFmtStr(AX_S32 nLv, const AX_CHAR *pFmt, ...) {
+}
+
+class CCheckRelease : public IFrameRelease {
+public:
+    CCheckRelease(AX_U32 nCount) : m_vecReleased(nCount) {
+    }
+
+    AX_VOID VideoFrameRelease(CAXFrame *pFrame) override {
+        if (!pFrame->bMultiplex || pFrame->DecFrmRef() == 0) {
+            m_vecReleased[pFrame->stFrame.stVFrame.stVFrame.u64SeqNum]++;
+        }
+    }
+
+    AX_BOOL Verify(AX_U32 nCount) const {
+        for (AX_U32 i = 0; i < nCount; ++i) {
+            if (1 != m_vecReleased[i].load()) {
+                printf("  frame %u released %u times\n", i, m_vecReleased[i].load());
+                return AX_FALSE;
+            }
+        }
+        return AX_TRUE;
+    }
+
+private:
+    std::vector<std::atomic<AX_U32>> m_vecReleased;
+};
+
+class CCheckStage : public CAXStage {
+public:
+    CCheckStage(const std::string &strName, AX_U32 nDelayUs) : CAXStage(strName), m_nDelayUs(nDelayUs) {
+    }
+
+    AX_BOOL Run(AX_S32 nCapacity) {
+        SetCapacity(nCapacity);
+        STAGE_START_PARAM_T tParams;
+        tParams.bStartProcessingThread = AX_TRUE;
+        return Start(&tParams);
+    }
+
+    AX_U32 GetCount(AX_VOID) {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        return (AX_U32)m_vecSeq.size();
+    }
+
+    AX_S64 GetLast(AX_VOID) {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        return m_vecSeq.empty() ? -1 : (AX_S64)m_vecSeq.back();
+    }
+
+protected:
+    AX_BOOL ProcessFrame(CAXFrame *pFrame) override {
+        if (m_nDelayUs) {
+            std::this_thread::sleep_for(std::chrono::microseconds(m_nDelayUs));
+        }
+        std::lock_guard<std::mutex> lck(m_mtx);
+        m_vecSeq.push_back(pFrame->stFrame.stVFrame.stVFrame.u64SeqNum);
+        return AX_TRUE;
+    }
+
+private:
+    AX_U32 m_nDelayUs{0};
+    std::mutex m_mtx;
+    std::vector<AX_U64> m_vecSeq;
+};
+
+class CCheckSource {
+public:
+    CCheckSource(AX_U32 nCount) : m_tRelease(nCount) {
+        for (AX_U32 i = 0; i < nCount; ++i) {
+            m_vecFrames.emplace_back(new CAXFrame());
+            m_vecFrames[i]->stFrame.stVFrame.stVFrame.u64SeqNum = i;
+            m_vecFrames[i]->pFrameRelease = &m_tRelease;
+        }
+    }
+
+    CAXFrame *Get(AX_U32 i) {
+        return m_vecFrames[i].get();
+    }
+
+    CCheckRelease &GetRelease(AX_VOID) {
+        return m_tRelease;
+    }
+
+private:
+    CCheckRelease m_tRelease;
+    std::vector<std::unique_ptr<CAXFrame>> m_vecFrames;
+};
+
+/* wait until a stage has drained its queue */
+static AX_VOID WaitIdle(CCheckStage &tStage, AX_U32 nExpect) {
+    for (AX_U32 i = 0; i < 2000 && tStage.GetCount() < nExpect; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+static AX_BOOL CheckFanout(AX_VOID) {
+    CCheckSource tSource(CHECK_FRAME_NUM);
+    CCheckStage tSrc("src", 0);
+    CCheckStage tFast("fast", 0);
+    CCheckStage tNewest("slow_newest", CHECK_SLOW_US);
+    CCheckStage tOldest("slow_oldest", CHECK_SLOW_US);
+
+    tSrc.BindNextStage(&tFast, 0, STAGE_DROP_POLICY_BLOCK);
+    tSrc.BindNextStage(&tNewest, 0, STAGE_DROP_POLICY_NEWEST);
+    tSrc.BindNextStage(&tOldest, 0, STAGE_DROP_POLICY_OLDEST);
+    tFast.Run(-1);
+    tNewest.Run(2);
+    tOldest.Run(2);
+    tSrc.Run(-1);
+
+    AX_U64 nStart = HostToolNowNs();
+    for (AX_U32 i = 0; i < CHECK_FRAME_NUM; ++i) {
+        tSrc.EnqueueFrame(tSource.Get(i));
+    }
+    WaitIdle(tSrc, CHECK_FRAME_NUM);
+    AX_F64 fFeedMs = (HostToolNowNs() - nStart) / 1e6;
+    WaitIdle(tFast, CHECK_FRAME_NUM);
+    std::this_thread::sleep_for(std::chrono::microseconds(CHECK_SLOW_US * 4));
+
+    tSrc.Stop();
+    tFast.Stop();
+    tNewest.Stop();
+    tOldest.Stop();
+
+    printf("fanout: %u frames in %.1f ms, fast %u, newest %u (dropped %llu), oldest %u (dropped %llu, last %lld)\n",
+           CHECK_FRAME_NUM, fFeedMs, tFast.GetCount(), tNewest.GetCount(), (unsigned long long)tNewest.GetDropCount(),
+           tOldest.GetCount(), (unsigned long long)tOldest.GetDropCount(), (long long)tOldest.GetLast());
+
+    AX_BOOL bOk = tSource.GetRelease().Verify(CHECK_FRAME_NUM);
+    bOk = (bOk && CHECK_FRAME_NUM == tFast.GetCount()) ? AX_TRUE : AX_FALSE;
+    bOk = (bOk && tNewest.GetCount() + tNewest.GetDropCount() == CHECK_FRAME_NUM) ? AX_TRUE : AX_FALSE;
+    bOk = (bOk && tOldest.GetCount() + tOldest.GetDropCount() == CHECK_FRAME_NUM) ? AX_TRUE : AX_FALSE;
+    bOk = (bOk && tOldest.GetLast() == CHECK_FRAME_NUM - 1) ? AX_TRUE : AX_FALSE;
+    /* slow stages at full rate would need CHECK_FRAME_NUM * CHECK_SLOW_US */
+    bOk = (bOk && fFeedMs < CHECK_FRAME_NUM * CHECK_SLOW_US / 1000.0 / 2) ? AX_TRUE : AX_FALSE;
+    return bOk;
+}
+
+static AX_BOOL CheckBlock(AX_VOID) {
+    CCheckSource tSource(CHECK_FRAME_NUM);
+    CCheckStage tSrc("src", 0);
+    CCheckStage tSlow("slow_block", CHECK_SLOW_US / 10);
+
+    tSrc.BindNextStage(&tSlow, 0, STAGE_DROP_POLICY_BLOCK);
+    tSlow.Run(1);
+    tSrc.Run(-1);
+
+    for (AX_U32 i = 0; i < CHECK_FRAME_NUM; ++i) {
+        tSrc.EnqueueFrame(tSource.Get(i));
+    }
+    WaitIdle(tSlow, CHECK_FRAME_NUM);
+    AX_U32 nGot = tSlow.GetCount();
+
+    /* successor stops while source is blocked on it: source must give up and release */
+    CCheckSource tStall(4);
+    CCheckStage tStuck("stuck", 200 * 1000);
+    tSrc.UnbindNextStage(&tSlow, 0);
+    tSrc.BindNextStage(&tStuck, 0, STAGE_DROP_POLICY_BLOCK);
+    tStuck.Run(1);
+    for (AX_U32 i = 0; i < 4; ++i) {
+        tSrc.EnqueueFrame(tStall.Get(i));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    AX_U64 nStart = HostToolNowNs();
+    tStuck.Stop();
+    tSrc.Stop();
+    AX_F64 fStopMs = (HostToolNowNs() - nStart) / 1e6;
+    tSlow.Stop();
+    /* frames still queued are released by DeInit, as on pipeline teardown */
+    tSrc.DeInit();
+    tStuck.DeInit();
+
+    printf("block: %u/%u frames delivered, stop with blocked producer %.1f ms\n", nGot, CHECK_FRAME_NUM, fStopMs);
+
+    AX_BOOL bOk = (CHECK_FRAME_NUM == nGot && 0 == tSlow.GetDropCount()) ? AX_TRUE : AX_FALSE;
+    bOk = (bOk && tSource.GetRelease().Verify(CHECK_FRAME_NUM) && tStall.GetRelease().Verify(4)) ? AX_TRUE : AX_FALSE;
+    return (bOk && fStopMs < 1000) ? AX_TRUE : AX_FALSE;
+}
+
+static AX_BOOL CheckUnbind(AX_VOID) {
+    CCheckSource tSource(CHECK_FRAME_NUM);
+    CCheckStage tSrc("src", 0);
+    CCheckStage tA("a", 0);
+    CCheckStage tB("b", 0);
+
+    tSrc.BindNextStage(&tA, 0, STAGE_DROP_POLICY_BLOCK);
+    tSrc.BindNextStage(&tB, 0, STAGE_DROP_POLICY_BLOCK);
+    AX_BOOL bOk = (nullptr == tSrc.BindNextStage(&tA, 0, STAGE_DROP_POLICY_BLOCK) && 2 == tSrc.GetNextStageCount()) ? AX_TRUE : AX_FALSE;
+    tA.Run(-1);
+    tB.Run(-1);
+    tSrc.Run(-1);
+
+    for (AX_U32 i = 0; i < CHECK_FRAME_NUM / 2; ++i) {
+        tSrc.EnqueueFrame(tSource.Get(i));
+    }
+    WaitIdle(tB, CHECK_FRAME_NUM / 2);
+    tSrc.UnbindNextStage(&tB, 0);
+    for (AX_U32 i = CHECK_FRAME_NUM / 2; i < CHECK_FRAME_NUM; ++i) {
+        tSrc.EnqueueFrame(tSource.Get(i));
+    }
+    WaitIdle(tA, CHECK_FRAME_NUM);
+    tSrc.Stop();
+    tA.Stop();
+    tB.Stop();
+
+    printf("unbind: a %u, b %u\n", tA.GetCount(), tB.GetCount());
+
+    bOk = (bOk && CHECK_FRAME_NUM == tA.GetCount() && CHECK_FRAME_NUM / 2 == tB.GetCount()) ? AX_TRUE : AX_FALSE;
+    return (bOk && tSource.GetRelease().Verify(CHECK_FRAME_NUM)) ? AX_TRUE : AX_FALSE;
+}
+
+static AX_BOOL CheckSpsc(AX_VOID) {
+    CCheckSource tSource(CHECK_FRAME_NUM);
+    CCheckStage tSrcA("src_a", 0);
+    CCheckStage tSrcB("src_b", 0);
+    CCheckStage tSink("sink", 0);
+    CCheckStage tOne("one", 0);
+
+    /* SPSC selected before producers are bound, as builders do with options.ini */
+    tSink.SetQueueType(AX_APP_LOCKQ_TYPE_SPSC);
+    tOne.SetQueueType(AX_APP_LOCKQ_TYPE_SPSC);
+    tSrcA.BindNextStage(&tSink, 0, STAGE_DROP_POLICY_BLOCK);
+    tSrcB.BindNextStage(&tSink, 0, STAGE_DROP_POLICY_BLOCK);
+    tSrcA.BindNextStage(&tOne, 1, STAGE_DROP_POLICY_BLOCK);
+    tSink.Run(4);
+    tOne.Run(4);
+    tSrcA.Run(-1);
+    tSrcB.Run(-1);
+
+    /* queue of a running stage can not be switched, second producer is refused */
+    AX_BOOL bRejected = (nullptr == tSrcB.BindNextStage(&tOne, 1, STAGE_DROP_POLICY_BLOCK)) ? AX_TRUE : AX_FALSE;
+
+    std::thread tFeedB([&]() {
+        for (AX_U32 i = 1; i < CHECK_FRAME_NUM; i += 2) {
+            tSrcB.EnqueueFrame(tSource.Get(i));
+        }
+    });
+    for (AX_U32 i = 0; i < CHECK_FRAME_NUM; i += 2) {
+        tSrcA.EnqueueFrame(tSource.Get(i));
+    }
+    tFeedB.join();
+    WaitIdle(tSink, CHECK_FRAME_NUM);
+    tSrcA.Stop();
+    tSrcB.Stop();
+    tSink.Stop();
+    tOne.Stop();
+
+    printf("spsc: sink with %u producers uses queue %d, got %u; one producer uses queue %d, second bind %s\n", tSink.GetProducerCount(),
+           tSink.GetQueueType(), tSink.GetCount(), tOne.GetQueueType(), bRejected ? "refused" : "accepted");
+
+    AX_BOOL bOk = (AX_APP_LOCKQ_TYPE_MPSC == tSink.GetQueueType() && AX_APP_LOCKQ_TYPE_SPSC == tOne.GetQueueType()) ? AX_TRUE : AX_FALSE;
+    bOk = (bOk && bRejected && 1 == tOne.GetProducerCount() && CHECK_FRAME_NUM == tSink.GetCount()) ? AX_TRUE : AX_FALSE;
+    return (bOk && tSource.GetRelease().Verify(CHECK_FRAME_NUM)) ? AX_TRUE : AX_FALSE;
+}
+
+int main(int argc, char *argv[]) {
+    struct {
+        const AX_CHAR *pszName;
+        AX_BOOL (*pCheck)(AX_VOID);
+    } arrChecks[] = {{"fanout", CheckFanout}, {"block", CheckBlock}, {"unbind", CheckUnbind}, {"spsc", CheckSpsc}};
+
+    AX_BOOL bOk = AX_TRUE;
+    for (AX_U32 i = 0; i < HOST_TOOL_ARRAY_SIZE(arrChecks); ++i) {
+        AX_BOOL bRet = arrChecks[i].pCheck();
+        printf("%-8s %s\n", arrChecks[i].pszName, bRet ? "PASS" : "FAIL");
+        if (!bRet) {
+            bOk = AX_FALSE;
+        }
+    }
+
+    return bOk ? 0 : 1;
+}
@@ -0,0 +1,42 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+/*
+    Helpers shared by the C++ host tools built by host_tool.mk.
+*/
+
+#include <chrono>
+#include "ax_global_type.h"
+
+#define HOST_TOOL_ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+/* one build of a source checked against the scalar golden, see VARIANT_SRC of host_tool.mk */
+template <typename FUNC>
+struct HOST_TOOL_VARIANT_T {
+    const AX_CHAR* pszName;
+    FUNC pFunc;
+};
+
+static inline AX_U64 HostToolNowNs(AX_VOID) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* average microseconds of one call of fn over nLoop calls */
+template <typename FN>
+static inline AX_F64 HostToolBenchUs(AX_U32 nLoop, FN fn) {
+    AX_U64 nStart = HostToolNowNs();
+    for (AX_U32 i = 0; i < nLoop; ++i) {
+        fn();
+    }
+
+    return (HostToolNowNs() - nStart) / 1000.0 / (nLoop ? nLoop : 1);
+}
@@ -0,0 +1,74 @@
+################################################################################
+#	common rules of host tools (golden checks, benchmarks, simulations), not part of app build
+#
+#	A tool Makefile sets TOOL_ROOT to this directory and includes this file after setting:
+#	  TARGET          program name
+#	  SRCS            sources linked into TARGET
+#	  DEPS            extra prerequisites of TARGET, e.g. headers or sources included by SRCS
+#	  TOOL_LANG       c or c++ (default)
+#	  TOOL_FLAGS      extra compile flags of every source
+#	  RUN_ARGS        arguments of "make run"
+#	SIMD tools build one source several times, once per variant, with a class and an entry renamed:
+#	  VARIANT_SRC     source built per variant, VARIANT_DEPS its prerequisites
+#	  VARIANT_CLASS   class renamed to <class><Suffix> in each variant
+#	  VARIANT_ENTRY   macro set to <VARIANT_ENTRY_NAME><Suffix>, the entry point called by the check
+#	  VARIANT_EXTRA_<variant>  extra flags of one variant
+#	Variants: scalar (every SIMD path compiled out, the golden), simd (native SSE2 or NEON),
+#	and on x86 host neon_emu (NEON path on header/neon_emu, HOST_TOOL_NEON_EMU is defined for the check).
+#
+#	make                                  PC build
+#	make run                              build and run, exit code is non-zero if the check fails
+#	make CROSS=aarch64-none-linux-gnu-    board build, copy TARGET to board and run
+#	make MSP_INC=<dir>                    SDK headers, default $(HOME_PATH)/msp/out/include
+################################################################################
+CUR_PATH		:= $(shell pwd)
+APP_PATH		:= $(abspath $(TOOL_ROOT)/..)
+HOME_PATH		:= $(abspath $(APP_PATH)/../..)
+MSP_INC			?= $(HOME_PATH)/msp/out/include
+
+CC				:= $(CROSS)gcc
+CXX				:= $(CROSS)g++
+CFLAGS			:= -O2 -Wall -I$(CUR_PATH) -I$(TOOL_ROOT) -I$(MSP_INC) $(TOOL_FLAGS)
+CXXFLAGS		:= -std=c++11 -O2 -Wall -I$(CUR_PATH) -I$(TOOL_ROOT) -I$(APP_PATH)/header -I$(MSP_INC) $(TOOL_FLAGS)
+LDLIBS			+= -lpthread
+
+ifeq ($(TOOL_LANG),c)
+TOOL_CC			:= $(CC) $(CFLAGS)
+else
+TOOL_CC			:= $(CXX) $(CXXFLAGS)
+endif
+
+ifneq ($(VARIANT_SRC),)
+VARIANTS		:= scalar simd
+ifeq ($(CROSS),)
+ifneq ($(filter x86_64 i686 i386,$(shell uname -m)),)
+VARIANTS		+= neon_emu
+TOOL_CC			+= -DHOST_TOOL_NEON_EMU
+endif
+endif
+
+VARIANT_SUFFIX_scalar	:= Scalar
+VARIANT_SUFFIX_simd		:= Simd
+VARIANT_SUFFIX_neon_emu	:= NeonEmu
+VARIANT_FLAGS_scalar	:= -U__SSE2__ -U__ARM_NEON
+VARIANT_FLAGS_simd		:=
+VARIANT_FLAGS_neon_emu	:= -U__SSE2__ -D__ARM_NEON -I$(APP_PATH)/header/neon_emu
+
+VARIANT_OBJS	:= $(addprefix variant_,$(addsuffix .o,$(VARIANTS)))
+endif
+
+.PHONY: all run clean
+all: $(TARGET)
+
+run: $(TARGET)
+	./$(TARGET) $(RUN_ARGS)
+
+$(TARGET): $(SRCS) $(VARIANT_OBJS) $(OBJS) $(DEPS)
+	$(TOOL_CC) $(SRCS) $(VARIANT_OBJS) $(OBJS) -o $@ $(LDLIBS)
+
+variant_%.o: $(VARIANT_SRC) $(VARIANT_DEPS)
+	$(CXX) $(CXXFLAGS) $(VARIANT_FLAGS_$*) -D$(VARIANT_CLASS)=$(VARIANT_CLASS)$(VARIANT_SUFFIX_$*) \
+		-D$(VARIANT_ENTRY)=$(VARIANT_ENTRY_NAME)$(VARIANT_SUFFIX_$*) $(VARIANT_EXTRA_$*) -c $< -o $@
+
+clean:
+	rm -f $(TARGET) $(VARIANT_OBJS) $(OBJS) $(CLEAN_FILES)
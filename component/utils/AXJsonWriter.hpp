@@ -0,0 +1,335 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "ax_base_type.h"
+
+/* max nesting of objects and arrays */
+#define AX_JSON_MAX_DEPTH (16)
+
+/* max output length of scalar values, used to bound buffer sizes at compile time */
+#define AX_JSON_MAX_INT_LEN (20)   /* -9223372036854775808 */
+#define AX_JSON_MAX_FLOAT_LEN (32) /* sign, 16 digits and point of fast path, or snprintf fallback */
+#define AX_JSON_MAX_BOOL_LEN (5)   /* false */
+/* quoted key of n bytes with separator of previous member: , "key": */
+#define AX_JSON_KEY_N_LEN(n) ((n) + 6)
+#define AX_JSON_KEY_LEN(key) AX_JSON_KEY_N_LEN(sizeof(key) - 1)
+/* quoted and escaped string value with separator of previous element, each byte may become \u00XX */
+#define AX_JSON_STR_LEN(n) ((n)*6 + 4)
+
+/* scaled float at or above this is written by snprintf: 2^53, beyond it doubles are not exact integers */
+#define AX_JSON_FLOAT_FAST_MAX (9007199254740992.0)
+
+/**
+ * @brief streaming JSON writer into a caller provided buffer.
+ *
+ *  - no heap use and no format string parsing, integers and fixed point floats are converted directly.
+ *  - commas and key separators are inserted automatically according to nesting.
+ *  - output never exceeds the buffer; once full, writer is marked overflow and stops writing,
+ *    so caller checks IsValid() instead of sending truncated JSON.
+ *
+ *  CAXJsonWriter w(szBuf, sizeof(szBuf));
+ *  w.BeginObject().Key("type").Int(1).Key("date").String(szDate).EndObject();
+ *  if (w.IsValid()) { send(w.GetString(), w.GetLength()); }
+ */
+class CAXJsonWriter {
+public:
+    CAXJsonWriter(AX_CHAR* pBuf, AX_U32 nSize) : m_pBuf(pBuf), m_nSize(nSize) {
+        if (!m_pBuf || 0 == m_nSize) {
+            m_bOverflow = AX_TRUE;
+        } else {
+            m_pBuf[0] = '\0';
+        }
+    }
+
+    CAXJsonWriter& BeginObject(AX_VOID) {
+        return Open('{');
+    }
+
+    CAXJsonWriter& EndObject(AX_VOID) {
+        return Close('}');
+    }
+
+    CAXJsonWriter& BeginArray(AX_VOID) {
+        return Open('[');
+    }
+
+    CAXJsonWriter& EndArray(AX_VOID) {
+        return Close(']');
+    }
+
+    CAXJsonWriter& Key(const AX_CHAR* pszKey) {
+        Separate();
+        PutChar('"');
+        PutEscaped(pszKey);
+        PutBytes("\": ", 3);
+        m_bAfterKey = AX_TRUE;
+        return *this;
+    }
+
+    CAXJsonWriter& Int(AX_S64 nValue) {
+        Separate();
+        AX_U64 nAbs = (nValue < 0) ? (AX_U64)(-(nValue + 1)) + 1 : (AX_U64)nValue;
+        if (nValue < 0) {
+            PutChar('-');
+        }
+        PutU64(nAbs);
+        return *this;
+    }
+
+    CAXJsonWriter& UInt(AX_U64 nValue) {
+        Separate();
+        PutU64(nValue);
+        return *this;
+    }
+
+    /* fixed point with nPrecision decimals (0 ~ 6), same rounding as printf("%.*f") except for ties */
+    CAXJsonWriter& Float(AX_F64 fValue, AX_U32 nPrecision = 2) {
+        Separate();
+        if (isnan(fValue) || isinf(fValue)) {
+            PutBytes("null", 4);
+            return *this;
+        }
+
+        if (nPrecision > 6) {
+            nPrecision = 6;
+        }
+
+        static const AX_U32 arrScale[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+        AX_F64 fAbs = fValue < 0 ? -fValue : fValue;
+        if (fAbs * arrScale[nPrecision] >= AX_JSON_FLOAT_FAST_MAX) {
+            /* scaled value is not exact in AX_F64 or does not fit in AX_U64 */
+            AX_CHAR szNum[AX_JSON_MAX_FLOAT_LEN];
+            AX_S32 nLen = snprintf(szNum, sizeof(szNum), "%.*f", (AX_S32)nPrecision, fValue);
+            PutBytes(szNum, (nLen > 0 && nLen < (AX_S32)sizeof(szNum)) ? nLen : sizeof(szNum));
+            if (nLen >= (AX_S32)sizeof(szNum)) {
+                m_bOverflow = AX_TRUE;
+            }
+            return *this;
+        }
+
+        AX_U64 nScaled = (AX_U64)(fAbs * arrScale[nPrecision] + 0.5);
+        AX_U64 nInt = nScaled / arrScale[nPrecision];
+        AX_U64 nFrac = nScaled % arrScale[nPrecision];
+        if (fValue < 0 && nScaled > 0) {
+            PutChar('-');
+        }
+
+        PutU64(nInt);
+        if (nPrecision > 0) {
+            AX_CHAR szFrac[8];
+            for (AX_S32 i = (AX_S32)nPrecision - 1; i >= 0; --i) {
+                szFrac[i] = (AX_CHAR)('0' + nFrac % 10);
+                nFrac /= 10;
+            }
+            PutChar('.');
+            PutBytes(szFrac, nPrecision);
+        }
+
+        return *this;
+    }
+
+    CAXJsonWriter& Bool(AX_BOOL bValue) {
+        Separate();
+        if (bValue) {
+            PutBytes("true", 4);
+        } else {
+            PutBytes("false", 5);
+        }
+        return *this;
+    }
+
+    CAXJsonWriter& Null(AX_VOID) {
+        Separate();
+        PutBytes("null", 4);
+        return *this;
+    }
+
+    CAXJsonWriter& String(const AX_CHAR* pszValue) {
+        Separate();
+        PutChar('"');
+        PutEscaped(pszValue ? pszValue : "");
+        PutChar('"');
+        return *this;
+    }
+
+    /* write preformatted JSON value as is, caller guarantees its validity */
+    CAXJsonWriter& Raw(const AX_CHAR* pszValue, AX_U32 nLen) {
+        Separate();
+        PutBytes(pszValue, nLen);
+        return *this;
+    }
+
+    /* key and value in one call, most formatters write flat members */
+    CAXJsonWriter& Int(const AX_CHAR* pszKey, AX_S64 nValue) {
+        return Key(pszKey).Int(nValue);
+    }
+
+    CAXJsonWriter& UInt(const AX_CHAR* pszKey, AX_U64 nValue) {
+        return Key(pszKey).UInt(nValue);
+    }
+
+    CAXJsonWriter& Float(const AX_CHAR* pszKey, AX_F64 fValue, AX_U32 nPrecision = 2) {
+        return Key(pszKey).Float(fValue, nPrecision);
+    }
+
+    CAXJsonWriter& Bool(const AX_CHAR* pszKey, AX_BOOL bValue) {
+        return Key(pszKey).Bool(bValue);
+    }
+
+    CAXJsonWriter& String(const AX_CHAR* pszKey, const AX_CHAR* pszValue) {
+        return Key(pszKey).String(pszValue);
+    }
+
+    /* complete and not truncated */
+    AX_BOOL IsValid(AX_VOID) const {
+        return (!m_bOverflow && 0 == m_nDepth && !m_bAfterKey) ? AX_TRUE : AX_FALSE;
+    }
+
+    AX_BOOL IsOverflow(AX_VOID) const {
+        return m_bOverflow;
+    }
+
+    const AX_CHAR* GetString(AX_VOID) const {
+        return m_pBuf;
+    }
+
+    /* length without terminating null */
+    AX_U32 GetLength(AX_VOID) const {
+        return m_nLen;
+    }
+
+private:
+    CAXJsonWriter& Open(AX_CHAR c) {
+        Separate();
+        PutChar(c);
+        if (m_nDepth >= AX_JSON_MAX_DEPTH) {
+            m_bOverflow = AX_TRUE;
+            return *this;
+        }
+
+        m_arrHasMember[m_nDepth++] = AX_FALSE;
+        return *this;
+    }
+
+    CAXJsonWriter& Close(AX_CHAR c) {
+        if (0 == m_nDepth) {
+            m_bOverflow = AX_TRUE;
+            return *this;
+        }
+
+        --m_nDepth;
+        PutChar(c);
+        return *this;
+    }
+
+    /* comma before every member/element except the first one, nothing between key and value */
+    AX_VOID Separate(AX_VOID) {
+        if (m_bAfterKey) {
+            m_bAfterKey = AX_FALSE;
+            return;
+        }
+
+        if (m_nDepth > 0) {
+            if (m_arrHasMember[m_nDepth - 1]) {
+                PutBytes(", ", 2);
+            } else {
+                m_arrHasMember[m_nDepth - 1] = AX_TRUE;
+            }
+        }
+    }
+
+    AX_VOID PutU64(AX_U64 nValue) {
+        AX_CHAR szNum[AX_JSON_MAX_INT_LEN];
+        AX_U32 nPos = sizeof(szNum);
+        do {
+            szNum[--nPos] = (AX_CHAR)('0' + nValue % 10);
+            nValue /= 10;
+        } while (nValue > 0);
+
+        PutBytes(szNum + nPos, sizeof(szNum) - nPos);
+    }
+
+    AX_VOID PutEscaped(const AX_CHAR* pszValue) {
+        static const AX_CHAR szHex[] = "0123456789abcdef";
+        const AX_CHAR* pStart = pszValue;
+        const AX_CHAR* p = pszValue;
+        for (; *p; ++p) {
+            AX_U8 c = (AX_U8)*p;
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+
+            PutBytes(pStart, p - pStart);
+            switch (c) {
+                case '"':
+                    PutBytes("\\\"", 2);
+                    break;
+                case '\\':
+                    PutBytes("\\\\", 2);
+                    break;
+                case '\n':
+                    PutBytes("\\n", 2);
+                    break;
+                case '\r':
+                    PutBytes("\\r", 2);
+                    break;
+                case '\t':
+                    PutBytes("\\t", 2);
+                    break;
+                default: {
+                    AX_CHAR szEsc[6] = {'\\', 'u', '0', '0', szHex[c >> 4], szHex[c & 0xF]};
+                    PutBytes(szEsc, 6);
+                    break;
+                }
+            }
+            pStart = p + 1;
+        }
+
+        PutBytes(pStart, p - pStart);
+    }
+
+    AX_VOID PutChar(AX_CHAR c) {
+        PutBytes(&c, 1);
+    }
+
+    AX_VOID PutBytes(const AX_CHAR* pData, AX_U32 nLen) {
+        if (m_bOverflow) {
+            return;
+        }
+
+        /* keep one byte for terminating null */
+        if (m_nLen + nLen >= m_nSize) {
+            m_bOverflow = AX_TRUE;
+            m_pBuf[m_nLen] = '\0';
+            return;
+        }
+
+        memcpy(m_pBuf + m_nLen, pData, nLen);
+        m_nLen += nLen;
+        m_pBuf[m_nLen] = '\0';
+    }
+
+    /* delete copy and assignment ctor */
+    CAXJsonWriter(const CAXJsonWriter&) = delete;
+    CAXJsonWriter& operator=(const CAXJsonWriter&) = delete;
+
+private:
+    AX_CHAR* m_pBuf{nullptr};
+    AX_U32 m_nSize{0};
+    AX_U32 m_nLen{0};
+    AX_U32 m_nDepth{0};
+    AX_BOOL m_bAfterKey{AX_FALSE};
+    AX_BOOL m_bOverflow{AX_FALSE};
+    AX_BOOL m_arrHasMember[AX_JSON_MAX_DEPTH]{AX_FALSE};
+};
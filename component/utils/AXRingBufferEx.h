@@ -312,6 +312,19 @@ public:
         return AX_TRUE;
     }
 
+    /* hold one more reference of element got by Get(), each one is released by Free() */
+    AX_VOID AddRef(CAXRingElementEx* ele) {
+        if (!ele) {
+            return;
+        }
+        std::lock_guard<std::mutex> lck(m_mutex);
+        if (!m_pRingBuf || !CheckElement(ele)) {
+            return;
+        }
+
+        ele->IncreaseRefCount();
+    }
+
     AX_VOID Free(CAXRingElementEx* ele, AX_BOOL bForce = AX_FALSE) {
         if (!ele) {
             return;
@@ -0,0 +1,509 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "AXSingleton.h"
+#include "AppLogApi.h"
+#include "GlobalDef.h"
+#include "ax_base_type.h"
+
+#define AXSTREAMBUF "STREAMBUF"
+#define STREAM_MIN(x, y) ((x) < (y) ? (x) : (y))
+#define STREAM_SPILL_DIVISOR (4)
+
+class CAXStreamBuffer;
+
+/* read-only view of one encoded packet, data may wrap around the end of buffer (pBuf2/nSize2) */
+typedef struct _AX_STREAM_PACKET {
+    AX_U64 nSeq;
+    AX_U8* pBuf;
+    AX_U32 nSize;
+    AX_U8* pBuf2;
+    AX_U32 nSize2;
+    AX_U64 nPts;
+    AX_BOOL bIFrame;
+    CAXStreamBuffer* pParent;
+
+    _AX_STREAM_PACKET() {
+        memset(this, 0, sizeof(_AX_STREAM_PACKET));
+    }
+} AX_STREAM_PACKET_T;
+
+/**
+ * @brief Encoded packet store shared by all sinks of one VENC channel.
+ *
+ * The encoder copies each packet once by Put. Every sink reads through its own CAXStreamReader cursor,
+ * a packet returned by Get is pinned until Free, and its bytes are never reused while pinned.
+ * Readers which lag behind the retired packets are moved to the next IDR, other readers are not affected.
+ * Put never waits for a pin: while the oldest bytes of the ring are pinned, new packets go to a preallocated spill ring
+ * of 1/STREAM_SPILL_DIVISOR buffer size with the same rule. If both are pinned the new packet is dropped for all readers.
+ */
+class CAXStreamBuffer {
+public:
+    CAXStreamBuffer(AX_U32 nChn, AX_U32 nBuffSize, AX_U32 nMaxPackets, const AX_CHAR* pszName = nullptr)
+        : m_nChn(nChn), m_nMaxPackets(nMaxPackets > 0 ? nMaxPackets : 1) {
+        InitRing(m_arrRings[STREAM_RING_MAIN], nBuffSize);
+        InitRing(m_arrRings[STREAM_RING_SPILL], nBuffSize / STREAM_SPILL_DIVISOR);
+        m_szName[0] = 0;
+        if (pszName && strlen(pszName)) {
+            strncpy(m_szName, pszName, sizeof(m_szName) - 1);
+            m_szName[sizeof(m_szName) - 1] = '\0';
+        }
+    }
+
+    ~CAXStreamBuffer(AX_VOID) {
+        for (auto& tRing : m_arrRings) {
+            AX_FREE(tRing.pBuf);
+        }
+    }
+
+    AX_BOOL Put(const AX_U8* pData, AX_U32 nSize, AX_U64 nPts, AX_BOOL bIFrame) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        STREAM_RING_T& tMain = m_arrRings[STREAM_RING_MAIN];
+        if (!tMain.pBuf || !pData || 0 == nSize || nSize > tMain.nSize) {
+            LOG_MM_E(AXSTREAMBUF, "[%s] drop frame of size %u, buffer size %u", m_szName, nSize, tMain.nSize);
+            m_bLost = AX_TRUE;
+            ++m_nDropCount;
+            return AX_FALSE;
+        }
+
+        if (m_bLost && !bIFrame) {
+            /* P frames behind a lost frame are useless for all readers */
+            ++m_nDropCount;
+            return AX_FALSE;
+        }
+
+        while (m_dqPackets.size() >= m_nMaxPackets) {
+            RetireOldest();
+        }
+
+        /* spill ring is only used while the oldest bytes of main ring are pinned */
+        AX_U32 nRing = STREAM_RING_MAIN;
+        if (!MakeRoom(STREAM_RING_MAIN, nSize)) {
+            nRing = STREAM_RING_SPILL;
+            if (!MakeRoom(STREAM_RING_SPILL, nSize)) {
+                if (0 == m_nPinDropCount++ % 100) {
+                    LOG_MM_W(AXSTREAMBUF, "[%s] buffer pinned by slow reader, drop frame of size %u (%lld dropped)", m_szName, nSize,
+                             m_nPinDropCount);
+                }
+                m_bLost = AX_TRUE;
+                ++m_nDropCount;
+                return AX_FALSE;
+            }
+            ++m_nSpillCount;
+        }
+
+        STREAM_RING_T& tRing = m_arrRings[nRing];
+        AX_U32 nPos = (AX_U32)(tRing.nHead % tRing.nSize);
+        AX_U32 nPart = STREAM_MIN(nSize, tRing.nSize - nPos);
+        memcpy(tRing.pBuf + nPos, pData, nPart);
+        if (nPart < nSize) {
+            memcpy(tRing.pBuf, pData + nPart, nSize - nPart);
+        }
+
+        PACKET_DESC_T tDesc;
+        tDesc.nSeq = m_nNextSeq;
+        tDesc.nOffset = tRing.nHead;
+        tDesc.nSize = nSize;
+        tDesc.nPts = nPts;
+        tDesc.bIFrame = bIFrame;
+        tDesc.nPinCnt = 0;
+        tDesc.nRing = nRing;
+        tRing.nHead += nSize;
+        tRing.dqSeq.push_back(m_nNextSeq);
+
+        m_dqPackets.push_back(tDesc);
+        if (bIFrame) {
+            m_nLastIDRSeq = m_nNextSeq;
+            m_bHasIDR = AX_TRUE;
+        }
+
+        ++m_nNextSeq;
+        m_bLost = AX_FALSE;
+
+        return AX_TRUE;
+    }
+
+    AX_VOID AddRef(const AX_STREAM_PACKET_T& tPkt) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        PACKET_DESC_T* pDesc = Find(tPkt.nSeq);
+        if (pDesc) {
+            pDesc->nPinCnt++;
+            ++m_nPinTotal;
+        }
+    }
+
+    AX_VOID Free(const AX_STREAM_PACKET_T& tPkt) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        PACKET_DESC_T* pDesc = Find(tPkt.nSeq);
+        if (!pDesc || 0 == pDesc->nPinCnt) {
+            return;
+        }
+
+        pDesc->nPinCnt--;
+        --m_nPinTotal;
+        if (0 == pDesc->nPinCnt && tPkt.nSeq < m_nFirstSeq) {
+            AX_U32 nRing = pDesc->nRing;
+            m_mapOrphans.erase(tPkt.nSeq);
+            Reclaim(nRing);
+        }
+    }
+
+    AX_VOID Clear(AX_VOID) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        /* pinned packets stay valid, only unread history is dropped */
+        while (!m_dqPackets.empty()) {
+            RetireOldest();
+        }
+        m_bHasIDR = AX_FALSE;
+    }
+
+    AX_U32 Capacity(AX_VOID) const {
+        return m_arrRings[STREAM_RING_MAIN].nSize;
+    }
+
+    AX_U32 GetChannel(AX_VOID) const {
+        return m_nChn;
+    }
+
+    AX_U64 GetDropCount(AX_VOID) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        return m_nDropCount;
+    }
+
+    /* packets stored in spill ring behind a pinned packet, and packets dropped because both rings were pinned */
+    AX_VOID GetSpillStat(AX_U64& nSpillCount, AX_U64& nPinDropCount) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        nSpillCount = m_nSpillCount;
+        nPinDropCount = m_nPinDropCount;
+    }
+
+    const AX_CHAR* GetName(AX_VOID) const {
+        return m_szName;
+    }
+
+    /* replaced by a new buffer of the same channel, readers move to it once no packet of this one is pinned */
+    AX_VOID Retire(AX_VOID) {
+        m_bRetired = AX_TRUE;
+    }
+
+    AX_BOOL IsRetired(AX_VOID) const {
+        return m_bRetired ? AX_TRUE : AX_FALSE;
+    }
+
+    AX_BOOL IsPinned(AX_VOID) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        return (m_nPinTotal > 0) ? AX_TRUE : AX_FALSE;
+    }
+
+private:
+    friend class CAXStreamReader;
+
+    enum { STREAM_RING_MAIN = 0, STREAM_RING_SPILL = 1, STREAM_RING_BUTT };
+
+    typedef struct {
+        AX_U64 nSeq;
+        AX_U64 nOffset; /* in its ring */
+        AX_U32 nSize;
+        AX_U64 nPts;
+        AX_BOOL bIFrame;
+        AX_S32 nPinCnt;
+        AX_U32 nRing;
+    } PACKET_DESC_T;
+
+    /* bytes [nTail, nHead) are owned by packets in dqSeq order, readable ones or retired ones still pinned */
+    typedef struct {
+        AX_U8* pBuf;
+        AX_U32 nSize;
+        AX_U64 nHead;
+        AX_U64 nTail;
+        std::deque<AX_U64> dqSeq;
+    } STREAM_RING_T;
+
+    static AX_VOID InitRing(STREAM_RING_T& tRing, AX_U32 nSize) {
+        tRing.pBuf = (nSize > 0) ? (AX_U8*)AX_MALLOC(nSize) : nullptr;
+        tRing.nSize = tRing.pBuf ? nSize : 0;
+        tRing.nHead = 0;
+        tRing.nTail = 0;
+    }
+
+    static AX_U32 RingFree(const STREAM_RING_T& tRing) {
+        return tRing.nSize - (AX_U32)(tRing.nHead - tRing.nTail);
+    }
+
+    PACKET_DESC_T& Slot(AX_U64 nSeq) {
+        return m_dqPackets[nSeq - m_nFirstSeq];
+    }
+
+    PACKET_DESC_T* Find(AX_U64 nSeq) {
+        if (nSeq >= m_nFirstSeq && nSeq < m_nNextSeq) {
+            return &Slot(nSeq);
+        }
+
+        auto it = m_mapOrphans.find(nSeq);
+        return (it != m_mapOrphans.end()) ? &it->second : nullptr;
+    }
+
+    /* release bytes at tail of ring up to the oldest packet still readable or pinned */
+    AX_VOID Reclaim(AX_U32 nRing) {
+        STREAM_RING_T& tRing = m_arrRings[nRing];
+        while (!tRing.dqSeq.empty()) {
+            AX_U64 nSeq = tRing.dqSeq.front();
+            if (nSeq >= m_nFirstSeq || m_mapOrphans.count(nSeq) > 0) {
+                break;
+            }
+            tRing.dqSeq.pop_front();
+        }
+
+        tRing.nTail = tRing.dqSeq.empty() ? tRing.nHead : Find(tRing.dqSeq.front())->nOffset;
+    }
+
+    /* oldest packet is no longer readable, its bytes are kept while it is pinned */
+    AX_VOID RetireOldest(AX_VOID) {
+        PACKET_DESC_T& tDesc = m_dqPackets.front();
+        AX_U32 nRing = tDesc.nRing;
+        if (tDesc.nPinCnt > 0) {
+            m_mapOrphans[tDesc.nSeq] = tDesc;
+        }
+
+        m_dqPackets.pop_front();
+        ++m_nFirstSeq;
+        Reclaim(nRing);
+    }
+
+    /* retire readable packets until nSize bytes are free at head of ring, fails if tail of ring is pinned */
+    AX_BOOL MakeRoom(AX_U32 nRing, AX_U32 nSize) {
+        STREAM_RING_T& tRing = m_arrRings[nRing];
+        if (nSize > tRing.nSize) {
+            return AX_FALSE;
+        }
+
+        while (RingFree(tRing) < nSize) {
+            AX_U64 nSeq = tRing.dqSeq.front();
+            if (nSeq < m_nFirstSeq || Slot(nSeq).nPinCnt > 0) {
+                return AX_FALSE;
+            }
+            RetireOldest();
+        }
+
+        return AX_TRUE;
+    }
+
+    /* start position of a new reader: latest IDR if still buffered, otherwise wait for next IDR */
+    AX_U64 GetStartSeq(AX_BOOL& bNeedIDR) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        if (m_bHasIDR && m_nLastIDRSeq >= m_nFirstSeq) {
+            bNeedIDR = AX_FALSE;
+            return m_nLastIDRSeq;
+        }
+
+        bNeedIDR = AX_TRUE;
+        return m_nNextSeq;
+    }
+
+    AX_BOOL Acquire(AX_U64& nCursor, AX_BOOL& bNeedIDR, AX_U64& nSkipped, AX_STREAM_PACKET_T& tPkt) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        if (nCursor < m_nFirstSeq) {
+            /* packets retired before this reader got them */
+            nSkipped += m_nFirstSeq - nCursor;
+            nCursor = m_nFirstSeq;
+            bNeedIDR = AX_TRUE;
+        }
+
+        while (nCursor < m_nNextSeq) {
+            PACKET_DESC_T& tDesc = Slot(nCursor);
+            if (bNeedIDR && !tDesc.bIFrame) {
+                ++nSkipped;
+                ++nCursor;
+                continue;
+            }
+
+            bNeedIDR = AX_FALSE;
+            tDesc.nPinCnt++;
+            ++m_nPinTotal;
+
+            const STREAM_RING_T& tRing = m_arrRings[tDesc.nRing];
+            AX_U32 nPos = (AX_U32)(tDesc.nOffset % tRing.nSize);
+            tPkt.nSeq = nCursor;
+            tPkt.pBuf = tRing.pBuf + nPos;
+            tPkt.nSize = STREAM_MIN(tDesc.nSize, tRing.nSize - nPos);
+            tPkt.pBuf2 = tRing.pBuf;
+            tPkt.nSize2 = tDesc.nSize - tPkt.nSize;
+            tPkt.nPts = tDesc.nPts;
+            tPkt.bIFrame = tDesc.bIFrame;
+            tPkt.pParent = this;
+
+            ++nCursor;
+            return AX_TRUE;
+        }
+
+        return AX_FALSE;
+    }
+
+    CAXStreamBuffer(const CAXStreamBuffer&) = delete;
+    CAXStreamBuffer& operator=(const CAXStreamBuffer&) = delete;
+
+private:
+    AX_U32 m_nChn{0};
+    AX_U32 m_nMaxPackets{0};
+    STREAM_RING_T m_arrRings[STREAM_RING_BUTT];
+    std::deque<PACKET_DESC_T> m_dqPackets;        /* readable packets [m_nFirstSeq, m_nNextSeq) */
+    std::map<AX_U64, PACKET_DESC_T> m_mapOrphans; /* retired packets still pinned, at most one per outstanding pin */
+    AX_U64 m_nFirstSeq{0};
+    AX_U64 m_nNextSeq{0};
+    AX_U64 m_nLastIDRSeq{0};
+    AX_U64 m_nPinTotal{0};
+    AX_BOOL m_bHasIDR{AX_FALSE};
+    AX_BOOL m_bLost{AX_FALSE};
+    std::atomic<bool> m_bRetired{false};
+    AX_U64 m_nDropCount{0};
+    AX_U64 m_nSpillCount{0};
+    AX_U64 m_nPinDropCount{0};
+    std::mutex m_mutex;
+    AX_CHAR m_szName[64];
+};
+
+/**
+ * @brief Independent read cursor of one sink into a CAXStreamBuffer.
+ *
+ */
+class CAXStreamReader {
+public:
+    CAXStreamReader(std::shared_ptr<CAXStreamBuffer> spBuffer) : m_spBuffer(spBuffer) {
+        if (m_spBuffer) {
+            m_nCursor = m_spBuffer->GetStartSeq(m_bNeedIDR);
+        }
+    }
+
+    ~CAXStreamReader(AX_VOID) = default;
+
+    /* pin next packet, caller must return it by Free */
+    AX_BOOL Get(AX_STREAM_PACKET_T& tPkt) {
+        if (!m_spBuffer) {
+            return AX_FALSE;
+        }
+
+        if (m_spBuffer->IsRetired()) {
+            Reattach();
+        }
+
+        return m_spBuffer->Acquire(m_nCursor, m_bNeedIDR, m_nSkipped, tPkt);
+    }
+
+    /* packet goes back to the buffer it was taken from, which may have been replaced since */
+    AX_VOID Free(const AX_STREAM_PACKET_T& tPkt) {
+        if (tPkt.pParent) {
+            tPkt.pParent->Free(tPkt);
+        }
+    }
+
+    /* restart from the latest IDR, used when nobody consumed this reader for a while */
+    AX_VOID Reset(AX_VOID) {
+        if (m_spBuffer) {
+            m_nCursor = m_spBuffer->GetStartSeq(m_bNeedIDR);
+        }
+    }
+
+    /* drop everything up to the next IDR, e.g. after the sink itself lost data */
+    AX_VOID SkipToIDR(AX_VOID) {
+        m_bNeedIDR = AX_TRUE;
+    }
+
+    AX_U64 GetSkipCount(AX_VOID) const {
+        return m_nSkipped;
+    }
+
+    CAXStreamBuffer* GetBuffer(AX_VOID) const {
+        return m_spBuffer.get();
+    }
+
+private:
+    AX_VOID Reattach(AX_VOID);
+
+private:
+    std::shared_ptr<CAXStreamBuffer> m_spBuffer;
+    AX_U64 m_nCursor{0};
+    AX_U64 m_nSkipped{0};
+    AX_BOOL m_bNeedIDR{AX_TRUE};
+};
+
+/**
+ * @brief Shared stream buffers indexed by VENC channel.
+ *
+ */
+class CAXStreamBufferMgr final : public CAXSingleton<CAXStreamBufferMgr> {
+    friend class CAXSingleton<CAXStreamBufferMgr>;
+
+public:
+    std::shared_ptr<CAXStreamBuffer> Create(AX_U32 nVencChn, AX_U32 nBuffSize, AX_U32 nMaxPackets) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        auto it = m_mapBuffers.find(nVencChn);
+        if (it != m_mapBuffers.end() && it->second->Capacity() >= nBuffSize) {
+            return it->second;
+        }
+
+        AX_CHAR szName[32] = {0};
+        snprintf(szName, sizeof(szName), "VENC_CH%d", nVencChn);
+        std::shared_ptr<CAXStreamBuffer> spBuffer = std::make_shared<CAXStreamBuffer>(nVencChn, nBuffSize, nMaxPackets, szName);
+        if (it != m_mapBuffers.end()) {
+            it->second->Retire();
+        }
+        m_mapBuffers[nVencChn] = spBuffer;
+
+        LOG_MM_I(AXSTREAMBUF, "[%s] buffer size %u, max packets %u", szName, nBuffSize, nMaxPackets);
+        return spBuffer;
+    }
+
+    std::shared_ptr<CAXStreamBuffer> Get(AX_U32 nVencChn) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        auto it = m_mapBuffers.find(nVencChn);
+        return (it != m_mapBuffers.end()) ? it->second : nullptr;
+    }
+
+    /* readers keep their own reference, buffer memory is released after the last reader is gone */
+    AX_VOID Destroy(AX_U32 nVencChn) {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        auto it = m_mapBuffers.find(nVencChn);
+        if (it != m_mapBuffers.end()) {
+            it->second->Retire();
+            m_mapBuffers.erase(it);
+        }
+    }
+
+private:
+    CAXStreamBufferMgr(AX_VOID) noexcept = default;
+    virtual ~CAXStreamBufferMgr(AX_VOID) = default;
+
+private:
+    std::mutex m_mutex;
+    std::map<AX_U32, std::shared_ptr<CAXStreamBuffer>> m_mapBuffers;
+};
+
+/* a reader keeps its buffer alive, it drops it for the rebuilt one only when no packet of the old one is pinned,
+   since pinned packets in flight (e.g. queued websocket messages) hold just a raw pParent */
+inline AX_VOID CAXStreamReader::Reattach(AX_VOID) {
+    std::shared_ptr<CAXStreamBuffer> spNew = CAXStreamBufferMgr::GetInstance()->Get(m_spBuffer->GetChannel());
+    if (!spNew || spNew == m_spBuffer || m_spBuffer->IsPinned()) {
+        return;
+    }
+
+    LOG_MM_I(AXSTREAMBUF, "[%s] reader moves to rebuilt buffer", spNew->GetName());
+    m_spBuffer = spNew;
+    m_nCursor = m_spBuffer->GetStartSeq(m_bNeedIDR);
+}
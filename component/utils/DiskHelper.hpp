@@ -34,10 +34,10 @@ public:
     /* mkdir -p */
     static AX_BOOL CreateDir(const char* dir, AX_BOOL bAlwaysCreate);
 
-    /* get the size of directory */
+    /* get the size of directory, walks the whole tree: size of recording directory is CRecordIndex::GetTotalSize */
     static AX_U64 GetDirSize(const char* dir);
 
-    /* travser directory by time in ascending order */
+    /* travser directory by time in ascending order, stats every file: recordings are listed by CRecordIndex */
     static std::deque<DISK_FILE_INFO_T> TraverseFiles(const char* dir, const char* extension = nullptr);
     static std::deque<DISK_FILE_INFO_T> TraverseDirs(const char* dir);
 
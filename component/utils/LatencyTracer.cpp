@@ -0,0 +1,335 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "LatencyTracer.hpp"
+#include "AXJsonWriter.hpp"
+#include "AppLogApi.h"
+
+#define TRACER "TRACER"
+
+AX_VOID CLatencyHistogram::GetStat(LATENCY_STAT_T& tStat) const {
+    tStat = LATENCY_STAT_T();
+
+    AX_U32 arrBucket[LATENCY_HIST_BUCKET_NUM];
+    AX_U64 nTotal = 0;
+    for (AX_U32 i = 0; i < LATENCY_HIST_BUCKET_NUM; ++i) {
+        arrBucket[i] = m_arrBucket[i].load(std::memory_order_relaxed);
+        nTotal += arrBucket[i];
+    }
+
+    if (0 == nTotal) {
+        return;
+    }
+
+    tStat.nCount = nTotal;
+    tStat.nMax = m_nMax.load(std::memory_order_relaxed);
+    AX_U64 nCount = m_nCount.load(std::memory_order_relaxed);
+    tStat.nMean = (AX_U32)(m_nSum.load(std::memory_order_relaxed) / (nCount ? nCount : 1));
+
+    /* rank of p50, p99 and p99.9, round up */
+    const AX_U64 arrRank[] = {(nTotal * 500 + 999) / 1000, (nTotal * 990 + 999) / 1000, (nTotal * 999 + 999) / 1000};
+    AX_U32* arrValue[] = {&tStat.nP50, &tStat.nP99, &tStat.nP999};
+    AX_U64 nAccum = 0;
+    AX_U32 nNext = 0;
+    for (AX_U32 i = 0; i < LATENCY_HIST_BUCKET_NUM && nNext < 3; ++i) {
+        nAccum += arrBucket[i];
+        while (nNext < 3 && nAccum >= arrRank[nNext]) {
+            /* bucket upper bound, never above recorded max */
+            AX_U32 nValue = Index2Value(i);
+            *arrValue[nNext++] = (nValue > tStat.nMax) ? tStat.nMax : nValue;
+        }
+    }
+}
+
+AX_U16 CLatencyTracer::RegisterPoint(const std::string& strName) {
+    std::lock_guard<std::mutex> lck(m_mtxRegistry);
+    auto it = m_mapPoint.find(strName);
+    if (it != m_mapPoint.end()) {
+        return it->second;
+    }
+
+    if (m_vecPointName.size() >= LATENCY_POINT_MAX_NUM) {
+        LOG_M_W(TRACER, "trace point %s is ignored, max %d points", strName.c_str(), LATENCY_POINT_MAX_NUM);
+        return LATENCY_POINT_INVALID;
+    }
+
+    AX_U16 nPoint = (AX_U16)m_vecPointName.size();
+    m_vecPointName.push_back(strName);
+    m_mapPoint[strName] = nPoint;
+    for (AX_U32 i = 0; i < LATENCY_HIST_BUTT; ++i) {
+        m_vecHist.emplace_back(new CLatencyHistogram());
+        m_arrHist[nPoint][i] = m_vecHist.back().get();
+    }
+
+    return nPoint;
+}
+
+CLatencyHistogram* CLatencyTracer::RegisterEdge(AX_U16 nFrom, AX_U16 nTo) {
+    if (LATENCY_POINT_INVALID == nFrom || LATENCY_POINT_INVALID == nTo) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtxRegistry);
+    std::unique_ptr<CLatencyHistogram>& pHist = m_mapEdge[((AX_U32)nFrom << 16) | nTo];
+    if (!pHist) {
+        pHist.reset(new CLatencyHistogram());
+        if (nTo < LATENCY_POINT_MAX_NUM) {
+            for (auto& tSlot : m_arrEdgeSlot[nTo]) {
+                if (LATENCY_POINT_INVALID == tSlot.nFrom.load(std::memory_order_relaxed)) {
+                    tSlot.pHist = pHist.get();
+                    tSlot.nFrom.store(nFrom, std::memory_order_release);
+                    break;
+                }
+            }
+        }
+    }
+
+    return pHist.get();
+}
+
+CLatencyHistogram* CLatencyTracer::GetEdge(AX_U16 nFrom, AX_U16 nTo) {
+    if (LATENCY_POINT_INVALID == nFrom || LATENCY_POINT_INVALID == nTo || nTo >= LATENCY_POINT_MAX_NUM) {
+        return nullptr;
+    }
+
+    for (const auto& tSlot : m_arrEdgeSlot[nTo]) {
+        AX_U16 nSlotFrom = tSlot.nFrom.load(std::memory_order_acquire);
+        if (nSlotFrom == nFrom) {
+            return tSlot.pHist;
+        } else if (LATENCY_POINT_INVALID == nSlotFrom) {
+            break;
+        }
+    }
+
+    return RegisterEdge(nFrom, nTo);
+}
+
+AX_VOID CLatencyTracer::OnEnqueue(CLatencyTrail& tTrail, AX_U16 nPoint) {
+    if (!IsEnabled() || LATENCY_POINT_INVALID == nPoint || !tTrail.IsStarted()) {
+        return;
+    }
+
+    AX_U64 nNow = NowUs();
+    tTrail.Stamp(nPoint, LATENCY_STAMP_ENQUEUE, nNow);
+
+    AX_U16 nSource = tTrail.GetSource();
+    if (nSource != nPoint && nNow >= tTrail.GetOrigin()) {
+        CLatencyHistogram* pEdge = GetEdge(nSource, nPoint);
+        if (pEdge) {
+            pEdge->Record(nNow - tTrail.GetOrigin());
+        }
+    }
+}
+
+AX_VOID CLatencyTracer::OnDequeue(CLatencyTrail& tTrail, AX_U16 nPoint) {
+    if (!IsEnabled() || LATENCY_POINT_INVALID == nPoint || !tTrail.IsStarted()) {
+        return;
+    }
+
+    AX_U64 nNow = NowUs();
+    AX_U64 nEnqueue = tTrail.Find(nPoint, LATENCY_STAMP_ENQUEUE);
+    tTrail.Stamp(nPoint, LATENCY_STAMP_DEQUEUE, nNow);
+
+    if (nEnqueue > 0 && nNow >= nEnqueue) {
+        m_arrHist[nPoint][LATENCY_HIST_WAIT]->Record(nNow - nEnqueue);
+    }
+    if (nNow >= tTrail.GetOrigin()) {
+        m_arrHist[nPoint][LATENCY_HIST_AGE]->Record(nNow - tTrail.GetOrigin());
+    }
+}
+
+AX_VOID CLatencyTracer::Collect(const CLatencyTrail& tTrail) {
+    if (!IsEnabled() || !tTrail.IsStarted()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtxTrace);
+    if (m_vecTrace.size() < LATENCY_TRACE_RING_NUM) {
+        m_vecTrace.push_back(tTrail);
+    } else {
+        m_vecTrace[m_nTraceIndex] = tTrail;
+    }
+    m_nTraceIndex = (m_nTraceIndex + 1) % LATENCY_TRACE_RING_NUM;
+}
+
+static AX_VOID WriteStat(CAXJsonWriter& w, const AX_CHAR* pszName, const CLatencyHistogram* pHist) {
+    LATENCY_STAT_T tStat;
+    pHist->GetStat(tStat);
+    if (0 == tStat.nCount) {
+        return;
+    }
+
+    w.BeginObject()
+        .String("name", pszName)
+        .UInt("count", tStat.nCount)
+        .UInt("mean", tStat.nMean)
+        .UInt("p50", tStat.nP50)
+        .UInt("p99", tStat.nP99)
+        .UInt("p999", tStat.nP999)
+        .UInt("max", tStat.nMax)
+        .EndObject();
+}
+
+AX_U32 CLatencyTracer::DumpStat(AX_CHAR* pBuf, AX_U32 nSize) {
+    static const AX_CHAR* arrSuffix[LATENCY_HIST_BUTT] = {".wait", ".age", ".notify"};
+
+    CAXJsonWriter w(pBuf, nSize);
+    w.BeginObject().Bool("enable", IsEnabled()).Key("unit").String("us").Key("histograms").BeginArray();
+
+    std::lock_guard<std::mutex> lck(m_mtxRegistry);
+    for (AX_U32 nPoint = 1; nPoint < m_vecPointName.size(); ++nPoint) {
+        for (AX_U32 i = 0; i < LATENCY_HIST_BUTT; ++i) {
+            WriteStat(w, (m_vecPointName[nPoint] + arrSuffix[i]).c_str(), m_arrHist[nPoint][i]);
+        }
+    }
+
+    for (auto& kv : m_mapEdge) {
+        AX_U16 nFrom = (AX_U16)(kv.first >> 16);
+        AX_U16 nTo = (AX_U16)(kv.first & 0xFFFF);
+        WriteStat(w, (m_vecPointName[nFrom] + "->" + m_vecPointName[nTo]).c_str(), kv.second.get());
+    }
+
+    w.EndArray().EndObject();
+    if (!w.IsValid()) {
+        LOG_M_E(TRACER, "latency stat exceeds buffer size %d", nSize);
+        return 0;
+    }
+
+    return w.GetLength();
+}
+
+AX_U32 CLatencyTracer::DumpTrace(AX_CHAR* pBuf, AX_U32 nSize) {
+    std::vector<CLatencyTrail> vecTrace;
+    {
+        std::lock_guard<std::mutex> lck(m_mtxTrace);
+        vecTrace = m_vecTrace;
+    }
+
+    std::vector<std::string> vecName;
+    {
+        std::lock_guard<std::mutex> lck(m_mtxRegistry);
+        vecName = m_vecPointName;
+    }
+
+    auto GetName = [&vecName](AX_U16 nPoint) -> const AX_CHAR* {
+        return (nPoint < vecName.size()) ? vecName[nPoint].c_str() : "unknown";
+    };
+
+    /* one track (tid) per source point, timestamps in us of CLOCK_MONOTONIC */
+    CAXJsonWriter w(pBuf, nSize);
+    w.BeginObject().Key("displayTimeUnit").String("ms").Key("traceEvents").BeginArray();
+
+    std::map<AX_U16, AX_BOOL> mapSource;
+    for (auto& tTrail : vecTrace) {
+        AX_U32 nCount = tTrail.GetCount();
+        AX_U16 nSource = LATENCY_POINT_INVALID;
+        AX_U32 nEnd = 0;
+        for (AX_U32 i = 0; i < nCount; ++i) {
+            AX_U64 nStamp = tTrail.GetStamp(i);
+            if (0 == nStamp) {
+                continue;
+            }
+
+            AX_U16 nPoint = CLatencyTrail::GetPoint(nStamp);
+            LATENCY_STAMP_E eKind = CLatencyTrail::GetKind(nStamp);
+            AX_U32 nDelta = CLatencyTrail::GetDelta(nStamp);
+            if (nDelta > nEnd) {
+                nEnd = nDelta;
+            }
+
+            if (LATENCY_STAMP_SOURCE == eKind) {
+                nSource = nPoint;
+                mapSource[nPoint] = AX_TRUE;
+            } else if (LATENCY_STAMP_DEQUEUE == eKind) {
+                /* queue wait of stage as complete event */
+                AX_U64 nEnqueue = tTrail.Find(nPoint, LATENCY_STAMP_ENQUEUE);
+                AX_U64 nDequeue = tTrail.GetOrigin() + nDelta;
+                if (nEnqueue > 0 && nDequeue >= nEnqueue) {
+                    w.BeginObject()
+                        .String("name", GetName(nPoint))
+                        .String("cat", "wait")
+                        .String("ph", "X")
+                        .UInt("ts", nEnqueue)
+                        .UInt("dur", nDequeue - nEnqueue)
+                        .UInt("pid", 1)
+                        .UInt("tid", nSource)
+                        .Key("args")
+                        .BeginObject()
+                        .UInt("seq", tTrail.GetSeq())
+                        .EndObject()
+                        .EndObject();
+                }
+            } else if (LATENCY_STAMP_NOTIFY == eKind) {
+                w.BeginObject()
+                    .String("name", GetName(nPoint))
+                    .String("cat", "notify")
+                    .String("ph", "i")
+                    .String("s", "t")
+                    .UInt("ts", tTrail.GetOrigin() + nDelta)
+                    .UInt("pid", 1)
+                    .UInt("tid", nSource)
+                    .EndObject();
+            }
+        }
+
+        /* frame from source until its last stamp */
+        w.BeginObject()
+            .Key("name")
+            .String(GetName(nSource))
+            .String("cat", "frame")
+            .String("ph", "X")
+            .UInt("ts", tTrail.GetOrigin())
+            .UInt("dur", nEnd)
+            .UInt("pid", 1)
+            .UInt("tid", nSource)
+            .Key("args")
+            .BeginObject()
+            .UInt("seq", tTrail.GetSeq())
+            .EndObject()
+            .EndObject();
+    }
+
+    for (auto& kv : mapSource) {
+        w.BeginObject()
+            .String("name", "thread_name")
+            .String("ph", "M")
+            .UInt("pid", 1)
+            .UInt("tid", kv.first)
+            .Key("args")
+            .BeginObject()
+            .String("name", GetName(kv.first))
+            .EndObject()
+            .EndObject();
+    }
+
+    w.EndArray().EndObject();
+    if (!w.IsValid()) {
+        LOG_M_E(TRACER, "latency trace exceeds buffer size %d", nSize);
+        return 0;
+    }
+
+    return w.GetLength();
+}
+
+AX_VOID CLatencyTracer::Reset(AX_VOID) {
+    {
+        std::lock_guard<std::mutex> lck(m_mtxRegistry);
+        for (auto& pHist : m_vecHist) {
+            pHist->Reset();
+        }
+        for (auto& kv : m_mapEdge) {
+            kv.second->Reset();
+        }
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtxTrace);
+    m_vecTrace.clear();
+    m_nTraceIndex = 0;
+}
@@ -0,0 +1,326 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+#include <time.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AXSingleton.h"
+#include "ax_base_type.h"
+
+/* 8 linear sub buckets per power of 2, relative error <= 12.5% */
+#define LATENCY_HIST_SUB_BITS (3)
+#define LATENCY_HIST_SUB_NUM (1 << LATENCY_HIST_SUB_BITS)
+/* values are clamped to 2^27 us (134s) */
+#define LATENCY_HIST_MAX_BITS (27)
+#define LATENCY_HIST_BUCKET_NUM ((LATENCY_HIST_MAX_BITS - LATENCY_HIST_SUB_BITS + 1) * LATENCY_HIST_SUB_NUM)
+
+/* stamps kept by one frame, later stamps are dropped */
+#define LATENCY_TRAIL_MAX_NUM (16)
+/* trace points (sources and stages) */
+#define LATENCY_POINT_MAX_NUM (256)
+#define LATENCY_POINT_INVALID (0)
+/* finished trails kept for trace export */
+#define LATENCY_TRACE_RING_NUM (128)
+/* edges into a point which are looked up without lock, more are looked up under registry lock */
+#define LATENCY_EDGE_SLOT_NUM (4)
+
+typedef enum {
+    LATENCY_STAMP_SOURCE = 0,  /* frame got from SDK, origin of trail */
+    LATENCY_STAMP_ENQUEUE = 1, /* frame pushed to stage queue */
+    LATENCY_STAMP_DEQUEUE = 2, /* frame popped by stage thread */
+    LATENCY_STAMP_NOTIFY = 3,  /* observer callbacks of source are done */
+    LATENCY_STAMP_BUTT
+} LATENCY_STAMP_E;
+
+/* histograms of a trace point */
+typedef enum {
+    LATENCY_HIST_WAIT = 0,   /* stage: dequeue - enqueue */
+    LATENCY_HIST_AGE = 1,    /* stage: dequeue - origin */
+    LATENCY_HIST_NOTIFY = 2, /* source: duration of one observer callback */
+    LATENCY_HIST_BUTT
+} LATENCY_HIST_E;
+
+typedef struct {
+    AX_U64 nCount{0};
+    AX_U32 nMean{0};
+    AX_U32 nP50{0};
+    AX_U32 nP99{0};
+    AX_U32 nP999{0};
+    AX_U32 nMax{0};
+} LATENCY_STAT_T;
+
+/**
+ * @brief Log-linear (HDR style) histogram of latency in us, recorded lock free by any thread.
+ */
+class CLatencyHistogram final {
+public:
+    CLatencyHistogram(AX_VOID) {
+        Reset();
+    }
+
+    AX_VOID Record(AX_U64 nUs) {
+        AX_U32 nValue = (nUs >= (1ULL << LATENCY_HIST_MAX_BITS)) ? (AX_U32)((1ULL << LATENCY_HIST_MAX_BITS) - 1) : (AX_U32)nUs;
+        m_arrBucket[Value2Index(nValue)].fetch_add(1, std::memory_order_relaxed);
+        m_nCount.fetch_add(1, std::memory_order_relaxed);
+        m_nSum.fetch_add(nValue, std::memory_order_relaxed);
+
+        AX_U32 nMax = m_nMax.load(std::memory_order_relaxed);
+        while (nValue > nMax && !m_nMax.compare_exchange_weak(nMax, nValue, std::memory_order_relaxed)) {
+        }
+    }
+
+    /* not a consistent snapshot while recording, good enough for percentiles */
+    AX_VOID GetStat(LATENCY_STAT_T& tStat) const;
+
+    AX_VOID Reset(AX_VOID) {
+        for (auto& m : m_arrBucket) {
+            m.store(0, std::memory_order_relaxed);
+        }
+        m_nCount.store(0, std::memory_order_relaxed);
+        m_nSum.store(0, std::memory_order_relaxed);
+        m_nMax.store(0, std::memory_order_relaxed);
+    }
+
+    static AX_U32 Value2Index(AX_U32 nValue) {
+        if (nValue < LATENCY_HIST_SUB_NUM) {
+            return nValue;
+        }
+
+        AX_U32 nExp = 31 - __builtin_clz(nValue);
+        AX_U32 nSub = (nValue >> (nExp - LATENCY_HIST_SUB_BITS)) & (LATENCY_HIST_SUB_NUM - 1);
+        return (nExp - LATENCY_HIST_SUB_BITS + 1) * LATENCY_HIST_SUB_NUM + nSub;
+    }
+
+    /* highest value of bucket */
+    static AX_U32 Index2Value(AX_U32 nIndex) {
+        if (nIndex < LATENCY_HIST_SUB_NUM) {
+            return nIndex;
+        }
+
+        AX_U32 nExp = nIndex / LATENCY_HIST_SUB_NUM + LATENCY_HIST_SUB_BITS - 1;
+        AX_U32 nSub = nIndex % LATENCY_HIST_SUB_NUM;
+        AX_U32 nWidth = 1U << (nExp - LATENCY_HIST_SUB_BITS);
+        return ((LATENCY_HIST_SUB_NUM + nSub) << (nExp - LATENCY_HIST_SUB_BITS)) + nWidth - 1;
+    }
+
+private:
+    std::atomic<AX_U32> m_arrBucket[LATENCY_HIST_BUCKET_NUM];
+    std::atomic<AX_U64> m_nCount;
+    std::atomic<AX_U64> m_nSum;
+    std::atomic<AX_U32> m_nMax;
+};
+
+/**
+ * @brief Compact timestamp trail carried by CAXFrame.
+ *
+ *  Each stamp is packed into one atomic word: point(16) | kind(8) | us since origin(32),
+ *  so successors sharing a multiplexed frame can stamp concurrently.
+ */
+class CLatencyTrail final {
+public:
+    CLatencyTrail(AX_VOID) = default;
+    CLatencyTrail(const CLatencyTrail& rhs) {
+        *this = rhs;
+    }
+
+    CLatencyTrail& operator=(const CLatencyTrail& rhs) {
+        if (this != &rhs) {
+            m_nOrigin = rhs.m_nOrigin;
+            m_nSeq = rhs.m_nSeq;
+            AX_U32 nCount = rhs.GetCount();
+            for (AX_U32 i = 0; i < nCount; ++i) {
+                m_arrStamp[i].store(rhs.m_arrStamp[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            m_nCount.store(nCount, std::memory_order_relaxed);
+        }
+        return *this;
+    }
+
+    /* by producer before frame is shared */
+    AX_VOID Start(AX_U16 nPoint, AX_U64 nSeq, AX_U64 nNowUs) {
+        Clear();
+        m_nOrigin = nNowUs;
+        m_nSeq = nSeq;
+        Stamp(nPoint, LATENCY_STAMP_SOURCE, nNowUs);
+    }
+
+    /* frame object is reused or tracing is off */
+    AX_VOID Clear(AX_VOID) {
+        AX_U32 nCount = GetCount();
+        for (AX_U32 i = 0; i < nCount; ++i) {
+            m_arrStamp[i].store(0, std::memory_order_relaxed);
+        }
+        m_nCount.store(0, std::memory_order_relaxed);
+        m_nOrigin = 0;
+        m_nSeq = 0;
+    }
+
+    AX_BOOL IsStarted(AX_VOID) const {
+        return (0 != m_nOrigin) ? AX_TRUE : AX_FALSE;
+    }
+
+    AX_VOID Stamp(AX_U16 nPoint, LATENCY_STAMP_E eKind, AX_U64 nNowUs) {
+        if (!IsStarted()) {
+            return;
+        }
+
+        AX_U32 nIndex = m_nCount.fetch_add(1, std::memory_order_relaxed);
+        if (nIndex >= LATENCY_TRAIL_MAX_NUM) {
+            m_nCount.store(LATENCY_TRAIL_MAX_NUM, std::memory_order_relaxed);
+            return;
+        }
+
+        AX_U64 nDelta = (nNowUs > m_nOrigin) ? nNowUs - m_nOrigin : 0;
+        if (nDelta > 0xFFFFFFFF) {
+            nDelta = 0xFFFFFFFF;
+        }
+        m_arrStamp[nIndex].store(((AX_U64)nPoint << 48) | ((AX_U64)eKind << 40) | nDelta, std::memory_order_release);
+    }
+
+    /* absolute time of latest stamp of point, 0 if not found */
+    AX_U64 Find(AX_U16 nPoint, LATENCY_STAMP_E eKind) const {
+        AX_U32 nCount = GetCount();
+        for (AX_S32 i = (AX_S32)nCount - 1; i >= 0; --i) {
+            AX_U64 nStamp = m_arrStamp[i].load(std::memory_order_acquire);
+            if (0 != nStamp && GetPoint(nStamp) == nPoint && GetKind(nStamp) == eKind) {
+                return m_nOrigin + GetDelta(nStamp);
+            }
+        }
+
+        return 0;
+    }
+
+    AX_U32 GetCount(AX_VOID) const {
+        AX_U32 nCount = m_nCount.load(std::memory_order_relaxed);
+        return (nCount > LATENCY_TRAIL_MAX_NUM) ? LATENCY_TRAIL_MAX_NUM : nCount;
+    }
+
+    /* 0 if slot is reserved but not written yet */
+    AX_U64 GetStamp(AX_U32 nIndex) const {
+        return (nIndex < LATENCY_TRAIL_MAX_NUM) ? m_arrStamp[nIndex].load(std::memory_order_acquire) : 0;
+    }
+
+    /* point which started the trail */
+    AX_U16 GetSource(AX_VOID) const {
+        return IsStarted() ? GetPoint(GetStamp(0)) : (AX_U16)LATENCY_POINT_INVALID;
+    }
+
+    AX_U64 GetOrigin(AX_VOID) const {
+        return m_nOrigin;
+    }
+
+    AX_U64 GetSeq(AX_VOID) const {
+        return m_nSeq;
+    }
+
+    static AX_U16 GetPoint(AX_U64 nStamp) {
+        return (AX_U16)(nStamp >> 48);
+    }
+
+    static LATENCY_STAMP_E GetKind(AX_U64 nStamp) {
+        return (LATENCY_STAMP_E)((nStamp >> 40) & 0xFF);
+    }
+
+    static AX_U32 GetDelta(AX_U64 nStamp) {
+        return (AX_U32)(nStamp & 0xFFFFFFFF);
+    }
+
+private:
+    AX_U64 m_nOrigin{0};
+    AX_U64 m_nSeq{0};
+    std::atomic<AX_U32> m_nCount{0};
+    std::atomic<AX_U64> m_arrStamp[LATENCY_TRAIL_MAX_NUM]{};
+};
+
+/**
+ * @brief Registry of trace points and histograms, fed by frame trails.
+ *
+ *  Source (VIN/IVPS chn, encoded stream of VENC) and CAXStage register a point once, hot path only stamps
+ *  the trail and records into histograms by point id, no lock is taken unless a finished trail is kept for
+ *  trace export or a new edge is seen.
+ *  Histograms:
+ *      <stage>.wait     queue wait of stage
+ *      <stage>.age      frame age when stage starts processing, from source; of stream: age when sinks get it
+ *      <source>.notify  one observer (sink) callback of source
+ *      <A>-><B>         from A handing the frame out (source got it, stage dequeued it) until B received it
+ */
+class CLatencyTracer final : public CAXSingleton<CLatencyTracer> {
+    friend class CAXSingleton<CLatencyTracer>;
+
+public:
+    static AX_U64 NowUs(AX_VOID) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (AX_U64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    }
+
+    AX_VOID Enable(AX_BOOL bEnable) {
+        m_bEnable.store(bEnable, std::memory_order_relaxed);
+    }
+
+    AX_BOOL IsEnabled(AX_VOID) const {
+        return m_bEnable.load(std::memory_order_relaxed);
+    }
+
+    /* same name returns same point */
+    AX_U16 RegisterPoint(const std::string& strName);
+    CLatencyHistogram* RegisterEdge(AX_U16 nFrom, AX_U16 nTo);
+    /* lock free once the edge is registered, unless the point has more than LATENCY_EDGE_SLOT_NUM edges in */
+    CLatencyHistogram* GetEdge(AX_U16 nFrom, AX_U16 nTo);
+
+    CLatencyHistogram* GetHistogram(AX_U16 nPoint, LATENCY_HIST_E eHist) const {
+        return (nPoint < LATENCY_POINT_MAX_NUM && eHist < LATENCY_HIST_BUTT) ? m_arrHist[nPoint][eHist] : nullptr;
+    }
+
+    /* stamp helpers of stage, enqueue also records edge <source>-><stage> */
+    AX_VOID OnEnqueue(CLatencyTrail& tTrail, AX_U16 nPoint);
+    AX_VOID OnDequeue(CLatencyTrail& tTrail, AX_U16 nPoint);
+
+    /* frame is released by producer, keep trail for trace export */
+    AX_VOID Collect(const CLatencyTrail& tTrail);
+
+    /* JSON of all histograms with count, mean, p50, p99, p99.9 and max in us; return length or 0 if buffer is too small */
+    AX_U32 DumpStat(AX_CHAR* pBuf, AX_U32 nSize);
+    /* Chrome trace event JSON (chrome://tracing, perfetto) of kept trails */
+    AX_U32 DumpTrace(AX_CHAR* pBuf, AX_U32 nSize);
+    static AX_U32 GetTraceBufSize(AX_VOID) {
+        return LATENCY_TRACE_RING_NUM * LATENCY_TRAIL_MAX_NUM * 256 + 64 * 1024;
+    }
+
+    AX_VOID Reset(AX_VOID);
+
+private:
+    CLatencyTracer(AX_VOID) = default;
+    ~CLatencyTracer(AX_VOID) = default;
+
+private:
+    std::atomic<AX_BOOL> m_bEnable{AX_FALSE};
+
+    std::mutex m_mtxRegistry;
+    std::map<std::string, AX_U16> m_mapPoint;
+    std::vector<std::string> m_vecPointName{""};
+    CLatencyHistogram* m_arrHist[LATENCY_POINT_MAX_NUM][LATENCY_HIST_BUTT]{};
+    std::map<AX_U32 /* from << 16 | to */, std::unique_ptr<CLatencyHistogram>> m_mapEdge;
+    /* edges into a point, histogram is set before nFrom is published */
+    struct {
+        std::atomic<AX_U16> nFrom{LATENCY_POINT_INVALID};
+        CLatencyHistogram* pHist{nullptr};
+    } m_arrEdgeSlot[LATENCY_POINT_MAX_NUM][LATENCY_EDGE_SLOT_NUM];
+    std::vector<std::unique_ptr<CLatencyHistogram>> m_vecHist;
+
+    std::mutex m_mtxTrace;
+    std::vector<CLatencyTrail> m_vecTrace;
+    AX_U32 m_nTraceIndex{0};
+};
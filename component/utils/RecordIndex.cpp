@@ -0,0 +1,536 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#include "RecordIndex.hpp"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include "AppLogApi.h"
+
+#define REC_INDEX "REC_INDEX"
+
+/* removed entries are compacted away once they are more than live ones and at least this many */
+#define RECORD_INDEX_COMPACT_MIN (1024)
+#define RECORD_INDEX_COPY_KEYS (256)
+
+static_assert(sizeof(RECORD_INDEX_HEAD_T) == 40, "record index head size changed");
+static_assert(sizeof(RECORD_INDEX_ENTRY_T) == 128, "record index entry size changed");
+static_assert(sizeof(RECORD_INDEX_KEY_T) == 24, "record index key size changed");
+
+namespace {
+
+AX_U32 CheckSum(const AX_VOID* pData, size_t nLen) {
+    /* fnv-1a, only used to find torn records */
+    const AX_U8* p = (const AX_U8*)pData;
+    AX_U32 nHash = 2166136261u;
+    for (size_t i = 0; i < nLen; ++i) {
+        nHash = (nHash ^ p[i]) * 16777619u;
+    }
+    return nHash;
+}
+
+template <typename T>
+AX_VOID Seal(T& t) {
+    t.nCheckSum = CheckSum(&t, offsetof(T, nCheckSum));
+}
+
+template <typename T>
+AX_BOOL IsSealed(const T& t) {
+    return (t.nCheckSum == CheckSum(&t, offsetof(T, nCheckSum))) ? AX_TRUE : AX_FALSE;
+}
+
+RECORD_INDEX_HEAD_T MakeHead(AX_U32 nMagic, AX_U32 nRecordSize, AX_U64 nKeyBase) {
+    RECORD_INDEX_HEAD_T tHead;
+    memset(&tHead, 0, sizeof(tHead));
+    tHead.nMagic = nMagic;
+    tHead.nVersion = RECORD_INDEX_VERSION;
+    tHead.nRecordSize = nRecordSize;
+    tHead.nKeyBase = nKeyBase;
+    Seal(tHead);
+    return tHead;
+}
+
+AX_BOOL IsValidHead(const RECORD_INDEX_HEAD_T& tHead, AX_U32 nMagic, AX_U32 nRecordSize) {
+    return (nMagic == tHead.nMagic && RECORD_INDEX_VERSION == tHead.nVersion && nRecordSize == tHead.nRecordSize && IsSealed(tHead))
+               ? AX_TRUE
+               : AX_FALSE;
+}
+
+AX_BOOL PWriteFull(AX_S32 nFd, const AX_VOID* pData, size_t nSize, off_t nOffset) {
+    const AX_U8* p = (const AX_U8*)pData;
+    while (nSize > 0) {
+        ssize_t nRet = pwrite(nFd, p, nSize, nOffset);
+        if (nRet < 0) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return AX_FALSE;
+        }
+        p += nRet;
+        nSize -= (size_t)nRet;
+        nOffset += nRet;
+    }
+    return AX_TRUE;
+}
+
+AX_BOOL PReadFull(AX_S32 nFd, AX_VOID* pData, size_t nSize, off_t nOffset) {
+    AX_U8* p = (AX_U8*)pData;
+    while (nSize > 0) {
+        ssize_t nRet = pread(nFd, p, nSize, nOffset);
+        if (nRet < 0 && EINTR == errno) {
+            continue;
+        }
+        if (nRet <= 0) {
+            return AX_FALSE;
+        }
+        p += nRet;
+        nSize -= (size_t)nRet;
+        nOffset += nRet;
+    }
+    return AX_TRUE;
+}
+
+off_t EntryOffset(AX_U64 nEntry) {
+    return (off_t)(sizeof(RECORD_INDEX_HEAD_T) + nEntry * sizeof(RECORD_INDEX_ENTRY_T));
+}
+
+off_t KeyOffset(AX_U64 nKey) {
+    return (off_t)(sizeof(RECORD_INDEX_HEAD_T) + nKey * sizeof(RECORD_INDEX_KEY_T));
+}
+
+}  // namespace
+
+AX_BOOL CRecordIndex::Open(const std::string& strDir, const std::string& strPrefix, const std::string& strExt) {
+    Close();
+
+    m_strDir = strDir;
+    m_strPrefix = strPrefix;
+    m_strExt = strExt;
+
+    AX_BOOL bExisted = (0 == access(IndexPath().c_str(), F_OK)) ? AX_TRUE : AX_FALSE;
+    if (Load()) {
+        LOG_MM_I(REC_INDEX, "%s: %d files, %lld MB", IndexPath().c_str(), GetCount(), m_nTotalSize >> 20);
+        return AX_TRUE;
+    }
+
+    Close();
+    if (!Rebuild()) {
+        LOG_MM_E(REC_INDEX, "rebuild %s failed, %s", IndexPath().c_str(), strerror(errno));
+        Close();
+        return AX_FALSE;
+    }
+
+    if (bExisted) {
+        LOG_MM_W(REC_INDEX, "%s corrupted, rebuilt from directory: %d files, %lld MB", IndexPath().c_str(), GetCount(),
+                 m_nTotalSize >> 20);
+    } else {
+        LOG_MM_I(REC_INDEX, "%s created from directory: %d files, %lld MB", IndexPath().c_str(), GetCount(), m_nTotalSize >> 20);
+    }
+    return AX_TRUE;
+}
+
+AX_VOID CRecordIndex::Close(AX_VOID) {
+    if (m_nIdxFd >= 0) {
+        close(m_nIdxFd);
+        m_nIdxFd = -1;
+    }
+    if (m_nKeyFd >= 0) {
+        close(m_nKeyFd);
+        m_nKeyFd = -1;
+    }
+
+    memset(&m_tHead, 0, sizeof(m_tHead));
+    m_dqEntries.clear();
+    m_nKeyCount = 0;
+    m_nTotalSize = 0;
+}
+
+AX_BOOL CRecordIndex::Load(AX_VOID) {
+    m_nIdxFd = open(IndexPath().c_str(), O_RDWR | O_CLOEXEC);
+    m_nKeyFd = open(KeyPath().c_str(), O_RDWR | O_CLOEXEC);
+    if (m_nIdxFd < 0 || m_nKeyFd < 0) {
+        return AX_FALSE;
+    }
+
+    struct stat stIdx;
+    struct stat stKey;
+    if (fstat(m_nIdxFd, &stIdx) != 0 || fstat(m_nKeyFd, &stKey) != 0) {
+        return AX_FALSE;
+    }
+
+    /* a torn entry append is corruption, a torn key append was never referenced */
+    if ((size_t)stIdx.st_size < sizeof(RECORD_INDEX_HEAD_T) || (size_t)stKey.st_size < sizeof(RECORD_INDEX_HEAD_T) ||
+        0 != (stIdx.st_size - sizeof(RECORD_INDEX_HEAD_T)) % sizeof(RECORD_INDEX_ENTRY_T)) {
+        return AX_FALSE;
+    }
+
+    RECORD_INDEX_HEAD_T tKeyHead;
+    if (!PReadFull(m_nKeyFd, &tKeyHead, sizeof(tKeyHead), 0) ||
+        !IsValidHead(tKeyHead, RECORD_INDEX_KEY_MAGIC, sizeof(RECORD_INDEX_KEY_T))) {
+        return AX_FALSE;
+    }
+    m_nKeyCount = (stKey.st_size - sizeof(RECORD_INDEX_HEAD_T)) / sizeof(RECORD_INDEX_KEY_T);
+    if ((off_t)KeyOffset(m_nKeyCount) != stKey.st_size && ftruncate(m_nKeyFd, KeyOffset(m_nKeyCount)) != 0) {
+        return AX_FALSE;
+    }
+
+    AX_VOID* pMap = mmap(nullptr, stIdx.st_size, PROT_READ, MAP_SHARED, m_nIdxFd, 0);
+    if (MAP_FAILED == pMap) {
+        return AX_FALSE;
+    }
+
+    AX_BOOL bValid = AX_FALSE;
+    do {
+        memcpy(&m_tHead, pMap, sizeof(m_tHead));
+        AX_U64 nEntries = (stIdx.st_size - sizeof(RECORD_INDEX_HEAD_T)) / sizeof(RECORD_INDEX_ENTRY_T);
+        if (!IsValidHead(m_tHead, RECORD_INDEX_MAGIC, sizeof(RECORD_INDEX_ENTRY_T)) || m_tHead.nKeyBase != tKeyHead.nKeyBase ||
+            m_tHead.nHead > nEntries) {
+            break;
+        }
+
+        const RECORD_INDEX_ENTRY_T* pEntries = (const RECORD_INDEX_ENTRY_T*)((const AX_U8*)pMap + sizeof(RECORD_INDEX_HEAD_T));
+        AX_U64 i = m_tHead.nHead;
+        for (; i < nEntries; ++i) {
+            const RECORD_INDEX_ENTRY_T& tEntry = pEntries[i];
+            if (!IsSealed(tEntry) || 0 != tEntry.szName[RECORD_INDEX_NAME_LEN - 1] ||
+                (tEntry.nKeyCount > 0 &&
+                 (tEntry.nKeyFirst < m_tHead.nKeyBase || tEntry.nKeyFirst + tEntry.nKeyCount > m_tHead.nKeyBase + m_nKeyCount))) {
+                break;
+            }
+            m_dqEntries.push_back(tEntry);
+            m_nTotalSize += tEntry.nSize;
+        }
+        bValid = (i == nEntries) ? AX_TRUE : AX_FALSE;
+    } while (0);
+
+    munmap(pMap, stIdx.st_size);
+
+    return bValid;
+}
+
+AX_BOOL CRecordIndex::Rebuild(AX_VOID) {
+    std::vector<RECORD_INDEX_ENTRY_T> vecEntries;
+
+    DIR* pDir = opendir(m_strDir.c_str());
+    if (pDir) {
+        struct dirent* pDirent = nullptr;
+        while ((pDirent = readdir(pDir)) != nullptr) {
+            std::string strName = pDirent->d_name;
+            if (strName.size() <= m_strPrefix.size() + m_strExt.size() || strName.size() >= RECORD_INDEX_NAME_LEN ||
+                0 != strName.compare(0, m_strPrefix.size(), m_strPrefix) ||
+                0 != strName.compare(strName.size() - m_strExt.size(), m_strExt.size(), m_strExt)) {
+                continue;
+            }
+
+            struct stat st;
+            if (stat((m_strDir + "/" + strName).c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+                continue;
+            }
+
+            RECORD_INDEX_ENTRY_T tEntry;
+            memset(&tEntry, 0, sizeof(tEntry));
+            memcpy(tEntry.szName, strName.c_str(), strName.size());
+            tEntry.nSize = st.st_size;
+            tEntry.nStartTime = st.st_mtime;
+
+            /* writers name files <prefix>YYYYmmdd_HHMMSS..., which is the creation time */
+            struct tm tmName;
+            memset(&tmName, 0, sizeof(tmName));
+            if (strptime(strName.c_str() + m_strPrefix.size(), "%Y%m%d_%H%M%S", &tmName)) {
+                tmName.tm_isdst = -1;
+                tEntry.nStartTime = mktime(&tmName);
+            }
+
+            Seal(tEntry);
+            vecEntries.push_back(tEntry);
+        }
+        closedir(pDir);
+    }
+
+    std::sort(vecEntries.begin(), vecEntries.end(), [](const RECORD_INDEX_ENTRY_T& a, const RECORD_INDEX_ENTRY_T& b) -> bool {
+        return (a.nStartTime != b.nStartTime) ? (a.nStartTime < b.nStartTime) : (strcmp(a.szName, b.szName) < 0);
+    });
+
+    for (auto& tEntry : vecEntries) {
+        m_dqEntries.push_back(tEntry);
+        m_nTotalSize += tEntry.nSize;
+    }
+
+    return Rewrite(0);
+}
+
+AX_BOOL CRecordIndex::Compact(AX_VOID) {
+    /* entries rebuilt from directory have no key frames and keep nKeyFirst 0 */
+    AX_U64 nKeyBase = m_dqEntries.empty() ? m_tHead.nKeyBase + m_nKeyCount : std::max(m_dqEntries.front().nKeyFirst, m_tHead.nKeyBase);
+    if (!Rewrite(nKeyBase)) {
+        LOG_MM_E(REC_INDEX, "compact %s failed, %s", IndexPath().c_str(), strerror(errno));
+        return AX_FALSE;
+    }
+
+    return AX_TRUE;
+}
+
+AX_BOOL CRecordIndex::Rewrite(AX_U64 nKeyBase) {
+    /* written aside and renamed, key file first: a crash in between leaves key bases unequal, which rebuilds */
+    std::string strIdxTmp = IndexPath() + ".tmp";
+    std::string strKeyTmp = KeyPath() + ".tmp";
+    AX_S32 nIdxFd = open(strIdxTmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    AX_S32 nKeyFd = open(strKeyTmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+    RECORD_INDEX_HEAD_T tHead = MakeHead(RECORD_INDEX_MAGIC, sizeof(RECORD_INDEX_ENTRY_T), nKeyBase);
+    RECORD_INDEX_HEAD_T tKeyHead = MakeHead(RECORD_INDEX_KEY_MAGIC, sizeof(RECORD_INDEX_KEY_T), nKeyBase);
+    AX_U64 nKeyCount = 0;
+
+    AX_BOOL bRet = AX_FALSE;
+    do {
+        if (nIdxFd < 0 || nKeyFd < 0 || !PWriteFull(nIdxFd, &tHead, sizeof(tHead), 0) ||
+            !PWriteFull(nKeyFd, &tKeyHead, sizeof(tKeyHead), 0)) {
+            break;
+        }
+
+        AX_U64 nKeyEnd = m_tHead.nKeyBase + m_nKeyCount;
+        if (m_nKeyFd >= 0 && nKeyBase < nKeyEnd) {
+            std::vector<RECORD_INDEX_KEY_T> vecKeys(RECORD_INDEX_COPY_KEYS);
+            AX_U64 nKey = nKeyBase;
+            while (nKey < nKeyEnd) {
+                size_t nCount = (size_t)std::min<AX_U64>(RECORD_INDEX_COPY_KEYS, nKeyEnd - nKey);
+                if (!PReadFull(m_nKeyFd, vecKeys.data(), nCount * sizeof(RECORD_INDEX_KEY_T), KeyOffset(nKey - m_tHead.nKeyBase)) ||
+                    !PWriteFull(nKeyFd, vecKeys.data(), nCount * sizeof(RECORD_INDEX_KEY_T), KeyOffset(nKeyCount))) {
+                    break;
+                }
+                nKey += nCount;
+                nKeyCount += nCount;
+            }
+            if (nKey < nKeyEnd) {
+                break;
+            }
+        }
+
+        std::vector<RECORD_INDEX_ENTRY_T> vecEntries(m_dqEntries.begin(), m_dqEntries.end());
+        if (!vecEntries.empty() &&
+            !PWriteFull(nIdxFd, vecEntries.data(), vecEntries.size() * sizeof(RECORD_INDEX_ENTRY_T), EntryOffset(0))) {
+            break;
+        }
+
+        if (fdatasync(nKeyFd) != 0 || fdatasync(nIdxFd) != 0 || rename(strKeyTmp.c_str(), KeyPath().c_str()) != 0 ||
+            rename(strIdxTmp.c_str(), IndexPath().c_str()) != 0) {
+            break;
+        }
+
+        bRet = AX_TRUE;
+    } while (0);
+
+    if (!bRet) {
+        if (nIdxFd >= 0) {
+            close(nIdxFd);
+            unlink(strIdxTmp.c_str());
+        }
+        if (nKeyFd >= 0) {
+            close(nKeyFd);
+            unlink(strKeyTmp.c_str());
+        }
+        return AX_FALSE;
+    }
+
+    if (m_nIdxFd >= 0) {
+        close(m_nIdxFd);
+    }
+    if (m_nKeyFd >= 0) {
+        close(m_nKeyFd);
+    }
+    m_nIdxFd = nIdxFd;
+    m_nKeyFd = nKeyFd;
+    m_tHead = tHead;
+    m_nKeyCount = nKeyCount;
+
+    return AX_TRUE;
+}
+
+AX_BOOL CRecordIndex::Append(const std::string& strName, time_t tStart) {
+    if (m_nIdxFd < 0 || strName.empty() || strName.size() >= RECORD_INDEX_NAME_LEN) {
+        return AX_FALSE;
+    }
+
+    RECORD_INDEX_ENTRY_T tEntry;
+    memset(&tEntry, 0, sizeof(tEntry));
+    memcpy(tEntry.szName, strName.c_str(), strName.size());
+    tEntry.nStartTime = (AX_U64)tStart;
+    tEntry.nKeyFirst = m_tHead.nKeyBase + m_nKeyCount;
+
+    m_dqEntries.push_back(tEntry);
+    if (!WriteLastEntry()) {
+        m_dqEntries.pop_back();
+        return AX_FALSE;
+    }
+
+    return AX_TRUE;
+}
+
+AX_BOOL CRecordIndex::Update(AX_U64 nSize, AX_U64 nEndPts) {
+    if (m_dqEntries.empty()) {
+        return AX_FALSE;
+    }
+
+    RECORD_INDEX_ENTRY_T& tEntry = m_dqEntries.back();
+    m_nTotalSize = m_nTotalSize - tEntry.nSize + nSize;
+    tEntry.nSize = nSize;
+    tEntry.nEndPts = nEndPts;
+
+    return WriteLastEntry();
+}
+
+AX_BOOL CRecordIndex::AddKeyFrame(AX_U64 nOffset, AX_U64 nPts) {
+    if (m_dqEntries.empty() || m_nKeyFd < 0) {
+        return AX_FALSE;
+    }
+
+    RECORD_INDEX_KEY_T tKey;
+    memset(&tKey, 0, sizeof(tKey));
+    tKey.nPts = nPts;
+    tKey.nOffset = nOffset;
+    Seal(tKey);
+    if (!PWriteFull(m_nKeyFd, &tKey, sizeof(tKey), KeyOffset(m_nKeyCount))) {
+        return AX_FALSE;
+    }
+    ++m_nKeyCount;
+
+    RECORD_INDEX_ENTRY_T& tEntry = m_dqEntries.back();
+    if (0 == tEntry.nKeyCount) {
+        tEntry.nStartPts = nPts;
+    }
+    ++tEntry.nKeyCount;
+
+    return WriteLastEntry();
+}
+
+AX_VOID CRecordIndex::Sync(AX_VOID) {
+    if (m_nKeyFd >= 0) {
+        fdatasync(m_nKeyFd);
+    }
+    if (m_nIdxFd >= 0) {
+        fdatasync(m_nIdxFd);
+    }
+}
+
+AX_BOOL CRecordIndex::PopFront(AX_VOID) {
+    if (m_dqEntries.empty()) {
+        return AX_FALSE;
+    }
+
+    m_nTotalSize -= m_dqEntries.front().nSize;
+    m_dqEntries.pop_front();
+    ++m_tHead.nHead;
+    if (!WriteHead()) {
+        return AX_FALSE;
+    }
+
+    if (m_tHead.nHead >= RECORD_INDEX_COMPACT_MIN && m_tHead.nHead >= m_dqEntries.size()) {
+        Compact();
+    }
+
+    return AX_TRUE;
+}
+
+AX_BOOL CRecordIndex::WriteHead(AX_VOID) {
+    if (m_nIdxFd < 0) {
+        return AX_FALSE;
+    }
+
+    Seal(m_tHead);
+    return PWriteFull(m_nIdxFd, &m_tHead, sizeof(m_tHead), 0);
+}
+
+AX_BOOL CRecordIndex::WriteLastEntry(AX_VOID) {
+    if (m_nIdxFd < 0 || m_dqEntries.empty()) {
+        return AX_FALSE;
+    }
+
+    RECORD_INDEX_ENTRY_T& tEntry = m_dqEntries.back();
+    Seal(tEntry);
+    return PWriteFull(m_nIdxFd, &tEntry, sizeof(tEntry), EntryOffset(m_tHead.nHead + m_dqEntries.size() - 1));
+}
+
+AX_BOOL CRecordIndex::ReadKey(AX_U64 nKey, RECORD_INDEX_KEY_T& tKey) const {
+    if (m_nKeyFd < 0 || nKey < m_tHead.nKeyBase || nKey >= m_tHead.nKeyBase + m_nKeyCount) {
+        return AX_FALSE;
+    }
+
+    return (PReadFull(m_nKeyFd, &tKey, sizeof(tKey), KeyOffset(nKey - m_tHead.nKeyBase)) && IsSealed(tKey)) ? AX_TRUE : AX_FALSE;
+}
+
+AX_BOOL CRecordIndex::FindByTime(time_t tStart, time_t tEnd, AX_U32& nFirst, AX_U32& nLast) const {
+    if (m_dqEntries.empty() || tEnd < tStart) {
+        return AX_FALSE;
+    }
+
+    auto fnLess = [](AX_U64 nTime, const RECORD_INDEX_ENTRY_T& tEntry) -> bool { return nTime < tEntry.nStartTime; };
+    auto itLast = std::upper_bound(m_dqEntries.begin(), m_dqEntries.end(), (AX_U64)tEnd, fnLess);
+    if (itLast == m_dqEntries.begin()) {
+        return AX_FALSE;
+    }
+
+    auto itFirst = std::upper_bound(m_dqEntries.begin(), itLast, (AX_U64)tStart, fnLess);
+    if (itFirst != m_dqEntries.begin()) {
+        --itFirst;
+        /* file started before tStart, skip it if pts show it also ended before */
+        const RECORD_INDEX_ENTRY_T& tEntry = *itFirst;
+        if (tEntry.nEndPts > tEntry.nStartPts && tEntry.nStartTime + (tEntry.nEndPts - tEntry.nStartPts) / 1000000 < (AX_U64)tStart) {
+            ++itFirst;
+        }
+    }
+
+    if (itFirst >= itLast) {
+        return AX_FALSE;
+    }
+
+    nFirst = (AX_U32)(itFirst - m_dqEntries.begin());
+    nLast = (AX_U32)(itLast - m_dqEntries.begin() - 1);
+
+    return AX_TRUE;
+}
+
+AX_BOOL CRecordIndex::FindKeyFrame(AX_U32 nIndex, AX_U64 nPts, AX_U64& nOffset) const {
+    if (nIndex >= m_dqEntries.size() || 0 == m_dqEntries[nIndex].nKeyCount) {
+        return AX_FALSE;
+    }
+
+    const RECORD_INDEX_ENTRY_T& tEntry = m_dqEntries[nIndex];
+    RECORD_INDEX_KEY_T tKey;
+    if (!ReadKey(tEntry.nKeyFirst, tKey)) {
+        return AX_FALSE;
+    }
+
+    /* key[nLo].nPts <= nPts < key[nHi].nPts, pts before the first key frame map to it */
+    nOffset = tKey.nOffset;
+    AX_U64 nLo = 0;
+    AX_U64 nHi = tEntry.nKeyCount;
+    while (nHi - nLo > 1) {
+        AX_U64 nMid = nLo + (nHi - nLo) / 2;
+        if (!ReadKey(tEntry.nKeyFirst + nMid, tKey)) {
+            return AX_FALSE;
+        }
+
+        if (tKey.nPts <= nPts) {
+            nLo = nMid;
+            nOffset = tKey.nOffset;
+        } else {
+            nHi = nMid;
+        }
+    }
+
+    return AX_TRUE;
+}
@@ -0,0 +1,135 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+#include <time.h>
+#include <deque>
+#include <string>
+#include "ax_base_type.h"
+
+/*
+    Persistent index of the recording files of one writer, so that startup, disk sweep and playback lookup
+    do not walk the directory. Both files are fixed size records and can be read by mmap:
+        <dir>/<prefix>record.idx: RECORD_INDEX_HEAD_T + RECORD_INDEX_ENTRY_T * n, oldest first
+        <dir>/<prefix>record.key: RECORD_INDEX_HEAD_T + RECORD_INDEX_KEY_T * n, key frames of all entries
+    New entries and key frames are appended, only the last entry is rewritten while its file is recorded.
+    Removed entries are skipped by nHead and compacted away once they are the majority.
+    The index is rebuilt from directory only if it is missing or corrupted, rebuilt entries have no pts and key frames.
+*/
+#define RECORD_INDEX_MAGIC (0x49525841)     /* "AXRI" */
+#define RECORD_INDEX_KEY_MAGIC (0x4B525841) /* "AXRK" */
+#define RECORD_INDEX_VERSION (1)
+#define RECORD_INDEX_NAME_LEN (64)
+
+typedef struct RECORD_INDEX_HEAD_S {
+    AX_U32 nMagic;
+    AX_U32 nVersion;
+    AX_U32 nRecordSize;
+    AX_U32 nReserved;
+    AX_U64 nHead;    /* .idx: entries before are removed */
+    AX_U64 nKeyBase; /* key number of the first record in .key, same in both files */
+    AX_U32 nReserved2;
+    AX_U32 nCheckSum;
+} RECORD_INDEX_HEAD_T;
+
+typedef struct RECORD_INDEX_ENTRY_S {
+    AX_CHAR szName[RECORD_INDEX_NAME_LEN]; /* file name in index directory */
+    AX_U64 nStartTime;                     /* utc seconds when file was created */
+    AX_U64 nStartPts;                      /* 0 if unknown */
+    AX_U64 nEndPts;
+    AX_U64 nSize;
+    AX_U64 nKeyFirst; /* key number of the first key frame */
+    AX_U32 nKeyCount;
+    AX_U32 nReserved[4];
+    AX_U32 nCheckSum;
+} RECORD_INDEX_ENTRY_T;
+
+typedef struct RECORD_INDEX_KEY_S {
+    AX_U64 nPts;
+    AX_U64 nOffset; /* byte offset in file */
+    AX_U32 nReserved;
+    AX_U32 nCheckSum;
+} RECORD_INDEX_KEY_T;
+
+/**
+ * @brief Not thread safe, the writer owning the index serializes all calls.
+ */
+class CRecordIndex {
+public:
+    CRecordIndex(AX_VOID) = default;
+    ~CRecordIndex(AX_VOID) {
+        Close();
+    }
+
+    /* load index of files <prefix>*<ext> in strDir, rebuild it if missing or corrupted */
+    AX_BOOL Open(const std::string& strDir, const std::string& strPrefix, const std::string& strExt);
+    AX_VOID Close(AX_VOID);
+
+    /* a new file becomes the last entry, which is updated while it is recorded */
+    AX_BOOL Append(const std::string& strName, time_t tStart);
+    AX_BOOL Update(AX_U64 nSize, AX_U64 nEndPts);
+    /* start pts of the last entry is taken from its first key frame */
+    AX_BOOL AddKeyFrame(AX_U64 nOffset, AX_U64 nPts);
+    AX_VOID Sync(AX_VOID);
+
+    /* drop the oldest entry, its file is removed by caller before */
+    AX_BOOL PopFront(AX_VOID);
+
+    AX_U32 GetCount(AX_VOID) const {
+        return (AX_U32)m_dqEntries.size();
+    }
+
+    /* 0: oldest */
+    const RECORD_INDEX_ENTRY_T& GetEntry(AX_U32 nIndex) const {
+        return m_dqEntries[nIndex];
+    }
+
+    std::string GetPath(AX_U32 nIndex) const {
+        return m_strDir + "/" + m_dqEntries[nIndex].szName;
+    }
+
+    /* bytes of all indexed files */
+    AX_U64 GetTotalSize(AX_VOID) const {
+        return m_nTotalSize;
+    }
+
+    /* entries [nFirst, nLast] recorded within utc seconds [tStart, tEnd] */
+    AX_BOOL FindByTime(time_t tStart, time_t tEnd, AX_U32& nFirst, AX_U32& nLast) const;
+    /* offset of the last key frame at or before nPts in entry nIndex */
+    AX_BOOL FindKeyFrame(AX_U32 nIndex, AX_U64 nPts, AX_U64& nOffset) const;
+
+private:
+    AX_BOOL Load(AX_VOID);
+    AX_BOOL Rebuild(AX_VOID);
+    AX_BOOL Compact(AX_VOID);
+    AX_BOOL Rewrite(AX_U64 nKeyBase);
+    AX_BOOL WriteHead(AX_VOID);
+    AX_BOOL WriteLastEntry(AX_VOID);
+    AX_BOOL ReadKey(AX_U64 nKey, RECORD_INDEX_KEY_T& tKey) const;
+
+    std::string IndexPath(AX_VOID) const {
+        return m_strDir + "/" + m_strPrefix + "record.idx";
+    }
+
+    std::string KeyPath(AX_VOID) const {
+        return m_strDir + "/" + m_strPrefix + "record.key";
+    }
+
+private:
+    std::string m_strDir;
+    std::string m_strPrefix;
+    std::string m_strExt;
+    AX_S32 m_nIdxFd{-1};
+    AX_S32 m_nKeyFd{-1};
+    RECORD_INDEX_HEAD_T m_tHead{};
+    std::deque<RECORD_INDEX_ENTRY_T> m_dqEntries; /* entries after nHead, oldest first */
+    AX_U64 m_nKeyCount{0};                       /* records in .key */
+    AX_U64 m_nTotalSize{0};
+};
@@ -0,0 +1,308 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+/*
+    Check of CAXStreamBuffer pin rules.
+    Every packet carries its sequence number and bytes derived from it, so a reader can prove that a pinned packet
+    was not overwritten: it is verified once when taken and again right before Free.
+
+    pinned:   the oldest packet in ring is pinned while the writer runs several buffers further, new packets go to
+              spill ring; once a spilled packet is pinned too, new packets are dropped. Pinned bytes must stay intact.
+    stress:   one writer of 8 Mbps stream at 4x speed and three readers: fast, slow holding pins for up to 40 ms,
+              and one passing packets to a second holder by AddRef like websocket clients.
+    rebuild:  buffer of the channel is destroyed and created again, readers move to the new one.
+
+    usage: stream_buf_check [stress seconds]
+*/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
+#include "ax_global_type.h"
+
+/* buffer memory is allocated once per buffer, never per packet */
+static std::atomic<AX_U32> s_nAllocCount{0};
+static AX_VOID *CheckMalloc(size_t nSize) {
+    ++s_nAllocCount;
+    return malloc(nSize);
+}
+
+#include "AXStreamBuffer.h"
+#include "host_tool.h"
+
+#define CHECK_BUF_SIZE (256 * 1024)
+#define CHECK_MAX_PACKETS (64)
+#define CHECK_GOP (30)
+#define CHECK_FPS (30)
+#define CHECK_P_SIZE (8 * 1024 * 1024 / 8 / CHECK_FPS)
+#define CHECK_STRESS_SPEED (4)
+#define CHECK_I_SIZE (CHECK_P_SIZE * 4)
+
+/* stream buffer logs through app log, not shown here */
+AX_VOID AX_APP_LogFmtStr(AX_S32 nLv, const AX_CHAR *pFmt, ...) {
+}
+
+static AX_U32 PacketSize(AX_U64 nSeq, AX_U32 nSeed) {
+    AX_U32 nBase = (0 == nSeq % CHECK_GOP) ? CHECK_I_SIZE : CHECK_P_SIZE;
+    return nBase / 2 + (AX_U32)((nSeq * 2654435761u + nSeed) % nBase);
+}
+
+static AX_U8 PacketByte(AX_U64 nSeq, AX_U32 i) {
+    return (AX_U8)(nSeq * 131 + i * 7 + (i >> 8));
+}
+
+static AX_VOID FillPacket(std::vector<AX_U8> &vecData, AX_U64 nSeq, AX_U32 nSize) {
+    vecData.resize(nSize);
+    memcpy(vecData.data(), &nSeq, sizeof(nSeq));
+    for (AX_U32 i = sizeof(nSeq); i < nSize; ++i) {
+        vecData[i] = PacketByte(nSeq, i);
+    }
+}
+
+/* payload seq of a packet is the writer's count of Put calls, independent of the buffer's own sequence */
+static AX_BOOL VerifyPacket(const AX_STREAM_PACKET_T &tPkt, AX_U64 *pPayloadSeq = nullptr) {
+    AX_U32 nSize = tPkt.nSize + tPkt.nSize2;
+    if (nSize < sizeof(AX_U64)) {
+        return AX_FALSE;
+    }
+
+    auto ByteAt = [&](AX_U32 i) { return (i < tPkt.nSize) ? tPkt.pBuf[i] : tPkt.pBuf2[i - tPkt.nSize]; };
+    AX_U64 nSeq = 0;
+    for (AX_U32 i = 0; i < sizeof(nSeq); ++i) {
+        ((AX_U8 *)&nSeq)[i] = ByteAt(i);
+    }
+
+    for (AX_U32 i = sizeof(nSeq); i < nSize; ++i) {
+        if (ByteAt(i) != PacketByte(nSeq, i)) {
+            return AX_FALSE;
+        }
+    }
+
+    if (pPayloadSeq) {
+        *pPayloadSeq = nSeq;
+    }
+    return (tPkt.bIFrame == (0 == nSeq % CHECK_GOP)) ? AX_TRUE : AX_FALSE;
+}
+
+static AX_BOOL CheckPinned(AX_VOID) {
+    auto spBuf = std::make_shared<CAXStreamBuffer>(0, CHECK_BUF_SIZE, CHECK_MAX_PACKETS, "pinned");
+    CAXStreamReader tSlow(spBuf);
+    CAXStreamReader tFast(spBuf);
+    std::vector<AX_U8> vecData;
+    std::vector<AX_STREAM_PACKET_T> vecPinned;
+    AX_U32 nCorrupt = 0;
+    AX_U32 nRead = 0;
+    AX_U32 nPut = 0;
+    AX_U32 nDropped = 0;
+    AX_U64 nSpill = 0;
+    AX_U64 nPinDrop = 0;
+
+    /* packet 0 pinned in main ring, then the first spilled packet is pinned too, four buffers of data are put meanwhile */
+    for (AX_U64 nSeq = 0; nSeq < 4 * CHECK_BUF_SIZE / CHECK_P_SIZE; ++nSeq) {
+        FillPacket(vecData, nSeq, PacketSize(nSeq, 1));
+        if (spBuf->Put(vecData.data(), vecData.size(), nSeq, (0 == nSeq % CHECK_GOP) ? AX_TRUE : AX_FALSE)) {
+            ++nPut;
+        } else {
+            ++nDropped;
+        }
+
+        AX_STREAM_PACKET_T tPkt;
+        while (tFast.Get(tPkt)) {
+            ++nRead;
+            nCorrupt += VerifyPacket(tPkt) ? 0 : 1;
+            spBuf->GetSpillStat(nSpill, nPinDrop);
+            if (vecPinned.empty() || (1 == vecPinned.size() && nSpill > 0)) {
+                spBuf->AddRef(tPkt);
+                vecPinned.push_back(tPkt);
+            }
+            tFast.Free(tPkt);
+        }
+
+        for (const auto &tPinned : vecPinned) {
+            nCorrupt += VerifyPacket(tPinned) ? 0 : 1;
+        }
+    }
+
+    spBuf->GetSpillStat(nSpill, nPinDrop);
+    for (const auto &tPinned : vecPinned) {
+        tPinned.pParent->Free(tPinned);
+    }
+
+    /* pins released: main ring is usable again */
+    FillPacket(vecData, 1000 * CHECK_GOP, CHECK_I_SIZE);
+    AX_BOOL bResumed = spBuf->Put(vecData.data(), vecData.size(), 0, AX_TRUE);
+
+    printf("pinned: put %u, dropped %u, spilled %llu, reader read %u skipped %llu, corrupt %u, resumed %d\n", nPut, nDropped, nSpill, nRead,
+           tFast.GetSkipCount(), nCorrupt, bResumed);
+    return (0 == nCorrupt && 2 == vecPinned.size() && nSpill > 0 && nPinDrop > 0 && bResumed) ? AX_TRUE : AX_FALSE;
+}
+
+typedef struct {
+    const AX_CHAR *pszName;
+    AX_U32 nHoldMaxUs; /* pin held before Free */
+    AX_BOOL bHandOver; /* AddRef to a second holder which frees later */
+    AX_U64 nRead;
+    AX_U64 nCorrupt;
+    AX_U64 nReorder;
+    AX_U64 nSkipped;
+} STRESS_READER_T;
+
+static AX_BOOL CheckStress(AX_U32 nSeconds) {
+    AX_U32 nAllocStart = s_nAllocCount;
+    auto spBuf = std::make_shared<CAXStreamBuffer>(0, CHECK_BUF_SIZE, CHECK_MAX_PACKETS, "stress");
+    STRESS_READER_T arrReaders[] = {
+        {"fast", 0, AX_FALSE, 0, 0, 0, 0}, {"slow", 40000, AX_FALSE, 0, 0, 0, 0}, {"handover", 15000, AX_TRUE, 0, 0, 0, 0}};
+    std::atomic<bool> bRunning{true};
+    AX_U64 nPut = 0;
+    AX_U64 nDropped = 0;
+
+    std::vector<std::thread> vecThreads;
+    for (auto &tReader : arrReaders) {
+        vecThreads.emplace_back([&]() {
+            CAXStreamReader tCursor(spBuf);
+            std::deque<std::pair<AX_U64, AX_STREAM_PACKET_T>> dqHeld; /* second holder: release tick, packet */
+            AX_U32 nSeed = (AX_U32)(uintptr_t)&tReader;
+            AX_U64 nLast = 0;
+            AX_BOOL bFirst = AX_TRUE;
+            while (bRunning) {
+                AX_STREAM_PACKET_T tPkt;
+                if (tCursor.Get(tPkt)) {
+                    AX_U64 nSeq = 0;
+                    if (!VerifyPacket(tPkt, &nSeq)) {
+                        ++tReader.nCorrupt;
+                    } else if (!bFirst && nSeq <= nLast) {
+                        ++tReader.nReorder;
+                    }
+                    nLast = nSeq;
+                    bFirst = AX_FALSE;
+                    ++tReader.nRead;
+
+                    if (tReader.bHandOver) {
+                        spBuf->AddRef(tPkt);
+                        dqHeld.push_back(std::make_pair(HostToolNowNs() + (rand_r(&nSeed) % tReader.nHoldMaxUs) * 1000ULL, tPkt));
+                    } else if (tReader.nHoldMaxUs > 0) {
+                        std::this_thread::sleep_for(std::chrono::microseconds(rand_r(&nSeed) % tReader.nHoldMaxUs));
+                    }
+
+                    tReader.nCorrupt += VerifyPacket(tPkt) ? 0 : 1;
+                    tCursor.Free(tPkt);
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(500));
+                }
+
+                while (!dqHeld.empty() && (dqHeld.front().first <= HostToolNowNs() || !bRunning)) {
+                    tReader.nCorrupt += VerifyPacket(dqHeld.front().second) ? 0 : 1;
+                    dqHeld.front().second.pParent->Free(dqHeld.front().second);
+                    dqHeld.pop_front();
+                }
+            }
+
+            while (!dqHeld.empty()) {
+                dqHeld.front().second.pParent->Free(dqHeld.front().second);
+                dqHeld.pop_front();
+            }
+            tReader.nSkipped = tCursor.GetSkipCount();
+        });
+    }
+
+    std::vector<AX_U8> vecData;
+    AX_U64 nStart = HostToolNowNs();
+    for (AX_U64 nSeq = 0; nSeq < (AX_U64)nSeconds * CHECK_FPS * CHECK_STRESS_SPEED; ++nSeq) {
+        FillPacket(vecData, nSeq, PacketSize(nSeq, 7));
+        if (spBuf->Put(vecData.data(), vecData.size(), nSeq, (0 == nSeq % CHECK_GOP) ? AX_TRUE : AX_FALSE)) {
+            ++nPut;
+        } else {
+            ++nDropped;
+        }
+
+        AX_U64 nNext = nStart + (nSeq + 1) * 1000000000ULL / (CHECK_FPS * CHECK_STRESS_SPEED);
+        AX_U64 nNow = HostToolNowNs();
+        if (nNext > nNow) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(nNext - nNow));
+        }
+    }
+
+    bRunning = false;
+    for (auto &t : vecThreads) {
+        t.join();
+    }
+
+    AX_U64 nSpill = 0;
+    AX_U64 nPinDrop = 0;
+    spBuf->GetSpillStat(nSpill, nPinDrop);
+    AX_U32 nAlloc = s_nAllocCount - nAllocStart;
+    printf("stress: %u s, put %llu, dropped %llu (pinned %llu), spilled %llu, buffer allocations %u\n", nSeconds, nPut, nDropped,
+           nPinDrop, nSpill, nAlloc);
+
+    AX_BOOL bOk = (2 == nAlloc) ? AX_TRUE : AX_FALSE; /* main and spill ring */
+    for (const auto &tReader : arrReaders) {
+        printf("    reader %-8s read %llu, skipped %llu, corrupt %llu, out of order %llu\n", tReader.pszName, tReader.nRead, tReader.nSkipped,
+               tReader.nCorrupt, tReader.nReorder);
+        if (tReader.nCorrupt > 0 || tReader.nReorder > 0 || 0 == tReader.nRead) {
+            bOk = AX_FALSE;
+        }
+    }
+
+    /* every pin returned: buffer must accept a full size packet in main ring again */
+    spBuf->Clear();
+    FillPacket(vecData, 0, CHECK_BUF_SIZE);
+    if (!spBuf->Put(vecData.data(), vecData.size(), 0, AX_TRUE)) {
+        printf("stress: bytes still reserved after every pin was released\n");
+        bOk = AX_FALSE;
+    }
+
+    return bOk;
+}
+
+static AX_BOOL CheckRebuild(AX_VOID) {
+    const AX_U32 nChn = 7;
+    std::vector<AX_U8> vecData;
+    auto spOld = CAXStreamBufferMgr::GetInstance()->Create(nChn, CHECK_BUF_SIZE, CHECK_MAX_PACKETS);
+    CAXStreamReader tReader(spOld);
+
+    FillPacket(vecData, 0, CHECK_I_SIZE);
+    spOld->Put(vecData.data(), vecData.size(), 0, AX_TRUE);
+    AX_STREAM_PACKET_T tPinned;
+    AX_BOOL bOk = tReader.Get(tPinned);
+
+    /* encoder re-init: old buffer dropped by manager and encoder, a new one of a larger size is created */
+    CAXStreamBufferMgr::GetInstance()->Destroy(nChn);
+    spOld.reset();
+    auto spNew = CAXStreamBufferMgr::GetInstance()->Create(nChn, CHECK_BUF_SIZE * 2, CHECK_MAX_PACKETS);
+    spNew->Put(vecData.data(), vecData.size(), 0, AX_TRUE);
+
+    /* still pinned: reader keeps the old buffer so the pinned bytes stay valid */
+    AX_STREAM_PACKET_T tPkt;
+    bOk = (bOk && !tReader.Get(tPkt) && tReader.GetBuffer() != spNew.get() && VerifyPacket(tPinned)) ? AX_TRUE : AX_FALSE;
+    tReader.Free(tPinned);
+
+    bOk = (bOk && tReader.Get(tPkt) && tPkt.pParent == spNew.get() && VerifyPacket(tPkt)) ? AX_TRUE : AX_FALSE;
+    if (bOk) {
+        tReader.Free(tPkt);
+    }
+
+    CAXStreamBufferMgr::GetInstance()->Destroy(nChn);
+    printf("rebuild: reader %s\n", bOk ? "moved to new buffer after its pin was released" : "FAILED");
+    return bOk;
+}
+
+int main(int argc, char *argv[]) {
+    AX_U32 nSeconds = (argc > 1) ? (AX_U32)atoi(argv[1]) : 10;
+    AX_BOOL bOk = CheckPinned();
+    bOk = (CheckStress(nSeconds) && bOk) ? AX_TRUE : AX_FALSE;
+    bOk = (CheckRebuild() && bOk) ? AX_TRUE : AX_FALSE;
+
+    printf("%s\n", bOk ? "all checks passed" : "FAILED");
+    return bOk ? 0 : 1;
+}
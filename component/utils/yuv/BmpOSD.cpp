@@ -213,10 +213,7 @@ AX_BOOL CBmpOSD::FillString(const AX_CHAR *pNumStri, AX_S16 x, AX_S16 y, AX_U8 *
         AX_U8 *dst = pBmp + y * uBmpWidthBytes + (x + i) * uSymbolWidthBytes;
         AX_U8 *src = m_pFont + FONT_MAP[(AX_U8)pNumStri[i]] * uSymbolWidthBytes;
         for (AX_U16 j = 0; j < m_uHight; j++) {
-            for (AX_U16 k = 0; k < uSymbolWidthBytes; k++) {
-                dst[j * uBmpWidthBytes + k] = src[j * uFontWidthBytes + k];
-                printf("des pos:%d, src pos:%d\n", j * uBmpWidthBytes + k, j * uFontWidthBytes + k);
-            }
+            memcpy(dst + j * uBmpWidthBytes, src + j * uFontWidthBytes, uSymbolWidthBytes);
         }
     }
 
@@ -263,19 +260,26 @@ AX_BOOL CBmpOSD::FillString(const AX_CHAR *pNumStri, AX_S16 x, AX_S16 y, CYuvHan
         y = 0;
     }
 
+    AX_U16 nBits = uSymbolWidthBytes * 8;
     for (AX_U16 i = 0; i < uLen; i++) {
         AX_U8 *src = m_pFont + FONT_MAP[(AX_U8)pNumStri[i]] * uSymbolWidthBytes;
         for (AX_U16 j = 0; j < m_uHight; j++) {
-            for (AX_U16 k = 0; k < uSymbolWidthBytes; k++) {
-                AX_U8 dot8 = src[j * uFontWidthBytes + k];
-                for (AX_U16 dot = 0; dot < 8; dot++) {
-                    if ((dot8 & 0x1) == 1) {
-                        yuvHandler->DrawPoint(x + i * uSymbolWidthBytes * 8 + k * 8 + dot, y + j, nScale, (x + 0) * (nScale - 1),
-                                              (y + 1) * (nScale - 1), CYuvHandler::YUV_WHITE);
-                    }
-
-                    dot8 = dot8 >> 1;
+            /* each run of set dots in the row is drawn as one span, bit 0 is the left dot */
+            const AX_U8 *pRow = src + j * uFontWidthBytes;
+            for (AX_U16 nDot = 0; nDot < nBits;) {
+                if (0 == (pRow[nDot / 8] & (1 << (nDot % 8)))) {
+                    nDot = (0 == nDot % 8 && 0 == pRow[nDot / 8]) ? nDot + 8 : nDot + 1;
+                    continue;
                 }
+
+                AX_U16 nEnd = nDot + 1;
+                while (nEnd < nBits && (pRow[nEnd / 8] & (1 << (nEnd % 8)))) {
+                    nEnd++;
+                }
+
+                yuvHandler->DrawPoints(x + i * nBits + nDot, y + j, nEnd - nDot, nScale, (x + 0) * (nScale - 1), (y + 1) * (nScale - 1),
+                                       CYuvHandler::YUV_WHITE);
+                nDot = nEnd;
             }
         }
     }
@@ -11,8 +11,12 @@
 #include "YuvHandler.hpp"
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 #include <fstream>
 #include "GlobalDef.h"
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 using namespace std;
 
@@ -35,6 +39,30 @@ static const struct axYUV_COLOR_T {
     {0xff, 0x80, 0x80}   // white
 };
 
+/* clamp to [0, nLimit - 1] */
+static inline AX_S16 ClampCoord(AX_S16 v, AX_U16 nLimit) {
+    return (v < 0) ? 0 : ((v >= nLimit) ? nLimit - 1 : v);
+}
+
+/* fill nPairs of interleaved chroma (UVUV... or VUVU...), x86 host builds leave the tail loop to the compiler vectorizer */
+static inline AX_VOID FillPairs(AX_U8 *p, AX_U32 nPairs, AX_U8 nFirst, AX_U8 nSecond) {
+    AX_U32 i = 0;
+#if defined(__ARM_NEON)
+    uint8x16_t vPair = vreinterpretq_u8_u16(vdupq_n_u16((AX_U16)(nFirst | (nSecond << 8))));
+    for (; i + 16 <= nPairs; i += 16) {
+        vst1q_u8(p + i * 2, vPair);
+        vst1q_u8(p + i * 2 + 16, vPair);
+    }
+    for (; i + 8 <= nPairs; i += 8) {
+        vst1q_u8(p + i * 2, vPair);
+    }
+#endif
+    for (; i < nPairs; ++i) {
+        p[i * 2] = nFirst;
+        p[i * 2 + 1] = nSecond;
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 CYuvHandler::CYuvHandler(AX_VOID)
     : m_pImgData(nullptr), m_bCopy(AX_FALSE), m_nWidth(0), m_nHeight(0), m_nStride(0), m_nImgSize(0), m_eType(AX_FORMAT_YUV420_SEMIPLANAR) {
@@ -203,15 +231,10 @@ AX_VOID CYuvHandler::DrawPoint(AX_U8 *y, AX_U8 *u, AX_U8 *v, AX_U16 x0, AX_U16 y
     }
 }
 
-AX_VOID CYuvHandler::DrawPoint(AX_S16 x, AX_S16 y, AX_U8 nScale /* = 1*/, AX_S16 xOffset /* = 0*/, AX_S16 yOffset /* = 0*/,
-                               YUV_COLOR eColor /* = YUV_GREEN*/) {
-    if (!m_pImgData) {
-        return;
-    }
-
-    AX_U8 *pY = nullptr;
-    AX_U8 *pU = nullptr;
-    AX_U8 *pV = nullptr;
+AX_VOID CYuvHandler::GetPlanes(AX_U8 *&pY, AX_U8 *&pU, AX_U8 *&pV) const {
+    pY = nullptr;
+    pU = nullptr;
+    pV = nullptr;
     switch (m_eType) {
         case AX_FORMAT_YUV420_PLANAR:
             pY = m_pImgData;
@@ -233,40 +256,137 @@ AX_VOID CYuvHandler::DrawPoint(AX_S16 x, AX_S16 y, AX_U8 nScale /* = 1*/, AX_S16
         default:
             break;
     }
+}
 
-    AX_S16 nXStart = 0;
-    AX_S16 nYStart = 0;
-    for (uint32_t hScale = 0; hScale < nScale; hScale++) {
-        for (uint32_t wScale = 0; wScale < nScale; wScale++) {
-            nXStart = x * nScale + hScale - xOffset;
-            nYStart = y * nScale + wScale - yOffset;
-            if (nXStart < 0 || nXStart > m_nWidth) {
-                break;
-            }
+AX_BOOL CYuvHandler::IsYuv420(AX_VOID) const {
+    switch (m_eType) {
+        case AX_FORMAT_YUV420_PLANAR:
+        case AX_FORMAT_YUV420_SEMIPLANAR:
+        case AX_FORMAT_YUV420_SEMIPLANAR_VU:
+            return AX_TRUE;
+        default:
+            return AX_FALSE;
+    }
+}
 
-            if (nYStart < 0 || nYStart > m_nHeight) {
-                break;
+AX_VOID CYuvHandler::FillLumaSpan(AX_U16 y, AX_U16 x0, AX_U16 x1, YUV_COLOR eColor) {
+    /* NV12 writes luma of white only, see DrawPoint */
+    if (AX_FORMAT_YUV420_SEMIPLANAR == m_eType && YUV_COLORS[eColor].Y != 0xFF) {
+        return;
+    }
+
+    memset(m_pImgData + (AX_U32)y * m_nStride + x0, YUV_COLORS[eColor].Y, x1 - x0 + 1);
+}
+
+AX_VOID CYuvHandler::FillChromaSpan(AX_U16 cy, AX_U16 cx0, AX_U16 cx1, YUV_COLOR eColor) {
+    AX_U8 *pUV = m_pImgData + (AX_U32)m_nStride * m_nHeight;
+    AX_U32 nCount = cx1 - cx0 + 1;
+    switch (m_eType) {
+        case AX_FORMAT_YUV420_PLANAR: {
+            AX_U32 nOffset = (AX_U32)cy * (m_nStride / 2) + cx0;
+            memset(pUV + nOffset, YUV_COLORS[eColor].U, nCount);
+            memset(pUV + (AX_U32)m_nStride * m_nHeight / 4 + nOffset, YUV_COLORS[eColor].V, nCount);
+            break;
+        }
+        case AX_FORMAT_YUV420_SEMIPLANAR:
+            if (YUV_COLORS[eColor].Y != 0xFF) {
+                FillPairs(pUV + (AX_U32)cy * m_nStride + cx0 * 2, nCount, YUV_COLORS[eColor].U, YUV_COLORS[eColor].V);
             }
+            break;
+        case AX_FORMAT_YUV420_SEMIPLANAR_VU:
+            FillPairs(pUV + (AX_U32)cy * m_nStride + cx0 * 2, nCount, YUV_COLORS[eColor].V, YUV_COLORS[eColor].U);
+            break;
+        default:
+            break;
+    }
+}
+
+AX_VOID CYuvHandler::FillRect(AX_U16 x0, AX_U16 y0, AX_U16 x1, AX_U16 y1, YUV_COLOR eColor) {
+    for (AX_U32 y = y0; y <= y1; ++y) {
+        FillLumaSpan(y, x0, x1, eColor);
+    }
+
+    /* one chroma sample covers 2x2 luma, each chroma row is written once */
+    for (AX_U32 cy = y0 / 2; cy <= (AX_U32)y1 / 2; ++cy) {
+        FillChromaSpan(cy, x0 / 2, x1 / 2, eColor);
+    }
+}
+
+AX_VOID CYuvHandler::DrawOutline(AX_U16 x0, AX_U16 y0, AX_U16 x1, AX_U16 y1, YUV_COLOR eColor) {
+    /* horizontal edges are row fills, both vertical edges are drawn in the same pass over rows between */
+    FillLumaSpan(y0, x0, x1, eColor);
+    for (AX_U32 y = y0 + 1; y < y1; ++y) {
+        FillLumaSpan(y, x0, x0, eColor);
+        FillLumaSpan(y, x1, x1, eColor);
+    }
+    if (y1 != y0) {
+        FillLumaSpan(y1, x0, x1, eColor);
+    }
+
+    AX_U16 cy0 = y0 / 2;
+    AX_U16 cy1 = y1 / 2;
+    FillChromaSpan(cy0, x0 / 2, x1 / 2, eColor);
+    for (AX_U32 cy = cy0 + 1; cy < cy1; ++cy) {
+        FillChromaSpan(cy, x0 / 2, x0 / 2, eColor);
+        FillChromaSpan(cy, x1 / 2, x1 / 2, eColor);
+    }
+    if (cy1 != cy0) {
+        FillChromaSpan(cy1, x0 / 2, x1 / 2, eColor);
+    }
+}
 
-            DrawPoint(pY, pU, pV, nXStart, nYStart, eColor);
+AX_VOID CYuvHandler::DrawPoint(AX_S16 x, AX_S16 y, AX_U8 nScale /* = 1*/, AX_S16 xOffset /* = 0*/, AX_S16 yOffset /* = 0*/,
+                               YUV_COLOR eColor /* = YUV_GREEN*/) {
+    DrawPoints(x, y, 1, nScale, xOffset, yOffset, eColor);
+}
+
+AX_VOID CYuvHandler::DrawPoints(AX_S16 x, AX_S16 y, AX_U16 nCount, AX_U8 nScale /* = 1*/, AX_S16 xOffset /* = 0*/,
+                                AX_S16 yOffset /* = 0*/, YUV_COLOR eColor /* = YUV_GREEN*/) {
+    if (!m_pImgData || 0 == m_nWidth || 0 == m_nHeight || 0 == nCount) {
+        return;
+    }
+
+    /* nCount * nScale x nScale block clipped to image, a block starting above the image is dropped */
+    AX_S32 nXStart = x * nScale - xOffset;
+    AX_S32 nYStart = y * nScale - yOffset;
+    AX_S32 nX0 = std::max(nXStart, 0);
+    AX_S32 nX1 = std::min(nXStart + nCount * nScale - 1, m_nWidth - 1);
+    AX_S32 nY1 = std::min(nYStart + nScale - 1, m_nHeight - 1);
+    if (nYStart < 0 || nX0 > nX1 || nYStart > nY1) {
+        return;
+    }
+
+    if (IsYuv420()) {
+        FillRect(nX0, nYStart, nX1, nY1, eColor);
+        return;
+    }
+
+    AX_U8 *pY = nullptr;
+    AX_U8 *pU = nullptr;
+    AX_U8 *pV = nullptr;
+    GetPlanes(pY, pU, pV);
+    for (AX_S32 i = nX0; i <= nX1; i++) {
+        for (AX_S32 j = nYStart; j <= nY1; j++) {
+            DrawPoint(pY, pU, pV, i, j, eColor);
         }
     }
 }
 
 const AX_U8 *CYuvHandler::DrawLine(AX_S16 x0, AX_S16 y0, AX_S16 x1, AX_S16 y1, YUV_COLOR eColor /* = YUV_GREEN*/) {
-    if (!m_pImgData) {
+    if (!m_pImgData || 0 == m_nWidth || 0 == m_nHeight) {
         return nullptr;
     }
 
-    x0 = (x0 < 0) ? 0 : x0;
-    y0 = (y0 < 0) ? 0 : y0;
-    x1 = (x1 < 0) ? 0 : x1;
-    y1 = (y1 < 0) ? 0 : y1;
+    x0 = ClampCoord(x0, m_nWidth);
+    y0 = ClampCoord(y0, m_nHeight);
+    x1 = ClampCoord(x1, m_nWidth);
+    y1 = ClampCoord(y1, m_nHeight);
 
-    x0 = (x0 >= m_nWidth) ? m_nWidth - 1 : x0;
-    y0 = (y0 >= m_nHeight) ? m_nHeight - 1 : y0;
-    x1 = (x1 >= m_nWidth) ? m_nWidth - 1 : x1;
-    y1 = (y1 >= m_nHeight) ? m_nHeight - 1 : y1;
+    /* horizontal and vertical lines of YUV420 are filled by rows */
+    if ((x0 == x1 || y0 == y1) && IsYuv420()) {
+        FillRect(std::min(x0, x1), std::min(y0, y1), std::max(x0, x1), std::max(y0, y1), eColor);
+        return m_pImgData;
+    }
 
     AX_U16 dx = (x0 > x1) ? (x0 - x1) : (x1 - x0);
     AX_U16 dy = (y0 > y1) ? (y0 - y1) : (y1 - y0);
@@ -278,27 +398,7 @@ const AX_U8 *CYuvHandler::DrawLine(AX_S16 x0, AX_S16 y0, AX_S16 x1, AX_S16 y1, Y
     AX_U8 *pY = nullptr;
     AX_U8 *pU = nullptr;
     AX_U8 *pV = nullptr;
-    switch (m_eType) {
-        case AX_FORMAT_YUV420_PLANAR:
-            pY = m_pImgData;
-            pU = m_pImgData + m_nStride * m_nHeight;
-            pV = pU + m_nStride * m_nHeight / 4;
-            break;
-        case AX_FORMAT_YUV420_SEMIPLANAR:
-        case AX_FORMAT_YUV420_SEMIPLANAR_VU:
-            pY = m_pImgData;
-            pU = m_pImgData + m_nStride * m_nHeight;
-            pV = pU;
-            break;
-        case AX_FORMAT_YUV422_INTERLEAVED_UYVY:
-        case AX_FORMAT_YUV422_INTERLEAVED_YUYV:
-            pY = m_pImgData;
-            pU = pY;
-            pV = pY;
-            break;
-        default:
-            break;
-    }
+    GetPlanes(pY, pU, pV);
 
     AX_U16 x = x0;
     AX_U16 y = y0;
@@ -330,15 +430,43 @@ const AX_U8 *CYuvHandler::DrawLine(AX_S16 x0, AX_S16 y0, AX_S16 x1, AX_S16 y1, Y
 }
 
 const AX_U8 *CYuvHandler::DrawRect(AX_S16 x0, AX_S16 y0, AX_U16 w, AX_U16 h, YUV_COLOR eColor /* = YUV_GREEN*/) {
+    YUV_RECT_T tRect = {x0, y0, w, h};
+    return DrawRects(&tRect, 1, eColor);
+}
+
+const AX_U8 *CYuvHandler::DrawRects(const YUV_RECT_T *pRects, AX_U32 nCount, YUV_COLOR eColor /* = YUV_GREEN*/) {
     if (!m_pImgData) {
         return nullptr;
     }
 
-    if (w > 0 && h > 0) {
-        DrawLine(x0, y0, x0 + w, y0, eColor);
-        DrawLine(x0, y0, x0, y0 + h, eColor);
-        DrawLine(x0 + w, y0, x0 + w, y0 + h, eColor);
-        DrawLine(x0, y0 + h, x0 + w, y0 + h, eColor);
+    if (!pRects || 0 == m_nWidth || 0 == m_nHeight) {
+        return m_pImgData;
+    }
+
+    AX_BOOL bYuv420 = IsYuv420();
+    for (AX_U32 i = 0; i < nCount; ++i) {
+        const YUV_RECT_T &tRect = pRects[i];
+        if (0 == tRect.w || 0 == tRect.h) {
+            continue;
+        }
+
+        /* far corner is passed to DrawLine as AX_S16 */
+        AX_S16 x1 = (AX_S16)(tRect.x0 + tRect.w);
+        AX_S16 y1 = (AX_S16)(tRect.y0 + tRect.h);
+        if (!bYuv420) {
+            DrawLine(tRect.x0, tRect.y0, x1, tRect.y0, eColor);
+            DrawLine(tRect.x0, tRect.y0, tRect.x0, y1, eColor);
+            DrawLine(x1, tRect.y0, x1, y1, eColor);
+            DrawLine(tRect.x0, y1, x1, y1, eColor);
+            continue;
+        }
+
+        /* edges are clamped to image as DrawLine does, so the box keeps its visible sides */
+        AX_U16 nX0 = ClampCoord(tRect.x0, m_nWidth);
+        AX_U16 nY0 = ClampCoord(tRect.y0, m_nHeight);
+        AX_U16 nX1 = ClampCoord(x1, m_nWidth);
+        AX_U16 nY1 = ClampCoord(y1, m_nHeight);
+        DrawOutline(std::min(nX0, nX1), std::min(nY0, nY1), std::max(nX0, nX1), std::max(nY0, nY1), eColor);
     }
 
     return m_pImgData;
@@ -353,6 +481,7 @@ AX_U32 CYuvHandler::GetClipImage(AX_S16 x0, AX_S16 y0, AX_U16 &w, AX_U16 &h, AX_
 
     x0 = (x0 < 0) ? 0 : x0;
     y0 = (y0 < 0) ? 0 : y0;
+    /* even origin keeps chroma samples of ROI aligned */
     x0 = (x0 + 1) / 2 * 2;
     y0 = (y0 + 1) / 2 * 2;
     /* 8 pixel padding */
@@ -382,8 +511,16 @@ AX_U32 CYuvHandler::GetClipImage(AX_S16 x0, AX_S16 y0, AX_U16 &w, AX_U16 &h, AX_
         case AX_FORMAT_YUV420_SEMIPLANAR:
         case AX_FORMAT_YUV420_SEMIPLANAR_VU:
             /* YYYY UVUV or YYYY VUVU */
-            /* Copy Y */
             pY = m_pImgData + y0 * m_nStride + x0;
+            pV = m_pImgData + m_nStride * m_nHeight + (y0 * m_nStride / 2 + x0);
+            if (w == m_nStride) {
+                /* full rows, each plane is one block */
+                memcpy(pO, pY, (AX_U32)w * h);
+                memcpy(pO + (AX_U32)w * h, pV, (AX_U32)w * (h / 2));
+                break;
+            }
+
+            /* Copy Y */
             for (AX_U16 i = 0; i < h; ++i) {
                 memcpy(pO, pY, w);
                 pY += m_nStride;
@@ -391,7 +528,6 @@ AX_U32 CYuvHandler::GetClipImage(AX_S16 x0, AX_S16 y0, AX_U16 &w, AX_U16 &h, AX_
             }
 
             /* Copy UV */
-            pV = m_pImgData + m_nStride * m_nHeight + (y0 * m_nStride / 2 + x0);
             for (AX_U16 i = 0; i < (h / 2); ++i) {
                 memcpy(pO, pV, w);
                 pV += m_nStride;
@@ -28,6 +28,13 @@ public:
         YUV_COLOR_MAX,
     };
 
+    struct YUV_RECT_T {
+        AX_S16 x0;
+        AX_S16 y0;
+        AX_U16 w;
+        AX_U16 h;
+    };
+
     CYuvHandler(AX_VOID);
     CYuvHandler(const AX_U8 *pImgData, AX_U16 nWidth, AX_U16 nHeight, AX_IMG_FORMAT_E eType = AX_FORMAT_YUV420_SEMIPLANAR,
                 AX_U16 nStride = 0, AX_BOOL bMemCopy = AX_FALSE);
@@ -51,11 +58,24 @@ public:
 
     const AX_U8 *DrawLine(AX_S16 x0, AX_S16 y0, AX_S16 x1, AX_S16 y1, YUV_COLOR eColor = YUV_GREEN);
     const AX_U8 *DrawRect(AX_S16 x0, AX_S16 y0, AX_U16 w, AX_U16 h, YUV_COLOR eColor = YUV_GREEN);
+    /* draw all boxes of a frame in one call, same result as DrawRect of each */
+    const AX_U8 *DrawRects(const YUV_RECT_T *pRects, AX_U32 nCount, YUV_COLOR eColor = YUV_GREEN);
 
     AX_VOID DrawPoint(AX_S16 x, AX_S16 y, AX_U8 nScale = 1, AX_S16 xOffset = 0, AX_S16 yOffset = 0, YUV_COLOR eColor = YUV_GREEN);
+    /* nCount points from (x, y) to the right, same as DrawPoint of each */
+    AX_VOID DrawPoints(AX_S16 x, AX_S16 y, AX_U16 nCount, AX_U8 nScale = 1, AX_S16 xOffset = 0, AX_S16 yOffset = 0,
+                       YUV_COLOR eColor = YUV_GREEN);
 
 private:
     AX_VOID DrawPoint(AX_U8 *y, AX_U8 *u, AX_U8 *v, AX_U16 x0, AX_U16 y0, YUV_COLOR eColor);
+    AX_VOID GetPlanes(AX_U8 *&pY, AX_U8 *&pU, AX_U8 *&pV) const;
+
+    /* row kernels of YUV420 formats, coordinates are inclusive and inside image */
+    AX_BOOL IsYuv420(AX_VOID) const;
+    AX_VOID FillLumaSpan(AX_U16 y, AX_U16 x0, AX_U16 x1, YUV_COLOR eColor);
+    AX_VOID FillChromaSpan(AX_U16 cy, AX_U16 cx0, AX_U16 cx1, YUV_COLOR eColor);
+    AX_VOID FillRect(AX_U16 x0, AX_U16 y0, AX_U16 x1, AX_U16 y1, YUV_COLOR eColor);
+    AX_VOID DrawOutline(AX_U16 x0, AX_U16 y0, AX_U16 x1, AX_U16 y1, YUV_COLOR eColor);
     AX_VOID FreeImage(AX_VOID);
 
 private:
@@ -0,0 +1,177 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+/*
+    Golden check and benchmark of CYuvHandler drawing.
+    Random lines, rects and points are drawn on random images by every build of YuvHandler.cpp,
+    the scalar build is the golden and the SIMD builds must produce identical bytes, including pixels out of the image.
+
+    usage: yuv_draw_check [iterations]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "host_tool.h"
+#include "yuv_draw_check.h"
+
+#define YUV_CHECK_COLOR_NUM (11) /* CYuvHandler::YUV_COLOR_MAX */
+#define YUV_CHECK_GUARD (64)     /* bytes after image, must stay untouched */
+#define YUV_BENCH_WIDTH (1920)
+#define YUV_BENCH_HEIGHT (1080)
+#define YUV_BENCH_LOOP (200)
+#define YUV_BENCH_ROUND (7) /* best round is reported, host timing is noisy */
+
+static const HOST_TOOL_VARIANT_T<YUV_DRAW_FUNC> s_arrVariants[] = {
+    {"scalar", YuvDrawScalar},
+    {"simd", YuvDrawSimd},
+#if defined(HOST_TOOL_NEON_EMU)
+    {"neon_emu", YuvDrawNeonEmu},
+#endif
+};
+
+static const AX_IMG_FORMAT_E s_arrFormats[] = {AX_FORMAT_YUV420_SEMIPLANAR, AX_FORMAT_YUV420_SEMIPLANAR_VU, AX_FORMAT_YUV420_PLANAR,
+                                               AX_FORMAT_YUV422_INTERLEAVED_YUYV, AX_FORMAT_YUV422_INTERLEAVED_UYVY};
+
+static AX_S16 RandCoord(AX_U16 nLimit) {
+    /* 20 pixels around the image, clipping is part of the check */
+    return (AX_S16)(rand() % (nLimit + 40) - 20);
+}
+
+static YUV_DRAW_RECT_T RandRect(AX_U16 nWidth, AX_U16 nHeight) {
+    YUV_DRAW_RECT_T tRect;
+    tRect.x0 = RandCoord(nWidth);
+    tRect.y0 = RandCoord(nHeight);
+    tRect.w = (0 == rand() % 8) ? 65530 : (AX_U16)(rand() % (nWidth + 10));
+    tRect.h = (AX_U16)(rand() % (nHeight + 10));
+    return tRect;
+}
+
+static YUV_DRAW_OP_T RandOp(AX_U16 nWidth, AX_U16 nHeight) {
+    YUV_DRAW_OP_T tOp;
+    memset(&tOp, 0, sizeof(tOp));
+    tOp.eOp = (YUV_DRAW_OP_E)(rand() % YUV_DRAW_OP_MAX);
+    tOp.nColor = rand() % YUV_CHECK_COLOR_NUM;
+    tOp.x0 = RandCoord(nWidth);
+    tOp.y0 = RandCoord(nHeight);
+    switch (tOp.eOp) {
+        case YUV_DRAW_OP_LINE:
+            tOp.x1 = RandCoord(nWidth);
+            tOp.y1 = RandCoord(nHeight);
+            /* most lines of boxes are horizontal or vertical */
+            if (rand() % 2) {
+                tOp.x1 = tOp.x0;
+            } else if (rand() % 2) {
+                tOp.y1 = tOp.y0;
+            }
+            break;
+        case YUV_DRAW_OP_RECT:
+            tOp.arrRects[0] = RandRect(nWidth, nHeight);
+            break;
+        case YUV_DRAW_OP_RECTS:
+            tOp.nCount = 1 + rand() % YUV_DRAW_MAX_RECTS;
+            for (AX_U32 i = 0; i < tOp.nCount; ++i) {
+                tOp.arrRects[i] = RandRect(nWidth, nHeight);
+            }
+            break;
+        default:
+            tOp.nScale = 1 + rand() % 4;
+            tOp.x0 = (AX_S16)(rand() % (nWidth / tOp.nScale + 4));
+            tOp.y0 = (AX_S16)(rand() % (nHeight / tOp.nScale + 4));
+            tOp.nCount = 1 + rand() % 24;
+            tOp.xOffset = (AX_S16)(rand() % 6 - 1);
+            tOp.yOffset = (AX_S16)(rand() % 6 - 1);
+            break;
+    }
+
+    return tOp;
+}
+
+static AX_BOOL Check(AX_U32 nIterations) {
+    const AX_U32 nVariants = HOST_TOOL_ARRAY_SIZE(s_arrVariants);
+    AX_U32 nMismatch = 0;
+    for (AX_U32 it = 0; it < nIterations; ++it) {
+        AX_IMG_FORMAT_E eType = s_arrFormats[it % HOST_TOOL_ARRAY_SIZE(s_arrFormats)];
+        AX_U16 nWidth = 2 * (4 + rand() % 60);
+        AX_U16 nHeight = 2 * (4 + rand() % 40);
+        AX_U16 nStride = nWidth + 2 * (rand() % 3);
+
+        /* 3 bytes per pixel covers every format, rest is guard */
+        std::vector<AX_U8> vecInit((size_t)nStride * nHeight * 3 + YUV_CHECK_GUARD);
+        for (auto &c : vecInit) {
+            c = (AX_U8)rand();
+        }
+
+        std::vector<YUV_DRAW_OP_T> vecOps(1 + rand() % 20);
+        for (auto &tOp : vecOps) {
+            tOp = RandOp(nWidth, nHeight);
+        }
+
+        std::vector<AX_U8> vecGolden = vecInit;
+        s_arrVariants[0].pFunc(vecGolden.data(), nWidth, nHeight, eType, nStride, vecOps.data(), vecOps.size());
+        for (AX_U32 v = 1; v < nVariants; ++v) {
+            std::vector<AX_U8> vecImg = vecInit;
+            s_arrVariants[v].pFunc(vecImg.data(), nWidth, nHeight, eType, nStride, vecOps.data(), vecOps.size());
+            if (vecImg != vecGolden) {
+                if (++nMismatch <= 5) {
+                    printf("[%s] differs from scalar: iteration %u, format %d, %ux%u stride %u\n", s_arrVariants[v].pszName, it, eType,
+                           nWidth, nHeight, nStride);
+                }
+            }
+        }
+    }
+
+    printf("check: %u iterations, %u variants, %u mismatches\n", nIterations, nVariants, nMismatch);
+    return (0 == nMismatch) ? AX_TRUE : AX_FALSE;
+}
+
+static AX_VOID Bench(AX_VOID) {
+    /* detection boxes of a busy 1080p frame, NV12 */
+    std::vector<YUV_DRAW_OP_T> vecOps(16);
+    for (AX_U32 i = 0; i < vecOps.size(); ++i) {
+        YUV_DRAW_OP_T &tOp = vecOps[i];
+        memset(&tOp, 0, sizeof(tOp));
+        tOp.eOp = YUV_DRAW_OP_RECTS;
+        tOp.nColor = i % YUV_CHECK_COLOR_NUM;
+        tOp.nCount = YUV_DRAW_MAX_RECTS;
+        for (AX_U32 j = 0; j < YUV_DRAW_MAX_RECTS; ++j) {
+            tOp.arrRects[j] = {(AX_S16)(100 * j + 13 * i), (AX_S16)(60 * i + 7 * j), (AX_U16)(160 + 20 * j), (AX_U16)(240 + 10 * i)};
+        }
+    }
+
+    std::vector<AX_U8> vecImg((size_t)YUV_BENCH_WIDTH * YUV_BENCH_HEIGHT * 3 / 2);
+    for (const auto &tVariant : s_arrVariants) {
+        AX_F64 fUs = 0;
+        for (AX_U32 r = 0; r < YUV_BENCH_ROUND; ++r) {
+            AX_F64 fRoundUs = HostToolBenchUs(YUV_BENCH_LOOP, [&]() {
+                tVariant.pFunc(vecImg.data(), YUV_BENCH_WIDTH, YUV_BENCH_HEIGHT, AX_FORMAT_YUV420_SEMIPLANAR, YUV_BENCH_WIDTH,
+                               vecOps.data(), vecOps.size());
+            });
+            if (0 == r || fRoundUs < fUs) {
+                fUs = fRoundUs;
+            }
+        }
+        printf("bench [%-8s] %u rects on %ux%u NV12: %.2f us/frame\n", tVariant.pszName, (AX_U32)vecOps.size() * YUV_DRAW_MAX_RECTS,
+               YUV_BENCH_WIDTH, YUV_BENCH_HEIGHT, fUs);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    AX_U32 nIterations = (argc > 1) ? (AX_U32)atoi(argv[1]) : 3000;
+    srand(1);
+
+    if (!Check(nIterations)) {
+        return 1;
+    }
+
+    Bench();
+    return 0;
+}
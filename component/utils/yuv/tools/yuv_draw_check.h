@@ -0,0 +1,53 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+#include "ax_global_type.h"
+
+typedef enum {
+    YUV_DRAW_OP_LINE = 0,
+    YUV_DRAW_OP_RECT,
+    YUV_DRAW_OP_RECTS,
+    YUV_DRAW_OP_POINTS,
+    YUV_DRAW_OP_MAX,
+} YUV_DRAW_OP_E;
+
+#define YUV_DRAW_MAX_RECTS (4)
+
+/* same layout as CYuvHandler::YUV_RECT_T */
+typedef struct {
+    AX_S16 x0;
+    AX_S16 y0;
+    AX_U16 w;
+    AX_U16 h;
+} YUV_DRAW_RECT_T;
+
+typedef struct {
+    YUV_DRAW_OP_E eOp;
+    AX_S32 nColor;                           /* CYuvHandler::YUV_COLOR */
+    AX_S16 x0, y0, x1, y1;                   /* line end points, or first point */
+    AX_U16 nCount;                           /* rects of YUV_DRAW_OP_RECTS, or points */
+    AX_U8 nScale;                            /* points */
+    AX_S16 xOffset, yOffset;                 /* points */
+    YUV_DRAW_RECT_T arrRects[YUV_DRAW_MAX_RECTS]; /* rect uses arrRects[0] */
+} YUV_DRAW_OP_T;
+
+typedef AX_VOID (*YUV_DRAW_FUNC)(AX_U8 *pImg, AX_U16 nWidth, AX_U16 nHeight, AX_IMG_FORMAT_E eType, AX_U16 nStride,
+                                 const YUV_DRAW_OP_T *pOps, AX_U32 nCount);
+
+/* one entry per build of YuvHandler.cpp, see yuv_draw_variant.cpp */
+AX_VOID YuvDrawScalar(AX_U8 *pImg, AX_U16 nWidth, AX_U16 nHeight, AX_IMG_FORMAT_E eType, AX_U16 nStride, const YUV_DRAW_OP_T *pOps,
+                      AX_U32 nCount);
+AX_VOID YuvDrawSimd(AX_U8 *pImg, AX_U16 nWidth, AX_U16 nHeight, AX_IMG_FORMAT_E eType, AX_U16 nStride, const YUV_DRAW_OP_T *pOps,
+                    AX_U32 nCount);
+#if defined(HOST_TOOL_NEON_EMU)
+AX_VOID YuvDrawNeonEmu(AX_U8 *pImg, AX_U16 nWidth, AX_U16 nHeight, AX_IMG_FORMAT_E eType, AX_U16 nStride, const YUV_DRAW_OP_T *pOps,
+                       AX_U32 nCount);
+#endif
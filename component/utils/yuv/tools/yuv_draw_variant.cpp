@@ -0,0 +1,43 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+/*
+    Built once per SIMD variant by Makefile, with CYuvHandler renamed and YUV_DRAW_ENTRY set to the entry of
+    yuv_draw_check.h, so that the scalar, native (NEON on board) and emulated NEON paths of YuvHandler.cpp link into one program.
+*/
+#include "../YuvHandler.cpp"
+#include "yuv_draw_check.h"
+
+static_assert(sizeof(YUV_DRAW_RECT_T) == sizeof(CYuvHandler::YUV_RECT_T), "rect layout differs");
+
+AX_VOID YUV_DRAW_ENTRY(AX_U8 *pImg, AX_U16 nWidth, AX_U16 nHeight, AX_IMG_FORMAT_E eType, AX_U16 nStride, const YUV_DRAW_OP_T *pOps,
+                       AX_U32 nCount) {
+    CYuvHandler hYuv(pImg, nWidth, nHeight, eType, nStride);
+    for (AX_U32 i = 0; i < nCount; ++i) {
+        const YUV_DRAW_OP_T &tOp = pOps[i];
+        CYuvHandler::YUV_COLOR eColor = (CYuvHandler::YUV_COLOR)tOp.nColor;
+        switch (tOp.eOp) {
+            case YUV_DRAW_OP_LINE:
+                hYuv.DrawLine(tOp.x0, tOp.y0, tOp.x1, tOp.y1, eColor);
+                break;
+            case YUV_DRAW_OP_RECT:
+                hYuv.DrawRect(tOp.arrRects[0].x0, tOp.arrRects[0].y0, tOp.arrRects[0].w, tOp.arrRects[0].h, eColor);
+                break;
+            case YUV_DRAW_OP_RECTS:
+                hYuv.DrawRects((const CYuvHandler::YUV_RECT_T *)tOp.arrRects, tOp.nCount, eColor);
+                break;
+            case YUV_DRAW_OP_POINTS:
+                hYuv.DrawPoints(tOp.x0, tOp.y0, tOp.nCount, tOp.nScale, tOp.xOffset, tOp.yOffset, eColor);
+                break;
+            default:
+                break;
+        }
+    }
+}
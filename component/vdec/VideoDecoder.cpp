@@ -18,6 +18,10 @@ CVideoDecoder::CVideoDecoder(VDEC_GRP_CONFIG_T &tConfig) : CAXStage((std::string
 }
 
 AX_BOOL CVideoDecoder::Init() {
+    if (!CAXStage::Init()) {
+        return AX_FALSE;
+    }
+
     LOG_MM_C(VDEC, "+++");
     memset(&m_stAttr, 0, sizeof(m_stAttr));
     m_stAttr.enCodecType = m_tGrpInfo.ePayloadType;
@@ -0,0 +1,64 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#pragma once
+#include <vector>
+#include "Fmp4Muxer.h"
+#include "WebServer.h"
+
+/* fragments kept by web ring buffer of MSE channel */
+#define WEB_MSE_RING_FRAGMENTS (2)
+/* room for init segment sent ahead of each key fragment */
+#define WEB_MSE_INIT_RESERVE (64 * 1024)
+
+/*
+    Forwards init segment and fragments of CMPEG4Encoder (fragmented mode) to WS_MSE_CHANNEL of web server.
+    Each fragment starting with an I frame is preceded by the current init segment, so that a client
+    can join at any key fragment and append the messages to an MSE source buffer as they are.
+*/
+class CWebFMP4Sink : public IFMP4Sink {
+public:
+    CWebFMP4Sink(CWebServer* pSink) : m_pSink(pSink){};
+    virtual ~CWebFMP4Sink(AX_VOID) = default;
+
+    AX_BOOL Init(AX_U32 nMaxFragmentSize) {
+        if (!m_pSink || 0 == nMaxFragmentSize) {
+            return AX_FALSE;
+        }
+
+        return m_pSink->RequestRingbuf(WS_MSE_CHANNEL, nMaxFragmentSize + WEB_MSE_INIT_RESERVE, WEB_MSE_RING_FRAGMENTS, "MSE");
+    }
+
+protected:
+    /* called on the muxer thread of CMPEG4Encoder, serialized by the encoder */
+    AX_VOID OnInitSegment(const AX_U8* pData, AX_U32 nSize) override {
+        m_vecInit.assign(pData, pData + nSize);
+    }
+
+    AX_VOID OnFragment(const FMP4_FRAGMENT_T& tFragment) override {
+        if (!m_pSink || m_vecInit.empty()) {
+            return;
+        }
+
+        m_vecHead.clear();
+        if (tFragment.bKeyFrame) {
+            m_vecHead.insert(m_vecHead.end(), m_vecInit.begin(), m_vecInit.end());
+        }
+        m_vecHead.insert(m_vecHead.end(), tFragment.pHead, tFragment.pHead + tFragment.nHeadSize);
+
+        m_pSink->SendMseData(m_vecHead.data(), (AX_U32)m_vecHead.size(), tFragment.pData, tFragment.nDataSize, tFragment.nPts,
+                             tFragment.bKeyFrame);
+    }
+
+private:
+    CWebServer* m_pSink{nullptr};
+    std::vector<AX_U8> m_vecInit;
+    std::vector<AX_U8> m_vecHead;
+};
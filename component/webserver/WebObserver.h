@@ -179,6 +179,11 @@ public:
             AX_U32 nHeight = pParams->nHeight;
             AX_U32 nBuffSize = COptionHelper::GetInstance()->GetWebVencRingBufSize(nWidth, nHeight);
             AX_U32 nCount = COptionHelper::GetInstance()->GetWebVencRingBufCount(nWidth, nHeight);
+            std::shared_ptr<CAXStreamBuffer> spStreamBuf = CAXStreamBufferMgr::GetInstance()->Get(nChn);
+            if (spStreamBuf) {
+                return m_pSink->AttachStreamBuffer(nChn, spStreamBuf);
+            }
+
             sprintf(szName, "VENC_CH%d", nChn);
             return m_pSink->RequestRingbuf(nChn, nBuffSize, nCount, szName);
         } else if (E_OBS_TARGET_TYPE_JENC == eTarget) {
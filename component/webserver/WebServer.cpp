@@ -11,12 +11,18 @@
 #include "WebServer.h"
 #include <sys/prctl.h>
 #include <map>
+#include <memory>
+#include <new>
+#include <vector>
 #include "AudioOptionHelper.h"
 #include "AudioWrapper.hpp"
+#include "AXJsonWriter.hpp"
+#include "AXPoolManager.hpp"
 #include "CommonUtils.hpp"
 #include "ElapsedTimer.hpp"
 #include "IModule.h"
 #include "IPPLBuilder.h"
+#include "LatencyTracer.hpp"
 #include "OptionHelper.h"
 #include "SensorOptionHelper.h"
 #include "WebOptionHelper.h"
@@ -57,18 +63,64 @@ static std::map<string, string> g_mapUser2Token;
 static std::map<string, AX_U16> g_mapToken2Data;
 static CWebServer* s_pWebInstance = CWebServer::GetInstance();
 
-typedef struct {
-    HttpConn* conn{nullptr};
-    AX_VOID* packet{nullptr};
-} WSMsg_T;
-static std::map<void*, std::unique_ptr<WSMsg_T>> g_mapWSMsg;
-
 typedef struct {
     AX_U32 nMagic{0x54495841};  // "AXIT" by default
     AX_U32 nDatalen{0};
     AX_U64 nPts{0};
 } PTS_HEADER_T;
 
+/* max packets of one channel sent to one connection in one pass */
+#define WS_BATCH_MAX_PACKETS (8)
+/* batches queued on one connection, packets beyond are dropped until next key frame */
+#define WS_MAX_PENDING_BATCH (2)
+/* send thread wakes up at least once per timeout to refresh connection status */
+#define WS_SEND_IDLE_TIMEOUT (100)
+#define WS_SEND_STAT_INTERVAL (10000)
+
+typedef struct {
+    /* ring element, or nullptr if packet is from shared stream buffer which is sent without copy */
+    CAXRingElementEx* pElement{nullptr};
+    AX_STREAM_PACKET_T tStreamPkt;
+    PTS_HEADER_T tHeader;
+} WS_PACKET_T;
+
+typedef struct WS_CONN_MSG_S WS_CONN_MSG_T;
+
+typedef struct {
+    HttpConn* conn{nullptr};
+    WS_CONN_MSG_T* pOwner{nullptr};
+    AX_BOOL bInUse{AX_FALSE};
+    AX_S32 nChannel{0};
+    AX_U64 nQueueTick{0};
+    AX_U32 nCount{0};
+    WS_PACKET_T arrPkts[WS_BATCH_MAX_PACKETS];
+} WSMsg_T;
+
+/* messages reserved for one connection, allocated when the connection opens,
+   freed when it is closed and the last queued batch is returned by appweb dispatcher */
+struct WS_CONN_MSG_S {
+    AX_BOOL bClosed{AX_FALSE};
+    WSMsg_T arrMsg[WS_MAX_PENDING_BATCH];
+};
+
+/* batches queued by one send pass on one appweb dispatcher, sent by a single event */
+typedef struct {
+    MprDispatcher* pDispatcher{nullptr};
+    std::vector<WSMsg_T*> vecMsg;
+} WS_SEND_PASS_T;
+
+typedef struct {
+    AX_U64 nSentPkts{0};
+    AX_U64 nDropPkts{0};
+    AX_U64 nBatches{0};
+    AX_U64 nLatencySum{0}; /* ms, from queued by send thread to sent by appweb dispatcher */
+    AX_U64 nLatencyMax{0};
+} WS_SEND_STAT_T;
+
+/* messages of open connections and send statistics, guarded by g_mtxWSData */
+static std::map<HttpConn*, WS_CONN_MSG_T*> g_mapWSConnMsg;
+static WS_SEND_STAT_T g_arrWSSendStat[MAX_WS_CONN_NUM];
+
 // strong
 extern "C" void *MprVmalloc(size_t size, int mode) {
     void    *ptr;
@@ -175,78 +227,258 @@ static AX_VOID WebServerMemNotifier(int cause, int policy, size_t size, size_t t
     }
 }
 
-/* http event callback */
-static AX_VOID SendHttpData(WSMsg_T* msg) {
-    HttpConn* stream = msg->conn;
-    CAXRingElementEx* pData = static_cast<CAXRingElementEx*>(msg->packet);
-    {
-        std::lock_guard<std::mutex> guard(g_mtxWSData);
-        g_mapWSMsg.erase(msg);
+static AX_BOOL IsWSConnMsgIdle(const WS_CONN_MSG_T* pConnMsg) {
+    for (const auto& msg : pConnMsg->arrMsg) {
+        if (msg.bInUse) {
+            return AX_FALSE;
+        }
+    }
+
+    return AX_TRUE;
+}
+
+static AX_VOID OpenWSConnMsg(HttpConn* conn) {
+    std::lock_guard<std::mutex> guard(g_mtxWSData);
+    if (g_mapWSConnMsg.find(conn) != g_mapWSConnMsg.end()) {
+        return;
+    }
+
+    WS_CONN_MSG_T* pConnMsg = new (std::nothrow) WS_CONN_MSG_T;
+    if (!pConnMsg) {
+        LOG_MM_E(WEB, "alloc messages of connection %p failed.", conn);
+        return;
+    }
+
+    for (auto& msg : pConnMsg->arrMsg) {
+        msg.pOwner = pConnMsg;
+    }
+    g_mapWSConnMsg[conn] = pConnMsg;
+}
+
+static AX_VOID CloseWSConnMsg(HttpConn* conn) {
+    std::lock_guard<std::mutex> guard(g_mtxWSData);
+    auto it = g_mapWSConnMsg.find(conn);
+    if (it == g_mapWSConnMsg.end()) {
+        return;
     }
 
-    if ((mprLookupItem(g_pClients, stream) < 0) || (pData == nullptr)) {
-        if (pData && pData->pParent) {
-            pData->pParent->Free(pData);
+    WS_CONN_MSG_T* pConnMsg = it->second;
+    g_mapWSConnMsg.erase(it);
+
+    /* batches still queued to dispatcher are freed by ReleaseWSMsg */
+    pConnMsg->bClosed = AX_TRUE;
+    if (IsWSConnMsgIdle(pConnMsg)) {
+        delete pConnMsg;
+    }
+}
+
+static WSMsg_T* AllocWSMsg(HttpConn* conn, AX_S32 nChannel) {
+    std::lock_guard<std::mutex> guard(g_mtxWSData);
+    auto it = g_mapWSConnMsg.find(conn);
+    if (it == g_mapWSConnMsg.end()) {
+        return nullptr;
+    }
+
+    for (auto& msg : it->second->arrMsg) {
+        if (!msg.bInUse) {
+            msg.bInUse = AX_TRUE;
+            msg.conn = conn;
+            msg.nChannel = nChannel;
+            msg.nQueueTick = 0;
+            msg.nCount = 0;
+            return &msg;
+        }
+    }
+
+    /* WS_MAX_PENDING_BATCH batches pending on this connection */
+    return nullptr;
+}
+
+static AX_BOOL IsWSMsgConnOpen(const WSMsg_T* msg) {
+    std::lock_guard<std::mutex> guard(g_mtxWSData);
+    return msg->pOwner->bClosed ? AX_FALSE : AX_TRUE;
+}
+
+static AX_VOID ReleaseWSMsg(WSMsg_T* msg, AX_BOOL bSent) {
+    std::lock_guard<std::mutex> guard(g_mtxWSData);
+    if (bSent && msg->nChannel >= 0 && msg->nChannel < MAX_WS_CONN_NUM) {
+        WS_SEND_STAT_T& tStat = g_arrWSSendStat[msg->nChannel];
+        AX_U64 nLatency = CElapsedTimer::GetTickCount() - msg->nQueueTick;
+        tStat.nSentPkts += msg->nCount;
+        tStat.nBatches += 1;
+        tStat.nLatencySum += nLatency;
+        if (nLatency > tStat.nLatencyMax) {
+            tStat.nLatencyMax = nLatency;
         }
+    }
+
+    msg->conn = nullptr;
+    msg->nCount = 0;
+    msg->bInUse = AX_FALSE;
+
+    WS_CONN_MSG_T* pConnMsg = msg->pOwner;
+    if (pConnMsg->bClosed && IsWSConnMsgIdle(pConnMsg)) {
+        delete pConnMsg;
+    }
+}
+
+static AX_VOID AddWSDropStat(AX_S32 nChannel, AX_U32 nCount) {
+    std::lock_guard<std::mutex> guard(g_mtxWSData);
+    g_arrWSSendStat[nChannel].nDropPkts += nCount;
+}
+
+static AX_VOID PrintWSSendStat(AX_U64 nElapsed) {
+    std::lock_guard<std::mutex> guard(g_mtxWSData);
+    for (AX_S32 i = 0; i < MAX_WS_CONN_NUM; ++i) {
+        WS_SEND_STAT_T& tStat = g_arrWSSendStat[i];
+        if (0 == tStat.nSentPkts && 0 == tStat.nDropPkts) {
+            continue;
+        }
+
+        LOG_MM_I(WEB, "[%d] sent %.2f pkts/s, dropped %llu, latency avg %llu ms max %llu ms", i,
+                 tStat.nSentPkts * 1000.0 / (nElapsed ? nElapsed : 1), tStat.nDropPkts,
+                 tStat.nBatches ? tStat.nLatencySum / tStat.nBatches : 0, tStat.nLatencyMax);
+        tStat = WS_SEND_STAT_T();
+    }
+}
+
+static AX_BOOL WSPacketIsIFrame(const WS_PACKET_T& tPkt) {
+    return tPkt.pElement ? tPkt.pElement->bIFrame : tPkt.tStreamPkt.bIFrame;
+}
+
+static AX_U32 WSPacketSize(const WS_PACKET_T& tPkt) {
+    return tPkt.pElement ? (tPkt.pElement->nSize + tPkt.pElement->nSize2)
+                         : (tPkt.tStreamPkt.nSize + tPkt.tStreamPkt.nSize2 + sizeof(PTS_HEADER_T));
+}
+
+static AX_VOID WSPacketAddRef(WS_PACKET_T& tPkt) {
+    if (tPkt.pElement) {
+        tPkt.pElement->pParent->AddRef(tPkt.pElement);
+    } else {
+        tPkt.tStreamPkt.pParent->AddRef(tPkt.tStreamPkt);
+    }
+}
+
+static AX_VOID WSPacketFree(WS_PACKET_T& tPkt) {
+    if (tPkt.pElement) {
+        if (tPkt.pElement->pParent) {
+            tPkt.pElement->pParent->Free(tPkt.pElement);
+        }
+    } else if (tPkt.tStreamPkt.pParent) {
+        tPkt.tStreamPkt.pParent->Free(tPkt.tStreamPkt);
+    }
+}
+
+static AX_VOID SendHttpStreamPacket(HttpConn* stream, const AX_STREAM_PACKET_T& tPkt, const PTS_HEADER_T& tHeader) {
+    if (stream == nullptr || stream->connError || stream->timeout != 0 || !tPkt.pBuf || tPkt.nSize == 0) {
         return;
     }
 
-    if (!s_pWebInstance->IsRunning()) {
+    /* one websocket message: pts header + packet, packet may wrap around the end of shared buffer */
+    ssize nRet = httpSendBlock(stream, WS_MSG_BINARY, (cchar*)&tHeader, sizeof(PTS_HEADER_T), HTTP_BLOCK | HTTP_MORE);
+    if (nRet != (ssize)sizeof(PTS_HEADER_T)) {
+        LOG_MM_E(WEB, "httpSendBlock() header failed, ret=%d.", (AX_S32)nRet);
         return;
     }
 
+    AX_S32 nFlags = (tPkt.nSize2 > 0) ? (HTTP_BLOCK | HTTP_MORE) : HTTP_BLOCK;
+    nRet = httpSendBlock(stream, WS_MSG_BINARY, (cchar*)tPkt.pBuf, tPkt.nSize, nFlags);
+    if (nRet == (ssize)tPkt.nSize && tPkt.nSize2 > 0) {
+        nRet = httpSendBlock(stream, WS_MSG_BINARY, (cchar*)tPkt.pBuf2, tPkt.nSize2, HTTP_BLOCK);
+        if (nRet != (ssize)tPkt.nSize2) {
+            LOG_MM_E(WEB, "httpSendBlock() failed, ret=%d.", (AX_S32)nRet);
+        }
+    } else if (nRet != (ssize)tPkt.nSize) {
+        LOG_MM_E(WEB, "httpSendBlock() failed, ret=%d.", (AX_S32)nRet);
+    }
+}
+
+static AX_VOID SendHttpRingElement(HttpConn* stream, CAXRingElementEx* pData) {
     /* pData->pBuf and pData->nSize is not stable, so save them to local varible */
     AX_U8* pBuf = pData->pBuf;
     AX_S32 nSize = (AX_S32)(pData->nSize);
     AX_U8* pBuf2 = pData->pBuf2;
     AX_S32 nSize2 = (AX_S32)(pData->nSize2);
 
-    do {
-        if (stream == nullptr || stream->connError || stream->timeout != 0 || !pBuf || nSize == 0) {
-            break;
-        }
+    if (stream == nullptr || stream->connError || stream->timeout != 0 || !pBuf || nSize == 0) {
+        return;
+    }
 
-        ssize nRet = 0;
-        if (nSize2 > 0) {
-            nRet = httpSendBlock(stream, WS_MSG_BINARY, (cchar*)pBuf, nSize, HTTP_BLOCK | HTTP_MORE);
+    ssize nRet = 0;
+    if (nSize2 > 0) {
+        nRet = httpSendBlock(stream, WS_MSG_BINARY, (cchar*)pBuf, nSize, HTTP_BLOCK | HTTP_MORE);
+    } else {
+        nRet = httpSendBlock(stream, WS_MSG_BINARY, (cchar*)pBuf, nSize, HTTP_BLOCK);
+    }
+    if (nRet == nSize) {
+        if (nSize2 > 0 && pBuf2) {
+            nRet = httpSendBlock(stream, WS_MSG_BINARY, (cchar*)pBuf2, nSize2, HTTP_BLOCK);
+            if (nRet == nSize2) {
+                return;
+            }
         } else {
-            nRet = httpSendBlock(stream, WS_MSG_BINARY, (cchar*)pBuf, nSize, HTTP_BLOCK);
+            return;
         }
-        if (nRet == nSize) {
-            if (nSize2 > 0 && pBuf2) {
-                nRet = httpSendBlock(stream, WS_MSG_BINARY, (cchar*)pBuf2, nSize2, HTTP_BLOCK);
-                if (nRet == nSize2) {
-                    break;
-                }
+    }
+    switch (nRet) {
+        case MPR_ERR_TIMEOUT:
+            LOG_MM_E(WEB, "httpSendBlock() return ERR_TIMEOUT.");
+            break;
+        case MPR_ERR_MEMORY:
+            LOG_MM_E(WEB, "httpSendBlock() return ERR_MEMORY.");
+            break;
+        case MPR_ERR_BAD_STATE:
+            LOG_MM_E(WEB, "httpSendBlock() return MPR_ERR_BAD_STATE.");
+            break;
+        case MPR_ERR_BAD_ARGS:
+            LOG_MM_E(WEB, "httpSendBlock() return MPR_ERR_BAD_ARGS.");
+            break;
+        case MPR_ERR_WONT_FIT:
+            LOG_MM_E(WEB, "httpSendBlock() return MPR_ERR_WONT_FIT.");
+            break;
+        default:
+            LOG_MM_E(WEB, "httpSendBlock failed.");
+            break;
+    }
+}
+
+/* sends one batch queued by SendWSData, on the dispatcher of its connection */
+static AX_VOID SendHttpData(WSMsg_T* msg) {
+    HttpConn* stream = msg->conn;
+    /* connection may be closed, and its address reused by a new one, after the batch is queued */
+    AX_BOOL bSend = (IsWSMsgConnOpen(msg) && mprLookupItem(g_pClients, stream) >= 0 && s_pWebInstance->IsRunning()) ? AX_TRUE : AX_FALSE;
+
+    for (AX_U32 i = 0; i < msg->nCount; ++i) {
+        WS_PACKET_T& tPkt = msg->arrPkts[i];
+        if (bSend) {
+            if (tPkt.pElement) {
+                SendHttpRingElement(stream, tPkt.pElement);
             } else {
-                break;
+                SendHttpStreamPacket(stream, tPkt.tStreamPkt, tPkt.tHeader);
             }
         }
-        switch (nRet) {
-            case MPR_ERR_TIMEOUT:
-                LOG_MM_E(WEB, "httpSendBlock() return ERR_TIMEOUT.");
-                break;
-            case MPR_ERR_MEMORY:
-                LOG_MM_E(WEB, "httpSendBlock() return ERR_MEMORY.");
-                break;
-            case MPR_ERR_BAD_STATE:
-                LOG_MM_E(WEB, "httpSendBlock() return MPR_ERR_BAD_STATE.");
-                break;
-            case MPR_ERR_BAD_ARGS:
-                LOG_MM_E(WEB, "httpSendBlock() return MPR_ERR_BAD_ARGS.");
-                break;
-            case MPR_ERR_WONT_FIT:
-                LOG_MM_E(WEB, "httpSendBlock() return MPR_ERR_WONT_FIT.");
-                break;
-            default:
-                LOG_MM_E(WEB, "httpSendBlock failed.");
-                break;
-        }
-    } while (false);
 
-    if (pData && pData->pParent) {
-        pData->pParent->Free(pData);
+        WSPacketFree(tPkt);
     }
+
+    ReleaseWSMsg(msg, bSend);
+}
+
+/* http event callback, sends the batches of all connections served by one dispatcher in one pass */
+static AX_VOID SendHttpPass(WS_SEND_PASS_T* pPass) {
+    for (auto msg : pPass->vecMsg) {
+        SendHttpData(msg);
+    }
+
+    delete pPass;
+}
+
+static AX_VOID DropWSMsg(WSMsg_T* msg) {
+    for (AX_U32 i = 0; i < msg->nCount; ++i) {
+        WSPacketFree(msg->arrPkts[i]);
+    }
+    AddWSDropStat(msg->nChannel, msg->nCount);
+    ReleaseWSMsg(msg, AX_FALSE);
 }
 
 static size_t GenKeyData(AX_U8 nSnsID, AX_U8 nChnID) {
@@ -517,6 +749,7 @@ AX_VOID ReadAndPlayAudioData(HttpConn* conn) {
 static AX_VOID WebNotifier(HttpConn* conn, AX_S32 event, AX_S32 arg) {
     if ((event == HTTP_EVENT_APP_CLOSE) || (event == HTTP_EVENT_ERROR) || (event == HTTP_EVENT_DESTROY)) {
         AX_S32 nIndex = mprRemoveItem(g_pClients, conn);
+        CloseWSConnMsg(conn);
         if (nIndex >= 0) {
             LOG_MM_D(WEB, "remove connection %p, index=%d", conn, nIndex);
             CWebServer::GetInstance()->UpdateConnStatus();
@@ -781,6 +1014,7 @@ static AX_VOID SaveWSConnection(HttpConn* conn, AX_U8 nSnsID, AX_U8 nUniChnID, A
         SetNeedIDRFlagToWS(conn);
         SetIDRNumFlagToWS(conn);
     }
+    OpenWSConnMsg(conn);
     AX_S32 nIndex = mprAddItem(g_pClients, conn);
     LOG_MM_D(WEB, "connected %p, index=%d", conn, nIndex);
     httpSetConnNotifier(conn, WebNotifier);
@@ -814,6 +1048,19 @@ static AX_VOID WSPreviewAction(HttpConn* conn) {
     }
 }
 
+static AX_VOID WSMsePreviewAction(HttpConn* conn) {
+    LOG_MM_C(WEB, "...");
+    if (!IsAuthorized(conn, AX_FALSE)) {
+        ResponseUnauthorized(conn);
+        return;
+    }
+
+    /* fragments are appended to MSE source buffer as is, a new client starts from a key fragment carrying the init segment */
+    LOG_MM_I(WEB, "MSE preview %d setup conn=%p.", WS_MSE_CHANNEL, conn);
+    SaveWSConnection(conn, 0, WS_MSE_CHANNEL);
+    SetNeedIDRFlagToWS(conn);
+}
+
 static AX_VOID WSCaptureAction(HttpConn* conn) {
     LOG_MM_C(WEB, "...");
     if (!IsAuthorized(conn, AX_FALSE)) {
@@ -970,8 +1217,8 @@ static AX_VOID AssistInfoAction(HttpConn* conn) {
             mprWriteJsonObj(mprReadJsonObj(pResponseBody, "data"), "assist_res", mprParseJson("--"));
         }
 
-        AX_CHAR szBitrate[16] = {0};
-        if (CWebOptionHelper::GetInstance()->GetAssistBitrateStr(nSnsID, GetUniChn(nSnsID, nPrevIndex), szBitrate, 16)) {
+        AX_CHAR szBitrate[WEB_ASSIST_BITRATE_STR_LEN] = {0};
+        if (CWebOptionHelper::GetInstance()->GetAssistBitrateStr(nSnsID, GetUniChn(nSnsID, nPrevIndex), szBitrate, sizeof(szBitrate))) {
             mprWriteJsonObj(mprReadJsonObj(pResponseBody, "data"), "assist_bitrate", mprParseJson(szBitrate));
         } else {
             mprWriteJsonObj(mprReadJsonObj(pResponseBody, "data"), "assist_bitrate", mprParseJson("--"));
@@ -1332,10 +1579,101 @@ typedef struct _HTTP_ACTION_INFO {
     HttpAction action;
 } HTTP_ACTION_INFO;
 
+static AX_VOID PoolAction(HttpConn* conn) {
+    if (!IsAuthorized(conn, AX_TRUE)) {
+        ResponseUnauthorized(conn);
+        return;
+    }
+
+    if (strcmp(conn->rx->method, "GET") == 0) {
+        constexpr AX_U32 nBufSize = 32 * 1024;
+        std::unique_ptr<AX_CHAR[]> spBuf(new (std::nothrow) AX_CHAR[nBufSize]);
+        if (!spBuf || 0 == CAXPoolManager::GetInstance()->DumpUsage(spBuf.get(), nBufSize)) {
+            ResponseError(conn, RESPONSE_STATUS_INVALID_REQ);
+            WebMprYield();
+            return;
+        }
+
+        MprJson* pResponseBody = ConstructBaseResponse(RESPONSE_STATUS_OK, 0);
+        mprWriteJsonObj(mprReadJsonObj(pResponseBody, "data"), "pool_usage", mprParseJson(spBuf.get()));
+
+        httpSetContentType(conn, "application/json");
+        httpWrite(conn->writeq, mprJsonToString(pResponseBody, MPR_JSON_QUOTES));
+
+        httpSetStatus(conn, RESPONSE_STATUS_OK_CODE);
+        httpFinalize(conn);
+        WebMprYield();
+    } else if (strcmp(conn->rx->method, "PUT") == 0 || strcmp(conn->rx->method, "POST") == 0) {
+        /* tracking=1 starts accounting from now on, tracking=0 stops it */
+        cchar* szTracking = httpGetParam(conn, "tracking", nullptr);
+        if (!szTracking) {
+            ResponseError(conn, RESPONSE_STATUS_INVALID_REQ);
+            return;
+        }
+
+        LOG_MM_C(WEB, "Pool tracking: %s", szTracking);
+        CAXPoolManager::GetInstance()->EnableTracking(atoi(szTracking) ? AX_TRUE : AX_FALSE);
+        ResponseStatusCode(conn, RESPONSE_STATUS_OK_CODE);
+    } else {
+        ResponseStatusCode(conn, RESPONSE_STATUS_FAILURE_CODE);
+    }
+}
+
+static AX_VOID LatencyAction(HttpConn* conn) {
+    if (!IsAuthorized(conn, AX_TRUE)) {
+        ResponseUnauthorized(conn);
+        return;
+    }
+
+    if (strcmp(conn->rx->method, "GET") == 0) {
+        /* optional: enable=1|0 switches tracing, reset=1 clears histograms and kept frames, format=trace exports chrome trace */
+        CLatencyTracer* pTracer = CLatencyTracer::GetInstance();
+        cchar* szEnable = httpGetParam(conn, "enable", nullptr);
+        if (szEnable) {
+            pTracer->Enable(atoi(szEnable) ? AX_TRUE : AX_FALSE);
+        }
+        cchar* szReset = httpGetParam(conn, "reset", nullptr);
+        if (szReset && atoi(szReset)) {
+            pTracer->Reset();
+        }
+
+        cchar* szFormat = httpGetParam(conn, "format", nullptr);
+        AX_BOOL bTrace = (szFormat && strcmp(szFormat, "trace") == 0) ? AX_TRUE : AX_FALSE;
+        AX_U32 nBufSize = bTrace ? CLatencyTracer::GetTraceBufSize() : 64 * 1024;
+        std::unique_ptr<AX_CHAR[]> spBuf(new (std::nothrow) AX_CHAR[nBufSize]);
+        AX_U32 nLen = 0;
+        if (spBuf) {
+            nLen = bTrace ? pTracer->DumpTrace(spBuf.get(), nBufSize) : pTracer->DumpStat(spBuf.get(), nBufSize);
+        }
+        if (0 == nLen) {
+            ResponseError(conn, RESPONSE_STATUS_INVALID_REQ);
+            WebMprYield();
+            return;
+        }
+
+        httpSetContentType(conn, "application/json");
+        if (bTrace) {
+            /* loaded by chrome://tracing or perfetto as is */
+            httpWriteBlock(conn->writeq, spBuf.get(), nLen, HTTP_BUFFER);
+        } else {
+            MprJson* pResponseBody = ConstructBaseResponse(RESPONSE_STATUS_OK, 0);
+            mprWriteJsonObj(mprReadJsonObj(pResponseBody, "data"), "latency", mprParseJson(spBuf.get()));
+            httpWrite(conn->writeq, mprJsonToString(pResponseBody, MPR_JSON_QUOTES));
+        }
+
+        httpSetStatus(conn, RESPONSE_STATUS_OK_CODE);
+        httpFinalize(conn);
+    }
+
+    WebMprYield();
+}
+
 const HTTP_ACTION_INFO g_httpActionInfo[] = {{"/action/login", LoginAction},
                                              {"/action/setting/capability", CapabilityAction},
                                              {"/action/preview/assist", AssistInfoAction},
                                              {"/action/setting/system", SystemAction},
+                                             {"/action/setting/pool", PoolAction},
+                                             {"/action/setting/latency", LatencyAction},
                                              {"/action/setting/camera", CameraAction},
                                              {"/action/setting/image", ImageAction},
                                              {"/action/setting/audio", AudioAction},
@@ -1352,6 +1690,7 @@ const HTTP_ACTION_INFO g_httpActionInfo[] = {{"/action/login", LoginAction},
                                              {"/audio_0", WSAudioAction},
                                              {"/talk", WSTalkAction},
                                              {"/preview", WSPreviewAction},
+                                             {"/preview_mse", WSMsePreviewAction},
                                              {"/capture_0", WSCaptureAction},
                                              {"/capture_1", WSSnapshotAction},
                                              {"/events", WSEventsAction}};
@@ -1368,6 +1707,11 @@ CWebServer::~CWebServer(AX_VOID) {
             delete m_arrChannelData[i].pRingBuffer;
             m_arrChannelData[i].pRingBuffer = nullptr;
         }
+
+        if (m_arrChannelData[i].pStreamReader) {
+            delete m_arrChannelData[i].pStreamReader;
+            m_arrChannelData[i].pStreamReader = nullptr;
+        }
     }
 }
 
@@ -1399,6 +1743,9 @@ AX_BOOL CWebServer::Stop() {
     // Make sure send logout data first
     SendLogOutData();
 
+    /* wake up send thread to exit */
+    NotifySendData();
+
     {
         std::unique_lock<std::mutex> lck(m_mtxStatusCheck);
         m_bStatusCheckStarted = AX_FALSE;
@@ -1448,6 +1795,23 @@ AX_BOOL CWebServer::RequestRingbuf(AX_U32 nUniChn, AX_U32 nElementBuffSize, AX_U
     return tChnData.pRingBuffer == nullptr ? AX_FALSE : AX_TRUE;
 }
 
+AX_BOOL CWebServer::AttachStreamBuffer(AX_U32 nUniChn, std::shared_ptr<CAXStreamBuffer> spStreamBuf) {
+    if (nUniChn >= MAX_WS_CONN_NUM || !spStreamBuf) {
+        return AX_FALSE;
+    }
+
+    WS_CHANNEL_DATA_T& tChnData = m_arrChannelData[nUniChn];
+    tChnData.nChannel = nUniChn;
+    if (tChnData.pStreamReader != nullptr) {
+        delete tChnData.pStreamReader;
+        tChnData.pStreamReader = nullptr;
+    }
+    tChnData.pStreamReader = new CAXStreamReader(spStreamBuf);
+
+    LOG_MM_I(WEB, "[%d] attach to shared stream buffer %s", nUniChn, spStreamBuf->GetName());
+    return tChnData.pStreamReader == nullptr ? AX_FALSE : AX_TRUE;
+}
+
 AX_VOID* CWebServer::WebServerThreadFunc(AX_VOID* pThis) {
     LOG_MM_I(WEB, "+++");
 
@@ -1528,9 +1892,22 @@ AX_VOID* CWebServer::SendDataThreadFunc(AX_VOID* pThis) {
     prctl(PR_SET_NAME, "APP_WEB_Send");
 
     CWebServer* pWebServer = (CWebServer*)pThis;
+    AX_U64 nStatTick = CElapsedTimer::GetTickCount();
     while (pWebServer->m_bServerStarted) {
-        pWebServer->SendWSData();
-        CElapsedTimer::mSleep(10);
+        if (!pWebServer->SendWSData()) {
+            /* sleep until producers put data, wake up periodically as connection status is refreshed by SendWSData */
+            std::unique_lock<std::mutex> lck(pWebServer->m_mtxSendData);
+            pWebServer->m_cvSendData.wait_for(lck, std::chrono::milliseconds(WS_SEND_IDLE_TIMEOUT), [pWebServer]() -> bool {
+                return pWebServer->m_bSendDataPending || !pWebServer->m_bServerStarted;
+            });
+            pWebServer->m_bSendDataPending = AX_FALSE;
+        }
+
+        AX_U64 nTick = CElapsedTimer::GetTickCount();
+        if (nTick - nStatTick >= WS_SEND_STAT_INTERVAL) {
+            PrintWSSendStat(nTick - nStatTick);
+            nStatTick = nTick;
+        }
     }
 
     LOG_MM_I(WEB, "---");
@@ -1582,11 +1959,128 @@ AX_VOID* CWebServer::StatusCheckThreadFunc(AX_VOID* pThis) {
     return nullptr;
 }
 
-AX_VOID CWebServer::SendWSData(AX_VOID) {
+/* take at most nMax packets from channel, each holds one reference released by WSPacketFree */
+static AX_U32 FetchWSPackets(CAXStreamReader* pStreamReader, CAXRingBufferEx* pRingBuffer, WS_PACKET_T* pPkts, AX_U32 nMax) {
+    AX_U32 nCount = 0;
+    if (pStreamReader) {
+        while (nCount < nMax) {
+            WS_PACKET_T& tPkt = pPkts[nCount];
+            tPkt.pElement = nullptr;
+            if (!pStreamReader->Get(tPkt.tStreamPkt)) {
+                break;
+            }
+
+            tPkt.tHeader.nDatalen = tPkt.tStreamPkt.nSize + tPkt.tStreamPkt.nSize2;
+            tPkt.tHeader.nPts = tPkt.tStreamPkt.nPts;
+            ++nCount;
+        }
+    } else if (pRingBuffer) {
+        while (nCount < nMax) {
+            CAXRingElementEx* pData = pRingBuffer->Get();
+            if (!pData) {
+                break;
+            }
+
+            /* reference of Get() is kept by this pass, Pop moves to next element */
+            pRingBuffer->Pop(AX_FALSE);
+            pPkts[nCount++].pElement = pData;
+        }
+    }
+
+    return nCount;
+}
+
+/* batch packets of one pass for client, a client still holding WS_MAX_PENDING_BATCH batches drops them.
+   returns the batch to be sent by the event of this pass, or nullptr if nothing is left for client */
+static WSMsg_T* QueueWSPackets(HttpConn* client, AX_S32 nUniChn, WS_PACKET_T* pPkts, AX_U32 nCount, AX_BOOL bDropToIDR) {
+    WSMsg_T* msg = AllocWSMsg(client, nUniChn);
+    if (!msg) {
+        /* client is too slow, restart from next key frame so that decoder never sees broken references */
+        if (bDropToIDR) {
+            SetNeedIDRFlagToWS(client);
+        }
+        AddWSDropStat(nUniChn, nCount);
+        return nullptr;
+    }
+
+    AX_U32 limit = client->rx->route->limits->webSocketsFrameSize;
+    for (AX_U32 i = 0; i < nCount; ++i) {
+        WS_PACKET_T& tPkt = pPkts[i];
+        if (WSPacketSize(tPkt) >= limit) {
+            LOG_MM_E(WEB, "Websocket data size(%u) exceeding max frame size(%u).", WSPacketSize(tPkt), limit);
+        }
+
+        if (GetNeedIDRFlagFromWS(client)) {
+            if (!WSPacketIsIFrame(tPkt)) {
+                continue;
+            } else if (GetIDRNumFlagFromWS(client)) {
+                ClearIDRNumFlagToWS(client);
+                continue;
+            } else {
+                ClearNeedIDRFlagToWS(client);
+            }
+        }
+
+        /* each client holds its own reference, released by SendHttpData */
+        WSPacketAddRef(tPkt);
+        msg->arrPkts[msg->nCount++] = tPkt;
+    }
+
+    if (0 == msg->nCount) {
+        ReleaseWSMsg(msg, AX_FALSE);
+        return nullptr;
+    }
+
+    msg->nQueueTick = CElapsedTimer::GetTickCount();
+    return msg;
+}
+
+/* add batch to the pass of its dispatcher, connections usually share one dispatcher and so one event */
+static AX_VOID AddWSPass(std::vector<WS_SEND_PASS_T*>& vecPass, MprDispatcher* pDispatcher, WSMsg_T* msg) {
+    for (auto pPass : vecPass) {
+        if (pPass->pDispatcher == pDispatcher) {
+            pPass->vecMsg.push_back(msg);
+            return;
+        }
+    }
+
+    WS_SEND_PASS_T* pPass = new (std::nothrow) WS_SEND_PASS_T;
+    if (!pPass) {
+        DropWSMsg(msg);
+        return;
+    }
+
+    pPass->pDispatcher = pDispatcher;
+    pPass->vecMsg.push_back(msg);
+    vecPass.push_back(pPass);
+}
+
+/* one event per dispatcher for all batches of a pass, called with clients locked so dispatchers stay valid */
+static AX_VOID PostWSPass(std::vector<WS_SEND_PASS_T*>& vecPass) {
+    for (auto pPass : vecPass) {
+        auto pEvent = mprCreateEvent(pPass->pDispatcher, "ws", 0, (AX_VOID*)SendHttpPass, (AX_VOID*)pPass,
+                                     MPR_EVENT_STATIC_DATA | MPR_EVENT_ALWAYS);
+        if (!pEvent) {
+            for (auto msg : pPass->vecMsg) {
+                DropWSMsg(msg);
+            }
+            delete pPass;
+        }
+    }
+
+    vecPass.clear();
+}
+
+AX_BOOL CWebServer::SendWSData(AX_VOID) {
     CWebServer* pWebServer = this;
     AX_S32 nSnsID = 0;
     AX_S32 nUniChannel = 0;
+    AX_BOOL bMore = AX_FALSE;
+    /* packets fetched by this pass, one reference held per packet until end of pass */
     AX_BOOL arrDataStatus[MAX_WS_CONN_NUM] = {AX_FALSE};
+    AX_U32 arrPktNum[MAX_WS_CONN_NUM] = {0};
+    WS_PACKET_T arrPkts[MAX_WS_CONN_NUM][WS_BATCH_MAX_PACKETS];
+    std::vector<WS_SEND_PASS_T*> vecPass;
     HttpConn* client = nullptr;
 
     // gPrintHelper.Remove(E_PH_MOD_WEB_CONN, 0);
@@ -1599,8 +2093,6 @@ AX_VOID CWebServer::SendWSData(AX_VOID) {
             continue;
         }
 
-        AX_BOOL bNeedIDRFlag = GetNeedIDRFlagFromWS(client);
-
         nSnsID = GetSnsIDFromWS(client);
         if (nSnsID == -1 || nSnsID >= AX_WEB_MAX_PREV_SNS_NUM) {
             LOG_MM_D(WEB, "connect %p nSnsID = %d is invalid", client, nSnsID);
@@ -1622,71 +2114,60 @@ AX_VOID CWebServer::SendWSData(AX_VOID) {
             }
         }
 
-        if (!pWebServer->m_arrChannelData[nUniChannel].pRingBuffer) {
-            /* Ringbuff is null */
-            if (nUniChannel == 0) {
-                LOG_MM_D(WEB, "connect %p nUniChannel = %d, pRingBuffer is empty", client, nUniChannel);
+        if (!arrDataStatus[nUniChannel]) {
+            /* first subscriber of this channel in this pass, drain pending packets once for all subscribers */
+            arrDataStatus[nUniChannel] = AX_TRUE;
+            arrPktNum[nUniChannel] = FetchWSPackets(pWebServer->m_arrChannelData[nUniChannel].pStreamReader,
+                                                    pWebServer->m_arrChannelData[nUniChannel].pRingBuffer, arrPkts[nUniChannel],
+                                                    WS_BATCH_MAX_PACKETS);
+            if (WS_BATCH_MAX_PACKETS == arrPktNum[nUniChannel]) {
+                bMore = AX_TRUE;
             }
-            continue;
         }
 
-        CAXRingElementEx* pData = pWebServer->m_arrChannelData[nUniChannel].pRingBuffer->Get();
-        if (!pData) {
-            /* Ringbuff is empty */
+        if (0 == arrPktNum[nUniChannel]) {
             if (nUniChannel == 0) {
                 LOG_MM_D(WEB, "connect %p nUniChannel = %d pdata is empty", client, nUniChannel);
             }
             continue;
         }
 
-        arrDataStatus[nUniChannel] = AX_TRUE;  // got data
-        AX_U32 limit = client->rx->route->limits->webSocketsFrameSize;
-        if (pData->nSize >= (AX_U32)limit) {
-            LOG_MM_E(WEB, "Websocket data size(%u) exceeding max frame size(%u).", pData->nSize, limit);
+        /* events, capture and audio have no key frame to resync, so they are never dropped to IDR */
+        AX_BOOL bDropToIDR = (nUniChannel != m_nCaptureChannel && nUniChannel != m_nAencChannel && nUniChannel != WS_EVENTS_CHANNEL)
+                                 ? AX_TRUE
+                                 : AX_FALSE;
+        WSMsg_T* msg = QueueWSPackets(client, nUniChannel, arrPkts[nUniChannel], arrPktNum[nUniChannel], bDropToIDR);
+        if (msg) {
+            AddWSPass(vecPass, client->dispatcher, msg);
         }
 
         if (nUniChannel == 0) {
             LOG_MM_D(WEB, "connect %p send data ---", client);
         }
-
-        if (bNeedIDRFlag) {
-            //LOG_MM_E(WEB, "connect %p nUniChannel=%d, bNeedIDRFlag=%d, bIFrame=%d", client, nUniChannel, bNeedIDRFlag, pData->bIFrame);
-            if (!pData->bIFrame) {
-                pData->pParent->Free(pData);
-                continue;
-            } else {
-                if (GetIDRNumFlagFromWS(client)) {
-                    ClearIDRNumFlagToWS(client);
-                    pData->pParent->Free(pData);
-                    continue;
-                } else {
-                    ClearNeedIDRFlagToWS(client);
-                }
-            }
-        }
-
-        {
-            auto msg = std::make_unique<WSMsg_T>();
-            msg->conn = client;
-            msg->packet = pData;
-            auto pEvent =
-                mprCreateEvent(client->dispatcher, "ws", 0, (AX_VOID*)SendHttpData, (AX_VOID*)msg.get(), MPR_EVENT_STATIC_DATA | MPR_EVENT_ALWAYS);
-            if (!pEvent) {
-                pData->pParent->Free(pData);
-                msg.reset();
-            } else {
-                std::lock_guard<std::mutex> guard(g_mtxWSData);
-                g_mapWSMsg.emplace(msg.get(), std::move(msg));
-            }
-        }
     }
+    PostWSPass(vecPass);
     mprUnlock(g_pClients->mutex);
 
     pWebServer->UpdateConnStatus();
     for (AX_U32 i = 0; i < MAX_WS_CONN_NUM; i++) {
-        if (arrDataStatus[i] && pWebServer->m_arrChannelData[i].pRingBuffer) {
-            pWebServer->m_arrChannelData[i].pRingBuffer->Pop(AX_FALSE);
+        for (AX_U32 j = 0; j < arrPktNum[i]; j++) {
+            WSPacketFree(arrPkts[i][j]);
         }
+
+        if (!arrDataStatus[i] && pWebServer->m_arrChannelData[i].pStreamReader) {
+            /* nobody is watching, do not keep stale packets for next connection */
+            pWebServer->m_arrChannelData[i].pStreamReader->Reset();
+        }
+    }
+
+    return bMore;
+}
+
+AX_VOID CWebServer::NotifySendData(AX_VOID) {
+    std::lock_guard<std::mutex> lck(m_mtxSendData);
+    if (!m_bSendDataPending) {
+        m_bSendDataPending = AX_TRUE;
+        m_cvSendData.notify_one();
     }
 }
 
@@ -1707,6 +2188,12 @@ AX_VOID CWebServer::SendPreviewData(AX_U8 nUniChn, AX_VENC_PACK_T* pVencPack) {
         }
     }
 
+    if (m_arrChannelData[nUniChn].pStreamReader) {
+        /* already stored in shared stream buffer by encoder */
+        NotifySendData();
+        return;
+    }
+
     AX_BOOL bSuc = AX_FALSE;
     AX_VOID* data = pVencPack->pu8Addr;
     AX_U32 size = pVencPack->u32Len;
@@ -1721,6 +2208,36 @@ AX_VOID CWebServer::SendPreviewData(AX_U8 nUniChn, AX_VENC_PACK_T* pVencPack) {
     if (nUniChn == 0 && !bSuc) {
         LOG_MM_W(WEB, "[%d] put data failed", nUniChn);
     }
+
+    NotifySendData();
+}
+
+/* {"snsId": x, "type": x, "attribute": {...}}, eAttrType selects attribute content, return 0 if json does not fit */
+static AX_U32 FormatJpegInfoJson(AX_U8 nSnsID, AX_S32 nType, JPEG_TYPE_E eAttrType, const JPEG_DATA_INFO_T* pJpegInfo, AX_CHAR* pBuf,
+                                 AX_U32 nSize) {
+    CAXJsonWriter tJson(pBuf, nSize);
+    tJson.BeginObject().Int("snsId", nSnsID).Int("type", nType).Key("attribute").BeginObject();
+    if (JPEG_TYPE_PLATE == eAttrType) {
+        tJson.Key("plate").BeginObject();
+        tJson.String("number", pJpegInfo->tPlateInfo.szNum).String("color", pJpegInfo->tPlateInfo.szColor);
+        tJson.EndObject();
+    } else if (JPEG_TYPE_FACE == eAttrType) {
+        tJson.Key("face").BeginObject();
+        tJson.Int("gender", pJpegInfo->tFaceInfo.nGender).Int("age", pJpegInfo->tFaceInfo.nAge);
+        tJson.String("mask", pJpegInfo->tFaceInfo.szMask).String("info", pJpegInfo->tFaceInfo.szInfo);
+        tJson.EndObject();
+    } else {
+        tJson.Int("src", pJpegInfo->tCaptureInfo.tHeaderInfo.nSnsSrc);
+        tJson.Int("width", pJpegInfo->tCaptureInfo.tHeaderInfo.nWidth).Int("height", pJpegInfo->tCaptureInfo.tHeaderInfo.nHeight);
+    }
+    tJson.EndObject().EndObject();
+
+    if (!tJson.IsValid()) {
+        LOG_MM_W(WEB, "jpeg info json(type: %d) exceeds %d bytes, dropped.", nType, nSize);
+        return 0;
+    }
+
+    return tJson.GetLength();
 }
 
 AX_VOID CWebServer::SendPushImgData(AX_U8 nSnsID, AX_U8 nUniChn, AX_VOID* data, AX_U32 size, AX_U64 nPts /*= 0*/,
@@ -1749,38 +2266,21 @@ AX_VOID CWebServer::SendPushImgData(AX_U8 nSnsID, AX_U8 nUniChn, AX_VOID* data,
     LOG_MM_D(WEB, "[%d] Send capture data, size=%d", m_nCaptureChannel, size);
 
     if (nullptr != pJpegInfo) {
-        AX_CHAR szJsonData[256] = {0};
-        /* construct json data info */
-        if (pJpegInfo->eType == JPEG_TYPE_PLATE) {
-            sprintf(szJsonData, "{\"snsId\": %d, \"type\": %d, \"attribute\": {\"plate\": {\"number\": \"%s\", \"color\": \"%s\"} }}",
-                    nSnsID, pJpegInfo->eType, pJpegInfo->tPlateInfo.szNum, pJpegInfo->tPlateInfo.szColor);
-        } else if (pJpegInfo->eType == JPEG_TYPE_FACE) {
-            sprintf(szJsonData,
-                    "{\"snsId\": %d, \"type\": %d, \"attribute\": {\"face\": {\"gender\": %d, \"age\": %d, \"mask\": \"%s\", \"info\": "
-                    "\"%s\"}}}",
-                    nSnsID, pJpegInfo->eType, pJpegInfo->tFaceInfo.nGender, pJpegInfo->tFaceInfo.nAge, pJpegInfo->tFaceInfo.szMask,
-                    pJpegInfo->tFaceInfo.szInfo);
-        } else {
-            sprintf(szJsonData, "{\"snsId\": %d, \"type\": %d, \"attribute\": {\"src\": %d, \"width\": %d, \"height\": %d}}", nSnsID,
-                    pJpegInfo->eType, pJpegInfo->tCaptureInfo.tHeaderInfo.nSnsSrc, pJpegInfo->tCaptureInfo.tHeaderInfo.nWidth,
-                    pJpegInfo->tCaptureInfo.tHeaderInfo.nHeight);
-        }
-
-        AX_U32 nJsnLen = strlen(szJsonData);
-
-        /* construct jpeg head */
+        /* construct jpeg head, json data info is written in place */
         JpegHead tJpegHead;
+        AX_U32 nJsnLen = FormatJpegInfoJson(nSnsID, pJpegInfo->eType, pJpegInfo->eType, pJpegInfo, tJpegHead.szJsonData,
+                                            sizeof(tJpegHead.szJsonData));
         tJpegHead.nJsonLen = nJsnLen > 0 ? nJsnLen + 1 : 0;
         tJpegHead.nTotalLen = 4 /*magic*/ + 4 /*total len*/ + 4 /*tag*/ + 4 /*json len*/ + tJpegHead.nJsonLen;
 
-        strcpy(tJpegHead.szJsonData, szJsonData);
-
         CAXRingElementEx _ele((AX_U8*)data, size, nPts, bIFrame, (AX_U8*)&tJpegHead, tJpegHead.nTotalLen);
         m_arrChannelData[m_nCaptureChannel].pRingBuffer->Put(_ele);
     } else {
         CAXRingElementEx ele((AX_U8*)data, size, nPts, bIFrame);
         m_arrChannelData[m_nCaptureChannel].pRingBuffer->Put(ele);
     }
+
+    NotifySendData();
 }
 
 AX_VOID CWebServer::SendCaptureData(AX_U8 nSnsID, AX_U8 nUniChn, AX_VOID* data, AX_U32 size, AX_U64 nPts /*= 0*/,
@@ -1809,27 +2309,21 @@ AX_VOID CWebServer::SendCaptureData(AX_U8 nSnsID, AX_U8 nUniChn, AX_VOID* data,
     LOG_MM_D(WEB, "[%d] Send capture data, size=%d", m_nCaptureChannel, size);
     JPEG_TYPE_E eType = m_mapJencChnType[nUniChn];
     if (nullptr != pJpegInfo) {
-        AX_CHAR szJsonData[256] = {0};
-        /* construct json data info */
-        sprintf(szJsonData, "{\"snsId\": %d, \"type\": %d, \"attribute\": {\"src\": %d, \"width\": %d, \"height\": %d}}", nSnsID, eType,
-                pJpegInfo->tCaptureInfo.tHeaderInfo.nSnsSrc, pJpegInfo->tCaptureInfo.tHeaderInfo.nWidth,
-                pJpegInfo->tCaptureInfo.tHeaderInfo.nHeight);
-
-        AX_U32 nJsnLen = strlen(szJsonData);
-
-        /* construct jpeg head */
+        /* construct jpeg head, json data info is written in place */
         JpegHead tJpegHead;
+        AX_U32 nJsnLen =
+            FormatJpegInfoJson(nSnsID, eType, JPEG_TYPE_CAPTURE, pJpegInfo, tJpegHead.szJsonData, sizeof(tJpegHead.szJsonData));
         tJpegHead.nJsonLen = nJsnLen > 0 ? nJsnLen + 1 : 0;
         tJpegHead.nTotalLen = 4 /*magic*/ + 4 /*total len*/ + 4 /*tag*/ + 4 /*json len*/ + tJpegHead.nJsonLen;
 
-        strcpy(tJpegHead.szJsonData, szJsonData);
-
         CAXRingElementEx _ele((AX_U8*)data, size, nPts, bIFrame, (AX_U8*)&tJpegHead, tJpegHead.nTotalLen);
         m_arrChannelData[m_nCaptureChannel].pRingBuffer->Put(_ele);
     } else {
         CAXRingElementEx ele((AX_U8*)data, size, nPts, bIFrame);
         m_arrChannelData[m_nCaptureChannel].pRingBuffer->Put(ele);
     }
+
+    NotifySendData();
 }
 
 AX_VOID CWebServer::SendSnapshotData(AX_VOID* data, AX_U32 size, AX_VOID* conn) {
@@ -1889,6 +2383,30 @@ AX_VOID CWebServer::SendAudioData(AX_U8 nUniChn, AX_VOID* data, AX_U32 size, AX_
 
     CAXRingElementEx ele((AX_U8*)data, size, nPts, AX_TRUE, (AX_U8*)&tHeader, (AX_U32)(sizeof(tHeader)));
     m_arrChannelData[nAencChannel].pRingBuffer->Put(ele);
+
+    NotifySendData();
+}
+
+AX_VOID CWebServer::SendMseData(const AX_U8* pHead, AX_U32 nHeadSize, const AX_U8* pData, AX_U32 nDataSize, AX_U64 nPts,
+                                AX_BOOL bKeyFrame) {
+    if (!m_bServerStarted || !m_arrChannelData[WS_MSE_CHANNEL].pRingBuffer) {
+        return;
+    }
+
+    {
+        /* Waiting for reading thread to refresh the websock conn status */
+        std::lock_guard<std::mutex> guard(m_mtxConnStatus);
+        if (!m_arrConnStatus[WS_MSE_CHANNEL]) {
+            return;
+        }
+    }
+
+    CAXRingElementEx ele((AX_U8*)pData, nDataSize, nPts, bKeyFrame, (AX_U8*)pHead, nHeadSize);
+    if (!m_arrChannelData[WS_MSE_CHANNEL].pRingBuffer->Put(ele)) {
+        LOG_MM_W(WEB, "[%d] put fragment of %u bytes failed", WS_MSE_CHANNEL, nHeadSize + nDataSize);
+    }
+
+    NotifySendData();
 }
 
 AX_BOOL CWebServer::SendEventsData(WEB_EVENTS_DATA_T* data) {
@@ -1925,69 +2443,74 @@ AX_BOOL CWebServer::SendEventsData(WEB_EVENTS_DATA_T* data) {
     }
 
     AX_U8 nChnnelID = m_arrChannelData[WS_EVENTS_CHANNEL].nInnerIndex;
-    string strEventsJson;
+    AX_CHAR szEventsJson[MAX_EVENTS_CHN_SIZE];
+    AX_U32 nJsonLen = 0;
     if (E_WEB_EVENTS_TYPE_ReStartPreview == data->eType || E_WEB_EVENTS_TYPE_LogOut == data->eType) {
-        strEventsJson = FormatPreviewEventsJson(data);
+        nJsonLen = FormatPreviewEventsJson(data, szEventsJson, MAX_EVENTS_CHN_SIZE);
     } else if (E_WEB_EVENTS_TYPE_AED == data->eType) {
-        strEventsJson = FormatAedEventsJson(data);
+        nJsonLen = FormatAedEventsJson(data, szEventsJson, MAX_EVENTS_CHN_SIZE);
     } else {
-        strEventsJson = FormatIVESEventsJson(data);
+        nJsonLen = FormatIVESEventsJson(data, szEventsJson, MAX_EVENTS_CHN_SIZE);
     }
-    CAXRingElementEx ele((AX_U8*)strEventsJson.c_str(), strEventsJson.length(), nChnnelID);
+
+    if (0 == nJsonLen) {
+        LOG_MM_W(WEB, "Format events(type: %d) json failed.", data->eType);
+        return AX_FALSE;
+    }
+
+    CAXRingElementEx ele((AX_U8*)szEventsJson, nJsonLen, nChnnelID);
     m_arrChannelData[WS_EVENTS_CHANNEL].pRingBuffer->Put(ele);
 
+    NotifySendData();
+
     return AX_TRUE;
 }
 
-std::string CWebServer::FormatPreviewEventsJson(WEB_EVENTS_DATA_T* pEvent) {
-    AX_CHAR szEventJson[MAX_EVENTS_CHN_SIZE] = {0};
-    AX_CHAR szDate[64] = {0};
-    CElapsedTimer::GetInstance()->GetLocalTime(szDate, 16);
-    snprintf(szEventJson, MAX_EVENTS_CHN_SIZE, "{\"events\": [{\"type\": %d, \"sensor\":%d, \"date\": \"%s\"}]}", pEvent->eType,
-             pEvent->nReserved, szDate);
-
-    std::string strEvent;
-    strEvent = szEventJson;
+/* {"events": [{"type": x, "<name>": x, "date": "hh:mm:ss"}]} */
+#define WS_EVENTS_NAME_SENSOR "sensor"
+#define WS_EVENTS_NAME_DB "db"
+/* length of longest <name>, FormatEventJson refuses longer names at compile time */
+#define WS_EVENTS_NAME_MAX_LEN \
+    ((sizeof(WS_EVENTS_NAME_SENSOR) > sizeof(WS_EVENTS_NAME_DB) ? sizeof(WS_EVENTS_NAME_SENSOR) : sizeof(WS_EVENTS_NAME_DB)) - 1)
+#define WS_EVENTS_DATE_LEN (16)
+#define WS_EVENTS_JSON_MAX_LEN                                                                                             \
+    (sizeof("{\"events\": [{}]}") + AX_JSON_KEY_LEN("type") + AX_JSON_MAX_INT_LEN + AX_JSON_KEY_N_LEN(WS_EVENTS_NAME_MAX_LEN) + \
+     AX_JSON_MAX_INT_LEN + AX_JSON_KEY_LEN("date") + AX_JSON_STR_LEN(WS_EVENTS_DATE_LEN))
+static_assert(WS_EVENTS_JSON_MAX_LEN <= MAX_EVENTS_CHN_SIZE, "events json may exceed events ring element");
 
-    return strEvent;
-}
+template <size_t N>
+static AX_U32 FormatEventJson(AX_S32 nType, const AX_CHAR (&szName)[N], AX_S64 nValue, AX_CHAR* pBuf, AX_U32 nSize) {
+    static_assert(N - 1 <= WS_EVENTS_NAME_MAX_LEN, "event name is not bounded by WS_EVENTS_JSON_MAX_LEN");
 
-std::string CWebServer::FormatIVESEventsJson(WEB_EVENTS_DATA_T* pEvent) {
-    AX_CHAR szEventJson[MAX_EVENTS_CHN_SIZE] = {0};
     AX_CHAR szDate[64] = {0};
-    CElapsedTimer::GetInstance()->GetLocalTime(szDate, 16);
+    CElapsedTimer::GetInstance()->GetLocalTime(szDate, WS_EVENTS_DATE_LEN);
 
-    if (E_WEB_EVENTS_TYPE_MD == pEvent->eType) {
-        snprintf(szEventJson, MAX_EVENTS_CHN_SIZE, "{\"events\": [{\"type\": %d, \"sensor\":%d, \"date\": \"%s\"}]}", pEvent->eType,
-                 pEvent->nReserved, szDate);
-    } else if (E_WEB_EVENTS_TYPE_OD == pEvent->eType) {
-        snprintf(szEventJson, MAX_EVENTS_CHN_SIZE, "{\"events\": [{\"type\": %d, \"sensor\":%d,\"date\": \"%s\"}]}", pEvent->eType,
-                 pEvent->nReserved, szDate);
-    } else if (E_WEB_EVENTS_TYPE_SCD == pEvent->eType) {
-        snprintf(szEventJson, MAX_EVENTS_CHN_SIZE, "{\"events\": [{\"type\": %d, \"sensor\":%d, \"date\": \"%s\"}]}", pEvent->eType,
-                 pEvent->nReserved, szDate);
-    } else if (E_WEB_EVENTS_TYPE_ReStartPreview == pEvent->eType) {
-        snprintf(szEventJson, MAX_EVENTS_CHN_SIZE, "{\"events\": [{\"type\": %d, \"sensor\":%d, \"date\": \"%s\"}]}", pEvent->eType,
-                 pEvent->nReserved, szDate);
-    }
-    std::string strEvent;
-    strEvent = szEventJson;
+    CAXJsonWriter tJson(pBuf, nSize);
+    tJson.BeginObject().Key("events").BeginArray().BeginObject();
+    tJson.Int("type", nType).Int(szName, nValue).String("date", szDate);
+    tJson.EndObject().EndArray().EndObject();
 
-    return strEvent;
+    return tJson.IsValid() ? tJson.GetLength() : 0;
 }
 
-std::string CWebServer::FormatAedEventsJson(WEB_EVENTS_DATA_T* pEvent) {
-    AX_CHAR szEventJson[MAX_EVENTS_CHN_SIZE] = {0};
-    AX_CHAR szDate[64] = {0};
-    CElapsedTimer::GetInstance()->GetLocalTime(szDate, 16);
-
-    snprintf(szEventJson, MAX_EVENTS_CHN_SIZE, "{\"events\": [{\"type\": %d, \"db\":%d, \"date\": \"%s\"}]}", pEvent->eType,
-             pEvent->tAED.nDb, szDate);
+AX_U32 CWebServer::FormatPreviewEventsJson(WEB_EVENTS_DATA_T* pEvent, AX_CHAR* pBuf, AX_U32 nSize) {
+    return FormatEventJson(pEvent->eType, WS_EVENTS_NAME_SENSOR, pEvent->nReserved, pBuf, nSize);
+}
 
-    std::string strEvent;
-    strEvent = szEventJson;
+AX_U32 CWebServer::FormatIVESEventsJson(WEB_EVENTS_DATA_T* pEvent, AX_CHAR* pBuf, AX_U32 nSize) {
+    switch (pEvent->eType) {
+        case E_WEB_EVENTS_TYPE_MD:
+        case E_WEB_EVENTS_TYPE_OD:
+        case E_WEB_EVENTS_TYPE_SCD:
+        case E_WEB_EVENTS_TYPE_ReStartPreview:
+            return FormatEventJson(pEvent->eType, WS_EVENTS_NAME_SENSOR, pEvent->nReserved, pBuf, nSize);
+        default:
+            return 0;
+    }
+}
 
-    return strEvent;
+AX_U32 CWebServer::FormatAedEventsJson(WEB_EVENTS_DATA_T* pEvent, AX_CHAR* pBuf, AX_U32 nSize) {
+    return FormatEventJson(pEvent->eType, WS_EVENTS_NAME_DB, pEvent->tAED.nDb, pBuf, nSize);
 }
 
 /* TODO: PrevChn -> UniChn mapping must be registered in order by modules */
@@ -2065,14 +2588,15 @@ AX_BOOL CWebServer::SendLogOutData() {
         if (nUniChannel == WS_EVENTS_CHANNEL) {
             WEB_EVENTS_DATA_T tEvent;
             tEvent.eType = E_WEB_EVENTS_TYPE_LogOut;
-            string strLogoutData = FormatPreviewEventsJson(&tEvent);
+            AX_CHAR szLogoutData[MAX_EVENTS_CHN_SIZE];
+            AX_U32 nLogoutLen = FormatPreviewEventsJson(&tEvent, szLogoutData, MAX_EVENTS_CHN_SIZE);
             LOG_MM_D(WEB, "Send logout data to client=%p", client);
-            ssize nRet = httpSendBlock(client, WS_MSG_BINARY, (cchar*)strLogoutData.c_str(), strLogoutData.length(), HTTP_BLOCK);
-            if (nRet == (ssize)strLogoutData.length()) {
+            ssize nRet = httpSendBlock(client, WS_MSG_BINARY, (cchar*)szLogoutData, nLogoutLen, HTTP_BLOCK);
+            if (nRet == (ssize)nLogoutLen) {
                 bRet = AX_TRUE;
             } else {
                 LOG_MM_E(WEB, "httpSendBlock failed for data: %s(len: %d) with nRet: %d.",
-                            strLogoutData.c_str(), strLogoutData.length(), nRet);
+                            szLogoutData, nLogoutLen, nRet);
             }
         }
     }
@@ -16,6 +16,7 @@
 #include "condition_variable.hpp"
 #include "AXRingBufferEx.h"
 #include "AXSingleton.h"
+#include "AXStreamBuffer.h"
 #include "AppLogApi.h"
 #include "EncoderOptionHelper.h"
 #include "IModule.h"
@@ -26,6 +27,8 @@
 
 #define WS_EVENTS_CHANNEL (MAX_WS_CONN_NUM - 1)
 #define WS_CAPTURE_CHANNEL (MAX_WS_CONN_NUM - 3)
+/* fragmented mp4 of the recorder for MSE preview, see CWebFMP4Sink */
+#define WS_MSE_CHANNEL (MAX_WS_CONN_NUM - 4)
 #define MAX_EVENTS_CHN_SIZE (256)
 #define AX_WEB_MAX_PREV_SNS_NUM (3)
 
@@ -625,8 +628,11 @@ public:
     AX_VOID SendSnapshotData(AX_VOID* data, AX_U32 size, AX_VOID* conn);
     AX_BOOL SendEventsData(WEB_EVENTS_DATA_T* data);
     AX_VOID SendAudioData(AX_U8 nUniChn, AX_VOID* data, AX_U32 size, AX_U64 nPts);
+    /* one websocket message of WS_MSE_CHANNEL: pHead (init segment of key fragments, moof, mdat header) + mdat payload */
+    AX_VOID SendMseData(const AX_U8* pHead, AX_U32 nHeadSize, const AX_U8* pData, AX_U32 nDataSize, AX_U64 nPts, AX_BOOL bKeyFrame);
 
     AX_BOOL RequestRingbuf(AX_U32 nUniChn, AX_U32 nElementBuffSize, AX_U32 nBuffCount, std::string strName);
+    AX_BOOL AttachStreamBuffer(AX_U32 nUniChn, std::shared_ptr<CAXStreamBuffer> spStreamBuf);
     AX_U8 RegistPreviewChnMappingInOrder(AX_U8 nSnsID, AX_U8 nUniChn, AX_U8 nType);
     AX_VOID UpdateMediaTypeInPreviewChnMap(AX_U8 nSnsID, AX_U8 nUniChn, AX_U8 nType);
     AX_VOID RegistUniCaptureChn(AX_S8 nCaptureChn, JPEG_TYPE_E eType = JPEG_TYPE_CAPTURE);
@@ -674,19 +680,24 @@ private:
     ~CWebServer(AX_VOID);
 
     AX_BOOL SendLogOutData();
-    AX_VOID SendWSData(AX_VOID);
+    /* send all pending packets to subscribed connections, return AX_TRUE if some channel still has packets left */
+    AX_BOOL SendWSData(AX_VOID);
+    /* wake up send thread, called by producers after data is put */
+    AX_VOID NotifySendData(AX_VOID);
 
     static AX_VOID* WebServerThreadFunc(AX_VOID* pThis);
     static AX_VOID* SendDataThreadFunc(AX_VOID* pThis);
     static AX_VOID* StatusCheckThreadFunc(AX_VOID* pThis);
 
-    std::string FormatAedEventsJson(WEB_EVENTS_DATA_T* pEvent);
-    std::string FormatIVESEventsJson(WEB_EVENTS_DATA_T* pEvent);
-    std::string FormatPreviewEventsJson(WEB_EVENTS_DATA_T* pEvent);
+    /* format event json into pBuf, return json length or 0 if event is unknown or buffer is too small */
+    AX_U32 FormatAedEventsJson(WEB_EVENTS_DATA_T* pEvent, AX_CHAR* pBuf, AX_U32 nSize);
+    AX_U32 FormatIVESEventsJson(WEB_EVENTS_DATA_T* pEvent, AX_CHAR* pBuf, AX_U32 nSize);
+    AX_U32 FormatPreviewEventsJson(WEB_EVENTS_DATA_T* pEvent, AX_CHAR* pBuf, AX_U32 nSize);
 
 private:
     typedef struct _WS_CHANNEL_DATA_T {
         CAXRingBufferEx* pRingBuffer;
+        CAXStreamReader* pStreamReader; /* read venc stream from shared buffer instead of pRingBuffer */
         AX_U8 nChannel;
         AX_U8 nInnerIndex;
         _WS_CHANNEL_DATA_T() {
@@ -706,6 +717,10 @@ private:
     std::thread* m_pStatucCheckThread{nullptr};
     std::mutex m_mtxConnStatus;
 
+    AX_BOOL m_bSendDataPending{AX_FALSE};
+    std::mutex m_mtxSendData;
+    std::condition_variable m_cvSendData;
+
     AX_BOOL m_bStatusCheckStarted{AX_FALSE};
     std::mutex m_mtxStatusCheck;
     std::condition_variable m_cvStatusCheck;
@@ -0,0 +1,214 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+/*
+    Model of websocket send passes of CWebServer::SendWSData on host, appweb is not linked.
+
+    A dispatcher thread stands for the appweb dispatcher shared by connections: events are allocated and queued under
+    its lock and the thread is woken, as mprCreateEvent does. Each event callback copies the batch of a client into
+    the client socket buffer, as httpSendBlock does.
+
+    per client:  one event per client per pass (before)
+    per pass:    one event per pass walking the batches of all clients (SendHttpPass)
+
+    Each mode reports events and dispatcher wakeups per pass, time spent by send thread queueing a pass,
+    and latency from queueing a pass to the last client being sent.
+
+    usage: ws_event_bench [clients] [passes]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "host_tool.h"
+
+#define BENCH_PKT_SIZE (16 * 1024) /* one P frame of main stream */
+#define BENCH_PASS_INTERVAL_US (1000000 / 30)
+
+typedef struct {
+    std::vector<AX_U8> vecSock; /* socket buffer of connection */
+    AX_U64 nSent{0};
+} BENCH_CLIENT_T;
+
+typedef struct {
+    std::vector<BENCH_CLIENT_T*> vecClient; /* one batch per client */
+} BENCH_EVENT_T;
+
+class CBenchDispatcher {
+public:
+    CBenchDispatcher(AX_VOID) : m_thread([this]() { Run(); }) {
+    }
+
+    ~CBenchDispatcher(AX_VOID) {
+        {
+            std::lock_guard<std::mutex> lck(m_mtx);
+            m_bExit = AX_TRUE;
+        }
+        m_cv.notify_one();
+        m_thread.join();
+    }
+
+    AX_VOID CreateEvent(BENCH_EVENT_T* pEvent) {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        m_qEvent.push_back(pEvent);
+        m_nEvents++;
+        if (m_bIdle) {
+            m_bIdle = AX_FALSE;
+            m_nWakeups++;
+            m_cv.notify_one();
+        }
+    }
+
+    /* return time the last event was done */
+    AX_U64 WaitIdle(AX_VOID) {
+        std::unique_lock<std::mutex> lck(m_mtx);
+        m_cvIdle.wait(lck, [this]() { return m_qEvent.empty() && m_bIdle; });
+        return m_nDoneNs;
+    }
+
+    AX_U64 m_nEvents{0};
+    AX_U64 m_nWakeups{0};
+
+private:
+    AX_VOID Run(AX_VOID) {
+        std::unique_lock<std::mutex> lck(m_mtx);
+        while (!m_bExit) {
+            if (m_qEvent.empty()) {
+                m_bIdle = AX_TRUE;
+                m_cvIdle.notify_all();
+                m_cv.wait(lck);
+                continue;
+            }
+
+            BENCH_EVENT_T* pEvent = m_qEvent.front();
+            m_qEvent.pop_front();
+            lck.unlock();
+
+            for (auto pClient : pEvent->vecClient) {
+                memset(pClient->vecSock.data(), (AX_S32)pClient->nSent, pClient->vecSock.size());
+                pClient->nSent++;
+            }
+            delete pEvent;
+
+            lck.lock();
+            m_nDoneNs = HostToolNowNs();
+        }
+    }
+
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::condition_variable m_cvIdle;
+    std::deque<BENCH_EVENT_T*> m_qEvent;
+    AX_U64 m_nDoneNs{0};
+    AX_BOOL m_bIdle{AX_FALSE};
+    AX_BOOL m_bExit{AX_FALSE};
+    std::thread m_thread;
+};
+
+typedef struct {
+    AX_F64 fEventsPerPass;
+    AX_F64 fWakeupsPerPass;
+    AX_F64 fQueueUs;
+    AX_F64 fLatencyUs;
+    AX_F64 fLatencyMaxUs;
+    AX_BOOL bOk;
+} BENCH_RESULT_T;
+
+static BENCH_RESULT_T BenchRun(AX_U32 nClients, AX_U32 nPasses, AX_BOOL bPerPass) {
+    std::vector<BENCH_CLIENT_T> vecClients(nClients);
+    for (auto& tClient : vecClients) {
+        tClient.vecSock.resize(BENCH_PKT_SIZE);
+    }
+
+    BENCH_RESULT_T tResult;
+    memset(&tResult, 0, sizeof(tResult));
+    AX_U64 nLatencyNs = 0;
+    AX_U64 nLatencyMaxNs = 0;
+    AX_U64 nEvents = 0;
+    AX_U64 nWakeups = 0;
+    {
+        CBenchDispatcher tDispatcher;
+        tDispatcher.WaitIdle();
+
+        AX_U64 nQueueNs = 0;
+        for (AX_U32 i = 0; i < nPasses; ++i) {
+            AX_U64 nStart = HostToolNowNs();
+            if (bPerPass) {
+                BENCH_EVENT_T* pEvent = new BENCH_EVENT_T;
+                for (auto& tClient : vecClients) {
+                    pEvent->vecClient.push_back(&tClient);
+                }
+                tDispatcher.CreateEvent(pEvent);
+            } else {
+                for (auto& tClient : vecClients) {
+                    BENCH_EVENT_T* pEvent = new BENCH_EVENT_T;
+                    pEvent->vecClient.push_back(&tClient);
+                    tDispatcher.CreateEvent(pEvent);
+                }
+            }
+            nQueueNs += HostToolNowNs() - nStart;
+
+            /* pass is done when the last client is sent */
+            AX_U64 nLatency = tDispatcher.WaitIdle() - nStart;
+            nLatencyNs += nLatency;
+            if (nLatency > nLatencyMaxNs) {
+                nLatencyMaxNs = nLatency;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(BENCH_PASS_INTERVAL_US / 10));
+        }
+
+        tResult.fQueueUs = nQueueNs / 1000.0 / nPasses;
+        nEvents = tDispatcher.m_nEvents;
+        nWakeups = tDispatcher.m_nWakeups;
+    }
+
+    tResult.fEventsPerPass = (AX_F64)nEvents / nPasses;
+    tResult.fWakeupsPerPass = (AX_F64)nWakeups / nPasses;
+    tResult.fLatencyUs = nLatencyNs / 1000.0 / nPasses;
+    tResult.fLatencyMaxUs = nLatencyMaxNs / 1000.0;
+    tResult.bOk = AX_TRUE;
+    for (auto& tClient : vecClients) {
+        if (tClient.nSent != nPasses) {
+            tResult.bOk = AX_FALSE;
+        }
+    }
+
+    return tResult;
+}
+
+int main(int argc, char* argv[]) {
+    AX_U32 nClients = (argc > 1) ? (AX_U32)atoi(argv[1]) : 16;
+    AX_U32 nPasses = (argc > 2) ? (AX_U32)atoi(argv[2]) : 2000;
+    if (0 == nClients || 0 == nPasses) {
+        printf("usage: %s [clients] [passes]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%u clients, %u passes, %u KB per client per pass\n", nClients, nPasses, BENCH_PKT_SIZE >> 10);
+    printf("%-11s %8s %8s %10s %12s %12s\n", "mode", "events", "wakeups", "queue us", "latency us", "max us");
+
+    AX_BOOL bOk = AX_TRUE;
+    const AX_CHAR* arrNames[] = {"per client", "per pass"};
+    for (AX_U32 i = 0; i < HOST_TOOL_ARRAY_SIZE(arrNames); ++i) {
+        BENCH_RESULT_T tResult = BenchRun(nClients, nPasses, i ? AX_TRUE : AX_FALSE);
+        printf("%-11s %8.1f %8.1f %10.2f %12.2f %12.2f%s\n", arrNames[i], tResult.fEventsPerPass, tResult.fWakeupsPerPass, tResult.fQueueUs,
+               tResult.fLatencyUs, tResult.fLatencyMaxUs, tResult.bOk ? "" : "  FAILED");
+        if (!tResult.bOk) {
+            bOk = AX_FALSE;
+        }
+    }
+
+    return bOk ? 0 : 1;
+}
@@ -57,7 +57,7 @@ if [ $# -lt 2 ] ; then
   echo "   l: log level, indicates the log level."
   echo "      ALERT = 1, CRITICAL = 2, ERROR = 3 (DEFAULT), WARN = 4, NOTICE = 5, INFO = 6, DEBUG = 7, DATA = 8"
   echo "   t: log target, indicates the log output targets."
-  echo "      SYSLOG = 1, APPLOG = 2, STDOUT = 4 (DEFAULT) (Calculate the sum if multiple targets is required)"
+  echo "      SYSLOG = 1, APPLOG = 2, STDOUT = 4 (DEFAULT), ASYNC = 8 (Calculate the sum if multiple targets is required, ASYNC writes the other targets from a background thread)"
   echo "   c: config path, indicates configure files top path."
   echo "      ./config (Default)"
   exit 1;
@@ -12,6 +12,7 @@
 #include <signal.h>
 #include <sys/prctl.h>
 
+#include "AXPoolManager.hpp"
 #include "CmdLineParser.h"
 #include "CommonUtils.hpp"
 #include "ElapsedTimer.hpp"
@@ -145,6 +146,11 @@ int main(int argc, const char* argv[]) {
 
     get_sdk_version();
 
+    AX_S32 nPoolStatInterval = 0;
+    if (CCmdLineParser::GetInstance()->GetPoolStatInterval(nPoolStatInterval) && nPoolStatInterval > 0) {
+        CAXPoolManager::GetInstance()->EnableTracking(AX_TRUE);
+    }
+
     switch (nPPLIndex) {
 #ifdef IPC_SUPPORT
         // IPC
@@ -225,6 +231,7 @@ int main(int argc, const char* argv[]) {
 
     g_Running = AX_TRUE;
     AX_U32 nRunTimes = 0;
+    AX_U32 nPoolStatTimes = 0;
 
     while (g_Running) {
         CElapsedTimer::GetInstance()->mSleep(100);
@@ -235,6 +242,11 @@ int main(int argc, const char* argv[]) {
             nRunTimes = 0;
         }
 
+        if (nPoolStatInterval > 0 && ++nPoolStatTimes >= 10 * (AX_U32)nPoolStatInterval) {
+            CAXPoolManager::GetInstance()->PrintUsage();
+            nPoolStatTimes = 0;
+        }
+
 #ifdef SLT
         AX_S32 nSLTRet = CPrintHelper::GetInstance()->GetSLTResult();
         if (nSLTRet == 1 || nSLTRet == 0) {
@@ -245,6 +257,10 @@ int main(int argc, const char* argv[]) {
 #endif
     }
 
+    if (nPoolStatInterval > 0) {
+        CAXPoolManager::GetInstance()->PrintUsage();
+    }
+
     if (g_pPPLBuilder) {
         if (!g_pPPLBuilder->Stop()) {
             printf("PPL stop failed.\n");
@@ -1,131 +0,0 @@
-/**************************************************************************************************
- *
- * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
- *
- * This source file is the property of Axera Semiconductor Co., Ltd. and
- * may not be copied or distributed in any isomorphic form without the prior
- * written consent of Axera Semiconductor Co., Ltd.
- *
- **************************************************************************************************/
-
-#ifndef __FONTEN16_H__
-#define __FONTEN16_H__
-
-#include "FontDefine.h"
-
-// English(ASCII) Glyphs: WxH = 8x16
-const static AX_U8 g_fontEn16Glyphs[] = {
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40,
-    0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f,
-    0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
-    0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f,
-    0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40,
-    0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
-    0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00,
-    0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x0c, 0x1e, 0x3f, 0x7f, 0x6d, 0x4c, 0x0c, 0x0c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f,
-    0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
-    0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f,
-    0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40,
-    0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
-    0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00,
-    0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40,
-    0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
-    0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f,
-    0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
-    0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f,
-    0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40,
-    0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,
-    0x40, 0x40, 0x40, 0x7f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x10, 0x10, 0x00, 0x00, 0x00, 0x12, 0x24, 0x24, 0x48, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x12, 0x12, 0x7e, 0x24, 0x24, 0x24, 0x7e, 0x24,
-    0x24, 0x24, 0x00, 0x00, 0x00, 0x00, 0x08, 0x3c, 0x4a, 0x4a, 0x48, 0x38, 0x0c, 0x0a, 0x0a, 0x4a, 0x4a, 0x3c, 0x08, 0x08, 0x00, 0x00,
-    0x00, 0x44, 0xa4, 0xa8, 0xa8, 0xb0, 0x54, 0x1a, 0x2a, 0x2a, 0x4a, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x48, 0x48, 0x48, 0x50,
-    0x6e, 0xa4, 0x94, 0x98, 0x89, 0x76, 0x00, 0x00, 0x00, 0x60, 0x20, 0x20, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x02, 0x04, 0x08, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x08, 0x08, 0x04, 0x02, 0x00, 0x00, 0x40, 0x20, 0x10,
-    0x10, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x10, 0x10, 0x20, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0xd6, 0x38, 0x38, 0xd6,
-    0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x7f, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x20, 0x20, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x7e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x60, 0x60, 0x00, 0x00, 0x00, 0x00, 0x02, 0x04, 0x04, 0x04, 0x08, 0x08, 0x10, 0x10, 0x10, 0x20, 0x20, 0x40, 0x40, 0x00, 0x00, 0x00,
-    0x00, 0x18, 0x24, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x24, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x38, 0x08, 0x08, 0x08,
-    0x08, 0x08, 0x08, 0x08, 0x08, 0x3e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x42, 0x42, 0x42, 0x02, 0x04, 0x08, 0x10, 0x20, 0x42, 0x7e,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x42, 0x42, 0x02, 0x04, 0x18, 0x04, 0x02, 0x42, 0x42, 0x3c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04,
-    0x0c, 0x0c, 0x14, 0x24, 0x24, 0x44, 0x7f, 0x04, 0x04, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7e, 0x40, 0x40, 0x40, 0x78, 0x44, 0x02,
-    0x02, 0x42, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x24, 0x40, 0x40, 0x5c, 0x62, 0x42, 0x42, 0x42, 0x22, 0x1c, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x7e, 0x42, 0x04, 0x04, 0x08, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x42, 0x42,
-    0x42, 0x24, 0x18, 0x24, 0x42, 0x42, 0x42, 0x3c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x38, 0x44, 0x42, 0x42, 0x42, 0x46, 0x3a, 0x02, 0x02,
-    0x24, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x02, 0x04, 0x08, 0x10, 0x20,
-    0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7e, 0x00, 0x00, 0x7e, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c,
-    0x42, 0x42, 0x62, 0x04, 0x08, 0x08, 0x08, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x38, 0x44, 0x5a, 0xaa, 0xaa, 0xaa, 0xaa,
-    0xaa, 0x5c, 0x42, 0x3c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x18, 0x28, 0x28, 0x24, 0x3c, 0x44, 0x42, 0x42, 0xe7, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0xf8, 0x44, 0x44, 0x44, 0x78, 0x44, 0x42, 0x42, 0x42, 0x44, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3e, 0x42, 0x42,
-    0x80, 0x80, 0x80, 0x80, 0x80, 0x42, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf8, 0x44, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42,
-    0x44, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfc, 0x42, 0x48, 0x48, 0x78, 0x48, 0x48, 0x40, 0x42, 0x42, 0xfc, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0xfc, 0x42, 0x48, 0x48, 0x78, 0x48, 0x48, 0x40, 0x40, 0x40, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x44, 0x44, 0x80, 0x80,
-    0x80, 0x8e, 0x84, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe7, 0x42, 0x42, 0x42, 0x42, 0x7e, 0x42, 0x42, 0x42, 0x42, 0xe7,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x7c, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x7c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3e,
-    0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x88, 0xf0, 0x00, 0x00, 0x00, 0xee, 0x44, 0x48, 0x50, 0x70, 0x50, 0x48,
-    0x48, 0x44, 0x44, 0xee, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x42, 0xfe, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0xee, 0x6c, 0x6c, 0x6c, 0x6c, 0x6c, 0x54, 0x54, 0x54, 0x54, 0xd6, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc7, 0x62, 0x62,
-    0x52, 0x52, 0x4a, 0x4a, 0x4a, 0x46, 0x46, 0xe2, 0x00, 0x00, 0x00, 0x00, 0x00, 0x38, 0x44, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82,
-    0x44, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfc, 0x42, 0x42, 0x42, 0x42, 0x7c, 0x40, 0x40, 0x40, 0x40, 0xe0, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x38, 0x44, 0x82, 0x82, 0x82, 0x82, 0x82, 0x82, 0xb2, 0x4c, 0x38, 0x06, 0x00, 0x00, 0x00, 0x00, 0xfc, 0x42, 0x42, 0x42, 0x7c,
-    0x48, 0x48, 0x44, 0x44, 0x42, 0xe3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3e, 0x42, 0x42, 0x40, 0x20, 0x18, 0x04, 0x02, 0x42, 0x42, 0x7c,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x92, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe7,
-    0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x3c, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe7, 0x42, 0x42, 0x44, 0x24, 0x24, 0x28,
-    0x28, 0x18, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd6, 0x54, 0x54, 0x54, 0x54, 0x54, 0x6c, 0x28, 0x28, 0x28, 0x28, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0xe7, 0x42, 0x24, 0x24, 0x18, 0x18, 0x18, 0x24, 0x24, 0x42, 0xe7, 0x00, 0x00, 0x00, 0x00, 0x00, 0xee, 0x44, 0x44,
-    0x28, 0x28, 0x10, 0x10, 0x10, 0x10, 0x10, 0x38, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7e, 0x84, 0x04, 0x08, 0x08, 0x10, 0x20, 0x20, 0x42,
-    0x42, 0xfc, 0x00, 0x00, 0x00, 0x1e, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1e, 0x00, 0x00, 0x00,
-    0x40, 0x20, 0x20, 0x20, 0x10, 0x10, 0x10, 0x08, 0x08, 0x04, 0x04, 0x04, 0x02, 0x02, 0x00, 0x78, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,
-    0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x78, 0x00, 0x00, 0x18, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x00, 0x60, 0x10, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x38, 0x44, 0x0c,
-    0x34, 0x44, 0x4c, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x40, 0x40, 0x58, 0x64, 0x42, 0x42, 0x42, 0x64, 0x58, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1c, 0x22, 0x40, 0x40, 0x40, 0x22, 0x1c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x02,
-    0x02, 0x3e, 0x42, 0x42, 0x42, 0x42, 0x46, 0x3b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x42, 0x42, 0x7e, 0x40,
-    0x42, 0x3c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x12, 0x10, 0x7c, 0x10, 0x10, 0x10, 0x10, 0x10, 0x7c, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x3e, 0x44, 0x44, 0x38, 0x40, 0x3c, 0x42, 0x42, 0x3c, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x40, 0x40, 0x5c,
-    0x62, 0x42, 0x42, 0x42, 0x42, 0xe7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x00, 0x00, 0x70, 0x10, 0x10, 0x10, 0x10, 0x10, 0x7c,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c, 0x00, 0x00, 0x1c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x44, 0x78, 0x00, 0x00, 0x00, 0x00,
-    0xc0, 0x40, 0x40, 0x4e, 0x48, 0x50, 0x70, 0x48, 0x44, 0xee, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x70, 0x10, 0x10, 0x10, 0x10, 0x10,
-    0x10, 0x10, 0x10, 0x7c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x49, 0x49, 0x49, 0x49, 0x49, 0xed, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xdc, 0x62, 0x42, 0x42, 0x42, 0x42, 0xe7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x3c, 0x42, 0x42, 0x42, 0x42, 0x42, 0x3c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xd8, 0x64, 0x42, 0x42, 0x42,
-    0x64, 0x58, 0x40, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1a, 0x26, 0x42, 0x42, 0x42, 0x26, 0x1a, 0x02, 0x07, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0xee, 0x32, 0x20, 0x20, 0x20, 0x20, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3e,
-    0x42, 0x40, 0x3c, 0x02, 0x42, 0x7c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x7c, 0x10, 0x10, 0x10, 0x10, 0x12, 0x0c,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc6, 0x42, 0x42, 0x42, 0x42, 0x46, 0x3b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0xee, 0x44, 0x44, 0x28, 0x28, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xdb, 0x89, 0x4a,
-    0x5a, 0x54, 0x24, 0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x76, 0x24, 0x18, 0x18, 0x18, 0x24, 0x6e, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe7, 0x42, 0x24, 0x24, 0x18, 0x18, 0x10, 0x10, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x7e, 0x44, 0x08, 0x10, 0x10, 0x22, 0x7e, 0x00, 0x00, 0x00, 0x03, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x08, 0x04, 0x04, 0x04,
-    0x04, 0x04, 0x03, 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0xc0,
-    0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x10, 0x20, 0x20, 0x20, 0x20, 0x20, 0xc0, 0x00, 0x20, 0x5a, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-    0x00, 0x00};
-// Unicode to Glyph ID
-const static UICODE_INDEX_T g_fontEn16Index[] = {
-    {0x0000, 0x0000}, {0x0001, 0x0001}, {0x0002, 0x0002}, {0x0003, 0x0003}, {0x0004, 0x0004}, {0x0005, 0x0005}, {0x0006, 0x0006}, {0x0007, 0x0007},
-    {0x0008, 0x0008}, {0x0009, 0x0009}, {0x000a, 0x000a}, {0x000b, 0x000b}, {0x000c, 0x000c}, {0x000d, 0x000d}, {0x000e, 0x000e}, {0x000f, 0x000f},
-    {0x0010, 0x0010}, {0x0011, 0x0011}, {0x0012, 0x0012}, {0x0013, 0x0013}, {0x0014, 0x0014}, {0x0015, 0x0015}, {0x0016, 0x0016}, {0x0017, 0x0017},
-    {0x0018, 0x0018}, {0x0019, 0x0019}, {0x001a, 0x001a}, {0x001b, 0x001b}, {0x001c, 0x001c}, {0x001d, 0x001d}, {0x001e, 0x001e}, {0x001f, 0x001f},
-    {0x0020, 0x0020}, {0x0021, 0x0021}, {0x0022, 0x0022}, {0x0023, 0x0023}, {0x0024, 0x0024}, {0x0025, 0x0025}, {0x0026, 0x0026}, {0x0027, 0x0027},
-    {0x0028, 0x0028}, {0x0029, 0x0029}, {0x002a, 0x002a}, {0x002b, 0x002b}, {0x002c, 0x002c}, {0x002d, 0x002d}, {0x002e, 0x002e}, {0x002f, 0x002f},
-    {0x0030, 0x0030}, {0x0031, 0x0031}, {0x0032, 0x0032}, {0x0033, 0x0033}, {0x0034, 0x0034}, {0x0035, 0x0035}, {0x0036, 0x0036}, {0x0037, 0x0037},
-    {0x0038, 0x0038}, {0x0039, 0x0039}, {0x003a, 0x003a}, {0x003b, 0x003b}, {0x003c, 0x003c}, {0x003d, 0x003d}, {0x003e, 0x003e}, {0x003f, 0x003f},
-    {0x0040, 0x0040}, {0x0041, 0x0041}, {0x0042, 0x0042}, {0x0043, 0x0043}, {0x0044, 0x0044}, {0x0045, 0x0045}, {0x0046, 0x0046}, {0x0047, 0x0047},
-    {0x0048, 0x0048}, {0x0049, 0x0049}, {0x004a, 0x004a}, {0x004b, 0x004b}, {0x004c, 0x004c}, {0x004d, 0x004d}, {0x004e, 0x004e}, {0x004f, 0x004f},
-    {0x0050, 0x0050}, {0x0051, 0x0051}, {0x0052, 0x0052}, {0x0053, 0x0053}, {0x0054, 0x0054}, {0x0055, 0x0055}, {0x0056, 0x0056}, {0x0057, 0x0057},
-    {0x0058, 0x0058}, {0x0059, 0x0059}, {0x005a, 0x005a}, {0x005b, 0x005b}, {0x005c, 0x005c}, {0x005d, 0x005d}, {0x005e, 0x005e}, {0x005f, 0x005f},
-    {0x0060, 0x0060}, {0x0061, 0x0061}, {0x0062, 0x0062}, {0x0063, 0x0063}, {0x0064, 0x0064}, {0x0065, 0x0065}, {0x0066, 0x0066}, {0x0067, 0x0067},
-    {0x0068, 0x0068}, {0x0069, 0x0069}, {0x006a, 0x006a}, {0x006b, 0x006b}, {0x006c, 0x006c}, {0x006d, 0x006d}, {0x006e, 0x006e}, {0x006f, 0x006f},
-    {0x0070, 0x0070}, {0x0071, 0x0071}, {0x0072, 0x0072}, {0x0073, 0x0073}, {0x0074, 0x0074}, {0x0075, 0x0075}, {0x0076, 0x0076}, {0x0077, 0x0077},
-    {0x0078, 0x0078}, {0x0079, 0x0079}, {0x007a, 0x007a}, {0x007b, 0x007b}, {0x007c, 0x007c}, {0x007d, 0x007d}, {0x007e, 0x007e}, {0x007f, 0x007f}};
-
-#endif  // __FONTEN16_H__
\ No newline at end of file
@@ -116,6 +116,7 @@ static SAMPLE_ENTRY_PARAM_T g_entry_param = {
     .bRtspEnable = AX_TRUE,
     .nVencRcChangePolicy = 0, // 0: change bitrate, 1: change gop
     .nMaxRecordFileCount = MAX_RECORD_FILE_COUNT,
+    .bRecordSegRing = AX_FALSE,
     .nGopInAov = 10,
     .nSwitchSnsId = 1,
     .bAutoZoomLoopOn = AX_FALSE,
@@ -3051,7 +3052,8 @@ static AX_S32 QSDemoRun(SAMPLE_ENTRY_PARAM_T *pEntryParam)
     QS_MonitorSDCardStart();
     ALOGD("sd card monitor started");
 
-    QS_VideoRecorderInit(pEntryParam->nCamCnt, 4*1024*1024, 32 * 1024, pEntryParam->nMaxRecordFileCount);
+    QS_VideoRecorderInit(pEntryParam->nCamCnt, 4*1024*1024, 32 * 1024, pEntryParam->nMaxRecordFileCount,
+                         pEntryParam->bRecordSegRing);
     ALOGD("video recorder init done");
 
     g_stResultTimes.u64CamOpenLastPts = u64LastPts;
@@ -3428,6 +3430,10 @@ AX_VOID PrintHelp()
 
     printf("\n\t-s(optional): venc gop in aov\n");
     printf("\t\t10: default)\n");
+
+    printf("\n\t-x(optional): record to preallocated segment files which are reused in loop\n");
+    printf("\t\t0: disable(default)\n");
+    printf("\t\t1: enable\n");
 }
 
 int main(int argc, char *argv[])
@@ -3443,7 +3449,7 @@ int main(int argc, char *argv[])
     signal(SIGINT, SigInt);
     signal(SIGTSTP, SigStop);
 
-    while ((c = getopt(argc, argv, "a:b:c:d:e:f:g:i:j:k:l:m:n:o:p:q:r:s:t:u:v:w:h")) != -1) {
+    while ((c = getopt(argc, argv, "a:b:c:d:e:f:g:i:j:k:l:m:n:o:p:q:r:s:t:u:v:w:x:h")) != -1) {
         isExit = 0;
         switch (c) {
         case 'a':
@@ -3584,6 +3590,9 @@ int main(int argc, char *argv[])
         case 'w':
             g_entry_param.nAeManualShutter = (AX_S32)atoi(optarg);
             break;
+        case 'x':
+            g_entry_param.bRecordSegRing = (atoi(optarg) == 1) ? AX_TRUE : AX_FALSE;
+            break;
         case 'h':
         default:
             isExit = 1;
@@ -134,6 +134,7 @@ typedef struct {
     AX_BOOL bStoreAudioInAov;
     AX_S32 nVencRcChangePolicy;
     AX_S32 nMaxRecordFileCount;
+    AX_BOOL bRecordSegRing;
     AX_S32 nGopInAov;
     AX_S32 nSwitchSnsId;
     AX_BOOL bAutoZoomLoopOn;
@@ -0,0 +1,714 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  /* O_DIRECT */
+#endif
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/prctl.h>
+#include <sys/uio.h>
+#include "qs_file_writer.h"
+#include "qs_log.h"
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define QS_WRITER_URING_SUPPORT
+#endif
+#endif
+#endif
+
+#define QS_WRITER_ALIGN             (4096)
+#define QS_WRITER_MIN_BUF_COUNT     (2)
+#define QS_WRITER_MAX_BUF_COUNT     (16)
+#define QS_WRITER_ALIGN_UP(x)       (((x) + QS_WRITER_ALIGN - 1) & ~(QS_WRITER_ALIGN - 1))
+#define QS_WRITER_ALIGN_DOWN(x)     ((x) & ~(QS_WRITER_ALIGN - 1))
+
+typedef enum {
+    QS_WRITE_BUF_FREE = 0,
+    QS_WRITE_BUF_FILL,
+    QS_WRITE_BUF_BUSY
+} QS_WRITE_BUF_STATE_E;
+
+typedef struct _QS_WRITE_BUF {
+    AX_U8  *pData;
+    AX_U32  nLen;
+    AX_U64  nOffset;
+    struct iovec tIov;
+    QS_WRITE_BUF_STATE_E eState;
+} QS_WRITE_BUF_T;
+
+#ifdef QS_WRITER_URING_SUPPORT
+typedef struct _QS_URING {
+    AX_S32  nFd;
+    AX_U32 *pSqTail;
+    AX_U32 *pSqMask;
+    AX_U32 *pSqArray;
+    AX_U32 *pCqHead;
+    AX_U32 *pCqTail;
+    AX_U32 *pCqMask;
+    struct io_uring_sqe *pSqes;
+    struct io_uring_cqe *pCqes;
+    AX_VOID *pSqRing;
+    AX_VOID *pCqRing;
+    size_t  nSqRingSize;
+    size_t  nCqRingSize;
+    size_t  nSqesSize;
+} QS_URING_T;
+#endif
+
+typedef struct _QS_FILE_WRITER {
+    QS_FILE_WRITER_ATTR_T tAttr;
+    QS_WRITE_BUF_T arrBuf[QS_WRITER_MAX_BUF_COUNT];
+    QS_WRITE_BUF_T *pFill;      /* buffer being filled by Write */
+    AX_S32  nFd;
+    AX_S32  nTailFd;            /* buffered fd to write the unaligned tail if file is opened with O_DIRECT */
+    AX_BOOL bDirect;
+    AX_U64  nOffset;            /* file offset of next submitted buffer */
+    AX_U32  nPending;
+    AX_S32  nError;             /* first io errno of current file */
+    QS_FILE_WRITER_STAT_T tStat;
+
+    /* pwrite thread engine */
+    pthread_mutex_t mtx;
+    pthread_cond_t  cvIo;
+    pthread_cond_t  cvDone;
+    pthread_t tid;
+    AX_BOOL bExit;
+    AX_U32  arrQueue[QS_WRITER_MAX_BUF_COUNT];
+    AX_U32  nQueueHead;
+    AX_U32  nQueueCount;
+
+    /* io_uring engine */
+    AX_BOOL bUring;
+#ifdef QS_WRITER_URING_SUPPORT
+    QS_URING_T tRing;
+#endif
+} QS_FILE_WRITER_T;
+
+static AX_VOID QS_WriterSetError(QS_FILE_WRITER_T *pWriter, AX_S32 nErr) {
+    AX_S32 nExpected = 0;
+    __atomic_compare_exchange_n(&pWriter->nError, &nExpected, nErr, AX_FALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+static AX_S32 QS_WriterGetError(QS_FILE_WRITER_T *pWriter) {
+    return __atomic_load_n(&pWriter->nError, __ATOMIC_RELAXED);
+}
+
+static AX_S32 QS_WriterPwrite(QS_FILE_WRITER_T *pWriter, AX_S32 nFd, const AX_U8 *pData, AX_U32 nLen, AX_U64 nOffset) {
+    while (nLen > 0) {
+        ssize_t nRet = pwrite(nFd, pData, nLen, (off_t)nOffset);
+        __atomic_fetch_add(&pWriter->tStat.nSyscalls, 1, __ATOMIC_RELAXED);
+        if (nRet < 0 && errno == EINTR) {
+            continue;
+        }
+        if (nRet <= 0) {
+            return (nRet < 0) ? errno : ENOSPC;
+        }
+
+        __atomic_fetch_add(&pWriter->tStat.nBytes, (AX_U64)nRet, __ATOMIC_RELAXED);
+        pData += nRet;
+        nLen -= (AX_U32)nRet;
+        nOffset += (AX_U64)nRet;
+    }
+
+    return 0;
+}
+
+static AX_VOID QS_WriterNotePending(QS_FILE_WRITER_T *pWriter) {
+    pWriter->nPending++;
+    if (pWriter->nPending > pWriter->tStat.nMaxPending) {
+        pWriter->tStat.nMaxPending = pWriter->nPending;
+    }
+}
+
+#ifdef QS_WRITER_URING_SUPPORT
+static AX_S32 QS_UringEnter(AX_S32 nFd, AX_U32 nSubmit, AX_U32 nWait, AX_U32 nFlags) {
+    return (AX_S32)syscall(__NR_io_uring_enter, nFd, nSubmit, nWait, nFlags, NULL, 0);
+}
+
+static AX_VOID QS_UringTeardown(QS_URING_T *pRing) {
+    if (pRing->pSqes && pRing->pSqes != MAP_FAILED) {
+        munmap(pRing->pSqes, pRing->nSqesSize);
+    }
+    if (pRing->pCqRing && pRing->pCqRing != MAP_FAILED && pRing->pCqRing != pRing->pSqRing) {
+        munmap(pRing->pCqRing, pRing->nCqRingSize);
+    }
+    if (pRing->pSqRing && pRing->pSqRing != MAP_FAILED) {
+        munmap(pRing->pSqRing, pRing->nSqRingSize);
+    }
+    if (pRing->nFd >= 0) {
+        close(pRing->nFd);
+    }
+    memset(pRing, 0, sizeof(QS_URING_T));
+    pRing->nFd = -1;
+}
+
+static AX_S32 QS_UringSetup(QS_URING_T *pRing, AX_U32 nEntries) {
+    struct io_uring_params tParams;
+    AX_BOOL bSingleMmap = AX_FALSE;
+
+    memset(pRing, 0, sizeof(QS_URING_T));
+    memset(&tParams, 0, sizeof(tParams));
+
+    pRing->nFd = (AX_S32)syscall(__NR_io_uring_setup, nEntries, &tParams);
+    if (pRing->nFd < 0) {
+        return -1;
+    }
+
+    pRing->nSqRingSize = tParams.sq_off.array + tParams.sq_entries * sizeof(AX_U32);
+    pRing->nCqRingSize = tParams.cq_off.cqes + tParams.cq_entries * sizeof(struct io_uring_cqe);
+    pRing->nSqesSize = tParams.sq_entries * sizeof(struct io_uring_sqe);
+#ifdef IORING_FEAT_SINGLE_MMAP
+    if (tParams.features & IORING_FEAT_SINGLE_MMAP) {
+        bSingleMmap = AX_TRUE;
+        if (pRing->nCqRingSize > pRing->nSqRingSize) {
+            pRing->nSqRingSize = pRing->nCqRingSize;
+        }
+        pRing->nCqRingSize = pRing->nSqRingSize;
+    }
+#endif
+
+    pRing->pSqRing = mmap(NULL, pRing->nSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pRing->nFd,
+                          IORING_OFF_SQ_RING);
+    if (pRing->pSqRing == MAP_FAILED) {
+        QS_UringTeardown(pRing);
+        return -1;
+    }
+
+    if (bSingleMmap) {
+        pRing->pCqRing = pRing->pSqRing;
+    } else {
+        pRing->pCqRing = mmap(NULL, pRing->nCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, pRing->nFd,
+                              IORING_OFF_CQ_RING);
+        if (pRing->pCqRing == MAP_FAILED) {
+            QS_UringTeardown(pRing);
+            return -1;
+        }
+    }
+
+    pRing->pSqes = (struct io_uring_sqe *)mmap(NULL, pRing->nSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                               pRing->nFd, IORING_OFF_SQES);
+    if (pRing->pSqes == MAP_FAILED) {
+        QS_UringTeardown(pRing);
+        return -1;
+    }
+
+    pRing->pSqTail = (AX_U32 *)((AX_U8 *)pRing->pSqRing + tParams.sq_off.tail);
+    pRing->pSqMask = (AX_U32 *)((AX_U8 *)pRing->pSqRing + tParams.sq_off.ring_mask);
+    pRing->pSqArray = (AX_U32 *)((AX_U8 *)pRing->pSqRing + tParams.sq_off.array);
+    pRing->pCqHead = (AX_U32 *)((AX_U8 *)pRing->pCqRing + tParams.cq_off.head);
+    pRing->pCqTail = (AX_U32 *)((AX_U8 *)pRing->pCqRing + tParams.cq_off.tail);
+    pRing->pCqMask = (AX_U32 *)((AX_U8 *)pRing->pCqRing + tParams.cq_off.ring_mask);
+    pRing->pCqes = (struct io_uring_cqe *)((AX_U8 *)pRing->pCqRing + tParams.cq_off.cqes);
+
+    return 0;
+}
+
+static AX_VOID QS_UringComplete(QS_FILE_WRITER_T *pWriter, AX_U32 nIdx, AX_S32 nRes) {
+    QS_WRITE_BUF_T *pBuf = &pWriter->arrBuf[nIdx];
+
+    if (nRes < 0) {
+        QS_WriterSetError(pWriter, -nRes);
+    } else {
+        __atomic_fetch_add(&pWriter->tStat.nBytes, (AX_U64)nRes, __ATOMIC_RELAXED);
+        if ((AX_U32)nRes < pBuf->nLen) {
+            /* short write, finish it synchronously */
+            AX_S32 nErr = QS_WriterPwrite(pWriter, pWriter->nFd, pBuf->pData + nRes, pBuf->nLen - nRes, pBuf->nOffset + nRes);
+            if (nErr != 0) {
+                QS_WriterSetError(pWriter, nErr);
+            }
+        }
+    }
+
+    pBuf->eState = QS_WRITE_BUF_FREE;
+    pBuf->nLen = 0;
+    pWriter->nPending--;
+}
+
+static AX_S32 QS_UringReap(QS_FILE_WRITER_T *pWriter, AX_BOOL bWait) {
+    QS_URING_T *pRing = &pWriter->tRing;
+
+    while (1) {
+        AX_U32 nHead = *pRing->pCqHead;
+        if (nHead != __atomic_load_n(pRing->pCqTail, __ATOMIC_ACQUIRE)) {
+            struct io_uring_cqe *pCqe = &pRing->pCqes[nHead & *pRing->pCqMask];
+            AX_U32 nIdx = (AX_U32)pCqe->user_data;
+            AX_S32 nRes = pCqe->res;
+            __atomic_store_n(pRing->pCqHead, nHead + 1, __ATOMIC_RELEASE);
+
+            QS_UringComplete(pWriter, nIdx, nRes);
+            bWait = AX_FALSE;
+            continue;
+        }
+
+        if (!bWait || 0 == pWriter->nPending) {
+            return 0;
+        }
+
+        __atomic_fetch_add(&pWriter->tStat.nSyscalls, 1, __ATOMIC_RELAXED);
+        if (QS_UringEnter(pRing->nFd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+            QS_WriterSetError(pWriter, errno);
+            return -1;
+        }
+    }
+}
+
+static AX_S32 QS_UringSubmit(QS_FILE_WRITER_T *pWriter, AX_U32 nIdx) {
+    QS_URING_T *pRing = &pWriter->tRing;
+    QS_WRITE_BUF_T *pBuf = &pWriter->arrBuf[nIdx];
+    AX_U32 nTail = *pRing->pSqTail;
+    AX_U32 nSqIdx = nTail & *pRing->pSqMask;
+    struct io_uring_sqe *pSqe = &pRing->pSqes[nSqIdx];
+
+    pBuf->tIov.iov_base = pBuf->pData;
+    pBuf->tIov.iov_len = pBuf->nLen;
+
+    /* ring has as many entries as buffers, so a sqe is always free here */
+    memset(pSqe, 0, sizeof(struct io_uring_sqe));
+    pSqe->opcode = IORING_OP_WRITEV;
+    pSqe->fd = pWriter->nFd;
+    pSqe->addr = (AX_U64)(unsigned long)&pBuf->tIov;
+    pSqe->len = 1;
+    pSqe->off = pBuf->nOffset;
+    pSqe->user_data = nIdx;
+    pRing->pSqArray[nSqIdx] = nSqIdx;
+    __atomic_store_n(pRing->pSqTail, nTail + 1, __ATOMIC_RELEASE);
+
+    while (1) {
+        __atomic_fetch_add(&pWriter->tStat.nSyscalls, 1, __ATOMIC_RELAXED);
+        if (QS_UringEnter(pRing->nFd, 1, 0, 0) >= 0) {
+            return 0;
+        }
+        if (errno == EAGAIN || errno == EBUSY) {
+            /* kernel is short of resources, give back completions first */
+            QS_UringReap(pWriter, AX_TRUE);
+        } else if (errno != EINTR) {
+            QS_WriterSetError(pWriter, errno);
+            return -1;
+        }
+    }
+}
+#endif
+
+static AX_VOID *QS_WriterThreadFunc(AX_VOID *param) {
+    QS_FILE_WRITER_T *pWriter = (QS_FILE_WRITER_T *)param;
+
+    prctl(PR_SET_NAME, "qs_writer");
+
+    pthread_mutex_lock(&pWriter->mtx);
+    while (1) {
+        while (!pWriter->bExit && 0 == pWriter->nQueueCount) {
+            pthread_cond_wait(&pWriter->cvIo, &pWriter->mtx);
+        }
+
+        if (0 == pWriter->nQueueCount) {
+            break;
+        }
+
+        QS_WRITE_BUF_T *pBuf = &pWriter->arrBuf[pWriter->arrQueue[pWriter->nQueueHead]];
+        pWriter->nQueueHead = (pWriter->nQueueHead + 1) % pWriter->tAttr.nBufCount;
+        pWriter->nQueueCount--;
+        pthread_mutex_unlock(&pWriter->mtx);
+
+        AX_S32 nErr = QS_WriterPwrite(pWriter, pWriter->nFd, pBuf->pData, pBuf->nLen, pBuf->nOffset);
+
+        pthread_mutex_lock(&pWriter->mtx);
+        if (nErr != 0) {
+            QS_WriterSetError(pWriter, nErr);
+        }
+        pBuf->eState = QS_WRITE_BUF_FREE;
+        pBuf->nLen = 0;
+        pWriter->nPending--;
+        pthread_cond_broadcast(&pWriter->cvDone);
+    }
+    pthread_mutex_unlock(&pWriter->mtx);
+
+    return NULL;
+}
+
+static AX_S32 QS_WriterSubmit(QS_FILE_WRITER_T *pWriter, QS_WRITE_BUF_T *pBuf) {
+    AX_U32 nIdx = (AX_U32)(pBuf - pWriter->arrBuf);
+
+    pBuf->nOffset = pWriter->nOffset;
+    pWriter->nOffset += pBuf->nLen;
+
+#ifdef QS_WRITER_URING_SUPPORT
+    if (pWriter->bUring) {
+        pBuf->eState = QS_WRITE_BUF_BUSY;
+        QS_WriterNotePending(pWriter);
+        return QS_UringSubmit(pWriter, nIdx);
+    }
+#endif
+
+    pthread_mutex_lock(&pWriter->mtx);
+    pBuf->eState = QS_WRITE_BUF_BUSY;
+    QS_WriterNotePending(pWriter);
+    pWriter->arrQueue[(pWriter->nQueueHead + pWriter->nQueueCount) % pWriter->tAttr.nBufCount] = nIdx;
+    pWriter->nQueueCount++;
+    pthread_cond_signal(&pWriter->cvIo);
+    pthread_mutex_unlock(&pWriter->mtx);
+
+    return 0;
+}
+
+static QS_WRITE_BUF_T *QS_WriterFindFree(QS_FILE_WRITER_T *pWriter) {
+    AX_U32 i = 0;
+    for (i = 0; i < pWriter->tAttr.nBufCount; i++) {
+        if (QS_WRITE_BUF_FREE == pWriter->arrBuf[i].eState) {
+            pWriter->arrBuf[i].eState = QS_WRITE_BUF_FILL;
+            pWriter->arrBuf[i].nLen = 0;
+            return &pWriter->arrBuf[i];
+        }
+    }
+
+    return NULL;
+}
+
+static QS_WRITE_BUF_T *QS_WriterGetFree(QS_FILE_WRITER_T *pWriter) {
+    QS_WRITE_BUF_T *pBuf = NULL;
+
+#ifdef QS_WRITER_URING_SUPPORT
+    if (pWriter->bUring) {
+        QS_UringReap(pWriter, AX_FALSE);
+        pBuf = QS_WriterFindFree(pWriter);
+        if (!pBuf) {
+            pWriter->tStat.nStalls++;
+            while (!pBuf && pWriter->nPending > 0) {
+                if (QS_UringReap(pWriter, AX_TRUE) != 0) {
+                    break;
+                }
+                pBuf = QS_WriterFindFree(pWriter);
+            }
+        }
+        return pBuf;
+    }
+#endif
+
+    pthread_mutex_lock(&pWriter->mtx);
+    pBuf = QS_WriterFindFree(pWriter);
+    if (!pBuf) {
+        pWriter->tStat.nStalls++;
+        do {
+            pthread_cond_wait(&pWriter->cvDone, &pWriter->mtx);
+            pBuf = QS_WriterFindFree(pWriter);
+        } while (!pBuf);
+    }
+    pthread_mutex_unlock(&pWriter->mtx);
+
+    return pBuf;
+}
+
+static AX_VOID QS_WriterDrain(QS_FILE_WRITER_T *pWriter) {
+#ifdef QS_WRITER_URING_SUPPORT
+    if (pWriter->bUring) {
+        while (pWriter->nPending > 0) {
+            if (QS_UringReap(pWriter, AX_TRUE) != 0) {
+                break;
+            }
+        }
+        return;
+    }
+#endif
+
+    pthread_mutex_lock(&pWriter->mtx);
+    while (pWriter->nPending > 0) {
+        pthread_cond_wait(&pWriter->cvDone, &pWriter->mtx);
+    }
+    pthread_mutex_unlock(&pWriter->mtx);
+}
+
+QS_FILE_WRITER_HANDLE QS_FileWriterCreate(const QS_FILE_WRITER_ATTR_T *pAttr) {
+    AX_U32 i = 0;
+
+    if (!pAttr || 0 == pAttr->nBufSize) {
+        return NULL;
+    }
+
+    QS_FILE_WRITER_T *pWriter = (QS_FILE_WRITER_T *)malloc(sizeof(QS_FILE_WRITER_T));
+    if (!pWriter) {
+        return NULL;
+    }
+
+    memset(pWriter, 0, sizeof(QS_FILE_WRITER_T));
+    pWriter->tAttr = *pAttr;
+    pWriter->tAttr.nBufSize = QS_WRITER_ALIGN_UP(pAttr->nBufSize);
+    if (pWriter->tAttr.nBufCount < QS_WRITER_MIN_BUF_COUNT) {
+        pWriter->tAttr.nBufCount = QS_WRITER_MIN_BUF_COUNT;
+    } else if (pWriter->tAttr.nBufCount > QS_WRITER_MAX_BUF_COUNT) {
+        pWriter->tAttr.nBufCount = QS_WRITER_MAX_BUF_COUNT;
+    }
+    pWriter->nFd = -1;
+    pWriter->nTailFd = -1;
+#ifdef QS_WRITER_URING_SUPPORT
+    pWriter->tRing.nFd = -1;
+#endif
+    pthread_mutex_init(&pWriter->mtx, NULL);
+    pthread_cond_init(&pWriter->cvIo, NULL);
+    pthread_cond_init(&pWriter->cvDone, NULL);
+
+    for (i = 0; i < pWriter->tAttr.nBufCount; i++) {
+        if (posix_memalign((AX_VOID **)&pWriter->arrBuf[i].pData, QS_WRITER_ALIGN, pWriter->tAttr.nBufSize) != 0) {
+            ALOGE("file writer alloc %u bytes failed", pWriter->tAttr.nBufSize);
+            pWriter->arrBuf[i].pData = NULL;
+            QS_FileWriterDestroy(pWriter);
+            return NULL;
+        }
+    }
+
+#ifdef QS_WRITER_URING_SUPPORT
+    if (pWriter->tAttr.bUring) {
+        if (QS_UringSetup(&pWriter->tRing, pWriter->tAttr.nBufCount) == 0) {
+            pWriter->bUring = AX_TRUE;
+        } else {
+            ALOGW("file writer io_uring is not available(%d), use pwrite thread", errno);
+        }
+    }
+#endif
+
+    if (!pWriter->bUring) {
+        if (pthread_create(&pWriter->tid, NULL, QS_WriterThreadFunc, pWriter) != 0) {
+            ALOGE("file writer create thread failed");
+            pWriter->tid = 0;
+            QS_FileWriterDestroy(pWriter);
+            return NULL;
+        }
+    }
+
+    return (QS_FILE_WRITER_HANDLE)pWriter;
+}
+
+AX_VOID QS_FileWriterDestroy(QS_FILE_WRITER_HANDLE hWriter) {
+    QS_FILE_WRITER_T *pWriter = (QS_FILE_WRITER_T *)hWriter;
+    AX_U32 i = 0;
+
+    if (!pWriter) {
+        return;
+    }
+
+    QS_FileWriterClose(hWriter);
+
+    if (pWriter->tid != 0) {
+        pthread_mutex_lock(&pWriter->mtx);
+        pWriter->bExit = AX_TRUE;
+        pthread_cond_signal(&pWriter->cvIo);
+        pthread_mutex_unlock(&pWriter->mtx);
+        pthread_join(pWriter->tid, NULL);
+        pWriter->tid = 0;
+    }
+
+#ifdef QS_WRITER_URING_SUPPORT
+    if (pWriter->bUring) {
+        QS_UringTeardown(&pWriter->tRing);
+    }
+#endif
+
+    for (i = 0; i < pWriter->tAttr.nBufCount; i++) {
+        free(pWriter->arrBuf[i].pData);
+    }
+
+    pthread_mutex_destroy(&pWriter->mtx);
+    pthread_cond_destroy(&pWriter->cvIo);
+    pthread_cond_destroy(&pWriter->cvDone);
+    free(pWriter);
+}
+
+AX_S32 QS_FileWriterOpen(QS_FILE_WRITER_HANDLE hWriter, const AX_CHAR *szPath, AX_BOOL bKeepSize) {
+    QS_FILE_WRITER_T *pWriter = (QS_FILE_WRITER_T *)hWriter;
+    AX_S32 nFlags = O_WRONLY | O_CREAT | O_CLOEXEC | (bKeepSize ? 0 : O_TRUNC);
+
+    if (!pWriter || !szPath) {
+        return -1;
+    }
+
+    QS_FileWriterClose(hWriter);
+
+    pWriter->bDirect = AX_FALSE;
+    if (pWriter->tAttr.bDirect) {
+        pWriter->nFd = open(szPath, nFlags | O_DIRECT, 0644);
+        if (pWriter->nFd >= 0) {
+            pWriter->nTailFd = open(szPath, O_WRONLY | O_CLOEXEC);
+            if (pWriter->nTailFd >= 0) {
+                pWriter->bDirect = AX_TRUE;
+            } else {
+                close(pWriter->nFd);
+                pWriter->nFd = -1;
+            }
+        }
+    }
+
+    if (!pWriter->bDirect) {
+        pWriter->nFd = open(szPath, nFlags, 0644);
+        if (pWriter->nFd < 0) {
+            return -1;
+        }
+    }
+
+    pWriter->nOffset = 0;
+    pWriter->nError = 0;
+
+    return 0;
+}
+
+AX_S32 QS_FileWriterWrite(QS_FILE_WRITER_HANDLE hWriter, const AX_VOID *pData, AX_U32 nLen) {
+    QS_FILE_WRITER_T *pWriter = (QS_FILE_WRITER_T *)hWriter;
+    const AX_U8 *pSrc = (const AX_U8 *)pData;
+
+    if (!pWriter || pWriter->nFd < 0) {
+        return -1;
+    }
+
+    while (nLen > 0) {
+        if (QS_WriterGetError(pWriter) != 0) {
+            return -1;
+        }
+
+        if (!pWriter->pFill) {
+            pWriter->pFill = QS_WriterGetFree(pWriter);
+            if (!pWriter->pFill) {
+                return -1;
+            }
+        }
+
+        QS_WRITE_BUF_T *pBuf = pWriter->pFill;
+        AX_U32 nCopy = pWriter->tAttr.nBufSize - pBuf->nLen;
+        if (nCopy > nLen) {
+            nCopy = nLen;
+        }
+
+        memcpy(pBuf->pData + pBuf->nLen, pSrc, nCopy);
+        pBuf->nLen += nCopy;
+        pSrc += nCopy;
+        nLen -= nCopy;
+
+        if (pBuf->nLen == pWriter->tAttr.nBufSize) {
+            pWriter->pFill = NULL;
+            if (QS_WriterSubmit(pWriter, pBuf) != 0) {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+AX_S32 QS_FileWriterFlush(QS_FILE_WRITER_HANDLE hWriter) {
+    QS_FILE_WRITER_T *pWriter = (QS_FILE_WRITER_T *)hWriter;
+
+    if (!pWriter || pWriter->nFd < 0) {
+        return -1;
+    }
+
+    QS_WRITE_BUF_T *pBuf = pWriter->pFill;
+    if (pBuf && pBuf->nLen > 0) {
+        if (!pWriter->bDirect) {
+            pWriter->pFill = NULL;
+            QS_WriterSubmit(pWriter, pBuf);
+        } else if (pBuf->nLen >= QS_WRITER_ALIGN) {
+            /* O_DIRECT only takes aligned blocks, carry the remainder into a new buffer */
+            AX_U32 nAligned = QS_WRITER_ALIGN_DOWN(pBuf->nLen);
+            AX_U32 nRemain = pBuf->nLen - nAligned;
+            QS_WRITE_BUF_T *pNext = NULL;
+
+            if (nRemain > 0) {
+                pNext = QS_WriterGetFree(pWriter);
+                if (!pNext) {
+                    return -1;
+                }
+                memcpy(pNext->pData, pBuf->pData + nAligned, nRemain);
+                pNext->nLen = nRemain;
+            }
+
+            pBuf->nLen = nAligned;
+            pWriter->pFill = pNext;
+            QS_WriterSubmit(pWriter, pBuf);
+        }
+    }
+
+    QS_WriterDrain(pWriter);
+
+    /* unaligned tail of O_DIRECT file goes through page cache and stays buffered,
+       it is written again with the following data once its block is full */
+    pBuf = pWriter->pFill;
+    if (pBuf && pBuf->nLen > 0 && 0 == QS_WriterGetError(pWriter)) {
+        AX_S32 nErr = QS_WriterPwrite(pWriter, pWriter->nTailFd, pBuf->pData, pBuf->nLen, pWriter->nOffset);
+        if (nErr != 0) {
+            QS_WriterSetError(pWriter, nErr);
+        }
+    }
+
+    return (0 == QS_WriterGetError(pWriter)) ? 0 : -1;
+}
+
+AX_S32 QS_FileWriterClose(QS_FILE_WRITER_HANDLE hWriter) {
+    QS_FILE_WRITER_T *pWriter = (QS_FILE_WRITER_T *)hWriter;
+    AX_S32 nRet = 0;
+
+    if (!pWriter || pWriter->nFd < 0) {
+        return 0;
+    }
+
+    nRet = QS_FileWriterFlush(hWriter);
+    if (nRet != 0) {
+        ALOGE("file writer close with io error %d", QS_WriterGetError(pWriter));
+        /* wait submitted buffers anyway before their fd is closed */
+        QS_WriterDrain(pWriter);
+    }
+
+    if (pWriter->pFill) {
+        pWriter->pFill->eState = QS_WRITE_BUF_FREE;
+        pWriter->pFill->nLen = 0;
+        pWriter->pFill = NULL;
+    }
+
+    close(pWriter->nFd);
+    pWriter->nFd = -1;
+    if (pWriter->nTailFd >= 0) {
+        close(pWriter->nTailFd);
+        pWriter->nTailFd = -1;
+    }
+
+    return nRet;
+}
+
+AX_BOOL QS_FileWriterIsOpened(QS_FILE_WRITER_HANDLE hWriter) {
+    QS_FILE_WRITER_T *pWriter = (QS_FILE_WRITER_T *)hWriter;
+    return (pWriter && pWriter->nFd >= 0) ? AX_TRUE : AX_FALSE;
+}
+
+AX_VOID QS_FileWriterGetStat(QS_FILE_WRITER_HANDLE hWriter, QS_FILE_WRITER_STAT_T *pStat) {
+    QS_FILE_WRITER_T *pWriter = (QS_FILE_WRITER_T *)hWriter;
+
+    if (!pWriter || !pStat) {
+        return;
+    }
+
+    pthread_mutex_lock(&pWriter->mtx);
+    pStat->nBytes = __atomic_load_n(&pWriter->tStat.nBytes, __ATOMIC_RELAXED);
+    pStat->nSyscalls = __atomic_load_n(&pWriter->tStat.nSyscalls, __ATOMIC_RELAXED);
+    pStat->nMaxPending = pWriter->tStat.nMaxPending;
+    pStat->nStalls = pWriter->tStat.nStalls;
+    pthread_mutex_unlock(&pWriter->mtx);
+}
+
+const AX_CHAR* QS_FileWriterGetEngine(QS_FILE_WRITER_HANDLE hWriter) {
+    QS_FILE_WRITER_T *pWriter = (QS_FILE_WRITER_T *)hWriter;
+
+    if (!pWriter) {
+        return "none";
+    }
+
+    return pWriter->bUring ? "io_uring" : "pwrite thread";
+}
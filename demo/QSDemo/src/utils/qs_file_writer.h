@@ -0,0 +1,51 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _QSFILEWRITER_H__
+#define _QSFILEWRITER_H__
+
+#include "ax_global_type.h"
+
+/*
+    Aggregates small writes into large page aligned buffers and writes full buffers asynchronously,
+    by io_uring if kernel supports it, otherwise by a dedicated pwrite thread.
+    All functions of one writer must be called from the same thread.
+*/
+typedef AX_VOID* QS_FILE_WRITER_HANDLE;
+
+typedef struct _QS_FILE_WRITER_ATTR {
+    AX_U32  nBufSize;   /* bytes of each buffer, rounded up to 4KB */
+    AX_U32  nBufCount;  /* buffers owned by writer, at least 2 */
+    AX_BOOL bDirect;    /* open file with O_DIRECT, buffered io is used if file system refuses */
+    AX_BOOL bUring;     /* submit with io_uring, pwrite thread is used if kernel refuses */
+} QS_FILE_WRITER_ATTR_T;
+
+typedef struct _QS_FILE_WRITER_STAT {
+    AX_U64 nBytes;      /* bytes written to files */
+    AX_U64 nSyscalls;   /* pwrite and io_uring_enter calls */
+    AX_U32 nMaxPending; /* most buffers submitted and not completed */
+    AX_U32 nStalls;     /* times of write waiting for a free buffer */
+} QS_FILE_WRITER_STAT_T;
+
+QS_FILE_WRITER_HANDLE QS_FileWriterCreate(const QS_FILE_WRITER_ATTR_T *pAttr);
+AX_VOID QS_FileWriterDestroy(QS_FILE_WRITER_HANDLE hWriter);
+
+/* bKeepSize: file is preallocated, it is overwritten from head and its size is not truncated */
+AX_S32  QS_FileWriterOpen(QS_FILE_WRITER_HANDLE hWriter, const AX_CHAR *szPath, AX_BOOL bKeepSize);
+AX_S32  QS_FileWriterWrite(QS_FILE_WRITER_HANDLE hWriter, const AX_VOID *pData, AX_U32 nLen);
+/* write out buffered data and wait all io done, file stays opened */
+AX_S32  QS_FileWriterFlush(QS_FILE_WRITER_HANDLE hWriter);
+AX_S32  QS_FileWriterClose(QS_FILE_WRITER_HANDLE hWriter);
+AX_BOOL QS_FileWriterIsOpened(QS_FILE_WRITER_HANDLE hWriter);
+
+AX_VOID QS_FileWriterGetStat(QS_FILE_WRITER_HANDLE hWriter, QS_FILE_WRITER_STAT_T *pStat);
+const AX_CHAR* QS_FileWriterGetEngine(QS_FILE_WRITER_HANDLE hWriter);
+
+#endif //_QSFILEWRITER_H__
@@ -15,8 +15,11 @@
 #include <stdlib.h>
 #include <dirent.h>
 #include <pthread.h>
+#include <time.h>
 #include "qs_recorder.h"
 #include "qs_utils.h"
+#include "qs_file_writer.h"
+#include "qs_segment_ring.h"
 #include "AXRingFifo.h"
 #include "ax_sys_api.h"
 #include "audio_config.h"
@@ -25,8 +28,28 @@
 #define MAX_RECORD_SNS_COUNT   (2)
 #define MAX_PATH               (256)
 
+#define RECORD_VIDEO_WRITE_BUF_SIZE  (512*1024)
+#define RECORD_AUDIO_WRITE_BUF_SIZE  (32*1024)
+#define RECORD_WRITE_BUF_COUNT       (4)
+/* record thread is woken by producer once fifo holds 1/RECORD_WAKE_DIVISOR of its capacity */
+#define RECORD_WAKE_DIVISOR          (4)
+/* record thread is also woken on sd card state change and stop, timeout is only a safety net */
+#define RECORD_WAIT_TIMEOUT_MS       (5000)
+#define RECORD_FLUSH_WAIT_MS         (100)
+/* segment ring: an I frame starts next segment once current one has less room than headroom */
+#define RECORD_SEG_HEADROOM          (8*1024*1024)
+#define RECORD_SEG_AUDIO_SIZE        (g_nMaxFileSize / 8)
+/* valid size of current segment is persisted to index each time it grows by this */
+#define RECORD_SEG_SYNC_SIZE         (4*1024*1024)
+#if defined(QSDEMO_RECORD_DIRECT_IO)
+#define RECORD_DIRECT_IO             AX_TRUE
+#else
+#define RECORD_DIRECT_IO             AX_FALSE
+#endif
+
 static const AX_S32 g_nMaxFileSize = 100*1024*1024;
 static AX_S32 g_nMaxRecodFileCount = MAX_RECORD_FILE_COUNT;
+static AX_BOOL g_bSegmentRing = AX_FALSE;
 
 static AX_S32 g_nCamCount = 1;
 AX_BOOL g_bWorking = AX_FALSE;
@@ -52,6 +75,23 @@ typedef struct _RECODER_FILE_INFO {
     AX_S32   nCamID;
     AX_RINGFIFO_HANDLE hVideoFifo;
     AX_RINGFIFO_HANDLE hAudioFifo;
+    QS_FILE_WRITER_HANDLE hVideoWriter;
+    QS_FILE_WRITER_HANDLE hAudioWriter;
+    QS_SEG_RING_HANDLE hSegRing;
+    AX_U64   nSegStartPts;
+    AX_U64   nSegEndPts;
+    AX_U32   nSegSyncSize;      /* video size persisted to segment index */
+    AX_U32   nVideoWakeSize;
+    AX_U32   nAudioWakeSize;
+    AX_U32   nVideoFifoPeak;
+    AX_U32   nAudioFifoPeak;
+    pthread_mutex_t mtxWake;
+    pthread_cond_t  cvWake;     /* producer, sd monitor and stop -> record thread */
+    pthread_cond_t  cvFlushed;  /* record thread -> flushing producer */
+    AX_BOOL  bWakeup;
+    AX_U32   nFlushSeq;         /* last flush requested by producer */
+    AX_U32   nFlushDone;        /* last flush finished by record thread */
+    AX_BOOL  bSyncInited;
     pthread_t tid;
 }RECODER_FILE_INFO_T;
 
@@ -61,6 +101,87 @@ int compare(const void* a, const void* b) {
     return strcmp((AX_CHAR*)a, (AX_CHAR*)b);
 }
 
+static AX_VOID QS_RecorderDeadline(struct timespec *pTs, AX_U32 nTimeoutMs) {
+    clock_gettime(CLOCK_MONOTONIC, pTs);
+    pTs->tv_sec += nTimeoutMs / 1000;
+    pTs->tv_nsec += (nTimeoutMs % 1000) * 1000000;
+    if (pTs->tv_nsec >= 1000000000) {
+        pTs->tv_sec++;
+        pTs->tv_nsec -= 1000000000;
+    }
+}
+
+static AX_VOID QS_RecorderWakeup(RECODER_FILE_INFO_T *pRecFileInfo) {
+    pthread_mutex_lock(&pRecFileInfo->mtxWake);
+    pRecFileInfo->bWakeup = AX_TRUE;
+    pthread_cond_signal(&pRecFileInfo->cvWake);
+    pthread_mutex_unlock(&pRecFileInfo->mtxWake);
+}
+
+static AX_VOID QS_RecorderWakeupAll() {
+    AX_S32 i = 0;
+    for (i = 0; i < g_nCamCount; i++) {
+        if (g_videoRecordFile[i].bSyncInited) {
+            QS_RecorderWakeup(&g_videoRecordFile[i]);
+        }
+    }
+}
+
+/* sleep until producer fills fifo to wakeup size, asks a flush, sd card state changes or recorder stops */
+static AX_VOID QS_RecorderWait(RECODER_FILE_INFO_T *pRecFileInfo) {
+    struct timespec ts;
+    QS_RecorderDeadline(&ts, RECORD_WAIT_TIMEOUT_MS);
+
+    pthread_mutex_lock(&pRecFileInfo->mtxWake);
+    while (!pRecFileInfo->bWakeup && g_bWorking) {
+        if (pthread_cond_timedwait(&pRecFileInfo->cvWake, &pRecFileInfo->mtxWake, &ts) == ETIMEDOUT) {
+            break;
+        }
+    }
+    pRecFileInfo->bWakeup = AX_FALSE;
+    pthread_mutex_unlock(&pRecFileInfo->mtxWake);
+}
+
+static AX_U32 QS_RecorderGetFlushSeq(RECODER_FILE_INFO_T *pRecFileInfo) {
+    AX_U32 nSeq = 0;
+    pthread_mutex_lock(&pRecFileInfo->mtxWake);
+    nSeq = pRecFileInfo->nFlushSeq;
+    pthread_mutex_unlock(&pRecFileInfo->mtxWake);
+    return nSeq;
+}
+
+static AX_VOID QS_RecorderFlushDone(RECODER_FILE_INFO_T *pRecFileInfo, AX_U32 nSeq) {
+    pthread_mutex_lock(&pRecFileInfo->mtxWake);
+    pRecFileInfo->nFlushDone = nSeq;
+    pthread_cond_broadcast(&pRecFileInfo->cvFlushed);
+    pthread_mutex_unlock(&pRecFileInfo->mtxWake);
+}
+
+/* called by producer after a frame is put to fifo */
+static AX_VOID QS_RecorderOnPut(RECODER_FILE_INFO_T *pRecFileInfo, AX_RINGFIFO_HANDLE hFifo, AX_U32 nWakeSize, AX_U32 *pFifoPeak,
+                                AX_BOOL bFlush) {
+    AX_U32 nSize = AX_RingFifo_Size(hFifo);
+    if (nSize > *pFifoPeak) {
+        *pFifoPeak = nSize;
+    }
+
+    if (bFlush) {
+        /* frames put before this ticket are written to file once the record thread reports it done */
+        struct timespec ts;
+        pthread_mutex_lock(&pRecFileInfo->mtxWake);
+        AX_U32 nTicket = ++pRecFileInfo->nFlushSeq;
+        pRecFileInfo->bWakeup = AX_TRUE;
+        pthread_cond_signal(&pRecFileInfo->cvWake);
+        while ((AX_S32)(pRecFileInfo->nFlushDone - nTicket) < 0 && g_bWorking && QS_IsSDCardReady()) {
+            QS_RecorderDeadline(&ts, RECORD_FLUSH_WAIT_MS);
+            pthread_cond_timedwait(&pRecFileInfo->cvFlushed, &pRecFileInfo->mtxWake, &ts);
+        }
+        pthread_mutex_unlock(&pRecFileInfo->mtxWake);
+    } else if (nSize >= nWakeSize && !__atomic_load_n(&pRecFileInfo->bWakeup, __ATOMIC_RELAXED)) {
+        QS_RecorderWakeup(pRecFileInfo);
+    }
+}
+
 AX_BOOL QS_MountSDCard() {
     FILE * fp;
 #if defined(__LP64__)
@@ -86,52 +207,40 @@ AX_BOOL QS_MountSDCard() {
 
 AX_BOOL QS_CheckSDMounted() {
     // /dev/mmcblk1p1 /mnt vfat rw,relatime,fmask=0022,dmask=0022,codepage=437,iocharset=iso8859-1,shortname=mixed,errors=remount-ro 0 0
-    FILE * fp;
-    fd_set read_fds;
-    struct timeval timeout;
-    int fd = 0;
-    int ret = 0;
-
+    /* scan /proc/mounts directly, it is polled by sd monitor so no shell is forked for it */
+    const AX_CHAR *szDev = NULL;
     AX_CHAR buf[256];
-    memset(buf, 0, sizeof(buf));
+    AX_BOOL bMounted = AX_FALSE;
+
 #if defined(__LP64__)
 #if defined(AX620E_NAND)
-    fp = popen("cat /proc/mounts | grep '/dev/mmcblk0p1 '","r");
+    szDev = "/dev/mmcblk0p1 ";
 #else
-    fp = popen("cat /proc/mounts | grep '/dev/mmcblk1p1 '","r");
+    szDev = "/dev/mmcblk1p1 ";
 #endif
 #else
     AX_BOOL b620Q = IS_AX620Q ? AX_TRUE : AX_FALSE;
     if (b620Q) {
-        fp = popen("cat /proc/mounts | grep '/dev/mmcblk0p1 '","r");
+        szDev = "/dev/mmcblk0p1 ";
     } else {
-        fp = popen("cat /proc/mounts | grep '/dev/mmcblk1p1 '","r");
+        szDev = "/dev/mmcblk1p1 ";
     }
 #endif
-    if(fp == NULL){
+
+    FILE *fp = fopen("/proc/mounts", "r");
+    if (fp == NULL) {
         return AX_FALSE;
     }
 
-    fd = fileno(fp);
-    FD_ZERO(&read_fds);
-    FD_SET(fd, &read_fds);
-
-    timeout.tv_sec = 1;
-    timeout.tv_usec = 0;
-
-    ret = select(fd + 1, &read_fds, NULL, NULL, &timeout);
-    if (ret > 0 && FD_ISSET(fd, &read_fds)) {
-        AX_S32 len = fread(buf, 1, 255, fp);
-        if (len <= 14) {
-            pclose(fp);
-            return AX_FALSE;
+    while (fgets(buf, sizeof(buf), fp)) {
+        if (strncmp(buf, szDev, strlen(szDev)) == 0) {
+            bMounted = AX_TRUE;
+            break;
         }
-        pclose(fp);
-        return AX_TRUE;
-    } else {
-        pclose(fp);
-        return AX_FALSE;
     }
+    fclose(fp);
+
+    return bMounted;
 }
 
 static AX_VOID *monitor_sd_thread_func(AX_VOID *param) {
@@ -170,6 +279,7 @@ static AX_VOID *monitor_sd_thread_func(AX_VOID *param) {
 
                 if (QS_CheckSDMounted()) {
                     g_bSDCardReady = AX_TRUE;
+                    QS_RecorderWakeupAll();
 
                     ALOGI("sd card mounted");
                 } else {
@@ -177,6 +287,7 @@ static AX_VOID *monitor_sd_thread_func(AX_VOID *param) {
                 }
             } else {
                 g_bSDCardReady = AX_FALSE;
+                QS_RecorderWakeupAll();
 
                 if (nLastStatus == -1) {
                     // no sd card
@@ -203,6 +314,7 @@ static AX_VOID *monitor_sd_thread_func(AX_VOID *param) {
 
                 if (QS_CheckSDMounted()) {
                     g_bSDCardReady = AX_TRUE;
+                    QS_RecorderWakeupAll();
 
                     ALOGI("sd card mounted");
                 }
@@ -269,10 +381,8 @@ AX_BOOL QS_CheckDisk(AX_U32 nMinLeftSize) {
 }
 
 AX_BOOL QS_CheckAndSweepDisk(AX_S32 nCamId) {
-    AX_CHAR command[256] = {0};
     AX_S32 i = 0;
     AX_S32 idx = 0;
-    AX_S32 nSize = 0;
     AX_S32 nCurIdx = g_videoRecordFile[nCamId].nCurFileIdx;
     if (nCurIdx > g_nMaxRecodFileCount ) {
         i = nCurIdx - g_nMaxRecodFileCount - 1;
@@ -289,17 +399,13 @@ AX_BOOL QS_CheckAndSweepDisk(AX_S32 nCamId) {
             AX_BOOL bSwept = AX_FALSE;
             idx = i % g_nMaxRecodFileCount;
             if (strlen(g_videoRecordFile[nCamId].szVideoFile[idx])) {
-                nSize = sprintf(command, "rm -f %s", g_videoRecordFile[nCamId].szVideoFile[idx]);
-                command[nSize] = 0;
-                QS_RunCmd(command, NULL, 0);
+                unlink(g_videoRecordFile[nCamId].szVideoFile[idx]);
                 g_videoRecordFile[nCamId].szVideoFile[idx][0] = 0;
                 bSwept = AX_TRUE;
             }
 #ifdef QSDEMO_AUDIO_SUPPORT
             if (strlen(g_videoRecordFile[nCamId].szAudioFile[idx])) {
-                nSize = sprintf(command, "rm -f %s", g_videoRecordFile[nCamId].szAudioFile[idx]);
-                command[nSize] = 0;
-                QS_RunCmd(command, NULL, 0);
+                unlink(g_videoRecordFile[nCamId].szAudioFile[idx]);
                 g_videoRecordFile[nCamId].szAudioFile[idx][0] = 0;
                 bSwept = AX_TRUE;
             }
@@ -335,6 +441,7 @@ AX_BOOL QS_SweepDiskQs(AX_S32 nRunTimes) {
     return AX_TRUE;
 }
 
+/* file rotation without segment ring, lists at most MAX_RECORD_FILE_COUNT files of each kind */
 AX_BOOL QS_ListFile(AX_S32 nCamIdx) {
     DIR *dp;
     struct dirent *dirp;
@@ -447,8 +554,29 @@ AX_BOOL QS_ListFile(AX_S32 nCamIdx) {
     return 0;
 }
 
+#ifdef QSDEMO_AUDIO_SUPPORT
+/* NULL if audio encoder is disabled */
+static const AX_CHAR* QS_GetAudioFileExt() {
+    SAMPLE_AUDIO_ENCODER_INFO_T stEncoderInfo;
+    AX_S32 s32Ret = COMMON_AUDIO_GetEncoderInfo(&stEncoderInfo);
+
+    if (s32Ret || !stEncoderInfo.bEnable) {
+        return NULL;
+    }
+
+    if (stEncoderInfo.ePt == PT_G711A) {
+        return "g711a";
+    } else if (stEncoderInfo.ePt == PT_G711U) {
+        return "g711u";
+    } else if (stEncoderInfo.ePt == PT_AAC) {
+        return "aac";
+    } else {
+        return "pcm";
+    }
+}
+#endif
+
 static AX_U32 QS_GetFileName(AX_S32 nCamIdx) {
-    AX_CHAR command[256] = {0};
     AX_S32 nSize = 0;
     AX_U32 nIdx = g_videoRecordFile[nCamIdx].nCurFileIdx % g_nMaxRecodFileCount;
     time_t t;
@@ -458,9 +586,7 @@ static AX_U32 QS_GetFileName(AX_S32 nCamIdx) {
     localtime_r(&t, &tm);
 
     if (strlen(g_videoRecordFile[nCamIdx].szVideoFile[nIdx]) != 0) {
-        nSize = sprintf(command, "rm -f %s", g_videoRecordFile[nCamIdx].szVideoFile[nIdx]);
-        command[nSize] = 0;
-        QS_RunCmd(command, NULL, 0);
+        unlink(g_videoRecordFile[nCamIdx].szVideoFile[nIdx]);
         ALOGI("sns[%d] delete video file: %s", nCamIdx, g_videoRecordFile[nCamIdx].szVideoFile[nIdx]);
     }
 
@@ -474,30 +600,15 @@ static AX_U32 QS_GetFileName(AX_S32 nCamIdx) {
 
 #ifdef QSDEMO_AUDIO_SUPPORT
     if (strlen(g_videoRecordFile[nCamIdx].szAudioFile[nIdx]) != 0) {
-        nSize = sprintf(command, "rm -f %s", g_videoRecordFile[nCamIdx].szAudioFile[nIdx]);
-        command[nSize] = 0;
-        QS_RunCmd(command, NULL, 0);
+        unlink(g_videoRecordFile[nCamIdx].szAudioFile[nIdx]);
         ALOGI("sns[%d] delete audio file: %s", nCamIdx, g_videoRecordFile[nCamIdx].szAudioFile[nIdx]);
     }
 
     g_videoRecordFile[nCamIdx].nCurAudioFileSize = 0;
 
-    const AX_CHAR* audio_ext = NULL;
-    SAMPLE_AUDIO_ENCODER_INFO_T stEncoderInfo;
-    AX_S32 s32Ret = COMMON_AUDIO_GetEncoderInfo(&stEncoderInfo);
-
-    if (!s32Ret
-        && stEncoderInfo.bEnable) {
-        if (stEncoderInfo.ePt == PT_G711A) {
-            audio_ext = "g711a";
-        } else if (stEncoderInfo.ePt == PT_G711U) {
-            audio_ext = "g711u";
-        } else if (stEncoderInfo.ePt == PT_AAC) {
-            audio_ext = "aac";
-        } else {
-            audio_ext = "pcm";
-        }
+    const AX_CHAR* audio_ext = QS_GetAudioFileExt();
 
+    if (audio_ext) {
         nSize = sprintf(g_videoRecordFile[nCamIdx].szAudioFile[nIdx], "%s/%04d-%02d-%02d-%02d%02d%02d.%s",
                 g_videoRecordFile[nCamIdx].szBaseDir,
                 tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, audio_ext);
@@ -511,14 +622,123 @@ static AX_U32 QS_GetFileName(AX_S32 nCamIdx) {
     return nIdx;
 }
 
+static AX_VOID QS_RecorderSyncSegment(RECODER_FILE_INFO_T *pRecFileInfo) {
+    AX_U32 arrSize[QS_SEG_TRACK_MAX] = {pRecFileInfo->nCurVideoFileSize, pRecFileInfo->nCurAudioFileSize};
+
+    QS_SegRingUpdate(pRecFileInfo->hSegRing, arrSize, pRecFileInfo->nSegStartPts, pRecFileInfo->nSegEndPts);
+    pRecFileInfo->nSegSyncSize = pRecFileInfo->nCurVideoFileSize;
+}
+
+static AX_VOID QS_RecorderCloseFiles(RECODER_FILE_INFO_T *pRecFileInfo) {
+    AX_BOOL bOpened = QS_FileWriterIsOpened(pRecFileInfo->hVideoWriter);
+
+    QS_FileWriterClose(pRecFileInfo->hVideoWriter);
+    QS_FileWriterClose(pRecFileInfo->hAudioWriter);
+
+    if (pRecFileInfo->hSegRing && bOpened) {
+        QS_RecorderSyncSegment(pRecFileInfo);
+    }
+}
+
+/* segment files are preallocated once, so recording needs no directory scan, sweep or unlink afterwards */
+static AX_VOID QS_RecorderOpenSegRing(RECODER_FILE_INFO_T *pRecFileInfo) {
+    QS_SEG_RING_ATTR_T tAttr;
+
+    memset(&tAttr, 0, sizeof(tAttr));
+    tAttr.szDir = pRecFileInfo->szBaseDir;
+    tAttr.nSegCount = g_nMaxRecodFileCount;
+    tAttr.nTrackCount = 1;
+    tAttr.arrTrackSize[0] = g_nMaxFileSize;
+    tAttr.arrTrackExt[0] = "264";
+#ifdef QSDEMO_AUDIO_SUPPORT
+    tAttr.arrTrackExt[1] = QS_GetAudioFileExt();
+    if (tAttr.arrTrackExt[1]) {
+        tAttr.nTrackCount = 2;
+        tAttr.arrTrackSize[1] = RECORD_SEG_AUDIO_SIZE;
+    }
+#endif
+
+    pRecFileInfo->hSegRing = QS_SegRingOpen(&tAttr);
+    if (!pRecFileInfo->hSegRing) {
+        ALOGE("sns[%d] open segment ring failed, record to files instead", pRecFileInfo->nCamID);
+    }
+}
+
+static AX_VOID QS_RecorderCloseSegRing(RECODER_FILE_INFO_T *pRecFileInfo) {
+    if (pRecFileInfo->hSegRing) {
+        QS_SegRingClose(pRecFileInfo->hSegRing);
+        pRecFileInfo->hSegRing = NULL;
+    }
+}
+
+static AX_S32 QS_RecorderOpenSegment(RECODER_FILE_INFO_T *pRecFileInfo) {
+    AX_CHAR szPath[MAX_PATH];
+    AX_S32 nSeg = QS_SegRingNext(pRecFileInfo->hSegRing);
+
+    if (nSeg < 0) {
+        return -1;
+    }
+
+    pRecFileInfo->nCurVideoFileSize = 0;
+    pRecFileInfo->nCurAudioFileSize = 0;
+    pRecFileInfo->nSegStartPts = 0;
+    pRecFileInfo->nSegEndPts = 0;
+    pRecFileInfo->nSegSyncSize = 0;
+
+    QS_SegRingGetPath(pRecFileInfo->hSegRing, nSeg, 0, szPath, MAX_PATH);
+    if (QS_FileWriterOpen(pRecFileInfo->hVideoWriter, szPath, AX_TRUE) != 0) {
+        ALOGE("sns[%d] open video segment %s failed, errno=%d", pRecFileInfo->nCamID, szPath, errno);
+        return -1;
+    }
+    ALOGI("sns[%d] record video to segment: %s", pRecFileInfo->nCamID, szPath);
+
+    if (QS_SegRingGetPath(pRecFileInfo->hSegRing, nSeg, 1, szPath, MAX_PATH) == 0) {
+        if (QS_FileWriterOpen(pRecFileInfo->hAudioWriter, szPath, AX_TRUE) != 0) {
+            ALOGE("sns[%d] open audio segment %s failed, errno=%d", pRecFileInfo->nCamID, szPath, errno);
+            QS_RecorderCloseFiles(pRecFileInfo);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static AX_S32 QS_RecorderWriteElement(QS_FILE_WRITER_HANDLE hWriter, const AX_RINGFIFO_ELEMENT_T *pElement) {
+    if (QS_FileWriterWrite(hWriter, pElement->data[0].buf, pElement->data[0].len) != 0) {
+        return -1;
+    }
+    if (pElement->data[1].len && QS_FileWriterWrite(hWriter, pElement->data[1].buf, pElement->data[1].len) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static AX_VOID QS_RecorderDumpStat(RECODER_FILE_INFO_T *pRecFileInfo) {
+    QS_FILE_WRITER_STAT_T tStat;
+    memset(&tStat, 0, sizeof(tStat));
+
+    QS_FileWriterGetStat(pRecFileInfo->hVideoWriter, &tStat);
+    ALOGI("sns[%d] video record(%s): %llu bytes, %llu syscalls, pending max %u, stalls %u, fifo peak %u/%u",
+          pRecFileInfo->nCamID, QS_FileWriterGetEngine(pRecFileInfo->hVideoWriter), tStat.nBytes, tStat.nSyscalls,
+          tStat.nMaxPending, tStat.nStalls, pRecFileInfo->nVideoFifoPeak, AX_RingFifo_Capacity(pRecFileInfo->hVideoFifo));
+
+#ifdef QSDEMO_AUDIO_SUPPORT
+    memset(&tStat, 0, sizeof(tStat));
+    QS_FileWriterGetStat(pRecFileInfo->hAudioWriter, &tStat);
+    ALOGI("sns[%d] audio record(%s): %llu bytes, %llu syscalls, pending max %u, stalls %u, fifo peak %u/%u",
+          pRecFileInfo->nCamID, QS_FileWriterGetEngine(pRecFileInfo->hAudioWriter), tStat.nBytes, tStat.nSyscalls,
+          tStat.nMaxPending, tStat.nStalls, pRecFileInfo->nAudioFifoPeak, AX_RingFifo_Capacity(pRecFileInfo->hAudioFifo));
+#endif
+}
+
 static AX_VOID *record_thread_func(AX_VOID *param) {
 
     RECODER_FILE_INFO_T * pRecFileInfo = (RECODER_FILE_INFO_T *)param;
+    QS_FILE_WRITER_HANDLE hVideoWriter = pRecFileInfo->hVideoWriter;
+    QS_FILE_WRITER_HANDLE hAudioWriter = pRecFileInfo->hAudioWriter;
     AX_RINGFIFO_ELEMENT_T di;
-    FILE *f_video = NULL;
-    FILE *f_audio = NULL;
     AX_U32 len = 0;
-    AX_U32 wlen = 0;
+    AX_U32 nFlushSeq = 0;
     AX_CHAR command[256] = {0};
     AX_CHAR name[64] = {0};
     sprintf(name, "qs_record%d", pRecFileInfo->nCamID);
@@ -530,11 +750,12 @@ static AX_VOID *record_thread_func(AX_VOID *param) {
     command[nSize] = 0;
 
 wait_sd:
+    QS_RecorderCloseSegRing(pRecFileInfo);
     do {
         if (QS_IsSDCardReady()) {
             break;
         }
-        usleep(100000);
+        QS_RecorderWait(pRecFileInfo);
     } while (g_bWorking);
 
     if (!g_bWorking) {
@@ -558,42 +779,47 @@ wait_sd:
         return NULL;
     }
 
+    AX_U32 nIdx = 0;
+    if (g_bSegmentRing) {
+        QS_RecorderOpenSegRing(pRecFileInfo);
+    }
+
+    if (pRecFileInfo->hSegRing) {
+        if (QS_RecorderOpenSegment(pRecFileInfo) != 0) {
+            goto wait_sd;
+        }
+        goto record;
+    }
+
     QS_ListFile(pRecFileInfo->nCamID);
 
     QS_CheckAndSweepDisk(pRecFileInfo->nCamID);
 
-    AX_U32 nIdx = QS_GetFileName(pRecFileInfo->nCamID);
-    f_video = fopen(g_videoRecordFile[pRecFileInfo->nCamID].szVideoFile[nIdx], "wb");
+    nIdx = QS_GetFileName(pRecFileInfo->nCamID);
+    QS_FileWriterOpen(hVideoWriter, g_videoRecordFile[pRecFileInfo->nCamID].szVideoFile[nIdx], AX_FALSE);
     ALOGI("sns[%d] create video file: %s, ret=%d", pRecFileInfo->nCamID, g_videoRecordFile[pRecFileInfo->nCamID].szVideoFile[nIdx], errno);
 
-    if (!f_video) {
+    if (!QS_FileWriterIsOpened(hVideoWriter)) {
         goto wait_sd;
     }
 
 #ifdef QSDEMO_AUDIO_SUPPORT
     if (strlen(g_videoRecordFile[pRecFileInfo->nCamID].szAudioFile[nIdx]) != 0) {
-        f_audio = fopen(g_videoRecordFile[pRecFileInfo->nCamID].szAudioFile[nIdx], "wb");
+        QS_FileWriterOpen(hAudioWriter, g_videoRecordFile[pRecFileInfo->nCamID].szAudioFile[nIdx], AX_FALSE);
         ALOGI("sns[%d] create audio file: %s, ret=%d", pRecFileInfo->nCamID, g_videoRecordFile[pRecFileInfo->nCamID].szAudioFile[nIdx], errno);
 
-        if (!f_audio) {
-            fclose(f_video);
-            f_video = NULL;
+        if (!QS_FileWriterIsOpened(hAudioWriter)) {
+            QS_RecorderCloseFiles(pRecFileInfo);
 
             goto wait_sd;
         }
     }
 #endif
 
+record:
 #define CHECK_SDCARD_READY() do { \
             if (!QS_IsSDCardReady()) { \
-                if (f_video) { \
-                    fclose(f_video); \
-                    f_video = NULL; \
-                } \
-                if (f_audio) { \
-                    fclose(f_audio); \
-                    f_audio = NULL; \
-                } \
+                QS_RecorderCloseFiles(pRecFileInfo); \
                 goto wait_sd; \
             } \
         } while(0)
@@ -601,10 +827,14 @@ wait_sd:
     while (g_bWorking || AX_RingFifo_Size(pRecFileInfo->hVideoFifo) > 0 || AX_RingFifo_Size(pRecFileInfo->hAudioFifo) > 0) {
         CHECK_SDCARD_READY();
 
+        /* frames put before this sequence are drained by the pass below */
+        nFlushSeq = QS_RecorderGetFlushSeq(pRecFileInfo);
+
         if (g_bWorking
-            && AX_RingFifo_Size(pRecFileInfo->hVideoFifo) < (AX_RingFifo_Capacity(pRecFileInfo->hVideoFifo) / 2)
-            && AX_RingFifo_Size(pRecFileInfo->hAudioFifo) < (AX_RingFifo_Capacity(pRecFileInfo->hAudioFifo) / 2)) {
-            usleep(100000);
+            && nFlushSeq == pRecFileInfo->nFlushDone
+            && AX_RingFifo_Size(pRecFileInfo->hVideoFifo) < pRecFileInfo->nVideoWakeSize
+            && AX_RingFifo_Size(pRecFileInfo->hAudioFifo) < pRecFileInfo->nAudioWakeSize) {
+            QS_RecorderWait(pRecFileInfo);
             continue;
         }
 
@@ -616,31 +846,19 @@ wait_sd:
             if (AX_RingFifo_Size(pRecFileInfo->hAudioFifo) > 0
                 && AX_RingFifo_Get(pRecFileInfo->hAudioFifo, &di) == 0) {
                 len = di.data[0].len + di.data[1].len;
-                wlen = 0;
 
-                if (f_audio) {
-                    wlen = fwrite(di.data[0].buf, 1, di.data[0].len, f_audio);
-                    if (di.data[1].len) {
-                        wlen += fwrite(di.data[1].buf, 1, di.data[1].len, f_audio);
-                    }
-                    if (wlen != len) {
-                        ALOGE("Audio sns[%d] write data to file failed, %u -> %u", pRecFileInfo->nCamID, len, wlen);
-                        {
-                            fclose(f_audio);
-                            f_audio = NULL;
-                            pRecFileInfo->nCurAudioFileSize += wlen;
-                            AX_RingFifo_Pop(pRecFileInfo->hAudioFifo);
-
-                            if (f_video) {
-                                fclose(f_video);
-                                f_video = NULL;
-                            }
-                            goto wait_sd;
-                        }
+                if (pRecFileInfo->hSegRing && pRecFileInfo->nCurAudioFileSize + len > QS_SegRingGetTrackSize(pRecFileInfo->hSegRing, 1)) {
+                    /* audio segment is full before video reaches next I frame */
+                } else if (QS_FileWriterIsOpened(hAudioWriter)) {
+                    if (QS_RecorderWriteElement(hAudioWriter, &di) != 0) {
+                        ALOGE("Audio sns[%d] write data to file failed, %u bytes", pRecFileInfo->nCamID, len);
+                        AX_RingFifo_Pop(pRecFileInfo->hAudioFifo);
+                        QS_RecorderCloseFiles(pRecFileInfo);
+                        goto wait_sd;
                     }
+                    pRecFileInfo->nCurAudioFileSize += len;
                 }
 
-                pRecFileInfo->nCurAudioFileSize += wlen;
                 AX_RingFifo_Pop(pRecFileInfo->hAudioFifo);
             }
 #endif
@@ -650,39 +868,40 @@ wait_sd:
                 // ALOGI("[rec%d][get] pts=%llu, ifrm=%d", pRecFileInfo->nCamID, di.nPts, di.bIFrame);
 
                 len = di.data[0].len + di.data[1].len;
-                wlen = 0;
-                if (di.bIFrame && (pRecFileInfo->nCurVideoFileSize + len) >= g_nMaxFileSize) {
-                    if (f_video) {
-                        fflush(f_video);
-                        fclose(f_video);
+                if (pRecFileInfo->hSegRing) {
+                    AX_U32 nSegSize = QS_SegRingGetTrackSize(pRecFileInfo->hSegRing, 0);
+                    if (di.bIFrame && (pRecFileInfo->nCurVideoFileSize + len) >= nSegSize - RECORD_SEG_HEADROOM) {
+                        QS_RecorderCloseFiles(pRecFileInfo);
+                        if (QS_RecorderOpenSegment(pRecFileInfo) != 0) {
+                            goto wait_sd;
+                        }
+                    } else if ((pRecFileInfo->nCurVideoFileSize + len) > nSegSize) {
+                        ALOGW("sns[%d] segment is full, drop frame pts=%llu", pRecFileInfo->nCamID, di.nPts);
+                        AX_RingFifo_Pop(pRecFileInfo->hVideoFifo);
+                        continue;
                     }
+                } else if (di.bIFrame && (pRecFileInfo->nCurVideoFileSize + len) >= g_nMaxFileSize) {
+                    QS_RecorderCloseFiles(pRecFileInfo);
 
-#ifdef QSDEMO_AUDIO_SUPPORT
-                    if (f_audio) {
-                        fflush(f_audio);
-                        fclose(f_audio);
-                    }
-#endif
                     g_videoRecordFile[pRecFileInfo->nCamID].nCurFileIdx ++;
 
                     QS_CheckAndSweepDisk(pRecFileInfo->nCamID);
 
                     nIdx = QS_GetFileName(pRecFileInfo->nCamID);
-                    f_video = fopen(g_videoRecordFile[pRecFileInfo->nCamID].szVideoFile[nIdx], "wb");
+                    QS_FileWriterOpen(hVideoWriter, g_videoRecordFile[pRecFileInfo->nCamID].szVideoFile[nIdx], AX_FALSE);
                     ALOGI("sns[%d] create video file: %s", pRecFileInfo->nCamID, g_videoRecordFile[pRecFileInfo->nCamID].szVideoFile[nIdx]);
 
-                    if (!f_video) {
+                    if (!QS_FileWriterIsOpened(hVideoWriter)) {
                         goto wait_sd;
                     }
 
 #ifdef QSDEMO_AUDIO_SUPPORT
                     if (strlen(g_videoRecordFile[pRecFileInfo->nCamID].szAudioFile[nIdx]) != 0) {
-                        f_audio = fopen(g_videoRecordFile[pRecFileInfo->nCamID].szAudioFile[nIdx], "wb");
+                        QS_FileWriterOpen(hAudioWriter, g_videoRecordFile[pRecFileInfo->nCamID].szAudioFile[nIdx], AX_FALSE);
                         ALOGI("sns[%d] create audio file: %s", pRecFileInfo->nCamID, g_videoRecordFile[pRecFileInfo->nCamID].szAudioFile[nIdx]);
 
-                        if (!f_audio) {
-                            fclose(f_video);
-                            f_video = NULL;
+                        if (!QS_FileWriterIsOpened(hAudioWriter)) {
+                            QS_RecorderCloseFiles(pRecFileInfo);
 
                             goto wait_sd;
                         }
@@ -695,58 +914,60 @@ wait_sd:
                     continue;
                 }
 
-                if (f_video) {
-                    wlen = fwrite(di.data[0].buf, 1, di.data[0].len, f_video);
-                    if (di.data[1].len) {
-                        wlen += fwrite(di.data[1].buf, 1, di.data[1].len, f_video);
+                if (QS_FileWriterIsOpened(hVideoWriter)) {
+                    if (QS_RecorderWriteElement(hVideoWriter, &di) != 0) {
+                        ALOGE("Video sns[%d] write data to file failed, %u bytes", pRecFileInfo->nCamID, len);
+                        AX_RingFifo_Pop(pRecFileInfo->hVideoFifo);
+                        QS_RecorderCloseFiles(pRecFileInfo);
+                        goto wait_sd;
                     }
-                    if (wlen != len) {
-                        ALOGE("Video sns[%d] write data to file failed, %u -> %u", pRecFileInfo->nCamID, len, wlen);
-                        {
-                            fclose(f_video);
-                            f_video = NULL;
-                            pRecFileInfo->nCurVideoFileSize += wlen;
-                            AX_RingFifo_Pop(pRecFileInfo->hVideoFifo);
-#ifdef QSDEMO_AUDIO_SUPPORT
-                            if (f_audio) {
-                                fclose(f_audio);
-                                f_audio = NULL;
-                            }
-#endif
-                            goto wait_sd;
-                        }
+                    if (pRecFileInfo->nCurVideoFileSize == 0) {
+                        pRecFileInfo->nSegStartPts = di.nPts;
                     }
+                    pRecFileInfo->nSegEndPts = di.nPts;
+                    pRecFileInfo->nCurVideoFileSize += len;
+                }
+
+                if (pRecFileInfo->hSegRing && pRecFileInfo->nCurVideoFileSize - pRecFileInfo->nSegSyncSize >= RECORD_SEG_SYNC_SIZE) {
+                    QS_RecorderSyncSegment(pRecFileInfo);
                 }
 
-                pRecFileInfo->nCurVideoFileSize += wlen;
                 AX_RingFifo_Pop(pRecFileInfo->hVideoFifo);
             } else {
                 break;
             }
         } while(g_bWorking);
-    }
 
-    if (f_video) {
-        fflush(f_video);
-        fclose(f_video);
-    }
-    if (f_audio) {
-        fflush(f_audio);
-        fclose(f_audio);
+        if (nFlushSeq != pRecFileInfo->nFlushDone) {
+            if (QS_FileWriterFlush(hVideoWriter) != 0
+                || (QS_FileWriterIsOpened(hAudioWriter) && QS_FileWriterFlush(hAudioWriter) != 0)) {
+                ALOGE("sns[%d] flush record files failed", pRecFileInfo->nCamID);
+                QS_RecorderFlushDone(pRecFileInfo, nFlushSeq);
+                QS_RecorderCloseFiles(pRecFileInfo);
+                goto wait_sd;
+            }
+            QS_RecorderFlushDone(pRecFileInfo, nFlushSeq);
+        }
     }
 
+    QS_RecorderCloseFiles(pRecFileInfo);
+    QS_RecorderCloseSegRing(pRecFileInfo);
+    QS_RecorderDumpStat(pRecFileInfo);
+
     return NULL;
 }
 
-AX_S32 QS_VideoRecorderInit(AX_S32 nCamCount, AX_U32 nVideoRingBufSize, AX_U32 nAudioRingBufSize, AX_S32 nMaxRecodFileCount)
+AX_S32 QS_VideoRecorderInit(AX_S32 nCamCount, AX_U32 nVideoRingBufSize, AX_U32 nAudioRingBufSize, AX_S32 nMaxRecodFileCount,
+                            AX_BOOL bSegmentRing)
 {
     AX_S32 i = 0;
     AX_S32 j = 0;
     AX_CHAR szName[64] = {0};
     g_nCamCount = nCamCount;
     g_nMaxRecodFileCount = nMaxRecodFileCount;
+    g_bSegmentRing = bSegmentRing;
 
-    ALOGI("max record file count %d", g_nMaxRecodFileCount);
+    ALOGI("max record file count %d, segment ring %d", g_nMaxRecodFileCount, g_bSegmentRing);
 
     for (i = 0; i < nCamCount; i++) {
         g_videoRecordFile[i].nCurFileIdx = 0;
@@ -755,6 +976,7 @@ AX_S32 QS_VideoRecorderInit(AX_S32 nCamCount, AX_U32 nVideoRingBufSize, AX_U32 n
         g_videoRecordFile[i].szBaseDir = (i == 0) ? "/mnt/qsdemo/aov/sns0_vr" : "/mnt/qsdemo/aov/sns1_vr";
         g_videoRecordFile[i].nCurFileIdx = 0;
         g_videoRecordFile[i].tid = 0;
+        g_videoRecordFile[i].hSegRing = NULL;
         g_videoRecordFile[i].szVideoFile = (char**)malloc(g_nMaxRecodFileCount*sizeof(char*));
         g_videoRecordFile[i].szAudioFile = (char**)malloc(g_nMaxRecodFileCount*sizeof(char*));
         for(j = 0; j < g_nMaxRecodFileCount; j++) {
@@ -766,17 +988,56 @@ AX_S32 QS_VideoRecorderInit(AX_S32 nCamCount, AX_U32 nVideoRingBufSize, AX_U32 n
     }
 
     for (i = 0; i < nCamCount; i++) {
+        QS_FILE_WRITER_ATTR_T tWriterAttr;
+        RECODER_FILE_INFO_T *pRecFileInfo = &g_videoRecordFile[i];
+
+        if (!pRecFileInfo->bSyncInited) {
+            pthread_condattr_t tCondAttr;
+            pthread_condattr_init(&tCondAttr);
+            pthread_condattr_setclock(&tCondAttr, CLOCK_MONOTONIC);
+            pthread_mutex_init(&pRecFileInfo->mtxWake, NULL);
+            pthread_cond_init(&pRecFileInfo->cvWake, &tCondAttr);
+            pthread_cond_init(&pRecFileInfo->cvFlushed, &tCondAttr);
+            pthread_condattr_destroy(&tCondAttr);
+            pRecFileInfo->bSyncInited = AX_TRUE;
+        }
+        pRecFileInfo->bWakeup = AX_FALSE;
+        pRecFileInfo->nFlushSeq = 0;
+        pRecFileInfo->nFlushDone = 0;
+        pRecFileInfo->nVideoFifoPeak = 0;
+        pRecFileInfo->nAudioFifoPeak = 0;
+        pRecFileInfo->nVideoWakeSize = nVideoRingBufSize / RECORD_WAKE_DIVISOR;
+        pRecFileInfo->nAudioWakeSize = nAudioRingBufSize / RECORD_WAKE_DIVISOR;
+
         sprintf(szName, "VRING%d", i);
-        if (AX_RingFifo_Init(&g_videoRecordFile[i].hVideoFifo, nVideoRingBufSize, szName) != 0) {
+        if (AX_RingFifo_Init(&pRecFileInfo->hVideoFifo, nVideoRingBufSize, szName) != 0) {
             ALOGE("create video fifo failed");
             return -1;
         }
+
+        memset(&tWriterAttr, 0, sizeof(tWriterAttr));
+        tWriterAttr.nBufSize = RECORD_VIDEO_WRITE_BUF_SIZE;
+        tWriterAttr.nBufCount = RECORD_WRITE_BUF_COUNT;
+        tWriterAttr.bDirect = RECORD_DIRECT_IO;
+        tWriterAttr.bUring = AX_TRUE;
+        pRecFileInfo->hVideoWriter = QS_FileWriterCreate(&tWriterAttr);
+        if (!pRecFileInfo->hVideoWriter) {
+            ALOGE("create video file writer failed");
+            return -1;
+        }
 #ifdef QSDEMO_AUDIO_SUPPORT
         sprintf(szName, "ARING%d", i);
-        if (AX_RingFifo_Init(&g_videoRecordFile[i].hAudioFifo, nAudioRingBufSize, szName) != 0) {
+        if (AX_RingFifo_Init(&pRecFileInfo->hAudioFifo, nAudioRingBufSize, szName) != 0) {
             ALOGE("create audio fifo failed");
             return -1;
         }
+
+        tWriterAttr.nBufSize = RECORD_AUDIO_WRITE_BUF_SIZE;
+        pRecFileInfo->hAudioWriter = QS_FileWriterCreate(&tWriterAttr);
+        if (!pRecFileInfo->hAudioWriter) {
+            ALOGE("create audio file writer failed");
+            return -1;
+        }
 #endif
     }
 
@@ -806,6 +1067,11 @@ AX_S32 QS_VideoRecorderDeinit()
             g_videoRecordFile[i].hAudioFifo = NULL;
         }
 
+        QS_FileWriterDestroy(g_videoRecordFile[i].hVideoWriter);
+        g_videoRecordFile[i].hVideoWriter = NULL;
+        QS_FileWriterDestroy(g_videoRecordFile[i].hAudioWriter);
+        g_videoRecordFile[i].hAudioWriter = NULL;
+
         for(j = 0; j < g_nMaxRecodFileCount; j++) {
             free(g_videoRecordFile[i].szVideoFile[j]);
             free(g_videoRecordFile[i].szAudioFile[j]);
@@ -839,6 +1105,7 @@ AX_S32 QS_VideoRecorderStop() {
         return 0;
     }
     g_bWorking = AX_FALSE;
+    QS_RecorderWakeupAll();
     for (i = 0; i < g_nCamCount; i++) {
         // join thread
         if (g_videoRecordFile[i].tid != 0) {
@@ -868,11 +1135,8 @@ AX_S32 QS_SaveVideo(AX_S32 nCamIdx, AX_U8 *pData, AX_S32 nSize, AX_U64 nPts, AX_
     //     ALOGI("[rec%d][put] pts=%llu, ifrm=%d, ring is full", nCamIdx, nPts, bIFrame);
     // }
 
-    if (bFlush) {
-        while (AX_RingFifo_Size(g_videoRecordFile[nCamIdx].hVideoFifo) != 0) {
-            usleep(10000);
-        }
-    }
+    QS_RecorderOnPut(&g_videoRecordFile[nCamIdx], g_videoRecordFile[nCamIdx].hVideoFifo, g_videoRecordFile[nCamIdx].nVideoWakeSize,
+                     &g_videoRecordFile[nCamIdx].nVideoFifoPeak, bFlush);
 
     return ret;
 }
@@ -891,11 +1155,8 @@ AX_S32 QS_SaveAudio(AX_S32 nCamIdx, AX_U8 *pData, AX_S32 nSize, AX_U64 nPts, AX_
 
     ret = AX_RingFifo_Put(g_videoRecordFile[nCamIdx].hAudioFifo, pData, nSize, nPts, AX_TRUE);
 
-    if (bFlush) {
-        while (AX_RingFifo_Size(g_videoRecordFile[nCamIdx].hAudioFifo) != 0) {
-            usleep(10000);
-        }
-    }
+    QS_RecorderOnPut(&g_videoRecordFile[nCamIdx], g_videoRecordFile[nCamIdx].hAudioFifo, g_videoRecordFile[nCamIdx].nAudioWakeSize,
+                     &g_videoRecordFile[nCamIdx].nAudioFifoPeak, bFlush);
 
     return ret;
 }
@@ -20,7 +20,9 @@ AX_S32  QS_MonitorSDCardStart();
 AX_S32  QS_MonitorSDCardStop();
 AX_BOOL QS_IsSDCardReady();
 
-AX_S32  QS_VideoRecorderInit(AX_S32 nCamCount, AX_U32 nVideoRingBufSize, AX_U32 nAudioRingBufSize, AX_S32 nMaxRecodFileCount);
+/* bSegmentRing: record to nMaxRecodFileCount preallocated segment files reused in loop */
+AX_S32  QS_VideoRecorderInit(AX_S32 nCamCount, AX_U32 nVideoRingBufSize, AX_U32 nAudioRingBufSize, AX_S32 nMaxRecodFileCount,
+                             AX_BOOL bSegmentRing);
 AX_S32  QS_VideoRecorderDeinit();
 AX_S32  QS_VideoRecorderStart();
 AX_S32  QS_VideoRecorderStop();
@@ -0,0 +1,309 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  /* fallocate */
+#endif
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "qs_segment_ring.h"
+#include "qs_log.h"
+
+#define QS_SEG_MAX_COUNT    (256)
+#define QS_SEG_MAX_PATH     (256)
+
+typedef struct _QS_SEG_RING {
+    QS_SEG_RING_ATTR_T tAttr;
+    AX_CHAR szDir[QS_SEG_MAX_PATH];
+    AX_CHAR arrExt[QS_SEG_TRACK_MAX][16];
+    AX_S32  nIndexFd;
+    AX_S32  nCurIdx;        /* -1 before first segment */
+    AX_U32  nNextSeq;
+    QS_SEG_INFO_T *pInfo;
+} QS_SEG_RING_T;
+
+static AX_U32 QS_SegCheckSum(const AX_VOID *pData, AX_U32 nLen) {
+    /* fnv-1a, only used to find torn index records */
+    const AX_U8 *p = (const AX_U8 *)pData;
+    AX_U32 nHash = 2166136261u;
+    AX_U32 i = 0;
+    for (i = 0; i < nLen; i++) {
+        nHash = (nHash ^ p[i]) * 16777619u;
+    }
+    return nHash;
+}
+
+static AX_S32 QS_SegWriteInfo(QS_SEG_RING_T *pRing, AX_U32 nSegIdx) {
+    QS_SEG_INFO_T *pInfo = &pRing->pInfo[nSegIdx];
+    off_t nOffset = (off_t)(sizeof(QS_SEG_INDEX_HEAD_T) + nSegIdx * sizeof(QS_SEG_INFO_T));
+
+    pInfo->nCheckSum = QS_SegCheckSum(pInfo, offsetof(QS_SEG_INFO_T, nCheckSum));
+    if (pwrite(pRing->nIndexFd, pInfo, sizeof(QS_SEG_INFO_T), nOffset) != (ssize_t)sizeof(QS_SEG_INFO_T)) {
+        ALOGE("seg ring %s write index of seg %u failed, errno=%d", pRing->szDir, nSegIdx, errno);
+        return -1;
+    }
+
+    return 0;
+}
+
+static AX_S32 QS_SegLoadIndex(QS_SEG_RING_T *pRing) {
+    QS_SEG_INDEX_HEAD_T tHead;
+    QS_SEG_INDEX_HEAD_T tLoad;
+    AX_U32 nInfoSize = pRing->tAttr.nSegCount * sizeof(QS_SEG_INFO_T);
+    AX_U32 i = 0;
+
+    memset(&tHead, 0, sizeof(tHead));
+    tHead.nMagic = QS_SEG_INDEX_MAGIC;
+    tHead.nVersion = QS_SEG_INDEX_VERSION;
+    tHead.nSegCount = pRing->tAttr.nSegCount;
+    tHead.nTrackCount = pRing->tAttr.nTrackCount;
+    for (i = 0; i < pRing->tAttr.nTrackCount; i++) {
+        tHead.arrTrackSize[i] = pRing->tAttr.arrTrackSize[i];
+    }
+    tHead.nCheckSum = QS_SegCheckSum(&tHead, offsetof(QS_SEG_INDEX_HEAD_T, nCheckSum));
+
+    if (pread(pRing->nIndexFd, &tLoad, sizeof(tLoad), 0) == (ssize_t)sizeof(tLoad) && memcmp(&tLoad, &tHead, sizeof(tHead)) == 0
+        && pread(pRing->nIndexFd, pRing->pInfo, nInfoSize, sizeof(tHead)) == (ssize_t)nInfoSize) {
+        for (i = 0; i < pRing->tAttr.nSegCount; i++) {
+            if (pRing->pInfo[i].nCheckSum != QS_SegCheckSum(&pRing->pInfo[i], offsetof(QS_SEG_INFO_T, nCheckSum))) {
+                ALOGW("seg ring %s index of seg %u is broken, drop it", pRing->szDir, i);
+                memset(&pRing->pInfo[i], 0, sizeof(QS_SEG_INFO_T));
+            }
+        }
+        return 0;
+    }
+
+    /* no index or layout changed, all segments are regarded as empty */
+    ALOGI("seg ring %s create index: %u segs", pRing->szDir, pRing->tAttr.nSegCount);
+    memset(pRing->pInfo, 0, nInfoSize);
+    if (ftruncate(pRing->nIndexFd, 0) != 0 || pwrite(pRing->nIndexFd, &tHead, sizeof(tHead), 0) != (ssize_t)sizeof(tHead)) {
+        return -1;
+    }
+    for (i = 0; i < pRing->tAttr.nSegCount; i++) {
+        if (QS_SegWriteInfo(pRing, i) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static AX_S32 QS_SegPrealloc(const AX_CHAR *szPath, AX_U32 nSize, AX_BOOL *pCreated) {
+    struct stat st;
+    AX_S32 nRet = 0;
+
+    *pCreated = AX_FALSE;
+    if (stat(szPath, &st) == 0 && (AX_U64)st.st_size == nSize && (AX_U64)st.st_blocks * 512 >= nSize) {
+        return 0;
+    }
+
+    AX_S32 fd = open(szPath, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+
+    if (ftruncate(fd, 0) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    nRet = fallocate(fd, 0, 0, (off_t)nSize);
+    if (nRet != 0 && (errno == EOPNOTSUPP || errno == ENOSYS)) {
+        /* file system without fallocate, glibc writes the blocks */
+        nRet = posix_fallocate(fd, 0, (off_t)nSize);
+        if (nRet != 0) {
+            errno = nRet;
+            nRet = -1;
+        }
+    }
+
+    if (nRet != 0) {
+        AX_S32 nErr = errno;
+        close(fd);
+        unlink(szPath);
+        errno = nErr;
+        return -1;
+    }
+
+    close(fd);
+    *pCreated = AX_TRUE;
+
+    return 0;
+}
+
+QS_SEG_RING_HANDLE QS_SegRingOpen(const QS_SEG_RING_ATTR_T *pAttr) {
+    AX_CHAR szPath[QS_SEG_MAX_PATH];
+    AX_U32 i = 0;
+    AX_U32 j = 0;
+
+    if (!pAttr || !pAttr->szDir || 0 == pAttr->nSegCount || pAttr->nSegCount > QS_SEG_MAX_COUNT || 0 == pAttr->nTrackCount
+        || pAttr->nTrackCount > QS_SEG_TRACK_MAX) {
+        return NULL;
+    }
+
+    QS_SEG_RING_T *pRing = (QS_SEG_RING_T *)malloc(sizeof(QS_SEG_RING_T));
+    if (!pRing) {
+        return NULL;
+    }
+
+    memset(pRing, 0, sizeof(QS_SEG_RING_T));
+    pRing->tAttr = *pAttr;
+    pRing->nIndexFd = -1;
+    pRing->nCurIdx = -1;
+    snprintf(pRing->szDir, sizeof(pRing->szDir), "%s", pAttr->szDir);
+    for (i = 0; i < pAttr->nTrackCount; i++) {
+        snprintf(pRing->arrExt[i], sizeof(pRing->arrExt[i]), "%s", pAttr->arrTrackExt[i] ? pAttr->arrTrackExt[i] : "dat");
+    }
+
+    pRing->pInfo = (QS_SEG_INFO_T *)malloc(pAttr->nSegCount * sizeof(QS_SEG_INFO_T));
+    if (!pRing->pInfo) {
+        QS_SegRingClose(pRing);
+        return NULL;
+    }
+
+    snprintf(szPath, sizeof(szPath), "%s/%s", pRing->szDir, QS_SEG_INDEX_NAME);
+    pRing->nIndexFd = open(szPath, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (pRing->nIndexFd < 0 || QS_SegLoadIndex(pRing) != 0) {
+        ALOGE("seg ring open index %s failed, errno=%d", szPath, errno);
+        QS_SegRingClose(pRing);
+        return NULL;
+    }
+
+    for (i = 0; i < pAttr->nSegCount; i++) {
+        for (j = 0; j < pAttr->nTrackCount; j++) {
+            AX_BOOL bCreated = AX_FALSE;
+            QS_SegRingGetPath(pRing, i, j, szPath, sizeof(szPath));
+            if (QS_SegPrealloc(szPath, pAttr->arrTrackSize[j], &bCreated) != 0) {
+                ALOGE("seg ring preallocate %s(%u bytes) failed, errno=%d", szPath, pAttr->arrTrackSize[j], errno);
+                QS_SegRingClose(pRing);
+                return NULL;
+            }
+
+            if (bCreated && pRing->pInfo[i].nSeq != 0) {
+                memset(&pRing->pInfo[i], 0, sizeof(QS_SEG_INFO_T));
+                QS_SegWriteInfo(pRing, i);
+            }
+        }
+
+        if (pRing->pInfo[i].nSeq != 0
+            && (pRing->nCurIdx < 0 || (AX_S32)(pRing->pInfo[i].nSeq - pRing->pInfo[pRing->nCurIdx].nSeq) > 0)) {
+            pRing->nCurIdx = (AX_S32)i;
+        }
+    }
+
+    pRing->nNextSeq = (pRing->nCurIdx >= 0) ? pRing->pInfo[pRing->nCurIdx].nSeq + 1 : 1;
+    if (0 == pRing->nNextSeq) {
+        pRing->nNextSeq = 1;
+    }
+
+    ALOGI("seg ring %s opened: %u segs, last seg %d seq %u", pRing->szDir, pAttr->nSegCount, pRing->nCurIdx,
+          pRing->nNextSeq - 1);
+
+    return (QS_SEG_RING_HANDLE)pRing;
+}
+
+AX_VOID QS_SegRingClose(QS_SEG_RING_HANDLE hRing) {
+    QS_SEG_RING_T *pRing = (QS_SEG_RING_T *)hRing;
+
+    if (!pRing) {
+        return;
+    }
+
+    if (pRing->nIndexFd >= 0) {
+        fdatasync(pRing->nIndexFd);
+        close(pRing->nIndexFd);
+    }
+
+    free(pRing->pInfo);
+    free(pRing);
+}
+
+AX_S32 QS_SegRingNext(QS_SEG_RING_HANDLE hRing) {
+    QS_SEG_RING_T *pRing = (QS_SEG_RING_T *)hRing;
+
+    if (!pRing) {
+        return -1;
+    }
+
+    if (pRing->nCurIdx >= 0) {
+        /* final record of finished segment reaches disk before next segment is overwritten */
+        fdatasync(pRing->nIndexFd);
+    }
+
+    AX_U32 nIdx = (AX_U32)(pRing->nCurIdx + 1) % pRing->tAttr.nSegCount;
+    QS_SEG_INFO_T *pInfo = &pRing->pInfo[nIdx];
+
+    memset(pInfo, 0, sizeof(QS_SEG_INFO_T));
+    pInfo->nSeq = pRing->nNextSeq++;
+    if (0 == pRing->nNextSeq) {
+        pRing->nNextSeq = 1;
+    }
+    pInfo->nStartTime = (AX_U64)time(NULL);
+
+    pRing->nCurIdx = (AX_S32)nIdx;
+    if (QS_SegWriteInfo(pRing, nIdx) != 0) {
+        return -1;
+    }
+
+    return (AX_S32)nIdx;
+}
+
+AX_S32 QS_SegRingUpdate(QS_SEG_RING_HANDLE hRing, const AX_U32 *arrSize, AX_U64 nStartPts, AX_U64 nEndPts) {
+    QS_SEG_RING_T *pRing = (QS_SEG_RING_T *)hRing;
+    AX_U32 i = 0;
+
+    if (!pRing || !arrSize || pRing->nCurIdx < 0) {
+        return -1;
+    }
+
+    QS_SEG_INFO_T *pInfo = &pRing->pInfo[pRing->nCurIdx];
+    for (i = 0; i < pRing->tAttr.nTrackCount; i++) {
+        pInfo->arrSize[i] = arrSize[i];
+    }
+    pInfo->nStartPts = nStartPts;
+    pInfo->nEndPts = nEndPts;
+
+    return QS_SegWriteInfo(pRing, (AX_U32)pRing->nCurIdx);
+}
+
+AX_S32 QS_SegRingGetPath(QS_SEG_RING_HANDLE hRing, AX_U32 nSegIdx, AX_U32 nTrack, AX_CHAR *szPath, AX_U32 nLen) {
+    QS_SEG_RING_T *pRing = (QS_SEG_RING_T *)hRing;
+
+    if (!pRing || !szPath || nSegIdx >= pRing->tAttr.nSegCount || nTrack >= pRing->tAttr.nTrackCount) {
+        return -1;
+    }
+
+    snprintf(szPath, nLen, "%s/seg_%03u.%s", pRing->szDir, nSegIdx, pRing->arrExt[nTrack]);
+    return 0;
+}
+
+AX_U32 QS_SegRingGetTrackSize(QS_SEG_RING_HANDLE hRing, AX_U32 nTrack) {
+    QS_SEG_RING_T *pRing = (QS_SEG_RING_T *)hRing;
+
+    if (!pRing || nTrack >= pRing->tAttr.nTrackCount) {
+        return 0;
+    }
+
+    return pRing->tAttr.arrTrackSize[nTrack];
+}
+
+AX_S32 QS_SegRingGetInfo(QS_SEG_RING_HANDLE hRing, AX_U32 nSegIdx, QS_SEG_INFO_T *pInfo) {
+    QS_SEG_RING_T *pRing = (QS_SEG_RING_T *)hRing;
+
+    if (!pRing || !pInfo || nSegIdx >= pRing->tAttr.nSegCount) {
+        return -1;
+    }
+
+    *pInfo = pRing->pInfo[nSegIdx];
+    return 0;
+}
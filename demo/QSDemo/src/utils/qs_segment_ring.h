@@ -0,0 +1,71 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+#ifndef _QSSEGMENTRING_H__
+#define _QSSEGMENTRING_H__
+
+#include "ax_global_type.h"
+
+/*
+    Loop recording on a fixed set of preallocated segment files which are overwritten round-robin.
+    Segment files keep their preallocated size, valid bytes and time of each segment are kept in
+    <dir>/seg_index.dat:
+        QS_SEG_INDEX_HEAD_T + QS_SEG_INFO_T * nSegCount
+*/
+#define QS_SEG_TRACK_MAX        (2)   /* 0: video, 1: audio */
+#define QS_SEG_INDEX_MAGIC      (0x49525351)  /* "QSRI" */
+#define QS_SEG_INDEX_VERSION    (1)
+#define QS_SEG_INDEX_NAME       "seg_index.dat"
+
+typedef AX_VOID* QS_SEG_RING_HANDLE;
+
+typedef struct _QS_SEG_INDEX_HEAD {
+    AX_U32 nMagic;
+    AX_U32 nVersion;
+    AX_U32 nSegCount;
+    AX_U32 nTrackCount;
+    AX_U32 arrTrackSize[QS_SEG_TRACK_MAX];
+    AX_U32 nReserved;
+    AX_U32 nCheckSum;
+} QS_SEG_INDEX_HEAD_T;
+
+typedef struct _QS_SEG_INFO {
+    AX_U32 nSeq;                            /* increases by each reuse, 0 if segment holds no recording */
+    AX_U32 arrSize[QS_SEG_TRACK_MAX];       /* valid bytes of each track */
+    AX_U32 nReserved;
+    AX_U64 nStartTime;                      /* utc seconds of first frame */
+    AX_U64 nStartPts;
+    AX_U64 nEndPts;
+    AX_U32 nReserved2;
+    AX_U32 nCheckSum;
+} QS_SEG_INFO_T;
+
+typedef struct _QS_SEG_RING_ATTR {
+    const AX_CHAR *szDir;
+    AX_U32 nSegCount;
+    AX_U32 nTrackCount;
+    AX_U32 arrTrackSize[QS_SEG_TRACK_MAX];  /* preallocated bytes of each track file */
+    const AX_CHAR *arrTrackExt[QS_SEG_TRACK_MAX];
+} QS_SEG_RING_ATTR_T;
+
+/* load index and preallocate missing segment files, NULL if disk has no room for all segments */
+QS_SEG_RING_HANDLE QS_SegRingOpen(const QS_SEG_RING_ATTR_T *pAttr);
+AX_VOID QS_SegRingClose(QS_SEG_RING_HANDLE hRing);
+
+/* move to the oldest segment and mark it empty, returns segment index or -1 */
+AX_S32  QS_SegRingNext(QS_SEG_RING_HANDLE hRing);
+/* persist valid bytes of each track and pts range of current segment */
+AX_S32  QS_SegRingUpdate(QS_SEG_RING_HANDLE hRing, const AX_U32 *arrSize, AX_U64 nStartPts, AX_U64 nEndPts);
+
+AX_S32  QS_SegRingGetPath(QS_SEG_RING_HANDLE hRing, AX_U32 nSegIdx, AX_U32 nTrack, AX_CHAR *szPath, AX_U32 nLen);
+AX_U32  QS_SegRingGetTrackSize(QS_SEG_RING_HANDLE hRing, AX_U32 nTrack);
+AX_S32  QS_SegRingGetInfo(QS_SEG_RING_HANDLE hRing, AX_U32 nSegIdx, QS_SEG_INFO_T *pInfo);
+
+#endif //_QSSEGMENTRING_H__
@@ -0,0 +1,230 @@
+/**************************************************************************************************
+ *
+ * Copyright (c) 2019-2024 Axera Semiconductor Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Axera Semiconductor Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Axera Semiconductor Co., Ltd.
+ *
+ **************************************************************************************************/
+
+/*
+    Benchmark of qs_file_writer against one write() per frame, the way recorder wrote before.
+    Frames are fed from the calling thread like the record thread does, with the recorder's video writer attributes.
+
+    paced:  25 fps stream, I frame every second, the load of one recording camera.
+    burst:  frames of random size written as fast as the writer accepts, storage bound.
+
+    Each engine reports throughput, syscalls (pwrite and io_uring_enter, or write for baseline),
+    worst-case occupancy of writer buffers (submitted and not completed, of nBufCount), stalls and
+    longest blocking of the feeding thread. File size is checked against bytes written.
+
+    usage: file_writer_bench <file path> [burst MB] [paced seconds]
+*/
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "qs_file_writer.h"
+
+#define BENCH_BUF_SIZE        (512*1024)  /* RECORD_VIDEO_WRITE_BUF_SIZE */
+#define BENCH_BUF_COUNT       (4)         /* RECORD_WRITE_BUF_COUNT */
+#define BENCH_PACED_FPS       (25)
+#define BENCH_PACED_P_SIZE    (20*1024)
+#define BENCH_PACED_I_RATIO   (4)
+#define BENCH_BURST_MIN_SIZE  (32*1024)
+#define BENCH_BURST_MAX_SIZE  (128*1024)
+#define BENCH_BURST_I_RATIO   (3)
+#define BENCH_MAX_FRAME_SIZE  (BENCH_BURST_MAX_SIZE * BENCH_BURST_I_RATIO)
+
+typedef enum {
+    BENCH_ENGINE_WRITE = 0,  /* baseline: write() per frame */
+    BENCH_ENGINE_THREAD,
+    BENCH_ENGINE_THREAD_DIRECT,
+    BENCH_ENGINE_URING,
+    BENCH_ENGINE_URING_DIRECT,
+    BENCH_ENGINE_BUTT
+} BENCH_ENGINE_E;
+
+typedef struct {
+    const AX_CHAR *szName;
+    AX_U64 nBytes;       /* burst: total bytes to write */
+    AX_U32 nSeconds;     /* paced: duration */
+} BENCH_CASE_T;
+
+typedef struct {
+    const AX_CHAR *szEngine;
+    AX_U64 nBytes;
+    AX_U64 nElapsedUs;
+    AX_U64 nMaxBlockUs;  /* longest write call seen by feeding thread */
+    QS_FILE_WRITER_STAT_T tStat;
+    AX_BOOL bOk;
+} BENCH_RESULT_T;
+
+static AX_U8 g_arrFrame[BENCH_MAX_FRAME_SIZE];
+
+/* qs_timer.c reads board timer, host only needs a clock for logs */
+AX_U64 GetTickCountPts(AX_VOID) {
+    struct timespec tv;
+    clock_gettime(CLOCK_MONOTONIC, &tv);
+    return (AX_U64)tv.tv_sec * 1000000 + tv.tv_nsec / 1000;
+}
+
+static AX_U32 BenchFrameSize(const BENCH_CASE_T *pCase, AX_U32 nFrame, AX_U32 *pSeed) {
+    if (pCase->nSeconds > 0) {
+        return BENCH_PACED_P_SIZE * ((nFrame % BENCH_PACED_FPS) == 0 ? BENCH_PACED_I_RATIO : 1);
+    }
+
+    AX_U32 nLen = BENCH_BURST_MIN_SIZE + rand_r(pSeed) % (BENCH_BURST_MAX_SIZE - BENCH_BURST_MIN_SIZE);
+    return nLen * ((nFrame % 30) == 0 ? BENCH_BURST_I_RATIO : 1);
+}
+
+static AX_S32 BenchWrite(BENCH_ENGINE_E eEngine, AX_S32 nFd, QS_FILE_WRITER_HANDLE hWriter, AX_U32 nLen, AX_U64 *pSyscalls) {
+    if (BENCH_ENGINE_WRITE != eEngine) {
+        return QS_FileWriterWrite(hWriter, g_arrFrame, nLen);
+    }
+
+    const AX_U8 *pData = g_arrFrame;
+    while (nLen > 0) {
+        ssize_t nRet = write(nFd, pData, nLen);
+        (*pSyscalls)++;
+        if (nRet <= 0) {
+            return -1;
+        }
+        pData += nRet;
+        nLen -= (AX_U32)nRet;
+    }
+
+    return 0;
+}
+
+static AX_VOID BenchRun(const BENCH_CASE_T *pCase, BENCH_ENGINE_E eEngine, const AX_CHAR *szPath, BENCH_RESULT_T *pResult) {
+    QS_FILE_WRITER_HANDLE hWriter = NULL;
+    AX_S32 nFd = -1;
+    AX_U32 nSeed = 1;
+    AX_U32 nFrame = 0;
+    AX_U32 nFrames = pCase->nSeconds * BENCH_PACED_FPS;
+    struct stat tFileStat;
+
+    memset(pResult, 0, sizeof(BENCH_RESULT_T));
+    pResult->szEngine = "write";
+
+    if (BENCH_ENGINE_WRITE == eEngine) {
+        nFd = open(szPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (nFd < 0) {
+            return;
+        }
+    } else {
+        QS_FILE_WRITER_ATTR_T tAttr;
+        memset(&tAttr, 0, sizeof(tAttr));
+        tAttr.nBufSize = BENCH_BUF_SIZE;
+        tAttr.nBufCount = BENCH_BUF_COUNT;
+        tAttr.bDirect = (BENCH_ENGINE_THREAD_DIRECT == eEngine || BENCH_ENGINE_URING_DIRECT == eEngine) ? AX_TRUE : AX_FALSE;
+        tAttr.bUring = (BENCH_ENGINE_URING == eEngine || BENCH_ENGINE_URING_DIRECT == eEngine) ? AX_TRUE : AX_FALSE;
+        hWriter = QS_FileWriterCreate(&tAttr);
+        if (!hWriter) {
+            return;
+        }
+        if (QS_FileWriterOpen(hWriter, szPath, AX_FALSE) != 0) {
+            QS_FileWriterDestroy(hWriter);
+            return;
+        }
+        pResult->szEngine = QS_FileWriterGetEngine(hWriter);
+    }
+
+    pResult->bOk = AX_TRUE;
+    AX_U64 nStart = GetTickCountPts();
+    AX_U64 nNext = nStart;
+    while ((pCase->nSeconds > 0) ? (nFrame < nFrames) : (pResult->nBytes < pCase->nBytes)) {
+        if (pCase->nSeconds > 0) {
+            nNext += 1000000 / BENCH_PACED_FPS;
+            AX_U64 nNow = GetTickCountPts();
+            if (nNext > nNow) {
+                usleep((useconds_t)(nNext - nNow));
+            }
+        }
+
+        AX_U32 nLen = BenchFrameSize(pCase, nFrame, &nSeed);
+        AX_U64 nCallStart = GetTickCountPts();
+        if (BenchWrite(eEngine, nFd, hWriter, nLen, &pResult->tStat.nSyscalls) != 0) {
+            pResult->bOk = AX_FALSE;
+            break;
+        }
+        AX_U64 nBlock = GetTickCountPts() - nCallStart;
+        if (nBlock > pResult->nMaxBlockUs) {
+            pResult->nMaxBlockUs = nBlock;
+        }
+
+        pResult->nBytes += nLen;
+        nFrame++;
+    }
+
+    /* bytes must reach the file before clock stops, as recorder close does */
+    if (BENCH_ENGINE_WRITE == eEngine) {
+        close(nFd);
+        pResult->tStat.nBytes = pResult->nBytes;
+    } else {
+        if (QS_FileWriterClose(hWriter) != 0) {
+            pResult->bOk = AX_FALSE;
+        }
+        QS_FileWriterGetStat(hWriter, &pResult->tStat);
+        QS_FileWriterDestroy(hWriter);
+    }
+    pResult->nElapsedUs = GetTickCountPts() - nStart;
+
+    if (stat(szPath, &tFileStat) != 0 || (AX_U64)tFileStat.st_size != pResult->nBytes || pResult->tStat.nBytes != pResult->nBytes) {
+        pResult->bOk = AX_FALSE;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        printf("usage: %s <file path> [burst MB] [paced seconds]\n", argv[0]);
+        return 1;
+    }
+
+    const AX_CHAR *szPath = argv[1];
+    AX_U64 nBurstMB = (argc > 2) ? (AX_U64)atoi(argv[2]) : 256;
+    AX_U32 nPacedSeconds = (argc > 3) ? (AX_U32)atoi(argv[3]) : 10;
+
+    const BENCH_CASE_T arrCases[] = {
+        {"paced", 0, nPacedSeconds},
+        {"burst", nBurstMB << 20, 0},
+    };
+    const AX_CHAR *arrEngineNames[BENCH_ENGINE_BUTT] = {"write per frame", "thread", "thread direct", "uring", "uring direct"};
+    AX_BOOL bOk = AX_TRUE;
+    AX_U32 i = 0;
+    AX_U32 j = 0;
+
+    memset(g_arrFrame, 0x5A, sizeof(g_arrFrame));
+    printf("writer: %u buffers of %u KB\n", BENCH_BUF_COUNT, BENCH_BUF_SIZE >> 10);
+    printf("%-6s %-16s %-14s %8s %9s %9s %10s %7s %10s\n", "case", "requested", "engine", "MB", "MB/s", "syscalls", "max bufs", "stalls",
+           "max blk ms");
+
+    for (i = 0; i < sizeof(arrCases) / sizeof(arrCases[0]); i++) {
+        for (j = 0; j < BENCH_ENGINE_BUTT; j++) {
+            BENCH_RESULT_T tResult;
+            BenchRun(&arrCases[i], (BENCH_ENGINE_E)j, szPath, &tResult);
+
+            AX_CHAR szPending[16] = "-";
+            if (BENCH_ENGINE_WRITE != j) {
+                snprintf(szPending, sizeof(szPending), "%u/%u", tResult.tStat.nMaxPending, BENCH_BUF_COUNT);
+            }
+            printf("%-6s %-16s %-14s %8.1f %9.1f %9llu %10s %7u %10.2f%s\n", arrCases[i].szName, arrEngineNames[j], tResult.szEngine,
+                   tResult.nBytes / 1048576.0, (tResult.nBytes / 1048576.0) / ((tResult.nElapsedUs ? tResult.nElapsedUs : 1) / 1e6),
+                   tResult.tStat.nSyscalls, szPending, tResult.tStat.nStalls, tResult.nMaxBlockUs / 1000.0,
+                   tResult.bOk ? "" : "  FAILED");
+            if (!tResult.bOk) {
+                bOk = AX_FALSE;
+            }
+        }
+    }
+
+    unlink(szPath);
+    return bOk ? 0 : 1;
+}